@@ -37,6 +37,7 @@
 #define	OPT_SEARCH_ALG		"alg"
 #define	OPT_BLD_CATEGORIES	"bldcat"
 #define	OPT_RUN_CATEGORIES	"runcat"
+#define	OPT_BLD_THREADS		"bldthreads"
 #define	OPT_MAX_SIZE		"maxsize"
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
@@ -98,6 +99,7 @@ static struct {
 	size_t              max_size;
 	uint32_t            bld_categories;
 	uint32_t            run_categories;
+	uint32_t            bld_threads;
 	uint32_t            nb_rules;
 	uint32_t            nb_traces;
 	uint32_t            trace_step;
@@ -797,6 +799,10 @@ acx_init(void)
 				"for ACL context\n", config.alg.name);
 	}
 
+	ret = rte_acl_set_build_threads(config.acx, config.bld_threads);
+	if (ret != 0)
+		rte_exit(ret, "failed to set build threads for ACL context\n");
+
 	/* add ACL rules. */
 	f = fopen(config.rule_file, "r");
 	if (f == NULL)
@@ -960,6 +966,8 @@ print_usage(const char *prgname)
 			"=<number of categories to run with> "
 			"should be either 1 or multiple of %zu, "
 			"but not greater then %u]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build with>]\n"
 		"[--" OPT_MAX_SIZE
 			"=<size limit (in bytes) for runtime ACL strucutures> "
 			"leave 0 for default behaviour]\n"
@@ -983,6 +991,7 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_TRACE_STEP, config.trace_step);
 	fprintf(f, "%s:%u\n", OPT_BLD_CATEGORIES, config.bld_categories);
 	fprintf(f, "%s:%u\n", OPT_RUN_CATEGORIES, config.run_categories);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
 	fprintf(f, "%s:%zu\n", OPT_MAX_SIZE, config.max_size);
 	fprintf(f, "%s:%u\n", OPT_ITER_NUM, config.iter_num);
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
@@ -1014,6 +1023,7 @@ get_input_opts(int argc, char **argv)
 		{OPT_TRACE_STEP, 1, 0, 0},
 		{OPT_BLD_CATEGORIES, 1, 0, 0},
 		{OPT_RUN_CATEGORIES, 1, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
 		{OPT_ITER_NUM, 1, 0, 0},
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_ALG, 1, 0, 0},
@@ -1056,6 +1066,10 @@ get_input_opts(int argc, char **argv)
 			config.run_categories = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 1,
 				RTE_ACL_MAX_CATEGORIES);
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 0, UINT32_MAX);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_ITER_NUM) == 0) {
 			config.iter_num = get_ulong_opt(optarg,
 				lgopts[opt_idx].name, 1, INT32_MAX);
@@ -69,6 +69,7 @@ do_recursive_call(void)
 			{ "test_memory_flags", no_action },
 			{ "test_file_prefix", no_action },
 			{ "test_no_huge_flag", no_action },
+			{ "test_huge_populate_flags", test_huge_populate_touch },
 #ifdef RTE_LIB_TIMER
 			{ "timer_secondary_spawn_wait", test_timer_secondary },
 #endif
@@ -155,6 +155,7 @@ int commands_init(void);
 
 int test_mp_secondary(void);
 int test_timer_secondary(void);
+int test_huge_populate_touch(void);
 
 int test_set_rxtx_conf(cmdline_fixed_string_t mode);
 int test_set_rxtx_anchor(cmdline_fixed_string_t type);
@@ -13,6 +13,7 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_random.h>
 
 #include "test_acl.h"
 
@@ -1716,6 +1717,369 @@ test_u32_range(void)
 	return rc;
 }
 
+/*
+ * Compare classify results of two contexts over the test data.
+ */
+static int
+test_incremental_cmp(struct rte_acl_ctx *acx, struct rte_acl_ctx *ref)
+{
+	int32_t ret;
+	uint32_t i;
+	const uint8_t *data[RTE_DIM(acl_test_data)];
+	uint32_t res[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+	uint32_t res_ref[RTE_DIM(acl_test_data) * RTE_ACL_MAX_CATEGORIES];
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 1);
+
+	for (i = 0; i != RTE_DIM(acl_test_data); i++)
+		data[i] = (uint8_t *)&acl_test_data[i];
+
+	ret = rte_acl_classify(acx, data, res, RTE_DIM(acl_test_data),
+		RTE_ACL_MAX_CATEGORIES);
+	if (ret == 0)
+		ret = rte_acl_classify(ref, data, res_ref,
+			RTE_DIM(acl_test_data), RTE_ACL_MAX_CATEGORIES);
+
+	bswap_test_data(acl_test_data, RTE_DIM(acl_test_data), 0);
+
+	if (ret != 0) {
+		printf("Line %i: classify failed, error code: %d\n",
+			__LINE__, ret);
+		return ret;
+	}
+
+	for (i = 0; i != RTE_DIM(res); i++) {
+		if (res[i] != res_ref[i]) {
+			printf("Line %i: result mismatch at %u, "
+				"expected %u got %u\n",
+				__LINE__, i, res_ref[i], res[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Delete every third rule from the incremental context and
+ * check it against the context built from the remaining rules.
+ */
+static int
+test_incremental_del(struct rte_acl_ctx *acx)
+{
+	int32_t ret;
+	uint32_t i;
+	struct rte_acl_ctx *ref;
+	struct rte_acl_param prm;
+	struct acl_ipv4vlan_rule rv;
+
+	for (i = 0; i < RTE_DIM(acl_test_rules); i += 3) {
+		acl_ipv4vlan_convert_rule(acl_test_rules + i, &rv);
+		ret = rte_acl_del_rules(acx, (struct rte_acl_rule *)&rv, 1);
+		if (ret != 0) {
+			printf("Line %i: deleting rule %u failed, "
+				"error code: %d\n", __LINE__, i, ret);
+			return ret;
+		}
+	}
+
+	/* already deleted. */
+	acl_ipv4vlan_convert_rule(acl_test_rules, &rv);
+	ret = rte_acl_del_rules(acx, (struct rte_acl_rule *)&rv, 1);
+	if (ret != -ENOENT) {
+		printf("Line %i: deleting missing rule returned %d\n",
+			__LINE__, ret);
+		return -EINVAL;
+	}
+
+	prm = acl_param;
+	prm.name = "acl_ctx_ref";
+	ref = rte_acl_create(&prm);
+	if (ref == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -ENOMEM;
+	}
+
+	ret = 0;
+	for (i = 0; i != RTE_DIM(acl_test_rules) && ret == 0; i++) {
+		if (i % 3 != 0)
+			ret = rte_acl_ipv4vlan_add_rules(ref,
+				acl_test_rules + i, 1);
+	}
+	if (ret == 0)
+		ret = rte_acl_ipv4vlan_build(ref, ipv4_7tuple_layout,
+			RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: building reference context failed!\n",
+			__LINE__);
+		rte_acl_free(ref);
+		return ret;
+	}
+
+	/* deleted rules are masked in the main tries. */
+	ret = test_incremental_cmp(acx, ref);
+
+	/* deleted rules are gone after consolidation. */
+	if (ret == 0) {
+		ret = rte_acl_consolidate(acx);
+		if (ret != 0)
+			printf("Line %i: consolidation failed!\n", __LINE__);
+		else
+			ret = test_incremental_cmp(acx, ref);
+	}
+
+	rte_acl_free(ref);
+	return ret;
+}
+
+/*
+ * Test incremental updates of the built context.
+ */
+static int
+test_incremental(void)
+{
+	int32_t ret;
+	uint32_t i, n;
+	struct rte_acl_ctx *acx;
+	struct rte_acl_config cfg;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	/* first half of the rules goes into the main tries. */
+	n = RTE_DIM(acl_test_rules) / 2;
+	ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules, n);
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+	ret = rte_acl_build_incremental(acx, &cfg,
+		RTE_DIM(acl_test_rules) - n);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		goto err;
+	}
+
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != -EBUSY) {
+		printf("Line %i: build of incremental context returned %d\n",
+			__LINE__, ret);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* the rest goes into the delta tries, one by one. */
+	for (i = n; i != RTE_DIM(acl_test_rules); i++) {
+		ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules + i, 1);
+		if (ret != 0) {
+			printf("Line %i: Adding rule %u failed!\n",
+				__LINE__, i);
+			goto err;
+		}
+	}
+
+	ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules, 1);
+	if (ret != -ENOSPC) {
+		printf("Line %i: Adding rule to full delta returned %d\n",
+			__LINE__, ret);
+		ret = -EINVAL;
+		goto err;
+	}
+
+	ret = test_classify_run(acx, acl_test_data, RTE_DIM(acl_test_data));
+	if (ret != 0) {
+		printf("Line %i: %s with delta failed!\n", __LINE__, __func__);
+		goto err;
+	}
+
+	ret = rte_acl_consolidate(acx);
+	if (ret == 0)
+		ret = test_classify_run(acx, acl_test_data,
+			RTE_DIM(acl_test_data));
+	if (ret != 0) {
+		printf("Line %i: %s after consolidation failed!\n",
+			__LINE__, __func__);
+		goto err;
+	}
+
+	/* move every third rule of the main tries into the delta tries. */
+	for (i = 0; i < n; i += 3) {
+		ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules + i, 1);
+		if (ret != 0) {
+			printf("Line %i: Adding rule %u failed!\n",
+				__LINE__, i);
+			goto err;
+		}
+	}
+	for (i = 0; i < n; i += 3) {
+		struct acl_ipv4vlan_rule rv;
+
+		acl_ipv4vlan_convert_rule(acl_test_rules + i, &rv);
+		ret = rte_acl_del_rules(acx, (struct rte_acl_rule *)&rv, 1);
+		if (ret != 0) {
+			printf("Line %i: Deleting rule %u failed!\n",
+				__LINE__, i);
+			goto err;
+		}
+	}
+
+	ret = test_incremental_del(acx);
+	if (ret != 0)
+		printf("Line %i: %s delete failed!\n", __LINE__, __func__);
+
+err:
+	rte_acl_free(acx);
+	return ret;
+}
+
+static struct rte_acl_ipv4vlan_rule acl_rand_rules[0x800];
+static struct ipv4_7tuple acl_rand_data[0x100];
+
+/*
+ * Generate random overlapping rules (so the build has to split them
+ * into several tries) and input data that hits them.
+ */
+static void
+fill_rand_rules(void)
+{
+	uint32_t i;
+	uint16_t lo;
+	struct ipv4_7tuple *d;
+	struct rte_acl_ipv4vlan_rule *r;
+
+	for (i = 0; i != RTE_DIM(acl_rand_rules); i++) {
+		r = acl_rand_rules + i;
+		memset(r, 0, sizeof(*r));
+		r->data.category_mask = RTE_LEN2MASK(RTE_ACL_MAX_CATEGORIES,
+			uint32_t);
+		r->data.priority = i + 1;
+		r->data.userdata = i + 1;
+		r->src_addr = rte_rand();
+		r->dst_addr = rte_rand();
+
+		/* wide source and narrow destination or vice versa. */
+		if (i & 1) {
+			r->src_mask_len = rte_rand() % 9;
+			r->dst_mask_len = 24 + rte_rand() % 9;
+		} else {
+			r->src_mask_len = 24 + rte_rand() % 9;
+			r->dst_mask_len = rte_rand() % 9;
+		}
+		lo = rte_rand();
+		r->src_port_low = lo;
+		r->src_port_high = lo + rte_rand() % (UINT16_MAX - lo + 1);
+		lo = rte_rand();
+		r->dst_port_low = lo;
+		r->dst_port_high = lo + rte_rand() % (UINT16_MAX - lo + 1);
+	}
+
+	for (i = 0; i != RTE_DIM(acl_rand_data); i++) {
+		r = acl_rand_rules + rte_rand() % RTE_DIM(acl_rand_rules);
+		d = acl_rand_data + i;
+		memset(d, 0, sizeof(*d));
+		d->ip_src = rte_cpu_to_be_32(r->src_addr);
+		d->ip_dst = rte_cpu_to_be_32(r->dst_addr);
+		d->port_src = rte_cpu_to_be_16(r->src_port_low);
+		d->port_dst = rte_cpu_to_be_16(r->dst_port_high);
+	}
+}
+
+/*
+ * Check that context built with several threads
+ * classifies the same way as the one built with one thread.
+ */
+static int
+test_build_threads(void)
+{
+	static const uint32_t num_threads[] = {2, 3, 16};
+
+	int32_t ret;
+	uint32_t i, j;
+	struct rte_acl_ctx *acx, *ref;
+	struct rte_acl_param prm;
+	struct rte_acl_config cfg;
+	const uint8_t *data[RTE_DIM(acl_rand_data)];
+	uint32_t res[RTE_DIM(acl_rand_data) * RTE_ACL_MAX_CATEGORIES];
+	uint32_t res_ref[RTE_DIM(acl_rand_data) * RTE_ACL_MAX_CATEGORIES];
+
+	fill_rand_rules();
+	for (i = 0; i != RTE_DIM(acl_rand_data); i++)
+		data[i] = (uint8_t *)&acl_rand_data[i];
+
+	prm = acl_param;
+	prm.name = "acl_ctx_ref";
+	ref = rte_acl_create(&prm);
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL || ref == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	ret = rte_acl_ipv4vlan_add_rules(ref, acl_rand_rules,
+		RTE_DIM(acl_rand_rules));
+	if (ret == 0)
+		ret = rte_acl_ipv4vlan_add_rules(acx, acl_rand_rules,
+			RTE_DIM(acl_rand_rules));
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+	ret = rte_acl_build(ref, &cfg);
+	if (ret == 0)
+		ret = rte_acl_classify(ref, data, res_ref,
+			RTE_DIM(acl_rand_data), RTE_ACL_MAX_CATEGORIES);
+	if (ret != 0) {
+		printf("Line %i: reference context failed, error code: %d\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	for (i = 0; i != RTE_DIM(num_threads); i++) {
+
+		ret = rte_acl_set_build_threads(acx, num_threads[i]);
+		if (ret == 0)
+			ret = rte_acl_build(acx, &cfg);
+		if (ret == 0)
+			ret = rte_acl_classify(acx, data, res,
+				RTE_DIM(acl_rand_data), RTE_ACL_MAX_CATEGORIES);
+		if (ret != 0) {
+			printf("Line %i: build with %u threads failed, "
+				"error code: %d\n",
+				__LINE__, num_threads[i], ret);
+			goto err;
+		}
+
+		for (j = 0; j != RTE_DIM(res); j++) {
+			if (res[j] != res_ref[j]) {
+				printf("Line %i: build with %u threads, "
+					"result mismatch at %u, "
+					"expected %u got %u\n",
+					__LINE__, num_threads[i], j,
+					res_ref[j], res[j]);
+				ret = -EINVAL;
+				goto err;
+			}
+		}
+	}
+
+err:
+	rte_acl_free(acx);
+	rte_acl_free(ref);
+	return ret;
+}
+
 static int
 test_acl(void)
 {
@@ -1737,6 +2101,10 @@ test_acl(void)
 		return -1;
 	if (test_u32_range() < 0)
 		return -1;
+	if (test_incremental() < 0)
+		return -1;
+	if (test_build_threads() < 0)
+		return -1;
 
 	return 0;
 }
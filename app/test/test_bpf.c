@@ -14,6 +14,10 @@
 #include <rte_byteorder.h>
 #include <rte_errno.h>
 #include <rte_bpf.h>
+#include <rte_bpf_map.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 
@@ -3216,6 +3220,759 @@ run_test(const struct bpf_test *tst)
 
 }
 
+/* map test-cases */
+
+struct dummy_map_arg {
+	uint64_t key[2];
+};
+
+#define	TEST_MAP_NAME	"test_map"
+
+/* map helpers follow the only external symbol - the map */
+#define	TEST_MAP_FUNC(f)	(1 + RTE_BPF_FUNC_MAP_##f)
+
+/* lookup the key given in the argument, increment the value */
+static const struct ebpf_insn test_map_lookup_prog[] = {
+
+	/* copy the key to the stack */
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+		.off = offsetof(struct dummy_map_arg, key[0]),
+	},
+	{
+		.code = (BPF_STX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.src_reg = EBPF_REG_2,
+		.off = -16,
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+		.off = offsetof(struct dummy_map_arg, key[1]),
+	},
+	{
+		.code = (BPF_STX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.src_reg = EBPF_REG_2,
+		.off = -8,
+	},
+	/* map address is filled at runtime */
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_10,
+	},
+	{
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = -16,
+	},
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.imm = TEST_MAP_FUNC(LOOKUP_ELEM),
+	},
+	{
+		.code = (BPF_JMP | EBPF_JNE | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 0,
+		.off = 1,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_1,
+		.imm = 1,
+	},
+	{
+		.code = (BPF_STX | EBPF_XADD | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_1,
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_0,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/* add the key given in the argument, its first 8 bytes are the value */
+static const struct ebpf_insn test_map_update_prog[] = {
+
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+		.off = offsetof(struct dummy_map_arg, key[0]),
+	},
+	{
+		.code = (BPF_STX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.src_reg = EBPF_REG_2,
+		.off = -16,
+	},
+	{
+		.code = (BPF_STX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.src_reg = EBPF_REG_2,
+		.off = -24,
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+		.off = offsetof(struct dummy_map_arg, key[1]),
+	},
+	{
+		.code = (BPF_STX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.src_reg = EBPF_REG_2,
+		.off = -8,
+	},
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_10,
+	},
+	{
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = -16,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_3,
+		.src_reg = EBPF_REG_10,
+	},
+	{
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_3,
+		.imm = -24,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_4,
+		.imm = RTE_BPF_MAP_ANY,
+	},
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.imm = TEST_MAP_FUNC(UPDATE_ELEM),
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/* dereference of lookup result without NULL check, should be rejected */
+static const struct ebpf_insn test_map_nocheck_prog[] = {
+
+	{
+		.code = (BPF_ST | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.off = -8,
+		.imm = 0,
+	},
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_10,
+	},
+	{
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = -8,
+	},
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.imm = TEST_MAP_FUNC(LOOKUP_ELEM),
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_0,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/*
+ * lookup result compared with the argument pointer instead of NULL,
+ * dereference should be rejected
+ */
+static const struct ebpf_insn test_map_ptrcmp_prog[] = {
+
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_6,
+		.src_reg = EBPF_REG_1,
+	},
+	{
+		.code = (BPF_ST | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_10,
+		.off = -8,
+		.imm = 0,
+	},
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_10,
+	},
+	{
+		.code = (EBPF_ALU64 | BPF_ADD | BPF_K),
+		.dst_reg = EBPF_REG_2,
+		.imm = -8,
+	},
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.imm = TEST_MAP_FUNC(LOOKUP_ELEM),
+	},
+	{
+		.code = (BPF_JMP | EBPF_JNE | BPF_X),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_6,
+		.off = 2,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 0,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_0,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/*
+ * Load the program with the map as the only external symbol,
+ * map address is patched into the code at runtime.
+ */
+static struct rte_bpf *
+test_map_load(const struct ebpf_insn *prog, uint32_t nb_ins,
+	struct rte_bpf_map *map)
+{
+	uint32_t i;
+	struct ebpf_insn ins[nb_ins];
+	struct rte_bpf_xsym xsym = {
+		.name = TEST_MAP_NAME,
+		.type = RTE_BPF_XTYPE_MAP,
+		.map = { .val = map, },
+	};
+	struct rte_bpf_prm prm = {
+		.ins = ins,
+		.nb_ins = nb_ins,
+		.xsym = &xsym,
+		.nb_xsym = 1,
+		.prog_arg = {
+			.type = RTE_BPF_ARG_PTR,
+			.size = sizeof(struct dummy_map_arg),
+		},
+	};
+
+	memcpy(ins, prog, sizeof(ins));
+	for (i = 0; i != nb_ins; i++) {
+		if (ins[i].code == (BPF_LD | BPF_IMM | EBPF_DW)) {
+			ins[i].imm = (uintptr_t)map;
+			ins[i + 1].imm = (uint64_t)(uintptr_t)map >> 32;
+		}
+	}
+
+	return rte_bpf_load(&prm);
+}
+
+/*
+ * Run the program with given key, using both interpreter and jit
+ * (when possible), compare return values with expected ones.
+ */
+static int
+test_map_run(const char *name, struct rte_bpf_map *map,
+	const struct ebpf_insn *prog, uint32_t nb_ins,
+	const void *key, size_t key_sz, const uint64_t exp_rc[2])
+{
+	int32_t ret;
+	uint64_t rc[2];
+	struct rte_bpf *bpf;
+	struct rte_bpf_jit jit;
+	struct dummy_map_arg arg;
+
+	bpf = test_map_load(prog, nb_ins, map);
+	if (bpf == NULL) {
+		printf("%s@%d: failed to load bpf code for %s, error=%d(%s);\n",
+			__func__, __LINE__, name, rte_errno,
+			strerror(rte_errno));
+		return -1;
+	}
+
+	if (rte_bpf_map_get(bpf, TEST_MAP_NAME) != map) {
+		printf("%s@%d: rte_bpf_map_get(%s) failed;\n",
+			__func__, __LINE__, name);
+		rte_bpf_destroy(bpf);
+		return -1;
+	}
+
+	memset(&arg, 0, sizeof(arg));
+	memcpy(&arg, key, key_sz);
+
+	rc[0] = rte_bpf_exec(bpf, &arg);
+
+	/* without jit run interpreter once again */
+	rte_bpf_get_jit(bpf, &jit);
+	if (jit.func != NULL)
+		rc[1] = jit.func(&arg);
+	else
+		rc[1] = rte_bpf_exec(bpf, &arg);
+
+	rte_bpf_destroy(bpf);
+
+	ret = cmp_res(name, exp_rc[0], rc[0], exp_rc, exp_rc, 0);
+	ret |= cmp_res(name, exp_rc[1], rc[1], exp_rc, exp_rc, 0);
+	return ret;
+}
+
+/* check value of the element with the given key */
+static int
+test_map_check(const char *name, const struct rte_bpf_map *map,
+	const void *key, uint32_t lcore_id, const uint64_t *exp)
+{
+	const uint64_t *val;
+
+	val = rte_bpf_map_lookup_lcore(map, key, lcore_id);
+	if (exp == NULL && val == NULL)
+		return 0;
+
+	if (exp == NULL || val == NULL) {
+		printf("%s: unexpected lookup result: %p\n", name, val);
+		return -1;
+	}
+
+	return cmp_res(name, *exp, *val, exp, exp, 0);
+}
+
+static int
+test_map_array(void)
+{
+	int32_t ret;
+	uint32_t key;
+	uint64_t val;
+	struct rte_bpf_map *map;
+
+	static const uint64_t exp_rc[2] = {1, 2};
+	static const uint64_t exp_null[2] = {0, 0};
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = RTE_BPF_MAP_TYPE_ARRAY,
+			.key_size = sizeof(key),
+			.value_size = sizeof(val),
+			.max_entries = 4,
+		},
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	key = 1;
+	ret = test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_rc);
+	ret |= test_map_check(__func__, map, &key, rte_lcore_id(),
+		exp_rc + 1);
+
+	/* out of range key */
+	key = prm.def.max_entries;
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_null);
+
+	/* array elements can't be deleted or created */
+	key = 0;
+	val = 0;
+	if (rte_bpf_map_delete_elem(map, &key) != -EINVAL ||
+			rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_NOEXIST) != -EEXIST) {
+		printf("%s@%d: unexpected array update result;\n",
+			__func__, __LINE__);
+		ret = -1;
+	}
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_lcore_array(void)
+{
+	int32_t ret;
+	uint32_t key, lcore_id;
+	uint64_t val;
+	struct rte_bpf_map *map;
+
+	static const uint64_t exp_rc[2] = {6, 7};
+	static const uint64_t exp_val = 5;
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = RTE_BPF_MAP_TYPE_LCORE_ARRAY,
+			.key_size = sizeof(key),
+			.value_size = sizeof(val),
+			.max_entries = 4,
+		},
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	/* application update sets values for all lcores */
+	key = 3;
+	val = exp_val;
+	ret = rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+
+	/* program updates the copy of the current lcore only */
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_rc);
+
+	lcore_id = rte_lcore_id();
+	ret |= test_map_check(__func__, map, &key, lcore_id, exp_rc + 1);
+	ret |= test_map_check(__func__, map, &key,
+		(lcore_id + 1) % (RTE_MAX_LCORE + 1), &exp_val);
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_hash(void)
+{
+	int32_t ret;
+	uint64_t key, val;
+	struct rte_bpf_map *map;
+
+	static const uint64_t exp_rc[2] = {11, 12};
+	static const uint64_t exp_null[2] = {0, 0};
+	static const uint64_t exp_upd = 0x1234;
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = RTE_BPF_MAP_TYPE_HASH,
+			.key_size = sizeof(key),
+			.value_size = sizeof(val),
+			.max_entries = 16,
+		},
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	key = 0x5678;
+	val = 10;
+	ret = rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_NOEXIST);
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_rc);
+	ret |= test_map_check(__func__, map, &key, 0, exp_rc + 1);
+
+	/* add new element from the program */
+	key = exp_upd;
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_null);
+	ret |= test_map_run(__func__, map, test_map_update_prog,
+		RTE_DIM(test_map_update_prog), &key, sizeof(key), exp_null);
+	ret |= test_map_check(__func__, map, &key, 0, &exp_upd);
+
+	if (rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_NOEXIST) != -EEXIST ||
+			rte_bpf_map_delete_elem(map, &key) != 0 ||
+			rte_bpf_map_delete_elem(map, &key) != -ENOENT ||
+			rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_EXIST) != -ENOENT) {
+		printf("%s@%d: unexpected hash update result;\n",
+			__func__, __LINE__);
+		ret = -1;
+	}
+	ret |= test_map_check(__func__, map, &key, 0, NULL);
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_lpm(void)
+{
+	int32_t ret;
+	uint64_t val;
+	struct rte_bpf_map *map;
+	struct rte_bpf_map_lpm_key key;
+
+	static const uint64_t exp_rc16[2] = {201, 202};
+	static const uint64_t exp_rc8[2] = {101, 102};
+	static const uint64_t exp_null[2] = {0, 0};
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = RTE_BPF_MAP_TYPE_LPM,
+			.key_size = sizeof(key),
+			.value_size = sizeof(val),
+			.max_entries = 16,
+		},
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	key.depth = 8;
+	key.ip = RTE_IPV4(10, 0, 0, 0);
+	val = 100;
+	ret = rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+	key.depth = 16;
+	key.ip = RTE_IPV4(10, 1, 0, 0);
+	val = 200;
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+
+	/* depth of the key is ignored by lookup */
+	key.depth = 0;
+	key.ip = RTE_IPV4(10, 1, 2, 3);
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_rc16);
+	key.ip = RTE_IPV4(10, 2, 2, 3);
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_rc8);
+	key.ip = RTE_IPV4(11, 1, 2, 3);
+	ret |= test_map_run(__func__, map, test_map_lookup_prog,
+		RTE_DIM(test_map_lookup_prog), &key, sizeof(key), exp_null);
+
+	/* remove more specific prefix */
+	key.depth = 16;
+	key.ip = RTE_IPV4(10, 1, 0, 0);
+	ret |= rte_bpf_map_delete_elem(map, &key);
+	key.ip = RTE_IPV4(10, 1, 2, 3);
+	ret |= test_map_check(__func__, map, &key, 0, exp_rc8 + 1);
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_nocheck(void)
+{
+	uint32_t key;
+	struct rte_bpf *bpf;
+	struct rte_bpf_map *map;
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = RTE_BPF_MAP_TYPE_ARRAY,
+			.key_size = sizeof(key),
+			.value_size = sizeof(uint64_t),
+			.max_entries = 1,
+		},
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	bpf = test_map_load(test_map_nocheck_prog,
+		RTE_DIM(test_map_nocheck_prog), map);
+	if (bpf != NULL) {
+		printf("%s@%d: unchecked map value access is not rejected;\n",
+			__func__, __LINE__);
+		rte_bpf_destroy(bpf);
+		rte_bpf_map_free(map);
+		return -1;
+	}
+
+	bpf = test_map_load(test_map_ptrcmp_prog,
+		RTE_DIM(test_map_ptrcmp_prog), map);
+	rte_bpf_destroy(bpf);
+	rte_bpf_map_free(map);
+
+	if (bpf != NULL) {
+		printf("%s@%d: map value checked against a pointer "
+			"is not rejected;\n", __func__, __LINE__);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * value slot of the deleted element is not reused
+ * until the reader thread reports a quiescent state
+ */
+static int
+test_map_rcu_type(struct rte_rcu_qsbr *v, enum rte_bpf_map_type type)
+{
+	int32_t ret;
+	uint64_t val;
+	struct rte_bpf_map *map, *map2;
+	struct rte_bpf_map_lpm_key key;
+
+	const struct rte_bpf_map_prm prm = {
+		.name = __func__,
+		.socket_id = SOCKET_ID_ANY,
+		.def = {
+			.type = type,
+			.key_size = sizeof(key),
+			.value_size = sizeof(val),
+			.max_entries = 1,
+		},
+		.v = v,
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL) {
+		printf("%s@%d: failed to create map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	/* maps allocated next to each other have distinct defer queues */
+	map2 = rte_bpf_map_create(&prm);
+	if (map2 == NULL) {
+		printf("%s@%d: failed to create second map, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		rte_bpf_map_free(map);
+		return -1;
+	}
+	rte_bpf_map_free(map2);
+
+	memset(&key, 0, sizeof(key));
+	key.depth = 16;
+	key.ip = RTE_IPV4(10, 1, 0, 0);
+	val = 100;
+	ret = rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+	ret |= rte_bpf_map_delete_elem(map, &key);
+
+	key.ip = RTE_IPV4(10, 2, 0, 0);
+	if (ret != 0 || rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_ANY) != -ENOSPC) {
+		printf("%s@%d: map type %d: deleted value slot is reused "
+			"within the grace period;\n",
+			__func__, __LINE__, type);
+		ret = -1;
+	}
+
+	rte_rcu_qsbr_quiescent(v, 0);
+	val = 200;
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+	ret |= test_map_check(__func__, map, &key, 0, &val);
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_rcu(void)
+{
+	int32_t ret;
+	size_t sz;
+	struct rte_rcu_qsbr *v;
+
+	sz = rte_rcu_qsbr_get_memsize(1);
+	v = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (v == NULL || rte_rcu_qsbr_init(v, 1) != 0) {
+		printf("%s@%d: failed to create RCU QSBR variable;\n",
+			__func__, __LINE__);
+		rte_free(v);
+		return -1;
+	}
+
+	/* this thread acts as the reader */
+	rte_rcu_qsbr_thread_register(v, 0);
+	rte_rcu_qsbr_thread_online(v, 0);
+
+	ret = test_map_rcu_type(v, RTE_BPF_MAP_TYPE_HASH);
+	ret |= test_map_rcu_type(v, RTE_BPF_MAP_TYPE_LPM);
+
+	rte_rcu_qsbr_thread_offline(v, 0);
+	rte_rcu_qsbr_thread_unregister(v, 0);
+	rte_free(v);
+	return ret;
+}
+
+static int
+test_bpf_map(void)
+{
+	int32_t rc;
+
+	rc = test_map_array();
+	rc |= test_map_lcore_array();
+	rc |= test_map_hash();
+	rc |= test_map_lpm();
+	rc |= test_map_nocheck();
+	rc |= test_map_rcu();
+	return rc;
+}
+
 static int
 test_bpf(void)
 {
@@ -3229,6 +3986,7 @@ test_bpf(void)
 			rc |= rv;
 	}
 
+	rc |= test_bpf_map();
 	return rc;
 }
 
@@ -0,0 +1,482 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_conntrack.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_random.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "test.h"
+
+#define NUM_MBUFS	1023
+#define MAX_CONNS	1024
+#define NB_SHARDS	4
+#define NB_FLOWS	200
+
+static struct rte_mempool *pool;
+static uint32_t expired_cnt;
+
+static void
+expire_cb(struct rte_conntrack_conn *conn, void *arg)
+{
+	RTE_SET_USED(conn);
+	RTE_SET_USED(arg);
+	expired_cnt++;
+}
+
+static struct rte_mbuf *
+pkt_build(int ipv6, uint8_t proto, uint32_t src, uint32_t dst,
+	uint16_t sport, uint16_t dport, uint8_t tcp_flags)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_tcp_hdr *tcp;
+	struct rte_udp_hdr *udp;
+	struct rte_mbuf *m;
+	uint32_t l3_len, l4_len;
+	uint8_t *l4;
+
+	m = rte_pktmbuf_alloc(pool);
+	if (m == NULL)
+		return NULL;
+
+	l3_len = ipv6 ? sizeof(*ip6) : sizeof(*ip4);
+	l4_len = (proto == IPPROTO_TCP) ? sizeof(*tcp) : sizeof(*udp);
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+		sizeof(*eth) + l3_len + l4_len);
+	memset(eth, 0, sizeof(*eth) + l3_len + l4_len);
+	m->l2_len = sizeof(*eth);
+	m->l3_len = l3_len;
+
+	if (ipv6) {
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6);
+		ip6 = (struct rte_ipv6_hdr *)(eth + 1);
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->proto = proto;
+		ip6->src_addr[0] = 0x20;
+		ip6->src_addr[1] = 0x01;
+		memcpy(&ip6->src_addr[12], &src, sizeof(src));
+		ip6->dst_addr[0] = 0x20;
+		ip6->dst_addr[1] = 0x01;
+		memcpy(&ip6->dst_addr[12], &dst, sizeof(dst));
+		l4 = (uint8_t *)(ip6 + 1);
+	} else {
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+		ip4 = (struct rte_ipv4_hdr *)(eth + 1);
+		ip4->version_ihl = RTE_IPV4_VHL_DEF;
+		ip4->next_proto_id = proto;
+		ip4->src_addr = rte_cpu_to_be_32(src);
+		ip4->dst_addr = rte_cpu_to_be_32(dst);
+		l4 = (uint8_t *)(ip4 + 1);
+	}
+
+	if (proto == IPPROTO_TCP) {
+		tcp = (struct rte_tcp_hdr *)l4;
+		tcp->src_port = rte_cpu_to_be_16(sport);
+		tcp->dst_port = rte_cpu_to_be_16(dport);
+		tcp->tcp_flags = tcp_flags;
+	} else {
+		udp = (struct rte_udp_hdr *)l4;
+		udp->src_port = rte_cpu_to_be_16(sport);
+		udp->dst_port = rte_cpu_to_be_16(dport);
+	}
+
+	return m;
+}
+
+static struct rte_conntrack *
+conntrack_create(uint32_t nb_shards)
+{
+	struct rte_conntrack_params params = {
+		.name = "test_ct",
+		.socket_id = SOCKET_ID_ANY,
+		.nb_shards = nb_shards,
+		.max_conns = MAX_CONNS,
+		.expire_cb = expire_cb,
+	};
+
+	params.timeout[RTE_CONNTRACK_UDP_UNREPLIED] = 1;
+	params.timeout[RTE_CONNTRACK_UDP_ASSURED] = 4;
+	return rte_conntrack_create(&params);
+}
+
+/* Send one packet through lookup and create, return its connection. */
+static struct rte_conntrack_conn *
+pkt_process(struct rte_conntrack *ct, struct rte_mbuf *m, uint8_t *dir,
+	uint64_t now)
+{
+	struct rte_conntrack_conn *conn;
+
+	if (rte_conntrack_lookup_bulk(ct, 0, &m, &conn, dir, 1, now) == 0)
+		rte_conntrack_create_bulk(ct, 0, &m, &conn, dir, 1, now);
+	rte_pktmbuf_free(m);
+	return conn;
+}
+
+static int
+test_conntrack_create_invalid(void)
+{
+	struct rte_conntrack_params params = {
+		.name = "test_ct",
+		.socket_id = SOCKET_ID_ANY,
+		.nb_shards = 1,
+		.max_conns = MAX_CONNS,
+	};
+	uint16_t reta[4] = {0, 1, 2, 3};
+	struct rte_conntrack *ct;
+
+	ct = rte_conntrack_create(NULL);
+	TEST_ASSERT(ct == NULL && rte_errno == EINVAL,
+		"No error on create() with NULL params");
+
+	params.nb_shards = 0;
+	ct = rte_conntrack_create(&params);
+	TEST_ASSERT(ct == NULL && rte_errno == EINVAL,
+		"No error on create() with no shard");
+
+	params.nb_shards = 2;
+	params.reta_size = 3;
+	ct = rte_conntrack_create(&params);
+	TEST_ASSERT(ct == NULL && rte_errno == EINVAL,
+		"No error on create() with invalid reta size");
+
+	params.reta = reta;
+	params.reta_size = RTE_DIM(reta);
+	ct = rte_conntrack_create(&params);
+	TEST_ASSERT(ct == NULL && rte_errno == EINVAL,
+		"No error on create() with reta entry out of range");
+
+	params.nb_shards = RTE_DIM(reta);
+	ct = rte_conntrack_create(&params);
+	TEST_ASSERT_NOT_NULL(ct, "Failed to create connection tracker");
+	rte_conntrack_free(ct);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_conntrack_tcp(void)
+{
+	static const struct {
+		int reply;
+		uint8_t flags;
+		uint8_t state;
+	} seq[] = {
+		{1, RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG,
+			RTE_CONNTRACK_TCP_SYN_RECV},
+		{0, RTE_TCP_ACK_FLAG, RTE_CONNTRACK_TCP_ESTABLISHED},
+		{1, RTE_TCP_ACK_FLAG | RTE_TCP_PSH_FLAG,
+			RTE_CONNTRACK_TCP_ESTABLISHED},
+		{0, RTE_TCP_FIN_FLAG | RTE_TCP_ACK_FLAG,
+			RTE_CONNTRACK_TCP_FIN_WAIT},
+		{1, RTE_TCP_ACK_FLAG, RTE_CONNTRACK_TCP_CLOSE_WAIT},
+		{1, RTE_TCP_FIN_FLAG | RTE_TCP_ACK_FLAG,
+			RTE_CONNTRACK_TCP_LAST_ACK},
+		{0, RTE_TCP_ACK_FLAG, RTE_CONNTRACK_TCP_TIME_WAIT},
+	};
+	struct rte_conntrack_conn *conn, *c;
+	struct rte_conntrack_stats stats;
+	struct rte_conntrack *ct;
+	struct rte_mbuf *m;
+	uint64_t now;
+	uint32_t a, b, i;
+	uint8_t dir;
+	int v6;
+
+	ct = conntrack_create(1);
+	TEST_ASSERT_NOT_NULL(ct, "Failed to create connection tracker");
+	now = rte_get_tsc_cycles();
+
+	for (v6 = 0; v6 != 2; v6++) {
+		/* originator with the higher address */
+		a = RTE_IPV4(10, 0, 0, 2);
+		b = RTE_IPV4(10, 0, 0, 1);
+
+		m = pkt_build(v6, IPPROTO_TCP, a, b, 1024, 80,
+			RTE_TCP_ACK_FLAG);
+		TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+		conn = pkt_process(ct, m, &dir, now);
+		TEST_ASSERT_NULL(conn, "Connection opened without SYN");
+
+		m = pkt_build(v6, IPPROTO_TCP, a, b, 1024, 80,
+			RTE_TCP_SYN_FLAG);
+		TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+		conn = pkt_process(ct, m, &dir, now);
+		TEST_ASSERT_NOT_NULL(conn, "Connection not created");
+		TEST_ASSERT(conn->state == RTE_CONNTRACK_TCP_SYN_SENT &&
+			dir == RTE_CONNTRACK_DIR_ORIGINAL,
+			"Unexpected state %u dir %u", conn->state, dir);
+
+		for (i = 0; i != RTE_DIM(seq); i++) {
+			if (seq[i].reply)
+				m = pkt_build(v6, IPPROTO_TCP, b, a, 80, 1024,
+					seq[i].flags);
+			else
+				m = pkt_build(v6, IPPROTO_TCP, a, b, 1024, 80,
+					seq[i].flags);
+			TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+			c = pkt_process(ct, m, &dir, now);
+			TEST_ASSERT(c == conn, "Step %u: wrong connection", i);
+			TEST_ASSERT_EQUAL(dir, (seq[i].reply ?
+				RTE_CONNTRACK_DIR_REPLY :
+				RTE_CONNTRACK_DIR_ORIGINAL),
+				"Step %u: wrong direction", i);
+			TEST_ASSERT_EQUAL(conn->state, seq[i].state,
+				"Step %u: state %u, expected %u",
+				i, conn->state, seq[i].state);
+		}
+		TEST_ASSERT(conn->pkts[RTE_CONNTRACK_DIR_ORIGINAL] == 4 &&
+			conn->pkts[RTE_CONNTRACK_DIR_REPLY] == 4,
+			"Wrong packet counters");
+
+		/* reset closes, SYN reopens */
+		m = pkt_build(v6, IPPROTO_TCP, b, a, 80, 1024,
+			RTE_TCP_RST_FLAG);
+		TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+		c = pkt_process(ct, m, &dir, now);
+		TEST_ASSERT(c == conn && conn->state == RTE_CONNTRACK_TCP_CLOSE,
+			"RST did not close the connection");
+
+		m = pkt_build(v6, IPPROTO_TCP, b, a, 80, 1024,
+			RTE_TCP_SYN_FLAG);
+		TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+		c = pkt_process(ct, m, &dir, now);
+		TEST_ASSERT(c == conn &&
+			conn->state == RTE_CONNTRACK_TCP_SYN_SENT,
+			"SYN did not reopen the connection");
+
+		m = pkt_build(v6, IPPROTO_TCP, a, b, 1024, 80,
+			RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG);
+		TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+		c = pkt_process(ct, m, &dir, now);
+		TEST_ASSERT(c == conn && dir == RTE_CONNTRACK_DIR_REPLY &&
+			conn->state == RTE_CONNTRACK_TCP_SYN_RECV,
+			"Reopened connection has wrong originator");
+
+		TEST_ASSERT_SUCCESS(rte_conntrack_delete(ct, 0, conn),
+			"Failed to delete connection");
+		TEST_ASSERT_FAIL(rte_conntrack_delete(ct, 0, conn),
+			"Deleted connection twice");
+	}
+
+	TEST_ASSERT_SUCCESS(rte_conntrack_stats_get(ct, 0, &stats),
+		"Failed to get stats");
+	TEST_ASSERT(stats.conns == 0 && stats.created == 2 &&
+		stats.deleted == 2 && stats.untracked == 2,
+		"Unexpected stats");
+
+	rte_conntrack_free(ct);
+	return TEST_SUCCESS;
+}
+
+static int
+test_conntrack_udp_aging(void)
+{
+	struct rte_conntrack_conn *c1, *c2, *c;
+	struct rte_conntrack *ct;
+	struct rte_mbuf *m;
+	uint64_t hz, now;
+	uint8_t dir;
+
+	ct = conntrack_create(1);
+	TEST_ASSERT_NOT_NULL(ct, "Failed to create connection tracker");
+	hz = rte_get_tsc_hz();
+	now = rte_get_tsc_cycles();
+	expired_cnt = 0;
+
+	m = pkt_build(0, IPPROTO_UDP, 1, 2, 53, 53, 0);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	c1 = pkt_process(ct, m, &dir, now);
+	TEST_ASSERT(c1 != NULL && c1->state == RTE_CONNTRACK_UDP_UNREPLIED,
+		"UDP connection not created");
+
+	m = pkt_build(0, IPPROTO_UDP, 3, 4, 1000, 2000, 0);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	c2 = pkt_process(ct, m, &dir, now);
+	TEST_ASSERT_NOT_NULL(c2, "UDP connection not created");
+
+	m = pkt_build(0, IPPROTO_UDP, 4, 3, 2000, 1000, 0);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	c = pkt_process(ct, m, &dir, now);
+	TEST_ASSERT(c == c2 && dir == RTE_CONNTRACK_DIR_REPLY &&
+		c2->state == RTE_CONNTRACK_UDP_ASSURED,
+		"UDP reply not matched");
+
+	/* unreplied flow times out after 1s, the assured one after 4s */
+	TEST_ASSERT_EQUAL(rte_conntrack_age(ct, 0, now + hz / 2), 0,
+		"Connection expired too early");
+	TEST_ASSERT_EQUAL(rte_conntrack_age(ct, 0, now + 2 * hz), 1,
+		"Unreplied connection not expired");
+	TEST_ASSERT_EQUAL(expired_cnt, 1, "Expiry callback not called");
+
+	/* refresh the assured flow, it must survive its first deadline */
+	m = pkt_build(0, IPPROTO_UDP, 3, 4, 1000, 2000, 0);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	c = pkt_process(ct, m, &dir, now + 3 * hz);
+	TEST_ASSERT(c == c2, "Assured connection lost");
+	TEST_ASSERT_EQUAL(rte_conntrack_age(ct, 0, now + 5 * hz), 0,
+		"Refreshed connection expired");
+	TEST_ASSERT_EQUAL(rte_conntrack_age(ct, 0, now + 8 * hz), 1,
+		"Assured connection not expired");
+	TEST_ASSERT_EQUAL(expired_cnt, 2, "Expiry callback not called");
+
+	m = pkt_build(0, IPPROTO_UDP, 4, 3, 2000, 1000, 0);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	TEST_ASSERT(rte_conntrack_lookup_bulk(ct, 0, &m, &c, NULL, 1,
+		now + 8 * hz) == 0, "Expired connection still found");
+	rte_pktmbuf_free(m);
+
+	rte_conntrack_free(ct);
+	return TEST_SUCCESS;
+}
+
+static int
+test_conntrack_shard(void)
+{
+	struct rte_conntrack *ct;
+	struct rte_mbuf *m[2];
+	uint32_t i, a, b, hist[NB_SHARDS];
+	uint16_t pa, pb;
+	int v6;
+
+	ct = conntrack_create(NB_SHARDS);
+	TEST_ASSERT_NOT_NULL(ct, "Failed to create connection tracker");
+	memset(hist, 0, sizeof(hist));
+
+	for (i = 0; i != 1024; i++) {
+		a = rte_rand();
+		b = rte_rand();
+		pa = rte_rand();
+		pb = rte_rand();
+		v6 = i & 1;
+
+		m[0] = pkt_build(v6, IPPROTO_TCP, a, b, pa, pb, 0);
+		m[1] = pkt_build(v6, IPPROTO_TCP, b, a, pb, pa, 0);
+		TEST_ASSERT(m[0] != NULL && m[1] != NULL,
+			"Failed to build packet");
+		TEST_ASSERT_EQUAL(rte_conntrack_shard_get(ct, m[0]),
+			rte_conntrack_shard_get(ct, m[1]),
+			"Shard not symmetric");
+		hist[rte_conntrack_shard_get(ct, m[0])]++;
+		rte_pktmbuf_free_bulk(m, 2);
+	}
+
+	for (i = 0; i != NB_SHARDS; i++)
+		TEST_ASSERT(hist[i] != 0, "Shard %u never selected", i);
+
+	rte_conntrack_free(ct);
+	return TEST_SUCCESS;
+}
+
+static int
+test_conntrack_bulk(void)
+{
+	struct rte_mbuf *m[NB_FLOWS];
+	struct rte_conntrack_conn *conns[NB_FLOWS], *orig[NB_FLOWS];
+	struct rte_conntrack_stats stats;
+	struct rte_conntrack *ct;
+	uint8_t dirs[NB_FLOWS];
+	uint64_t now;
+	uint32_t i;
+
+	ct = conntrack_create(1);
+	TEST_ASSERT_NOT_NULL(ct, "Failed to create connection tracker");
+	now = rte_get_tsc_cycles();
+
+	for (i = 0; i != NB_FLOWS; i++) {
+		m[i] = pkt_build(i & 1, (i & 2) ? IPPROTO_UDP : IPPROTO_TCP,
+			i, i + 1000, 1000 + i, 80, RTE_TCP_SYN_FLAG);
+		TEST_ASSERT_NOT_NULL(m[i], "Failed to build packet");
+	}
+
+	TEST_ASSERT_EQUAL(rte_conntrack_lookup_bulk(ct, 0, m, conns, dirs,
+		NB_FLOWS, now), 0, "Unexpected hits in empty table");
+	TEST_ASSERT_EQUAL(rte_conntrack_create_bulk(ct, 0, m, conns, dirs,
+		NB_FLOWS, now), NB_FLOWS, "Failed to create connections");
+	memcpy(orig, conns, sizeof(orig));
+	rte_pktmbuf_free_bulk(m, NB_FLOWS);
+
+	/* replies */
+	for (i = 0; i != NB_FLOWS; i++) {
+		m[i] = pkt_build(i & 1, (i & 2) ? IPPROTO_UDP : IPPROTO_TCP,
+			i + 1000, i, 80, 1000 + i,
+			RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG);
+		TEST_ASSERT_NOT_NULL(m[i], "Failed to build packet");
+	}
+
+	TEST_ASSERT_EQUAL(rte_conntrack_lookup_bulk(ct, 0, m, conns, dirs,
+		NB_FLOWS, now), NB_FLOWS, "Replies not matched");
+	for (i = 0; i != NB_FLOWS; i++) {
+		TEST_ASSERT(conns[i] == orig[i] &&
+			dirs[i] == RTE_CONNTRACK_DIR_REPLY,
+			"Reply %u matched the wrong connection", i);
+		TEST_ASSERT_EQUAL(conns[i]->state, ((i & 2) ?
+			RTE_CONNTRACK_UDP_ASSURED :
+			RTE_CONNTRACK_TCP_SYN_RECV),
+			"Reply %u: wrong state", i);
+	}
+	rte_pktmbuf_free_bulk(m, NB_FLOWS);
+
+	TEST_ASSERT_SUCCESS(rte_conntrack_stats_get(ct, 0, &stats),
+		"Failed to get stats");
+	TEST_ASSERT(stats.conns == NB_FLOWS && stats.created == NB_FLOWS &&
+		stats.hits == NB_FLOWS && stats.misses == NB_FLOWS,
+		"Unexpected stats");
+
+	rte_conntrack_free(ct);
+	return TEST_SUCCESS;
+}
+
+static int
+test_setup(void)
+{
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("ct_test_pool", NUM_MBUFS, 0,
+			0, RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+		if (pool == NULL) {
+			printf("%s: Error creating mempool\n", __func__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void
+test_teardown(void)
+{
+	rte_mempool_free(pool);
+	pool = NULL;
+}
+
+static struct unit_test_suite conntrack_test_suite = {
+	.setup = test_setup,
+	.teardown = test_teardown,
+	.suite_name = "Connection Tracking Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_conntrack_create_invalid),
+		TEST_CASE(test_conntrack_tcp),
+		TEST_CASE(test_conntrack_udp_aging),
+		TEST_CASE(test_conntrack_shard),
+		TEST_CASE(test_conntrack_bulk),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_conntrack(void)
+{
+	return unit_test_suite_runner(&conntrack_test_suite);
+}
+
+REGISTER_TEST_COMMAND(conntrack_autotest, test_conntrack);
@@ -577,6 +577,149 @@ test_flush_with_worker_shutdown(struct worker_params *wp,
 	return 0;
 }
 
+/* worker function for the work stealing test: worker zero is slow,
+ * so that its backlog is left for the other workers to steal.
+ */
+static int
+handle_work_with_slow_worker(void *arg)
+{
+	struct rte_mbuf *buf[8] __rte_cache_aligned;
+	struct worker_params *wp = arg;
+	struct rte_distributor *db = wp->dist;
+	unsigned int num;
+	unsigned int id = __atomic_fetch_add(&worker_idx, 1, __ATOMIC_RELAXED);
+
+	num = rte_distributor_get_pkt(db, id, buf, NULL, 0);
+	while (!quit) {
+		__atomic_fetch_add(&worker_stats[id].handled_packets, num,
+				__ATOMIC_RELAXED);
+		if (id == 0 && num != 0)
+			rte_delay_us(100);
+		num = rte_distributor_get_pkt(db, id,
+				buf, buf, num);
+	}
+	__atomic_fetch_add(&worker_stats[id].handled_packets, num,
+			__ATOMIC_RELAXED);
+	rte_distributor_return_pkt(db, id, buf, num);
+	return 0;
+}
+
+/* steal_test sends untagged packets with work stealing enabled, checks
+ * that they all come back and that the worker statistics are consistent.
+ */
+static int
+steal_test(struct worker_params *wp, struct rte_mempool *p)
+{
+	struct rte_distributor *d = wp->dist;
+	const unsigned int num_workers = rte_lcore_count() - 1;
+	struct rte_mbuf *bufs[BIG_BATCH], *returns[BIG_BATCH];
+	struct rte_distributor_worker_stats stats;
+	uint64_t pkts = 0, returned = 0, stolen = 0, robbed = 0;
+	unsigned int num_returned = 0, num_being_processed = 0;
+	unsigned int return_buffer_capacity = 127;/* RTE_DISTRIB_RETURNS_MASK */
+	unsigned int i, count, retries;
+
+	printf("=== Work stealing test (%s) ===\n", wp->name);
+	clear_packet_count();
+
+	rte_distributor_flush(d);
+	rte_distributor_clear_returns(d);
+	if (rte_distributor_steal_set(NULL, 1) != -EINVAL) {
+		printf("line %d: No error on NULL distributor\n", __LINE__);
+		return -1;
+	}
+	if (rte_distributor_steal_set(d, 1) != 0) {
+		printf("line %d: Error enabling work stealing\n", __LINE__);
+		return -1;
+	}
+	rte_distributor_stats_reset(d);
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	/* zero hash: untagged packets, not bound to any flow */
+	for (i = 0; i < BIG_BATCH; i++)
+		bufs[i]->hash.usr = 0;
+
+	/*
+	 * No flush between the bursts, it would empty the backlog of the
+	 * slow worker before any other worker gets ready to steal from it.
+	 */
+	for (i = 0; i < BIG_BATCH / BURST; i++) {
+		rte_distributor_process(d, &bufs[i * BURST], BURST);
+		num_being_processed += BURST;
+		while (num_being_processed + BURST > return_buffer_capacity) {
+			rte_distributor_process(d, NULL, 0);
+			count = rte_distributor_returned_pkts(d,
+					&returns[num_returned],
+					BIG_BATCH - num_returned);
+			num_being_processed -= count;
+			num_returned += count;
+		}
+	}
+	retries = 0;
+	do {
+		rte_distributor_flush(d);
+		count = rte_distributor_returned_pkts(d,
+				&returns[num_returned],
+				BIG_BATCH - num_returned);
+		num_returned += count;
+		retries++;
+	} while ((num_returned < BIG_BATCH) && (retries < 100));
+
+	rte_distributor_steal_set(d, 0);
+	rte_mempool_put_bulk(p, (void *)bufs, BIG_BATCH);
+
+	if (num_returned != BIG_BATCH) {
+		printf("line %d: Missing packets, expected %d, got %u\n",
+				__LINE__, BIG_BATCH, num_returned);
+		return -1;
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		if (rte_distributor_stats_get(d, i, &stats) != 0) {
+			printf("line %d: Error getting worker stats\n",
+					__LINE__);
+			return -1;
+		}
+		printf("Worker %u handled %u packets, stole %"PRIu64
+				", robbed of %"PRIu64"\n", i,
+				__atomic_load_n(
+					&worker_stats[i].handled_packets,
+					__ATOMIC_RELAXED),
+				stats.stolen, stats.robbed);
+		pkts += stats.pkts;
+		returned += stats.returns;
+		stolen += stats.stolen;
+		robbed += stats.robbed;
+	}
+	if (rte_distributor_stats_get(d, num_workers, &stats) != -EINVAL) {
+		printf("line %d: No error on invalid worker id\n", __LINE__);
+		return -1;
+	}
+
+	if (pkts != BIG_BATCH || returned != BIG_BATCH || stolen != robbed ||
+			total_packet_count() != BIG_BATCH) {
+		printf("line %d: Inconsistent worker stats: pkts %"PRIu64
+				", returns %"PRIu64", stolen %"PRIu64
+				", robbed %"PRIu64", handled %u\n", __LINE__,
+				pkts, returned, stolen, robbed,
+				total_packet_count());
+		return -1;
+	}
+
+	/* the backlog of the slow worker must have been stolen from */
+	if (stolen == 0) {
+		printf("line %d: No packet stolen from the slow worker\n",
+				__LINE__);
+		return -1;
+	}
+
+	printf("Work stealing test passed\n\n");
+	return 0;
+}
+
 static int
 handle_and_mark_work(void *arg)
 {
@@ -918,6 +1061,31 @@ test_distributor(void)
 					&worker_params, SKIP_MAIN);
 			if (sanity_mark_test(&worker_params, p) < 0)
 				goto err;
+			if (i == 0 && rte_distributor_steal_set(dist[i], 1) !=
+					-ENOTSUP) {
+				printf("Work stealing not rejected\n");
+				goto err;
+			}
+			quit_workers(&worker_params, p);
+
+			if (i == 0)
+				continue;
+
+			rte_eal_mp_remote_launch(handle_work_with_slow_worker,
+					&worker_params, SKIP_MAIN);
+			if (steal_test(&worker_params, p) < 0)
+				goto err;
+			quit_workers(&worker_params, p);
+
+			/* tagged flows stay pinned with work stealing */
+			rte_eal_mp_remote_launch(handle_and_mark_work,
+					&worker_params, SKIP_MAIN);
+			rte_distributor_steal_set(dist[i], 1);
+			if (sanity_mark_test(&worker_params, p) < 0) {
+				rte_distributor_steal_set(dist[i], 0);
+				goto err;
+			}
+			rte_distributor_steal_set(dist[i], 0);
 			quit_workers(&worker_params, p);
 
 		} else {
@@ -21,6 +21,7 @@
 
 #include <rte_lcore.h>
 #include <rte_debug.h>
+#include <rte_memory.h>
 #include <rte_string_fns.h>
 
 #include "process.h"
@@ -1457,6 +1458,94 @@ test_memory_flags(void)
 	return 0;
 }
 
+static int
+touch_seg(const struct rte_memseg_list *msl __rte_unused,
+		const struct rte_memseg *ms, void *arg __rte_unused)
+{
+	/* fault the page in without changing its content */
+	*(volatile int *)ms->addr = *(volatile int *)ms->addr;
+	return 0;
+}
+
+/*
+ * Run in the process launched by test_huge_populate_flags(), fault in
+ * all the hugepages it preallocated.
+ */
+int
+test_huge_populate_touch(void)
+{
+	return rte_memseg_walk(touch_seg, NULL);
+}
+
+/*
+ * Test that the app runs with the options faulting in the preallocated
+ * hugepages, and uses its memory once initialized.
+ */
+static int
+test_huge_populate_flags(void)
+{
+#ifdef RTE_EXEC_ENV_FREEBSD
+	/* options are not supported on BSD */
+	return 0;
+#else
+	const char *prefix = "--file-prefix=" memtest;
+
+	/* lazy mode, pages are faulted in after initialization */
+	const char *argv0[] = {prgname, prefix, "-m", DEFAULT_MEM_SIZE,
+			"--iova-mode=va", "--huge-lazy-populate"};
+	/* several threads faulting in the pages */
+	const char *argv1[] = {prgname, prefix, "-m", DEFAULT_MEM_SIZE,
+			"--huge-populate-threads", "2"};
+	/* both options together */
+	const char *argv2[] = {prgname, prefix, "-m", DEFAULT_MEM_SIZE,
+			"--iova-mode=va", "--huge-lazy-populate",
+			"--huge-populate-threads", "2"};
+	/* lazy mode with --no-huge (should fail) */
+	const char *argv3[] = {prgname, prefix, no_huge,
+			"--huge-lazy-populate"};
+	/* lazy mode with --legacy-mem (should fail) */
+	const char *argv4[] = {prgname, prefix, "-m", DEFAULT_MEM_SIZE,
+			"--legacy-mem", "--huge-lazy-populate"};
+	/* threads with --single-file-segments (should fail) */
+	const char *argv5[] = {prgname, prefix, "-m", DEFAULT_MEM_SIZE,
+			"--single-file-segments",
+			"--huge-populate-threads", "2"};
+
+	if (launch_proc(argv0) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-lazy-populate flag\n");
+		return -1;
+	}
+	if (launch_proc(argv1) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-populate-threads flag\n");
+		return -1;
+	}
+	if (launch_proc(argv2) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-lazy-populate and --huge-populate-threads flags\n");
+		return -1;
+	}
+	if (launch_proc(argv3) == 0) {
+		printf("Error - process run ok with "
+				"--huge-lazy-populate and --no-huge flags\n");
+		return -1;
+	}
+	if (launch_proc(argv4) == 0) {
+		printf("Error - process run ok with "
+				"--huge-lazy-populate and --legacy-mem flags\n");
+		return -1;
+	}
+	if (launch_proc(argv5) == 0) {
+		printf("Error - process run ok with "
+				"--huge-populate-threads and --single-file-segments flags\n");
+		return -1;
+	}
+
+	return 0;
+#endif
+}
+
 static int
 test_eal_flags(void)
 {
@@ -1535,6 +1624,12 @@ test_eal_flags(void)
 		return ret;
 	}
 
+	ret = test_huge_populate_flags();
+	if (ret < 0) {
+		printf("Error in test_huge_populate_flags()\n");
+		return ret;
+	}
+
 	return ret;
 }
 
@@ -1553,3 +1648,5 @@ REGISTER_TEST_COMMAND(eal_flags_r_opt_autotest, test_invalid_r_flag);
 REGISTER_TEST_COMMAND(eal_flags_mem_autotest, test_memory_flags);
 REGISTER_TEST_COMMAND(eal_flags_file_prefix_autotest, test_file_prefix);
 REGISTER_TEST_COMMAND(eal_flags_misc_autotest, test_misc_flags);
+REGISTER_TEST_COMMAND(eal_flags_huge_populate_autotest,
+		test_huge_populate_flags);
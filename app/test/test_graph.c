@@ -771,6 +771,104 @@ test_print_stats(void)
 	return 0;
 }
 
+static int
+test_graph_dispatch(void)
+{
+	struct rte_graph_param gconf = {
+		.socket_id = SOCKET_ID_ANY,
+	};
+	struct rte_graph *graph, *clone;
+	rte_node_t src_id, node3_id;
+	struct rte_node *node3;
+	rte_graph_t clone_id;
+	uint64_t calls;
+	int rc = -1;
+
+	if (RTE_MAX_LCORE < 2)
+		return 0;
+
+	/* Run test_node33 by the clone only, the sources by worker0 only */
+	src_id = rte_node_from_name("test_node_source1");
+	node3_id = rte_node_from_name("test_node00-test_node33");
+	if (rte_node_lcore_affinity_set(src_id, 0) ||
+	    rte_node_lcore_affinity_set(node3_id, 1)) {
+		printf("Node lcore affinity set failed\n");
+		return -1;
+	}
+
+	clone_id = rte_graph_clone(graph_id, "dispatch", &gconf);
+	if (clone_id == RTE_GRAPH_ID_INVALID) {
+		printf("Graph clone failed with error = %d\n", rte_errno);
+		goto affinity_clear;
+	}
+
+	if (rte_graph_bind_lcore(graph_id, 0) ||
+	    rte_graph_bind_lcore(clone_id, 1)) {
+		printf("Graph bind lcore failed\n");
+		goto clone_destroy;
+	}
+
+	if (rte_graph_bind_lcore(clone_id, 0) != -EEXIST) {
+		printf("Graph bind to a busy lcore, expected failure\n");
+		goto clone_destroy;
+	}
+
+	graph = rte_graph_lookup("worker0");
+	clone = rte_graph_lookup("worker0-dispatch");
+	node3 = rte_graph_node_get(graph_id, node3_id);
+	if (!graph || !clone || !node3) {
+		printf("Graph lookup failed\n");
+		goto clone_destroy;
+	}
+
+	/* The streams of test_node33 are handed off to the clone */
+	calls = fn_calls[4];
+	rte_graph_walk(graph);
+	if (fn_calls[4] != calls) {
+		printf("Node run by the graph not bound to its lcore\n");
+		goto clone_destroy;
+	}
+
+	if (rte_graph_has_stats_feature() && node3->total_sched_objs == 0) {
+		printf("No objs handed off to the clone\n");
+		goto clone_destroy;
+	}
+
+	rte_graph_walk(clone);
+	if (fn_calls[4] == calls) {
+		printf("Node not run by the graph bound to its lcore\n");
+		goto clone_destroy;
+	}
+
+	/* The streams queued at unbind time are run by the next walk */
+	rte_graph_walk(graph);
+	rte_graph_unbind_lcore(clone_id);
+	if (clone->wq != NULL) {
+		printf("Work queue still attached to the unbound graph\n");
+		goto clone_destroy;
+	}
+
+	calls = fn_calls[4];
+	rte_graph_walk(clone);
+	if (fn_calls[4] == calls) {
+		printf("Streams queued to the unbound graph not run\n");
+		goto clone_destroy;
+	}
+
+	rte_graph_unbind_lcore(graph_id);
+	rc = 0;
+
+clone_destroy:
+	if (rte_graph_destroy(clone_id)) {
+		printf("Graph clone destroy failed\n");
+		rc = -1;
+	}
+affinity_clear:
+	rte_node_lcore_affinity_set(src_id, RTE_MAX_LCORE);
+	rte_node_lcore_affinity_set(node3_id, RTE_MAX_LCORE);
+	return rc;
+}
+
 static int
 graph_setup(void)
 {
@@ -822,6 +920,7 @@ static struct unit_test_suite graph_testsuite = {
 		TEST_CASE(test_graph_lookup_functions),
 		TEST_CASE(test_graph_walk),
 		TEST_CASE(test_print_stats),
+		TEST_CASE(test_graph_dispatch),
 		TEST_CASES_END(), /**< NULL terminate unit test array */
 	},
 };
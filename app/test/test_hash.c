@@ -18,6 +18,7 @@
 #include <rte_eal.h>
 #include <rte_ip.h>
 #include <rte_string_fns.h>
+#include <rte_vect.h>
 
 #include "test.h"
 
@@ -1384,6 +1385,17 @@ static int test_hash_creation_with_bad_parameters(void)
 		return -1;
 	}
 
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "creation_with_bad_parameters_5";
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE |
+			    RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	handle = rte_hash_create(&params);
+	if (handle != NULL) {
+		rte_hash_free(handle);
+		printf("Impossible creating resizable hash successfully with ext table\n");
+		return -1;
+	}
+
 	/* test with same name should fail */
 	memcpy(&params, &ut_params, sizeof(params));
 	params.name = "same_name";
@@ -1593,6 +1605,236 @@ err:
 	return -1;
 }
 
+/*
+ * Bulk lookup of added and missing keys, with tables created under different
+ * max SIMD bitwidths to cover the scalar/SSE, AVX2 and AVX512 paths.
+ */
+#define BULK_ENTRIES 1024
+static int
+test_hash_lookup_bulk_simd(void)
+{
+	static const uint16_t bitwidths[] = {
+		RTE_VECT_SIMD_128, RTE_VECT_SIMD_256, RTE_VECT_SIMD_512,
+	};
+	static const uint32_t burst_sizes[] = {
+		1, 3, 13, 16, 17, RTE_HASH_LOOKUP_BULK_MAX,
+	};
+	static uint32_t keys[2 * BULK_ENTRIES][4];
+	struct rte_hash_parameters params = {
+		.name = "test_hash_lookup_bulk_simd",
+		.entries = BULK_ENTRIES,
+		.key_len = sizeof(keys[0]),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+	};
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t added[2 * BULK_ENTRIES];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	uint16_t max_simd_bitwidth;
+	struct rte_hash *handle;
+	uint32_t b, i, j, k, n;
+	uint64_t hit_mask;
+	int ret = -1;
+	int hit;
+
+	max_simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+
+	/* Second half of the keys is never added */
+	for (i = 0; i < RTE_DIM(keys); i++) {
+		for (j = 0; j < RTE_DIM(keys[i]); j++)
+			keys[i][j] = rte_rand();
+		added[i] = -ENOENT;
+	}
+
+	for (b = 0; b < RTE_DIM(bitwidths); b++) {
+		if (rte_vect_set_max_simd_bitwidth(bitwidths[b]) != 0) {
+			printf("Cannot set max SIMD bitwidth %u, skipping\n",
+				bitwidths[b]);
+			continue;
+		}
+
+		handle = rte_hash_create(&params);
+		if (handle == NULL) {
+			printf("hash creation failed\n");
+			goto end;
+		}
+
+		/* Positions of the added keys as found by single lookups */
+		for (i = 0; i < BULK_ENTRIES; i++) {
+			rte_hash_add_key_data(handle, keys[i],
+					(void *)(uintptr_t)i);
+			added[i] = rte_hash_lookup(handle, keys[i]);
+		}
+
+		for (k = 0; k < RTE_DIM(burst_sizes); k++) {
+			for (i = 0; i < RTE_DIM(keys); i += n) {
+				n = RTE_MIN(burst_sizes[k], RTE_DIM(keys) - i);
+				for (j = 0; j < n; j++)
+					key_ptrs[j] = keys[i + j];
+
+				rte_hash_lookup_bulk(handle, key_ptrs, n,
+					positions);
+				rte_hash_lookup_bulk_data(handle, key_ptrs, n,
+					&hit_mask, data);
+
+				for (j = 0; j < n; j++) {
+					hit = (hit_mask >> j) & 1;
+					if (positions[j] == added[i + j] &&
+					    hit == (added[i + j] >= 0) &&
+					    (!hit || data[j] ==
+					     (void *)(uintptr_t)(i + j)))
+						continue;
+
+					printf("Bulk lookup of key %u failed "
+						"with max SIMD bitwidth %u\n",
+						i + j, bitwidths[b]);
+					rte_hash_free(handle);
+					goto end;
+				}
+			}
+		}
+
+		rte_hash_free(handle);
+	}
+	ret = 0;
+
+end:
+	rte_vect_set_max_simd_bitwidth(max_simd_bitwidth);
+	return ret;
+}
+
+/*
+ * Add keys to a resizable table far beyond its initial size, checking all
+ * the keys with single and bulk lookups while it is resized, then delete
+ * half of them and reset the table.
+ */
+#define RESIZE_ENTRIES 64
+#define RESIZE_KEYS (256 * RESIZE_ENTRIES)
+static int
+test_hash_resizable(uint32_t extra_flag)
+{
+	static uint32_t keys[RESIZE_KEYS][4];
+	static int32_t added[RESIZE_KEYS];
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resizable",
+		.entries = RESIZE_ENTRIES,
+		.key_len = sizeof(keys[0]),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE | extra_flag,
+	};
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash *handle;
+	const void *next_key;
+	void *next_data;
+	uint32_t i, j, iter = 0;
+	uint64_t hit_mask;
+	int32_t pos;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < RESIZE_KEYS; i++) {
+		for (j = 0; j < RTE_DIM(keys[i]); j++)
+			keys[i][j] = rte_rand();
+		keys[i][0] = i;
+
+		RETURN_IF_ERROR(rte_hash_add_key_data(handle, keys[i],
+				(void *)(uintptr_t)i) != 0,
+				"failed to add key %u", i);
+
+		/* Look up a previous key while the table may be resized */
+		j = rte_rand() % (i + 1);
+		RETURN_IF_ERROR(rte_hash_lookup_data(handle, keys[j],
+				&data[0]) < 0 || data[0] != (void *)(uintptr_t)j,
+				"failed to find key %u after adding %u", j, i);
+	}
+	RETURN_IF_ERROR(rte_hash_count(handle) != RESIZE_KEYS,
+			"wrong count %d", rte_hash_count(handle));
+
+	for (i = 0; i < RESIZE_KEYS; i++) {
+		added[i] = rte_hash_lookup(handle, keys[i]);
+		RETURN_IF_ERROR(added[i] < 0 ||
+				added[i] > rte_hash_max_key_id(handle),
+				"wrong position %d of key %u", added[i], i);
+	}
+
+	for (i = 0; i < RESIZE_KEYS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			key_ptrs[j] = keys[i + j];
+		rte_hash_lookup_bulk(handle, key_ptrs,
+				RTE_HASH_LOOKUP_BULK_MAX, positions);
+		RETURN_IF_ERROR(rte_hash_lookup_bulk_data(handle, key_ptrs,
+				RTE_HASH_LOOKUP_BULK_MAX, &hit_mask, data) !=
+				RTE_HASH_LOOKUP_BULK_MAX,
+				"bulk lookup missed keys from %u", i);
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			RETURN_IF_ERROR(positions[j] != added[i + j] ||
+					data[j] != (void *)(uintptr_t)(i + j),
+					"bulk lookup of key %u failed", i + j);
+	}
+
+	for (i = 0; rte_hash_iterate(handle, &next_key, &next_data,
+			&iter) >= 0; i++)
+		RETURN_IF_ERROR(memcmp(next_key,
+				keys[(uintptr_t)next_data],
+				sizeof(keys[0])) != 0,
+				"iterated key does not match its data");
+	RETURN_IF_ERROR(i != RESIZE_KEYS, "iterated %u keys", i);
+
+	/* Delete even keys */
+	for (i = 0; i < RESIZE_KEYS; i += 2) {
+		pos = rte_hash_del_key(handle, keys[i]);
+		RETURN_IF_ERROR(pos != added[i], "failed to delete key %u", i);
+		if (extra_flag & RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+			RETURN_IF_ERROR(rte_hash_free_key_with_position(
+					handle, pos) != 0,
+					"failed to free key %u", i);
+	}
+	for (i = 0; i < RESIZE_KEYS; i++) {
+		pos = rte_hash_lookup(handle, keys[i]);
+		RETURN_IF_ERROR(pos != (i & 1 ? added[i] : -ENOENT),
+				"wrong lookup of key %u after delete", i);
+	}
+
+	rte_hash_reset(handle);
+	RETURN_IF_ERROR(rte_hash_count(handle) != 0, "reset failed");
+	for (i = 0; i < RESIZE_KEYS; i++)
+		RETURN_IF_ERROR(rte_hash_add_key(handle, keys[i]) < 0,
+				"failed to add key %u after reset", i);
+
+	/*
+	 * Keys added with hash values given by the application, which differ
+	 * from the hash function result, are moved by the resize according
+	 * to their given hash value. Reset keeps the table size, so start
+	 * with a new table.
+	 */
+	rte_hash_free(handle);
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	for (i = 0; i < RESIZE_KEYS; i++) {
+		added[i] = rte_hash_add_key_with_hash(handle, keys[i],
+				i * 0x9E3779B1);
+		RETURN_IF_ERROR(added[i] < 0,
+				"failed to add key %u with hash", i);
+	}
+	RETURN_IF_ERROR(rte_hash_count(handle) != RESIZE_KEYS,
+			"wrong count %d of keys added with hash",
+			rte_hash_count(handle));
+	for (i = 0; i < RESIZE_KEYS; i++)
+		RETURN_IF_ERROR(rte_hash_lookup_with_hash(handle, keys[i],
+				i * 0x9E3779B1) != added[i],
+				"failed to find key %u added with hash", i);
+
+	rte_hash_free(handle);
+	return 0;
+}
+
 static uint8_t key[16] = {0x00, 0x01, 0x02, 0x03,
 			0x04, 0x05, 0x06, 0x07,
 			0x08, 0x09, 0x0a, 0x0b,
@@ -2174,6 +2416,163 @@ test_hash_rcu_qsbr_sync_mode(uint8_t ext_bkt)
 
 }
 
+#define RESIZE_READERS_ENTRIES 64
+#define RESIZE_READERS_KEYS (64 * RESIZE_READERS_ENTRIES)
+
+static uint32_t g_resize_keys[RESIZE_READERS_KEYS][4];
+static uint32_t g_resize_added;
+
+/*
+ * Reader thread looking up the keys added so far to a resizable table,
+ * with single and bulk lookups.
+ */
+static int
+test_hash_resizable_reader(__rte_unused void *arg)
+{
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t i, j, n;
+	uint64_t hit_mask;
+	int ret = 0;
+
+	(void)rte_rcu_qsbr_thread_register(g_qsv, lcore_id);
+	rte_rcu_qsbr_thread_online(g_qsv, lcore_id);
+
+	do {
+		n = __atomic_load_n(&g_resize_added, __ATOMIC_ACQUIRE);
+		for (i = 0; i < n; i++) {
+			if (rte_hash_lookup_data(g_handle, g_resize_keys[i],
+					&data[0]) < 0 ||
+					data[0] != (void *)(uintptr_t)i) {
+				printf("lookup of key %u failed\n", i);
+				ret = -1;
+				goto done;
+			}
+
+			if (i % QSBR_REPORTING_INTERVAL == 0)
+				rte_rcu_qsbr_quiescent(g_qsv, lcore_id);
+		}
+
+		for (i = 0; i + RTE_HASH_LOOKUP_BULK_MAX <= n;
+				i += RTE_HASH_LOOKUP_BULK_MAX) {
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				key_ptrs[j] = g_resize_keys[i + j];
+			if (rte_hash_lookup_bulk_data(g_handle, key_ptrs,
+					RTE_HASH_LOOKUP_BULK_MAX, &hit_mask,
+					data) != RTE_HASH_LOOKUP_BULK_MAX) {
+				printf("bulk lookup from key %u failed\n", i);
+				ret = -1;
+				goto done;
+			}
+		}
+
+		rte_rcu_qsbr_quiescent(g_qsv, lcore_id);
+	} while (!writer_done);
+
+done:
+	rte_rcu_qsbr_thread_offline(g_qsv, lcore_id);
+	(void)rte_rcu_qsbr_thread_unregister(g_qsv, lcore_id);
+	return ret;
+}
+
+/*
+ * Lock free resizable table with concurrent readers.
+ *  - Create a lock free resizable hash with RCU QSBR attached
+ *  - Launch readers on all the worker lcores, looking up the keys added so
+ *    far while the table is resized and rehashed
+ *  - Writer adds keys far beyond the initial table size
+ */
+static int
+test_hash_resizable_readers(enum rte_hash_qsbr_mode mode)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_resizable_readers",
+		.entries = RESIZE_READERS_ENTRIES,
+		.key_len = sizeof(g_resize_keys[0]),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE |
+			RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	struct rte_hash_rcu_config rcu_cfg = {0};
+	unsigned int lcore_id;
+	uint32_t i, j;
+	int32_t status;
+	size_t sz;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for resizable readers test, "
+		       "skipping\n");
+		return 0;
+	}
+
+	printf("\n# Running resizable table test with readers, %s mode\n",
+	       mode == RTE_HASH_QSBR_MODE_SYNC ? "sync" : "defer queue");
+
+	g_qsv = NULL;
+	g_handle = NULL;
+	writer_done = 0;
+	g_resize_added = 0;
+
+	for (i = 0; i < RESIZE_READERS_KEYS; i++) {
+		for (j = 0; j < RTE_DIM(g_resize_keys[i]); j++)
+			g_resize_keys[i][j] = rte_rand();
+		g_resize_keys[i][0] = i;
+	}
+
+	g_handle = rte_hash_create(&params);
+	RETURN_IF_ERROR_RCU_QSBR(g_handle == NULL, "Hash creation failed");
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	g_qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+					RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RETURN_IF_ERROR_RCU_QSBR(g_qsv == NULL,
+				 "RCU QSBR variable creation failed");
+
+	status = rte_rcu_qsbr_init(g_qsv, RTE_MAX_LCORE);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				 "RCU QSBR variable initialization failed");
+
+	rcu_cfg.v = g_qsv;
+	rcu_cfg.mode = mode;
+	status = rte_hash_rcu_qsbr_add(g_handle, &rcu_cfg);
+	RETURN_IF_ERROR_RCU_QSBR(status != 0,
+				 "Attach RCU QSBR to hash table failed");
+
+	/* The error path of the checks below waits for the readers */
+	rcu_cfg.mode = RTE_HASH_QSBR_MODE_SYNC;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		rte_eal_remote_launch(test_hash_resizable_reader, NULL,
+				      lcore_id);
+
+	/* Each resize completes with rte_rcu_qsbr_synchronize() */
+	for (i = 0; i < RESIZE_READERS_KEYS; i++) {
+		status = rte_hash_add_key_data(g_handle, g_resize_keys[i],
+					       (void *)(uintptr_t)i);
+		RETURN_IF_ERROR_RCU_QSBR(status != 0,
+					 "failed to add key %u", i);
+		__atomic_store_n(&g_resize_added, i + 1, __ATOMIC_RELEASE);
+	}
+
+	writer_done = 1;
+	status = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			status = -1;
+	RETURN_IF_ERROR_RCU_QSBR(status != 0, "reader lookup failed");
+	RETURN_IF_ERROR_RCU_QSBR(
+		rte_hash_count(g_handle) != RESIZE_READERS_KEYS,
+		"wrong count %d", rte_hash_count(g_handle));
+
+	rte_hash_free(g_handle);
+	rte_free(g_qsv);
+
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -2230,6 +2629,16 @@ test_hash(void)
 	if (test_hash_iteration(1) < 0)
 		return -1;
 
+	if (test_hash_lookup_bulk_simd() < 0)
+		return -1;
+
+	if (test_hash_resizable(0) < 0)
+		return -1;
+	if (test_hash_resizable(RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY) < 0)
+		return -1;
+	if (test_hash_resizable(RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) < 0)
+		return -1;
+
 	run_hash_func_tests();
 
 	if (test_crc32_hash_alg_equiv() < 0)
@@ -2250,6 +2659,12 @@ test_hash(void)
 	if (test_hash_rcu_qsbr_sync_mode(1) < 0)
 		return -1;
 
+	if (test_hash_resizable_readers(RTE_HASH_QSBR_MODE_DQ) < 0)
+		return -1;
+
+	if (test_hash_resizable_readers(RTE_HASH_QSBR_MODE_SYNC) < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -238,6 +238,192 @@ test_ip_frag(void)
 	return result;
 }
 
+#define REASM_NB_DGRAM 6
+#define REASM_MAX_FRAG 4
+#define REASM_PKT_SIZE 1400
+
+static int
+test_ip_frag_reassemble_burst_ipv(int ipv)
+{
+	struct rte_mbuf *frags[REASM_NB_DGRAM][REASM_MAX_FRAG];
+	struct rte_mbuf *burst[REASM_NB_DGRAM * REASM_MAX_FRAG + 1];
+	struct rte_ip_frag_death_row dr = { .cnt = 0 };
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *b, *plain;
+	uint32_t hdr_len, l3_len;
+	uint16_t i, j, n, nb_pkts;
+	int32_t len, nb_frags;
+
+	if (ipv == 4) {
+		hdr_len = sizeof(struct rte_ipv4_hdr);
+		l3_len = hdr_len;
+		nb_frags = 3;
+	} else {
+		hdr_len = sizeof(struct rte_ipv6_hdr);
+		l3_len = hdr_len + sizeof(struct rte_ipv6_fragment_ext);
+		nb_frags = 2;
+	}
+
+	/* a single bucket with associativity growing from 1 to 8 */
+	tbl = rte_ip_frag_table_create_ext(1, 1, 8, 16, rte_get_tsc_hz(),
+					   SOCKET_ID_ANY);
+	RTE_TEST_ASSERT_NOT_NULL(tbl, "Failed to create table.");
+
+	for (i = 0; i < REASM_NB_DGRAM; i++) {
+		b = rte_pktmbuf_alloc(pkt_pool);
+		RTE_TEST_ASSERT_NOT_NULL(b, "Failed to allocate pkt.");
+
+		if (ipv == 4) {
+			v4_allocate_packet_of(b, 0x41414141, REASM_PKT_SIZE,
+					      0, 64, IPPROTO_ICMP, i);
+			len = rte_ipv4_fragment_packet(b, frags[i],
+						       REASM_MAX_FRAG, 600,
+						       direct_pool,
+						       indirect_pool);
+		} else {
+			v6_allocate_packet_of(b, 0x41414141, REASM_PKT_SIZE,
+					      64, IPPROTO_ICMP, i);
+			len = rte_ipv6_fragment_packet(b, frags[i],
+						       REASM_MAX_FRAG, 1280,
+						       direct_pool,
+						       indirect_pool);
+		}
+		rte_pktmbuf_free(b);
+		RTE_TEST_ASSERT_EQUAL(len, nb_frags,
+				      "Failed to fragment packet %u.", i);
+
+		for (j = 0; j < nb_frags; j++) {
+			frags[i][j]->l2_len = 0;
+			frags[i][j]->l3_len = l3_len;
+			if (ipv == 6) {
+				struct rte_ipv6_fragment_ext *fh;
+
+				fh = rte_pktmbuf_mtod_offset(frags[i][j],
+					struct rte_ipv6_fragment_ext *,
+					hdr_len);
+				fh->id = rte_cpu_to_be_32(i);
+			}
+		}
+	}
+
+	plain = rte_pktmbuf_alloc(pkt_pool);
+	RTE_TEST_ASSERT_NOT_NULL(plain, "Failed to allocate pkt.");
+	if (ipv == 4)
+		v4_allocate_packet_of(plain, 0x41414141, 100, 0, 64,
+				      IPPROTO_ICMP, 0);
+	else
+		v6_allocate_packet_of(plain, 0x41414141, 100, 64,
+				      IPPROTO_ICMP, 0);
+	plain->l2_len = 0;
+	plain->l3_len = hdr_len;
+
+	/* interleave the fragments of all datagrams, last ones first */
+	n = 0;
+	burst[n++] = plain;
+	for (j = 0; j < nb_frags; j++)
+		for (i = 0; i < REASM_NB_DGRAM; i++)
+			burst[n++] = frags[i][nb_frags - 1 - j];
+
+	if (ipv == 4)
+		nb_pkts = rte_ipv4_frag_reassemble_burst(tbl, &dr, burst, n,
+							 rte_rdtsc());
+	else
+		nb_pkts = rte_ipv6_frag_reassemble_burst(tbl, &dr, burst, n,
+							 rte_rdtsc());
+
+	RTE_TEST_ASSERT_EQUAL(dr.cnt, 0, "Unexpected dropped mbufs.");
+	RTE_TEST_ASSERT_EQUAL(nb_pkts, REASM_NB_DGRAM + 1,
+			      "Unexpected number of packets %u.", nb_pkts);
+	RTE_TEST_ASSERT_EQUAL(burst[0], plain, "Plain packet not returned.");
+	for (i = 1; i < nb_pkts; i++)
+		RTE_TEST_ASSERT_EQUAL(burst[i]->pkt_len,
+				      hdr_len + REASM_PKT_SIZE,
+				      "Wrong reassembled length %u.",
+				      burst[i]->pkt_len);
+	RTE_TEST_ASSERT(tbl->bucket_entries > 1,
+			"Table associativity did not grow.");
+	RTE_TEST_ASSERT_EQUAL(tbl->use_entries, 0, "Table not empty.");
+
+	test_free_fragments(burst, nb_pkts);
+	rte_ip_frag_table_destroy(tbl);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ip_frag_reassemble_burst(void)
+{
+	if (test_ip_frag_reassemble_burst_ipv(4) != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	return test_ip_frag_reassemble_burst_ipv(6);
+}
+
+#define REASM_DR_NB_PKTS (2 * IP_FRAG_DEATH_ROW_MBUF_LEN)
+
+/* a burst dropping more mbufs than the death row holds */
+static int
+test_ip_frag_reassemble_burst_death_row(void)
+{
+	struct rte_mbuf *burst[REASM_DR_NB_PKTS];
+	struct rte_ip_frag_death_row dr = { .cnt = 0 };
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_ipv4_hdr *hdr;
+	struct rte_mempool *mp;
+	uint16_t i, nb_pkts;
+	int ret = TEST_FAILED;
+
+	mp = rte_pktmbuf_pool_create("FRAG_DR_POOL", REASM_DR_NB_PKTS, 0, 0,
+				     RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT_NOT_NULL(mp, "Failed to create pool.");
+
+	tbl = rte_ip_frag_table_create(1, 1, 1, rte_get_tsc_hz(),
+				       SOCKET_ID_ANY);
+	if (tbl == NULL) {
+		printf("Failed to create table.\n");
+		goto free_pool;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(mp, burst, RTE_DIM(burst)) != 0) {
+		printf("Failed to allocate pkts.\n");
+		goto free_tbl;
+	}
+
+	/* first fragments without payload, dropped to the death row */
+	for (i = 0; i < RTE_DIM(burst); i++) {
+		v4_allocate_packet_of(burst[i], 0x41414141, 0, 0, 64,
+				      IPPROTO_ICMP, i);
+		hdr = rte_pktmbuf_mtod(burst[i], struct rte_ipv4_hdr *);
+		hdr->fragment_offset = rte_cpu_to_be_16(RTE_IPV4_HDR_MF_FLAG);
+		burst[i]->l2_len = 0;
+		burst[i]->l3_len = sizeof(*hdr);
+	}
+
+	nb_pkts = rte_ipv4_frag_reassemble_burst(tbl, &dr, burst,
+						 RTE_DIM(burst), rte_rdtsc());
+	if (nb_pkts != 0 || dr.cnt == 0 ||
+	    dr.cnt > IP_FRAG_DEATH_ROW_MBUF_LEN) {
+		printf("Unexpected %u packets, %u dropped mbufs.\n",
+		       nb_pkts, dr.cnt);
+		rte_ip_frag_free_death_row(&dr, 0);
+		goto free_tbl;
+	}
+
+	rte_ip_frag_free_death_row(&dr, 0);
+	if (rte_mempool_avail_count(mp) != RTE_DIM(burst)) {
+		printf("Dropped mbufs not freed.\n");
+		goto free_tbl;
+	}
+
+	ret = TEST_SUCCESS;
+
+free_tbl:
+	rte_ip_frag_table_destroy(tbl);
+free_pool:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static struct unit_test_suite ipfrag_testsuite  = {
 	.suite_name = "IP Frag Unit Test Suite",
 	.setup = testsuite_setup,
@@ -245,6 +431,10 @@ static struct unit_test_suite ipfrag_testsuite  = {
 	.unit_test_cases = {
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			     test_ip_frag),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			     test_ip_frag_reassemble_burst),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			     test_ip_frag_reassemble_burst_death_row),
 
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -9,6 +9,7 @@
 #include <rte_ip.h>
 #include <rte_lpm.h>
 #include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "test.h"
 #include "test_xmmt_ops.h"
@@ -44,6 +45,9 @@ static int32_t test18(void);
 static int32_t test19(void);
 static int32_t test20(void);
 static int32_t test21(void);
+static int32_t test22(void);
+static int32_t test23(void);
+static int32_t test24(void);
 
 rte_lpm_test tests[] = {
 /* Test Cases */
@@ -68,7 +72,10 @@ rte_lpm_test tests[] = {
 	test18,
 	test19,
 	test20,
-	test21
+	test21,
+	test22,
+	test23,
+	test24
 };
 
 #define MAX_DEPTH 32
@@ -1563,6 +1570,273 @@ error:
 	return (status == 0) ? PASS : -1;
 }
 
+/*
+ * rte_lpm_add_bulk functional test.
+ *  - Check invalid arguments are rejected without adding anything
+ *  - Add nested prefixes, including a duplicate, in one batch
+ *  - Check lookups return the most specific next hop and that the last
+ *    duplicate wins
+ *  - Check a batch exhausting the tbl8 groups reports ENOSPC
+ */
+int32_t
+test22(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	uint32_t ips[] = {
+		RTE_IPV4(10, 1, 1, 129), RTE_IPV4(10, 0, 0, 0),
+		RTE_IPV4(10, 1, 0, 0), RTE_IPV4(10, 1, 1, 0),
+		RTE_IPV4(10, 1, 1, 128), RTE_IPV4(10, 1, 0, 0),
+	};
+	uint8_t depths[] = { 32, 8, 16, 24, 25, 16 };
+	uint32_t next_hops[] = { 5, 1, 2, 3, 4, 6 };
+	uint8_t bad_depths[] = { 32, 8, 0, 24, 25, 16 };
+	uint32_t next_hop_return;
+	int32_t status;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 1;
+	config.flags = 0;
+
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	status = rte_lpm_add_bulk(NULL, ips, depths, next_hops, RTE_DIM(ips));
+	TEST_LPM_ASSERT(status < 0);
+
+	status = rte_lpm_add_bulk(lpm, ips, bad_depths, next_hops,
+			RTE_DIM(ips));
+	TEST_LPM_ASSERT(status < 0);
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 2, 0, 0), &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	status = rte_lpm_add_bulk(lpm, ips, depths, next_hops, RTE_DIM(ips));
+	TEST_LPM_ASSERT(status == RTE_DIM(ips));
+
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 2, 0, 0), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 1));
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 1, 2, 3), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 6));
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 1, 1, 1), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 3));
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 1, 1, 130), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 4));
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 1, 1, 129), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 5));
+
+	status = rte_lpm_is_rule_present(lpm, RTE_IPV4(10, 1, 0, 0), 16,
+			&next_hop_return);
+	TEST_LPM_ASSERT((status == 1) && (next_hop_return == 6));
+
+	status = rte_lpm_delete(lpm, RTE_IPV4(10, 1, 0, 0), 16);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 1, 2, 3), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 1));
+
+	/* The only tbl8 group is used by 10.1.1.0/24 */
+	ips[0] = RTE_IPV4(10, 3, 0, 1);
+	ips[1] = RTE_IPV4(10, 4, 0, 0);
+	depths[1] = 16;
+	status = rte_lpm_add_bulk(lpm, ips, depths, next_hops, 2);
+	TEST_LPM_ASSERT((status == 1) && (rte_errno == ENOSPC));
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 4, 0, 1), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 1));
+
+	rte_lpm_delete_all(lpm);
+	status = rte_lpm_add_bulk(lpm, ips, depths, next_hops, 2);
+	TEST_LPM_ASSERT(status == 2);
+	status = rte_lpm_lookup(lpm, RTE_IPV4(10, 3, 0, 1), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 5));
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+#define MT_WRITER_ROUTES 64
+
+/*
+ * Writer thread adding and deleting routes of its own /16.
+ */
+static int
+test_lpm_mt_writer(void *arg)
+{
+	uint32_t base = RTE_IPV4(10, (uint8_t)(uintptr_t)arg, 0, 0);
+	uint32_t i, j;
+
+	for (i = 0; i < WRITER_ITERATIONS / 16; i++) {
+		for (j = 0; j < MT_WRITER_ROUTES; j++) {
+			if (rte_lpm_add(g_lpm, base + (j << 8) + 1, 32,
+					j) != 0)
+				return -1;
+			if (rte_lpm_add(g_lpm, base + (j << 8), 24, j) != 0)
+				return -1;
+		}
+		for (j = 0; j < MT_WRITER_ROUTES / 2; j++) {
+			if (rte_lpm_delete(g_lpm, base + (j << 8) + 1, 32) != 0)
+				return -1;
+			if (rte_lpm_delete(g_lpm, base + (j << 8), 24) != 0)
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Multiple writers functional test.
+ *  - Each lcore adds and deletes routes of a different prefix without any
+ *    external locking
+ *  - Check the routes left by every writer are all present afterwards
+ */
+int32_t
+test23(void)
+{
+	struct rte_lpm_config config;
+	uint32_t next_hop_return, base;
+	unsigned int lcore_id, w, nb_writers = 0;
+	int32_t status = 0;
+	uint32_t j;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for %s, expecting at least 2\n",
+			__func__);
+		return TEST_SKIPPED;
+	}
+
+	config.max_rules = RTE_MAX_LCORE * MT_WRITER_ROUTES * 2;
+	config.number_tbl8s = RTE_MAX_LCORE * MT_WRITER_ROUTES;
+	config.flags = 0;
+
+	g_lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(g_lpm != NULL);
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_eal_remote_launch(test_lpm_mt_writer,
+				(void *)(uintptr_t)++nb_writers, lcore_id);
+		if (nb_writers == UINT8_MAX)
+			break;
+	}
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			status = -1;
+	}
+	if (status != 0) {
+		printf("%s: writer failed\n", __func__);
+		goto error;
+	}
+
+	for (w = 1; w <= nb_writers; w++) {
+		base = RTE_IPV4(10, w, 0, 0);
+		for (j = 0; j < MT_WRITER_ROUTES; j++) {
+			status = rte_lpm_lookup(g_lpm, base + (j << 8) + 1,
+					&next_hop_return);
+			if ((j < MT_WRITER_ROUTES / 2 && status != -ENOENT) ||
+					(j >= MT_WRITER_ROUTES / 2 &&
+					(status != 0 || next_hop_return != j))) {
+				printf("%s: wrong lookup for writer %u route %u\n",
+					__func__, w, j);
+				status = -1;
+				goto error;
+			}
+		}
+	}
+	status = 0;
+
+error:
+	rte_lpm_free(g_lpm);
+
+	return (status == 0) ? PASS : -1;
+}
+
+/*
+ * rte_lpm_delete_all with tbl8 groups in the RCU defer queue.
+ *  - Create LPM which supports 2 tbl8 groups at max, in DQ mode
+ *  - Add and delete 2 rules with depth=28 (> 24) while a reader is
+ *    registered, so that their tbl8 groups are left in the defer queue
+ *  - Delete all rules
+ *  - Add 2 rules with depth=28, using both tbl8 groups
+ *  - Check a third rule with depth=28 does not get a tbl8 group in use
+ *    and the 2 rules are still found
+ */
+int32_t
+test24(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	size_t sz;
+	struct rte_rcu_qsbr *qsv;
+	int32_t status;
+	uint32_t i, next_hop_return;
+	uint8_t depth = 28;
+	struct rte_lpm_rcu_config rcu_cfg = {0};
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 2;
+	config.flags = 0;
+
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* Create RCU QSBR variable */
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+				RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	TEST_LPM_ASSERT(qsv != NULL);
+
+	status = rte_rcu_qsbr_init(qsv, 1);
+	TEST_LPM_ASSERT(status == 0);
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_LPM_QSBR_MODE_DQ;
+	/* Attach RCU QSBR to LPM table */
+	status = rte_lpm_rcu_qsbr_add(lpm, &rcu_cfg);
+	TEST_LPM_ASSERT(status == 0);
+
+	for (i = 0; i < 2; i++) {
+		status = rte_lpm_add(lpm, RTE_IPV4(192, 0, i, 100), depth, i);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* Register pseudo reader */
+	status = rte_rcu_qsbr_thread_register(qsv, 0);
+	TEST_LPM_ASSERT(status == 0);
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	/* tbl8 groups cannot be reclaimed until the reader is quiescent */
+	for (i = 0; i < 2; i++) {
+		status = rte_lpm_delete(lpm, RTE_IPV4(192, 0, i, 100), depth);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	status = rte_rcu_qsbr_thread_unregister(qsv, 0);
+	TEST_LPM_ASSERT(status == 0);
+
+	rte_lpm_delete_all(lpm);
+
+	for (i = 0; i < 2; i++) {
+		status = rte_lpm_add(lpm, RTE_IPV4(198, 51, i, 100), depth,
+				i + 1);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	/* Both tbl8 groups are in use */
+	status = rte_lpm_add(lpm, RTE_IPV4(203, 0, 113, 100), depth, 3);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	for (i = 0; i < 2; i++) {
+		status = rte_lpm_lookup(lpm, RTE_IPV4(198, 51, i, 100),
+				&next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == i + 1));
+	}
+
+	rte_lpm_free(lpm);
+	rte_free(qsv);
+
+	return PASS;
+}
+
 /*
  * Do all unit tests.
  */
@@ -22,6 +22,7 @@
 #include <rte_cycles.h>
 #include <rte_random.h>
 #include <rte_string_fns.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -720,6 +721,128 @@ test_random_alloc_free(void *_ __rte_unused)
 	return 0;
 }
 
+#define SLAB_TEST_OBJS 512
+
+static int
+test_slab_alloc_per_lcore(void *arg __rte_unused)
+{
+	static const size_t sizes[] = { 1, 64, 100, 1000, 4096, 5000, 70000 };
+	void *objs[SLAB_TEST_OBJS];
+	size_t size;
+	unsigned int i, j, k;
+	uint8_t val;
+
+	for (k = 0; k < RTE_DIM(sizes); k++) {
+		size = sizes[k];
+		val = (uint8_t)(rte_lcore_id() + k + 1);
+
+		for (i = 0; i < SLAB_TEST_OBJS; i++) {
+			objs[i] = rte_slab_zalloc(size, SOCKET_ID_ANY);
+			if (objs[i] == NULL) {
+				printf("%s: cannot allocate %zu bytes\n",
+					__func__, size);
+				return -1;
+			}
+			if (!is_aligned(objs[i], RTE_CACHE_LINE_MIN_SIZE)) {
+				printf("%s: object not aligned\n", __func__);
+				return -1;
+			}
+			for (j = 0; j < size; j++) {
+				if (((uint8_t *)objs[i])[j] != 0) {
+					printf("%s: object not cleared\n",
+						__func__);
+					return -1;
+				}
+			}
+			memset(objs[i], val, size);
+		}
+
+		/* objects must not overlap each other */
+		for (i = 0; i < SLAB_TEST_OBJS; i++) {
+			for (j = 0; j < size; j++) {
+				if (((uint8_t *)objs[i])[j] != val) {
+					printf("%s: object overwritten\n",
+						__func__);
+					return -1;
+				}
+			}
+		}
+
+		/* free half of the objects and reuse them */
+		for (i = 0; i < SLAB_TEST_OBJS; i += 2)
+			rte_slab_free(objs[i]);
+		for (i = 0; i < SLAB_TEST_OBJS; i += 2) {
+			objs[i] = rte_slab_alloc(size, SOCKET_ID_ANY);
+			if (objs[i] == NULL)
+				return -1;
+			memset(objs[i], val, size);
+		}
+		for (i = 0; i < SLAB_TEST_OBJS; i++) {
+			if (((uint8_t *)objs[i])[size - 1] != val) {
+				printf("%s: object overwritten\n", __func__);
+				return -1;
+			}
+			rte_slab_free(objs[i]);
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_slab_alloc(void)
+{
+	unsigned int lcore_id;
+	unsigned int i;
+	int32_t socket;
+	void *obj;
+	int ret = 0;
+
+	/* bad parameters */
+	rte_errno = 0;
+	if (rte_slab_alloc(0, SOCKET_ID_ANY) != NULL || rte_errno != EINVAL) {
+		printf("%s: zero size allocated\n", __func__);
+		return -1;
+	}
+	rte_errno = 0;
+	if (rte_slab_alloc(64, RTE_MAX_NUMA_NODES) != NULL ||
+			rte_errno != EINVAL) {
+		printf("%s: allocated on invalid socket\n", __func__);
+		return -1;
+	}
+	rte_slab_free(NULL);
+
+	/* explicit sockets bypass the lcore cache */
+	for (i = 0; i < rte_socket_count(); i++) {
+		socket = rte_socket_id_by_idx(i);
+		if (!is_mem_on_socket(socket))
+			continue;
+		obj = rte_slab_alloc(256, socket);
+		if (obj == NULL || addr_to_socket(obj) != socket) {
+			printf("%s: cannot allocate on socket %d\n",
+				__func__, socket);
+			rte_slab_free(obj);
+			return -1;
+		}
+		rte_slab_free(obj);
+	}
+
+	if (test_slab_alloc_per_lcore(NULL) < 0)
+		return -1;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_eal_remote_launch(test_slab_alloc_per_lcore, NULL,
+			lcore_id);
+	}
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+
+	rte_slab_dump(stdout);
+	return ret;
+}
+
 #define err_return() do { \
 	printf("%s: %d - Error\n", __func__, __LINE__); \
 	goto err_return; \
@@ -1077,6 +1200,14 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_slab_alloc();
+	if (ret < 0) {
+		printf("test_slab_alloc() failed\n");
+		return ret;
+	}
+	else
+		printf("test_slab_alloc() passed\n");
+
 	return 0;
 }
 
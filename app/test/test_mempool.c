@@ -208,6 +208,97 @@ static int test_mempool_creation_with_exceeded_cache_size(void)
 	return 0;
 }
 
+/*
+ * Test the peer return and the adaptive sizing of the default caches.
+ * The default caches of two lcores are used from the current lcore,
+ * as user-owned caches.
+ */
+static int
+test_mempool_cache_ctl(void)
+{
+	const unsigned int tx_lcore = 1, rx_lcore = 2;
+	struct rte_mempool_cache *tx, *rx;
+	struct rte_mempool *mp;
+	void *objs[64];
+	unsigned int avail, common, i;
+	int ret = -1;
+
+	mp = rte_mempool_create("test_cache_ctl", MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE, 32, 0, NULL, NULL, my_obj_init, NULL,
+		SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		RET_ERR();
+
+	tx = rte_mempool_default_cache(mp, tx_lcore);
+	rx = rte_mempool_default_cache(mp, rx_lcore);
+
+	if (rte_mempool_cache_peer_set(mp, tx_lcore, tx_lcore) != -EINVAL)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_cache_adapt_set(mp, 16) != -EINVAL)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_cache_adapt_set(mp,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1) != -EINVAL)
+		GOTO_ERR(ret, out);
+
+	/* objects flushed by tx lcore go to rx lcore, not the common pool */
+	if (rte_mempool_cache_peer_set(mp, tx_lcore, rx_lcore) < 0)
+		GOTO_ERR(ret, out);
+	if (rte_mempool_generic_get(mp, objs, RTE_DIM(objs), NULL) < 0)
+		GOTO_ERR(ret, out);
+	avail = rte_mempool_avail_count(mp);
+	common = rte_mempool_ops_get_count(mp);
+
+	rte_mempool_generic_put(mp, objs, RTE_DIM(objs), tx);
+	if (tx->len != tx->size ||
+			rte_mempool_ops_get_count(mp) != common ||
+			rte_mempool_avail_count(mp) != avail + RTE_DIM(objs))
+		GOTO_ERR(ret, out);
+
+	/* rx lcore refills from the returned objects first */
+	if (rte_mempool_generic_get(mp, objs, 8, rx) < 0)
+		GOTO_ERR(ret, out);
+	avail += RTE_DIM(objs) - 8;
+	if (rte_mempool_ops_get_count(mp) != common - 8 ||
+			rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+	rte_mempool_generic_put(mp, objs, 8, rx);
+
+	if (rte_mempool_cache_peer_set(mp, tx_lcore, LCORE_ID_ANY) < 0)
+		GOTO_ERR(ret, out);
+
+	/* rx lcore only gets objects: its cache grows up to the maximum */
+	if (rte_mempool_cache_adapt_set(mp, 256) < 0)
+		GOTO_ERR(ret, out);
+	for (i = 0; i < 10000 && rx->size != 256; i++) {
+		if (rte_mempool_generic_get(mp, objs, 16, rx) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, 16, NULL);
+	}
+	if (rx->size != 256 || tx->size != 32)
+		GOTO_ERR(ret, out);
+	rte_mempool_dump(stdout, mp);
+
+	/* back to the default size on next refill */
+	if (rte_mempool_cache_adapt_set(mp, 0) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_cache_flush(rx, mp);
+	if (rte_mempool_generic_get(mp, objs, 16, rx) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_generic_put(mp, objs, 16, NULL);
+	if (rx->size != 32)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_cache_flush(tx, mp);
+	rte_mempool_cache_flush(rx, mp);
+	if (rte_mempool_avail_count(mp) != mp->size)
+		GOTO_ERR(ret, out);
+
+	ret = 0;
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static struct rte_mempool *mp_spsc;
 static rte_spinlock_t scsp_spinlock;
 static void *scsp_obj_table[MAX_KEEP];
@@ -357,6 +448,79 @@ err:
 	return ret;
 }
 
+/* get objects from an lcore whose shard is empty, and put them back */
+static int
+test_mempool_shard_steal(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	void *obj[MAX_KEEP];
+
+	if (rte_mempool_generic_get(mp, obj, MAX_KEEP, NULL) < 0)
+		RET_ERR();
+	rte_mempool_generic_put(mp, obj, MAX_KEEP, NULL);
+
+	return 0;
+}
+
+/*
+ * it tests a mempool with one shard per lcore: objects are stolen from
+ * the shard of another lcore, then gathered from several shards
+ */
+static int
+test_mempool_shard(void)
+{
+	struct rte_mempool *mp;
+	unsigned int lcores = 1;
+	unsigned int lcore_next;
+	unsigned int size = MEMPOOL_SIZE;
+	void **objtable = NULL;
+	void *obj;
+	int ret = -1;
+
+	lcore_next = rte_get_next_lcore(rte_lcore_id(), 0, 1);
+	if (lcore_next >= RTE_MAX_LCORE)
+		RET_ERR();
+
+	mp = rte_mempool_create_empty("test_mempool_shard", size,
+		MEMPOOL_ELT_SIZE, 0, 0, SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		RET_ERR();
+
+	if (rte_mempool_set_ops_byname(mp, "shard_lcore", &lcores) < 0)
+		GOTO_ERR(ret, err);
+	/* all the objects are put in the shard of the current lcore */
+	if (rte_mempool_populate_default(mp) < 0)
+		GOTO_ERR(ret, err);
+
+	/* the next lcore steals objects and puts them in its own shard */
+	rte_eal_remote_launch(test_mempool_shard_steal, mp, lcore_next);
+	if (rte_eal_wait_lcore(lcore_next) < 0)
+		GOTO_ERR(ret, err);
+	if (rte_mempool_avail_count(mp) != size)
+		GOTO_ERR(ret, err);
+
+	/* no shard holds all the objects, they are gathered from both */
+	objtable = malloc(size * sizeof(void *));
+	if (objtable == NULL)
+		GOTO_ERR(ret, err);
+	if (rte_mempool_generic_get(mp, objtable, size, NULL) < 0)
+		GOTO_ERR(ret, err);
+	if (rte_mempool_avail_count(mp) != 0 ||
+			rte_mempool_generic_get(mp, &obj, 1, NULL) == 0)
+		GOTO_ERR(ret, err);
+
+	rte_mempool_generic_put(mp, objtable, size, NULL);
+	if (rte_mempool_avail_count(mp) != size)
+		GOTO_ERR(ret, err);
+
+	ret = 0;
+
+err:
+	free(objtable);
+	rte_mempool_free(mp);
+	return ret;
+}
+
 /*
  * it tests some more basic of mempool
  */
@@ -485,6 +649,7 @@ test_mempool(void)
 	struct rte_mempool *mp_stack_anon = NULL;
 	struct rte_mempool *mp_stack_mempool_iter = NULL;
 	struct rte_mempool *mp_stack = NULL;
+	struct rte_mempool *mp_shard = NULL;
 	struct rte_mempool *default_pool = NULL;
 	struct mp_data cb_arg = {
 		.ret = -1
@@ -583,6 +748,27 @@ test_mempool(void)
 	}
 	rte_mempool_obj_iter(mp_stack, my_obj_init, NULL);
 
+	/* create a mempool sharded across groups of lcores */
+	mp_shard = rte_mempool_create_empty("test_shard",
+		MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE,
+		RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+		SOCKET_ID_ANY, 0);
+
+	if (mp_shard == NULL) {
+		printf("cannot allocate mp_shard mempool\n");
+		GOTO_ERR(ret, err);
+	}
+	if (rte_mempool_set_ops_byname(mp_shard, "shard_lcore", NULL) < 0) {
+		printf("cannot set shard handler\n");
+		GOTO_ERR(ret, err);
+	}
+	if (rte_mempool_populate_default(mp_shard) < 0) {
+		printf("cannot populate mp_shard mempool\n");
+		GOTO_ERR(ret, err);
+	}
+	rte_mempool_obj_iter(mp_shard, my_obj_init, NULL);
+
 	/* Create a mempool based on Default handler */
 	printf("Testing %s mempool handler\n", default_pool_ops);
 	default_pool = rte_mempool_create_empty("default_pool",
@@ -643,10 +829,22 @@ test_mempool(void)
 	if (test_mempool_same_name_twice_creation() < 0)
 		GOTO_ERR(ret, err);
 
+	/* peer return and adaptive sizing of the default caches */
+	if (test_mempool_cache_ctl() < 0)
+		GOTO_ERR(ret, err);
+
 	/* test the stack handler */
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		GOTO_ERR(ret, err);
 
+	/* test the shard handler */
+	if (test_mempool_basic(mp_shard, 1) < 0)
+		GOTO_ERR(ret, err);
+
+	/* test the steal and gather paths of the shard handler */
+	if (test_mempool_shard() < 0)
+		GOTO_ERR(ret, err);
+
 	if (test_mempool_basic(default_pool, 1) < 0)
 		GOTO_ERR(ret, err);
 
@@ -660,6 +858,7 @@ err:
 	rte_mempool_free(mp_stack_anon);
 	rte_mempool_free(mp_stack_mempool_iter);
 	rte_mempool_free(mp_stack);
+	rte_mempool_free(mp_shard);
 	rte_mempool_free(default_pool);
 
 	return ret;
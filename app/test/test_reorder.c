@@ -59,7 +59,8 @@ test_reorder_init(void)
 	unsigned int size;
 	/*
 	 * The minimum memory area size that should be passed to library is,
-	 * sizeof(struct rte_reorder_buffer) + (2 * size * sizeof(struct rte_mbuf *));
+	 * sizeof(struct rte_reorder_buffer) + per domain state +
+	 * (2 * size * sizeof(struct rte_mbuf *));
 	 * Otherwise error will be thrown
 	 */
 
@@ -303,8 +304,10 @@ test_reorder_drain(void)
 		goto exit;
 	}
 	for (i = 0; i < 3; i++) {
-		if (robufs[i] != NULL)
+		if (robufs[i] != NULL) {
 			rte_pktmbuf_free(robufs[i]);
+			robufs[i] = NULL;
+		}
 	}
 
 	/*
@@ -330,6 +333,203 @@ exit:
 	return ret;
 }
 
+static int
+test_reorder_insert_bulk(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 4;
+	const unsigned int num_bufs = 8;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	struct rte_mbuf *nullbufs[2] = { NULL, NULL };
+	int ret = 0;
+	unsigned int i, cnt;
+
+	for (i = 0; i < num_bufs; i++)
+		bufs[i] = robufs[i] = NULL;
+
+	b = rte_reorder_create_domains("test_insert_bulk", rte_socket_id(),
+			size, 2);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	/* Both domains use the same sequence numbers, out of order */
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+	}
+	*rte_reorder_seqn(bufs[0]) = 0;
+	*rte_reorder_seqn(bufs[1]) = 2;
+	*rte_reorder_seqn(bufs[2]) = 3;
+	*rte_reorder_seqn(bufs[3]) = 1;
+	*rte_reorder_seqn(bufs[4]) = 1;
+	*rte_reorder_seqn(bufs[5]) = 0;
+	*rte_reorder_seqn(bufs[6]) = 1;
+	*rte_reorder_seqn(bufs[7]) = 0;
+
+	cnt = rte_reorder_insert_bulk(b, 2, bufs, 4);
+	if (cnt != 0 || rte_errno != EINVAL) {
+		printf("%s:%d: No error inserting in invalid domain\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	nullbufs[1] = bufs[6];
+	cnt = rte_reorder_insert_bulk(b, 1, nullbufs, 2);
+	if (cnt != 0 || rte_errno != EINVAL) {
+		printf("%s:%d: No error inserting a NULL packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	/*
+	 * Domain 1 starts its window at seqn 1, so seqn 0 is late and
+	 * insertion stops there.
+	 */
+	cnt = rte_reorder_insert_bulk(b, 1, &bufs[4], 2);
+	if (cnt != 1 || rte_errno != ERANGE) {
+		printf("%s:%d: inserted %u of 2 packets\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	bufs[4] = NULL;
+
+	cnt = rte_reorder_insert_bulk(b, 0, bufs, 4);
+	if (cnt != 4) {
+		printf("%s:%d: inserted %u of 4 packets\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	for (i = 0; i < 4; i++)
+		bufs[i] = NULL;
+
+	/* Domain 0 drains in order, domain 1 is unaffected by it */
+	cnt = rte_reorder_drain_timeout(b, 0, robufs, num_bufs, 0);
+	if (cnt != 4) {
+		printf("%s:%d:%u: number of expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (*rte_reorder_seqn(robufs[i]) != i) {
+			printf("%s:%d: packet %u drained out of order\n",
+					__func__, __LINE__, i);
+			ret = -1;
+			goto exit;
+		}
+		rte_pktmbuf_free(robufs[i]);
+		robufs[i] = NULL;
+	}
+
+	/* seqn 1 is now behind the domain 0 window */
+	cnt = rte_reorder_insert_bulk(b, 0, &bufs[6], 1);
+	if (cnt != 0 || rte_errno != ERANGE) {
+		printf("%s:%d: No error inserting late packet\n",
+				__func__, __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	cnt = rte_reorder_drain_timeout(b, 1, robufs, num_bufs, 0);
+	if (cnt != 1 || *rte_reorder_seqn(robufs[0]) != 1) {
+		printf("%s:%d:%u: number of expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
+static int
+test_reorder_drain_timeout(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = 4;
+	const uint64_t timeout = rte_get_timer_hz() / 1000;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	int ret = 0;
+	unsigned int i, cnt;
+
+	for (i = 0; i < num_bufs; i++)
+		bufs[i] = robufs[i] = NULL;
+
+	b = rte_reorder_create("test_drain_timeout", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	/* seqn 0, 1, 3, 4: 2 never arrives */
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		*rte_reorder_seqn(bufs[i]) = i < 2 ? i : i + 1;
+	}
+	cnt = rte_reorder_insert_bulk(b, 0, bufs, num_bufs);
+	if (cnt != num_bufs) {
+		printf("%s:%d: inserted %u of %u packets\n",
+				__func__, __LINE__, cnt, num_bufs);
+		ret = -1;
+		goto exit;
+	}
+	for (i = 0; i < num_bufs; i++)
+		bufs[i] = NULL;
+
+	/* First call stops at the gap and starts timing it */
+	cnt = rte_reorder_drain_timeout(b, 0, robufs, num_bufs, timeout);
+	if (cnt != 2) {
+		printf("%s:%d:%u: number of expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	/* The gap has not timed out yet */
+	cnt = rte_reorder_drain_timeout(b, 0, &robufs[2], num_bufs - 2,
+			timeout);
+	if (cnt != 0) {
+		printf("%s:%d:%u: gap skipped before timeout\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	rte_delay_ms(2);
+	cnt = rte_reorder_drain_timeout(b, 0, &robufs[2], num_bufs - 2,
+			timeout);
+	if (cnt != 2 || *rte_reorder_seqn(robufs[2]) != 3 ||
+			*rte_reorder_seqn(robufs[3]) != 4) {
+		printf("%s:%d:%u: gap not skipped after timeout\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -380,6 +580,8 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_insert_bulk),
+		TEST_CASE(test_reorder_drain_timeout),
 		TEST_CASES_END()
 	}
 };
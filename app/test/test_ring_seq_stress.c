@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+/* the slot sequence numbers are set up by rte_ring_create_elem() only */
+#define _ST_RING_CREATE
+
+#include "test_ring_stress_impl.h"
+
+#include <rte_errno.h>
+
+/*
+ * A slot claimed by another thread but not handed over yet is seen as
+ * empty (or full), so the bulk operations can fail while the elements are
+ * in flight: retry until they are handed over.
+ */
+static inline uint32_t
+_st_ring_dequeue_bulk(struct rte_ring *r, void **obj, uint32_t n,
+	uint32_t *avail)
+{
+	uint32_t k;
+
+	while ((k = rte_ring_mc_seq_dequeue_bulk(r, obj, n, avail)) == 0)
+		rte_pause();
+	return k;
+}
+
+static inline uint32_t
+_st_ring_enqueue_bulk(struct rte_ring *r, void * const *obj, uint32_t n,
+	uint32_t *free)
+{
+	uint32_t k;
+
+	while ((k = rte_ring_mp_seq_enqueue_bulk(r, obj, n, free)) == 0)
+		rte_pause();
+	return k;
+}
+
+static int
+_st_ring_create(struct rte_ring **rng, const char *name, uint32_t num)
+{
+	struct rte_ring *r;
+
+	*rng = NULL;
+
+	r = rte_ring_create_elem(name, sizeof(void *), num, SOCKET_ID_ANY,
+		RING_F_MP_SEQ_ENQ | RING_F_MC_SEQ_DEQ);
+	if (r == NULL) {
+		printf("%s: rte_ring_create_elem(%s, %u) failed, "
+			"error: %d(%s)\n",
+			__func__, name, num, rte_errno,
+			strerror(rte_errno));
+		return -(rte_errno ? rte_errno : ENOMEM);
+	}
+
+	*rng = r;
+	return 0;
+}
+
+static void
+_st_ring_free(struct rte_ring *r)
+{
+	rte_ring_free(r);
+}
+
+const struct test test_ring_seq_stress = {
+	.name = "MT_SEQ",
+	.nb_case = RTE_DIM(tests),
+	.cases = tests,
+};
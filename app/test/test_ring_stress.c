@@ -46,6 +46,9 @@ test_ring_stress(void)
 	n += test_ring_hts_stress.nb_case;
 	k += run_test(&test_ring_hts_stress);
 
+	n += test_ring_seq_stress.nb_case;
+	k += run_test(&test_ring_seq_stress);
+
 	n += test_ring_mt_peek_stress.nb_case;
 	k += run_test(&test_ring_mt_peek_stress);
 
@@ -59,9 +59,56 @@ static uint32_t
 _st_ring_enqueue_bulk(struct rte_ring *r, void * const *obj, uint32_t n,
 	uint32_t *free);
 
+/*
+ * By default, the ring is set up by _st_ring_init() in memory allocated by
+ * the test. Sync modes which cannot be set up that way define
+ * _ST_RING_CREATE and provide _st_ring_create() and _st_ring_free() instead.
+ */
+#ifndef _ST_RING_CREATE
 static int
 _st_ring_init(struct rte_ring *r, const char *name, uint32_t num);
 
+static int
+_st_ring_create(struct rte_ring **rng, const char *name, uint32_t num)
+{
+	int32_t rc;
+	size_t sz;
+	struct rte_ring *r;
+
+	*rng = NULL;
+
+	sz = rte_ring_get_memsize(num);
+	r = rte_zmalloc(NULL, sz, __alignof__(*r));
+	if (r == NULL) {
+		printf("%s: alloc(%zu) for FIFO with %u elems failed",
+			__func__, sz, num);
+		return -ENOMEM;
+	}
+
+	rc = _st_ring_init(r, name, num);
+	if (rc != 0) {
+		printf("%s: _st_ring_init(%p, %u) failed, error: %d(%s)\n",
+			__func__, r, num, rc, strerror(-rc));
+		rte_free(r);
+		return rc;
+	}
+
+	*rng = r;
+	return 0;
+}
+
+static void
+_st_ring_free(struct rte_ring *r)
+{
+	rte_free(r);
+}
+#else
+static int
+_st_ring_create(struct rte_ring **rng, const char *name, uint32_t num);
+
+static void
+_st_ring_free(struct rte_ring *r);
+#endif
 
 static void
 lcore_stat_update(struct lcore_stat *ls, uint64_t call, uint64_t obj,
@@ -265,7 +312,7 @@ test_worker_avg(void *arg)
 static void
 mt1_fini(struct rte_ring *rng, void *data)
 {
-	rte_free(rng);
+	_st_ring_free(rng);
 	rte_free(data);
 }
 
@@ -294,23 +341,12 @@ mt1_init(struct rte_ring **rng, void **data, uint32_t num)
 
 	/* alloc ring */
 	nr = 2 * num;
-	sz = rte_ring_get_memsize(nr);
-	r = rte_zmalloc(NULL, sz, __alignof__(*r));
-	if (r == NULL) {
-		printf("%s: alloc(%zu) for FIFO with %u elems failed",
-			__func__, sz, nr);
-		return -ENOMEM;
-	}
+	rc = _st_ring_create(&r, RING_NAME, nr);
+	if (rc != 0)
+		return rc;
 
 	*rng = r;
 
-	rc = _st_ring_init(r, RING_NAME, nr);
-	if (rc != 0) {
-		printf("%s: _st_ring_init(%p, %u) failed, error: %d(%s)\n",
-			__func__, r, nr, rc, strerror(-rc));
-		return rc;
-	}
-
 	for (i = 0; i != num; i++) {
 		fill_ring_elm(elm + i, UINT32_MAX);
 		p = elm + i;
@@ -12,6 +12,8 @@
 
 #include <rte_cycles.h>
 #include <rte_ether.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
 #include <rte_sched.h>
@@ -37,6 +39,35 @@ static struct rte_sched_pipe_params pipe_profile[] = {
 	},
 };
 
+#define BE_QUEUES_32Q    20
+
+static struct rte_sched_pipe_params pipe_profile_32q[] = {
+	{ /* Profile #0, 20 best-effort queues */
+		.tb_rate = 305175,
+		.tb_size = 1000000,
+
+		.tc_rate = {305175, 305175, 305175, 305175, 305175, 305175,
+			305175, 305175, 305175, 305175, 305175, 305175, 305175},
+		.tc_period = 40,
+		.tc_ov_weight = 1,
+
+		.wrr_weights = {1, 1, 1, 1},
+	},
+};
+
+static struct rte_sched_pipe_topology topology_32q = {
+	.n_queues_per_pipe = 32,
+	.n_be_queues_per_pipe = BE_QUEUES_32Q,
+};
+
+/* Costs approximated, as the least common multiple is 3003 */
+static const uint8_t wrr_weights_32q[] = {1, 3, 7, 11, 13, 1, 3, 7, 11, 13,
+	1, 3, 7, 11, 13, 1, 3, 7, 11, 13};
+
+/* Costs of 19 and 20 no longer told apart once approximated */
+static const uint8_t wrr_weights_32q_bad[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 19, 20};
+
 static struct rte_sched_subport_profile_params
 		subport_profile[] = {
 	{
@@ -71,7 +102,7 @@ static struct rte_sched_port_params port_param = {
 	.n_pipes_per_subport = 1024,
 };
 
-#define NB_MBUF          32
+#define NB_MBUF          256
 #define MBUF_DATA_SZ     (2048 + RTE_PKTMBUF_HEADROOM)
 #define MEMPOOL_CACHE_SZ 0
 #define SOCKET           0
@@ -123,6 +154,413 @@ prepare_pkt(struct rte_sched_port *port, struct rte_mbuf *mbuf)
 }
 
 
+/* Pipes with 32 queues, 20 of them for the best-effort traffic class */
+static int
+test_sched_32q(struct rte_mempool *mp)
+{
+	struct rte_sched_subport_params subport_32q = subport_param[0];
+	struct rte_sched_port_params port_32q = port_param;
+	struct rte_mbuf *in_mbufs[10];
+	struct rte_mbuf *out_mbufs[10];
+	struct rte_sched_port *port;
+	uint32_t pipe;
+	int i, err;
+
+	subport_32q.pipe_profiles = pipe_profile_32q;
+
+	port = rte_sched_port_config_topology(&port_32q, &topology_32q);
+	TEST_ASSERT_NOT_NULL(port, "Error config 32 queues sched port\n");
+
+	err = rte_sched_subport_config(port, SUBPORT, &subport_32q, 0);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	err = rte_sched_subport_pipe_profile_wrr_set(port, SUBPORT, 0,
+		wrr_weights_32q_bad);
+	TEST_ASSERT_EQUAL(err, -EINVAL, "Wrong wrr weights set, err=%d\n", err);
+
+	err = rte_sched_subport_pipe_profile_wrr_set(port, SUBPORT, 0,
+		wrr_weights_32q);
+	TEST_ASSERT_SUCCESS(err, "Error wrr weights set, err=%d\n", err);
+
+	for (pipe = 0; pipe < subport_32q.n_pipes_per_subport_enabled; pipe++) {
+		err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n",
+			pipe, err);
+	}
+
+	/* Spread over the strict priority tcs and the last best-effort queues */
+	for (i = 0; i < 10; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(port, in_mbufs[i], SUBPORT, PIPE,
+			i < 5 ? i : RTE_SCHED_TRAFFIC_CLASS_BE,
+			i < 5 ? 0 : BE_QUEUES_32Q - 10 + i, RTE_COLOR_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong dequeue, err=%d\n", err);
+
+	for (i = 0; i < 10; i++) {
+		uint32_t subport, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(port, out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+
+		TEST_ASSERT_EQUAL(subport, SUBPORT, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+		if (i < 5) {
+			TEST_ASSERT_EQUAL(traffic_class, (uint32_t)i,
+				"Wrong traffic_class\n");
+			continue;
+		}
+		TEST_ASSERT_EQUAL(traffic_class, RTE_SCHED_TRAFFIC_CLASS_BE,
+			"Wrong traffic_class\n");
+		TEST_ASSERT(queue >= BE_QUEUES_32Q - 5 &&
+			queue < BE_QUEUES_32Q, "Wrong queue\n");
+	}
+	rte_pktmbuf_free_bulk(out_mbufs, 10);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define N_SUBPORTS_PART     2
+#define PART_RING_SIZE      256
+#define MT_WORKERS_MAX      4
+#define MT_PKTS_PER_WORKER  32
+#define MT_BURST            8
+#define MT_DEQ_TRIES        1000
+#define SHAPER_PKTS         100
+/* packet of one MTU, frame overhead included */
+#define SHAPER_PKT_LEN      (1522 - RTE_SCHED_FRAME_OVERHEAD_DEFAULT)
+/* line rate credit saved up by an idle partitioned port, in MTUs */
+#define SHAPER_BURST_MTUS   64
+
+static struct rte_sched_pipe_params pipe_profile_shaper[] = {
+	{ /* Profile #0, not limiting a 10 MB/s port */
+		.tb_rate = 10000000,
+		.tb_size = 1000000,
+
+		.tc_rate = {10000000, 10000000, 10000000, 10000000, 10000000,
+			10000000, 10000000, 10000000, 10000000, 10000000,
+			10000000, 10000000, 10000000},
+		.tc_period = 1000,
+		.tc_ov_weight = 1,
+
+		.wrr_weights = {1, 1, 1, 1},
+	},
+};
+
+static struct rte_sched_subport_profile_params subport_profile_shaper[] = {
+	{
+		.tb_rate = 10000000,
+		.tb_size = 1000000,
+		.tc_rate = {10000000, 10000000, 10000000, 10000000, 10000000,
+			10000000, 10000000, 10000000, 10000000, 10000000,
+			10000000, 10000000, 10000000},
+		.tc_period = 1000,
+	},
+};
+
+static struct rte_sched_port *mt_port;
+static struct rte_mempool *mt_mp;
+static uint32_t mt_workers_done;
+
+/* Port with all its subports and pipes configured */
+static struct rte_sched_port *
+config_port(struct rte_sched_port_params *params,
+	struct rte_sched_subport_params *subport)
+{
+	struct rte_sched_port *port;
+	uint32_t i, pipe;
+
+	port = rte_sched_port_config(params);
+	if (port == NULL)
+		return NULL;
+
+	for (i = 0; i < params->n_subports_per_port; i++) {
+		if (rte_sched_subport_config(port, i, subport, 0) != 0)
+			goto error;
+
+		for (pipe = 0; pipe < subport->n_pipes_per_subport_enabled;
+				pipe++) {
+			if (rte_sched_pipe_config(port, i, pipe, 0) != 0)
+				goto error;
+		}
+	}
+
+	return port;
+
+error:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+/* Worker handing bursts of packets to the partition, one pipe each */
+static int
+test_sched_enqueue_mt_worker(void *arg __rte_unused)
+{
+	struct rte_mbuf *mbufs[MT_BURST];
+	uint32_t n_pipes = subport_param[0].n_pipes_per_subport_enabled;
+	uint32_t pipe = rte_lcore_index(rte_lcore_id()) * MT_PKTS_PER_WORKER;
+	uint32_t i, j;
+	int ret = 0;
+
+	for (i = 0; i < MT_PKTS_PER_WORKER; i += MT_BURST) {
+		if (rte_pktmbuf_alloc_bulk(mt_mp, mbufs, MT_BURST) != 0) {
+			ret = -1;
+			break;
+		}
+
+		for (j = 0; j < MT_BURST; j++) {
+			rte_sched_port_pkt_write(mt_port, mbufs[j], SUBPORT,
+				pipe++ % n_pipes, TC, QUEUE, RTE_COLOR_GREEN);
+			mbufs[j]->pkt_len = 60;
+			mbufs[j]->data_len = 60;
+		}
+
+		if (rte_sched_port_enqueue_mt(mt_port, mbufs, MT_BURST) !=
+				MT_BURST) {
+			ret = -1;
+			break;
+		}
+	}
+
+	__atomic_fetch_add(&mt_workers_done, 1, __ATOMIC_RELEASE);
+	return ret;
+}
+
+/* Workers enqueue to a partition while it is dequeued */
+static int
+test_sched_enqueue_mt(struct rte_mempool *mp)
+{
+	struct rte_mbuf *out_mbufs[MT_BURST];
+	struct rte_sched_port *part;
+	uint32_t n_workers = 0, n_pkts = 0, tries = 0;
+	uint32_t subport, pipe, traffic_class, queue;
+	unsigned int lcore_id;
+	int i, n, ret = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for %s, expecting at least 2\n",
+			__func__);
+		return 0;
+	}
+
+	mt_mp = mp;
+	mt_port = config_port(&port_param, subport_param);
+	TEST_ASSERT_NOT_NULL(mt_port, "Error config sched port\n");
+
+	part = rte_sched_port_partition_create(mt_port, SUBPORT, 1,
+		PART_RING_SIZE);
+	TEST_ASSERT_NOT_NULL(part, "Error creating sched partition\n");
+
+	mt_workers_done = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_eal_remote_launch(test_sched_enqueue_mt_worker, NULL,
+			lcore_id);
+		if (++n_workers == MT_WORKERS_MAX)
+			break;
+	}
+
+	/* Dequeue while the workers run, then until the partition is empty */
+	while (n_pkts < n_workers * MT_PKTS_PER_WORKER &&
+			tries < MT_DEQ_TRIES) {
+		if (__atomic_load_n(&mt_workers_done, __ATOMIC_ACQUIRE) ==
+				n_workers)
+			tries++;
+
+		n = rte_sched_port_dequeue(part, out_mbufs, MT_BURST);
+		for (i = 0; i < n; i++) {
+			rte_sched_port_pkt_read_tree_path(mt_port,
+				out_mbufs[i], &subport, &pipe,
+				&traffic_class, &queue);
+			if (subport != SUBPORT || traffic_class != TC)
+				ret = -1;
+		}
+		rte_pktmbuf_free_bulk(out_mbufs, n);
+		n_pkts += n;
+	}
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+
+	rte_sched_port_partition_free(part);
+	rte_sched_port_free(mt_port);
+
+	TEST_ASSERT_SUCCESS(ret, "Wrong mt enqueue\n");
+	TEST_ASSERT_EQUAL(n_pkts, n_workers * MT_PKTS_PER_WORKER,
+		"Wrong number of packets dequeued: %u\n", n_pkts);
+
+	return 0;
+}
+
+/* Each partition dequeues the packets of its own subports only */
+static int
+test_sched_partitions(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params port_part = port_param;
+	struct rte_sched_port *part[N_SUBPORTS_PART];
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[10];
+	struct rte_mbuf *out_mbufs[10];
+	uint32_t subport, pipe, traffic_class, queue;
+	int i, err;
+
+	port_part.n_subports_per_port = N_SUBPORTS_PART;
+	port = config_port(&port_part, subport_param);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	TEST_ASSERT_NULL(rte_sched_port_partition_create(port, 0,
+		N_SUBPORTS_PART + 1, PART_RING_SIZE),
+		"Partition created beyond the last subport\n");
+
+	for (i = 0; i < N_SUBPORTS_PART; i++) {
+		part[i] = rte_sched_port_partition_create(port, i, 1,
+			PART_RING_SIZE);
+		TEST_ASSERT_NOT_NULL(part[i],
+			"Error creating sched partition %d\n", i);
+	}
+	TEST_ASSERT_NULL(rte_sched_port_partition_create(part[0], 0, 1,
+		PART_RING_SIZE), "Partition of a partition created\n");
+
+	/* Interleave the packets of both subports */
+	for (i = 0; i < 10; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(port, in_mbufs[i], i % N_SUBPORTS_PART,
+			PIPE, TC, QUEUE, RTE_COLOR_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue_mt(port, in_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong mt enqueue, err=%d\n", err);
+
+	for (i = 0; i < N_SUBPORTS_PART; i++) {
+		int j;
+
+		err = rte_sched_port_dequeue(part[i], out_mbufs, 10);
+		TEST_ASSERT_EQUAL(err, 10 / N_SUBPORTS_PART,
+			"Wrong partition %d dequeue, err=%d\n", i, err);
+
+		for (j = 0; j < err; j++) {
+			rte_sched_port_pkt_read_tree_path(port, out_mbufs[j],
+				&subport, &pipe, &traffic_class, &queue);
+			TEST_ASSERT_EQUAL(subport, (uint32_t)i,
+				"Wrong subport\n");
+		}
+		rte_pktmbuf_free_bulk(out_mbufs, err);
+	}
+
+	/* Packets of a subport without a partition are dropped */
+	rte_sched_port_partition_free(part[1]);
+	for (i = 0; i < 2; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(port, in_mbufs[i], i, PIPE, TC, QUEUE,
+			RTE_COLOR_GREEN);
+	}
+
+	err = rte_sched_port_enqueue_mt(port, in_mbufs, 2);
+	TEST_ASSERT_EQUAL(err, 1, "Wrong mt enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(part[0], out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 1, "Wrong partition dequeue, err=%d\n", err);
+	rte_pktmbuf_free_bulk(out_mbufs, err);
+
+	rte_sched_port_partition_free(part[0]);
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+/* The partitions together do not send more than the port credit */
+static int
+test_sched_shared_shaper(struct rte_mempool *mp)
+{
+	struct rte_sched_subport_params subport_shaper = subport_param[0];
+	struct rte_sched_port_params port_shaper = port_param;
+	struct rte_sched_port *part[N_SUBPORTS_PART];
+	struct rte_mbuf *mbufs[SHAPER_PKTS];
+	struct rte_sched_port *port;
+	uint32_t n_pkts = 0, ms;
+	int i, j, err;
+
+	port_shaper.rate = 10000000;
+	port_shaper.n_subports_per_port = N_SUBPORTS_PART;
+	port_shaper.subport_profiles = subport_profile_shaper;
+	subport_shaper.pipe_profiles = pipe_profile_shaper;
+
+	port = config_port(&port_shaper, &subport_shaper);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	for (i = 0; i < N_SUBPORTS_PART; i++) {
+		part[i] = rte_sched_port_partition_create(port, i, 1,
+			PART_RING_SIZE);
+		TEST_ASSERT_NOT_NULL(part[i],
+			"Error creating sched partition %d\n", i);
+	}
+
+	/*
+	 * Let the port save up its whole idle credit, dequeuing from the
+	 * empty partitions every millisecond to keep their time current.
+	 */
+	for (ms = 0; ms < 2 * SHAPER_BURST_MTUS * port_shaper.mtu * 1000 /
+			port_shaper.rate; ms++) {
+		rte_delay_ms(1);
+		for (i = 0; i < N_SUBPORTS_PART; i++) {
+			err = rte_sched_port_dequeue(part[i], mbufs, 1);
+			TEST_ASSERT_EQUAL(err, 0,
+				"Wrong partition dequeue, err=%d\n", err);
+		}
+	}
+
+	/* Each partition gets more packets than the port credit */
+	for (i = 0; i < N_SUBPORTS_PART; i++) {
+		err = rte_pktmbuf_alloc_bulk(mp, mbufs, SHAPER_PKTS);
+		TEST_ASSERT_SUCCESS(err, "Packet allocation failed\n");
+
+		for (j = 0; j < SHAPER_PKTS; j++) {
+			rte_sched_port_pkt_write(port, mbufs[j], i, PIPE,
+				j % RTE_SCHED_TRAFFIC_CLASS_BE, QUEUE,
+				RTE_COLOR_GREEN);
+			mbufs[j]->pkt_len = SHAPER_PKT_LEN;
+			mbufs[j]->data_len = 60;
+		}
+
+		err = rte_sched_port_enqueue_mt(port, mbufs, SHAPER_PKTS);
+		TEST_ASSERT_EQUAL(err, SHAPER_PKTS,
+			"Wrong mt enqueue, err=%d\n", err);
+	}
+
+	for (i = 0; i < N_SUBPORTS_PART; i++) {
+		err = rte_sched_port_dequeue(part[i], mbufs, SHAPER_PKTS);
+		rte_pktmbuf_free_bulk(mbufs, err);
+		n_pkts += err;
+	}
+
+	/* Allow the credit earned during the test and one packet more */
+	TEST_ASSERT(n_pkts >= SHAPER_BURST_MTUS / 2 &&
+		n_pkts <= SHAPER_BURST_MTUS + 8,
+		"Wrong number of packets sent by the partitions: %u\n",
+		n_pkts);
+
+	for (i = 0; i < N_SUBPORTS_PART; i++)
+		rte_sched_port_partition_free(part[i]);
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -131,6 +569,7 @@ test_sched(void)
 {
 	struct rte_mempool *mp = NULL;
 	struct rte_sched_port *port = NULL;
+	struct rte_sched_port *part;
 	uint32_t pipe;
 	struct rte_mbuf *in_mbufs[10];
 	struct rte_mbuf *out_mbufs[10];
@@ -199,9 +638,52 @@ test_sched(void)
 	TEST_ASSERT_EQUAL(queue_stats.n_pkts, 10, "Wrong queue stats\n");
 #endif
 
+	/* Same traffic through a partition fed by the multi-thread enqueue */
+	rte_pktmbuf_free_bulk(out_mbufs, 10);
+
+	part = rte_sched_port_partition_create(port, SUBPORT, 1, 64);
+	TEST_ASSERT_NOT_NULL(part, "Error creating sched partition\n");
+	TEST_ASSERT_NULL(rte_sched_port_partition_create(port, SUBPORT, 1, 64),
+		"Subport added to two partitions\n");
+
+	for (i = 0; i < 10; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		prepare_pkt(port, in_mbufs[i]);
+	}
+
+	err = rte_sched_port_enqueue_mt(port, in_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong mt enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(part, out_mbufs, 10);
+	TEST_ASSERT_EQUAL(err, 10, "Wrong partition dequeue, err=%d\n", err);
+
+	for (i = 0; i < 10; i++) {
+		uint32_t subport, traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(port, out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		TEST_ASSERT_EQUAL(subport, SUBPORT, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+	}
+	rte_pktmbuf_free_bulk(out_mbufs, 10);
+
+	rte_sched_port_partition_free(part);
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_enqueue_mt(mp);
+	if (err != 0)
+		return err;
+
+	err = test_sched_partitions(mp);
+	if (err != 0)
+		return err;
+
+	err = test_sched_shared_shaper(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_32q(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
@@ -0,0 +1,434 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_random.h>
+#include <rte_swx_port.h>
+#include <rte_swx_pipeline.h>
+
+#include "test.h"
+
+/*
+ * Run the same packets through the interpreter and through the code
+ * generated by rte_swx_pipeline_codegen() and compare the results.
+ *
+ * The generated code is built with the system C compiler, using the
+ * flags from the SWX_CODEGEN_CFLAGS environment variable, or the ones
+ * reported by pkg-config for libdpdk. The test is skipped when the
+ * generated code cannot be built.
+ */
+
+#define TEST_PKTS		256
+#define TEST_PKT_SIZE		256
+#define TEST_PKT_HEADROOM	64
+#define TEST_PORTS_OUT		4
+#define TEST_RUN_MAX		(TEST_PKTS * 64)
+#define TEST_CC_FMT		"cc -O2 -fPIC -shared %s -o %s %s"
+
+static const char test_spec[] =
+	"struct ethernet_h {\n"
+	"	bit<48> dst_addr\n"
+	"	bit<48> src_addr\n"
+	"	bit<16> ether_type\n"
+	"}\n"
+	"struct ipv4_h {\n"
+	"	bit<8> ver_ihl\n"
+	"	bit<8> diffserv\n"
+	"	bit<16> total_len\n"
+	"	bit<16> identification\n"
+	"	bit<16> flags_offset\n"
+	"	bit<8> ttl\n"
+	"	bit<8> protocol\n"
+	"	bit<16> hdr_checksum\n"
+	"	bit<32> src_addr\n"
+	"	bit<32> dst_addr\n"
+	"}\n"
+	"header ethernet instanceof ethernet_h\n"
+	"header ipv4 instanceof ipv4_h\n"
+	"struct metadata_t {\n"
+	"	bit<32> port\n"
+	"	bit<48> addr\n"
+	"}\n"
+	"metadata instanceof metadata_t\n"
+	"action macswp args none {\n"
+	"	mov m.addr h.ethernet.dst_addr\n"
+	"	mov h.ethernet.dst_addr h.ethernet.src_addr\n"
+	"	mov h.ethernet.src_addr m.addr\n"
+	"	xor m.port 2\n"
+	"	return\n"
+	"}\n"
+	"table stub {\n"
+	"	key {\n"
+	"	}\n"
+	"	actions {\n"
+	"		macswp\n"
+	"	}\n"
+	"	default_action macswp args none const\n"
+	"}\n"
+	"apply {\n"
+	"	rx m.port\n"
+	"	extract h.ethernet\n"
+	"	jmpneq L2 h.ethernet.ether_type 0x0800\n"
+	"	extract h.ipv4\n"
+	"	sub h.ipv4.ttl 1\n"
+	"	add h.ipv4.identification h.ipv4.total_len\n"
+	"	add m.port h.ipv4.protocol\n"
+	"	jmplt L3 h.ipv4.ttl 0x40\n"
+	"	or h.ipv4.diffserv 0x80\n"
+	"	L3 : cksub h.ipv4.hdr_checksum h.ipv4.ttl\n"
+	"	L2 : table stub\n"
+	"	and m.port 3\n"
+	"	emit h.ethernet\n"
+	"	emit h.ipv4\n"
+	"	tx m.port\n"
+	"}\n";
+
+struct test_pkt {
+	uint8_t buf[TEST_PKT_SIZE];
+	uint32_t len;
+	uint32_t port;
+};
+
+/* input port, returns the packets one by one */
+struct test_port_in {
+	struct test_pkt *pkts;
+	uint32_t n_pkts;
+	uint32_t pos;
+};
+
+/* output port, records the packets sent */
+struct test_port_out {
+	struct test_pkt *pkts;
+	uint32_t *n_pkts;
+	uint32_t id;
+};
+
+struct test_pipeline {
+	struct rte_swx_pipeline *p;
+	struct test_port_in in;
+	struct test_port_out out[TEST_PORTS_OUT];
+	struct test_pkt pkts_in[TEST_PKTS];
+	struct test_pkt pkts[TEST_PKTS];
+	uint32_t n_pkts;
+};
+
+static struct test_pkt test_pkts_in[TEST_PKTS];
+
+static void *
+test_port_create(void *args)
+{
+	return args;
+}
+
+static void
+test_port_free(void *port __rte_unused)
+{
+}
+
+static int
+test_port_rx(void *port, struct rte_swx_pkt *pkt)
+{
+	struct test_port_in *in = port;
+	struct test_pkt *tp;
+
+	if (in->pos == in->n_pkts)
+		return 0;
+
+	tp = &in->pkts[in->pos++];
+	pkt->handle = tp;
+	pkt->pkt = tp->buf;
+	pkt->offset = TEST_PKT_HEADROOM;
+	pkt->length = tp->len;
+	return 1;
+}
+
+static void
+test_port_in_stats(void *port __rte_unused,
+	struct rte_swx_port_in_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
+
+static void
+test_port_tx(void *port, struct rte_swx_pkt *pkt)
+{
+	struct test_port_out *out = port;
+	struct test_pkt *tp;
+
+	tp = &out->pkts[(*out->n_pkts)++];
+	memcpy(tp->buf, pkt->pkt + pkt->offset, pkt->length);
+	tp->len = pkt->length;
+	tp->port = out->id;
+}
+
+static void
+test_port_out_stats(void *port __rte_unused,
+	struct rte_swx_port_out_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
+
+static struct rte_swx_port_in_ops test_port_in_ops = {
+	.create = test_port_create,
+	.free = test_port_free,
+	.pkt_rx = test_port_rx,
+	.stats_read = test_port_in_stats,
+};
+
+static struct rte_swx_port_out_ops test_port_out_ops = {
+	.create = test_port_create,
+	.free = test_port_free,
+	.pkt_tx = test_port_tx,
+	.stats_read = test_port_out_stats,
+};
+
+static void
+test_pkts_init(void)
+{
+	uint32_t i, j;
+	struct test_pkt *tp;
+
+	for (i = 0; i != RTE_DIM(test_pkts_in); i++) {
+		tp = &test_pkts_in[i];
+		for (j = 0; j != sizeof(tp->buf); j++)
+			tp->buf[j] = rte_rand();
+
+		/* ethernet + ipv4 headers at least */
+		tp->len = 34 + rte_rand() % 64;
+
+		/* every other packet is IPv4 */
+		if ((i & 1) == 0) {
+			tp->buf[TEST_PKT_HEADROOM + 12] = 0x08;
+			tp->buf[TEST_PKT_HEADROOM + 13] = 0x00;
+		}
+	}
+}
+
+static int
+test_pipeline_create(struct test_pipeline *tp, const char *spec_str)
+{
+	FILE *spec;
+	uint32_t i, err_line;
+	const char *err_msg;
+	int status;
+
+	memset(tp, 0, sizeof(*tp));
+	tp->in.pkts = tp->pkts_in;
+
+	status = rte_swx_pipeline_config(&tp->p, 0);
+	if (status)
+		return status;
+
+	status = rte_swx_pipeline_port_in_type_register(tp->p, "test",
+		&test_port_in_ops);
+	if (!status)
+		status = rte_swx_pipeline_port_out_type_register(tp->p,
+			"test", &test_port_out_ops);
+	if (!status)
+		status = rte_swx_pipeline_port_in_config(tp->p, 0, "test",
+			&tp->in);
+
+	for (i = 0; i != TEST_PORTS_OUT && !status; i++) {
+		tp->out[i].pkts = tp->pkts;
+		tp->out[i].n_pkts = &tp->n_pkts;
+		tp->out[i].id = i;
+		status = rte_swx_pipeline_port_out_config(tp->p, i, "test",
+			&tp->out[i]);
+	}
+
+	if (status)
+		return status;
+
+	spec = fmemopen((void *)(uintptr_t)spec_str, strlen(spec_str), "r");
+	if (spec == NULL)
+		return -errno;
+
+	status = rte_swx_pipeline_build_from_spec(tp->p, spec, &err_line,
+		&err_msg);
+	fclose(spec);
+	if (status)
+		printf("%s: error %d at line %u: %s\n",
+			__func__, status, err_line, err_msg);
+
+	return status;
+}
+
+/* run all the input packets through the pipeline */
+static int
+test_pipeline_run(struct test_pipeline *tp)
+{
+	uint32_t i;
+
+	/* packets are modified in place, so start with a fresh copy */
+	memcpy(tp->pkts_in, test_pkts_in, sizeof(tp->pkts_in));
+	tp->in.n_pkts = TEST_PKTS;
+	tp->in.pos = 0;
+	tp->n_pkts = 0;
+
+	for (i = 0; i != TEST_RUN_MAX && tp->n_pkts != TEST_PKTS; i++)
+		rte_swx_pipeline_run(tp->p, 1);
+
+	if (tp->n_pkts != TEST_PKTS) {
+		printf("%s: %u packets out of %u were sent\n",
+			__func__, tp->n_pkts, TEST_PKTS);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_codegen_build(struct test_pipeline *tp, const char *src,
+	const char *lib)
+{
+	FILE *f;
+	int status, len;
+	char *cmd;
+	const char *cflags;
+
+	f = fopen(src, "w");
+	if (f == NULL)
+		return -errno;
+
+	status = rte_swx_pipeline_codegen(tp->p, f);
+	fclose(f);
+	if (status) {
+		printf("%s: code generation failed: %d\n", __func__, status);
+		return status;
+	}
+
+	cflags = getenv("SWX_CODEGEN_CFLAGS");
+	if (cflags == NULL)
+		cflags = "$(pkg-config --cflags libdpdk)";
+
+	len = snprintf(NULL, 0, TEST_CC_FMT, cflags, lib, src);
+	cmd = malloc(len + 1);
+	if (cmd == NULL)
+		return -ENOMEM;
+
+	snprintf(cmd, len + 1, TEST_CC_FMT, cflags, lib, src);
+	status = system(cmd);
+	free(cmd);
+	if (status != 0) {
+		printf("%s: cannot build the generated code, "
+			"set SWX_CODEGEN_CFLAGS to the DPDK build flags\n",
+			__func__);
+		return TEST_SKIPPED;
+	}
+
+	return 0;
+}
+
+/*
+ * Code generated for another pipeline with the same instructions,
+ * but different operands, must not be loaded.
+ */
+static int
+test_codegen_stale(const char *lib)
+{
+	static struct test_pipeline stale;
+	static char spec[sizeof(test_spec)];
+	char *op;
+	int status;
+
+	memcpy(spec, test_spec, sizeof(spec));
+	op = strstr(spec, "sub h.ipv4.ttl 1");
+	op[strlen("sub h.ipv4.ttl ")] = '2';
+
+	status = test_pipeline_create(&stale, spec);
+	if (status) {
+		printf("%s: pipeline create failed: %d\n", __func__, status);
+		status = TEST_FAILED;
+	} else if (rte_swx_pipeline_codegen_load(stale.p, lib) != -EINVAL) {
+		printf("%s: code generated for another pipeline is loaded\n",
+			__func__);
+		status = TEST_FAILED;
+	}
+
+	rte_swx_pipeline_free(stale.p);
+	return status;
+}
+
+static int
+test_swx_pipeline_codegen(void)
+{
+	static struct test_pipeline ref, gen;
+	char src[64], lib[64];
+	uint32_t i;
+	int status;
+
+	test_pkts_init();
+
+	status = test_pipeline_create(&ref, test_spec);
+	if (!status)
+		status = test_pipeline_create(&gen, test_spec);
+	if (status) {
+		printf("%s: pipeline create failed: %d\n", __func__, status);
+		status = TEST_FAILED;
+		goto free;
+	}
+
+	snprintf(src, sizeof(src), "/tmp/test_swx_codegen_%d.c", getpid());
+	snprintf(lib, sizeof(lib), "/tmp/test_swx_codegen_%d.so", getpid());
+
+	status = test_codegen_build(&gen, src, lib);
+	if (status) {
+		if (status != TEST_SKIPPED)
+			status = TEST_FAILED;
+		goto free;
+	}
+
+	status = test_codegen_stale(lib);
+	if (status)
+		goto free;
+
+	status = rte_swx_pipeline_codegen_load(gen.p, lib);
+	if (status) {
+		printf("%s: cannot load the generated code: %d\n",
+			__func__, status);
+		status = TEST_FAILED;
+		goto free;
+	}
+
+	/* code can be loaded only once */
+	if (rte_swx_pipeline_codegen_load(gen.p, lib) != -EEXIST) {
+		printf("%s: generated code is loaded twice\n", __func__);
+		status = TEST_FAILED;
+		goto free;
+	}
+
+	if (test_pipeline_run(&ref) != 0 || test_pipeline_run(&gen) != 0) {
+		status = TEST_FAILED;
+		goto free;
+	}
+
+	for (i = 0; i != TEST_PKTS; i++) {
+		if (ref.pkts[i].port != gen.pkts[i].port ||
+				ref.pkts[i].len != gen.pkts[i].len ||
+				memcmp(ref.pkts[i].buf, gen.pkts[i].buf,
+				ref.pkts[i].len) != 0) {
+			printf("%s: packet %u differs from interpreted one\n",
+				__func__, i);
+			status = TEST_FAILED;
+			break;
+		}
+	}
+
+free:
+	rte_swx_pipeline_free(gen.p);
+	rte_swx_pipeline_free(ref.p);
+	unlink(lib);
+	unlink(src);
+	return status;
+}
+
+REGISTER_TEST_COMMAND(swx_pipeline_codegen_autotest,
+	test_swx_pipeline_codegen);
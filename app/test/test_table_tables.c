@@ -4,7 +4,10 @@
 
 #include <string.h>
 #include <rte_byteorder.h>
+#include <rte_ip.h>
 #include <rte_table_lpm_ipv6.h>
+#include <rte_swx_table_wm.h>
+#include <rte_swx_table_lpm.h>
 #include <rte_lru.h>
 #include <rte_cycles.h>
 #include "test_table_tables.h"
@@ -18,6 +21,8 @@ table_test table_tests[] = {
 	test_table_hash_lru,
 	test_table_hash_ext,
 	test_table_hash_cuckoo,
+	test_table_swx_wm,
+	test_table_swx_lpm,
 };
 
 #define PREPARE_PACKET(mbuf, value) do {				\
@@ -1051,3 +1056,381 @@ test_table_hash_cuckoo(void)
 
 	return 0;
 }
+
+/* SWX table lookup, resumed until the lookup completes */
+static int
+swx_table_lookup(struct rte_swx_table_ops *ops, void *table, void *mailbox,
+	uint8_t *key, uint64_t *action_id, uint64_t *action_data)
+{
+	uint8_t *data;
+	int hit;
+
+	while (!ops->lkp(table, mailbox, &key, action_id, &data, &hit))
+		;
+
+	if (hit)
+		memcpy(action_data, data, sizeof(*action_data));
+	return hit;
+}
+
+int
+test_table_swx_wm(void)
+{
+	struct rte_swx_table_ops *ops = &rte_swx_table_wildcard_match_ops;
+	struct rte_swx_table_entry_list entries;
+	struct rte_swx_table_entry entry[3];
+	uint8_t key[3][8], key_mask[3][8], lkp_key[8];
+	uint64_t data[3], action_id, action_data;
+	void *table, *mailbox;
+	uint32_t i;
+
+	struct rte_swx_table_params params = {
+		.match_type = RTE_SWX_TABLE_MATCH_WILDCARD,
+		.key_size = sizeof(key[0]),
+		.key_offset = 0,
+		.key_mask0 = NULL,
+		.action_data_size = sizeof(data[0]),
+		.n_keys_max = 16,
+	};
+
+	/* Create */
+	table = ops->create(NULL, NULL, NULL, 0);
+	if (table != NULL)
+		return -1;
+
+	params.match_type = RTE_SWX_TABLE_MATCH_LPM;
+	table = ops->create(&params, NULL, NULL, 0);
+	if (table != NULL)
+		return -2;
+
+	params.match_type = RTE_SWX_TABLE_MATCH_WILDCARD;
+	if (ops->footprint_get(&params, NULL, NULL) == 0)
+		return -3;
+
+	mailbox = calloc(1, ops->mailbox_size_get());
+	if (mailbox == NULL)
+		return -4;
+
+	/* Empty table */
+	table = ops->create(&params, NULL, NULL, 0);
+	if (table == NULL)
+		return -5;
+
+	memset(lkp_key, 0, sizeof(lkp_key));
+	if (swx_table_lookup(ops, table, mailbox, lkp_key, &action_id,
+			&action_data) != 0)
+		return -6;
+
+	ops->free(table);
+
+	/*
+	 * Overlapping entries:
+	 * 0: 10.*.*, priority 2;
+	 * 1: 10.1.*, priority 1;
+	 * 2: 10.1.*, priority 3, hidden by entry 1.
+	 */
+	memset(key, 0, sizeof(key));
+	memset(key_mask, 0, sizeof(key_mask));
+	TAILQ_INIT(&entries);
+	for (i = 0; i != RTE_DIM(entry); i++) {
+		key[i][0] = 10;
+		key_mask[i][0] = 0xFF;
+		if (i != 0) {
+			key[i][1] = 1;
+			key_mask[i][1] = 0xFF;
+		}
+		data[i] = 0x100 + i;
+
+		memset(&entry[i], 0, sizeof(entry[i]));
+		entry[i].key = key[i];
+		entry[i].key_mask = key_mask[i];
+		entry[i].key_priority = (i == 0) ? 2 : 2 * i - 1;
+		entry[i].action_id = i;
+		entry[i].action_data = (uint8_t *)&data[i];
+		TAILQ_INSERT_TAIL(&entries, &entry[i], node);
+	}
+
+	params.n_keys_max = RTE_DIM(entry) - 1;
+	table = ops->create(&params, &entries, NULL, 0);
+	if (table != NULL)
+		return -7;
+
+	params.n_keys_max = 16;
+	table = ops->create(&params, &entries, NULL, 0);
+	if (table == NULL)
+		return -8;
+
+	/* Traffic flow */
+	lkp_key[0] = 10;
+	lkp_key[1] = 1;
+	lkp_key[7] = 0xAD;
+	if (swx_table_lookup(ops, table, mailbox, lkp_key, &action_id,
+			&action_data) != 1 ||
+			action_id != 1 || action_data != data[1])
+		return -9;
+
+	lkp_key[1] = 2;
+	if (swx_table_lookup(ops, table, mailbox, lkp_key, &action_id,
+			&action_data) != 1 ||
+			action_id != 0 || action_data != data[0])
+		return -10;
+
+	lkp_key[0] = 11;
+	if (swx_table_lookup(ops, table, mailbox, lkp_key, &action_id,
+			&action_data) != 0)
+		return -11;
+
+	ops->free(table);
+
+	/* Lowest priority value wins regardless of the entry order */
+	entry[0].key_priority = 5;
+	entry[1].key_priority = 4;
+	table = ops->create(&params, &entries, NULL, 0);
+	if (table == NULL)
+		return -12;
+
+	lkp_key[0] = 10;
+	lkp_key[1] = 1;
+	if (swx_table_lookup(ops, table, mailbox, lkp_key, &action_id,
+			&action_data) != 1 ||
+			action_id != 2 || action_data != data[2])
+		return -13;
+
+	ops->free(table);
+	free(mailbox);
+
+	return 0;
+}
+
+static int
+swx_table_lpm_route_add(struct rte_swx_table_ops *ops, void *table,
+	uint32_t ip, uint32_t depth, uint64_t action_id, uint64_t *data)
+{
+	struct rte_swx_table_entry entry;
+	uint32_t key, key_mask;
+
+	key = rte_cpu_to_be_32(ip);
+	key_mask = rte_cpu_to_be_32(depth ? UINT32_MAX << (32 - depth) : 0);
+
+	memset(&entry, 0, sizeof(entry));
+	entry.key = (uint8_t *)&key;
+	entry.key_mask = (uint8_t *)&key_mask;
+	entry.action_id = action_id;
+	entry.action_data = (uint8_t *)data;
+
+	return ops->add(table, &entry);
+}
+
+static int
+swx_table_lpm_route_del(struct rte_swx_table_ops *ops, void *table,
+	uint32_t ip, uint32_t depth)
+{
+	struct rte_swx_table_entry entry;
+	uint32_t key, key_mask;
+
+	key = rte_cpu_to_be_32(ip);
+	key_mask = rte_cpu_to_be_32(depth ? UINT32_MAX << (32 - depth) : 0);
+
+	memset(&entry, 0, sizeof(entry));
+	entry.key = (uint8_t *)&key;
+	entry.key_mask = (uint8_t *)&key_mask;
+
+	return ops->del(table, &entry);
+}
+
+static int
+swx_table_lpm_lookup(struct rte_swx_table_ops *ops, void *table,
+	void *mailbox, uint32_t ip, uint64_t *action_id)
+{
+	uint64_t action_data;
+	uint32_t key;
+
+	key = rte_cpu_to_be_32(ip);
+	if (!swx_table_lookup(ops, table, mailbox, (uint8_t *)&key,
+			action_id, &action_data))
+		return 0;
+
+	return action_data == *action_id + 0x100;
+}
+
+int
+test_table_swx_lpm(void)
+{
+	struct rte_swx_table_ops *ops = &rte_swx_table_longest_prefix_match_ops;
+	struct rte_swx_table_entry entry;
+	uint8_t key6[16], key_mask6[16];
+	uint64_t data[8], action_id, action_data;
+	uint32_t key, key_mask, i;
+	void *table, *mailbox;
+	int status;
+
+	struct rte_swx_table_params params = {
+		.match_type = RTE_SWX_TABLE_MATCH_LPM,
+		.key_size = 5,
+		.key_offset = 0,
+		.key_mask0 = NULL,
+		.action_data_size = sizeof(data[0]),
+		.n_keys_max = 4,
+	};
+
+	for (i = 0; i != RTE_DIM(data); i++)
+		data[i] = 0x100 + i;
+
+	/* Create */
+	table = ops->create(NULL, NULL, NULL, 0);
+	if (table != NULL)
+		return -1;
+
+	table = ops->create(&params, NULL, NULL, 0);
+	if (table != NULL)
+		return -2;
+
+	params.key_size = sizeof(key);
+	table = ops->create(&params, NULL, "num_tbl8 0", 0);
+	if (table != NULL)
+		return -3;
+
+	table = ops->create(&params, NULL, "n_tbl8 16", 0);
+	if (table != NULL)
+		return -4;
+
+	if (ops->footprint_get(&params, NULL, "num_tbl8 16") == 0)
+		return -5;
+
+	table = ops->create(&params, NULL, "num_tbl8 16", 0);
+	if (table == NULL)
+		return -6;
+
+	mailbox = calloc(1, ops->mailbox_size_get());
+	if (mailbox == NULL)
+		return -7;
+
+	/* Add */
+	status = swx_table_lpm_route_add(ops, table, RTE_IPV4(10, 0, 0, 0), 8,
+		1, &data[1]);
+	status |= swx_table_lpm_route_add(ops, table, RTE_IPV4(10, 1, 0, 0),
+		16, 2, &data[2]);
+	status |= swx_table_lpm_route_add(ops, table, RTE_IPV4(10, 1, 1, 128),
+		25, 3, &data[3]);
+	if (status != 0)
+		return -8;
+
+	/* key mask has to be a prefix mask */
+	key = rte_cpu_to_be_32(RTE_IPV4(10, 2, 0, 0));
+	key_mask = rte_cpu_to_be_32(0xFF00FF00);
+	memset(&entry, 0, sizeof(entry));
+	entry.key = (uint8_t *)&key;
+	entry.key_mask = (uint8_t *)&key_mask;
+	entry.action_data = (uint8_t *)&data[0];
+	if (ops->add(table, &entry) != -EINVAL)
+		return -9;
+
+	/* Traffic flow */
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 1, 1, 200), &action_id) != 1 ||
+			action_id != 3)
+		return -10;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 1, 1, 1), &action_id) != 1 ||
+			action_id != 2)
+		return -11;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 2, 0, 1), &action_id) != 1 ||
+			action_id != 1)
+		return -12;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(11, 1, 1, 1), &action_id) != 0)
+		return -13;
+
+	/* Modify in place, doesn't take a new entry */
+	if (swx_table_lpm_route_add(ops, table, RTE_IPV4(10, 1, 0, 0), 16,
+			4, &data[4]) != 0)
+		return -14;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 1, 1, 1), &action_id) != 1 ||
+			action_id != 4)
+		return -15;
+
+	/* Table full */
+	if (swx_table_lpm_route_add(ops, table, RTE_IPV4(0, 0, 0, 0), 0,
+			5, &data[5]) != 0)
+		return -16;
+
+	if (swx_table_lpm_route_add(ops, table, RTE_IPV4(192, 168, 0, 0), 16,
+			6, &data[6]) != -ENOSPC)
+		return -17;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(11, 1, 1, 1), &action_id) != 1 ||
+			action_id != 5)
+		return -18;
+
+	/* Delete */
+	if (swx_table_lpm_route_del(ops, table, RTE_IPV4(10, 1, 0, 0), 16) != 0)
+		return -19;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 1, 1, 1), &action_id) != 1 ||
+			action_id != 1)
+		return -20;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(10, 1, 1, 200), &action_id) != 1 ||
+			action_id != 3)
+		return -21;
+
+	/* deleted entry is reused */
+	if (swx_table_lpm_route_add(ops, table, RTE_IPV4(192, 168, 0, 0), 16,
+			6, &data[6]) != 0)
+		return -22;
+
+	if (swx_table_lpm_lookup(ops, table, mailbox,
+			RTE_IPV4(192, 168, 3, 4), &action_id) != 1 ||
+			action_id != 6)
+		return -23;
+
+	ops->free(table);
+
+	/* IPv6 */
+	params.key_size = sizeof(key6);
+	table = ops->create(&params, NULL, "num_tbl8 64", 0);
+	if (table == NULL)
+		return -24;
+
+	/* 2001:db8::/32 */
+	memset(key6, 0, sizeof(key6));
+	memset(key_mask6, 0, sizeof(key_mask6));
+	key6[0] = 0x20;
+	key6[1] = 0x01;
+	key6[2] = 0x0d;
+	key6[3] = 0xb8;
+	memset(key_mask6, 0xFF, 4);
+
+	memset(&entry, 0, sizeof(entry));
+	entry.key = key6;
+	entry.key_mask = key_mask6;
+	entry.action_id = 7;
+	entry.action_data = (uint8_t *)&data[7];
+	if (ops->add(table, &entry) != 0)
+		return -25;
+
+	key6[15] = 1;
+	if (swx_table_lookup(ops, table, mailbox, key6, &action_id,
+			&action_data) != 1 ||
+			action_id != 7 || action_data != data[7])
+		return -26;
+
+	key6[3] = 0xb9;
+	if (swx_table_lookup(ops, table, mailbox, key6, &action_id,
+			&action_data) != 0)
+		return -27;
+
+	ops->free(table);
+	free(mailbox);
+
+	return 0;
+}
@@ -14,6 +14,8 @@ int test_table_hash_unoptimized(void);
 int test_table_hash_lru(void);
 int test_table_hash_ext(void);
 int test_table_stub(void);
+int test_table_swx_wm(void);
+int test_table_swx_lpm(void);
 
 /* Extern variables */
 typedef int (*table_test)(void);
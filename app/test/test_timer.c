@@ -83,6 +83,19 @@
  *      - At initialization, timer3 is loaded by the main core, on
  *        another core in "periodical" mode (time = 1 second).
  *      - It is stopped at t=25s by timer2.
+ *
+ * #. Timer wheel test.
+ *
+ *    This test checks the timer wheel backend allocated with
+ *    rte_timer_data_alloc_wheel() on the main core.
+ *
+ *    - A set of single timers is loaded with random expiry times spanning
+ *      several wheel levels, and some of them are stopped.
+ *    - One periodical timer is loaded.
+ *    - rte_timer_alt_manage() is called until all the single timers have
+ *      expired, checking that no timer expires before its expiry time,
+ *      that stopped timers never expire, and that the periodical timer
+ *      expires several times.
  */
 
 #include <stdio.h>
@@ -91,6 +104,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <errno.h>
 #include <sys/queue.h>
 #include <math.h>
 
@@ -532,6 +546,110 @@ timer_sanity_check(void)
 	return 0;
 }
 
+#define WHEEL_NB_TIMER 1024
+#define WHEEL_PERIOD_US 1000
+
+struct wheel_timer {
+	struct rte_timer tim;
+	unsigned int count;
+	int stopped;
+};
+
+static struct wheel_timer wheel_timers[WHEEL_NB_TIMER + 1];
+static unsigned int wheel_expired;
+static int wheel_early;
+
+/* timer callback for the timer wheel test */
+static void
+timer_wheel_cb(struct rte_timer *tim)
+{
+	struct wheel_timer *wt = tim->arg;
+
+	if (rte_get_timer_cycles() < tim->expire)
+		wheel_early = 1;
+	wt->count++;
+	if (tim->period == 0)
+		wheel_expired++;
+}
+
+static int
+test_timer_wheel(void)
+{
+	struct wheel_timer *periodic = &wheel_timers[WHEEL_NB_TIMER];
+	unsigned int lcore_id = rte_lcore_id();
+	unsigned int i, nb_stopped = 0;
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t timeout;
+	uint32_t id;
+	int ret;
+
+	printf("\nStart timer wheel tests\n");
+
+	ret = rte_timer_data_alloc_wheel(&id, hz / 100000);
+	if (ret == -ENOSPC) {
+		printf("No timer data instance left, skipping\n");
+		return TEST_SUCCESS;
+	}
+	if (ret != 0) {
+		printf("Cannot allocate timer wheel: %d\n", ret);
+		return TEST_FAILED;
+	}
+
+	memset(wheel_timers, 0, sizeof(wheel_timers));
+	wheel_expired = 0;
+	wheel_early = 0;
+
+	/* expiry times up to 50ms, biased towards the short ones */
+	for (i = 0; i < WHEEL_NB_TIMER; i++) {
+		uint64_t ticks = rte_rand_max(hz / 20 >> (i & 7)) + 1;
+
+		rte_timer_init(&wheel_timers[i].tim);
+		rte_timer_alt_reset(id, &wheel_timers[i].tim, ticks, SINGLE,
+				    lcore_id, NULL, &wheel_timers[i]);
+	}
+	rte_timer_init(&periodic->tim);
+	rte_timer_alt_reset(id, &periodic->tim, hz * WHEEL_PERIOD_US / 1000000,
+			    PERIODICAL, lcore_id, NULL, periodic);
+
+	for (i = 0; i < WHEEL_NB_TIMER; i += 3) {
+		if (rte_timer_alt_stop(id, &wheel_timers[i].tim) == 0) {
+			wheel_timers[i].stopped = 1;
+			nb_stopped++;
+		}
+	}
+
+	timeout = rte_get_timer_cycles() + hz;
+	while (wheel_expired + nb_stopped < WHEEL_NB_TIMER &&
+	       rte_get_timer_cycles() < timeout)
+		rte_timer_alt_manage(id, &lcore_id, 1, timer_wheel_cb);
+
+	rte_timer_stop_all(id, &lcore_id, 1, NULL, NULL);
+	rte_timer_data_dealloc(id);
+
+	if (wheel_early) {
+		printf("Timer expired before its expiry time\n");
+		return TEST_FAILED;
+	}
+	if (wheel_expired + nb_stopped != WHEEL_NB_TIMER) {
+		printf("Only %u timers out of %u expired\n",
+		       wheel_expired, WHEEL_NB_TIMER - nb_stopped);
+		return TEST_FAILED;
+	}
+	for (i = 0; i < WHEEL_NB_TIMER; i++) {
+		if (wheel_timers[i].count != !wheel_timers[i].stopped) {
+			printf("Timer %u expired %u times\n", i,
+			       wheel_timers[i].count);
+			return TEST_FAILED;
+		}
+	}
+	if (periodic->count < 2) {
+		printf("Periodical timer expired %u times\n", periodic->count);
+		return TEST_FAILED;
+	}
+
+	return TEST_SUCCESS;
+}
+
 static int
 test_timer(void)
 {
@@ -595,6 +713,9 @@ test_timer(void)
 
 	rte_timer_dump_stats(stdout);
 
+	if (test_timer_wheel() != TEST_SUCCESS)
+		return TEST_FAILED;
+
 	return TEST_SUCCESS;
 }
 
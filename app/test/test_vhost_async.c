@@ -0,0 +1,391 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_vhost.h>
+#include <rte_vhost_async.h>
+
+#include "test.h"
+
+/*
+ * Async dequeue on a split virtqueue. A virtio-user port of this process
+ * plays the guest and transmits through the vhost-user socket, the host
+ * drains the guest Tx queue with the async dequeue API. The copies are
+ * done by a software engine which only reports them completed when the
+ * test releases them.
+ */
+
+#define VIRTIO_USER_NAME	"net_virtio_user_async"
+#define VIRTIO_TXQ		1
+#define NB_MBUF			2048
+#define RING_SIZE		256
+#define NB_PKTS			8
+#define DMA_LEN			1024
+#define CPU_LEN			64
+#define ASYNC_THRESHOLD		256
+#define ENGINE_MAX_SEGS		8
+#define WAIT_MS			5000
+
+/* even packets are copied by the engine, odd ones by the CPU */
+#define PKT_LEN(i)		((i) & 1 ? CPU_LEN : DMA_LEN)
+#define PKT_BYTE(i)		(0xa0 + (i))
+
+struct engine_job {
+	unsigned long nr_segs;
+	struct iovec src[ENGINE_MAX_SEGS];
+	struct iovec dst[ENGINE_MAX_SEGS];
+};
+
+static struct {
+	struct engine_job jobs[NB_PKTS];
+	/* next job to complete */
+	uint32_t head;
+	/* next free job */
+	uint32_t tail;
+	/* number of packets accepted in flight */
+	uint32_t capacity;
+	/* number of completions the engine may still report */
+	uint32_t released;
+	int error;
+} engine;
+
+static struct rte_mempool *mp;
+static char sock_path[PATH_MAX];
+static uint16_t port_id = RTE_MAX_ETHPORTS;
+static volatile int vhost_vid = -1;
+
+static void *
+engine_iova_to_va(void *iova)
+{
+	if (rte_eal_iova_mode() == RTE_IOVA_VA)
+		return iova;
+	return rte_mem_iova2virt((rte_iova_t)(uintptr_t)iova);
+}
+
+static uint32_t
+engine_transfer_data(int vid, uint16_t queue_id,
+		struct rte_vhost_async_desc *descs,
+		struct rte_vhost_async_status *opaque_data, uint16_t count)
+{
+	struct rte_vhost_iov_iter *src, *dst;
+	struct engine_job *job;
+	unsigned long s;
+	uint16_t i;
+
+	RTE_SET_USED(vid);
+	RTE_SET_USED(queue_id);
+
+	if (opaque_data != NULL)
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		src = descs[i].src;
+		dst = descs[i].dst;
+		if (engine.tail - engine.head >= engine.capacity ||
+				src->nr_segs > ENGINE_MAX_SEGS)
+			break;
+
+		job = &engine.jobs[engine.tail % NB_PKTS];
+		job->nr_segs = src->nr_segs;
+		for (s = 0; s < src->nr_segs; s++) {
+			job->src[s].iov_base = RTE_PTR_ADD(
+				src->iov[s].iov_base, src->offset);
+			job->src[s].iov_len = src->iov[s].iov_len;
+			job->dst[s].iov_base = RTE_PTR_ADD(
+				dst->iov[s].iov_base, dst->offset);
+		}
+		engine.tail++;
+	}
+
+	return i;
+}
+
+static uint32_t
+engine_check_completed_copies(int vid, uint16_t queue_id,
+		struct rte_vhost_async_status *opaque_data,
+		uint16_t max_packets)
+{
+	struct engine_job *job;
+	void *src, *dst;
+	uint32_t n = 0;
+	unsigned long s;
+
+	RTE_SET_USED(vid);
+	RTE_SET_USED(queue_id);
+
+	if (opaque_data != NULL)
+		return 0;
+
+	while (n < max_packets && engine.released > 0 &&
+			engine.head != engine.tail) {
+		job = &engine.jobs[engine.head % NB_PKTS];
+		for (s = 0; s < job->nr_segs; s++) {
+			src = engine_iova_to_va(job->src[s].iov_base);
+			dst = engine_iova_to_va(job->dst[s].iov_base);
+			if (src == NULL || dst == NULL) {
+				engine.error = 1;
+				continue;
+			}
+			memcpy(dst, src, job->src[s].iov_len);
+		}
+		engine.head++;
+		engine.released--;
+		n++;
+	}
+
+	return n;
+}
+
+static struct rte_vhost_async_channel_ops engine_ops = {
+	.transfer_data = engine_transfer_data,
+	.check_completed_copies = engine_check_completed_copies,
+};
+
+static int
+new_device(int vid)
+{
+	struct rte_vhost_async_features f;
+
+	f.intval = 0;
+	f.async_inorder = 1;
+	f.async_threshold = ASYNC_THRESHOLD;
+	if (rte_vhost_async_channel_register(vid, VIRTIO_TXQ, f.intval,
+			&engine_ops) < 0)
+		return -1;
+
+	vhost_vid = vid;
+	return 0;
+}
+
+static void
+destroy_device(int vid)
+{
+	vhost_vid = -1;
+	rte_vhost_async_channel_unregister(vid, VIRTIO_TXQ);
+}
+
+static const struct vhost_device_ops vhost_ops = {
+	.new_device = new_device,
+	.destroy_device = destroy_device,
+};
+
+static int
+port_init(void)
+{
+	struct rte_eth_conf conf;
+	char args[PATH_MAX + 32];
+	int ret;
+
+	snprintf(args, sizeof(args), "path=%s,queues=1,queue_size=%u",
+		sock_path, RING_SIZE);
+	ret = rte_vdev_init(VIRTIO_USER_NAME, args);
+	if (ret < 0)
+		return ret;
+
+	ret = rte_eth_dev_get_port_by_name(VIRTIO_USER_NAME, &port_id);
+	if (ret < 0)
+		return ret;
+
+	memset(&conf, 0, sizeof(conf));
+	ret = rte_eth_dev_configure(port_id, 1, 1, &conf);
+	if (ret < 0)
+		return ret;
+	ret = rte_eth_rx_queue_setup(port_id, 0, RING_SIZE,
+			rte_eth_dev_socket_id(port_id), NULL, mp);
+	if (ret < 0)
+		return ret;
+	ret = rte_eth_tx_queue_setup(port_id, 0, RING_SIZE,
+			rte_eth_dev_socket_id(port_id), NULL);
+	if (ret < 0)
+		return ret;
+
+	return rte_eth_dev_start(port_id);
+}
+
+static void
+testsuite_teardown(void)
+{
+	if (rte_eth_dev_is_valid_port(port_id)) {
+		rte_eth_dev_stop(port_id);
+		rte_eth_dev_close(port_id);
+		port_id = RTE_MAX_ETHPORTS;
+	}
+	rte_vdev_uninit(VIRTIO_USER_NAME);
+	rte_vhost_driver_unregister(sock_path);
+	rte_mempool_free(mp);
+	mp = NULL;
+}
+
+static int
+testsuite_setup(void)
+{
+	unsigned int i;
+
+	mp = rte_pktmbuf_pool_create("vhost_async_pool", NB_MBUF, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+
+	snprintf(sock_path, sizeof(sock_path), "%s/vhost_async.sock",
+		rte_eal_get_runtime_dir());
+	if (rte_vhost_driver_register(sock_path,
+			RTE_VHOST_USER_ASYNC_COPY) < 0 ||
+	    rte_vhost_driver_callback_register(sock_path, &vhost_ops) < 0 ||
+	    rte_vhost_driver_start(sock_path) < 0) {
+		printf("Cannot start vhost-user socket %s\n", sock_path);
+		goto err;
+	}
+
+	if (port_init() < 0) {
+		printf("Cannot start virtio-user port\n");
+		goto err;
+	}
+
+	for (i = 0; i < WAIT_MS && vhost_vid < 0; i++)
+		rte_delay_ms(1);
+	if (vhost_vid < 0) {
+		printf("vhost device not ready\n");
+		goto err;
+	}
+
+	return 0;
+
+err:
+	testsuite_teardown();
+	return -1;
+}
+
+static int
+guest_tx(unsigned int nb_pkts)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	unsigned int i;
+	uint16_t nb_tx;
+	char *data;
+
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, nb_pkts) != 0)
+		return -1;
+
+	for (i = 0; i < nb_pkts; i++) {
+		data = rte_pktmbuf_append(pkts[i], PKT_LEN(i));
+		memset(data, PKT_BYTE(i), PKT_LEN(i));
+	}
+
+	nb_tx = rte_eth_tx_burst(port_id, 0, pkts, nb_pkts);
+	if (nb_tx < nb_pkts) {
+		rte_pktmbuf_free_bulk(&pkts[nb_tx], nb_pkts - nb_tx);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Check that pkts hold the guest packets first to first + n - 1. */
+static int
+check_pkts(struct rte_mbuf **pkts, unsigned int first, unsigned int n)
+{
+	unsigned int i, j;
+	const uint8_t *data;
+	int ret = 0;
+
+	for (i = 0; i < n; i++) {
+		if (ret == 0 && pkts[i]->pkt_len != PKT_LEN(first + i)) {
+			printf("packet %u: length %u, expected %u\n",
+				first + i, pkts[i]->pkt_len,
+				PKT_LEN(first + i));
+			ret = -1;
+		}
+		data = rte_pktmbuf_mtod(pkts[i], const uint8_t *);
+		for (j = 0; ret == 0 && j < pkts[i]->data_len; j++) {
+			if (data[j] != PKT_BYTE(first + i)) {
+				printf("packet %u: byte %u is 0x%x\n",
+					first + i, j, data[j]);
+				ret = -1;
+			}
+		}
+	}
+
+	rte_pktmbuf_free_bulk(pkts, n);
+	return ret;
+}
+
+static int
+test_async_dequeue_split(void)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	int vid = vhost_vid;
+	uint16_t n;
+
+	memset(&engine, 0, sizeof(engine));
+	/* the engine holds two copies, the third one is rejected */
+	engine.capacity = 2;
+
+	TEST_ASSERT_SUCCESS(guest_tx(NB_PKTS), "guest Tx failed");
+
+	n = rte_vhost_submit_dequeue_burst(vid, VIRTIO_TXQ, mp, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, 4,
+		"submitted %u packets, expected the 4 before the rejected copy",
+		n);
+
+	n = rte_vhost_poll_dequeue_completed(vid, VIRTIO_TXQ, pkts, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, 0,
+		"%u packets returned before their copies completed", n);
+
+	/* a CPU copied packet follows the first completed one */
+	engine.released = 1;
+	n = rte_vhost_poll_dequeue_completed(vid, VIRTIO_TXQ, pkts, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, 2, "returned %u packets, expected 2", n);
+	TEST_ASSERT_SUCCESS(check_pkts(pkts, 0, n), "wrong packets 0-1");
+
+	engine.released = UINT32_MAX;
+	n = rte_vhost_poll_dequeue_completed(vid, VIRTIO_TXQ, pkts, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, 2, "returned %u packets, expected 2", n);
+	TEST_ASSERT_SUCCESS(check_pkts(pkts, 2, n), "wrong packets 2-3");
+
+	/* the rejected packets are still in the guest Tx ring */
+	engine.capacity = NB_PKTS;
+	n = rte_vhost_submit_dequeue_burst(vid, VIRTIO_TXQ, mp, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, NB_PKTS - 4,
+		"resubmitted %u packets, expected %u", n, NB_PKTS - 4);
+
+	n = rte_vhost_poll_dequeue_completed(vid, VIRTIO_TXQ, pkts, NB_PKTS);
+	TEST_ASSERT_EQUAL(n, NB_PKTS - 4, "returned %u packets, expected %u",
+		n, NB_PKTS - 4);
+	TEST_ASSERT_SUCCESS(check_pkts(pkts, 4, n), "wrong packets 4-7");
+
+	TEST_ASSERT_EQUAL(engine.error, 0, "engine cannot translate an IOVA");
+	TEST_ASSERT_EQUAL(engine.head, engine.tail, "copies left in flight");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite vhost_async_testsuite = {
+	.suite_name = "vhost async dequeue unit test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_async_dequeue_split),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_vhost_async(void)
+{
+	return unit_test_suite_runner(&vhost_async_testsuite);
+}
+
+REGISTER_TEST_COMMAND(vhost_async_autotest, test_vhost_async);
@@ -0,0 +1,305 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_pause.h>
+#include <rte_service.h>
+
+#include "../../examples/vhost/sw_dma.h"
+#include "test.h"
+
+/*
+ * Software DMA engine of the vhost sample application, driven through
+ * its async channel callbacks the way the vhost library does.
+ */
+
+#define SW_DMA_VID		0
+/* "rxd" channel, draining the guest Tx ring */
+#define SW_DMA_QUEUE		1
+#define MAX_SEGS		8
+#define SEG_LEN			2048
+/* enough descriptors to fill the engine ring with room to spare */
+#define NB_DESCS		(SW_DMA_RING_SIZE / MAX_SEGS + 2)
+#define NB_ORDER_PKTS		(2 * SW_DMA_BATCH + 3)
+#define WAIT_S			5
+
+#define SEG_OFF(pkt, seg)	(((pkt) * MAX_SEGS + (seg)) * SEG_LEN)
+#define BUF_LEN			SEG_OFF(NB_DESCS, 0)
+
+static struct {
+	struct rte_vhost_async_desc descs[NB_DESCS];
+	struct rte_vhost_iov_iter it[2 * NB_DESCS];
+	struct iovec iov[2 * NB_DESCS * MAX_SEGS];
+	uint8_t *src;
+	uint8_t *dst;
+	unsigned int lcore;
+	int lcore_added;
+	uint32_t service_id;
+} *t;
+
+static void
+testsuite_teardown(void)
+{
+	close_sw_dma();
+
+	if (t == NULL)
+		return;
+	if (t->lcore_added) {
+		rte_service_lcore_stop(t->lcore);
+		rte_eal_wait_lcore(t->lcore);
+		rte_service_lcore_del(t->lcore);
+	}
+	rte_free(t->src);
+	rte_free(t->dst);
+	rte_free(t);
+	t = NULL;
+}
+
+static int
+testsuite_setup(void)
+{
+	char dma_arg[32];
+	unsigned int i;
+	int ret;
+
+	if (rte_eal_iova_mode() != RTE_IOVA_VA) {
+		printf("software DMA needs IOVA as VA mode\n");
+		return TEST_SKIPPED;
+	}
+
+	t = rte_zmalloc(NULL, sizeof(*t), 0);
+	if (t == NULL)
+		return -1;
+
+	t->lcore = rte_get_next_lcore(-1, 1, 0);
+	if (t->lcore >= RTE_MAX_LCORE) {
+		printf("software DMA needs a service lcore\n");
+		testsuite_teardown();
+		return TEST_SKIPPED;
+	}
+
+	ret = rte_service_lcore_add(t->lcore);
+	if (ret != 0 && ret != -EALREADY)
+		goto err;
+	t->lcore_added = ret == 0;
+	ret = rte_service_lcore_start(t->lcore);
+	if (ret != 0 && ret != -EALREADY)
+		goto err;
+
+	t->src = rte_malloc(NULL, BUF_LEN, 0);
+	t->dst = rte_malloc(NULL, BUF_LEN, 0);
+	if (t->src == NULL || t->dst == NULL)
+		goto err;
+	for (i = 0; i < BUF_LEN; i++)
+		t->src[i] = i * 7;
+
+	snprintf(dma_arg, sizeof(dma_arg), "[rxd%u@test]", SW_DMA_VID);
+	if (open_sw_dma(dma_arg) != 0 ||
+	    rte_service_get_by_name("sw_dma_test", &t->service_id) != 0)
+		goto err;
+
+	return 0;
+
+err:
+	testsuite_teardown();
+	return -1;
+}
+
+/* Describe packets first to first + n - 1, packet i has segs[i] segments. */
+static struct rte_vhost_async_desc *
+fill_descs(unsigned int first, unsigned int n, const unsigned int *segs)
+{
+	struct rte_vhost_iov_iter *src, *dst;
+	struct iovec *iov = t->iov;
+	unsigned int i, s, pkt;
+
+	for (i = 0; i < n; i++) {
+		pkt = first + i;
+		src = &t->it[2 * i];
+		dst = &t->it[2 * i + 1];
+		src->offset = 0;
+		src->count = segs[pkt] * SEG_LEN;
+		src->iov = iov;
+		src->nr_segs = segs[pkt];
+		for (s = 0; s < segs[pkt]; s++, iov++) {
+			iov->iov_base = t->src + SEG_OFF(pkt, s);
+			iov->iov_len = SEG_LEN;
+		}
+		*dst = *src;
+		dst->iov = iov;
+		for (s = 0; s < segs[pkt]; s++, iov++) {
+			iov->iov_base = t->dst + SEG_OFF(pkt, s);
+			iov->iov_len = SEG_LEN;
+		}
+		t->descs[i].src = src;
+		t->descs[i].dst = dst;
+	}
+
+	return t->descs;
+}
+
+static uint32_t
+submit(unsigned int first, unsigned int n, const unsigned int *segs)
+{
+	return sw_dma_transfer_data_cb(SW_DMA_VID, SW_DMA_QUEUE,
+			fill_descs(first, n, segs), NULL, n);
+}
+
+/*
+ * Wait for the completion of packets first to first + n - 1, reported
+ * max_packets at most at a time. A packet is only reported once all
+ * the packets submitted before it are, and with its data copied.
+ */
+static int
+drain(unsigned int first, unsigned int n, const unsigned int *segs,
+		uint16_t max_packets)
+{
+	uint64_t deadline = rte_get_timer_cycles() +
+		WAIT_S * rte_get_timer_hz();
+	unsigned int i, done = 0;
+	uint32_t nb_cpl;
+
+	while (done < n) {
+		nb_cpl = sw_dma_check_completed_copies_cb(SW_DMA_VID,
+				SW_DMA_QUEUE, NULL, max_packets);
+		if (nb_cpl > max_packets || done + nb_cpl > n) {
+			printf("%u completions for %u expected\n",
+				nb_cpl, RTE_MIN(max_packets, n - done));
+			return -1;
+		}
+
+		/* the last completed packet is the most likely not copied */
+		for (i = done + nb_cpl; i-- > done; ) {
+			if (memcmp(t->dst + SEG_OFF(first + i, 0),
+					t->src + SEG_OFF(first + i, 0),
+					segs[first + i] * SEG_LEN) != 0) {
+				printf("packet %u completed, not copied\n",
+					first + i);
+				return -1;
+			}
+		}
+		done += nb_cpl;
+
+		if (rte_get_timer_cycles() > deadline) {
+			printf("%u of %u packets completed\n", done, n);
+			return -1;
+		}
+	}
+
+	/* nothing more than submitted */
+	if (sw_dma_check_completed_copies_cb(SW_DMA_VID, SW_DMA_QUEUE,
+			NULL, max_packets) != 0) {
+		printf("completion of a packet never submitted\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Submit the packets with the engine stopped, so that all the copies
+ * are done while their completions are polled.
+ */
+static uint32_t
+submit_held(unsigned int n, const unsigned int *segs)
+{
+	uint32_t nb_xfer;
+
+	rte_service_runstate_set(t->service_id, 0);
+	while (rte_service_may_be_active(t->service_id) == 1)
+		rte_pause();
+
+	memset(t->dst, 0, BUF_LEN);
+	nb_xfer = submit(0, n, segs);
+
+	rte_service_runstate_set(t->service_id, 1);
+	return nb_xfer;
+}
+
+static int
+test_sw_dma_order(void)
+{
+	unsigned int segs[NB_ORDER_PKTS];
+	unsigned int i;
+	uint32_t n;
+
+	for (i = 0; i < NB_ORDER_PKTS; i++)
+		segs[i] = i % MAX_SEGS + 1;
+
+	n = submit_held(NB_ORDER_PKTS, segs);
+	TEST_ASSERT_EQUAL(n, NB_ORDER_PKTS, "submitted %u of %u packets",
+		n, NB_ORDER_PKTS);
+	TEST_ASSERT_SUCCESS(drain(0, NB_ORDER_PKTS, segs, 1),
+		"packets not completed in order one at a time");
+
+	n = submit_held(NB_ORDER_PKTS, segs);
+	TEST_ASSERT_EQUAL(n, NB_ORDER_PKTS, "submitted %u of %u packets",
+		n, NB_ORDER_PKTS);
+	TEST_ASSERT_SUCCESS(drain(0, NB_ORDER_PKTS, segs, SW_DMA_BATCH + 1),
+		"packets not completed in order in bursts");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sw_dma_ring_full(void)
+{
+	unsigned int segs[NB_DESCS];
+	const unsigned int nb_fit = SW_DMA_RING_SIZE / MAX_SEGS;
+	unsigned int i;
+	uint32_t n;
+
+	memset(t->dst, 0, BUF_LEN);
+	for (i = 0; i < NB_DESCS; i++)
+		segs[i] = MAX_SEGS;
+
+	/* the ring holds the segments of nb_fit packets, not one more */
+	n = submit(0, NB_DESCS, segs);
+	TEST_ASSERT_EQUAL(n, nb_fit, "ring took %u packets, expected %u",
+		n, nb_fit);
+
+	/* ring slots are only given back on completion */
+	rte_delay_ms(10);
+	n = submit(nb_fit, 1, segs);
+	TEST_ASSERT_EQUAL(n, 0, "full ring took a packet");
+
+	TEST_ASSERT_SUCCESS(drain(0, nb_fit, segs, UINT16_MAX),
+		"full ring not completed");
+
+	/* the rejected packets are taken once the ring is drained */
+	n = submit(nb_fit, NB_DESCS - nb_fit, segs);
+	TEST_ASSERT_EQUAL(n, NB_DESCS - nb_fit,
+		"drained ring took %u of %u packets", n, NB_DESCS - nb_fit);
+	TEST_ASSERT_SUCCESS(drain(nb_fit, NB_DESCS - nb_fit, segs, UINT16_MAX),
+		"packets not completed after a full ring");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite vhost_sw_dma_testsuite = {
+	.suite_name = "vhost sample software DMA unit test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_sw_dma_order),
+		TEST_CASE(test_sw_dma_ring_full),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_vhost_sw_dma(void)
+{
+	return unit_test_suite_runner(&vhost_sw_dma_testsuite);
+}
+
+REGISTER_TEST_COMMAND(vhost_sw_dma_autotest, test_vhost_sw_dma);
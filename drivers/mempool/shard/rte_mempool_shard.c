@@ -0,0 +1,258 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+/* default number of lcores sharing a shard of a shard_lcore mempool */
+#define SHARD_LCORES_DEFAULT 8
+
+/*
+ * The objects of the mempool are spread over several rings, the shards.
+ * An lcore puts objects in its own shard and gets them from it, stealing
+ * from the other shards when it is empty, so that the refills and flushes
+ * of the mempool caches of lcores in different shards do not contend.
+ * Each shard can hold all the objects, so that a put never fails.
+ */
+struct shard_pool {
+	unsigned int nb_shards;
+	/* shard of each lcore */
+	uint16_t lcore_shard[RTE_MAX_LCORE];
+	struct rte_ring *rings[];
+};
+
+static inline unsigned int
+shard_local(const struct shard_pool *sp)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	/* unregistered non-EAL threads use the first shard */
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return 0;
+	return sp->lcore_shard[lcore_id];
+}
+
+static int
+shard_enqueue(struct rte_mempool *mp, void * const *obj_table,
+	unsigned int n)
+{
+	struct shard_pool *sp = mp->pool_data;
+
+	return rte_ring_mp_enqueue_bulk(sp->rings[shard_local(sp)],
+			obj_table, n, NULL) == 0 ? -ENOBUFS : 0;
+}
+
+static int
+shard_dequeue(struct rte_mempool *mp, void **obj_table, unsigned int n)
+{
+	struct shard_pool *sp = mp->pool_data;
+	unsigned int local = shard_local(sp);
+	unsigned int i, s, got;
+
+	if (likely(rte_ring_mc_dequeue_bulk(sp->rings[local],
+			obj_table, n, NULL) != 0))
+		return 0;
+
+	/* local shard is short of objects, steal from the next ones */
+	for (i = 1; i < sp->nb_shards; i++) {
+		s = (local + i) % sp->nb_shards;
+		if (rte_ring_mc_dequeue_bulk(sp->rings[s],
+				obj_table, n, NULL) != 0)
+			return 0;
+	}
+
+	/* no shard has enough objects, gather them from all shards */
+	got = 0;
+	for (i = 0; i < sp->nb_shards && got < n; i++) {
+		s = (local + i) % sp->nb_shards;
+		got += rte_ring_mc_dequeue_burst(sp->rings[s],
+				&obj_table[got], n - got, NULL);
+	}
+	if (got == n)
+		return 0;
+
+	if (got != 0)
+		rte_ring_mp_enqueue_bulk(sp->rings[local], obj_table, got,
+				NULL);
+	return -ENOBUFS;
+}
+
+static unsigned int
+shard_get_count(const struct rte_mempool *mp)
+{
+	const struct shard_pool *sp = mp->pool_data;
+	unsigned int i, count = 0;
+
+	for (i = 0; i < sp->nb_shards; i++)
+		count += rte_ring_count(sp->rings[i]);
+
+	return count;
+}
+
+static void
+shard_free(struct rte_mempool *mp)
+{
+	struct shard_pool *sp = mp->pool_data;
+	unsigned int i;
+
+	if (sp == NULL)
+		return;
+
+	for (i = 0; i < sp->nb_shards; i++)
+		rte_free(sp->rings[i]);
+	rte_free(sp);
+	mp->pool_data = NULL;
+}
+
+/*
+ * Allocate nb_shards rings, the lcore_shard map being set by the caller.
+ * The ring of a shard is allocated on the socket of its first lcore.
+ */
+static int
+shard_alloc(struct rte_mempool *mp, struct shard_pool *sp)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned int count = rte_align32pow2(mp->size + 1);
+	unsigned int i, lcore_id;
+	ssize_t ring_size;
+	int socket_id;
+	int ret;
+
+	mp->pool_data = sp;
+
+	ring_size = rte_ring_get_memsize(count);
+	if (ring_size < 0) {
+		ret = ring_size;
+		goto fail;
+	}
+
+	for (i = 0; i < sp->nb_shards; i++) {
+		socket_id = mp->socket_id;
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			if (rte_lcore_is_enabled(lcore_id) &&
+					sp->lcore_shard[lcore_id] == i) {
+				socket_id = rte_lcore_to_socket_id(lcore_id);
+				break;
+			}
+		}
+
+		sp->rings[i] = rte_zmalloc_socket("MEMPOOL_SHARD", ring_size,
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (sp->rings[i] == NULL) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		/* not registered in the ring list: the name may be cut */
+		snprintf(name, sizeof(name), "MPS%u_%s", i, mp->name);
+		ret = rte_ring_init(sp->rings[i], name, count, 0);
+		if (ret < 0)
+			goto fail;
+	}
+
+	return 0;
+
+fail:
+	shard_free(mp);
+	return ret;
+}
+
+static struct shard_pool *
+shard_pool_create(const struct rte_mempool *mp, unsigned int nb_shards)
+{
+	struct shard_pool *sp;
+
+	sp = rte_zmalloc_socket("MEMPOOL_SHARD_POOL",
+			sizeof(*sp) + nb_shards * sizeof(sp->rings[0]),
+			RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (sp != NULL)
+		sp->nb_shards = nb_shards;
+	return sp;
+}
+
+/* one shard per NUMA socket */
+static int
+shard_socket_alloc(struct rte_mempool *mp)
+{
+	unsigned int nb_shards = RTE_MAX(rte_socket_count(), 1u);
+	struct shard_pool *sp;
+	unsigned int lcore_id, i;
+
+	sp = shard_pool_create(mp, nb_shards);
+	if (sp == NULL)
+		return -ENOMEM;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		for (i = 0; i < nb_shards; i++) {
+			if (rte_socket_id_by_idx(i) ==
+					(int)rte_lcore_to_socket_id(lcore_id)) {
+				sp->lcore_shard[lcore_id] = i;
+				break;
+			}
+		}
+	}
+
+	return shard_alloc(mp, sp);
+}
+
+/*
+ * One shard per group of lcores, of SHARD_LCORES_DEFAULT lcores or
+ * of the number of lcores pointed to by the pool config.
+ */
+static int
+shard_lcore_alloc(struct rte_mempool *mp)
+{
+	unsigned int lcores = SHARD_LCORES_DEFAULT;
+	unsigned int nb_shards;
+	struct shard_pool *sp;
+	unsigned int lcore_id;
+	int idx;
+
+	if (mp->pool_config != NULL)
+		lcores = *(const unsigned int *)mp->pool_config;
+	if (lcores == 0)
+		return -EINVAL;
+
+	nb_shards = (RTE_MAX(rte_lcore_count(), 1u) + lcores - 1) / lcores;
+	sp = shard_pool_create(mp, nb_shards);
+	if (sp == NULL)
+		return -ENOMEM;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		idx = rte_lcore_index(lcore_id);
+		if (idx >= 0)
+			sp->lcore_shard[lcore_id] = idx / lcores;
+		else
+			sp->lcore_shard[lcore_id] = lcore_id % nb_shards;
+	}
+
+	return shard_alloc(mp, sp);
+}
+
+static const struct rte_mempool_ops ops_shard_socket = {
+	.name = "shard_socket",
+	.alloc = shard_socket_alloc,
+	.free = shard_free,
+	.enqueue = shard_enqueue,
+	.dequeue = shard_dequeue,
+	.get_count = shard_get_count,
+};
+
+static const struct rte_mempool_ops ops_shard_lcore = {
+	.name = "shard_lcore",
+	.alloc = shard_lcore_alloc,
+	.free = shard_free,
+	.enqueue = shard_enqueue,
+	.dequeue = shard_dequeue,
+	.get_count = shard_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(ops_shard_socket);
+MEMPOOL_REGISTER_OPS(ops_shard_lcore);
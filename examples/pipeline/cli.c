@@ -23,6 +23,9 @@
 #define CMD_MAX_TOKENS     256
 #endif
 
+#define CODEGEN_CMD_FMT \
+	"cc -O3 -fPIC -shared $(pkg-config --cflags libdpdk) -o %s %s"
+
 #define MSG_OUT_OF_MEMORY   "Not enough memory.\n"
 #define MSG_CMD_UNKNOWN     "Unknown command \"%s\".\n"
 #define MSG_CMD_UNIMPLEM    "Command \"%s\" not implemented.\n"
@@ -779,6 +782,69 @@ cmd_pipeline_build(char **tokens,
 	}
 }
 
+static const char cmd_pipeline_codegen_help[] =
+"pipeline <pipeline_name> codegen <c_file> <lib_file>\n";
+
+static void
+cmd_pipeline_codegen(char **tokens,
+	uint32_t n_tokens,
+	char *out,
+	size_t out_size,
+	void *obj)
+{
+	struct pipeline *p = NULL;
+	FILE *f = NULL;
+	char *cmd = NULL;
+	int len, status;
+
+	if (n_tokens != 5) {
+		snprintf(out, out_size, MSG_ARG_MISMATCH, tokens[0]);
+		return;
+	}
+
+	p = pipeline_find(obj, tokens[1]);
+	if (!p || !p->ctl) {
+		snprintf(out, out_size, MSG_ARG_INVALID, tokens[0]);
+		return;
+	}
+
+	f = fopen(tokens[3], "w");
+	if (!f) {
+		snprintf(out, out_size, "Cannot open file %s.\n", tokens[3]);
+		return;
+	}
+
+	status = rte_swx_pipeline_codegen(p->p, f);
+	fclose(f);
+	if (status) {
+		snprintf(out, out_size, "Code generation error %d.\n",
+			status);
+		return;
+	}
+
+	len = snprintf(NULL, 0, CODEGEN_CMD_FMT, tokens[4], tokens[3]);
+	cmd = malloc(len + 1);
+	if (!cmd) {
+		snprintf(out, out_size, MSG_OUT_OF_MEMORY);
+		return;
+	}
+
+	snprintf(cmd, len + 1, CODEGEN_CMD_FMT, tokens[4], tokens[3]);
+	status = system(cmd);
+	free(cmd);
+	if (status) {
+		snprintf(out, out_size, "Cannot build file %s.\n", tokens[3]);
+		return;
+	}
+
+	status = rte_swx_pipeline_codegen_load(p->p, tokens[4]);
+	if (status) {
+		snprintf(out, out_size, "Cannot load file %s: error %d.\n",
+			tokens[4], status);
+		return;
+	}
+}
+
 static void
 table_entry_free(struct rte_swx_table_entry *entry)
 {
@@ -1186,6 +1252,7 @@ cmd_help(char **tokens,
 			"\tpipeline port in\n"
 			"\tpipeline port out\n"
 			"\tpipeline build\n"
+			"\tpipeline codegen\n"
 			"\tpipeline table update\n"
 			"\tpipeline stats\n"
 			"\tthread pipeline enable\n"
@@ -1230,6 +1297,12 @@ cmd_help(char **tokens,
 		return;
 	}
 
+	if ((strcmp(tokens[0], "pipeline") == 0) &&
+		(n_tokens == 2) && (strcmp(tokens[1], "codegen") == 0)) {
+		snprintf(out, out_size, "\n%s\n", cmd_pipeline_codegen_help);
+		return;
+	}
+
 	if ((strcmp(tokens[0], "pipeline") == 0) &&
 		(n_tokens == 3) &&
 		(strcmp(tokens[1], "table") == 0) &&
@@ -1334,6 +1407,13 @@ cli_process(char *in, char *out, size_t out_size, void *obj)
 			return;
 		}
 
+		if ((n_tokens >= 3) &&
+			(strcmp(tokens[2], "codegen") == 0)) {
+			cmd_pipeline_codegen(tokens, n_tokens, out, out_size,
+				obj);
+			return;
+		}
+
 		if ((n_tokens >= 3) &&
 			(strcmp(tokens[2], "table") == 0)) {
 			cmd_pipeline_table_update(tokens, n_tokens, out,
@@ -9,7 +9,6 @@
 #include <rte_pci.h>
 #include <rte_vhost_async.h>
 
-#define MAX_VHOST_DEVICE 1024
 #define IOAT_RING_SIZE 4096
 #define MAX_ENQUEUED_SIZE 4096
 
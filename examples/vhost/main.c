@@ -25,6 +25,7 @@
 #include <rte_pause.h>
 
 #include "ioat.h"
+#include "sw_dma.h"
 #include "main.h"
 
 #ifndef MAX_QUEUES
@@ -203,6 +204,8 @@ open_dma(const char *value)
 {
 	if (strncmp(dma_type, "ioat", 4) == 0)
 		return open_ioat(value);
+	if (strncmp(dma_type, "sw", 2) == 0)
+		return open_sw_dma(value);
 
 	return -1;
 }
@@ -473,7 +476,7 @@ us_vhost_usage(const char *prgname)
 	"		--tx-csum [0|1] disable/enable TX checksum offload.\n"
 	"		--tso [0|1] disable/enable TCP segment offload.\n"
 	"		--client register a vhost-user socket as client mode.\n"
-	"		--dma-type register dma type for your vhost async driver. For example \"ioat\" for now.\n"
+	"		--dma-type register dma type for your vhost async driver. \"ioat\" or \"sw\".\n"
 	"		--dmas register dma channel for specific vhost device.\n",
 	       prgname);
 }
@@ -867,7 +870,7 @@ drain_vhost(struct vhost_dev *vdev)
 
 	if (builtin_net_driver) {
 		ret = vs_enqueue_pkts(vdev, VIRTIO_RXQ, m, nr_xmit);
-	} else if (async_vhost_driver) {
+	} else if (vdev->async_enqueue) {
 		uint32_t cpu_cpl_nr = 0;
 		uint16_t enqueue_fail = 0;
 		struct rte_mbuf *m_cpu_cpl[nr_xmit];
@@ -894,7 +897,7 @@ drain_vhost(struct vhost_dev *vdev)
 				__ATOMIC_SEQ_CST);
 	}
 
-	if (!async_vhost_driver)
+	if (!vdev->async_enqueue)
 		free_pkts(m, nr_xmit);
 }
 
@@ -1196,7 +1199,7 @@ drain_eth_rx(struct vhost_dev *vdev)
 	if (builtin_net_driver) {
 		enqueue_count = vs_enqueue_pkts(vdev, VIRTIO_RXQ,
 						pkts, rx_count);
-	} else if (async_vhost_driver) {
+	} else if (vdev->async_enqueue) {
 		uint32_t cpu_cpl_nr = 0;
 		uint16_t enqueue_fail = 0;
 		struct rte_mbuf *m_cpu_cpl[MAX_PKT_BURST];
@@ -1224,7 +1227,7 @@ drain_eth_rx(struct vhost_dev *vdev)
 				__ATOMIC_SEQ_CST);
 	}
 
-	if (!async_vhost_driver)
+	if (!vdev->async_enqueue)
 		free_pkts(pkts, rx_count);
 }
 
@@ -1238,6 +1241,11 @@ drain_virtio_tx(struct vhost_dev *vdev)
 	if (builtin_net_driver) {
 		count = vs_dequeue_pkts(vdev, VIRTIO_TXQ, mbuf_pool,
 					pkts, MAX_PKT_BURST);
+	} else if (vdev->async_dequeue) {
+		rte_vhost_submit_dequeue_burst(vdev->vid, VIRTIO_TXQ,
+					mbuf_pool, MAX_PKT_BURST);
+		count = rte_vhost_poll_dequeue_completed(vdev->vid,
+					VIRTIO_TXQ, pkts, MAX_PKT_BURST);
 	} else {
 		count = rte_vhost_dequeue_burst(vdev->vid, VIRTIO_TXQ,
 					mbuf_pool, pkts, MAX_PKT_BURST);
@@ -1376,9 +1384,22 @@ destroy_device(int vid)
 		"(%d) device has been removed from data core\n",
 		vdev->vid);
 
-	if (async_vhost_driver)
+	if (vdev->async_enqueue)
 		rte_vhost_async_channel_unregister(vid, VIRTIO_RXQ);
 
+	if (vdev->async_dequeue) {
+		struct rte_mbuf *pkts[MAX_PKT_BURST];
+		uint16_t count;
+
+		/* drop the packets still being copied out of the guest */
+		while (rte_vhost_async_channel_unregister(vid,
+				VIRTIO_TXQ) < 0) {
+			count = rte_vhost_poll_dequeue_completed(vid,
+					VIRTIO_TXQ, pkts, MAX_PKT_BURST);
+			free_pkts(pkts, count);
+		}
+	}
+
 	rte_free(vdev);
 }
 
@@ -1458,8 +1479,36 @@ new_device(int vid)
 			f.async_inorder = 1;
 			f.async_threshold = 256;
 
-			return rte_vhost_async_channel_register(vid, VIRTIO_RXQ,
-				f.intval, &channel_ops);
+			if (rte_vhost_async_channel_register(vid, VIRTIO_RXQ,
+					f.intval, &channel_ops) < 0)
+				return -1;
+			vdev->async_enqueue = 1;
+		}
+
+		if (strncmp(dma_type, "sw", 2) == 0) {
+			channel_ops.transfer_data = sw_dma_transfer_data_cb;
+			channel_ops.check_completed_copies =
+				sw_dma_check_completed_copies_cb;
+
+			f.intval = 0;
+			f.async_inorder = 1;
+			f.async_threshold = 256;
+
+			if (sw_dma_is_bound(vid, VIRTIO_RXQ)) {
+				if (rte_vhost_async_channel_register(vid,
+						VIRTIO_RXQ, f.intval,
+						&channel_ops) < 0)
+					return -1;
+				vdev->async_enqueue = 1;
+			}
+
+			if (sw_dma_is_bound(vid, VIRTIO_TXQ)) {
+				if (rte_vhost_async_channel_register(vid,
+						VIRTIO_TXQ, f.intval,
+						&channel_ops) < 0)
+					return -1;
+				vdev->async_dequeue = 1;
+			}
 		}
 	}
 
@@ -18,6 +18,8 @@ enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 
 #define MAX_PKT_BURST 32		/* Max burst size for RX/TX */
 
+#define MAX_VHOST_DEVICE 1024
+
 struct device_statistics {
 	uint64_t	tx;
 	uint64_t	tx_total;
@@ -46,6 +48,10 @@ struct vhost_dev {
 	volatile uint8_t ready;
 	/**< Device is marked for removal from the data core. */
 	volatile uint8_t remove;
+	/**< Guest Rx ring is filled through the async enqueue API. */
+	uint8_t async_enqueue;
+	/**< Guest Tx ring is drained through the async dequeue API. */
+	uint8_t async_dequeue;
 
 	int vid;
 	uint64_t features;
@@ -0,0 +1,332 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <sys/uio.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_pause.h>
+#include <rte_prefetch.h>
+#include <rte_ring_elem.h>
+#include <rte_service_component.h>
+#include <rte_string_fns.h>
+
+#include "sw_dma.h"
+#include "main.h"
+
+/*
+ * Software copy engine emulating a DMA channel: the data core pushes
+ * copy jobs to a ring, a service lcore performs them in batches and
+ * reports the completed packets through a completion ring. Copies are
+ * done by the CPU on the IOVAs handed by the vhost library, so the EAL
+ * must run in IOVA as VA mode.
+ */
+
+struct sw_dma_job {
+	uintptr_t src;
+	uintptr_t dst;
+	uint32_t len;
+	/* number of segments of the packet, set on its last segment */
+	uint32_t nr_segs;
+};
+
+struct sw_dma_chan {
+	/* copy jobs, enqueued by the data core */
+	struct rte_ring *job_ring;
+	/* segment counts of the completed packets, one per packet */
+	struct rte_ring *cpl_ring;
+	uint32_t service_id;
+	/* free job slots, only accessed by the data core */
+	uint32_t space;
+} __rte_cache_aligned;
+
+static struct sw_dma_chan *sw_dma_bind[MAX_VHOST_DEVICE][2];
+static uint32_t sw_dma_nr;
+
+static int32_t
+sw_dma_service_run(void *arg)
+{
+	struct sw_dma_chan *chan = arg;
+	struct sw_dma_job jobs[SW_DMA_BATCH];
+	uint32_t cpl[SW_DMA_BATCH];
+	unsigned int i, n, nb_cpl = 0;
+
+	n = rte_ring_dequeue_burst_elem(chan->job_ring, jobs,
+			sizeof(jobs[0]), SW_DMA_BATCH, NULL);
+	if (n == 0)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		if (i + 1 < n)
+			rte_prefetch0((void *)jobs[i + 1].src);
+		rte_memcpy((void *)jobs[i].dst, (const void *)jobs[i].src,
+				jobs[i].len);
+		if (jobs[i].nr_segs)
+			cpl[nb_cpl++] = jobs[i].nr_segs;
+	}
+
+	/*
+	 * The data core never has more segments in flight than the ring
+	 * size, so the completion ring cannot be full here. The ring
+	 * enqueue orders the copies above before the completions.
+	 */
+	if (nb_cpl)
+		rte_ring_enqueue_bulk_elem(chan->cpl_ring, cpl,
+				sizeof(cpl[0]), nb_cpl, NULL);
+
+	return 0;
+}
+
+static struct sw_dma_chan *
+sw_dma_chan_create(const char *name)
+{
+	struct rte_service_spec service;
+	struct sw_dma_chan *chan;
+	uint32_t lcores[RTE_MAX_LCORE];
+	char ring_name[RTE_RING_NAMESIZE];
+	int32_t nb_lcores;
+	uint32_t lcore;
+
+	nb_lcores = rte_service_lcore_list(lcores, RTE_MAX_LCORE);
+	if (nb_lcores <= 0) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"software DMA needs at least one service core\n");
+		return NULL;
+	}
+	lcore = lcores[sw_dma_nr % nb_lcores];
+
+	chan = rte_zmalloc_socket("sw_dma", sizeof(*chan),
+			RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore));
+	if (chan == NULL)
+		return NULL;
+
+	snprintf(ring_name, sizeof(ring_name), "sw_dma_job_%s", name);
+	chan->job_ring = rte_ring_create_elem(ring_name,
+			sizeof(struct sw_dma_job), SW_DMA_RING_SIZE,
+			rte_lcore_to_socket_id(lcore),
+			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	snprintf(ring_name, sizeof(ring_name), "sw_dma_cpl_%s", name);
+	chan->cpl_ring = rte_ring_create_elem(ring_name, sizeof(uint32_t),
+			SW_DMA_RING_SIZE, rte_lcore_to_socket_id(lcore),
+			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	if (chan->job_ring == NULL || chan->cpl_ring == NULL)
+		goto err;
+	chan->space = SW_DMA_RING_SIZE;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), "sw_dma_%s", name);
+	service.socket_id = rte_lcore_to_socket_id(lcore);
+	service.callback = sw_dma_service_run;
+	service.callback_userdata = chan;
+	if (rte_service_component_register(&service, &chan->service_id) < 0)
+		goto err;
+
+	if (rte_service_component_runstate_set(chan->service_id, 1) < 0 ||
+	    rte_service_runstate_set(chan->service_id, 1) < 0 ||
+	    rte_service_map_lcore_set(chan->service_id, lcore, 1) < 0) {
+		rte_service_component_unregister(chan->service_id);
+		goto err;
+	}
+
+	RTE_LOG(INFO, VHOST_CONFIG,
+		"software DMA channel %s running on service core %u\n",
+		name, lcore);
+	sw_dma_nr++;
+	return chan;
+
+err:
+	rte_ring_free(chan->job_ring);
+	rte_ring_free(chan->cpl_ring);
+	rte_free(chan);
+	return NULL;
+}
+
+int
+open_sw_dma(const char *value)
+{
+	char *input = strndup(value, strlen(value) + 1);
+	char *addrs = input;
+	char *ptrs[2];
+	char *start, *end, *substr;
+	char *dma_arg[MAX_VHOST_DEVICE];
+	int64_t vid;
+	uint16_t vring_id;
+	int args_nr;
+	int ret = 0;
+	int i;
+
+	if (rte_eal_iova_mode() != RTE_IOVA_VA) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"software DMA needs IOVA as VA mode\n");
+		ret = -1;
+		goto out;
+	}
+
+	while (isblank(*addrs))
+		addrs++;
+	if (*addrs == '\0') {
+		ret = -1;
+		goto out;
+	}
+
+	/* process DMA channels within bracket. */
+	addrs++;
+	substr = strtok(addrs, ";]");
+	if (!substr) {
+		ret = -1;
+		goto out;
+	}
+	args_nr = rte_strsplit(substr, strlen(substr),
+			dma_arg, MAX_VHOST_DEVICE, ',');
+	if (args_nr <= 0) {
+		ret = -1;
+		goto out;
+	}
+	for (i = 0; i < args_nr; i++) {
+		if (rte_strsplit(dma_arg[i], strlen(dma_arg[i]),
+				ptrs, 2, '@') != 2) {
+			ret = -1;
+			goto out;
+		}
+
+		/* txd feeds the guest Rx ring, rxd drains the guest Tx ring */
+		if (strncmp(ptrs[0], "txd", 3) == 0)
+			vring_id = VIRTIO_RXQ;
+		else if (strncmp(ptrs[0], "rxd", 3) == 0)
+			vring_id = VIRTIO_TXQ;
+		else {
+			ret = -1;
+			goto out;
+		}
+
+		start = ptrs[0] + 3;
+		vid = strtol(start, &end, 0);
+		if (end == start || vid < 0 || vid >= MAX_VHOST_DEVICE ||
+		    sw_dma_bind[vid][vring_id] != NULL) {
+			ret = -1;
+			goto out;
+		}
+
+		sw_dma_bind[vid][vring_id] = sw_dma_chan_create(ptrs[1]);
+		if (sw_dma_bind[vid][vring_id] == NULL) {
+			ret = -1;
+			goto out;
+		}
+	}
+out:
+	free(input);
+	return ret;
+}
+
+void
+close_sw_dma(void)
+{
+	struct sw_dma_chan *chan;
+	int vid, queue_id;
+
+	for (vid = 0; vid < MAX_VHOST_DEVICE; vid++) {
+		for (queue_id = 0; queue_id < 2; queue_id++) {
+			chan = sw_dma_bind[vid][queue_id];
+			if (chan == NULL)
+				continue;
+
+			rte_service_runstate_set(chan->service_id, 0);
+			rte_service_component_runstate_set(chan->service_id, 0);
+			while (rte_service_may_be_active(chan->service_id) == 1)
+				rte_pause();
+			rte_service_component_unregister(chan->service_id);
+
+			rte_ring_free(chan->job_ring);
+			rte_ring_free(chan->cpl_ring);
+			rte_free(chan);
+			sw_dma_bind[vid][queue_id] = NULL;
+		}
+	}
+	sw_dma_nr = 0;
+}
+
+bool
+sw_dma_is_bound(int vid, uint16_t queue_id)
+{
+	return sw_dma_bind[vid][queue_id] != NULL;
+}
+
+uint32_t
+sw_dma_transfer_data_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_desc *descs,
+		struct rte_vhost_async_status *opaque_data, uint16_t count)
+{
+	struct sw_dma_chan *chan = sw_dma_bind[vid][queue_id];
+	struct sw_dma_job jobs[SW_DMA_BATCH];
+	struct rte_vhost_iov_iter *src, *dst;
+	unsigned int nb_jobs = 0;
+	unsigned long i_seg;
+	uint32_t i_desc;
+
+	/* Opaque data is not supported */
+	if (opaque_data || chan == NULL)
+		return 0;
+
+	for (i_desc = 0; i_desc < count; i_desc++) {
+		src = descs[i_desc].src;
+		dst = descs[i_desc].dst;
+		if (chan->space < src->nr_segs)
+			break;
+
+		for (i_seg = 0; i_seg < src->nr_segs; i_seg++) {
+			jobs[nb_jobs].src =
+				(uintptr_t)src->iov[i_seg].iov_base +
+				src->offset;
+			jobs[nb_jobs].dst =
+				(uintptr_t)dst->iov[i_seg].iov_base +
+				dst->offset;
+			jobs[nb_jobs].len = src->iov[i_seg].iov_len;
+			jobs[nb_jobs].nr_segs = i_seg + 1 == src->nr_segs ?
+				src->nr_segs : 0;
+			if (++nb_jobs == SW_DMA_BATCH) {
+				rte_ring_enqueue_bulk_elem(chan->job_ring,
+						jobs, sizeof(jobs[0]),
+						nb_jobs, NULL);
+				nb_jobs = 0;
+			}
+		}
+		chan->space -= src->nr_segs;
+	}
+
+	if (nb_jobs)
+		rte_ring_enqueue_bulk_elem(chan->job_ring, jobs,
+				sizeof(jobs[0]), nb_jobs, NULL);
+
+	return i_desc;
+}
+
+uint32_t
+sw_dma_check_completed_copies_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_status *opaque_data,
+		uint16_t max_packets)
+{
+	struct sw_dma_chan *chan = sw_dma_bind[vid][queue_id];
+	uint32_t cpl[SW_DMA_BATCH];
+	uint32_t nb_packet = 0;
+	unsigned int i, n;
+
+	/* Opaque data is not supported */
+	if (opaque_data || chan == NULL)
+		return 0;
+
+	while (nb_packet < max_packets) {
+		n = rte_ring_dequeue_burst_elem(chan->cpl_ring, cpl,
+				sizeof(cpl[0]),
+				RTE_MIN(max_packets - nb_packet,
+					(uint32_t)SW_DMA_BATCH), NULL);
+		if (n == 0)
+			break;
+		for (i = 0; i < n; i++)
+			chan->space += cpl[i];
+		nb_packet += n;
+	}
+
+	return nb_packet;
+}
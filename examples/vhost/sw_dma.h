@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#ifndef _SW_DMA_H_
+#define _SW_DMA_H_
+
+#include <rte_vhost.h>
+#include <rte_vhost_async.h>
+
+#define SW_DMA_RING_SIZE 4096
+#define SW_DMA_BATCH 32
+
+int open_sw_dma(const char *value);
+
+/* Stop and free all channels, no vhost device may use them anymore. */
+void close_sw_dma(void);
+
+bool sw_dma_is_bound(int vid, uint16_t queue_id);
+
+uint32_t
+sw_dma_transfer_data_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_desc *descs,
+		struct rte_vhost_async_status *opaque_data, uint16_t count);
+
+uint32_t
+sw_dma_check_completed_copies_cb(int vid, uint16_t queue_id,
+		struct rte_vhost_async_status *opaque_data,
+		uint16_t max_packets);
+
+#endif /* _SW_DMA_H_ */
@@ -163,17 +163,21 @@ struct rte_acl_bld_trie {
 	struct rte_acl_node *trie;
 };
 
+struct acl_inc;
+
 struct rte_acl_ctx {
 	char                name[RTE_ACL_NAMESIZE];
 	/** Name of the ACL context. */
 	int32_t             socket_id;
 	/** Socket ID to allocate memory from. */
 	enum rte_acl_classify_alg alg;
+	uint32_t            num_threads; /* max number of build threads. */
 	uint32_t           first_load_sz;
 	void               *rules;
 	uint32_t            max_rules;
 	uint32_t            rule_sz;
 	uint32_t            num_rules;
+	struct acl_inc     *inc; /* incremental mode state, NULL if disabled. */
 	uint32_t            num_categories;
 	uint32_t            num_tries;
 	uint32_t            match_index;
@@ -189,11 +193,26 @@ struct rte_acl_ctx {
 
 int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size);
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t num_threads);
 
 typedef int (*rte_acl_classify_t)
 (const struct rte_acl_ctx *, const uint8_t **, uint32_t *, uint32_t, uint32_t);
 
+int acl_check_bld_param(struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg);
+
+int acl_inc_add_rules(struct rte_acl_ctx *ctx, const void *rules,
+	uint32_t num);
+
+int acl_inc_classify(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories,
+	rte_acl_classify_t classify);
+
+void acl_inc_free(struct rte_acl_ctx *ctx);
+
+void acl_inc_dump(const struct rte_acl_ctx *ctx);
+
 /*
  * Different implementations of ACL classify.
  */
@@ -2,7 +2,10 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <pthread.h>
+
 #include <rte_acl.h>
+#include <rte_lcore.h>
 #include "tb_mem.h"
 #include "acl.h"
 
@@ -62,6 +65,8 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+struct acl_build_job;
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -85,6 +90,21 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* trie rebuilds running on worker threads */
+	uint32_t                  num_threads;
+	uint32_t                  num_jobs;
+	uint32_t                  num_done;
+	struct acl_build_job      *jobs[RTE_ACL_MAX_TRIES];
+};
+
+/* Rebuild of one trie on a worker thread, with its own build context. */
+struct acl_build_job {
+	struct acl_build_context  bcx;
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
+	uint32_t                  n;
+	int32_t                   rc;
+	pthread_t                 tid;
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1335,10 +1355,134 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+static void *
+acl_build_job_run(void *arg)
+{
+	struct acl_build_job *job;
+	struct rte_acl_build_rule *last;
+
+	job = arg;
+
+	job->rc = sigsetjmp(job->bcx.pool.fail, 0);
+	if (job->rc != 0)
+		return NULL;
+
+	last = build_one_trie(&job->bcx, job->rule_sets, job->n, INT32_MAX);
+	if (job->bcx.bld_tries[job->n].trie == NULL || last != NULL)
+		job->rc = -ENOMEM;
+
+	return NULL;
+}
+
+/*
+ * Wait for the rebuild of one trie to finish and
+ * move its results into the main build context.
+ */
+static int
+acl_build_job_wait(struct acl_build_context *context,
+	struct acl_build_job *job)
+{
+	uint32_t n;
+
+	pthread_join(job->tid, NULL);
+
+	n = job->n;
+	if (job->rc != 0) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		return job->rc;
+	}
+
+	context->tries[n] = job->bcx.tries[n];
+	context->bld_tries[n] = job->bcx.bld_tries[n];
+	memcpy(context->data_indexes[n], job->bcx.data_indexes[n],
+		sizeof(context->data_indexes[n]));
+	context->tries[n].data_index = context->data_indexes[n];
+	context->num_nodes += job->bcx.num_nodes;
+	return 0;
+}
+
+static int
+acl_build_jobs_wait(struct acl_build_context *context)
+{
+	int32_t rc, ret;
+
+	rc = 0;
+	while (context->num_done != context->num_jobs) {
+		ret = acl_build_job_wait(context,
+			context->jobs[context->num_done++]);
+		if (rc == 0)
+			rc = ret;
+	}
+
+	return rc;
+}
+
+/*
+ * Rebuild n-th trie without any limit on the number of nodes.
+ * Nodes of different tries never share memory, so when allowed the
+ * rebuild is handed to a worker thread with its own build context,
+ * while the caller carries on with the rest of the rules.
+ */
+static int
+acl_build_rebuild(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t n)
+{
+	int32_t rc;
+	struct acl_build_job *job;
+	struct rte_acl_build_rule *last;
+	char name[RTE_MAX_THREAD_NAME_LEN];
+
+	if (context->num_threads > 1) {
+
+		/* calling thread counts as one of num_threads. */
+		if (context->num_jobs - context->num_done ==
+				context->num_threads - 1) {
+			rc = acl_build_job_wait(context,
+				context->jobs[context->num_done++]);
+			if (rc != 0)
+				return rc;
+		}
+
+		job = tb_alloc(&context->pool, sizeof(*job));
+		memset(job, 0, sizeof(*job));
+
+		job->bcx.acx = context->acx;
+		job->bcx.pool.alignment = ACL_POOL_ALIGN;
+		job->bcx.pool.min_alloc = ACL_POOL_ALLOC_MIN;
+		job->bcx.cfg.num_categories = context->cfg.num_categories;
+		job->bcx.category_mask = context->category_mask;
+		job->bcx.node_max = context->node_max;
+		job->rule_sets[n] = rule_sets[n];
+		job->n = n;
+
+		snprintf(name, sizeof(name), "acl-bld-%u", n);
+		rc = rte_ctrl_thread_create(&job->tid, name, NULL,
+			acl_build_job_run, job);
+		if (rc == 0) {
+			context->jobs[context->num_jobs++] = job;
+			return 0;
+		}
+
+		/* fall back to the calling thread. */
+		RTE_LOG(DEBUG, ACL,
+			"ACL context: %s, failed to start build thread: %d\n",
+			context->acx->name, rc);
+	}
+
+	last = build_one_trie(context, rule_sets, n, INT32_MAX);
+	if (context->bld_tries[n].trie == NULL || last != NULL) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
+	int32_t rc;
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last;
@@ -1398,14 +1542,15 @@ acl_build_tries(struct acl_build_context *context,
 		 * Rebuild the trie for the reduced rule-set.
 		 * Don't try to split it any further.
 		 */
-		last = build_one_trie(context, rule_sets, n, INT32_MAX);
-		if (context->bld_tries[n].trie == NULL || last != NULL) {
-			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
-			return -ENOMEM;
-		}
-
+		rc = acl_build_rebuild(context, rule_sets, n);
+		if (rc != 0)
+			return rc;
 	}
 
+	rc = acl_build_jobs_wait(context);
+	if (rc != 0)
+		return rc;
+
 	context->num_tries = num_tries;
 	return 0;
 }
@@ -1433,6 +1578,23 @@ acl_build_log(const struct acl_build_context *ctx)
 	}
 }
 
+/*
+ * Release all memory used by the build phase,
+ * waiting for the worker threads (if any) first.
+ */
+static void
+acl_build_cleanup(struct acl_build_context *bcx)
+{
+	uint32_t i;
+
+	acl_build_jobs_wait(bcx);
+
+	for (i = 0; i != bcx->num_jobs; i++)
+		tb_free_pool(&bcx->jobs[i]->bcx.pool);
+
+	tb_free_pool(&bcx->pool);
+}
+
 static int
 acl_build_rules(struct acl_build_context *bcx)
 {
@@ -1512,6 +1674,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
 		typeof(bcx->category_mask));
 	bcx->node_max = node_max;
+	bcx->num_threads = ctx->num_threads;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1541,7 +1704,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 /*
  * Check that parameters for acl_build() are valid.
  */
-static int
+int
 acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	static const size_t field_sizes[] = {
@@ -1624,6 +1787,10 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	if (rc != 0)
 		return rc;
 
+	/* incremental context is rebuilt by rte_acl_consolidate() only. */
+	if (ctx->inc != NULL)
+		return -EBUSY;
+
 	acl_build_reset(ctx);
 
 	if (cfg->max_size == 0) {
@@ -1644,7 +1811,8 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
 				bcx.num_tries, bcx.cfg.num_categories,
 				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
-				sizeof(ctx->data_indexes[0]), max_size);
+				sizeof(ctx->data_indexes[0]), max_size,
+				bcx.num_threads);
 			if (rc == 0) {
 				/* set data indexes. */
 				acl_set_data_indexes(ctx);
@@ -1660,7 +1828,7 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		acl_build_log(&bcx);
 
 		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
+		acl_build_cleanup(&bcx);
 	}
 
 	return rc;
@@ -2,7 +2,10 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <pthread.h>
+
 #include <rte_acl.h>
+#include <rte_lcore.h>
 #include "acl.h"
 
 #define	QRANGE_MIN	((uint8_t)INT8_MIN)
@@ -30,6 +33,27 @@ struct rte_acl_indices {
 	int32_t match_start;
 };
 
+/* Generation state for one trie. */
+struct acl_gen_trie {
+	struct rte_acl_node *root;
+	uint64_t *node_array;
+	uint64_t no_match;
+	int32_t num_categories;
+	struct acl_node_counters counts;
+	struct rte_acl_indices indices;
+};
+
+/* Worker that processes every step-th trie, starting from the first one. */
+struct acl_gen_worker {
+	struct acl_gen_trie *gt;
+	uint32_t num_tries;
+	uint32_t first;
+	uint32_t step;
+	void (*fn)(struct acl_gen_trie *);
+	int32_t started;
+	pthread_t tid;
+};
+
 static void
 acl_gen_log_stats(const struct rte_acl_ctx *ctx,
 	const struct acl_node_counters *counts,
@@ -414,21 +438,95 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+static void
+acl_gen_count(struct acl_gen_trie *gt)
+{
+	acl_count_trie_types(&gt->counts, gt->root, gt->no_match, 1);
+}
+
+static void
+acl_gen_trie(struct acl_gen_trie *gt)
+{
+	acl_gen_node(gt->root, gt->node_array, gt->no_match, &gt->indices,
+		gt->num_categories);
+}
+
+static void *
+acl_gen_worker_run(void *arg)
+{
+	uint32_t n;
+	struct acl_gen_worker *wk;
+
+	wk = arg;
+	for (n = wk->first; n < wk->num_tries; n += wk->step)
+		wk->fn(wk->gt + n);
+
+	return NULL;
+}
+
+/*
+ * Apply given function to all tries.
+ * Tries don't share any nodes, so they can be processed by up to
+ * num_threads threads in parallel (the calling one included).
+ */
+static void
+acl_gen_tries(struct acl_gen_trie *gt, uint32_t num_tries,
+	uint32_t num_threads, void (*fn)(struct acl_gen_trie *))
+{
+	uint32_t i, n;
+	struct acl_gen_worker wk[RTE_ACL_MAX_TRIES];
+	char name[RTE_MAX_THREAD_NAME_LEN];
+
+	n = RTE_MIN(num_threads, num_tries);
+	n = RTE_MAX(n, 1U);
+
+	for (i = 0; i != n; i++) {
+		wk[i].gt = gt;
+		wk[i].num_tries = num_tries;
+		wk[i].first = i;
+		wk[i].step = n;
+		wk[i].fn = fn;
+		wk[i].started = 0;
+	}
+
+	for (i = 1; i != n; i++) {
+		snprintf(name, sizeof(name), "acl-gen-%u", i);
+		wk[i].started = (rte_ctrl_thread_create(&wk[i].tid, name, NULL,
+			acl_gen_worker_run, wk + i) == 0);
+	}
+
+	acl_gen_worker_run(wk);
+
+	/* wait for workers, do ones that failed to start ourselves. */
+	for (i = 1; i != n; i++) {
+		if (wk[i].started != 0)
+			pthread_join(wk[i].tid, NULL);
+		else
+			acl_gen_worker_run(wk + i);
+	}
+}
+
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
-	struct rte_acl_indices *indices,
-	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	struct rte_acl_indices *indices, struct acl_gen_trie *gt,
+	uint32_t num_tries, uint32_t num_threads)
 {
 	uint32_t n;
+	struct rte_acl_indices idx;
 
 	memset(indices, 0, sizeof(*indices));
 	memset(counts, 0, sizeof(*counts));
 
 	/* Get stats on nodes */
+	acl_gen_tries(gt, num_tries, num_threads, acl_gen_count);
+
 	for (n = 0; n < num_tries; n++) {
-		acl_count_trie_types(counts, node_bld_trie[n].trie,
-			no_match, 1);
+		counts->match += gt[n].counts.match;
+		counts->single += gt[n].counts.single;
+		counts->quad += gt[n].counts.quad;
+		counts->quad_vectors += gt[n].counts.quad_vectors;
+		counts->dfa += gt[n].counts.dfa;
+		counts->dfa_gr64 += gt[n].counts.dfa_gr64;
 	}
 
 	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
@@ -439,6 +537,19 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 	indices->match_start = RTE_ALIGN(indices->match_start,
 		(XMM_SIZE / sizeof(uint64_t)));
 	indices->match_index = 1;
+
+	/*
+	 * Give each trie its own part of every region,
+	 * in the same order as sequential generation would.
+	 */
+	idx = *indices;
+	for (n = 0; n < num_tries; n++) {
+		gt[n].indices = idx;
+		idx.dfa_index += gt[n].counts.dfa_gr64 * RTE_ACL_DFA_GR64_SIZE;
+		idx.quad_index += gt[n].counts.quad_vectors;
+		idx.single_index += gt[n].counts.single;
+		idx.match_index += gt[n].counts.match;
+	}
 }
 
 /*
@@ -447,7 +558,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, size_t max_size)
+	uint32_t num_categories, uint32_t data_index_sz, size_t max_size,
+	uint32_t num_threads)
 {
 	void *mem;
 	size_t total_size;
@@ -456,12 +568,20 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_match_results *match;
 	struct acl_node_counters counts;
 	struct rte_acl_indices indices;
+	struct acl_gen_trie gt[RTE_ACL_MAX_TRIES];
 
 	no_match = RTE_ACL_NODE_MATCH;
 
+	memset(gt, 0, sizeof(gt));
+	for (n = 0; n < num_tries; n++) {
+		gt[n].root = node_bld_trie[n].trie;
+		gt[n].no_match = no_match;
+		gt[n].num_categories = num_categories;
+	}
+
 	/* Fill counts and indices arrays from the nodes. */
-	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+	acl_calc_counts_indices(&counts, &indices, gt, num_tries,
+		num_threads);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -505,11 +625,12 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	match = ((struct rte_acl_match_results *)(node_array + match_index));
 	memset(match, 0, sizeof(*match));
 
-	for (n = 0; n < num_tries; n++) {
+	for (n = 0; n < num_tries; n++)
+		gt[n].node_array = node_array;
 
-		acl_gen_node(node_bld_trie[n].trie, node_array, no_match,
-			&indices, num_categories);
+	acl_gen_tries(gt, num_tries, num_threads, acl_gen_trie);
 
+	for (n = 0; n < num_tries; n++) {
 		if (node_bld_trie[n].trie->node_index == no_match)
 			trie[n].root_index = 0;
 		else
@@ -527,6 +648,10 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	ctx->trans_table = node_array;
 	memcpy(ctx->trie, trie, sizeof(ctx->trie));
 
+	/* last trie ends up at the end of every region. */
+	if (num_tries != 0)
+		indices = gt[num_tries - 1].indices;
+
 	acl_gen_log_stats(ctx, &counts, &indices, max_size);
 	return 0;
 }
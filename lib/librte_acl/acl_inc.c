@@ -0,0 +1,921 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <rte_acl.h>
+#include <rte_spinlock.h>
+
+#include "acl.h"
+
+/*
+ * Incremental mode of the ACL context.
+ * The rules are split between two sets of run-time tries:
+ * - main: built from the bulk of the rules at rte_acl_build_incremental()
+ *   or rte_acl_consolidate() time, only ever masked afterwards.
+ * - delta: built from the rules added since the last main build,
+ *   small enough to be rebuilt from scratch on every update.
+ * Both are built with userdata replaced by (rule index + 1), so that
+ * the results can be merged by priority and deleted rules can be spotted.
+ * Readers search the view published last; each update publishes a new
+ * view and retires the replaced one through RCU QSBR.
+ */
+
+#define	ACL_INC_DELTA	UINT32_MAX	/* rule is in the delta tries */
+#define	ACL_INC_BURST	64		/* results merged at once */
+
+struct acl_inc_part {
+	struct rte_acl_ctx *rt;	/* run-time tries */
+	uint32_t num_rules;
+	uint32_t num_dead;
+	int32_t *priority;	/* original priority of each rule */
+	uint32_t *userdata;	/* original userdata of each rule */
+	uint8_t *dead;		/* rule was deleted after the build */
+};
+
+struct acl_inc_view {
+	struct acl_inc_part *main;
+	struct acl_inc_part *delta;
+};
+
+/* resources replaced by one update, reclaimed together. */
+struct acl_inc_retire {
+	struct acl_inc_view *view;
+	struct acl_inc_part *part[2];
+};
+
+struct acl_inc_meta {
+	uint64_t seq;      /* unique, grows with each added rule */
+	uint32_t main_idx; /* index in the main tries or ACL_INC_DELTA */
+	uint32_t del;      /* selected for deletion */
+};
+
+struct acl_inc_seq {
+	uint64_t seq;
+	uint32_t idx;
+};
+
+struct acl_inc {
+	struct acl_inc_view *view;  /* searched by readers, RCU protected */
+	rte_spinlock_t lock;        /* serializes updates */
+	uint32_t consolidating;
+	uint32_t max_delta;
+	uint32_t num_delta;
+	uint64_t seq;               /* seq of the next added rule */
+	struct acl_inc_meta *meta;  /* one per rule in ctx->rules */
+	struct rte_acl_config cfg;
+	struct rte_rcu_qsbr *v;
+	enum rte_acl_qsbr_mode rcu_mode;
+	struct rte_rcu_qsbr_dq *dq;
+};
+
+static inline const struct rte_acl_rule *
+acl_inc_rule(const struct rte_acl_ctx *ctx, uint32_t idx)
+{
+	return (const struct rte_acl_rule *)
+		((uintptr_t)ctx->rules + idx * ctx->rule_sz);
+}
+
+static inline int
+acl_inc_in_delta(const struct acl_inc_meta *m, uint64_t seq)
+{
+	return m->main_idx == ACL_INC_DELTA && m->del == 0 && m->seq >= seq;
+}
+
+static void
+acl_inc_part_free(struct acl_inc_part *part)
+{
+	if (part == NULL)
+		return;
+	rte_free(part->rt->mem);
+	rte_free(part->rt);
+	rte_free(part);
+}
+
+static struct acl_inc_part *
+acl_inc_part_alloc(const struct rte_acl_ctx *ctx, uint32_t num)
+{
+	size_t sz;
+	struct acl_inc_part *part;
+	struct rte_acl_ctx *rt;
+
+	sz = sizeof(*part) + num * (sizeof(part->priority[0]) +
+		sizeof(part->userdata[0]) + sizeof(part->dead[0]));
+	part = rte_zmalloc_socket("ACL_INC_PART", sz, RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (part == NULL)
+		return NULL;
+
+	/* run-time context, not visible through rte_acl_find_existing(). */
+	sz = sizeof(*rt) + num * ctx->rule_sz;
+	rt = rte_zmalloc_socket(ctx->name, sz, RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (rt == NULL) {
+		rte_free(part);
+		return NULL;
+	}
+
+	rt->rules = rt + 1;
+	rt->max_rules = num;
+	rt->rule_sz = ctx->rule_sz;
+	rt->socket_id = ctx->socket_id;
+	rt->alg = ctx->alg;
+	rt->num_threads = ctx->num_threads;
+	strlcpy(rt->name, ctx->name, sizeof(rt->name));
+
+	part->rt = rt;
+	part->priority = (int32_t *)(part + 1);
+	part->userdata = (uint32_t *)(part->priority + num);
+	part->dead = (uint8_t *)(part->userdata + num);
+	return part;
+}
+
+static void
+acl_inc_part_add(struct acl_inc_part *part, const struct rte_acl_rule *rule)
+{
+	uint32_t n;
+	struct rte_acl_ctx *rt;
+	struct rte_acl_rule *r;
+
+	rt = part->rt;
+	n = rt->num_rules;
+	r = (struct rte_acl_rule *)((uintptr_t)rt->rules + n * rt->rule_sz);
+	memcpy(r, rule, rt->rule_sz);
+
+	part->priority[n] = r->data.priority;
+	part->userdata[n] = r->data.userdata;
+	r->data.userdata = n + 1;
+
+	rt->num_rules = n + 1;
+	part->num_rules = n + 1;
+}
+
+static void
+acl_inc_retire_free(const struct acl_inc_retire *rt)
+{
+	acl_inc_part_free(rt->part[0]);
+	acl_inc_part_free(rt->part[1]);
+	rte_free(rt->view);
+}
+
+static void
+acl_inc_rcu_free(void *p, void *data, unsigned int n)
+{
+	unsigned int i;
+	const struct acl_inc_retire *rt;
+
+	RTE_SET_USED(p);
+	rt = data;
+	for (i = 0; i != n; i++)
+		acl_inc_retire_free(rt + i);
+}
+
+static void
+acl_inc_retire(struct acl_inc *inc, struct acl_inc_retire *rt)
+{
+	if (inc->v == NULL) {
+		acl_inc_retire_free(rt);
+		return;
+	}
+
+	if (inc->rcu_mode == RTE_ACL_QSBR_MODE_DQ &&
+			rte_rcu_qsbr_dq_enqueue(inc->dq, rt) == 0)
+		return;
+
+	/* blocking mode or defer queue is full. */
+	rte_rcu_qsbr_synchronize(inc->v, RTE_QSBR_THRID_INVALID);
+	acl_inc_retire_free(rt);
+}
+
+static struct acl_inc_view *
+acl_inc_view_alloc(const struct rte_acl_ctx *ctx, struct acl_inc_part *main,
+	struct acl_inc_part *delta)
+{
+	struct acl_inc_view *view;
+
+	view = rte_zmalloc_socket("ACL_INC_VIEW", sizeof(*view),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	if (view != NULL) {
+		view->main = main;
+		view->delta = delta;
+	}
+	return view;
+}
+
+/*
+ * Make new view visible to the readers and retire parts of the old one
+ * that are not referenced any more. Called with the lock held.
+ */
+static void
+acl_inc_publish(struct acl_inc *inc, struct acl_inc_view *view)
+{
+	struct acl_inc_retire rt;
+
+	rt.view = inc->view;
+	rt.part[0] = (rt.view->main != view->main) ? rt.view->main : NULL;
+	rt.part[1] = (rt.view->delta != view->delta) ? rt.view->delta : NULL;
+
+	__atomic_store_n(&inc->view, view, __ATOMIC_RELEASE);
+	acl_inc_retire(inc, &rt);
+}
+
+/*
+ * Build delta tries from the rules that are not in the main tries
+ * and were added not earlier than *seq*. Called with the lock held.
+ */
+static int
+acl_inc_delta_build(struct rte_acl_ctx *ctx, uint64_t seq,
+	struct acl_inc_part **pd)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct acl_inc *inc;
+	struct acl_inc_part *part;
+
+	inc = ctx->inc;
+	*pd = NULL;
+
+	n = 0;
+	for (i = 0; i != ctx->num_rules; i++)
+		n += acl_inc_in_delta(inc->meta + i, seq);
+
+	if (n == 0)
+		return 0;
+
+	part = acl_inc_part_alloc(ctx, n);
+	if (part == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i != ctx->num_rules; i++) {
+		if (acl_inc_in_delta(inc->meta + i, seq))
+			acl_inc_part_add(part, acl_inc_rule(ctx, i));
+	}
+
+	rc = rte_acl_build(part->rt, &inc->cfg);
+	if (rc != 0) {
+		acl_inc_part_free(part);
+		return rc;
+	}
+
+	*pd = part;
+	return 0;
+}
+
+/*
+ * Rebuild delta tries and publish them along with current main tries.
+ * Called with the lock held.
+ */
+static int
+acl_inc_delta_update(struct rte_acl_ctx *ctx)
+{
+	int32_t rc;
+	struct acl_inc *inc;
+	struct acl_inc_part *delta;
+	struct acl_inc_view *view;
+
+	inc = ctx->inc;
+
+	rc = acl_inc_delta_build(ctx, 0, &delta);
+	if (rc != 0)
+		return rc;
+
+	view = acl_inc_view_alloc(ctx, inc->view->main, delta);
+	if (view == NULL) {
+		acl_inc_part_free(delta);
+		return -ENOMEM;
+	}
+
+	acl_inc_publish(inc, view);
+	return 0;
+}
+
+int
+acl_inc_add_rules(struct rte_acl_ctx *ctx, const void *rules, uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct acl_inc *inc;
+	struct acl_inc_meta *m;
+
+	inc = ctx->inc;
+	rte_spinlock_lock(&inc->lock);
+
+	n = ctx->num_rules;
+	if (inc->num_delta + num > inc->max_delta)
+		rc = -ENOSPC;
+	else if (n + num > ctx->max_rules)
+		rc = -ENOMEM;
+	else {
+		memcpy((void *)(uintptr_t)acl_inc_rule(ctx, n), rules,
+			num * ctx->rule_sz);
+		for (i = 0; i != num; i++) {
+			m = inc->meta + n + i;
+			m->seq = inc->seq + i;
+			m->main_idx = ACL_INC_DELTA;
+			m->del = 0;
+		}
+		ctx->num_rules = n + num;
+
+		rc = acl_inc_delta_update(ctx);
+		if (rc == 0) {
+			inc->seq += num;
+			inc->num_delta += num;
+		} else
+			ctx->num_rules = n;
+	}
+
+	rte_spinlock_unlock(&inc->lock);
+	return rc;
+}
+
+/*
+ * Get value of the rule field of given size in host byte order.
+ */
+static inline uint64_t
+acl_inc_field_value(const union rte_acl_field_types *f, uint32_t size)
+{
+	switch (size) {
+	case sizeof(uint8_t):
+		return f->u8;
+	case sizeof(uint16_t):
+		return f->u16;
+	case sizeof(uint32_t):
+		return f->u32;
+	default:
+		return f->u64;
+	}
+}
+
+/*
+ * Rules are equal if they have the same data and the same values
+ * of all fields used by the build config.
+ */
+static int
+acl_inc_rule_equal(const struct rte_acl_config *cfg,
+	const struct rte_acl_rule *a, const struct rte_acl_rule *b)
+{
+	uint32_t i, k, sz;
+
+	if (a->data.category_mask != b->data.category_mask ||
+			a->data.priority != b->data.priority ||
+			a->data.userdata != b->data.userdata)
+		return 0;
+
+	for (i = 0; i != cfg->num_fields; i++) {
+		k = cfg->defs[i].field_index;
+		sz = cfg->defs[i].size;
+		if (acl_inc_field_value(&a->field[k].value, sz) !=
+				acl_inc_field_value(&b->field[k].value, sz) ||
+				acl_inc_field_value(&a->field[k].mask_range,
+				sz) != acl_inc_field_value(
+				&b->field[k].mask_range, sz))
+			return 0;
+	}
+
+	return 1;
+}
+
+int
+rte_acl_del_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
+	uint32_t num)
+{
+	int32_t rc;
+	uint32_t i, j, n, nd;
+	const struct rte_acl_rule *rv;
+	struct acl_inc *inc;
+	struct acl_inc_meta *m;
+	struct acl_inc_part *main;
+
+	if (ctx == NULL || rules == NULL || ctx->inc == NULL)
+		return -EINVAL;
+
+	inc = ctx->inc;
+	rte_spinlock_lock(&inc->lock);
+
+	/* select rules to delete, all or nothing. */
+	rc = 0;
+	nd = 0;
+	n = ctx->num_rules;
+	for (i = 0; i != num && rc == 0; i++) {
+		rv = (const struct rte_acl_rule *)
+			((uintptr_t)rules + i * ctx->rule_sz);
+		for (j = 0; j != n; j++) {
+			if (inc->meta[j].del == 0 && acl_inc_rule_equal(
+					&inc->cfg, rv, acl_inc_rule(ctx, j)))
+				break;
+		}
+		if (j == n)
+			rc = -ENOENT;
+		else {
+			inc->meta[j].del = 1;
+			nd += (inc->meta[j].main_idx == ACL_INC_DELTA);
+		}
+	}
+
+	/* delta tries have to be rebuilt without deleted rules. */
+	if (rc == 0 && nd != 0)
+		rc = acl_inc_delta_update(ctx);
+
+	if (rc != 0) {
+		for (j = 0; j != n; j++)
+			inc->meta[j].del = 0;
+		rte_spinlock_unlock(&inc->lock);
+		return rc;
+	}
+
+	/* mask rules in the main tries and compact the rules array. */
+	main = inc->view->main;
+	for (j = n; j-- != 0; ) {
+		m = inc->meta + j;
+		if (m->del == 0)
+			continue;
+
+		if (m->main_idx == ACL_INC_DELTA)
+			inc->num_delta--;
+		else {
+			__atomic_store_n(&main->dead[m->main_idx], 1,
+				__ATOMIC_RELAXED);
+			__atomic_store_n(&main->num_dead, main->num_dead + 1,
+				__ATOMIC_RELEASE);
+		}
+
+		n--;
+		if (j != n) {
+			memcpy((void *)(uintptr_t)acl_inc_rule(ctx, j),
+				acl_inc_rule(ctx, n), ctx->rule_sz);
+			*m = inc->meta[n];
+		}
+	}
+	ctx->num_rules = n;
+
+	rte_spinlock_unlock(&inc->lock);
+	return 0;
+}
+
+static int
+acl_inc_seq_cmp(const void *a, const void *b)
+{
+	const struct acl_inc_seq *sa = a;
+	const struct acl_inc_seq *sb = b;
+
+	return (sa->seq > sb->seq) - (sa->seq < sb->seq);
+}
+
+static uint32_t
+acl_inc_seq_find(const struct acl_inc_seq *seq, uint32_t num, uint64_t val)
+{
+	uint32_t lo, hi, mid;
+
+	lo = 0;
+	hi = num;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (seq[mid].seq < val)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return seq[lo].idx;
+}
+
+int
+rte_acl_consolidate(struct rte_acl_ctx *ctx)
+{
+	int32_t rc;
+	uint32_t i, k, n;
+	uint64_t snap;
+	struct acl_inc *inc;
+	struct acl_inc_meta *m;
+	struct acl_inc_part *main, *delta;
+	struct acl_inc_seq *seq;
+	struct acl_inc_view *view;
+
+	if (ctx == NULL || ctx->inc == NULL)
+		return -EINVAL;
+
+	inc = ctx->inc;
+	rte_spinlock_lock(&inc->lock);
+
+	if (inc->consolidating != 0) {
+		rte_spinlock_unlock(&inc->lock);
+		return -EBUSY;
+	}
+
+	/* take a snapshot of all current rules. */
+	rc = 0;
+	main = NULL;
+	seq = NULL;
+	n = ctx->num_rules;
+	if (n != 0) {
+		main = acl_inc_part_alloc(ctx, n);
+		seq = rte_malloc_socket(NULL, n * sizeof(seq[0]), 0,
+			ctx->socket_id);
+		if (main == NULL || seq == NULL)
+			rc = -ENOMEM;
+		for (i = 0; i != n && rc == 0; i++) {
+			acl_inc_part_add(main, acl_inc_rule(ctx, i));
+			seq[i].seq = inc->meta[i].seq;
+			seq[i].idx = i;
+		}
+	}
+	snap = inc->seq;
+	inc->consolidating = (rc == 0);
+
+	rte_spinlock_unlock(&inc->lock);
+
+	if (rc != 0) {
+		acl_inc_part_free(main);
+		rte_free(seq);
+		return rc;
+	}
+
+	/* the expensive part, updates can go on meanwhile. */
+	if (main != NULL) {
+		rc = rte_acl_build(main->rt, &inc->cfg);
+		qsort(seq, n, sizeof(seq[0]), acl_inc_seq_cmp);
+	}
+
+	rte_spinlock_lock(&inc->lock);
+
+	/* rules added since the snapshot make up the new delta. */
+	delta = NULL;
+	view = NULL;
+	if (rc == 0)
+		rc = acl_inc_delta_build(ctx, snap, &delta);
+	if (rc == 0) {
+		view = acl_inc_view_alloc(ctx, main, delta);
+		if (view == NULL)
+			rc = -ENOMEM;
+	}
+
+	if (rc == 0) {
+		/*
+		 * re-map rules to the new main tries,
+		 * rules deleted since the snapshot stay masked.
+		 */
+		if (main != NULL)
+			memset(main->dead, 1, n);
+		k = 0;
+		for (i = 0; i != ctx->num_rules; i++) {
+			m = inc->meta + i;
+			if (m->seq < snap) {
+				m->main_idx = acl_inc_seq_find(seq, n, m->seq);
+				main->dead[m->main_idx] = 0;
+				k++;
+			}
+		}
+		if (main != NULL)
+			main->num_dead = n - k;
+
+		inc->num_delta = ctx->num_rules - k;
+		acl_inc_publish(inc, view);
+	} else {
+		acl_inc_part_free(main);
+		acl_inc_part_free(delta);
+	}
+
+	inc->consolidating = 0;
+	rte_spinlock_unlock(&inc->lock);
+
+	rte_free(seq);
+	return rc;
+}
+
+int
+rte_acl_build_incremental(struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t max_delta_rules)
+{
+	int32_t rc;
+	uint32_t i, n;
+	struct acl_inc *inc;
+	struct acl_inc_part *main;
+
+	if (ctx == NULL || cfg == NULL || max_delta_rules == 0)
+		return -EINVAL;
+
+	if (ctx->inc != NULL)
+		return -EEXIST;
+
+	rc = acl_check_bld_param(ctx, cfg);
+	if (rc != 0)
+		return rc;
+
+	inc = rte_zmalloc_socket("ACL_INC", sizeof(*inc), RTE_CACHE_LINE_SIZE,
+		ctx->socket_id);
+	if (inc == NULL)
+		return -ENOMEM;
+
+	inc->meta = rte_zmalloc_socket("ACL_INC_META",
+		RTE_MAX(ctx->max_rules, 1U) * sizeof(inc->meta[0]),
+		RTE_CACHE_LINE_SIZE, ctx->socket_id);
+	if (inc->meta == NULL) {
+		rte_free(inc);
+		return -ENOMEM;
+	}
+
+	rte_spinlock_init(&inc->lock);
+	inc->max_delta = max_delta_rules;
+	inc->cfg = *cfg;
+
+	/* all present rules go into the main tries. */
+	main = NULL;
+	n = ctx->num_rules;
+	if (n != 0) {
+		main = acl_inc_part_alloc(ctx, n);
+		if (main == NULL)
+			rc = -ENOMEM;
+		for (i = 0; i != n && rc == 0; i++) {
+			acl_inc_part_add(main, acl_inc_rule(ctx, i));
+			inc->meta[i].seq = i;
+			inc->meta[i].main_idx = i;
+		}
+		if (rc == 0)
+			rc = rte_acl_build(main->rt, cfg);
+	}
+	inc->seq = n;
+
+	if (rc == 0) {
+		inc->view = acl_inc_view_alloc(ctx, main, NULL);
+		if (inc->view == NULL)
+			rc = -ENOMEM;
+	}
+
+	if (rc != 0) {
+		acl_inc_part_free(main);
+		rte_free(inc->meta);
+		rte_free(inc);
+		return rc;
+	}
+
+	ctx->config = *cfg;
+	__atomic_store_n(&ctx->inc, inc, __ATOMIC_RELEASE);
+	return 0;
+}
+
+int
+rte_acl_rcu_qsbr_add(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rcu_config *cfg)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	struct acl_inc *inc;
+
+	if (ctx == NULL || cfg == NULL || cfg->v == NULL || ctx->inc == NULL)
+		return -EINVAL;
+
+	inc = ctx->inc;
+	if (inc->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_ACL_QSBR_MODE_SYNC) {
+		/* No other things to do. */
+	} else if (cfg->mode == RTE_ACL_QSBR_MODE_DQ) {
+		/* Init QSBR defer queue, updates are serialized already. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"ACL_RCU_%s", ctx->name);
+		params.name = rcu_dq_name;
+		params.flags = RTE_RCU_QSBR_DQ_MT_UNSAFE;
+		params.size = cfg->dq_size;
+		if (params.size == 0)
+			params.size = inc->max_delta;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_ACL_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(struct acl_inc_retire);
+		params.free_fn = acl_inc_rcu_free;
+		params.p = inc;
+		params.v = cfg->v;
+		inc->dq = rte_rcu_qsbr_dq_create(&params);
+		if (inc->dq == NULL) {
+			RTE_LOG(ERR, ACL, "ACL defer queue creation failed\n");
+			return -ENOMEM;
+		}
+	} else
+		return -EINVAL;
+
+	rte_spinlock_lock(&inc->lock);
+	inc->rcu_mode = cfg->mode;
+	inc->v = cfg->v;
+	rte_spinlock_unlock(&inc->lock);
+
+	return 0;
+}
+
+void
+acl_inc_free(struct rte_acl_ctx *ctx)
+{
+	struct acl_inc *inc;
+
+	inc = ctx->inc;
+	if (inc == NULL)
+		return;
+
+	ctx->inc = NULL;
+	if (inc->dq != NULL)
+		rte_rcu_qsbr_dq_delete(inc->dq);
+
+	acl_inc_part_free(inc->view->main);
+	acl_inc_part_free(inc->view->delta);
+	rte_free(inc->view);
+	rte_free(inc->meta);
+	rte_free(inc);
+}
+
+void
+acl_inc_dump(const struct rte_acl_ctx *ctx)
+{
+	const struct acl_inc *inc;
+	const struct acl_inc_part *main;
+
+	inc = ctx->inc;
+	main = inc->view->main;
+	printf("  max_delta_rules=%"PRIu32"\n", inc->max_delta);
+	printf("  delta_rules=%"PRIu32"\n", inc->num_delta);
+	printf("  masked_rules=%"PRIu32"\n",
+		(main != NULL) ? main->num_dead : 0);
+}
+
+/*
+ * Match one rule against input buffer field by field,
+ * the same way the run-time tries do.
+ */
+static int
+acl_inc_rule_match(const struct rte_acl_config *cfg,
+	const struct rte_acl_rule *r, const uint8_t *data)
+{
+	uint32_t i, k;
+	uint64_t in, mask, val;
+	const struct rte_acl_field *fld;
+	const struct rte_acl_field_def *def;
+
+	for (i = 0; i != cfg->num_fields; i++) {
+
+		def = cfg->defs + i;
+		fld = r->field + def->field_index;
+
+		/* input data is in network byte order. */
+		in = 0;
+		for (k = 0; k != def->size; k++)
+			in = in << CHAR_BIT | data[def->offset + k];
+
+		val = acl_inc_field_value(&fld->value, def->size);
+
+		switch (def->type) {
+		case RTE_ACL_FIELD_TYPE_BITMASK:
+			mask = acl_inc_field_value(&fld->mask_range,
+				def->size);
+			break;
+		case RTE_ACL_FIELD_TYPE_MASK:
+			mask = RTE_ACL_MASKLEN_TO_BITMASK(fld->mask_range.u32,
+				def->size);
+			mask &= RTE_LEN2MASK(def->size * CHAR_BIT, uint64_t);
+			break;
+		default:
+			/* RTE_ACL_FIELD_TYPE_RANGE */
+			if (in < val || in > acl_inc_field_value(
+					&fld->mask_range, def->size))
+				return 0;
+			continue;
+		}
+
+		if ((in & mask) != (val & mask))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Input buffer matched a deleted rule in the main tries:
+ * find the best of the remaining main rules by a linear scan.
+ */
+static void
+acl_inc_match_slow(const struct acl_inc *inc, const struct acl_inc_part *part,
+	const uint8_t *data, uint32_t *res, uint32_t categories)
+{
+	uint32_t c, i, msk;
+	int32_t prio[RTE_ACL_MAX_CATEGORIES];
+	const struct rte_acl_rule *r;
+
+	for (c = 0; c != categories; c++) {
+		res[c] = 0;
+		prio[c] = 0;
+	}
+
+	for (i = 0; i != part->num_rules; i++) {
+
+		if (__atomic_load_n(&part->dead[i], __ATOMIC_RELAXED) != 0)
+			continue;
+
+		r = acl_inc_rule(part->rt, i);
+		msk = r->data.category_mask &
+			RTE_LEN2MASK(RTE_MIN(categories,
+				inc->cfg.num_categories), uint32_t);
+		if (msk == 0 || acl_inc_rule_match(&inc->cfg, r, data) == 0)
+			continue;
+
+		for (c = 0; c != categories; c++) {
+			if ((msk & (1U << c)) != 0 &&
+					part->priority[i] > prio[c]) {
+				prio[c] = part->priority[i];
+				res[c] = i + 1;
+			}
+		}
+	}
+}
+
+/*
+ * Merge results from the main and delta tries by priority and
+ * convert them back into user defined userdata.
+ */
+static void
+acl_inc_merge(const struct acl_inc *inc, const struct acl_inc_view *view,
+	const uint8_t **data, uint32_t *results, const uint32_t *dres,
+	uint32_t num, uint32_t categories)
+{
+	uint32_t c, i, k, ud;
+	int32_t prio;
+	uint32_t *res;
+	const struct acl_inc_part *delta, *main;
+
+	main = view->main;
+	delta = view->delta;
+
+	for (i = 0; i != num; i++) {
+
+		res = results + i * categories;
+
+		/* re-match input that hit rules deleted from the main tries */
+		if (main != NULL && __atomic_load_n(&main->num_dead,
+				__ATOMIC_ACQUIRE) != 0) {
+			for (c = 0; c != categories; c++) {
+				k = res[c];
+				if (k != 0 && __atomic_load_n(&main->dead[k - 1],
+						__ATOMIC_RELAXED) != 0)
+					break;
+			}
+			if (c != categories)
+				acl_inc_match_slow(inc, main, data[i], res,
+					categories);
+		}
+
+		for (c = 0; c != categories; c++) {
+
+			prio = 0;
+			ud = 0;
+
+			k = res[c];
+			if (k != 0) {
+				prio = main->priority[k - 1];
+				ud = main->userdata[k - 1];
+			}
+
+			if (dres != NULL) {
+				k = dres[i * categories + c];
+				if (k != 0 && delta->priority[k - 1] > prio)
+					ud = delta->userdata[k - 1];
+			}
+
+			res[c] = ud;
+		}
+	}
+}
+
+int
+acl_inc_classify(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories,
+	rte_acl_classify_t classify)
+{
+	int32_t rc;
+	uint32_t i, n;
+	const struct acl_inc *inc;
+	const struct acl_inc_view *view;
+	uint32_t dres[ACL_INC_BURST * RTE_ACL_MAX_CATEGORIES];
+
+	inc = ctx->inc;
+	view = __atomic_load_n(&inc->view, __ATOMIC_ACQUIRE);
+
+	if (view->main != NULL) {
+		rc = classify(view->main->rt, data, results, num, categories);
+		if (rc != 0)
+			return rc;
+	} else
+		memset(results, 0, num * categories * sizeof(results[0]));
+
+	for (i = 0; i < num; i += n) {
+
+		n = RTE_MIN(num - i, (uint32_t)ACL_INC_BURST);
+
+		if (view->delta != NULL) {
+			rc = classify(view->delta->rt, data + i, dres, n,
+				categories);
+			if (rc != 0)
+				return rc;
+		}
+
+		acl_inc_merge(inc, view, data + i, results + i * categories,
+			(view->delta != NULL) ? dres : NULL, n, categories);
+	}
+
+	return 0;
+}
@@ -287,6 +287,16 @@ rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 	return 0;
 }
 
+int
+rte_acl_set_build_threads(struct rte_acl_ctx *ctx, uint32_t num_threads)
+{
+	if (ctx == NULL)
+		return -EINVAL;
+
+	ctx->num_threads = num_threads;
+	return 0;
+}
+
 int
 rte_acl_classify_alg(const struct rte_acl_ctx *ctx, const uint8_t **data,
 	uint32_t *results, uint32_t num, uint32_t categories,
@@ -296,6 +306,10 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx, const uint8_t **data,
 			((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0)
 		return -EINVAL;
 
+	if (unlikely(ctx->inc != NULL))
+		return acl_inc_classify(ctx, data, results, num, categories,
+			classify_fns[alg]);
+
 	return classify_fns[alg](ctx, data, results, num, categories);
 }
 
@@ -358,6 +372,7 @@ rte_acl_free(struct rte_acl_ctx *ctx)
 
 	rte_mcfg_tailq_write_unlock();
 
+	acl_inc_free(ctx);
 	rte_free(ctx->mem);
 	rte_free(ctx);
 	rte_free(te);
@@ -481,6 +496,9 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 		}
 	}
 
+	if (ctx->inc != NULL)
+		return acl_inc_add_rules(ctx, rules, num);
+
 	return acl_add_rules(ctx, rules, num);
 }
 
@@ -491,7 +509,7 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 void
 rte_acl_reset_rules(struct rte_acl_ctx *ctx)
 {
-	if (ctx != NULL)
+	if (ctx != NULL && ctx->inc == NULL)
 		ctx->num_rules = 0;
 }
 
@@ -502,6 +520,7 @@ void
 rte_acl_reset(struct rte_acl_ctx *ctx)
 {
 	if (ctx != NULL) {
+		acl_inc_free(ctx);
 		rte_acl_reset_rules(ctx);
 		rte_acl_build(ctx, &ctx->config);
 	}
@@ -524,6 +543,8 @@ rte_acl_dump(const struct rte_acl_ctx *ctx)
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
 	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
 	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	if (ctx->inc != NULL)
+		acl_inc_dump(ctx);
 }
 
 /*
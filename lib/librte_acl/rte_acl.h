@@ -12,6 +12,7 @@
  */
 
 #include <rte_acl_osdep.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -132,6 +133,35 @@ struct rte_acl_param {
 	uint32_t    max_rule_num; /**< Maximum number of rules. */
 };
 
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_ACL_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_acl_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_ACL_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_ACL_QSBR_MODE_SYNC
+};
+
+/** ACL RCU QSBR configuration structure. */
+struct rte_acl_rcu_config {
+	struct rte_rcu_qsbr *v;	/**< RCU QSBR variable. */
+	enum rte_acl_qsbr_mode mode;
+	/**< Mode of RCU QSBR. RTE_ACL_QSBR_MODE_xxx
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	uint32_t dq_size;
+	/**< RCU defer queue size.
+	 * default: maximum number of delta rules.
+	 */
+	uint32_t reclaim_thd;	/**< Threshold to trigger auto reclaim. */
+	uint32_t reclaim_max;
+	/**< Max entries to reclaim in one go.
+	 * default: RTE_ACL_RCU_DQ_RECLAIM_MAX.
+	 */
+};
+
 
 /**
  * Create a new ACL context.
@@ -171,7 +201,11 @@ rte_acl_free(struct rte_acl_ctx *ctx);
 
 /**
  * Add rules to an existing ACL context.
- * This function is not multi-thread safe.
+ * This function is not multi-thread safe, unless the context is in
+ * incremental mode (see rte_acl_build_incremental()). In that mode
+ * the new rules are placed into the delta trie, which is rebuilt
+ * before this function returns, so they are visible to
+ * rte_acl_classify() without a call to rte_acl_build().
  *
  * @param ctx
  *   ACL context to add patterns to.
@@ -185,6 +219,8 @@ rte_acl_free(struct rte_acl_ctx *ctx);
  *   Number of elements in the input array of rules.
  * @return
  *   - -ENOMEM if there is no space in the ACL context for these rules.
+ *   - -ENOSPC if the delta trie of an incremental context is full
+ *     and rte_acl_consolidate() has to be called first.
  *   - -EINVAL if the parameters are invalid.
  *   - Zero if operation completed successfully.
  */
@@ -196,6 +232,8 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
  * Delete all rules from the ACL context.
  * This function is not multi-thread safe.
  * Note that internal run-time structures are not affected.
+ * Has no effect on a context in incremental mode,
+ * use rte_acl_reset() or rte_acl_del_rules() instead.
  *
  * @param ctx
  *   ACL context to delete rules from.
@@ -214,12 +252,34 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
  * @return
  *   - -ENOMEM if couldn't allocate enough memory.
  *   - -EINVAL if the parameters are invalid.
+ *   - -EBUSY if the context is in incremental mode.
  *   - Negative error code if operation failed.
  *   - Zero if operation completed successfully.
  */
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the maximum number of threads, the calling one included, that
+ * the builds of the ACL context can use. The default is to build on the
+ * calling thread only.
+ *
+ * @param ctx
+ *   ACL context to change.
+ * @param num_threads
+ *   Maximum number of threads to build with,
+ *   0 or 1 means build on the calling thread only.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_set_build_threads(struct rte_acl_ctx *ctx, uint32_t num_threads);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -231,6 +291,119 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 void
 rte_acl_reset(struct rte_acl_ctx *ctx);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Build the ACL context and switch it into incremental mode.
+ * All rules added so far are built into the main tries. From then on
+ * rte_acl_add_rules() and rte_acl_del_rules() update the context in place:
+ * added rules go into a small delta trie that rte_acl_classify() searches
+ * alongside the main tries, removed rules are masked out of the main tries.
+ * rte_acl_consolidate() folds the delta back into the main tries.
+ * Readers always see a consistent set of tries; the replaced ones are
+ * reclaimed through the RCU QSBR variable given to rte_acl_rcu_qsbr_add(),
+ * or freed immediately if there is none.
+ * This function is not multi-thread safe.
+ *
+ * @param ctx
+ *   ACL context to build.
+ * @param cfg
+ *   Pointer to struct rte_acl_config - defines build parameters.
+ * @param max_delta_rules
+ *   Maximum number of rules the delta trie can hold.
+ *   Keep it small: the delta trie is rebuilt on every update.
+ * @return
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if the context is already in incremental mode.
+ *   - Negative error code if operation failed.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_build_incremental(struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t max_delta_rules);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete rules from an ACL context in incremental mode.
+ * Each rule is looked up by its data and by the values of the fields
+ * defined in the build config. Rules from the main tries are masked
+ * out until the next rte_acl_consolidate(); input that hits a masked rule
+ * is re-matched against the remaining rules on a slower path.
+ * This function is multi-thread safe with respect to rte_acl_add_rules()
+ * and rte_acl_consolidate() on the same context.
+ *
+ * @param ctx
+ *   ACL context to delete rules from.
+ * @param rules
+ *   Array of rules to delete.
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @return
+ *   - -ENOENT if any of the rules is not present, no rule is deleted then.
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -EINVAL if the parameters are invalid or the context
+ *     is not in incremental mode.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_del_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
+	uint32_t num);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Rebuild the main tries of an ACL context in incremental mode from
+ * all its current rules, empty the delta trie and drop masked rules.
+ * The rebuild runs without holding the context lock, so it is meant to
+ * be called from a background (e.g. service) lcore while the control
+ * lcore keeps adding and deleting rules; updates made during the rebuild
+ * stay in the delta trie. The new tries are swapped in atomically.
+ *
+ * @param ctx
+ *   ACL context to consolidate.
+ * @return
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -EINVAL if the context is not in incremental mode.
+ *   - -EBUSY if another consolidation is in progress.
+ *   - Negative error code if the build failed.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_consolidate(struct rte_acl_ctx *ctx);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Associate RCU QSBR variable with an ACL context in incremental mode.
+ * Tries replaced by rte_acl_add_rules(), rte_acl_del_rules() and
+ * rte_acl_consolidate() are freed only after all readers registered
+ * with the variable went through a quiescent state.
+ *
+ * @param ctx
+ *   ACL context to add RCU QSBR to.
+ * @param cfg
+ *   RCU QSBR configuration.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the context
+ *     is not in incremental mode.
+ *   - -EEXIST if QSBR was already added.
+ *   - -ENOMEM if the defer queue couldn't be created.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_rcu_qsbr_add(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rcu_config *cfg);
+
 /**
  *  Available implementations of ACL classify.
  */
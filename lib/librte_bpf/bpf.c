@@ -17,7 +17,11 @@
 void
 rte_bpf_destroy(struct rte_bpf *bpf)
 {
+	uint32_t i;
+
 	if (bpf != NULL) {
+		for (i = 0; i != bpf->nb_maps; i++)
+			rte_bpf_map_free(bpf->maps[i]);
 		if (bpf->jit.func != NULL)
 			munmap(bpf->jit.func, bpf->jit.sz);
 		munmap(bpf, bpf->sz);
@@ -6,6 +6,7 @@
 #define _BPF_H_
 
 #include <rte_bpf.h>
+#include <rte_bpf_map.h>
 #include <sys/mman.h>
 
 #ifdef __cplusplus
@@ -19,8 +20,21 @@ struct rte_bpf {
 	struct rte_bpf_jit jit;
 	size_t sz;
 	uint32_t stack_sz;
+	uint32_t nb_maps;
+	struct rte_bpf_map **maps; /* maps owned by this BPF handle */
 };
 
+/* external symbols for the map helpers, in enum rte_bpf_map_func order */
+extern const struct rte_bpf_xsym bpf_map_xsym[RTE_BPF_FUNC_MAP_NUM];
+
+extern const struct rte_bpf_map_def *
+bpf_map_def(const struct rte_bpf_map *map);
+
+extern const char *bpf_map_name(const struct rte_bpf_map *map);
+
+extern struct rte_bpf *bpf_load_maps(const struct rte_bpf_prm *prm,
+	struct rte_bpf_map *maps[], uint32_t nb_maps);
+
 extern int bpf_validate(struct rte_bpf *bpf);
 
 extern int bpf_jit(struct rte_bpf *bpf);
@@ -47,6 +61,22 @@ bpf_size(uint32_t bpf_op_sz)
 	return 0;
 }
 
+/*
+ * map helpers are appended to the user provided external symbols,
+ * if at least one of them is a map.
+ */
+static inline int
+bpf_has_maps(const struct rte_bpf_prm *prm)
+{
+	uint32_t i;
+
+	for (i = 0; i != prm->nb_xsym; i++) {
+		if (prm->xsym[i].type == RTE_BPF_XTYPE_MAP)
+			return 1;
+	}
+	return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,16 +21,19 @@
 #include "bpf_impl.h"
 
 static struct rte_bpf *
-bpf_load(const struct rte_bpf_prm *prm)
+bpf_load(const struct rte_bpf_prm *prm, struct rte_bpf_map *maps[],
+	uint32_t nb_maps)
 {
 	uint8_t *buf;
 	struct rte_bpf *bpf;
-	size_t sz, bsz, insz, xsz;
+	size_t sz, bsz, insz, xsz, hsz, msz;
 
 	xsz =  prm->nb_xsym * sizeof(prm->xsym[0]);
+	hsz = bpf_has_maps(prm) ? sizeof(bpf_map_xsym) : 0;
 	insz = prm->nb_ins * sizeof(prm->ins[0]);
+	msz = nb_maps * sizeof(maps[0]);
 	bsz = sizeof(bpf[0]);
-	sz = insz + xsz + bsz;
+	sz = insz + xsz + hsz + msz + bsz;
 
 	buf = mmap(NULL, sz, PROT_READ | PROT_WRITE,
 		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -42,11 +45,18 @@ bpf_load(const struct rte_bpf_prm *prm)
 
 	memcpy(&bpf->prm, prm, sizeof(bpf->prm));
 
+	/* map helpers go right after user provided symbols */
 	memcpy(buf + bsz, prm->xsym, xsz);
+	memcpy(buf + bsz + xsz, bpf_map_xsym, hsz);
+	xsz += hsz;
 	memcpy(buf + bsz + xsz, prm->ins, insz);
+	memcpy(buf + bsz + xsz + insz, maps, msz);
 
 	bpf->prm.xsym = (void *)(buf + bsz);
+	bpf->prm.nb_xsym = xsz / sizeof(prm->xsym[0]);
 	bpf->prm.ins = (void *)(buf + bsz + xsz);
+	bpf->maps = (void *)(buf + bsz + xsz + insz);
+	bpf->nb_maps = nb_maps;
 
 	return bpf;
 }
@@ -80,14 +90,31 @@ bpf_check_xsym(const struct rte_bpf_xsym *xsym)
 		if (xsym->func.ret.type != RTE_BPF_ARG_UNDEF &&
 				xsym->func.ret.size == 0)
 			return -EINVAL;
+	} else if (xsym->type == RTE_BPF_XTYPE_MAP) {
+		if (xsym->map.val == NULL)
+			return -EINVAL;
 	} else
 		return -EINVAL;
 
 	return 0;
 }
 
+static void
+bpf_free_maps(struct rte_bpf_map *maps[], uint32_t nb_maps)
+{
+	uint32_t i;
+
+	for (i = 0; i != nb_maps; i++)
+		rte_bpf_map_free(maps[i]);
+}
+
+/*
+ * Load BPF program, the maps given are owned by the new BPF handle
+ * (or freed in case of failure).
+ */
 struct rte_bpf *
-rte_bpf_load(const struct rte_bpf_prm *prm)
+bpf_load_maps(const struct rte_bpf_prm *prm, struct rte_bpf_map *maps[],
+	uint32_t nb_maps)
 {
 	struct rte_bpf *bpf;
 	int32_t rc;
@@ -95,6 +122,7 @@ rte_bpf_load(const struct rte_bpf_prm *prm)
 
 	if (prm == NULL || prm->ins == NULL ||
 			(prm->nb_xsym != 0 && prm->xsym == NULL)) {
+		bpf_free_maps(maps, nb_maps);
 		rte_errno = EINVAL;
 		return NULL;
 	}
@@ -104,13 +132,15 @@ rte_bpf_load(const struct rte_bpf_prm *prm)
 		rc = bpf_check_xsym(prm->xsym + i);
 
 	if (rc != 0) {
+		bpf_free_maps(maps, nb_maps);
 		rte_errno = -rc;
 		RTE_BPF_LOG(ERR, "%s: %d-th xsym is invalid\n", __func__, i);
 		return NULL;
 	}
 
-	bpf = bpf_load(prm);
+	bpf = bpf_load(prm, maps, nb_maps);
 	if (bpf == NULL) {
+		bpf_free_maps(maps, nb_maps);
 		rte_errno = ENOMEM;
 		return NULL;
 	}
@@ -131,6 +161,12 @@ rte_bpf_load(const struct rte_bpf_prm *prm)
 	return bpf;
 }
 
+struct rte_bpf *
+rte_bpf_load(const struct rte_bpf_prm *prm)
+{
+	return bpf_load_maps(prm, NULL, 0);
+}
+
 #ifndef RTE_LIBRTE_BPF_ELF
 struct rte_bpf *
 rte_bpf_elf_load(const struct rte_bpf_prm *prm, const char *fname,
@@ -4,6 +4,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <stdint.h>
@@ -32,6 +33,9 @@
 #define	EM_BPF	247
 #endif
 
+/* section with map definitions */
+#define	BPF_ELF_MAPS	"maps"
+
 static uint32_t
 bpf_find_xsym(const char *sn, enum rte_bpf_xtype type,
 	const struct rte_bpf_xsym fp[], uint32_t fn)
@@ -73,6 +77,22 @@ resolve_xsym(const char *sn, size_t ofs, struct ebpf_insn *ins, size_t ins_sz,
 		return -EINVAL;
 
 	fidx = bpf_find_xsym(sn, type, prm->xsym, prm->nb_xsym);
+
+	/* not a variable, might be a map */
+	if (fidx == UINT32_MAX && type == RTE_BPF_XTYPE_VAR) {
+		type = RTE_BPF_XTYPE_MAP;
+		fidx = bpf_find_xsym(sn, type, prm->xsym, prm->nb_xsym);
+	}
+
+	/* not a user function, might be a map helper */
+	if (fidx == UINT32_MAX && type == RTE_BPF_XTYPE_FUNC &&
+			bpf_has_maps(prm)) {
+		fidx = bpf_find_xsym(sn, type, bpf_map_xsym,
+			RTE_DIM(bpf_map_xsym));
+		if (fidx != UINT32_MAX)
+			fidx += prm->nb_xsym;
+	}
+
 	if (fidx == UINT32_MAX)
 		return -ENOENT;
 
@@ -90,6 +110,11 @@ resolve_xsym(const char *sn, size_t ofs, struct ebpf_insn *ins, size_t ins_sz,
 			ins[idx].src_reg = EBPF_REG_0;
 		}
 		ins[idx].imm = fidx;
+	/* for map we need to store its absolute address */
+	} else if (type == RTE_BPF_XTYPE_MAP) {
+		ins[idx].imm = (uintptr_t)prm->xsym[fidx].map.val;
+		ins[idx + 1].imm =
+			(uint64_t)(uintptr_t)prm->xsym[fidx].map.val >> 32;
 	/* for variable we need to store its absolute address */
 	} else {
 		ins[idx].imm = (uintptr_t)prm->xsym[fidx].var.val;
@@ -263,6 +288,174 @@ elf_reloc_code(Elf *elf, Elf_Data *ed, size_t sidx,
 	return rc;
 }
 
+/*
+ * maps defined in ELF file and external symbols to resolve them.
+ */
+struct elf_maps {
+	struct rte_bpf_xsym *xsym; /* user provided symbols + new maps */
+	uint32_t nb_xsym;
+	struct rte_bpf_map **maps; /* maps created by the loader */
+	uint32_t nb_maps;
+};
+
+static void
+elf_maps_free(struct elf_maps *em, int32_t free_maps)
+{
+	uint32_t i;
+
+	if (free_maps != 0) {
+		for (i = 0; i != em->nb_maps; i++)
+			rte_bpf_map_free(em->maps[i]);
+	}
+
+	free(em->xsym);
+	free(em->maps);
+}
+
+/*
+ * helper function, get map with given name and definition:
+ * either the one provided by the user, or a new one.
+ */
+static int
+elf_get_map(const char *sn, const struct rte_bpf_map_def *def,
+	const struct rte_bpf_prm *prm, struct elf_maps *em)
+{
+	uint32_t idx;
+	struct rte_bpf_map *map;
+	const struct rte_bpf_map_def *ud;
+	struct rte_bpf_map_prm mprm;
+
+	idx = bpf_find_xsym(sn, RTE_BPF_XTYPE_MAP, prm->xsym, prm->nb_xsym);
+	if (idx != UINT32_MAX) {
+		ud = bpf_map_def(prm->xsym[idx].map.val);
+		if (ud->type != def->type || ud->key_size != def->key_size ||
+				ud->value_size != def->value_size) {
+			RTE_BPF_LOG(ERR, "%s(%s): user provided map "
+				"doesn't match its definition\n",
+				__func__, sn);
+			return -EINVAL;
+		}
+		return 0;
+	}
+
+	memset(&mprm, 0, sizeof(mprm));
+	mprm.name = sn;
+	mprm.socket_id = SOCKET_ID_ANY;
+	mprm.def = *def;
+
+	map = rte_bpf_map_create(&mprm);
+	if (map == NULL) {
+		RTE_BPF_LOG(ERR, "%s(%s): failed to create map, "
+			"error code: %d\n", __func__, sn, rte_errno);
+		return -rte_errno;
+	}
+
+	em->maps[em->nb_maps++] = map;
+	em->xsym[em->nb_xsym++] = (struct rte_bpf_xsym) {
+		.name = bpf_map_name(map),
+		.type = RTE_BPF_XTYPE_MAP,
+		.map = { .val = map, },
+	};
+	return 0;
+}
+
+/*
+ * helper function, find maps section (if any) and get maps for all
+ * symbols defined in it.
+ */
+static int
+elf_load_maps(Elf *elf, const struct rte_bpf_prm *prm, struct elf_maps *em)
+{
+	int32_t rc;
+	uint32_t i, n, nb;
+	size_t midx, sz;
+	const char *sn;
+	const Elf64_Ehdr *eh;
+	const Elf64_Shdr *sh;
+	Elf_Scn *sc, *mc, *tc;
+	const Elf_Data *md, *sd;
+	const Elf64_Sym *sm;
+	struct rte_bpf_map_def def;
+
+	memset(em, 0, sizeof(*em));
+	eh = elf64_getehdr(elf);
+
+	/* find maps section and symbol table */
+	mc = NULL;
+	tc = NULL;
+	for (sc = elf_nextscn(elf, NULL); sc != NULL;
+			sc = elf_nextscn(elf, sc)) {
+		sh = elf64_getshdr(sc);
+		sn = elf_strptr(elf, eh->e_shstrndx, sh->sh_name);
+		if (sh->sh_type == SHT_SYMTAB)
+			tc = sc;
+		else if (sn != NULL && strcmp(sn, BPF_ELF_MAPS) == 0 &&
+				sh->sh_type == SHT_PROGBITS)
+			mc = sc;
+	}
+
+	if (mc == NULL)
+		return 0;
+
+	md = elf_getdata(mc, NULL);
+	sd = (tc != NULL) ? elf_getdata(tc, NULL) : NULL;
+	if (md == NULL || sd == NULL)
+		return -EINVAL;
+
+	midx = elf_ndxscn(mc);
+	sm = sd->d_buf;
+	n = sd->d_size / sizeof(sm[0]);
+
+	/* count map symbols */
+	for (i = 0, nb = 0; i != n; i++) {
+		if (sm[i].st_shndx == midx && sm[i].st_name != 0)
+			nb++;
+	}
+
+	em->xsym = calloc(prm->nb_xsym + nb, sizeof(em->xsym[0]));
+	em->maps = calloc(nb, sizeof(em->maps[0]));
+	if (em->xsym == NULL || (nb != 0 && em->maps == NULL)) {
+		elf_maps_free(em, 0);
+		return -ENOMEM;
+	}
+
+	if (prm->nb_xsym != 0)
+		memcpy(em->xsym, prm->xsym,
+			prm->nb_xsym * sizeof(em->xsym[0]));
+	em->nb_xsym = prm->nb_xsym;
+
+	rc = 0;
+	for (i = 0; i != n && rc == 0; i++) {
+
+		if (sm[i].st_shndx != midx || sm[i].st_name == 0)
+			continue;
+
+		/* accept shorter legacy definitions, with zeroes for the rest */
+		sz = sm[i].st_size;
+		if (sz == 0 || sz > sizeof(def))
+			sz = sizeof(def);
+		if (sz < offsetof(struct rte_bpf_map_def, flags) ||
+				sm[i].st_value + sz > md->d_size) {
+			rc = -EINVAL;
+			break;
+		}
+
+		memset(&def, 0, sizeof(def));
+		memcpy(&def, (const uint8_t *)md->d_buf + sm[i].st_value, sz);
+
+		/* same string table as used by relocations */
+		sn = elf_strptr(elf, eh->e_shstrndx, sm[i].st_name);
+		if (sn == NULL)
+			rc = -EINVAL;
+		else
+			rc = elf_get_map(sn, &def, prm, em);
+	}
+
+	if (rc != 0)
+		elf_maps_free(em, 1);
+	return rc;
+}
+
 static struct rte_bpf *
 bpf_load_elf(const struct rte_bpf_prm *prm, int32_t fd, const char *section)
 {
@@ -272,19 +465,33 @@ bpf_load_elf(const struct rte_bpf_prm *prm, int32_t fd, const char *section)
 	int32_t rc;
 	struct rte_bpf *bpf;
 	struct rte_bpf_prm np;
+	struct elf_maps em;
 
 	elf_version(EV_CURRENT);
 	elf = elf_begin(fd, ELF_C_READ, NULL);
 
+	np = prm[0];
+	memset(&em, 0, sizeof(em));
+
 	rc = find_elf_code(elf, section, &sd, &sidx);
 	if (rc == 0)
-		rc = elf_reloc_code(elf, sd, sidx, prm);
+		rc = elf_load_maps(elf, prm, &em);
+	if (rc == 0) {
+		if (em.xsym != NULL) {
+			np.xsym = em.xsym;
+			np.nb_xsym = em.nb_xsym;
+		}
+		rc = elf_reloc_code(elf, sd, sidx, &np);
+		if (rc != 0)
+			elf_maps_free(&em, 1);
+	}
 
 	if (rc == 0) {
-		np = prm[0];
 		np.ins = sd->d_buf;
 		np.nb_ins = sd->d_size / sizeof(struct ebpf_insn);
-		bpf = rte_bpf_load(&np);
+		/* new BPF handle owns the created maps */
+		bpf = bpf_load_maps(&np, em.maps, em.nb_maps);
+		elf_maps_free(&em, 0);
 	} else {
 		bpf = NULL;
 		rte_errno = -rc;
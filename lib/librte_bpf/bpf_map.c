@@ -0,0 +1,681 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_hash.h>
+#include <rte_lcore.h>
+#include <rte_lpm.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
+#include <rte_spinlock.h>
+#include <rte_string_fns.h>
+
+#include "bpf_impl.h"
+
+#define	BPF_MAP_NAMESIZE	64
+
+/* max number of entries, LPM next hop is 24 bits wide */
+#define	BPF_MAP_LPM_MAX_ENTRIES	(1 << 24)
+
+/* default max number of LPM tbl8 groups */
+#define	BPF_MAP_LPM_TBL8S_DEFAULT	256
+
+/* max number of value slots to reclaim in one go */
+#define	BPF_MAP_RCU_DQ_RECLAIM_MAX	16
+
+/* min number of entries accepted by rte_hash */
+#define	BPF_MAP_HASH_MIN_ENTRIES	8
+
+/* update all lcore copies of the value */
+#define	BPF_MAP_LCORE_ALL	UINT32_MAX
+
+struct rte_bpf_map {
+	char name[BPF_MAP_NAMESIZE];
+	struct rte_bpf_map_def def;
+	uint32_t value_sz;  /* value size, aligned to 8B */
+	size_t lcore_sz;    /* size of all values for one lcore */
+	uint8_t *values;
+	struct rte_hash *hash;
+	struct rte_lpm *lpm;
+	rte_spinlock_t lock; /* serializes updates of hash and LPM maps */
+	uint32_t nb_free;
+	uint32_t *free_idx;  /* free value slots for hash and LPM maps */
+	struct rte_rcu_qsbr_dq *dq; /* deleted value slots in grace period */
+};
+
+/*
+ * Names of the tables and of the defer queue of a map are made unique,
+ * across processes too, from the map address. They are kept short, as
+ * the hash and LPM libraries prefix them to name the rings of their own
+ * defer queues ("HASH_RCU_", "LPM_RCU_"), within RTE_RING_NAMESIZE.
+ */
+#define	BPF_MAP_TABLE_NAME_FMT	"bpfm_%" PRIxPTR
+#define	BPF_MAP_DQ_NAME_FMT	"bpfd_%" PRIxPTR
+
+/* maps are cache line aligned, the low bits of the address are zero */
+static inline uintptr_t
+map_name_id(const struct rte_bpf_map *map)
+{
+	return (uintptr_t)map / RTE_CACHE_LINE_SIZE;
+}
+
+static inline uint32_t
+map_lcore_id(void)
+{
+	uint32_t lcore_id;
+
+	lcore_id = rte_lcore_id();
+	return (lcore_id < RTE_MAX_LCORE) ? lcore_id : RTE_MAX_LCORE;
+}
+
+static inline void *
+map_value(const struct rte_bpf_map *map, uint32_t lcore_id, uint32_t idx)
+{
+	return map->values + lcore_id * map->lcore_sz +
+		(size_t)idx * map->value_sz;
+}
+
+static inline uint32_t
+map_value_idx(const struct rte_bpf_map *map, const void *value)
+{
+	return ((const uint8_t *)value - map->values) / map->value_sz;
+}
+
+static int
+map_check_def(const struct rte_bpf_map_def *def)
+{
+	if (def->key_size == 0 || def->value_size == 0 ||
+			def->max_entries == 0 || def->flags != 0)
+		return -EINVAL;
+
+	switch (def->type) {
+	case RTE_BPF_MAP_TYPE_ARRAY:
+	case RTE_BPF_MAP_TYPE_LCORE_ARRAY:
+		if (def->key_size != sizeof(uint32_t))
+			return -EINVAL;
+		break;
+	case RTE_BPF_MAP_TYPE_HASH:
+		break;
+	case RTE_BPF_MAP_TYPE_LPM:
+		if (def->key_size != sizeof(struct rte_bpf_map_lpm_key) ||
+				def->max_entries > BPF_MAP_LPM_MAX_ENTRIES)
+			return -EINVAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+map_create_hash(struct rte_bpf_map *map, const char *name,
+	const struct rte_bpf_map_prm *prm)
+{
+	struct rte_hash_parameters hprm;
+	struct rte_hash_rcu_config rcfg;
+
+	memset(&hprm, 0, sizeof(hprm));
+	hprm.name = name;
+	hprm.entries = RTE_MAX(map->def.max_entries,
+		(uint32_t)BPF_MAP_HASH_MIN_ENTRIES);
+	hprm.key_len = map->def.key_size;
+	hprm.socket_id = prm->socket_id;
+	hprm.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+
+	map->hash = rte_hash_create(&hprm);
+	if (map->hash == NULL)
+		return -rte_errno;
+
+	if (prm->v == NULL)
+		return 0;
+
+	/* hash frees the deleted key slots after the grace period */
+	memset(&rcfg, 0, sizeof(rcfg));
+	rcfg.v = prm->v;
+	rcfg.mode = RTE_HASH_QSBR_MODE_DQ;
+	if (rte_hash_rcu_qsbr_add(map->hash, &rcfg) != 0)
+		return -rte_errno;
+
+	return 0;
+}
+
+static int
+map_create_lpm(struct rte_bpf_map *map, const char *name,
+	const struct rte_bpf_map_prm *prm)
+{
+	struct rte_lpm_config cfg;
+	struct rte_lpm_rcu_config rcfg;
+
+	/* each tbl8 group covers one /24 with longer prefixes in it */
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.max_rules = map->def.max_entries;
+	cfg.number_tbl8s = prm->lpm_number_tbl8s;
+	if (cfg.number_tbl8s == 0)
+		cfg.number_tbl8s = RTE_MIN(map->def.max_entries,
+			(uint32_t)BPF_MAP_LPM_TBL8S_DEFAULT);
+
+	map->lpm = rte_lpm_create(name, prm->socket_id, &cfg);
+	if (map->lpm == NULL)
+		return -rte_errno;
+
+	if (prm->v == NULL)
+		return 0;
+
+	/* LPM frees the deleted tbl8 groups after the grace period */
+	memset(&rcfg, 0, sizeof(rcfg));
+	rcfg.v = prm->v;
+	rcfg.mode = RTE_LPM_QSBR_MODE_DQ;
+	if (rte_lpm_rcu_qsbr_add(map->lpm, &rcfg) != 0)
+		return -rte_errno;
+
+	return 0;
+}
+
+static void
+map_free_value_slot(void *p, void *e, unsigned int n)
+{
+	uint32_t i;
+	struct rte_bpf_map *map;
+	const uint32_t *idx;
+
+	map = p;
+	idx = e;
+	for (i = 0; i != n; i++)
+		map->free_idx[map->nb_free++] = idx[i];
+}
+
+static int
+map_create_dq(struct rte_bpf_map *map, const struct rte_bpf_map_prm *prm)
+{
+	struct rte_rcu_qsbr_dq_parameters dprm;
+	char name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	snprintf(name, sizeof(name), BPF_MAP_DQ_NAME_FMT, map_name_id(map));
+
+	/* every value slot can wait in the queue at most once */
+	memset(&dprm, 0, sizeof(dprm));
+	dprm.name = name;
+	dprm.size = map->def.max_entries;
+	dprm.esize = sizeof(map->free_idx[0]);
+	dprm.max_reclaim_size = BPF_MAP_RCU_DQ_RECLAIM_MAX;
+	dprm.free_fn = map_free_value_slot;
+	dprm.p = map;
+	dprm.v = prm->v;
+
+	map->dq = rte_rcu_qsbr_dq_create(&dprm);
+	return (map->dq == NULL) ? -rte_errno : 0;
+}
+
+/* returns value slot of the deleted element to the free list */
+static void
+map_put_value_slot(struct rte_bpf_map *map, uint32_t idx)
+{
+	if (map->dq == NULL)
+		map->free_idx[map->nb_free++] = idx;
+	else if (rte_rcu_qsbr_dq_enqueue(map->dq, &idx) != 0)
+		RTE_BPF_LOG(ERR, "%s(%s): failed to defer free of slot %u\n",
+			__func__, map->name, idx);
+}
+
+/* gets value slot for the new element, reclaims the deleted ones if needed */
+static int
+map_get_value_slot(struct rte_bpf_map *map, uint32_t *idx)
+{
+	if (map->nb_free == 0 && map->dq != NULL)
+		rte_rcu_qsbr_dq_reclaim(map->dq, map->def.max_entries,
+			NULL, NULL, NULL);
+	if (map->nb_free == 0)
+		return -ENOSPC;
+
+	*idx = map->free_idx[--map->nb_free];
+	return 0;
+}
+
+struct rte_bpf_map *
+rte_bpf_map_create(const struct rte_bpf_map_prm *prm)
+{
+	int32_t rc;
+	uint32_t i, n;
+	size_t sz, vsz, fsz;
+	struct rte_bpf_map *map;
+	char name[RTE_HASH_NAMESIZE];
+
+	if (prm == NULL || prm->name == NULL ||
+			map_check_def(&prm->def) != 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	vsz = RTE_ALIGN_CEIL(prm->def.value_size, sizeof(uint64_t));
+	sz = (size_t)prm->def.max_entries * vsz;
+
+	/* one extra copy of values for non-EAL threads */
+	n = 1;
+	if (prm->def.type == RTE_BPF_MAP_TYPE_LCORE_ARRAY) {
+		sz = RTE_ALIGN_CEIL(sz, RTE_CACHE_LINE_SIZE);
+		n = RTE_MAX_LCORE + 1;
+	}
+
+	fsz = 0;
+	if (prm->def.type == RTE_BPF_MAP_TYPE_HASH ||
+			prm->def.type == RTE_BPF_MAP_TYPE_LPM)
+		fsz = prm->def.max_entries * sizeof(map->free_idx[0]);
+
+	map = rte_zmalloc_socket(prm->name,
+		RTE_ALIGN_CEIL(sizeof(*map), RTE_CACHE_LINE_SIZE) + n * sz +
+		fsz, RTE_CACHE_LINE_SIZE, prm->socket_id);
+	if (map == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	strlcpy(map->name, prm->name, sizeof(map->name));
+	map->def = prm->def;
+	map->value_sz = vsz;
+	map->lcore_sz = sz;
+	map->values = (uint8_t *)map +
+		RTE_ALIGN_CEIL(sizeof(*map), RTE_CACHE_LINE_SIZE);
+	rte_spinlock_init(&map->lock);
+
+	if (fsz != 0) {
+		map->free_idx = (uint32_t *)(map->values + n * sz);
+		map->nb_free = prm->def.max_entries;
+		for (i = 0; i != map->nb_free; i++)
+			map->free_idx[i] = map->nb_free - i - 1;
+	}
+
+	/* map names are not unique, names of the tables have to be */
+	snprintf(name, sizeof(name), BPF_MAP_TABLE_NAME_FMT, map_name_id(map));
+
+	rc = 0;
+	if (prm->def.type == RTE_BPF_MAP_TYPE_HASH)
+		rc = map_create_hash(map, name, prm);
+	else if (prm->def.type == RTE_BPF_MAP_TYPE_LPM)
+		rc = map_create_lpm(map, name, prm);
+
+	if (rc == 0 && fsz != 0 && prm->v != NULL)
+		rc = map_create_dq(map, prm);
+
+	if (rc != 0) {
+		RTE_BPF_LOG(ERR, "%s(%s) failed, error code: %d\n",
+			__func__, prm->name, rc);
+		rte_bpf_map_free(map);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	return map;
+}
+
+void
+rte_bpf_map_free(struct rte_bpf_map *map)
+{
+	if (map == NULL)
+		return;
+
+	if (map->dq != NULL)
+		rte_rcu_qsbr_dq_delete(map->dq);
+	rte_hash_free(map->hash);
+	rte_lpm_free(map->lpm);
+	rte_free(map);
+}
+
+struct rte_bpf_map *
+rte_bpf_map_get(const struct rte_bpf *bpf, const char *name)
+{
+	uint32_t i;
+	const struct rte_bpf_xsym *xsym;
+
+	if (bpf == NULL || name == NULL)
+		return NULL;
+
+	for (i = 0; i != bpf->prm.nb_xsym; i++) {
+		xsym = bpf->prm.xsym + i;
+		if (xsym->type == RTE_BPF_XTYPE_MAP &&
+				strcmp(xsym->name, name) == 0)
+			return xsym->map.val;
+	}
+
+	return NULL;
+}
+
+const struct rte_bpf_map_def *
+bpf_map_def(const struct rte_bpf_map *map)
+{
+	return &map->def;
+}
+
+const char *
+bpf_map_name(const struct rte_bpf_map *map)
+{
+	return map->name;
+}
+
+void *
+rte_bpf_map_lookup_lcore(const struct rte_bpf_map *map, const void *key,
+	uint32_t lcore_id)
+{
+	uint32_t idx;
+	void *data;
+	struct rte_bpf_map_lpm_key lk;
+
+	switch (map->def.type) {
+	case RTE_BPF_MAP_TYPE_ARRAY:
+		lcore_id = 0;
+		/* fallthrough */
+	case RTE_BPF_MAP_TYPE_LCORE_ARRAY:
+		memcpy(&idx, key, sizeof(idx));
+		if (idx >= map->def.max_entries || lcore_id > RTE_MAX_LCORE)
+			return NULL;
+		return map_value(map, lcore_id, idx);
+	case RTE_BPF_MAP_TYPE_HASH:
+		if (rte_hash_lookup_data(map->hash, key, &data) < 0)
+			return NULL;
+		return data;
+	case RTE_BPF_MAP_TYPE_LPM:
+		memcpy(&lk, key, sizeof(lk));
+		if (rte_lpm_lookup(map->lpm, lk.ip, &idx) != 0)
+			return NULL;
+		return map_value(map, 0, idx);
+	}
+
+	return NULL;
+}
+
+void *
+rte_bpf_map_lookup_elem(const struct rte_bpf_map *map, const void *key)
+{
+	return rte_bpf_map_lookup_lcore(map, key, map_lcore_id());
+}
+
+static int
+map_array_update(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags, uint32_t lcore_id)
+{
+	uint32_t i, idx, n;
+
+	memcpy(&idx, key, sizeof(idx));
+	if (idx >= map->def.max_entries)
+		return -EINVAL;
+	if (flags == RTE_BPF_MAP_NOEXIST)
+		return -EEXIST;
+
+	i = 0;
+	n = 1;
+	if (map->def.type == RTE_BPF_MAP_TYPE_LCORE_ARRAY) {
+		if (lcore_id == BPF_MAP_LCORE_ALL)
+			n = RTE_MAX_LCORE + 1;
+		else
+			i = lcore_id;
+	}
+
+	for (n += i; i != n; i++)
+		memcpy(map_value(map, i, idx), value, map->def.value_size);
+
+	return 0;
+}
+
+static int
+map_hash_update(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags)
+{
+	int32_t rc;
+	uint32_t idx;
+	void *data;
+
+	if (rte_hash_lookup_data(map->hash, key, &data) >= 0) {
+		if (flags == RTE_BPF_MAP_NOEXIST)
+			return -EEXIST;
+		memcpy(data, value, map->def.value_size);
+		return 0;
+	}
+
+	if (flags == RTE_BPF_MAP_EXIST)
+		return -ENOENT;
+	if (map_get_value_slot(map, &idx) != 0)
+		return -ENOSPC;
+
+	/* fill the value before the key becomes visible to the readers */
+	data = map_value(map, 0, idx);
+	memcpy(data, value, map->def.value_size);
+
+	rc = rte_hash_add_key_data(map->hash, key, data);
+	if (rc != 0)
+		map->free_idx[map->nb_free++] = idx;
+	return rc;
+}
+
+static int
+map_lpm_update(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags)
+{
+	int32_t rc;
+	uint32_t idx;
+	struct rte_bpf_map_lpm_key lk;
+
+	memcpy(&lk, key, sizeof(lk));
+	if (lk.depth == 0 || lk.depth > RTE_LPM_MAX_DEPTH)
+		return -EINVAL;
+
+	if (rte_lpm_is_rule_present(map->lpm, lk.ip, lk.depth, &idx) == 1) {
+		if (flags == RTE_BPF_MAP_NOEXIST)
+			return -EEXIST;
+		memcpy(map_value(map, 0, idx), value, map->def.value_size);
+		return 0;
+	}
+
+	if (flags == RTE_BPF_MAP_EXIST)
+		return -ENOENT;
+	if (map_get_value_slot(map, &idx) != 0)
+		return -ENOSPC;
+
+	memcpy(map_value(map, 0, idx), value, map->def.value_size);
+
+	rc = rte_lpm_add(map->lpm, lk.ip, lk.depth, idx);
+	if (rc != 0)
+		map->free_idx[map->nb_free++] = idx;
+	return rc;
+}
+
+static int
+map_update(struct rte_bpf_map *map, const void *key, const void *value,
+	uint64_t flags, uint32_t lcore_id)
+{
+	int32_t rc;
+
+	switch (map->def.type) {
+	case RTE_BPF_MAP_TYPE_ARRAY:
+	case RTE_BPF_MAP_TYPE_LCORE_ARRAY:
+		return map_array_update(map, key, value, flags, lcore_id);
+	case RTE_BPF_MAP_TYPE_HASH:
+		rte_spinlock_lock(&map->lock);
+		rc = map_hash_update(map, key, value, flags);
+		rte_spinlock_unlock(&map->lock);
+		return rc;
+	case RTE_BPF_MAP_TYPE_LPM:
+		rte_spinlock_lock(&map->lock);
+		rc = map_lpm_update(map, key, value, flags);
+		rte_spinlock_unlock(&map->lock);
+		return rc;
+	}
+
+	return -EINVAL;
+}
+
+int
+rte_bpf_map_update_elem(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags)
+{
+	if (map == NULL || key == NULL || value == NULL ||
+			flags > RTE_BPF_MAP_EXIST)
+		return -EINVAL;
+
+	return map_update(map, key, value, flags, BPF_MAP_LCORE_ALL);
+}
+
+static int
+map_hash_delete(struct rte_bpf_map *map, const void *key)
+{
+	int32_t pos;
+	void *data;
+
+	if (rte_hash_lookup_data(map->hash, key, &data) < 0)
+		return -ENOENT;
+
+	pos = rte_hash_del_key(map->hash, key);
+	if (pos < 0)
+		return pos;
+
+	/*
+	 * lock-free hash doesn't free the key slot on delete,
+	 * unless it does so itself after the grace period
+	 */
+	if (map->dq == NULL)
+		rte_hash_free_key_with_position(map->hash, pos);
+	map_put_value_slot(map, map_value_idx(map, data));
+	return 0;
+}
+
+static int
+map_lpm_delete(struct rte_bpf_map *map, const void *key)
+{
+	int32_t rc;
+	uint32_t idx;
+	struct rte_bpf_map_lpm_key lk;
+
+	memcpy(&lk, key, sizeof(lk));
+	if (lk.depth == 0 || lk.depth > RTE_LPM_MAX_DEPTH)
+		return -EINVAL;
+
+	if (rte_lpm_is_rule_present(map->lpm, lk.ip, lk.depth, &idx) != 1)
+		return -ENOENT;
+
+	rc = rte_lpm_delete(map->lpm, lk.ip, lk.depth);
+	if (rc == 0)
+		map_put_value_slot(map, idx);
+	return rc;
+}
+
+int
+rte_bpf_map_delete_elem(struct rte_bpf_map *map, const void *key)
+{
+	int32_t rc;
+
+	if (map == NULL || key == NULL)
+		return -EINVAL;
+
+	switch (map->def.type) {
+	case RTE_BPF_MAP_TYPE_HASH:
+		rte_spinlock_lock(&map->lock);
+		rc = map_hash_delete(map, key);
+		rte_spinlock_unlock(&map->lock);
+		return rc;
+	case RTE_BPF_MAP_TYPE_LPM:
+		rte_spinlock_lock(&map->lock);
+		rc = map_lpm_delete(map, key);
+		rte_spinlock_unlock(&map->lock);
+		return rc;
+	}
+
+	/* array elements can't be deleted */
+	return -EINVAL;
+}
+
+/*
+ * Map helpers, as called by BPF programs.
+ * Their arguments are checked by the verifier against the map definition.
+ */
+
+static uint64_t
+bpf_map_lookup_helper(uint64_t map, uint64_t key, uint64_t a3, uint64_t a4,
+	uint64_t a5)
+{
+	RTE_SET_USED(a3);
+	RTE_SET_USED(a4);
+	RTE_SET_USED(a5);
+
+	return (uintptr_t)rte_bpf_map_lookup_elem(
+		(const struct rte_bpf_map *)(uintptr_t)map,
+		(const void *)(uintptr_t)key);
+}
+
+static uint64_t
+bpf_map_update_helper(uint64_t map, uint64_t key, uint64_t value,
+	uint64_t flags, uint64_t a5)
+{
+	RTE_SET_USED(a5);
+
+	if (flags > RTE_BPF_MAP_EXIST)
+		return (uint64_t)-EINVAL;
+
+	/* program updates its own copy of lcore array */
+	return (int64_t)map_update((struct rte_bpf_map *)(uintptr_t)map,
+		(const void *)(uintptr_t)key, (const void *)(uintptr_t)value,
+		flags, map_lcore_id());
+}
+
+static uint64_t
+bpf_map_delete_helper(uint64_t map, uint64_t key, uint64_t a3, uint64_t a4,
+	uint64_t a5)
+{
+	RTE_SET_USED(a3);
+	RTE_SET_USED(a4);
+	RTE_SET_USED(a5);
+
+	return (int64_t)rte_bpf_map_delete_elem(
+		(struct rte_bpf_map *)(uintptr_t)map,
+		(const void *)(uintptr_t)key);
+}
+
+const struct rte_bpf_xsym bpf_map_xsym[RTE_BPF_FUNC_MAP_NUM] = {
+	[RTE_BPF_FUNC_MAP_LOOKUP_ELEM] = {
+		.name = "bpf_map_lookup_elem",
+		.type = RTE_BPF_XTYPE_FUNC,
+		.func = {
+			.val = bpf_map_lookup_helper,
+			.nb_args = 2,
+			.args = {
+				[0] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+				[1] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+			},
+			.ret = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+		},
+	},
+	[RTE_BPF_FUNC_MAP_UPDATE_ELEM] = {
+		.name = "bpf_map_update_elem",
+		.type = RTE_BPF_XTYPE_FUNC,
+		.func = {
+			.val = bpf_map_update_helper,
+			.nb_args = 4,
+			.args = {
+				[0] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+				[1] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+				[2] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+				[3] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+			},
+			.ret = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+		},
+	},
+	[RTE_BPF_FUNC_MAP_DELETE_ELEM] = {
+		.name = "bpf_map_delete_elem",
+		.type = RTE_BPF_XTYPE_FUNC,
+		.func = {
+			.val = bpf_map_delete_helper,
+			.nb_args = 2,
+			.args = {
+				[0] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+				[1] = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+			},
+			.ret = { .type = RTE_BPF_ARG_RAW, .size = 8, },
+		},
+	},
+};
@@ -17,8 +17,15 @@
 
 #define BPF_ARG_PTR_STACK RTE_BPF_ARG_RESERVED
 
+/* pointer to the map itself, can be passed to map helpers only */
+#define BPF_ARG_PTR_MAP (RTE_BPF_ARG_RESERVED + 1)
+
+/* value returned by map lookup, has to be checked for NULL before use */
+#define BPF_ARG_PTR_OR_NULL (RTE_BPF_ARG_PTR - 1)
+
 struct bpf_reg_val {
 	struct rte_bpf_arg v;
+	const struct rte_bpf_map *map;
 	uint64_t mask;
 	struct {
 		int64_t min;
@@ -200,6 +207,16 @@ eval_ld_imm64(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 			eval_fill_imm64(rd, UINT64_MAX, 0);
 			break;
 		}
+
+		/* load of map address */
+		if (bvf->prm->xsym[i].type == RTE_BPF_XTYPE_MAP &&
+				(uintptr_t)bvf->prm->xsym[i].map.val == val) {
+			rd->v.type = BPF_ARG_PTR_MAP;
+			rd->v.size = 0;
+			rd->map = bvf->prm->xsym[i].map.val;
+			eval_fill_imm64(rd, UINT64_MAX, 0);
+			break;
+		}
 	}
 
 	return NULL;
@@ -964,11 +981,79 @@ eval_func_arg(struct bpf_verifier *bvf, const struct rte_bpf_arg *arg,
 	return err;
 }
 
+/*
+ * check key/value argument of the map helper:
+ * it should point to the initialized memory of the given size.
+ */
+static const char *
+eval_map_arg(struct bpf_verifier *bvf, const struct bpf_reg_val *rv,
+	uint32_t size)
+{
+	uint32_t i, n;
+	const char *err;
+	struct bpf_reg_val rm;
+	const struct bpf_reg_val *sv;
+
+	rm = *rv;
+	err = eval_ptr(bvf, &rm, size, 1, 0);
+	if (err != NULL)
+		return err;
+
+	if (rm.v.type == BPF_ARG_PTR_STACK) {
+		i = rm.u.max / sizeof(uint64_t);
+		n = (rm.u.max + size + sizeof(uint64_t) - 1) /
+			sizeof(uint64_t);
+		for (sv = bvf->evst->sv + i; i != n; i++, sv++) {
+			if (sv->v.type == RTE_BPF_ARG_UNDEF)
+				return "undefined map argument on the stack";
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * evaluate call to the map helper, arguments are checked against
+ * definition of the map passed in R1.
+ */
+static const char *
+eval_map_call(struct bpf_verifier *bvf, uint32_t fn, struct rte_bpf_arg *ret)
+{
+	const char *err;
+	const struct rte_bpf_map_def *def;
+	const struct bpf_reg_val *rv;
+
+	rv = bvf->evst->rv;
+
+	if (rv[EBPF_REG_1].v.type != BPF_ARG_PTR_MAP ||
+			rv[EBPF_REG_1].u.min != 0 ||
+			rv[EBPF_REG_1].u.max != 0)
+		return "map helper expects map pointer as the first argument";
+
+	def = bpf_map_def(rv[EBPF_REG_1].map);
+
+	err = eval_map_arg(bvf, rv + EBPF_REG_2, def->key_size);
+	if (err == NULL && fn == RTE_BPF_FUNC_MAP_UPDATE_ELEM) {
+		err = eval_map_arg(bvf, rv + EBPF_REG_3, def->value_size);
+		if (err == NULL)
+			err = eval_defined(NULL, rv + EBPF_REG_4);
+	}
+
+	/* value pointer might be NULL, has to be checked by the program */
+	if (fn == RTE_BPF_FUNC_MAP_LOOKUP_ELEM) {
+		ret->type = BPF_ARG_PTR_OR_NULL;
+		ret->size = def->value_size;
+	}
+
+	return err;
+}
+
 static const char *
 eval_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 {
 	uint32_t i, idx;
 	struct bpf_reg_val *rv;
+	struct rte_bpf_arg ret;
 	const struct rte_bpf_xsym *xsym;
 	const char *err;
 
@@ -984,11 +1069,22 @@ eval_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 
 	xsym = bvf->prm->xsym + idx;
 
+	ret = xsym->func.ret;
+
+	/* map helper */
+	for (i = 0; i != RTE_DIM(bpf_map_xsym) &&
+			xsym->func.val != bpf_map_xsym[i].func.val; i++)
+		;
+
 	/* evaluate function arguments */
-	err = NULL;
-	for (i = 0; i != xsym->func.nb_args && err == NULL; i++) {
-		err = eval_func_arg(bvf, xsym->func.args + i,
-			bvf->evst->rv + EBPF_REG_1 + i);
+	if (i != RTE_DIM(bpf_map_xsym))
+		err = eval_map_call(bvf, i, &ret);
+	else {
+		err = NULL;
+		for (i = 0; i != xsym->func.nb_args && err == NULL; i++) {
+			err = eval_func_arg(bvf, xsym->func.args + i,
+				bvf->evst->rv + EBPF_REG_1 + i);
+		}
 	}
 
 	/* R1-R5 argument/scratch registers */
@@ -998,11 +1094,12 @@ eval_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 	/* update return value */
 
 	rv = bvf->evst->rv + EBPF_REG_0;
-	rv->v = xsym->func.ret;
+	rv->v = ret;
 	if (rv->v.type == RTE_BPF_ARG_RAW)
 		eval_fill_max_bound(rv,
 			RTE_LEN2MASK(rv->v.size * CHAR_BIT, uint64_t));
-	else if (RTE_BPF_ARG_PTR_TYPE(rv->v.type) != 0)
+	else if (RTE_BPF_ARG_PTR_TYPE(rv->v.type) != 0 ||
+			rv->v.type == BPF_ARG_PTR_OR_NULL)
 		eval_fill_imm64(rv, UINTPTR_MAX, 0);
 
 	return err;
@@ -1068,6 +1165,21 @@ eval_jslt_jsge(struct bpf_reg_val *trd, struct bpf_reg_val *trs,
 	trd->s.max = RTE_MIN(trd->s.max, trs->s.max - 1);
 }
 
+/*
+ * value pointer is not NULL on one branch and NULL on the other.
+ */
+static void
+eval_ptr_or_null(struct bpf_reg_val *frd, struct bpf_reg_val *trd, int jeq)
+{
+	struct bpf_reg_val *nrd, *prd;
+
+	nrd = jeq ? trd : frd;
+	prd = jeq ? frd : trd;
+
+	prd->v.type = RTE_BPF_ARG_PTR;
+	eval_fill_imm(nrd, UINT64_MAX, 0);
+}
+
 static const char *
 eval_jcc(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 {
@@ -1099,6 +1211,20 @@ eval_jcc(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 
 	op = BPF_OP(ins->code);
 
+	/*
+	 * check of the map lookup result for NULL,
+	 * only against an immediate zero or a scalar register known to be zero
+	 */
+	if (trd->v.type == BPF_ARG_PTR_OR_NULL &&
+			(op == BPF_JEQ || op == EBPF_JNE) &&
+			trd->u.min == 0 && trd->u.max == 0 &&
+			(BPF_SRC(ins->code) == BPF_K ? ins->imm == 0 :
+			trs->v.type == RTE_BPF_ARG_RAW &&
+			trs->u.min == 0 && trs->u.max == 0)) {
+		eval_ptr_or_null(frd, trd, op == BPF_JEQ);
+		return NULL;
+	}
+
 	if (op == BPF_JEQ)
 		eval_jeq_jne(trd, trs);
 	else if (op == EBPF_JNE)
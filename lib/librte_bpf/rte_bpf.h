@@ -59,9 +59,12 @@ struct rte_bpf_arg {
  */
 enum rte_bpf_xtype {
 	RTE_BPF_XTYPE_FUNC, /**< function */
-	RTE_BPF_XTYPE_VAR   /**< variable */
+	RTE_BPF_XTYPE_VAR,  /**< variable */
+	RTE_BPF_XTYPE_MAP   /**< map, see rte_bpf_map.h */
 };
 
+struct rte_bpf_map;
+
 /**
  * Definition for external symbols available in the BPF program.
  */
@@ -81,6 +84,9 @@ struct rte_bpf_xsym {
 			void *val; /**< actual memory location */
 			struct rte_bpf_arg desc; /**< type, size, etc. */
 		} var; /**< external variable */
+		struct {
+			struct rte_bpf_map *val; /**< map object */
+		} map; /**< external map */
 	};
 };
 
@@ -136,6 +142,9 @@ rte_bpf_load(const struct rte_bpf_prm *prm);
  * Note that if the function will encounter EBPF_PSEUDO_CALL instruction
  * that references external symbol, it will treat is as standard BPF_CALL
  * to the external helper function.
+ * Maps defined in the "maps" section of the file are taken from
+ * the external symbols with the same name, if there are any,
+ * otherwise they are created and destroyed along with the BPF handle.
  *
  * @param prm
  *  Parameters used to create and initialise the BPF execution context.
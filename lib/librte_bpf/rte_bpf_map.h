@@ -0,0 +1,258 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#ifndef _RTE_BPF_MAP_H_
+#define _RTE_BPF_MAP_H_
+
+/**
+ * @file rte_bpf_map.h
+ *
+ * API to create and access maps shared between BPF programs
+ * and the application.
+ * Map is passed to the BPF program as an external symbol of
+ * RTE_BPF_XTYPE_MAP type, loaded into the register with EBPF_DW load
+ * of the map address, and accessed by the program through the helper
+ * functions (see enum rte_bpf_map_func).
+ * Note that right now:
+ * - lookups are MT safe and can run in parallel with updates.
+ * - updates and deletes of the same map are serialized internally.
+ * - memory of the deleted element can be reused by the following update,
+ *   while other threads still hold the pointer returned by the lookup,
+ *   unless the map is created with an RCU QSBR variable.
+ */
+
+#include <rte_bpf.h>
+#include <rte_rcu_qsbr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Possible map types.
+ * Values match the ones used by Linux, so legacy map definitions
+ * (struct bpf_map_def) can be loaded as is.
+ */
+enum rte_bpf_map_type {
+	RTE_BPF_MAP_TYPE_HASH = 1,
+	/**< hash table with arbitrary keys, backed by rte_hash */
+	RTE_BPF_MAP_TYPE_ARRAY = 2,
+	/**< array indexed by uint32_t key */
+	RTE_BPF_MAP_TYPE_LCORE_ARRAY = 6,
+	/**< array with a separate copy of values for each lcore */
+	RTE_BPF_MAP_TYPE_LPM = 11,
+	/**< IPv4 longest prefix match, backed by rte_lpm */
+};
+
+/**
+ * Flags for the map update.
+ */
+enum {
+	RTE_BPF_MAP_ANY     = 0, /**< create new element or update existing */
+	RTE_BPF_MAP_NOEXIST = 1, /**< create new element only */
+	RTE_BPF_MAP_EXIST   = 2, /**< update existing element only */
+};
+
+/**
+ * Helper functions available to BPF programs that use maps.
+ * rte_bpf_load() appends them to the external symbols given by the user,
+ * so EBPF_CALL instruction with imm == (nb_xsym + RTE_BPF_FUNC_MAP_XXX)
+ * invokes the helper. Within ELF file they can be called by name.
+ */
+enum rte_bpf_map_func {
+	RTE_BPF_FUNC_MAP_LOOKUP_ELEM,
+	/**< void *bpf_map_lookup_elem(map, key) */
+	RTE_BPF_FUNC_MAP_UPDATE_ELEM,
+	/**< int bpf_map_update_elem(map, key, value, flags) */
+	RTE_BPF_FUNC_MAP_DELETE_ELEM,
+	/**< int bpf_map_delete_elem(map, key) */
+	RTE_BPF_FUNC_MAP_NUM
+};
+
+/**
+ * Key for the RTE_BPF_MAP_TYPE_LPM map.
+ */
+struct rte_bpf_map_lpm_key {
+	uint32_t depth; /**< prefix length, [1, 32], ignored by lookup */
+	uint32_t ip;    /**< IPv4 address in host byte order */
+};
+
+/**
+ * Map definition, same layout as legacy struct bpf_map_def,
+ * expected in the "maps" section of ELF file.
+ */
+struct rte_bpf_map_def {
+	uint32_t type;        /**< map type, enum rte_bpf_map_type */
+	uint32_t key_size;    /**< size of the key in bytes */
+	uint32_t value_size;  /**< size of the value in bytes */
+	uint32_t max_entries; /**< max number of elements */
+	uint32_t flags;       /**< reserved, should be zero */
+};
+
+/**
+ * Parameters used to create the map.
+ */
+struct rte_bpf_map_prm {
+	const char *name;           /**< map name */
+	int socket_id;              /**< NUMA socket to allocate memory on */
+	struct rte_bpf_map_def def; /**< map type and sizes */
+	struct rte_rcu_qsbr *v;
+	/**<
+	 * RCU QSBR variable the threads doing lookups report quiescent
+	 * states on. Memory of the deleted elements of hash and LPM maps
+	 * is reused only after a grace period. NULL to reuse it at once.
+	 */
+	uint32_t lpm_number_tbl8s;
+	/**<
+	 * Number of tbl8 groups of RTE_BPF_MAP_TYPE_LPM map, prefixes
+	 * longer than 24 bits need one per /24 they fall in.
+	 * 0 for the lesser of max_entries and 256.
+	 */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new map.
+ *
+ * @param prm
+ *   Parameters used to create the map.
+ *   RTE_BPF_MAP_TYPE_ARRAY and RTE_BPF_MAP_TYPE_LCORE_ARRAY require
+ *   4 bytes keys, RTE_BPF_MAP_TYPE_LPM requires
+ *   struct rte_bpf_map_lpm_key as a key.
+ * @return
+ *   Map handle, or NULL on error, with error code set in rte_errno.
+ *   Possible rte_errno errors include:
+ *   - EINVAL - invalid parameter passed to function
+ *   - ENOMEM - can't reserve enough memory
+ */
+__rte_experimental
+struct rte_bpf_map *
+rte_bpf_map_create(const struct rte_bpf_map_prm *prm);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * De-allocate all memory used by the map.
+ * The map must not be used by any loaded BPF program.
+ *
+ * @param map
+ *   Map to free.
+ */
+__rte_experimental
+void
+rte_bpf_map_free(struct rte_bpf_map *map);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find the map used by the BPF program by name.
+ *
+ * @param bpf
+ *   BPF handle.
+ * @param name
+ *   Map name, as in the external symbol or in the ELF file.
+ * @return
+ *   Map handle, or NULL if not found.
+ */
+__rte_experimental
+struct rte_bpf_map *
+rte_bpf_map_get(const struct rte_bpf *bpf, const char *name);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find the value for the given key.
+ * For RTE_BPF_MAP_TYPE_LCORE_ARRAY returns the copy of the calling lcore,
+ * non-EAL threads share one extra copy.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Key to find.
+ * @return
+ *   Pointer to the value, or NULL if not found.
+ */
+__rte_experimental
+void *
+rte_bpf_map_lookup_elem(const struct rte_bpf_map *map, const void *key);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Find the value of the given lcore for the given key.
+ * Allows to collect values of RTE_BPF_MAP_TYPE_LCORE_ARRAY map
+ * for all lcores, for other map types it is the same as
+ * rte_bpf_map_lookup_elem().
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Key to find.
+ * @param lcore_id
+ *   Lcore id, RTE_MAX_LCORE for the copy shared by non-EAL threads.
+ * @return
+ *   Pointer to the value, or NULL if not found.
+ */
+__rte_experimental
+void *
+rte_bpf_map_lookup_lcore(const struct rte_bpf_map *map, const void *key,
+	uint32_t lcore_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add or update the element.
+ * For RTE_BPF_MAP_TYPE_LCORE_ARRAY updates the copies of all lcores.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Key of the element.
+ * @param value
+ *   Value to copy into the element.
+ * @param flags
+ *   One of RTE_BPF_MAP_ANY, RTE_BPF_MAP_NOEXIST, RTE_BPF_MAP_EXIST.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if the element exists and RTE_BPF_MAP_NOEXIST is given.
+ *   - -ENOENT if the element doesn't exist and RTE_BPF_MAP_EXIST is given.
+ *   - -ENOSPC if there is no space for the new element.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_bpf_map_update_elem(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete the element.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Key of the element.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the map is an array.
+ *   - -ENOENT if the element doesn't exist.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_bpf_map_delete_elem(struct rte_bpf_map *map, const void *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BPF_MAP_H_ */
@@ -0,0 +1,791 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_tcp.h>
+#include <rte_thash.h>
+#include <rte_timer.h>
+#include <rte_udp.h>
+
+#include "rte_conntrack.h"
+
+/*
+ * Each shard keeps its connections in an array indexed by the key
+ * position returned by rte_hash, so a lookup costs a single bulk hash
+ * lookup and no extra indirection.
+ *
+ * Aging uses a lazy timer wheel: a connection is linked into the slot of
+ * the tick it is due to expire at, and a packet refreshing it only
+ * updates its expiry time. When the slot is walked, connections that
+ * were refreshed are moved further away instead of being expired.
+ * Connections are rescheduled eagerly only when their timeout shrinks,
+ * e.g. on TCP close.
+ */
+
+#define CT_WHEEL_SLOTS		1024
+#define CT_WHEEL_MASK		(CT_WHEEL_SLOTS - 1)
+/* wheel ticks per second */
+#define CT_WHEEL_HZ		8
+
+/* internal connection flags */
+#define CT_F_FIN(dir)		(0x02 << (dir))
+#define CT_F_FIN_BOTH		(CT_F_FIN(0) | CT_F_FIN(1))
+#define CT_F_LAST_FIN_REPLY	0x08
+
+#define CT_TCP_FLAGS_MASK	(RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG | \
+				RTE_TCP_FIN_FLAG | RTE_TCP_RST_FLAG)
+
+/* max number of IPv6 extension headers skipped */
+#define CT_IPV6_EXT_MAX		4
+
+static const uint32_t ct_default_timeout[RTE_CONNTRACK_STATE_MAX] = {
+	[RTE_CONNTRACK_TCP_SYN_SENT] = 120,
+	[RTE_CONNTRACK_TCP_SYN_RECV] = 60,
+	[RTE_CONNTRACK_TCP_ESTABLISHED] = 432000,
+	[RTE_CONNTRACK_TCP_FIN_WAIT] = 120,
+	[RTE_CONNTRACK_TCP_CLOSE_WAIT] = 60,
+	[RTE_CONNTRACK_TCP_LAST_ACK] = 30,
+	[RTE_CONNTRACK_TCP_TIME_WAIT] = 120,
+	[RTE_CONNTRACK_TCP_CLOSE] = 10,
+	[RTE_CONNTRACK_UDP_UNREPLIED] = 30,
+	[RTE_CONNTRACK_UDP_ASSURED] = 120,
+};
+
+/* symmetric Toeplitz key */
+static const uint8_t ct_default_rss_key[RTE_CONNTRACK_RSS_KEY_LEN] = {
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
+struct ct_conn {
+	struct rte_conntrack_conn pub;
+	LIST_ENTRY(ct_conn) next;	/* wheel slot linkage */
+	uint64_t tick;			/* wheel tick scheduled at */
+};
+
+LIST_HEAD(ct_slot, ct_conn);
+
+struct ct_shard {
+	struct rte_conntrack *ct;
+	struct rte_hash *h;
+	struct ct_conn *conns;
+	struct ct_slot *wheel;
+	uint64_t cur_tick;	/* last wheel tick walked */
+	struct rte_conntrack_stats stats;
+	struct rte_timer timer;
+	int timer_started;
+} __rte_cache_aligned;
+
+struct rte_conntrack {
+	char name[RTE_CONNTRACK_NAMESIZE];
+	uint32_t nb_shards;
+	uint32_t reta_mask;
+	uint64_t tick_cycles;
+	uint64_t timeout[RTE_CONNTRACK_STATE_MAX];	/* in TSC cycles */
+	rte_conntrack_expire_t expire_cb;
+	void *expire_cb_arg;
+	uint8_t rss_key[RTE_CONNTRACK_RSS_KEY_LEN];
+	/* key in CPU order, for rte_softrss_be() */
+	uint8_t rss_key_be[RTE_CONNTRACK_RSS_KEY_LEN] __rte_aligned(4);
+	uint16_t reta[RTE_CONNTRACK_RETA_SIZE_MAX];
+	struct ct_shard shards[] __rte_cache_aligned;
+};
+
+/* packet fields relevant to connection tracking */
+struct ct_pkt {
+	const uint8_t *l3;
+	const uint8_t *src;
+	const uint8_t *dst;
+	uint32_t l4_off;
+	uint16_t sport;
+	uint16_t dport;
+	uint8_t proto;
+	uint8_t ip_version;
+	uint8_t tcp_flags;
+};
+
+static int
+ct_pkt_parse_l3(const struct rte_mbuf *m, struct ct_pkt *p)
+{
+	const struct rte_ipv4_hdr *ip4;
+	const struct rte_ipv6_hdr *ip6;
+	uint32_t len, off;
+
+	len = rte_pktmbuf_data_len(m);
+	off = m->l2_len;
+	if (len < off + sizeof(*ip4))
+		return -EINVAL;
+	p->l3 = rte_pktmbuf_mtod_offset(m, const uint8_t *, off);
+
+	switch (p->l3[0] >> 4) {
+	case 4:
+		ip4 = (const struct rte_ipv4_hdr *)p->l3;
+		p->src = (const uint8_t *)&ip4->src_addr;
+		p->dst = (const uint8_t *)&ip4->dst_addr;
+		p->ip_version = 4;
+		p->proto = ip4->next_proto_id;
+		p->l4_off = off + (ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+			RTE_IPV4_IHL_MULTIPLIER;
+		return 0;
+	case 6:
+		ip6 = (const struct rte_ipv6_hdr *)p->l3;
+		if (len < off + sizeof(*ip6))
+			return -EINVAL;
+		p->src = ip6->src_addr;
+		p->dst = ip6->dst_addr;
+		p->ip_version = 6;
+		p->proto = ip6->proto;
+		p->l4_off = off + sizeof(*ip6);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int
+ct_pkt_parse(const struct rte_mbuf *m, struct ct_pkt *p)
+{
+	const struct rte_ipv4_hdr *ip4;
+	const struct rte_tcp_hdr *tcp;
+	const struct rte_udp_hdr *udp;
+	size_t ext_len;
+	uint32_t i, len;
+	int proto;
+
+	if (ct_pkt_parse_l3(m, p) != 0)
+		return -EINVAL;
+
+	len = rte_pktmbuf_data_len(m);
+	proto = p->proto;
+
+	if (p->ip_version == 4) {
+		/* fragments carry no ports, leave them to reassembly */
+		ip4 = (const struct rte_ipv4_hdr *)p->l3;
+		if ((ip4->fragment_offset & rte_cpu_to_be_16(
+				RTE_IPV4_HDR_MF_FLAG |
+				RTE_IPV4_HDR_OFFSET_MASK)) != 0)
+			return -EINVAL;
+	} else {
+		for (i = 0; i != CT_IPV6_EXT_MAX &&
+				proto != IPPROTO_TCP && proto != IPPROTO_UDP;
+				i++) {
+			if (proto == IPPROTO_FRAGMENT || len < p->l4_off + 2)
+				return -EINVAL;
+			proto = rte_ipv6_get_next_ext(
+				rte_pktmbuf_mtod_offset(m, const uint8_t *,
+				p->l4_off), proto, &ext_len);
+			if (proto < 0)
+				return -EINVAL;
+			p->l4_off += ext_len;
+		}
+	}
+
+	if (proto == IPPROTO_TCP) {
+		if (len < p->l4_off + sizeof(*tcp))
+			return -EINVAL;
+		tcp = rte_pktmbuf_mtod_offset(m, const struct rte_tcp_hdr *,
+			p->l4_off);
+		p->sport = tcp->src_port;
+		p->dport = tcp->dst_port;
+		p->tcp_flags = tcp->tcp_flags & CT_TCP_FLAGS_MASK;
+	} else if (proto == IPPROTO_UDP) {
+		if (len < p->l4_off + sizeof(*udp))
+			return -EINVAL;
+		udp = rte_pktmbuf_mtod_offset(m, const struct rte_udp_hdr *,
+			p->l4_off);
+		p->sport = udp->src_port;
+		p->dport = udp->dst_port;
+		p->tcp_flags = 0;
+	} else
+		return -EINVAL;
+
+	p->proto = proto;
+	return 0;
+}
+
+/*
+ * Fill the normalized key of a packet.
+ * Returns 1 if the packet source is endpoint 0 of the key.
+ */
+static int
+ct_key_fill(const struct ct_pkt *p, struct rte_conntrack_key *key)
+{
+	uint32_t alen;
+	int cmp, src_low;
+
+	alen = (p->ip_version == 4) ? sizeof(uint32_t) : 16;
+	cmp = memcmp(p->src, p->dst, alen);
+	if (cmp == 0)
+		cmp = memcmp(&p->sport, &p->dport, sizeof(p->sport));
+	src_low = (cmp <= 0);
+
+	memset(key, 0, sizeof(*key));
+	memcpy(key->addr[!src_low], p->src, alen);
+	memcpy(key->addr[src_low], p->dst, alen);
+	key->port[!src_low] = p->sport;
+	key->port[src_low] = p->dport;
+	key->proto = p->proto;
+	key->ip_version = p->ip_version;
+
+	return src_low;
+}
+
+static inline uint8_t
+ct_pkt_dir(const struct rte_conntrack_conn *c, int src_low)
+{
+	return ((c->flags & RTE_CONNTRACK_F_ORIG_LOW) != 0) == src_low ?
+		RTE_CONNTRACK_DIR_ORIGINAL : RTE_CONNTRACK_DIR_REPLY;
+}
+
+static uint8_t
+ct_tcp_state_next(struct rte_conntrack_conn *c, uint8_t dir, uint8_t fl)
+{
+	uint8_t state = c->state;
+
+	if (fl & RTE_TCP_RST_FLAG)
+		return RTE_CONNTRACK_TCP_CLOSE;
+
+	if (fl & RTE_TCP_SYN_FLAG) {
+		/* new connection reusing the tuple of a closed one */
+		if (state >= RTE_CONNTRACK_TCP_TIME_WAIT &&
+				!(fl & RTE_TCP_ACK_FLAG)) {
+			c->flags &= RTE_CONNTRACK_F_ORIG_LOW;
+			if (dir == RTE_CONNTRACK_DIR_REPLY)
+				c->flags ^= RTE_CONNTRACK_F_ORIG_LOW;
+			return RTE_CONNTRACK_TCP_SYN_SENT;
+		}
+		if (state == RTE_CONNTRACK_TCP_SYN_SENT &&
+				dir == RTE_CONNTRACK_DIR_REPLY &&
+				(fl & RTE_TCP_ACK_FLAG))
+			return RTE_CONNTRACK_TCP_SYN_RECV;
+		return state;
+	}
+
+	if (state < RTE_CONNTRACK_TCP_SYN_RECV ||
+			state > RTE_CONNTRACK_TCP_LAST_ACK)
+		return state;
+
+	if (fl & RTE_TCP_FIN_FLAG) {
+		c->flags |= CT_F_FIN(dir);
+		if ((c->flags & CT_F_FIN_BOTH) == CT_F_FIN_BOTH &&
+				state != RTE_CONNTRACK_TCP_LAST_ACK) {
+			if (dir == RTE_CONNTRACK_DIR_REPLY)
+				c->flags |= CT_F_LAST_FIN_REPLY;
+			return RTE_CONNTRACK_TCP_LAST_ACK;
+		}
+	}
+
+	switch (state) {
+	case RTE_CONNTRACK_TCP_SYN_RECV:
+		if (dir != RTE_CONNTRACK_DIR_ORIGINAL ||
+				!(fl & RTE_TCP_ACK_FLAG))
+			break;
+		state = RTE_CONNTRACK_TCP_ESTABLISHED;
+		/* fall-through */
+	case RTE_CONNTRACK_TCP_ESTABLISHED:
+		if (fl & RTE_TCP_FIN_FLAG)
+			state = RTE_CONNTRACK_TCP_FIN_WAIT;
+		break;
+	case RTE_CONNTRACK_TCP_FIN_WAIT:
+		/* ACK from the side that did not close yet */
+		if ((fl & RTE_TCP_ACK_FLAG) && !(c->flags & CT_F_FIN(dir)))
+			state = RTE_CONNTRACK_TCP_CLOSE_WAIT;
+		break;
+	case RTE_CONNTRACK_TCP_LAST_ACK:
+		/* ACK of the last FIN */
+		if ((fl & RTE_TCP_ACK_FLAG) && !(fl & RTE_TCP_FIN_FLAG) &&
+				((c->flags & CT_F_LAST_FIN_REPLY) != 0) !=
+				(dir == RTE_CONNTRACK_DIR_REPLY))
+			state = RTE_CONNTRACK_TCP_TIME_WAIT;
+		break;
+	default:
+		break;
+	}
+
+	return state;
+}
+
+static inline void
+ct_wheel_link(struct ct_shard *s, struct ct_conn *c, uint64_t tick)
+{
+	tick = RTE_MAX(tick, s->cur_tick + 1);
+	tick = RTE_MIN(tick, s->cur_tick + CT_WHEEL_SLOTS);
+	c->tick = tick;
+	LIST_INSERT_HEAD(&s->wheel[tick & CT_WHEEL_MASK], c, next);
+}
+
+static inline void
+ct_expire_set(const struct rte_conntrack *ct, struct ct_shard *s,
+	struct ct_conn *c, uint64_t now)
+{
+	uint64_t tick;
+
+	c->pub.expire = now + ct->timeout[c->pub.state];
+	tick = c->pub.expire / ct->tick_cycles;
+
+	/* timeout shrunk, don't wait for the old slot */
+	if (tick < c->tick) {
+		LIST_REMOVE(c, next);
+		ct_wheel_link(s, c, tick);
+	}
+}
+
+static inline void
+ct_conn_update(const struct rte_conntrack *ct, struct ct_shard *s,
+	struct ct_conn *c, const struct ct_pkt *p, uint8_t dir,
+	const struct rte_mbuf *m, uint64_t now)
+{
+	struct rte_conntrack_conn *pc = &c->pub;
+
+	pc->pkts[dir]++;
+	pc->bytes[dir] += m->pkt_len;
+
+	if (p->proto == IPPROTO_TCP)
+		pc->state = ct_tcp_state_next(pc, dir, p->tcp_flags);
+	else if (dir == RTE_CONNTRACK_DIR_REPLY)
+		pc->state = RTE_CONNTRACK_UDP_ASSURED;
+
+	ct_expire_set(ct, s, c, now);
+}
+
+static void
+ct_conn_remove(struct ct_shard *s, struct ct_conn *c)
+{
+	LIST_REMOVE(c, next);
+	rte_hash_del_key(s->h, &c->pub.key);
+	c->pub.state = RTE_CONNTRACK_STATE_NONE;
+}
+
+static inline struct ct_shard *
+ct_shard(struct rte_conntrack *ct, uint32_t shard_id)
+{
+	RTE_ASSERT(shard_id < ct->nb_shards);
+	return &ct->shards[shard_id];
+}
+
+uint16_t
+rte_conntrack_lookup_bulk(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_mbuf *pkts[], struct rte_conntrack_conn *conns[],
+	uint8_t dirs[], uint16_t num, uint64_t now)
+{
+	struct rte_conntrack_key keys[RTE_HASH_LOOKUP_BULK_MAX];
+	const void *keyp[RTE_HASH_LOOKUP_BULK_MAX];
+	struct ct_pkt pkt[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos[RTE_HASH_LOOKUP_BULK_MAX];
+	uint16_t idx[RTE_HASH_LOOKUP_BULK_MAX];
+	uint8_t low[RTE_HASH_LOOKUP_BULK_MAX];
+	struct ct_shard *s;
+	struct ct_conn *c;
+	uint32_t i, j, k, m, n, hits;
+	uint8_t dir;
+
+	s = ct_shard(ct, shard_id);
+	hits = 0;
+
+	for (i = 0; i != num; i += n) {
+		n = RTE_MIN(num - i, (uint32_t)RTE_HASH_LOOKUP_BULK_MAX);
+
+		for (j = 0, k = 0; j != n; j++) {
+			conns[i + j] = NULL;
+			if (ct_pkt_parse(pkts[i + j], &pkt[k]) != 0) {
+				s->stats.invalid++;
+				continue;
+			}
+			low[k] = ct_key_fill(&pkt[k], &keys[k]);
+			keyp[k] = &keys[k];
+			idx[k] = i + j;
+			k++;
+		}
+
+		if (k == 0)
+			continue;
+		rte_hash_lookup_bulk(s->h, keyp, k, pos);
+
+		for (j = 0, m = 0; j != k; j++) {
+			if (pos[j] < 0)
+				continue;
+			c = &s->conns[pos[j]];
+			dir = ct_pkt_dir(&c->pub, low[j]);
+			ct_conn_update(ct, s, c, &pkt[j], dir, pkts[idx[j]],
+				now);
+			conns[idx[j]] = &c->pub;
+			if (dirs != NULL)
+				dirs[idx[j]] = dir;
+			m++;
+		}
+
+		s->stats.hits += m;
+		s->stats.misses += k - m;
+		hits += m;
+	}
+
+	return hits;
+}
+
+uint16_t
+rte_conntrack_create_bulk(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_mbuf *pkts[], struct rte_conntrack_conn *conns[],
+	uint8_t dirs[], uint16_t num, uint64_t now)
+{
+	struct rte_conntrack_key key;
+	struct ct_shard *s;
+	struct ct_conn *c;
+	struct ct_pkt pkt;
+	uint32_t i, n;
+	int32_t pos;
+	uint8_t dir;
+	int low;
+
+	s = ct_shard(ct, shard_id);
+	n = 0;
+
+	for (i = 0; i != num; i++) {
+		if (conns[i] != NULL || ct_pkt_parse(pkts[i], &pkt) != 0)
+			continue;
+
+		if (pkt.proto == IPPROTO_TCP &&
+				pkt.tcp_flags != RTE_TCP_SYN_FLAG) {
+			s->stats.untracked++;
+			continue;
+		}
+
+		low = ct_key_fill(&pkt, &key);
+		pos = rte_hash_add_key(s->h, &key);
+		if (pos < 0) {
+			s->stats.full++;
+			continue;
+		}
+
+		c = &s->conns[pos];
+		if (c->pub.state == RTE_CONNTRACK_STATE_NONE) {
+			memset(&c->pub, 0, sizeof(c->pub));
+			c->pub.key = key;
+			c->pub.flags = low ? RTE_CONNTRACK_F_ORIG_LOW : 0;
+			c->pub.state = (pkt.proto == IPPROTO_TCP) ?
+				RTE_CONNTRACK_TCP_SYN_SENT :
+				RTE_CONNTRACK_UDP_UNREPLIED;
+			c->pub.pkts[RTE_CONNTRACK_DIR_ORIGINAL] = 1;
+			c->pub.bytes[RTE_CONNTRACK_DIR_ORIGINAL] =
+				pkts[i]->pkt_len;
+			c->pub.expire = now + ct->timeout[c->pub.state];
+			ct_wheel_link(s, c, c->pub.expire / ct->tick_cycles);
+			dir = RTE_CONNTRACK_DIR_ORIGINAL;
+			s->stats.created++;
+		} else {
+			/* created earlier in the burst */
+			dir = ct_pkt_dir(&c->pub, low);
+			ct_conn_update(ct, s, c, &pkt, dir, pkts[i], now);
+		}
+
+		conns[i] = &c->pub;
+		if (dirs != NULL)
+			dirs[i] = dir;
+		n++;
+	}
+
+	return n;
+}
+
+int
+rte_conntrack_delete(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_conntrack_conn *conn)
+{
+	struct ct_shard *s;
+	struct ct_conn *c;
+
+	if (ct == NULL || shard_id >= ct->nb_shards || conn == NULL)
+		return -EINVAL;
+
+	s = &ct->shards[shard_id];
+	c = container_of(conn, struct ct_conn, pub);
+	if (c < s->conns || c > s->conns + rte_hash_max_key_id(s->h) ||
+			conn->state == RTE_CONNTRACK_STATE_NONE)
+		return -EINVAL;
+
+	ct_conn_remove(s, c);
+	s->stats.deleted++;
+	return 0;
+}
+
+uint32_t
+rte_conntrack_age(struct rte_conntrack *ct, uint32_t shard_id, uint64_t now)
+{
+	struct ct_shard *s;
+	struct ct_conn *c, *next;
+	uint64_t end;
+	uint32_t n;
+
+	s = ct_shard(ct, shard_id);
+	end = now / ct->tick_cycles;
+	n = 0;
+
+	if (end <= s->cur_tick)
+		return 0;
+
+	/* a full turn visits every connection */
+	if (end - s->cur_tick > CT_WHEEL_SLOTS)
+		s->cur_tick = end - CT_WHEEL_SLOTS;
+
+	while (s->cur_tick < end) {
+		s->cur_tick++;
+		c = LIST_FIRST(&s->wheel[s->cur_tick & CT_WHEEL_MASK]);
+		LIST_INIT(&s->wheel[s->cur_tick & CT_WHEEL_MASK]);
+
+		for (; c != NULL; c = next) {
+			next = LIST_NEXT(c, next);
+			if (c->pub.expire > now) {
+				ct_wheel_link(s, c,
+					c->pub.expire / ct->tick_cycles);
+				continue;
+			}
+			if (ct->expire_cb != NULL)
+				ct->expire_cb(&c->pub, ct->expire_cb_arg);
+			rte_hash_del_key(s->h, &c->pub.key);
+			c->pub.state = RTE_CONNTRACK_STATE_NONE;
+			n++;
+		}
+	}
+
+	s->stats.expired += n;
+	return n;
+}
+
+static void
+ct_timer_cb(__rte_unused struct rte_timer *tim, void *arg)
+{
+	struct ct_shard *s = arg;
+
+	rte_conntrack_age(s->ct, s - s->ct->shards, rte_get_tsc_cycles());
+}
+
+int
+rte_conntrack_timer_start(struct rte_conntrack *ct, uint32_t shard_id,
+	unsigned int lcore_id)
+{
+	struct ct_shard *s;
+	int ret;
+
+	if (ct == NULL || shard_id >= ct->nb_shards)
+		return -EINVAL;
+
+	s = &ct->shards[shard_id];
+	ret = rte_timer_reset(&s->timer, ct->tick_cycles, PERIODICAL,
+		lcore_id, ct_timer_cb, s);
+	if (ret == 0)
+		s->timer_started = 1;
+	return ret;
+}
+
+void
+rte_conntrack_timer_stop(struct rte_conntrack *ct, uint32_t shard_id)
+{
+	struct ct_shard *s;
+
+	if (ct == NULL || shard_id >= ct->nb_shards)
+		return;
+
+	s = &ct->shards[shard_id];
+	if (s->timer_started) {
+		rte_timer_stop_sync(&s->timer);
+		s->timer_started = 0;
+	}
+}
+
+const uint8_t *
+rte_conntrack_rss_key(const struct rte_conntrack *ct)
+{
+	return ct->rss_key;
+}
+
+uint32_t
+rte_conntrack_shard_get(const struct rte_conntrack *ct,
+	const struct rte_mbuf *m)
+{
+	union rte_thash_tuple tuple;
+	struct ct_pkt pkt;
+	uint32_t hash, len;
+	int l4;
+
+	if (m->ol_flags & PKT_RX_RSS_HASH)
+		return ct->reta[m->hash.rss & ct->reta_mask];
+
+	/* untracked packets are spread on addresses only, as the NIC does */
+	l4 = (ct_pkt_parse(m, &pkt) == 0);
+	if (!l4 && ct_pkt_parse_l3(m, &pkt) != 0)
+		return 0;
+
+	if (pkt.ip_version == 4) {
+		tuple.v4.src_addr = rte_be_to_cpu_32(
+			((const struct rte_ipv4_hdr *)pkt.l3)->src_addr);
+		tuple.v4.dst_addr = rte_be_to_cpu_32(
+			((const struct rte_ipv4_hdr *)pkt.l3)->dst_addr);
+		tuple.v4.sport = rte_be_to_cpu_16(pkt.sport);
+		tuple.v4.dport = rte_be_to_cpu_16(pkt.dport);
+		len = l4 ? RTE_THASH_V4_L4_LEN : RTE_THASH_V4_L3_LEN;
+	} else {
+		rte_thash_load_v6_addrs(
+			(const struct rte_ipv6_hdr *)pkt.l3, &tuple);
+		tuple.v6.sport = rte_be_to_cpu_16(pkt.sport);
+		tuple.v6.dport = rte_be_to_cpu_16(pkt.dport);
+		len = l4 ? RTE_THASH_V6_L4_LEN : RTE_THASH_V6_L3_LEN;
+	}
+
+	hash = rte_softrss_be((uint32_t *)&tuple, len, ct->rss_key_be);
+	return ct->reta[hash & ct->reta_mask];
+}
+
+int
+rte_conntrack_stats_get(const struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_conntrack_stats *stats)
+{
+	const struct ct_shard *s;
+
+	if (ct == NULL || shard_id >= ct->nb_shards || stats == NULL)
+		return -EINVAL;
+
+	s = &ct->shards[shard_id];
+	*stats = s->stats;
+	stats->conns = rte_hash_count(s->h);
+	return 0;
+}
+
+void
+rte_conntrack_free(struct rte_conntrack *ct)
+{
+	struct ct_shard *s;
+	uint32_t i;
+
+	if (ct == NULL)
+		return;
+
+	for (i = 0; i != ct->nb_shards; i++) {
+		rte_conntrack_timer_stop(ct, i);
+		s = &ct->shards[i];
+		rte_hash_free(s->h);
+		rte_free(s->conns);
+		rte_free(s->wheel);
+	}
+	rte_free(ct);
+}
+
+struct rte_conntrack *
+rte_conntrack_create(const struct rte_conntrack_params *params)
+{
+	char hash_name[RTE_HASH_NAMESIZE];
+	struct rte_hash_parameters hash_params = {0};
+	struct rte_conntrack *ct;
+	struct ct_shard *s;
+	uint32_t i, n, reta_size;
+	uint64_t hz;
+
+	if (params == NULL || params->name == NULL ||
+			params->nb_shards == 0 || params->max_conns == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	reta_size = params->reta_size;
+	if (reta_size == 0)
+		reta_size = RTE_CONNTRACK_RETA_SIZE;
+	if (!rte_is_power_of_2(reta_size) ||
+			reta_size > RTE_CONNTRACK_RETA_SIZE_MAX ||
+			(params->reta != NULL && params->reta_size == 0)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (params->reta != NULL) {
+		for (i = 0; i != reta_size; i++) {
+			if (params->reta[i] >= params->nb_shards) {
+				rte_errno = EINVAL;
+				return NULL;
+			}
+		}
+	}
+
+	if (strnlen(params->name, RTE_CONNTRACK_NAMESIZE) ==
+			RTE_CONNTRACK_NAMESIZE) {
+		rte_errno = ENAMETOOLONG;
+		return NULL;
+	}
+
+	ct = rte_zmalloc_socket(NULL, sizeof(*ct) +
+		params->nb_shards * sizeof(ct->shards[0]),
+		RTE_CACHE_LINE_SIZE, params->socket_id);
+	if (ct == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	strlcpy(ct->name, params->name, sizeof(ct->name));
+	ct->nb_shards = params->nb_shards;
+	ct->expire_cb = params->expire_cb;
+	ct->expire_cb_arg = params->expire_cb_arg;
+
+	hz = rte_get_tsc_hz();
+	ct->tick_cycles = RTE_MAX(hz / CT_WHEEL_HZ, 1ULL);
+	for (i = 0; i != RTE_CONNTRACK_STATE_MAX; i++)
+		ct->timeout[i] = hz * (params->timeout[i] != 0 ?
+			params->timeout[i] : ct_default_timeout[i]);
+
+	memcpy(ct->rss_key, params->rss_key != NULL ? params->rss_key :
+		ct_default_rss_key, sizeof(ct->rss_key));
+	rte_convert_rss_key((const uint32_t *)ct->rss_key,
+		(uint32_t *)ct->rss_key_be, sizeof(ct->rss_key_be));
+
+	ct->reta_mask = reta_size - 1;
+	for (i = 0; i != reta_size; i++)
+		ct->reta[i] = params->reta != NULL ? params->reta[i] :
+			i % params->nb_shards;
+
+	hash_params.key_len = sizeof(struct rte_conntrack_key);
+	hash_params.entries = params->max_conns;
+	hash_params.hash_func = rte_hash_crc;
+	hash_params.hash_func_init_val = rte_rand();
+	hash_params.socket_id = params->socket_id;
+	hash_params.name = hash_name;
+
+	for (i = 0; i != ct->nb_shards; i++) {
+		s = &ct->shards[i];
+		s->ct = ct;
+		rte_timer_init(&s->timer);
+
+		snprintf(hash_name, sizeof(hash_name), "ct_%u_%p", i, ct);
+		s->h = rte_hash_create(&hash_params);
+		if (s->h == NULL)
+			goto error;
+
+		n = rte_hash_max_key_id(s->h) + 1;
+		s->conns = rte_zmalloc_socket(NULL, n * sizeof(s->conns[0]),
+			RTE_CACHE_LINE_SIZE, params->socket_id);
+		s->wheel = rte_zmalloc_socket(NULL,
+			CT_WHEEL_SLOTS * sizeof(s->wheel[0]),
+			RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (s->conns == NULL || s->wheel == NULL) {
+			rte_errno = ENOMEM;
+			goto error;
+		}
+
+		/* start the wheel at the current time */
+		s->cur_tick = rte_get_tsc_cycles() / ct->tick_cycles;
+	}
+
+	return ct;
+
+error:
+	rte_conntrack_free(ct);
+	return NULL;
+}
@@ -0,0 +1,405 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#ifndef _RTE_CONNTRACK_H_
+#define _RTE_CONNTRACK_H_
+
+/**
+ * @file rte_conntrack.h
+ *
+ * RTE Connection Tracking
+ *
+ * Stateful tracking of TCP and UDP connections over IPv4 and IPv6.
+ * Connections are kept in per-lcore shards, each shard being a single
+ * writer hash table owned by one lcore. A connection is identified by a
+ * normalized 5-tuple, so both directions of a connection map to the same
+ * entry, and shards are selected with a symmetric Toeplitz hash so that
+ * they match the RSS queues a NIC programmed with the same key and
+ * redirection table delivers the packets to.
+ *
+ * Idle connections are aged out in batches by a per-shard timer wheel,
+ * driven either explicitly with rte_conntrack_age() or periodically by an
+ * rte_timer started with rte_conntrack_timer_start().
+ */
+
+#include <stdint.h>
+
+#include <rte_compat.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of characters in connection tracker name. */
+#define RTE_CONNTRACK_NAMESIZE		32
+
+/** Length of the Toeplitz RSS key used for shard selection. */
+#define RTE_CONNTRACK_RSS_KEY_LEN	40
+
+/** Default size of the shard redirection table. */
+#define RTE_CONNTRACK_RETA_SIZE		128
+
+/** Max size of the shard redirection table. */
+#define RTE_CONNTRACK_RETA_SIZE_MAX	512
+
+/** Connection states. */
+enum rte_conntrack_state {
+	RTE_CONNTRACK_STATE_NONE = 0,	/**< Unused entry */
+	RTE_CONNTRACK_TCP_SYN_SENT,	/**< SYN seen from originator */
+	RTE_CONNTRACK_TCP_SYN_RECV,	/**< SYN+ACK seen from responder */
+	RTE_CONNTRACK_TCP_ESTABLISHED,	/**< Three-way handshake done */
+	RTE_CONNTRACK_TCP_FIN_WAIT,	/**< FIN seen from one side */
+	RTE_CONNTRACK_TCP_CLOSE_WAIT,	/**< First FIN acknowledged */
+	RTE_CONNTRACK_TCP_LAST_ACK,	/**< FIN seen from both sides */
+	RTE_CONNTRACK_TCP_TIME_WAIT,	/**< Last FIN acknowledged */
+	RTE_CONNTRACK_TCP_CLOSE,	/**< Connection reset */
+	RTE_CONNTRACK_UDP_UNREPLIED,	/**< UDP, originator traffic only */
+	RTE_CONNTRACK_UDP_ASSURED,	/**< UDP, traffic seen both ways */
+	RTE_CONNTRACK_STATE_MAX
+};
+
+/** Direction of a packet relative to its connection. */
+enum rte_conntrack_dir {
+	RTE_CONNTRACK_DIR_ORIGINAL = 0,	/**< From the originator */
+	RTE_CONNTRACK_DIR_REPLY,	/**< From the responder */
+	RTE_CONNTRACK_DIR_MAX
+};
+
+/**
+ * Normalized connection key.
+ *
+ * The endpoint with the lower address (and port, for equal addresses)
+ * is always stored first, independently of the packet direction.
+ * IPv4 addresses occupy the first 4 bytes of the address fields,
+ * the rest of the key is zeroed.
+ */
+struct rte_conntrack_key {
+	uint8_t addr[2][16];	/**< Endpoint addresses, network order */
+	uint16_t port[2];	/**< Endpoint ports, network order */
+	uint8_t proto;		/**< IPPROTO_TCP or IPPROTO_UDP */
+	uint8_t ip_version;	/**< 4 or 6 */
+	uint16_t reserved;	/**< Zero */
+};
+
+/** Endpoint 0 of the key is the connection originator. */
+#define RTE_CONNTRACK_F_ORIG_LOW	0x01
+
+/**
+ * Tracked connection.
+ *
+ * All fields but *udata* are maintained by the library and must be
+ * treated as read-only by the application.
+ */
+struct rte_conntrack_conn {
+	struct rte_conntrack_key key;	/**< Normalized key */
+	uint64_t expire;	/**< TSC cycles when the connection times out */
+	uint64_t pkts[RTE_CONNTRACK_DIR_MAX];	/**< Packets per direction */
+	uint64_t bytes[RTE_CONNTRACK_DIR_MAX];	/**< Bytes per direction */
+	uint64_t udata;		/**< Application data, zeroed on creation */
+	uint8_t state;		/**< enum rte_conntrack_state */
+	uint8_t flags;		/**< RTE_CONNTRACK_F_* and internal flags */
+};
+
+/** Per shard statistics. */
+struct rte_conntrack_stats {
+	uint64_t conns;		/**< Connections currently tracked */
+	uint64_t hits;		/**< Packets matching a connection */
+	uint64_t misses;	/**< Packets not matching any connection */
+	uint64_t created;	/**< Connections created */
+	uint64_t expired;	/**< Connections timed out */
+	uint64_t deleted;	/**< Connections deleted by the application */
+	uint64_t invalid;	/**< Untrackable or truncated packets */
+	uint64_t untracked;	/**< Misses that cannot open a connection */
+	uint64_t full;		/**< Creations failed for lack of room */
+};
+
+/**
+ * Connection expiry callback, called on the lcore aging the shard
+ * right before the connection is removed.
+ */
+typedef void (*rte_conntrack_expire_t)(struct rte_conntrack_conn *conn,
+	void *arg);
+
+/** Connection tracker creation parameters. */
+struct rte_conntrack_params {
+	/** Name of the connection tracker */
+	const char *name;
+	/** CPU socket ID where the tables should be allocated */
+	int socket_id;
+	/** Number of shards, usually the number of Rx queues */
+	uint32_t nb_shards;
+	/** Max number of connections in each shard */
+	uint32_t max_conns;
+	/**
+	 * Symmetric Toeplitz key programmed into the NIC,
+	 * RTE_CONNTRACK_RSS_KEY_LEN bytes long. If NULL, the 0x6d5a
+	 * repeated pattern is used.
+	 */
+	const uint8_t *rss_key;
+	/**
+	 * Redirection table mapping the hash LSBs to a shard, as programmed
+	 * into the NIC. If NULL, entry i is set to i % nb_shards.
+	 */
+	const uint16_t *reta;
+	/** Size of *reta*, power of 2; 0 for RTE_CONNTRACK_RETA_SIZE */
+	uint32_t reta_size;
+	/** Timeout in seconds per state; 0 for the default value */
+	uint32_t timeout[RTE_CONNTRACK_STATE_MAX];
+	/** Connection expiry callback, may be NULL */
+	rte_conntrack_expire_t expire_cb;
+	/** Argument passed to *expire_cb* */
+	void *expire_cb_arg;
+};
+
+struct rte_conntrack;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a connection tracker.
+ *
+ * @param params
+ *   Connection tracker parameters.
+ * @return
+ *   Pointer to the connection tracker on success, NULL otherwise with
+ *   rte_errno set to:
+ *   - EINVAL - invalid parameter passed to function
+ *   - ENAMETOOLONG - name is too long
+ *   - ENOMEM - no appropriate memory area found
+ *   - EEXIST - a hash table with the same name already exists
+ */
+__rte_experimental
+struct rte_conntrack *
+rte_conntrack_create(const struct rte_conntrack_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Free a connection tracker, stopping its aging timers if running.
+ * The expiry callback is not invoked for the remaining connections.
+ *
+ * @param ct
+ *   Connection tracker, may be NULL.
+ */
+__rte_experimental
+void
+rte_conntrack_free(struct rte_conntrack *ct);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the Toeplitz key used for shard selection, to be programmed into
+ * the NIC together with the redirection table.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @return
+ *   Pointer to the RTE_CONNTRACK_RSS_KEY_LEN bytes key.
+ */
+__rte_experimental
+const uint8_t *
+rte_conntrack_rss_key(const struct rte_conntrack *ct);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the shard owning the connection of a packet. Both directions of
+ * a connection map to the same shard. The RSS hash reported by the NIC
+ * is used when PKT_RX_RSS_HASH is set, otherwise it is computed in
+ * software from the packet headers.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param m
+ *   Packet, with l2_len set to the offset of the IP header.
+ * @return
+ *   Shard index.
+ */
+__rte_experimental
+uint32_t
+rte_conntrack_shard_get(const struct rte_conntrack *ct,
+	const struct rte_mbuf *m);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Look up the connections of a burst of packets and update their state.
+ * Packets must have l2_len set to the offset of the IP header, with the
+ * IP and L4 headers in the first segment.
+ *
+ * Only the lcore owning the shard may call this function.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard to search.
+ * @param pkts
+ *   Packets to look up.
+ * @param conns
+ *   Output, connection of each packet, NULL for a miss.
+ * @param dirs
+ *   Output, enum rte_conntrack_dir of each hit packet, may be NULL.
+ * @param num
+ *   Number of packets.
+ * @param now
+ *   Current TSC cycles.
+ * @return
+ *   Number of packets matching a connection.
+ */
+__rte_experimental
+uint16_t
+rte_conntrack_lookup_bulk(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_mbuf *pkts[], struct rte_conntrack_conn *conns[],
+	uint8_t dirs[], uint16_t num, uint64_t now);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create connections for the packets of a burst missing one, usually
+ * after rte_conntrack_lookup_bulk(). Only the packets with a NULL entry
+ * in *conns* are considered, and a connection is created only if the
+ * packet may open one: a TCP SYN without ACK, or any UDP datagram.
+ * Packets of the burst belonging to a connection created earlier in the
+ * same call update it as with rte_conntrack_lookup_bulk().
+ *
+ * Only the lcore owning the shard may call this function.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard to create the connections in.
+ * @param pkts
+ *   Packets.
+ * @param conns
+ *   Input/output, connection of each packet.
+ * @param dirs
+ *   Output, enum rte_conntrack_dir of each packet set by this call,
+ *   may be NULL.
+ * @param num
+ *   Number of packets.
+ * @param now
+ *   Current TSC cycles.
+ * @return
+ *   Number of entries of *conns* set by this call.
+ */
+__rte_experimental
+uint16_t
+rte_conntrack_create_bulk(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_mbuf *pkts[], struct rte_conntrack_conn *conns[],
+	uint8_t dirs[], uint16_t num, uint64_t now);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Delete a connection. The expiry callback is not invoked.
+ *
+ * Only the lcore owning the shard may call this function.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard of the connection.
+ * @param conn
+ *   Connection returned by a lookup or create of the same shard.
+ * @return
+ *   0 on success, -EINVAL if the connection is not tracked in the shard.
+ */
+__rte_experimental
+int
+rte_conntrack_delete(struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_conntrack_conn *conn);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Expire the idle connections of a shard. Walks the timer wheel slots
+ * elapsed since the previous call, removing the connections timed out
+ * and rescheduling the ones refreshed in the meantime.
+ *
+ * Only the lcore owning the shard may call this function.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard to age.
+ * @param now
+ *   Current TSC cycles.
+ * @return
+ *   Number of connections expired.
+ */
+__rte_experimental
+uint32_t
+rte_conntrack_age(struct rte_conntrack *ct, uint32_t shard_id, uint64_t now);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Start a periodic rte_timer aging a shard once per wheel tick.
+ * The timer runs from rte_timer_manage() on *lcore_id*, which must be
+ * the lcore owning the shard. The timer subsystem must be initialized.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard to age.
+ * @param lcore_id
+ *   Lcore owning the shard.
+ * @return
+ *   0 on success, negative errno otherwise.
+ */
+__rte_experimental
+int
+rte_conntrack_timer_start(struct rte_conntrack *ct, uint32_t shard_id,
+	unsigned int lcore_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stop the aging timer of a shard, waiting for a running callback.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard.
+ */
+__rte_experimental
+void
+rte_conntrack_timer_stop(struct rte_conntrack *ct, uint32_t shard_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the statistics of a shard.
+ *
+ * @param ct
+ *   Connection tracker.
+ * @param shard_id
+ *   Shard.
+ * @param stats
+ *   Output statistics.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+__rte_experimental
+int
+rte_conntrack_stats_get(const struct rte_conntrack *ct, uint32_t shard_id,
+	struct rte_conntrack_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_CONNTRACK_H_ */
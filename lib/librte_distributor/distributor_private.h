@@ -128,6 +128,7 @@ struct rte_distributor_buffer {
 	int64_t pad2 __rte_cache_aligned;    /* <= one cache line  */
 
 	int count __rte_cache_aligned;       /* <= number of current mbufs */
+	int socket_id;                       /* <= socket of the worker */
 };
 
 struct rte_distributor {
@@ -158,6 +159,10 @@ struct rte_distributor {
 
 	uint8_t active[RTE_DISTRIB_MAX_WORKERS];
 	uint8_t activesum;
+
+	uint8_t steal; /**< Idle workers steal untagged packets */
+
+	struct rte_distributor_worker_stats stats[RTE_DISTRIB_MAX_WORKERS];
 };
 
 void
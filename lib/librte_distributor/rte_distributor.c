@@ -47,6 +47,12 @@ rte_distributor_request_pkt(struct rte_distributor *d,
 		return;
 	}
 
+	/* Let the distributor know the socket of the worker lcore */
+	if (unlikely(__atomic_load_n(&buf->socket_id, __ATOMIC_RELAXED) !=
+			(int)rte_socket_id()))
+		__atomic_store_n(&buf->socket_id, (int)rte_socket_id(),
+				__ATOMIC_RELAXED);
+
 	retptr64 = &(buf->retptr64[0]);
 	/* Spin while handshake bits are set (scheduler clears it).
 	 * Sync with worker on GET_BUF flag.
@@ -363,6 +369,7 @@ handle_returns(struct rte_distributor *d, unsigned int wkr)
 		}
 		d->returns.start = ret_start;
 		d->returns.count = ret_count;
+		d->stats[wkr].returns += count;
 
 		/* If worker requested packets with GET_BUF, set it to active
 		 * otherwise (RETURN_BUF), set it to not active.
@@ -385,6 +392,89 @@ handle_returns(struct rte_distributor *d, unsigned int wkr)
 	return count;
 }
 
+/*
+ * Work stealing: called on behalf of a worker ready for a new burst, moves
+ * the untagged packets queued in the backlog of workers still busy with
+ * their previous burst. Workers on the same socket are robbed first.
+ * Backlogs are only accessed by the distributor lcore, so packets already
+ * handed to a worker are never taken back.
+ */
+static void
+steal_backlog(struct rte_distributor *d, unsigned int wkr)
+{
+	struct rte_distributor_backlog *bl = &d->backlog[wkr];
+	struct rte_distributor_backlog *victim;
+	int socket_id = __atomic_load_n(&d->bufs[wkr].socket_id,
+			__ATOMIC_RELAXED);
+	unsigned int pass, w, i, n, stolen;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (w = 0; w < d->num_workers; w++) {
+			victim = &d->backlog[w];
+			if (w == wkr || !d->active[w] || victim->count == 0)
+				continue;
+			/* same socket on first pass, the others on second */
+			if ((__atomic_load_n(&d->bufs[w].socket_id,
+					__ATOMIC_RELAXED) != socket_id) != pass)
+				continue;
+			/* a ready worker gets its backlog on next release */
+			if (__atomic_load_n(&d->bufs[w].bufptr64[0],
+					__ATOMIC_RELAXED) & RTE_DISTRIB_GET_BUF)
+				continue;
+
+			n = 0;
+			stolen = 0;
+			for (i = 0; i < victim->count; i++) {
+				if (victim->tags[i] == 0 && bl->count <
+						RTE_DIST_BURST_SIZE) {
+					bl->tags[bl->count] = 0;
+					bl->pkts[bl->count++] = victim->pkts[i];
+					stolen++;
+				} else {
+					victim->tags[n] = victim->tags[i];
+					victim->pkts[n++] = victim->pkts[i];
+				}
+			}
+			for (i = n; i < victim->count; i++)
+				victim->tags[i] = 0;
+			victim->count = n;
+
+			d->stats[w].robbed += stolen;
+			d->stats[wkr].stolen += stolen;
+			if (bl->count == RTE_DIST_BURST_SIZE)
+				return;
+		}
+	}
+}
+
+/*
+ * Work stealing: pick the worker for an untagged packet, starting at *wkr*.
+ * Prefer a worker ready for a new burst, then any worker with room in
+ * its backlog. Falls back to *wkr* when all backlogs are full.
+ */
+static unsigned int
+find_worker_unpinned(struct rte_distributor *d, unsigned int wkr)
+{
+	unsigned int i, w, found = wkr;
+	int room = 0;
+
+	for (i = 0; i < d->num_workers; i++) {
+		w = (wkr + i) % d->num_workers;
+		if (!d->active[w] ||
+				d->backlog[w].count == RTE_DIST_BURST_SIZE)
+			continue;
+		if (__atomic_load_n(&d->bufs[w].bufptr64[0],
+				__ATOMIC_RELAXED) & RTE_DISTRIB_GET_BUF)
+			return w;
+		if (!room) {
+			found = w;
+			room = 1;
+		}
+	}
+
+	return found;
+}
+
 /*
  * This function releases a burst (cache line) to a worker.
  * It is called from the process function when a cacheline is
@@ -415,6 +505,9 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 	buf->count = 0;
 
+	if (d->steal && d->backlog[wkr].count < RTE_DIST_BURST_SIZE)
+		steal_backlog(d, wkr);
+
 	for (i = 0; i < d->backlog[wkr].count; i++) {
 		d->bufs[wkr].bufptr64[i] = d->backlog[wkr].pkts[i] |
 				RTE_DISTRIB_GET_BUF | RTE_DISTRIB_VALID_BUF;
@@ -428,6 +521,9 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 	d->backlog[wkr].count = 0;
 
+	d->stats[wkr].pkts += buf->count;
+	d->stats[wkr].bursts += !!buf->count;
+
 	/* Clear the GET bit.
 	 * Sync with worker on GET_BUF flag. Release bufptrs.
 	 */
@@ -487,7 +583,11 @@ rte_distributor_process(struct rte_distributor *d,
 			pkts = RTE_DIST_BURST_SIZE;
 
 		for (i = 0; i < pkts; i++) {
-			if (mbufs[next_idx + i]) {
+			if (mbufs[next_idx + i] && d->steal &&
+					mbufs[next_idx + i]->hash.usr == 0) {
+				/* untagged, not bound to any flow */
+				flows[i] = 0;
+			} else if (mbufs[next_idx + i]) {
 				/* flows have to be non-zero */
 				flows[i] = mbufs[next_idx + i]->hash.usr | 1;
 			} else
@@ -539,6 +639,16 @@ rte_distributor_process(struct rte_distributor *d,
 			 */
 			/* matches[j] = 0; */
 
+			/*
+			 * With work stealing, untagged packets get tag zero
+			 * and are never pinned, so that idle workers can
+			 * steal them.
+			 */
+			if (d->steal && next_mb->hash.usr == 0) {
+				new_tag = 0;
+				matches[j] = 0;
+			}
+
 			if (matches[j] && d->active[matches[j]-1]) {
 				struct rte_distributor_backlog *bl =
 						&d->backlog[matches[j]-1];
@@ -564,6 +674,8 @@ rte_distributor_process(struct rte_distributor *d,
 
 				while (unlikely(!d->active[wkr]))
 					wkr = (wkr + 1) % d->num_workers;
+				if (new_tag == 0)
+					wkr = find_worker_unpinned(d, wkr);
 				bl = &d->backlog[wkr];
 
 				if (unlikely(bl->count ==
@@ -588,9 +700,10 @@ rte_distributor_process(struct rte_distributor *d,
 				 * other packets with that same flow will go
 				 * to the same worker in this burst.
 				 */
-				for (w = j; w < pkts; w++)
-					if (flows[w] == new_tag)
-						matches[w] = wkr+1;
+				if (new_tag != 0)
+					for (w = j; w < pkts; w++)
+						if (flows[w] == new_tag)
+							matches[w] = wkr+1;
 			}
 		}
 		wkr = (wkr + 1) % d->num_workers;
@@ -707,6 +820,44 @@ rte_distributor_clear_returns(struct rte_distributor *d)
 	d->returns.start = d->returns.count = 0;
 }
 
+int
+rte_distributor_steal_set(struct rte_distributor *d, int enable)
+{
+	if (d == NULL)
+		return -EINVAL;
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+
+	d->steal = !!enable;
+	return 0;
+}
+
+int
+rte_distributor_stats_get(struct rte_distributor *d, unsigned int worker_id,
+		struct rte_distributor_worker_stats *stats)
+{
+	if (d == NULL || stats == NULL)
+		return -EINVAL;
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+	if (worker_id >= d->num_workers)
+		return -EINVAL;
+
+	*stats = d->stats[worker_id];
+	stats->outstanding = d->backlog[worker_id].count +
+			d->bufs[worker_id].count;
+	return 0;
+}
+
+void
+rte_distributor_stats_reset(struct rte_distributor *d)
+{
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return;
+
+	memset(d->stats, 0, sizeof(d->stats));
+}
+
 /* creates a distributor instance */
 struct rte_distributor *
 rte_distributor_create(const char *name,
@@ -777,6 +928,11 @@ rte_distributor_create(const char *name,
 	memset(d->active, 0, sizeof(d->active));
 	d->activesum = 0;
 
+	for (i = 0 ; i < num_workers ; i++)
+		d->bufs[i].socket_id = SOCKET_ID_ANY;
+	d->steal = 0;
+	memset(d->stats, 0, sizeof(d->stats));
+
 	dist_burst_list = RTE_TAILQ_CAST(rte_dist_burst_tailq.head,
 					  rte_dist_burst_list);
 
@@ -27,6 +27,18 @@ enum rte_distributor_alg_type {
 struct rte_distributor;
 struct rte_mbuf;
 
+/**
+ * Per worker statistics, maintained by the distributor lcore.
+ */
+struct rte_distributor_worker_stats {
+	uint64_t pkts;    /**< Packets handed to the worker. */
+	uint64_t bursts;  /**< Non-empty bursts handed to the worker. */
+	uint64_t returns; /**< Packets returned by the worker. */
+	uint64_t stolen;  /**< Packets stolen from the backlog of peers. */
+	uint64_t robbed;  /**< Packets of its backlog stolen by peers. */
+	uint32_t outstanding; /**< Packets in backlog or in flight. */
+};
+
 /**
  * Function to create a new distributor instance
  *
@@ -235,6 +247,71 @@ int
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable or disable work stealing on a burst distributor.
+ *
+ * With work stealing, packets with a zero tag are not bound to any flow:
+ * they are queued on the first worker whose backlog has room, preferring
+ * the workers ready for a new burst, and a worker ready for a new burst
+ * steals them from the backlog of peers still busy with their previous
+ * burst, peers of its own socket first. Packets with a non-zero tag keep
+ * their flow affinity.
+ *
+ * This should only be called on the same lcore as rte_distributor_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param enable
+ *   Non-zero to enable work stealing, zero to disable it.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters, -ENOTSUP for a distributor
+ *   using RTE_DIST_ALG_SINGLE.
+ */
+__rte_experimental
+int
+rte_distributor_steal_set(struct rte_distributor *d, int enable);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the statistics of a worker of a burst distributor.
+ *
+ * This should only be called on the same lcore as rte_distributor_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number.
+ * @param stats
+ *   The statistics to be filled in.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters, -ENOTSUP for a distributor
+ *   using RTE_DIST_ALG_SINGLE.
+ */
+__rte_experimental
+int
+rte_distributor_stats_get(struct rte_distributor *d, unsigned int worker_id,
+		struct rte_distributor_worker_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset the statistics of all workers of a burst distributor.
+ *
+ * This should only be called on the same lcore as rte_distributor_process()
+ *
+ * @param d
+ *   The distributor instance to be used
+ */
+__rte_experimental
+void
+rte_distributor_stats_reset(struct rte_distributor *d);
+
 #ifdef __cplusplus
 }
 #endif
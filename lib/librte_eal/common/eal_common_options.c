@@ -103,6 +103,8 @@ eal_long_options[] = {
 	{OPT_LEGACY_MEM,        0, NULL, OPT_LEGACY_MEM_NUM       },
 	{OPT_SINGLE_FILE_SEGMENTS, 0, NULL, OPT_SINGLE_FILE_SEGMENTS_NUM},
 	{OPT_MATCH_ALLOCATIONS, 0, NULL, OPT_MATCH_ALLOCATIONS_NUM},
+	{OPT_HUGE_POPULATE_THREADS, 1, NULL, OPT_HUGE_POPULATE_THREADS_NUM},
+	{OPT_HUGE_LAZY_POPULATE, 0, NULL, OPT_HUGE_LAZY_POPULATE_NUM},
 	{OPT_TELEMETRY,         0, NULL, OPT_TELEMETRY_NUM        },
 	{OPT_NO_TELEMETRY,      0, NULL, OPT_NO_TELEMETRY_NUM     },
 	{OPT_FORCE_MAX_SIMD_BITWIDTH, 1, NULL, OPT_FORCE_MAX_SIMD_BITWIDTH_NUM},
@@ -331,6 +333,8 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
 	}
 	internal_cfg->base_virtaddr = 0;
+	internal_cfg->huge_populate_threads = 1;
+	internal_cfg->huge_lazy_populate = 0;
 
 #ifdef LOG_DAEMON
 	internal_cfg->syslog_facility = LOG_DAEMON;
@@ -1984,6 +1988,21 @@ eal_check_common_options(struct internal_config *internal_cfg)
 				"with --"OPT_MATCH_ALLOCATIONS"\n");
 		return -1;
 	}
+	if ((internal_cfg->legacy_mem || internal_cfg->no_hugetlbfs) &&
+			(internal_cfg->huge_populate_threads > 1 ||
+			internal_cfg->huge_lazy_populate)) {
+		RTE_LOG(ERR, EAL, "Options --"OPT_HUGE_POPULATE_THREADS" and "
+				"--"OPT_HUGE_LAZY_POPULATE" are not compatible "
+				"with --"OPT_LEGACY_MEM" or --"OPT_NO_HUGE"\n");
+		return -1;
+	}
+	if (internal_cfg->single_file_segments &&
+			internal_cfg->huge_populate_threads > 1) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_HUGE_POPULATE_THREADS" is "
+				"not compatible with "
+				"--"OPT_SINGLE_FILE_SEGMENTS"\n");
+		return -1;
+	}
 	if (internal_cfg->legacy_mem && internal_cfg->memory == 0) {
 		RTE_LOG(NOTICE, EAL, "Static memory layout is selected, "
 			"amount of reserved memory can be adjusted with "
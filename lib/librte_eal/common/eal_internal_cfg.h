@@ -75,6 +75,10 @@ struct internal_config {
 	/**< true if storing all pages within single files (per-page-size,
 	 * per-node) non-legacy mode only.
 	 */
+	unsigned int huge_populate_threads;
+	/**< number of threads faulting in hugepages at init */
+	unsigned int huge_lazy_populate;
+	/**< true to fault in hugepages on first use instead of at init */
 	volatile int syslog_facility;	  /**< facility passed to openlog() */
 	/** default interrupt mode for VFIO */
 	volatile enum rte_intr_mode vfio_intr_mode;
@@ -87,6 +87,10 @@ enum {
 	OPT_IOVA_MODE_NUM,
 #define OPT_MATCH_ALLOCATIONS  "match-allocations"
 	OPT_MATCH_ALLOCATIONS_NUM,
+#define OPT_HUGE_POPULATE_THREADS "huge-populate-threads"
+	OPT_HUGE_POPULATE_THREADS_NUM,
+#define OPT_HUGE_LAZY_POPULATE "huge-lazy-populate"
+	OPT_HUGE_LAZY_POPULATE_NUM,
 #define OPT_TELEMETRY         "telemetry"
 	OPT_TELEMETRY_NUM,
 #define OPT_NO_TELEMETRY      "no-telemetry"
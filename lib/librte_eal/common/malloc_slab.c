@@ -0,0 +1,542 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+
+#include "eal_memcfg.h"
+#include "eal_private.h"
+#include "malloc_elem.h"
+#include "malloc_heap.h"
+
+/*
+ * Size-class allocator layered on top of the malloc heaps.
+ *
+ * Objects of a given size class are carved out of slabs, blocks allocated
+ * from the malloc heap with SLAB_SIZE alignment and at most SLAB_SIZE
+ * bytes long, so that the slab owning an object is found by masking its
+ * address.
+ * Slabs are owned by a depot, one per heap and size class, protected by
+ * its own lock. Each lcore caches free objects of its local heap in two
+ * magazines (arrays of object pointers) per size class; magazines are
+ * exchanged as a whole with the depot, so that the depot lock is taken at
+ * most once every few operations and the heap lock only when a slab is
+ * created or released.
+ *
+ * All the state lives in a memzone, so that objects may be freed by any
+ * process.
+ */
+
+#define SLAB_SIZE		(64 * 1024)
+/*
+ * Usable length of a slab: the malloc element header of the next slab
+ * fits in the same SLAB_SIZE block, so that slabs taken one after the
+ * other are laid out back to back instead of every other block.
+ */
+#define SLAB_LEN		(SLAB_SIZE - MALLOC_ELEM_OVERHEAD)
+#define SLAB_MAG_SIZE		32
+/* maximum number of full magazines kept in a depot */
+#define SLAB_DEPOT_MAX_MAGS	16
+/* maximum number of unused slabs kept in a depot */
+#define SLAB_DEPOT_MAX_FREE	2
+
+#define SLAB_MAGIC		0x51ab51abU
+#define SLAB_MAGIC_LARGE	0x51ab1a26U
+
+#define SLAB_MZ_NAME		"eal_malloc_slab"
+
+static const uint32_t slab_class_size[] = {
+	64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
+
+#define SLAB_NB_CLASSES		RTE_DIM(slab_class_size)
+#define SLAB_MAX_OBJ_SIZE	4096
+
+struct slab_mag {
+	struct slab_mag *next;
+	uint32_t n;
+	void *objs[SLAB_MAG_SIZE];
+};
+
+struct slab_depot;
+
+/* header at the start of every slab and of every large object */
+struct slab_hdr {
+	uint32_t magic;
+	uint32_t cls;
+	uint32_t nb_objs;
+	uint32_t nb_free;
+	void *free_list;
+	struct slab_depot *depot;
+	LIST_ENTRY(slab_hdr) next;
+} __rte_cache_aligned;
+
+struct slab_depot {
+	rte_spinlock_t lock;
+	uint32_t nb_slabs;
+	uint32_t nb_free_slabs; /**< slabs with no object in use */
+	uint32_t nb_full;
+	uint32_t nb_empty;
+	struct slab_mag *full;
+	struct slab_mag *empty;
+	LIST_HEAD(, slab_hdr) partial; /**< slabs with free objects */
+} __rte_cache_aligned;
+
+struct slab_cache {
+	struct slab_mag *loaded;
+	struct slab_mag *prev;
+};
+
+struct slab_lcore {
+	struct slab_cache cache[SLAB_NB_CLASSES];
+} __rte_cache_aligned;
+
+struct slab_state {
+	uint32_t initialized;
+	struct slab_depot depot[RTE_MAX_HEAPS][SLAB_NB_CLASSES];
+	struct slab_lcore lcore[RTE_MAX_LCORE];
+};
+
+static struct slab_state *slab_state;
+static rte_spinlock_t slab_init_lock = RTE_SPINLOCK_INITIALIZER;
+
+static struct slab_state *
+slab_get_state(void)
+{
+	const struct rte_memzone *mz;
+	struct slab_state *st;
+
+	st = __atomic_load_n(&slab_state, __ATOMIC_ACQUIRE);
+	if (likely(st != NULL))
+		return st;
+
+	rte_spinlock_lock(&slab_init_lock);
+	mz = rte_memzone_lookup(SLAB_MZ_NAME);
+	if (mz == NULL && rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		mz = rte_memzone_reserve(SLAB_MZ_NAME, sizeof(*st),
+				SOCKET_ID_ANY, 0);
+		if (mz != NULL) {
+			st = mz->addr;
+			memset(st, 0, sizeof(*st));
+			__atomic_store_n(&st->initialized, 1, __ATOMIC_RELEASE);
+		}
+	}
+	if (mz != NULL) {
+		st = mz->addr;
+		if (__atomic_load_n(&st->initialized, __ATOMIC_ACQUIRE))
+			__atomic_store_n(&slab_state, st, __ATOMIC_RELEASE);
+		else
+			st = NULL;
+	}
+	rte_spinlock_unlock(&slab_init_lock);
+
+	if (st == NULL)
+		rte_errno = ENOMEM;
+	return st;
+}
+
+static inline unsigned int
+slab_size_to_class(size_t size)
+{
+	unsigned int cls = 0;
+
+	while (slab_class_size[cls] < size)
+		cls++;
+	return cls;
+}
+
+static inline struct slab_hdr *
+slab_from_obj(void *obj)
+{
+	return (struct slab_hdr *)RTE_PTR_ALIGN_FLOOR(obj, SLAB_SIZE);
+}
+
+/* create a new slab for the depot, called with the depot lock held */
+static struct slab_hdr *
+slab_create(struct slab_depot *depot, unsigned int cls, int socket)
+{
+	uint32_t obj_size = slab_class_size[cls];
+	struct slab_hdr *slab;
+	char *objs;
+	uint32_t i;
+
+	slab = rte_malloc_socket("slab", SLAB_LEN, SLAB_SIZE, socket);
+	if (slab == NULL)
+		return NULL;
+
+	slab->magic = SLAB_MAGIC;
+	slab->cls = cls;
+	slab->depot = depot;
+	slab->nb_objs = (SLAB_LEN - sizeof(*slab)) / obj_size;
+	slab->nb_free = slab->nb_objs;
+	slab->free_list = NULL;
+
+	/* chain objects so that they are handed out in address order */
+	objs = (char *)(slab + 1);
+	for (i = slab->nb_objs; i != 0; i--) {
+		void **obj = (void **)(objs + (i - 1) * obj_size);
+
+		*obj = slab->free_list;
+		slab->free_list = obj;
+	}
+
+	LIST_INSERT_HEAD(&depot->partial, slab, next);
+	depot->nb_slabs++;
+	depot->nb_free_slabs++;
+
+	return slab;
+}
+
+/* take up to n objects from the slabs, called with the depot lock held */
+static unsigned int
+slab_get_objs(struct slab_depot *depot, unsigned int cls, int socket,
+		void **objs, unsigned int n)
+{
+	struct slab_hdr *slab;
+	unsigned int i = 0;
+
+	while (i < n) {
+		slab = LIST_FIRST(&depot->partial);
+		if (slab == NULL) {
+			slab = slab_create(depot, cls, socket);
+			if (slab == NULL)
+				break;
+		}
+		if (slab->nb_free == slab->nb_objs)
+			depot->nb_free_slabs--;
+
+		while (i < n && slab->nb_free != 0) {
+			void **obj = slab->free_list;
+
+			slab->free_list = *obj;
+			slab->nb_free--;
+			objs[i++] = obj;
+		}
+		if (slab->nb_free == 0)
+			LIST_REMOVE(slab, next);
+	}
+
+	return i;
+}
+
+/* give n objects back to their slabs, called with the depot lock held */
+static void
+slab_put_objs(struct slab_depot *depot, void * const *objs, unsigned int n)
+{
+	struct slab_hdr *slab;
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		void **obj = objs[i];
+
+		slab = slab_from_obj(obj);
+		*obj = slab->free_list;
+		slab->free_list = obj;
+		if (slab->nb_free++ == 0)
+			LIST_INSERT_HEAD(&depot->partial, slab, next);
+		if (slab->nb_free != slab->nb_objs)
+			continue;
+
+		/* keep a few unused slabs to absorb bursts, release others */
+		if (depot->nb_free_slabs < SLAB_DEPOT_MAX_FREE) {
+			depot->nb_free_slabs++;
+			continue;
+		}
+		LIST_REMOVE(slab, next);
+		depot->nb_slabs--;
+		slab->magic = 0;
+		rte_free(slab);
+	}
+}
+
+static struct slab_cache *
+slab_lcore_cache(struct slab_state *st, unsigned int lcore_id,
+		unsigned int cls)
+{
+	struct slab_cache *c = &st->lcore[lcore_id].cache[cls];
+	struct slab_mag *loaded, *prev;
+
+	if (likely(c->loaded != NULL))
+		return c;
+
+	loaded = rte_zmalloc("slab_mag", sizeof(*loaded), 0);
+	prev = rte_zmalloc("slab_mag", sizeof(*prev), 0);
+	if (loaded == NULL || prev == NULL) {
+		rte_free(loaded);
+		rte_free(prev);
+		return NULL;
+	}
+	c->prev = prev;
+	c->loaded = loaded;
+	return c;
+}
+
+static void *
+slab_cache_alloc(struct slab_cache *c, struct slab_depot *depot,
+		unsigned int cls, int socket)
+{
+	struct slab_mag *m;
+
+	if (c->loaded->n == 0 && c->prev->n != 0) {
+		m = c->loaded;
+		c->loaded = c->prev;
+		c->prev = m;
+	}
+	if (c->loaded->n != 0)
+		return c->loaded->objs[--c->loaded->n];
+
+	/* both magazines are empty: exchange one for a full one, or fill
+	 * it straight from the slabs.
+	 */
+	rte_spinlock_lock(&depot->lock);
+	m = depot->full;
+	if (m != NULL) {
+		depot->full = m->next;
+		depot->nb_full--;
+		c->loaded->next = depot->empty;
+		depot->empty = c->loaded;
+		depot->nb_empty++;
+		c->loaded = m;
+	} else {
+		c->loaded->n = slab_get_objs(depot, cls, socket,
+				c->loaded->objs, SLAB_MAG_SIZE / 2);
+	}
+	rte_spinlock_unlock(&depot->lock);
+
+	if (c->loaded->n == 0) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	return c->loaded->objs[--c->loaded->n];
+}
+
+static void
+slab_cache_free(struct slab_cache *c, struct slab_depot *depot, void *obj)
+{
+	struct slab_mag *m;
+
+	if (c->loaded->n == SLAB_MAG_SIZE && c->prev->n != SLAB_MAG_SIZE) {
+		m = c->loaded;
+		c->loaded = c->prev;
+		c->prev = m;
+	}
+	if (c->loaded->n != SLAB_MAG_SIZE) {
+		c->loaded->objs[c->loaded->n++] = obj;
+		return;
+	}
+
+	/* both magazines are full: hand one over to the depot, or give its
+	 * objects back to the slabs when the depot holds enough already.
+	 */
+	rte_spinlock_lock(&depot->lock);
+	m = depot->empty;
+	if (m != NULL) {
+		depot->empty = m->next;
+		depot->nb_empty--;
+	} else if (depot->nb_full < SLAB_DEPOT_MAX_MAGS) {
+		m = rte_zmalloc("slab_mag", sizeof(*m), 0);
+	}
+	if (m != NULL && depot->nb_full < SLAB_DEPOT_MAX_MAGS) {
+		c->prev->next = depot->full;
+		depot->full = c->prev;
+		depot->nb_full++;
+		c->prev = m;
+	} else {
+		if (m != NULL) {
+			m->next = depot->empty;
+			depot->empty = m;
+			depot->nb_empty++;
+		}
+		slab_put_objs(depot, c->prev->objs, c->prev->n);
+		c->prev->n = 0;
+	}
+	rte_spinlock_unlock(&depot->lock);
+
+	m = c->loaded;
+	c->loaded = c->prev;
+	c->prev = m;
+	c->loaded->objs[c->loaded->n++] = obj;
+}
+
+static void *
+slab_large_alloc(size_t size, int socket)
+{
+	struct slab_hdr *hdr;
+
+	if (size > SIZE_MAX - sizeof(*hdr)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	hdr = rte_malloc_socket("slab_large", sizeof(*hdr) + size, SLAB_SIZE,
+			socket);
+	if (hdr == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	hdr->magic = SLAB_MAGIC_LARGE;
+	return hdr + 1;
+}
+
+void *
+rte_slab_alloc(size_t size, int socket)
+{
+	struct slab_state *st;
+	struct slab_depot *depot;
+	struct slab_cache *c;
+	unsigned int lcore_id, cls, local;
+	int heap_id;
+	void *obj;
+
+	if (size == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (size > SLAB_MAX_OBJ_SIZE)
+		return slab_large_alloc(size, socket);
+
+	st = slab_get_state();
+	if (st == NULL)
+		return NULL;
+
+	/* slabs are taken from the heap of their depot only */
+	local = malloc_get_numa_socket();
+	if (socket == SOCKET_ID_ANY)
+		socket = local;
+	heap_id = malloc_socket_to_heap_id(socket);
+	if (heap_id < 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	cls = slab_size_to_class(size);
+	depot = &st->depot[heap_id][cls];
+
+	/* only allocations on the local heap go through the lcore cache */
+	lcore_id = rte_lcore_id();
+	if ((unsigned int)socket != local)
+		lcore_id = LCORE_ID_ANY;
+	if (lcore_id < RTE_MAX_LCORE) {
+		c = slab_lcore_cache(st, lcore_id, cls);
+		if (c != NULL)
+			return slab_cache_alloc(c, depot, cls, socket);
+	}
+
+	rte_spinlock_lock(&depot->lock);
+	if (slab_get_objs(depot, cls, socket, &obj, 1) == 0)
+		obj = NULL;
+	rte_spinlock_unlock(&depot->lock);
+
+	if (obj == NULL)
+		rte_errno = ENOMEM;
+	return obj;
+}
+
+void *
+rte_slab_zalloc(size_t size, int socket)
+{
+	void *obj = rte_slab_alloc(size, socket);
+
+	if (obj != NULL)
+		memset(obj, 0, size);
+	return obj;
+}
+
+void
+rte_slab_free(void *ptr)
+{
+	struct slab_state *st;
+	struct slab_depot *depot;
+	struct slab_hdr *slab;
+	struct slab_cache *c;
+	unsigned int lcore_id;
+	int heap_id;
+
+	if (ptr == NULL)
+		return;
+
+	slab = slab_from_obj(ptr);
+	if (slab->magic == SLAB_MAGIC_LARGE) {
+		slab->magic = 0;
+		rte_free(slab);
+		return;
+	}
+	st = slab_get_state();
+	if (slab->magic != SLAB_MAGIC || st == NULL) {
+		RTE_LOG(ERR, EAL, "Error: Invalid slab object\n");
+		return;
+	}
+	depot = slab->depot;
+
+	/* objects of the local heap go to the lcore cache */
+	lcore_id = rte_lcore_id();
+	if (lcore_id < RTE_MAX_LCORE) {
+		heap_id = malloc_socket_to_heap_id(malloc_get_numa_socket());
+		if (heap_id >= 0 && depot == &st->depot[heap_id][slab->cls]) {
+			c = slab_lcore_cache(st, lcore_id, slab->cls);
+			if (c != NULL) {
+				slab_cache_free(c, depot, ptr);
+				return;
+			}
+		}
+	}
+
+	rte_spinlock_lock(&depot->lock);
+	slab_put_objs(depot, &ptr, 1);
+	rte_spinlock_unlock(&depot->lock);
+}
+
+void
+rte_slab_dump(FILE *f)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct slab_state *st;
+	struct slab_depot *depot;
+	unsigned int heap_id, cls, lcore_id, cached;
+
+	st = slab_get_state();
+	if (st == NULL)
+		return;
+
+	for (heap_id = 0; heap_id < RTE_MAX_HEAPS; heap_id++) {
+		for (cls = 0; cls < SLAB_NB_CLASSES; cls++) {
+			depot = &st->depot[heap_id][cls];
+
+			rte_spinlock_lock(&depot->lock);
+			if (depot->nb_slabs != 0 || depot->nb_full != 0)
+				fprintf(f, "heap %s, size %u: slabs=%u "
+					"unused_slabs=%u full_mags=%u "
+					"empty_mags=%u\n",
+					mcfg->malloc_heaps[heap_id].name,
+					slab_class_size[cls], depot->nb_slabs,
+					depot->nb_free_slabs, depot->nb_full,
+					depot->nb_empty);
+			rte_spinlock_unlock(&depot->lock);
+		}
+	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cached = 0;
+		for (cls = 0; cls < SLAB_NB_CLASSES; cls++) {
+			struct slab_cache *c = &st->lcore[lcore_id].cache[cls];
+
+			if (c->loaded != NULL)
+				cached += c->loaded->n + c->prev->n;
+		}
+		if (cached != 0)
+			fprintf(f, "lcore %u: cached_objs=%u\n", lcore_id,
+				cached);
+	}
+}
@@ -561,6 +561,76 @@ rte_malloc_set_limit(const char *type, size_t max);
 rte_iova_t
 rte_malloc_virt2iova(const void *addr);
 
+/**
+ * Allocate an object from the size-class allocator.
+ *
+ * Objects up to 4 KB are carved out of slabs taken from the malloc heaps
+ * and cached on each lcore, so that allocating and freeing them usually
+ * takes no lock. Larger objects are allocated from the malloc heap
+ * directly. This is meant for small objects allocated and freed at a high
+ * rate at runtime, such as session contexts; the memory is not cleared.
+ *
+ * @param size
+ *   Size (in bytes) to be allocated.
+ * @param socket
+ *   NUMA socket to allocate memory on. If SOCKET_ID_ANY is used, the
+ *   memory is allocated on the socket of the calling lcore when possible.
+ *   Only allocations on the socket of the calling lcore are cached.
+ * @return
+ *   - NULL on error, with rte_errno set. Not enough memory, or invalid
+ *     arguments (size is 0, unknown socket).
+ *   - Otherwise, the pointer to the allocated object, aligned on
+ *     RTE_CACHE_LINE_MIN_SIZE bytes.
+ */
+__rte_experimental
+void *
+rte_slab_alloc(size_t size, int socket)
+	__rte_alloc_size(1);
+
+/**
+ * Allocate an object from the size-class allocator and clear it.
+ *
+ * @see rte_slab_alloc()
+ *
+ * @param size
+ *   Size (in bytes) to be allocated.
+ * @param socket
+ *   NUMA socket to allocate memory on.
+ * @return
+ *   - NULL on error, with rte_errno set.
+ *   - Otherwise, the pointer to the allocated object.
+ */
+__rte_experimental
+void *
+rte_slab_zalloc(size_t size, int socket)
+	__rte_alloc_size(1);
+
+/**
+ * Free an object allocated with rte_slab_alloc() or rte_slab_zalloc().
+ *
+ * The object may be freed by any thread or process. It is kept in the
+ * cache of the calling lcore when it belongs to its socket. Objects from
+ * the size-class allocator must not be passed to rte_free() and vice versa.
+ *
+ * If the pointer is NULL, the function does nothing.
+ *
+ * @param ptr
+ *   The pointer to the object to be freed.
+ */
+__rte_experimental
+void
+rte_slab_free(void *ptr);
+
+/**
+ * Dump the statistics of the size-class allocator to a file.
+ *
+ * @param f
+ *   A pointer to a file for output
+ */
+__rte_experimental
+void
+rte_slab_dump(FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
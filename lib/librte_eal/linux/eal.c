@@ -547,6 +547,8 @@ eal_usage(const char *prgname)
 	       "  --"OPT_LEGACY_MEM"        Legacy memory mode (no dynamic allocation, contiguous segments)\n"
 	       "  --"OPT_SINGLE_FILE_SEGMENTS" Put all hugepage memory in single files\n"
 	       "  --"OPT_MATCH_ALLOCATIONS" Free hugepages exactly as allocated\n"
+	       "  --"OPT_HUGE_POPULATE_THREADS" Number of threads per socket faulting in hugepages at init\n"
+	       "  --"OPT_HUGE_LAZY_POPULATE" Fault in hugepages on first use rather than at init (IOVA as VA only)\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if (hook) {
@@ -638,6 +640,37 @@ eal_parse_vfio_vf_token(const char *vf_token)
 	return -1;
 }
 
+static int
+eal_parse_populate_threads(const char *arg)
+{
+	struct internal_config *cfg = eal_get_internal_configuration();
+	unsigned long n;
+	char *end;
+
+	errno = 0;
+	n = strtoul(arg, &end, 10);
+	if (errno != 0 || end == arg || *end != '\0' || n == 0 ||
+			n > RTE_MAX_LCORE)
+		return -1;
+
+	cfg->huge_populate_threads = n;
+	return 0;
+}
+
+/* return the ms elapsed since the time pointed to, and reset it to now */
+static unsigned long
+eal_phase_time_ms(struct timespec *ts)
+{
+	struct timespec now;
+	unsigned long ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	ms = (now.tv_sec - ts->tv_sec) * 1000 +
+		(now.tv_nsec - ts->tv_nsec) / 1000000;
+	*ts = now;
+	return ms;
+}
+
 /* Parse the arguments for --log-level only */
 static void
 eal_log_level_parse(int argc, char **argv)
@@ -814,6 +847,20 @@ eal_parse_args(int argc, char **argv)
 			internal_conf->match_allocations = 1;
 			break;
 
+		case OPT_HUGE_POPULATE_THREADS_NUM:
+			if (eal_parse_populate_threads(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameters for --"
+						OPT_HUGE_POPULATE_THREADS "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
+		case OPT_HUGE_LAZY_POPULATE_NUM:
+			internal_conf->huge_lazy_populate = 1;
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -966,6 +1013,8 @@ rte_eal_init(int argc, char **argv)
 	char cpuset[RTE_CPU_AFFINITY_STR_LEN];
 	char thread_name[RTE_MAX_THREAD_NAME_LEN];
 	bool phys_addrs;
+	struct timespec phase_ts;
+	unsigned long hugepage_info_ms, memory_ms;
 	const struct rte_config *config = rte_eal_get_configuration();
 	struct internal_config *internal_conf =
 		eal_get_internal_configuration();
@@ -1131,6 +1180,12 @@ rte_eal_init(int argc, char **argv)
 	RTE_LOG(INFO, EAL, "Selected IOVA mode '%s'\n",
 		rte_eal_iova_mode() == RTE_IOVA_PA ? "PA" : "VA");
 
+	if (internal_conf->huge_lazy_populate &&
+			rte_eal_iova_mode() == RTE_IOVA_PA)
+		RTE_LOG(WARNING, EAL, "Ignoring --"OPT_HUGE_LAZY_POPULATE
+			", hugepages must be populated to get their IOVA\n");
+
+	clock_gettime(CLOCK_MONOTONIC, &phase_ts);
 	if (internal_conf->no_hugetlbfs == 0) {
 		/* rte_config isn't initialized yet */
 		ret = internal_conf->process_type == RTE_PROC_PRIMARY ?
@@ -1144,6 +1199,8 @@ rte_eal_init(int argc, char **argv)
 		}
 	}
 
+	hugepage_info_ms = eal_phase_time_ms(&phase_ts);
+
 	if (internal_conf->memory == 0 && internal_conf->force_sockets == 0) {
 		if (internal_conf->no_hugetlbfs)
 			internal_conf->memory = MEMSIZE_IF_NO_HUGE_PAGE;
@@ -1179,6 +1236,7 @@ rte_eal_init(int argc, char **argv)
 	 * not present in primary processes, so to avoid any potential issues,
 	 * initialize memzones first.
 	 */
+	eal_phase_time_ms(&phase_ts);
 	if (rte_eal_memzone_init() < 0) {
 		rte_eal_init_alert("Cannot init memzone");
 		rte_errno = ENODEV;
@@ -1191,6 +1249,8 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	memory_ms = eal_phase_time_ms(&phase_ts);
+
 	/* the directories are locked during eal_hugepage_info_init */
 	eal_hugedirs_unlock();
 
@@ -1200,6 +1260,10 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	RTE_LOG(DEBUG, EAL, "Memory init times: hugepage info %lu ms, "
+		"memory map %lu ms, malloc heap %lu ms\n",
+		hugepage_info_ms, memory_ms, eal_phase_time_ms(&phase_ts));
+
 	if (rte_eal_tailqs_init() < 0) {
 		rte_eal_init_alert("Cannot init tail queues for objects");
 		rte_errno = EFAULT;
@@ -3,6 +3,8 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -22,6 +24,7 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <time.h>
 #ifdef F_ADD_SEALS /* if file sealing is supported, so is memfd */
 #include <linux/memfd.h>
 #define MEMFD_SUPPORTED
@@ -38,6 +41,7 @@
 #include <rte_eal.h>
 #include <rte_errno.h>
 #include <rte_memory.h>
+#include <rte_per_lcore.h>
 #include <rte_spinlock.h>
 
 #include "eal_filesystem.h"
@@ -45,6 +49,7 @@
 #include "eal_memalloc.h"
 #include "eal_memcfg.h"
 #include "eal_private.h"
+#include "eal_thread.h"
 
 const int anonymous_hugepages_supported =
 #ifdef MAP_HUGE_SHIFT
@@ -105,11 +110,12 @@ static struct {
 /** local copy of a memory map, used to synchronize memory hotplug in MP */
 static struct rte_memseg_list local_memsegs[RTE_MAX_MEMSEG_LISTS];
 
-static sigjmp_buf huge_jmpenv;
+/* per thread, as hugepages may be faulted in by several threads at init */
+static RTE_DEFINE_PER_LCORE(sigjmp_buf, huge_jmpenv);
 
 static void __rte_unused huge_sigbus_handler(int signo __rte_unused)
 {
-	siglongjmp(huge_jmpenv, 1);
+	siglongjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /* Put setjmp into a wrap method to avoid compiling error. Any non-volatile,
@@ -118,7 +124,7 @@ static void __rte_unused huge_sigbus_handler(int signo __rte_unused)
  */
 static int __rte_unused huge_wrap_sigsetjmp(void)
 {
-	return sigsetjmp(huge_jmpenv, 1);
+	return sigsetjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 static struct sigaction huge_action_old;
@@ -193,6 +199,25 @@ restore_numa(int *oldpolicy, struct bitmask *oldmask)
 	}
 	numa_free_cpumask(oldmask);
 }
+
+/*
+ * bind a range not faulted in yet to a node, pages that cannot be taken
+ * from this node at fault time raise SIGBUS instead of landing elsewhere
+ */
+static int
+bind_numa(void *addr, size_t len, int socket_id)
+{
+	struct bitmask *mask = numa_allocate_nodemask();
+	int ret;
+
+	numa_bitmask_setbit(mask, socket_id);
+	ret = mbind(addr, len, MPOL_BIND, mask->maskp, mask->size + 1, 0);
+	if (ret < 0)
+		RTE_LOG(DEBUG, EAL, "%s(): mbind() failed: %s\n",
+			__func__, strerror(errno));
+	numa_bitmask_free(mask);
+	return ret;
+}
 #endif
 
 /*
@@ -508,11 +533,19 @@ alloc_seg(struct rte_memseg *ms, void *addr, int socket_id,
 	size_t alloc_sz;
 	int flags;
 	void *new_addr;
+	bool populate;
 	const struct internal_config *internal_conf =
 		eal_get_internal_configuration();
 
 	alloc_sz = hi->hugepage_sz;
 
+	/* pages preallocated at init may be left for the kernel to fault in,
+	 * and clear, on first use if their IOVA is not needed right away.
+	 */
+	populate = !internal_conf->huge_lazy_populate ||
+			internal_conf->init_complete ||
+			rte_eal_iova_mode() != RTE_IOVA_VA;
+
 	/* these are checked at init, but code analyzers don't know that */
 	if (internal_conf->in_memory && !anonymous_hugepages_supported) {
 		RTE_LOG(ERR, EAL, "Anonymous hugepages not supported, in-memory mode cannot allocate memory\n");
@@ -573,7 +606,9 @@ alloc_seg(struct rte_memseg *ms, void *addr, int socket_id,
 				}
 			}
 		}
-		mmap_flags = MAP_SHARED | MAP_POPULATE | MAP_FIXED;
+		mmap_flags = MAP_SHARED | MAP_FIXED;
+		if (populate)
+			mmap_flags |= MAP_POPULATE;
 	}
 
 	/*
@@ -597,6 +632,20 @@ alloc_seg(struct rte_memseg *ms, void *addr, int socket_id,
 		goto resized;
 	}
 
+	/*
+	 * Nothing is faulted in, so neither the availability of the page nor
+	 * its node can be checked here: the node is enforced by the memory
+	 * policy, and a page missing at first touch raises SIGBUS then.
+	 */
+	if (!populate) {
+		iova = rte_mem_virt2iova(addr);
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+		if (check_numa() && bind_numa(addr, alloc_sz, socket_id) < 0)
+			goto mapped;
+#endif
+		goto populated;
+	}
+
 	/* In linux, hugetlb limitations, like cgroup, are
 	 * enforced at fault time instead of mmap(), even
 	 * with the option of MAP_POPULATE. Kernel will send
@@ -651,6 +700,7 @@ alloc_seg(struct rte_memseg *ms, void *addr, int socket_id,
 				__func__);
 #endif
 
+populated:
 	ms->addr = addr;
 	ms->hugepage_sz = alloc_sz;
 	ms->len = alloc_sz;
@@ -788,6 +838,135 @@ struct alloc_walk_param {
 	int socket;
 	bool exact;
 };
+
+struct alloc_thread_param {
+	pthread_t tid;
+	struct rte_memseg_list *msl;
+	const struct alloc_walk_param *wa;
+	unsigned int msl_idx;
+	int start_idx;
+	unsigned int n_segs;
+	unsigned int segs_allocated;
+};
+
+static void *
+alloc_seg_thread(void *arg)
+{
+	struct alloc_thread_param *p = arg;
+	struct rte_memseg *cur;
+	void *map_addr;
+	int cur_idx;
+	unsigned int i;
+
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	/* memory policy is per thread */
+	if (check_numa())
+		numa_set_preferred(p->wa->socket);
+#endif
+
+	cur_idx = p->start_idx;
+	for (i = 0; i < p->n_segs; i++, cur_idx++) {
+		cur = rte_fbarray_get(&p->msl->memseg_arr, cur_idx);
+		map_addr = RTE_PTR_ADD(p->msl->base_va,
+				cur_idx * p->msl->page_sz);
+		if (alloc_seg(cur, map_addr, p->wa->socket, p->wa->hi,
+				p->msl_idx, cur_idx))
+			break;
+	}
+	p->segs_allocated = i;
+
+	return NULL;
+}
+
+/*
+ * Fault in segments of a memseg list with several threads running on the
+ * socket memory is allocated from, as clearing hugepages takes most of the
+ * initialization time. Returns the number of segments allocated from the
+ * start index onwards; segments allocated past a failure are released.
+ */
+static unsigned int
+alloc_seg_parallel(struct rte_memseg_list *msl, unsigned int msl_idx,
+		int start_idx, unsigned int need,
+		const struct alloc_walk_param *wa)
+{
+	const struct internal_config *internal_conf =
+		eal_get_internal_configuration();
+	struct alloc_thread_param *threads;
+	struct timespec t_start, t_end;
+	unsigned int n_threads, i, j, allocated;
+	pthread_attr_t attr;
+	rte_cpuset_t cpuset;
+	bool hole;
+
+	n_threads = RTE_MIN(internal_conf->huge_populate_threads, need);
+	threads = calloc(n_threads, sizeof(*threads));
+	if (threads == NULL)
+		return 0;
+
+	CPU_ZERO(&cpuset);
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (eal_cpu_detected(i) &&
+				eal_cpu_socket_id(i) == (unsigned int)wa->socket)
+			CPU_SET(i, &cpuset);
+	}
+	pthread_attr_init(&attr);
+	if (CPU_COUNT(&cpuset) != 0)
+		pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+
+	clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+	for (i = 0, j = 0; i < n_threads; i++) {
+		struct alloc_thread_param *p = &threads[i];
+
+		p->msl = msl;
+		p->wa = wa;
+		p->msl_idx = msl_idx;
+		p->start_idx = start_idx + j;
+		p->n_segs = need / n_threads + (i < need % n_threads);
+		j += p->n_segs;
+
+		/* fall back to doing the work ourselves */
+		if (pthread_create(&p->tid, &attr, alloc_seg_thread, p) != 0) {
+			p->tid = pthread_self();
+			alloc_seg_thread(p);
+		}
+	}
+	for (i = 0; i < n_threads; i++) {
+		if (!pthread_equal(threads[i].tid, pthread_self()))
+			pthread_join(threads[i].tid, NULL);
+	}
+	pthread_attr_destroy(&attr);
+
+	clock_gettime(CLOCK_MONOTONIC, &t_end);
+
+	/* keep segments up to the first failure, release the others */
+	allocated = 0;
+	hole = false;
+	for (i = 0; i < n_threads; i++) {
+		struct alloc_thread_param *p = &threads[i];
+
+		if (!hole) {
+			allocated += p->segs_allocated;
+			hole = p->segs_allocated != p->n_segs;
+			continue;
+		}
+		for (j = 0; j < p->segs_allocated; j++) {
+			struct rte_memseg *tmp = rte_fbarray_get(
+					&msl->memseg_arr, p->start_idx + j);
+
+			if (free_seg(tmp, wa->hi, msl_idx, p->start_idx + j))
+				RTE_LOG(DEBUG, EAL, "Cannot free page\n");
+		}
+	}
+	free(threads);
+
+	RTE_LOG(DEBUG, EAL, "Populated %u of %u pages of size %zuM on socket %d with %u threads in %ld ms\n",
+		allocated, need, wa->page_sz >> 20, wa->socket, n_threads,
+		(long)((t_end.tv_sec - t_start.tv_sec) * 1000 +
+		(t_end.tv_nsec - t_start.tv_nsec) / 1000000));
+
+	return allocated;
+}
 static int
 alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 {
@@ -796,7 +975,7 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 	struct rte_memseg_list *cur_msl;
 	size_t page_sz;
 	int cur_idx, start_idx, j, dir_fd = -1;
-	unsigned int msl_idx, need, i;
+	unsigned int msl_idx, need, i, populated;
 	const struct internal_config *internal_conf =
 		eal_get_internal_configuration();
 
@@ -864,6 +1043,16 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 		}
 	}
 
+	/* pages preallocated at init may be faulted in by several threads,
+	 * the remaining ones are allocated below.
+	 */
+	populated = 0;
+	if (!internal_conf->init_complete &&
+			internal_conf->huge_populate_threads > 1 &&
+			!internal_conf->single_file_segments && need > 1)
+		populated = alloc_seg_parallel(cur_msl, msl_idx, cur_idx,
+				need, wa);
+
 	for (i = 0; i < need; i++, cur_idx++) {
 		struct rte_memseg *cur;
 		void *map_addr;
@@ -872,8 +1061,8 @@ alloc_seg_walk(const struct rte_memseg_list *msl, void *arg)
 		map_addr = RTE_PTR_ADD(cur_msl->base_va,
 				cur_idx * page_sz);
 
-		if (alloc_seg(cur, map_addr, wa->socket, wa->hi,
-				msl_idx, cur_idx)) {
+		if (i >= populated && alloc_seg(cur, map_addr, wa->socket,
+				wa->hi, msl_idx, cur_idx)) {
 			RTE_LOG(DEBUG, EAL, "attempted to allocate %i segments, but only %i were allocated\n",
 				need, i);
 
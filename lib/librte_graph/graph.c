@@ -327,6 +327,10 @@ rte_graph_create(const char *name, struct rte_graph_param *prm)
 	graph->src_node_count = src_node_count;
 	graph->node_count = graph_nodes_count(graph);
 	graph->id = graph_id;
+	graph->parent_id = RTE_GRAPH_ID_INVALID;
+	graph->wq_size = prm->wq_size;
+	if (graph->wq_size == 0)
+		graph->wq_size = RTE_GRAPH_WQ_SIZE_DEFAULT;
 
 	/* Allocate the Graph fast path memory and populate the data */
 	if (graph_fp_mem_create(graph))
@@ -354,6 +358,100 @@ fail:
 	return RTE_GRAPH_ID_INVALID;
 }
 
+static rte_graph_t
+graph_clone(struct graph *parent_graph, const char *name,
+	    struct rte_graph_param *prm)
+{
+	struct graph_node *graph_node;
+	struct graph *graph;
+
+	/* Don't allow to clone a graph from a cloned graph */
+	if (parent_graph->parent_id != RTE_GRAPH_ID_INVALID)
+		SET_ERR_JMP(EEXIST, fail, "A cloned graph is not allowed to be"
+			    " cloned");
+
+	/* Create graph object */
+	graph = calloc(1, sizeof(*graph));
+	if (graph == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to calloc graph object");
+
+	/* Naming ceremony of the new graph. name is parent name + "-" + name */
+	STAILQ_INIT(&graph->node_list);
+	if (snprintf(graph->name, sizeof(graph->name), "%s-%s",
+		     parent_graph->name, name) >= (int)sizeof(graph->name))
+		SET_ERR_JMP(E2BIG, free, "Too big name=%s", name);
+
+	/* Check for existence of duplicate graph */
+	if (rte_graph_from_name(graph->name) != RTE_GRAPH_ID_INVALID)
+		SET_ERR_JMP(EEXIST, free, "Found duplicate graph %s",
+			    graph->name);
+
+	/* Keep the node order of the parent, so are the node offsets */
+	STAILQ_FOREACH(graph_node, &parent_graph->node_list, next)
+		if (graph_node_add(graph, graph_node->node))
+			goto graph_cleanup;
+
+	/* Update adjacency list of all nodes in the graph */
+	if (graph_adjacency_list_update(graph))
+		goto graph_cleanup;
+
+	/* Initialize the graph object */
+	graph->socket = prm->socket_id;
+	graph->src_node_count = parent_graph->src_node_count;
+	graph->node_count = parent_graph->node_count;
+	graph->id = graph_id;
+	graph->parent_id = parent_graph->id;
+	graph->wq_size = prm->wq_size;
+	if (graph->wq_size == 0)
+		graph->wq_size = RTE_GRAPH_WQ_SIZE_DEFAULT;
+
+	/* Allocate the Graph fast path memory and populate the data */
+	if (graph_fp_mem_create(graph))
+		goto graph_cleanup;
+
+	/* Call init() of the all the nodes in the graph */
+	if (graph_node_init(graph))
+		goto graph_mem_destroy;
+
+	/* All good, Lets add the graph to the list */
+	graph_id++;
+	STAILQ_INSERT_TAIL(&graph_list, graph, next);
+
+	return graph->id;
+
+graph_mem_destroy:
+	graph_fp_mem_destroy(graph);
+graph_cleanup:
+	graph_cleanup(graph);
+free:
+	free(graph);
+fail:
+	return RTE_GRAPH_ID_INVALID;
+}
+
+rte_graph_t
+rte_graph_clone(rte_graph_t id, const char *name, struct rte_graph_param *prm)
+{
+	rte_graph_t rc = RTE_GRAPH_ID_INVALID;
+	struct graph *graph;
+
+	graph_spinlock_lock();
+
+	if (prm == NULL || name == NULL)
+		SET_ERR_JMP(EINVAL, fail, "Invalid param");
+
+	GRAPH_ID_CHECK(id);
+	STAILQ_FOREACH(graph, &graph_list, next)
+		if (graph->id == id) {
+			rc = graph_clone(graph, name, prm);
+			break;
+		}
+
+fail:
+	graph_spinlock_unlock();
+	return rc;
+}
+
 int
 rte_graph_destroy(rte_graph_t id)
 {
@@ -366,6 +464,8 @@ rte_graph_destroy(rte_graph_t id)
 	while (graph != NULL) {
 		tmp = STAILQ_NEXT(graph, next);
 		if (graph->id == id) {
+			/* Stop the streams hand off to the graph */
+			graph_dispatch_wq_destroy(graph);
 			/* Call fini() of the all the nodes in the graph */
 			graph_node_fini(graph);
 			/* Destroy graph fast path memory */
@@ -15,6 +15,7 @@ graph_dump(FILE *f, struct graph *g)
 
 	fprintf(f, "graph <%s>\n", g->name);
 	fprintf(f, "  id=%" PRIu32 "\n", g->id);
+	fprintf(f, "  parent_id=%" PRIu32 "\n", g->parent_id);
 	fprintf(f, "  cir_start=%" PRIu32 "\n", g->cir_start);
 	fprintf(f, "  cir_mask=%" PRIu32 "\n", g->cir_mask);
 	fprintf(f, "  addr=%p\n", g);
@@ -35,6 +36,7 @@ node_dump(FILE *f, struct node *n)
 	fprintf(f, "node <%s>\n", n->name);
 	fprintf(f, "  id=%" PRIu32 "\n", n->id);
 	fprintf(f, "  flags=0x%" PRIx64 "\n", n->flags);
+	fprintf(f, "  lcore_id=%u\n", n->lcore_id);
 	fprintf(f, "  addr=%p\n", n);
 	fprintf(f, "  process=%p\n", n->process);
 	fprintf(f, "  nb_edges=%d\n", n->nb_edges);
@@ -58,6 +60,7 @@ rte_graph_obj_dump(FILE *f, struct rte_graph *g, bool all)
 	fprintf(f, "  cir_mask=0x%" PRIx32 "\n", g->cir_mask);
 	fprintf(f, "  nb_nodes=%" PRId32 "\n", g->nb_nodes);
 	fprintf(f, "  socket=%d\n", g->socket);
+	fprintf(f, "  lcore_id=%u\n", g->lcore_id);
 	fprintf(f, "  fence=0x%" PRIx64 "\n", g->fence);
 	fprintf(f, "  nodes_start=0x%" PRIx32 "\n", g->nodes_start);
 	fprintf(f, "  cir_start=%p\n", g->cir_start);
@@ -77,6 +80,11 @@ rte_graph_obj_dump(FILE *f, struct rte_graph *g, bool all)
 		fprintf(f, "       idx=%d\n", n->idx);
 		fprintf(f, "       total_objs=%" PRId64 "\n", n->total_objs);
 		fprintf(f, "       total_calls=%" PRId64 "\n", n->total_calls);
+		fprintf(f, "       lcore_id=%u\n", n->lcore_id);
+		fprintf(f, "       total_sched_objs=%" PRId64 "\n",
+			n->total_sched_objs);
+		fprintf(f, "       total_sched_fail=%" PRId64 "\n",
+			n->total_sched_fail);
 		for (i = 0; i < n->nb_edges; i++)
 			fprintf(f, "          edge[%d] <%s>\n", i,
 				n->nodes[i]->name);
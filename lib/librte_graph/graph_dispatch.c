@@ -0,0 +1,295 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_memcpy.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+#include "graph_private.h"
+
+/* Max number of work queue entries processed per graph walk */
+#define GRAPH_WQ_DEQ_MAX 32
+
+/* Work queue entry holding a stream handed off to another lcore */
+struct graph_wq_node {
+	rte_graph_off_t node_off; /* Offset of the node in the graph reel */
+	uint16_t nb_objs;
+	void *objs[RTE_GRAPH_BURST_SIZE];
+} __rte_cache_aligned;
+
+#define GRAPH_GROUP(g)                                                         \
+	((g)->parent_id == RTE_GRAPH_ID_INVALID ? (g)->id : (g)->parent_id)
+
+int
+graph_dispatch_wq_create(struct graph *graph)
+{
+	struct rte_graph *g = graph->graph;
+	char name[RTE_RING_NAMESIZE];
+	struct rte_mempool *mp;
+	struct rte_ring *wq;
+	uint32_t cache_sz;
+
+	if (g->wq != NULL)
+		return 0;
+
+	snprintf(name, sizeof(name), "gwq_%p", (void *)graph);
+	wq = rte_ring_create(name, graph->wq_size, graph->socket,
+			     RING_F_SC_DEQ | RING_F_EXACT_SZ);
+	if (wq == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to create work queue %s",
+			    name);
+
+	/* The entries not in the work queue sit in the sender lcore caches */
+	cache_sz = RTE_MIN(graph->wq_size / 8,
+			   (uint32_t)RTE_MEMPOOL_CACHE_MAX_SIZE);
+	snprintf(name, sizeof(name), "gmp_%p", (void *)graph);
+	mp = rte_mempool_create(name, graph->wq_size * 2,
+				sizeof(struct graph_wq_node), cache_sz, 0, NULL,
+				NULL, NULL, NULL, graph->socket, 0);
+	if (mp == NULL)
+		SET_ERR_JMP(ENOMEM, free_wq, "Failed to create mempool %s",
+			    name);
+
+	g->wq = wq;
+	g->wq_mp = mp;
+	return 0;
+
+free_wq:
+	rte_ring_free(wq);
+fail:
+	return -rte_errno;
+}
+
+static void
+graph_dispatch_wq_process(struct rte_graph *graph)
+{
+	struct graph_wq_node *wq_nodes[GRAPH_WQ_DEQ_MAX];
+	struct graph_wq_node *wq_node;
+	struct rte_node *node;
+	unsigned int i, n;
+	uint16_t idx;
+
+	n = rte_ring_sc_dequeue_burst(graph->wq, (void **)wq_nodes,
+				      GRAPH_WQ_DEQ_MAX, NULL);
+	if (n == 0)
+		return;
+
+	for (i = 0; i < n; i++) {
+		wq_node = wq_nodes[i];
+		node = RTE_PTR_ADD(graph, wq_node->node_off);
+		RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
+		idx = node->idx;
+
+		__rte_node_enqueue_prologue(graph, node, idx, wq_node->nb_objs);
+
+		rte_memcpy(&node->objs[idx], wq_node->objs,
+			   wq_node->nb_objs * sizeof(void *));
+		node->idx = idx + wq_node->nb_objs;
+	}
+
+	rte_mempool_put_bulk(graph->wq_mp, (void **)wq_nodes, n);
+}
+
+void
+graph_dispatch_wq_destroy(struct graph *graph)
+{
+	struct rte_graph *g = graph->graph;
+
+	if (g->wq == NULL)
+		return;
+
+	/* Stop the other graphs handing off streams to this one */
+	g->lcore_id = RTE_MAX_LCORE;
+	graph_dispatch_update(graph);
+
+	/* Move the streams still queued to the pending streams of the graph */
+	while (!rte_ring_empty(g->wq))
+		graph_dispatch_wq_process(g);
+
+	rte_ring_free(g->wq);
+	rte_mempool_free(g->wq_mp);
+	g->wq = NULL;
+	g->wq_mp = NULL;
+}
+
+static struct rte_graph *
+graph_dispatch_lookup(struct graph *graph, unsigned int lcore)
+{
+	struct graph_head *graph_head = graph_list_head_get();
+	struct graph *tmp;
+
+	STAILQ_FOREACH(tmp, graph_head, next)
+		if (GRAPH_GROUP(tmp) == GRAPH_GROUP(graph) &&
+		    tmp->graph->lcore_id == lcore)
+			return tmp->graph;
+
+	return NULL;
+}
+
+static void
+graph_dispatch_nodes_update(struct graph *graph)
+{
+	unsigned int lcore = graph->graph->lcore_id;
+	struct graph_node *graph_node;
+	struct rte_node *node;
+
+	STAILQ_FOREACH(graph_node, &graph->node_list, next) {
+		node = graph_node_id_to_ptr(graph->graph,
+					    graph_node->node->id);
+		node->lcore_id = graph_node->node->lcore_id;
+		node->dispatch_graph = NULL;
+
+		if (lcore == RTE_MAX_LCORE || node->lcore_id == RTE_MAX_LCORE ||
+		    node->lcore_id == lcore)
+			continue;
+
+		/* Nodes owned by an lcore without graph are run locally */
+		node->dispatch_graph = graph_dispatch_lookup(graph,
+							     node->lcore_id);
+	}
+}
+
+void
+graph_dispatch_update(struct graph *graph)
+{
+	struct graph_head *graph_head = graph_list_head_get();
+	struct graph *tmp;
+
+	STAILQ_FOREACH(tmp, graph_head, next)
+		if (GRAPH_GROUP(tmp) == GRAPH_GROUP(graph))
+			graph_dispatch_nodes_update(tmp);
+}
+
+int
+rte_graph_bind_lcore(rte_graph_t id, unsigned int lcore)
+{
+	struct graph_head *graph_head = graph_list_head_get();
+	struct graph *graph;
+	int rc = -ENOENT;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	graph_spinlock_lock();
+
+	STAILQ_FOREACH(graph, graph_head, next)
+		if (graph->id == id)
+			break;
+	if (graph == NULL)
+		goto done;
+
+	/* Only one graph of the clone family can run on a given lcore */
+	if (graph->graph->lcore_id != lcore &&
+	    graph_dispatch_lookup(graph, lcore) != NULL)
+		SET_ERR_JMP(EEXIST, fail, "Lcore %u already has graph", lcore);
+
+	rc = graph_dispatch_wq_create(graph);
+	if (rc)
+		goto done;
+
+	graph->graph->lcore_id = lcore;
+	graph_dispatch_update(graph);
+	goto done;
+
+fail:
+	rc = -rte_errno;
+done:
+	graph_spinlock_unlock();
+	return rc;
+}
+
+void
+rte_graph_unbind_lcore(rte_graph_t id)
+{
+	struct graph_head *graph_head = graph_list_head_get();
+	struct graph *graph;
+
+	graph_spinlock_lock();
+
+	STAILQ_FOREACH(graph, graph_head, next)
+		if (graph->id == id) {
+			graph_dispatch_wq_destroy(graph);
+			break;
+		}
+
+	graph_spinlock_unlock();
+}
+
+static bool
+graph_dispatch_node_enqueue(struct rte_node *node)
+{
+	struct rte_graph *graph = node->dispatch_graph;
+	struct graph_wq_node *wq_node;
+	uint16_t off = 0, size;
+
+	while (off < node->idx) {
+		if (unlikely(rte_mempool_get(graph->wq_mp, (void **)&wq_node)))
+			goto fail;
+
+		size = RTE_MIN(node->idx - off, RTE_GRAPH_BURST_SIZE);
+		wq_node->node_off = node->off;
+		wq_node->nb_objs = size;
+		rte_memcpy(wq_node->objs, &node->objs[off],
+			   size * sizeof(void *));
+
+		if (unlikely(rte_ring_mp_enqueue(graph->wq, wq_node))) {
+			rte_mempool_put(graph->wq_mp, wq_node);
+			goto fail;
+		}
+		off += size;
+	}
+
+	if (rte_graph_has_stats_feature())
+		node->total_sched_objs += off;
+	node->idx = 0;
+	return true;
+
+fail:
+	/* Keep the objs not handed off for the local processing */
+	if (rte_graph_has_stats_feature()) {
+		node->total_sched_objs += off;
+		node->total_sched_fail += node->idx - off;
+	}
+	if (off) {
+		memmove(node->objs, &node->objs[off],
+			(node->idx - off) * sizeof(void *));
+		node->idx -= off;
+	}
+	return false;
+}
+
+void
+__rte_graph_dispatch_walk(struct rte_graph *graph)
+{
+	const rte_graph_off_t *cir_start = graph->cir_start;
+	const rte_node_t mask = graph->cir_mask;
+	uint32_t head = graph->head;
+	struct rte_node *node;
+	bool src;
+
+	/* Streams handed off by the other lcores are pending first */
+	graph_dispatch_wq_process(graph);
+
+	while (likely(head != graph->tail)) {
+		src = (int32_t)head < 0;
+		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
+
+		/* Source nodes owned by another lcore are run by its graph */
+		if (unlikely(node->dispatch_graph != NULL) &&
+		    (src || graph_dispatch_node_enqueue(node)))
+			goto next;
+
+		__rte_node_process(graph, node);
+next:
+		head = likely((int32_t)head > 0) ? head & mask : head;
+	}
+	graph->tail = 0;
+}
@@ -54,6 +54,7 @@ struct node {
 	rte_node_fini_t fini;	      /**< Node fini function. */
 	rte_node_t id;		      /**< Allocated identifier for the node. */
 	rte_node_t parent_id;	      /**< Parent node identifier. */
+	unsigned int lcore_id;	      /**< Lcore affinity of the node. */
 	rte_edge_t nb_edges;	      /**< Number of edges from this node. */
 	char next_nodes[][RTE_NODE_NAMESIZE]; /**< Names of next nodes. */
 };
@@ -96,6 +97,10 @@ struct graph {
 	/**< Circular buffer mask for wrap around. */
 	rte_graph_t id;
 	/**< Graph identifier. */
+	rte_graph_t parent_id;
+	/**< Parent graph identifier. */
+	uint32_t wq_size;
+	/**< Size of the work queue created when bound to an lcore. */
 	size_t mem_sz;
 	/**< Memory size of the graph. */
 	int socket;
@@ -286,6 +291,44 @@ int graph_fp_mem_create(struct graph *graph);
  */
 int graph_fp_mem_destroy(struct graph *graph);
 
+/* Dispatch functions */
+/**
+ * @internal
+ *
+ * Create the work queue receiving the streams handed off by the other graphs
+ * of the clone family.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -ENOMEM: Not enough memory for the work queue.
+ */
+int graph_dispatch_wq_create(struct graph *graph);
+
+/**
+ * @internal
+ *
+ * Free the work queue of the graph, after the streams still queued are moved
+ * to the pending streams of the graph.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ */
+void graph_dispatch_wq_destroy(struct graph *graph);
+
+/**
+ * @internal
+ *
+ * Recompute the node to graph hand off of all the graphs in the clone family
+ * of the given graph.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ */
+void graph_dispatch_update(struct graph *graph);
+
 /* Lookup functions */
 /**
  * @internal
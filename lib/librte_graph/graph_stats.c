@@ -42,14 +42,15 @@ struct rte_graph_cluster_stats {
 #define boarder()                                                              \
 	fprintf(f, "+-------------------------------+---------------+--------" \
 		   "-------+---------------+---------------+---------------+-" \
-		   "----------+\n")
+		   "--------------+---------------+-----------+\n")
 
 static inline void
 print_banner(FILE *f)
 {
 	boarder();
-	fprintf(f, "%-32s%-16s%-16s%-16s%-16s%-16s%-16s\n", "|Node", "|calls",
-		"|objs", "|realloc_count", "|objs/call", "|objs/sec(10E6)",
+	fprintf(f, "%-32s%-16s%-16s%-16s%-16s%-16s%-16s%-16s%-16s\n",
+		"|Node", "|calls", "|objs", "|realloc_count", "|objs/call",
+		"|objs/sec(10E6)", "|sched_objs", "|sched_fail",
 		"|cycles/call|");
 	boarder();
 }
@@ -77,9 +78,10 @@ print_node(FILE *f, const struct rte_graph_cluster_node_stats *stat)
 
 	fprintf(f,
 		"|%-31s|%-15" PRIu64 "|%-15" PRIu64 "|%-15" PRIu64
-		"|%-15.3f|%-15.6f|%-11.4f|\n",
+		"|%-15.3f|%-15.6f|%-15" PRIu64 "|%-15" PRIu64 "|%-11.4f|\n",
 		stat->name, calls, objs, stat->realloc_count, objs_per_call,
-		objs_per_sec, cycles_per_call);
+		objs_per_sec, stat->sched_objs, stat->sched_fail,
+		cycles_per_call);
 }
 
 static int
@@ -329,6 +331,7 @@ static inline void
 cluster_node_arregate_stats(struct cluster_node *cluster)
 {
 	uint64_t calls = 0, cycles = 0, objs = 0, realloc_count = 0;
+	uint64_t sched_objs = 0, sched_fail = 0;
 	struct rte_graph_cluster_node_stats *stat = &cluster->stat;
 	struct rte_node *node;
 	rte_node_t count;
@@ -340,6 +343,8 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 		objs += node->total_objs;
 		cycles += node->total_cycles;
 		realloc_count += node->realloc_count;
+		sched_objs += node->total_sched_objs;
+		sched_fail += node->total_sched_fail;
 	}
 
 	stat->calls = calls;
@@ -347,6 +352,8 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 	stat->cycles = cycles;
 	stat->ts = rte_get_timer_cycles();
 	stat->realloc_count = realloc_count;
+	stat->sched_objs = sched_objs;
+	stat->sched_fail = sched_fail;
 }
 
 static inline void
@@ -401,6 +408,8 @@ rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat)
 		node->prev_objs = 0;
 		node->prev_cycles = 0;
 		node->realloc_count = 0;
+		node->sched_objs = 0;
+		node->sched_fail = 0;
 		cluster = RTE_PTR_ADD(cluster, stat->cluster_node_size);
 	}
 }
@@ -21,6 +21,11 @@
  * edge update, and edge shrink, etc. The API also allows to create the stats
  * cluster to monitor per graph and per node stats.
  *
+ * A graph can be cloned and the graph and its clones bound to lcores, in
+ * which case the nodes that have an lcore affinity are only run by the graph
+ * bound to that lcore, and the streams enqueued to such nodes by the other
+ * graphs are handed off to it through a lock-free work queue.
+ *
  */
 
 #include <stdbool.h>
@@ -40,6 +45,7 @@ extern "C" {
 #define RTE_EDGE_ID_INVALID UINT16_MAX   /**< Invalid edge id. */
 #define RTE_GRAPH_ID_INVALID UINT16_MAX  /**< Invalid graph id. */
 #define RTE_GRAPH_FENCE 0xdeadbeef12345678ULL /**< Graph fence data. */
+#define RTE_GRAPH_WQ_SIZE_DEFAULT 512 /**< Default graph work queue size. */
 
 typedef uint32_t rte_graph_off_t;  /**< Graph offset type. */
 typedef uint32_t rte_node_t;       /**< Node id type. */
@@ -164,6 +170,10 @@ struct rte_graph_param {
 	uint16_t nb_node_patterns;  /**< Number of node patterns. */
 	const char **node_patterns;
 	/**< Array of node patterns based on shell pattern. */
+	uint32_t wq_size;
+	/**< Number of cross-core streams the graph work queue can hold once
+	 *   the graph is bound to an lcore, 0 for RTE_GRAPH_WQ_SIZE_DEFAULT.
+	 */
 };
 
 /**
@@ -206,6 +216,9 @@ struct rte_graph_cluster_node_stats {
 
 	uint64_t realloc_count; /**< Realloc count. */
 
+	uint64_t sched_objs; /**< Objs handed off to the node lcore. */
+	uint64_t sched_fail; /**< Objs processed locally on hand off failure. */
+
 	rte_node_t id;	/**< Node identifier of stats. */
 	uint64_t hz;	/**< Cycles per seconds. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
@@ -228,6 +241,69 @@ struct rte_graph_cluster_node_stats {
 __rte_experimental
 rte_graph_t rte_graph_create(const char *name, struct rte_graph_param *prm);
 
+/**
+ * Clone Graph.
+ *
+ * Create a new graph with the same nodes as the given graph. The graph and
+ * its clones share the node lcore affinities once bound to lcores, see
+ * rte_graph_bind_lcore().
+ *
+ * @param id
+ *   Graph id of the graph to clone from, which must not be a clone itself.
+ * @param name
+ *   Name of the new graph. The library prepends the parent graph name to the
+ * user-specified name. The final graph name will be,
+ * "parent graph name" + "-" + name.
+ * @param prm
+ *   Graph parameter, only the socket id and the work queue size are used.
+ *
+ * @return
+ *   Valid graph id on success, RTE_GRAPH_ID_INVALID otherwise.
+ */
+__rte_experimental
+rte_graph_t rte_graph_clone(rte_graph_t id, const char *name,
+			    struct rte_graph_param *prm);
+
+/**
+ * Bind graph to lcore.
+ *
+ * Once a graph is bound to an lcore, the nodes having an affinity to a
+ * different lcore are not run by this graph: their streams are handed off to
+ * the graph of the same clone family that is bound to the node lcore, and
+ * the source nodes are skipped. The graph has to be walked by that lcore.
+ *
+ * The function is not thread safe with respect to rte_graph_walk() on any
+ * graph of the clone family.
+ *
+ * @param id
+ *   Graph id to bind.
+ * @param lcore
+ *   The lcore the graph is walked by.
+ *
+ * @return
+ *   0 on success, error otherwise.
+ *
+ * @see rte_node_lcore_affinity_set(), rte_graph_clone()
+ */
+__rte_experimental
+int rte_graph_bind_lcore(rte_graph_t id, unsigned int lcore);
+
+/**
+ * Unbind graph from lcore.
+ *
+ * The graph runs all its nodes again and no longer receives streams from
+ * the other graphs of its clone family. The streams already handed off to
+ * the graph are moved to its pending streams and its work queue is freed.
+ *
+ * The function is not thread safe with respect to rte_graph_walk() on any
+ * graph of the clone family.
+ *
+ * @param id
+ *   Graph id to unbind.
+ */
+__rte_experimental
+void rte_graph_unbind_lcore(rte_graph_t id);
+
 /**
  * Destroy Graph.
  *
@@ -485,6 +561,25 @@ rte_node_t __rte_node_register(const struct rte_node_register *node);
 __rte_experimental
 rte_node_t rte_node_clone(rte_node_t id, const char *name);
 
+/**
+ * Set the lcore affinity of a node.
+ *
+ * The affinity is applied when graphs are bound to lcores, so it has to be
+ * set before calling rte_graph_bind_lcore().
+ *
+ * @param id
+ *   Valid node id.
+ * @param lcore
+ *   The lcore running the node, RTE_MAX_LCORE to clear the affinity.
+ *
+ * @return
+ *   0 on success, error otherwise.
+ *
+ * @see rte_graph_bind_lcore()
+ */
+__rte_experimental
+int rte_node_lcore_affinity_set(rte_node_t id, unsigned int lcore);
+
 /**
  * Get node id from node name.
  *
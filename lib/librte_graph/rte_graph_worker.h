@@ -42,6 +42,9 @@ struct rte_graph {
 	rte_graph_off_t nodes_start; /**< Offset at which node memory starts. */
 	rte_graph_t id;	/**< Graph identifier. */
 	int socket;	/**< Socket ID where memory is allocated. */
+	unsigned int lcore_id;	/**< Lcore the graph is bound to. */
+	struct rte_ring *wq;	/**< Work queue of streams from other lcores. */
+	struct rte_mempool *wq_mp; /**< Pool of the work queue entries. */
 	char name[RTE_GRAPH_NAMESIZE];	/**< Name of the graph. */
 	uint64_t fence;			/**< Fence. */
 } __rte_cache_aligned;
@@ -63,6 +66,12 @@ struct rte_node {
 	char parent[RTE_NODE_NAMESIZE];	/**< Parent node name. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
 
+	unsigned int lcore_id;	/**< Lcore affinity of the node. */
+	struct rte_graph *dispatch_graph;
+	/**< Graph running the node when owned by another lcore, else NULL. */
+	uint64_t total_sched_objs; /**< Objs handed off to dispatch_graph. */
+	uint64_t total_sched_fail; /**< Objs failed to be handed off. */
+
 	/* Fast path area  */
 #define RTE_NODE_CTX_SZ 16
 	uint8_t ctx[RTE_NODE_CTX_SZ] __rte_cache_aligned; /**< Node Context. */
@@ -118,6 +127,52 @@ __rte_experimental
 void __rte_node_stream_alloc_size(struct rte_graph *graph,
 				  struct rte_node *node, uint16_t req_size);
 
+/**
+ * @internal
+ *
+ * Perform graph walk of a graph bound to an lcore, handing off the streams
+ * of the nodes owned by other lcores to their graphs.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ */
+__rte_experimental
+void __rte_graph_dispatch_walk(struct rte_graph *graph);
+
+/**
+ * @internal
+ *
+ * Invoke the process function of a node on its pending stream and collect
+ * the stats.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ * @param node
+ *   Pointer to the node object.
+ */
+static __rte_always_inline void
+__rte_node_process(struct rte_graph *graph, struct rte_node *node)
+{
+	uint64_t start;
+	uint16_t rc;
+	void **objs;
+
+	RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
+	objs = node->objs;
+	rte_prefetch0(objs);
+
+	if (rte_graph_has_stats_feature()) {
+		start = rte_rdtsc();
+		rc = node->process(graph, node, objs, node->idx);
+		node->total_cycles += rte_rdtsc() - start;
+		node->total_calls++;
+		node->total_objs += rc;
+	} else {
+		node->process(graph, node, objs, node->idx);
+	}
+	node->idx = 0;
+}
+
 /**
  * Perform graph walk on the circular buffer and invoke the process function
  * of the nodes and collect the stats.
@@ -135,9 +190,12 @@ rte_graph_walk(struct rte_graph *graph)
 	const rte_node_t mask = graph->cir_mask;
 	uint32_t head = graph->head;
 	struct rte_node *node;
-	uint64_t start;
-	uint16_t rc;
-	void **objs;
+
+	/* Graph bound to an lcore, see rte_graph_bind_lcore() */
+	if (unlikely(graph->wq != NULL)) {
+		__rte_graph_dispatch_walk(graph);
+		return;
+	}
 
 	/*
 	 * Walk on the source node(s) ((cir_start - head) -> cir_start) and then
@@ -156,20 +214,7 @@ rte_graph_walk(struct rte_graph *graph)
 	 */
 	while (likely(head != graph->tail)) {
 		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
-		RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
-		objs = node->objs;
-		rte_prefetch0(objs);
-
-		if (rte_graph_has_stats_feature()) {
-			start = rte_rdtsc();
-			rc = node->process(graph, node, objs, node->idx);
-			node->total_cycles += rte_rdtsc() - start;
-			node->total_calls++;
-			node->total_objs += rc;
-		} else {
-			node->process(graph, node, objs, node->idx);
-		}
-		node->idx = 0;
+		__rte_node_process(graph, node);
 		head = likely((int32_t)head > 0) ? head & mask : head;
 	}
 	graph->tail = 0;
@@ -223,8 +268,9 @@ __rte_node_enqueue_prologue(struct rte_graph *graph, struct rte_node *node,
 	if (idx == 0)
 		__rte_node_enqueue_tail_update(graph, node);
 
+	/* Doubling the stream may not be enough for a large enqueue */
 	if (unlikely(node->size < (idx + space)))
-		__rte_node_stream_alloc(graph, node);
+		__rte_node_stream_alloc_size(graph, node, node->size + space);
 }
 
 /**
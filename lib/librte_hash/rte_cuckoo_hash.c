@@ -31,6 +31,9 @@
 
 #include "rte_hash.h"
 #include "rte_cuckoo_hash.h"
+#if defined(CC_HASH_AVX2_SUPPORT) || defined(CC_HASH_AVX512_SUPPORT)
+#include "rte_cuckoo_hash_x86.h"
+#endif
 
 /* Mask of all flags supported by this version */
 #define RTE_HASH_EXTRA_FLAGS_MASK (RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT | \
@@ -38,7 +41,8 @@
 				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY | \
 				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE |	\
 				   RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL | \
-				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF | \
+				   RTE_HASH_EXTRA_FLAGS_RESIZABLE)
 
 #define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
 	for (CURRENT_BKT = START_BUCKET;                                      \
@@ -134,6 +138,74 @@ get_alt_bucket_index(const struct rte_hash *h,
 	return (cur_bkt_idx ^ sig) & h->bucket_bitmask;
 }
 
+/*
+ * Get the key store entry of a key index. Tables which are not resizable
+ * only have the first segment.
+ */
+static inline struct rte_hash_key *
+get_key_slot(const struct rte_hash *h, uint32_t key_idx)
+{
+	uint32_t seg = key_idx >> h->key_seg_shift;
+
+	if (likely(seg == 0))
+		return RTE_PTR_ADD(h->key_store,
+				(uintptr_t)key_idx * h->key_entry_size);
+
+	seg = rte_fls_u32(seg);
+	key_idx -= 1U << (h->key_seg_shift + seg - 1);
+	return RTE_PTR_ADD(h->key_segs[seg],
+			(uintptr_t)key_idx * h->key_entry_size);
+}
+
+/*
+ * Hash value the key was added with, stored in the key store entries of
+ * resizable tables. It can be given by the application, so the resize
+ * cannot recompute it from the key.
+ */
+static inline hash_sig_t
+key_sig_get(const struct rte_hash *h, const struct rte_hash_key *k)
+{
+	hash_sig_t sig;
+
+	memcpy(&sig, k->key + h->key_len, sizeof(sig));
+	return sig;
+}
+
+static inline void
+key_sig_set(const struct rte_hash *h, struct rte_hash_key *k, hash_sig_t sig)
+{
+	memcpy(k->key + h->key_len, &sig, sizeof(sig));
+}
+
+/* First key index of a key store segment */
+static inline uint32_t
+key_seg_first(const struct rte_hash *h, uint32_t seg)
+{
+	return seg == 0 ? 0 : 1U << (h->key_seg_shift + seg - 1);
+}
+
+/* End of the key indexes, i.e. one past the last allocated index */
+static inline uint32_t
+key_slots_end(const struct rte_hash *h)
+{
+	uint32_t seg = h->num_key_segs - 1;
+
+	return key_seg_first(h, seg) + h->key_seg_slots[seg];
+}
+
+/* Check that a key index belongs to an allocated key store entry */
+static inline int
+key_idx_valid(const struct rte_hash *h, uint32_t key_idx)
+{
+	uint32_t seg = key_idx >> h->key_seg_shift;
+
+	if (seg != 0)
+		seg = rte_fls_u32(seg);
+	if (seg >= h->num_key_segs)
+		return 0;
+	return key_idx - key_seg_first(h, seg) < h->key_seg_slots[seg];
+}
+
 struct rte_hash *
 rte_hash_create(const struct rte_hash_parameters *params)
 {
@@ -158,6 +230,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	uint32_t *tbl_chng_cnt = NULL;
 	struct lcore_cache *local_free_slots = NULL;
 	unsigned int readwrite_concur_lf_support = 0;
+	unsigned int resizable = 0;
 	uint32_t i;
 
 	rte_hash_function default_hash_func = (rte_hash_function)rte_jhash;
@@ -193,6 +266,15 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		return NULL;
 	}
 
+	if ((params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) &&
+	    (params->extra_flag & (RTE_HASH_EXTRA_FLAGS_EXT_TABLE |
+				   RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD))) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create: resizable table cannot "
+			"use ext table or multi writer add\n");
+		return NULL;
+	}
+
 	/* Check extra flags field to check extra options. */
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
@@ -222,6 +304,9 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		no_free_on_del = 1;
 	}
 
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE)
+		resizable = 1;
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (use_local_cache)
 		/*
@@ -331,8 +416,10 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		}
 	}
 
+	/* Resizable tables keep the hash value of each key after the key */
 	const uint32_t key_entry_size =
-		RTE_ALIGN(sizeof(struct rte_hash_key) + params->key_len,
+		RTE_ALIGN(sizeof(struct rte_hash_key) + params->key_len +
+			  (resizable ? sizeof(hash_sig_t) : 0),
 			  KEY_ALIGNMENT);
 	const uint64_t key_tbl_size = (uint64_t) key_entry_size * num_key_slots;
 
@@ -435,8 +522,36 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->writer_takes_lock = writer_takes_lock;
 	h->no_free_on_del = no_free_on_del;
 	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->resizable = resizable;
+	h->socket_id = params->socket_id;
+	/* Key indexes of the segments added by resizes start at a power of 2 */
+	h->key_seg_shift = resizable ? rte_log2_u32(num_key_slots) : 31;
+	h->key_segs[0] = k;
+	h->key_seg_slots[0] = num_key_slots;
+	h->num_key_segs = 1;
+
+#if defined(CC_HASH_AVX2_SUPPORT) || defined(CC_HASH_AVX512_SUPPORT)
+	/* Vector paths compute the bucket addresses and load the signatures */
+	RTE_BUILD_BUG_ON(sizeof(struct rte_hash_bucket) !=
+			(1 << RTE_HASH_BUCKET_SHIFT));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_hash_bucket, sig_current) != 0);
+	RTE_BUILD_BUG_ON(RTE_HASH_LOOKUP_BULK_MAX % RTE_HASH_VEC_BATCH != 0);
+#endif
 
 #if defined(RTE_ARCH_X86)
+#ifdef CC_HASH_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0 &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512)
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX512;
+	else
+#endif
+#ifdef CC_HASH_AVX2_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0 &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX2;
+	else
+#endif
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
 		h->sig_cmp_fn = RTE_HASH_COMPARE_SSE;
 	else
@@ -485,11 +600,25 @@ err:
 	return NULL;
 }
 
+/*
+ * Free the ring of free key slots. Resizable tables replace the ring
+ * created with the table by larger rings which are not in the ring list.
+ */
+static void
+free_slots_ring_free(struct rte_ring *r)
+{
+	if (r == NULL || r->memzone != NULL)
+		rte_ring_free(r);
+	else
+		rte_free(r);
+}
+
 void
 rte_hash_free(struct rte_hash *h)
 {
 	struct rte_tailq_entry *te;
 	struct rte_hash_list *hash_list;
+	uint32_t i;
 
 	if (h == NULL)
 		return;
@@ -520,9 +649,16 @@ rte_hash_free(struct rte_hash *h)
 		rte_free(h->local_free_slots);
 	if (h->writer_takes_lock)
 		rte_free(h->readwrite_lock);
-	rte_ring_free(h->free_slots);
+	free_slots_ring_free(h->free_slots);
 	rte_ring_free(h->free_ext_bkts);
-	rte_free(h->key_store);
+	for (i = 0; i < h->num_key_segs; i++)
+		rte_free(h->key_segs[i]);
+	for (i = 0; i < h->num_retired; i++)
+		rte_free(h->retired[i]);
+	if (h->resize != NULL) {
+		rte_free(h->resize->buckets_new);
+		rte_free(h->resize);
+	}
 	rte_free(h->buckets);
 	rte_free(h->buckets_ext);
 	rte_free(h->tbl_chng_cnt);
@@ -549,6 +685,9 @@ rte_hash_max_key_id(const struct rte_hash *h)
 		 */
 		return (h->entries + ((RTE_MAX_LCORE - 1) *
 					(LCORE_CACHE_SIZE - 1)));
+	else if (h->resizable)
+		/* Key indexes of the segments are not contiguous */
+		return key_slots_end(h) - 1;
 	else
 		return h->entries;
 }
@@ -614,10 +753,306 @@ __hash_rw_reader_unlock(const struct rte_hash *h)
 		rte_rwlock_read_unlock(h->readwrite_lock);
 }
 
+/* Check if an old bucket was migrated by the resize in progress */
+static inline int
+resize_bkt_migrated(const struct rte_hash_resize *r, uint32_t bkt_idx)
+{
+	return (__atomic_load_n(&r->migrated[bkt_idx / 64], __ATOMIC_ACQUIRE) >>
+			(bkt_idx % 64)) & 1;
+}
+
+/*
+ * Copy the entries of an old bucket to the two buckets it is split into.
+ * Entries keep their primary or secondary role: only the new most
+ * significant bit of their bucket index changes, hence both new buckets
+ * have room at the same position.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static void
+resize_bkt_migrate(const struct rte_hash *h, struct rte_hash_resize *r,
+		uint32_t bkt_idx)
+{
+	const uint32_t new_bitmask = (r->bucket_bitmask << 1) | 1;
+	const struct rte_hash_bucket *old_bkt = &r->buckets[bkt_idx];
+	struct rte_hash_bucket *new_bkt;
+	struct rte_hash_key *k;
+	uint32_t key_idx, new_idx;
+	hash_sig_t sig;
+	unsigned int i;
+
+	if (resize_bkt_migrated(r, bkt_idx))
+		return;
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		key_idx = old_bkt->key_idx[i];
+		if (key_idx == EMPTY_SLOT)
+			continue;
+
+		k = get_key_slot(h, key_idx);
+		sig = key_sig_get(h, k);
+		new_idx = sig & new_bitmask;
+		if ((sig & r->bucket_bitmask) != bkt_idx)
+			new_idx = (new_idx ^ get_short_sig(sig)) & new_bitmask;
+
+		new_bkt = &r->buckets_new[new_idx];
+		new_bkt->sig_current[i] = old_bkt->sig_current[i];
+		new_bkt->key_idx[i] = key_idx;
+	}
+
+	/* Release the new buckets to the readers */
+	__atomic_store_n(&r->migrated[bkt_idx / 64],
+			 r->migrated[bkt_idx / 64] | (1ULL << (bkt_idx % 64)),
+			 __ATOMIC_RELEASE);
+}
+
+/*
+ * Free a bucket array or resize state replaced by a resize, once the
+ * readers cannot access it anymore.
+ */
+static void
+resize_retire(struct rte_hash *h, void *p)
+{
+	if (!h->readwrite_concur_lf_support) {
+		rte_free(p);
+		return;
+	}
+
+	/* Without RCU, lock free readers may hold it until the table is freed */
+	if (h->hash_rcu_cfg == NULL) {
+		h->retired[h->num_retired++] = p;
+		return;
+	}
+
+	rte_rcu_qsbr_synchronize(h->hash_rcu_cfg->v, RTE_QSBR_THRID_INVALID);
+	rte_free(p);
+}
+
+/*
+ * Migrate the remaining old buckets and switch to the new bucket array.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static void
+resize_finish(const struct rte_hash *h)
+{
+	struct rte_hash *hw = (struct rte_hash *)((uintptr_t)h);
+	struct rte_hash_resize *r = h->resize;
+
+	for (; r->next_bkt <= r->bucket_bitmask; r->next_bkt++)
+		resize_bkt_migrate(h, r, r->next_bkt);
+
+	if (h->readwrite_concur_lf_support) {
+		/* Inform the readers which did not see the resize state that
+		 * the bucket array changed. Since there is one writer, load
+		 * acquire on tbl_chng_cnt is not required.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		/* The store to buckets should not move above the store
+		 * to tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	/* The bucket array is published before its bitmask, so that readers
+	 * loading the new bitmask see the new bucket array.
+	 */
+	__atomic_store_n(&hw->buckets, r->buckets_new, __ATOMIC_RELEASE);
+	__atomic_store_n(&hw->bucket_bitmask, (r->bucket_bitmask << 1) | 1,
+			 __ATOMIC_RELEASE);
+	hw->num_buckets <<= 1;
+	__atomic_store_n(&hw->resize, NULL, __ATOMIC_RELEASE);
+
+	resize_retire(hw, r->buckets);
+	resize_retire(hw, r);
+}
+
+/*
+ * Move the resize in progress forward by a few old buckets.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static void
+resize_step(const struct rte_hash *h)
+{
+	struct rte_hash_resize *r = h->resize;
+	unsigned int i;
+
+	for (i = 0; i < RTE_HASH_RESIZE_STEP &&
+			r->next_bkt <= r->bucket_bitmask; i++, r->next_bkt++)
+		resize_bkt_migrate(h, r, r->next_bkt);
+
+	if (r->next_bkt > r->bucket_bitmask)
+		resize_finish(h);
+}
+
+/*
+ * Start doubling the table: add a key store segment with as many key slots
+ * as the current bucket array, move the free slots to a ring large enough
+ * for all the key slots and allocate the new bucket array. The buckets are
+ * migrated by the following add and delete calls.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static int
+resize_start(const struct rte_hash *h)
+{
+	struct rte_hash *hw = (struct rte_hash *)((uintptr_t)h);
+	const uint32_t seg = h->num_key_segs;
+	const uint32_t num_slots = h->num_buckets * RTE_HASH_BUCKET_ENTRIES;
+	struct rte_hash_resize *r = NULL;
+	struct rte_ring *ring = NULL;
+	uint32_t slots[LCORE_CACHE_SIZE];
+	uint32_t ring_size, first, i, n;
+	void *k = NULL;
+
+	if (seg == RTE_HASH_KEY_SEGS_MAX ||
+			(uint64_t)num_slots * 2 > RTE_HASH_ENTRIES_MAX)
+		return -ENOSPC;
+
+	r = rte_zmalloc_socket(NULL, sizeof(*r) + sizeof(uint64_t) *
+				RTE_ALIGN_CEIL(h->num_buckets, 64) / 64,
+				RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (r == NULL)
+		goto err;
+
+	r->buckets_new = rte_zmalloc_socket(NULL, 2 * h->num_buckets *
+				sizeof(struct rte_hash_bucket),
+				RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (r->buckets_new == NULL)
+		goto err;
+
+	k = rte_zmalloc_socket(NULL, (size_t)num_slots * h->key_entry_size,
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (k == NULL)
+		goto err;
+
+	/* Dummy slot index is not counted in entries */
+	ring_size = rte_align32pow2(h->entries + num_slots + 1);
+	ring = rte_zmalloc_socket(NULL,
+			rte_ring_get_memsize_elem(sizeof(uint32_t), ring_size),
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (ring == NULL ||
+			rte_ring_init(ring, h->free_slots->name, ring_size, 0))
+		goto err;
+
+	/* Writer is the only user of the free slots ring */
+	while ((n = rte_ring_sc_dequeue_burst_elem(h->free_slots, slots,
+			sizeof(uint32_t), LCORE_CACHE_SIZE, NULL)) != 0)
+		rte_ring_sp_enqueue_bulk_elem(ring, slots, sizeof(uint32_t), n,
+					      NULL);
+
+	first = 1U << (h->key_seg_shift + seg - 1);
+	for (i = first; i < first + num_slots; i++)
+		rte_ring_sp_enqueue_elem(ring, &i, sizeof(uint32_t));
+
+	free_slots_ring_free(h->free_slots);
+	hw->free_slots = ring;
+	hw->key_segs[seg] = k;
+	hw->key_seg_slots[seg] = num_slots;
+	hw->num_key_segs++;
+	hw->entries += num_slots;
+
+	r->buckets = h->buckets;
+	r->bucket_bitmask = h->bucket_bitmask;
+	/* Release the resize state to the readers */
+	__atomic_store_n(&hw->resize, r, __ATOMIC_RELEASE);
+
+	return 0;
+err:
+	RTE_LOG(ERR, HASH, "%s: resize memory allocation failed\n", h->name);
+	rte_free(ring);
+	rte_free(k);
+	if (r != NULL)
+		rte_free(r->buckets_new);
+	rte_free(r);
+	return -ENOMEM;
+}
+
+/*
+ * Get the buckets a writer updates for a hash value. While the table is
+ * resized, the old buckets of the hash value are migrated first and the
+ * resize moves forward.
+ * Writer is expected to hold the lock while calling this function.
+ * Returns 1 if the buckets are in the new bucket array of the resize
+ * still in progress, 0 otherwise.
+ */
+static int
+resize_writer_bkts(const struct rte_hash *h, hash_sig_t sig,
+		struct rte_hash_bucket **prim_bkt,
+		struct rte_hash_bucket **sec_bkt)
+{
+	struct rte_hash_resize *r = h->resize;
+	const uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx, sec_bucket_idx, bitmask;
+
+	if (r != NULL) {
+		prim_bucket_idx = sig & r->bucket_bitmask;
+		resize_bkt_migrate(h, r, prim_bucket_idx);
+		resize_bkt_migrate(h, r, (prim_bucket_idx ^ short_sig) &
+					r->bucket_bitmask);
+		resize_step(h);
+		r = h->resize;
+	}
+
+	if (r == NULL) {
+		prim_bucket_idx = get_prim_bucket_index(h, sig);
+		sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+						      short_sig);
+		*prim_bkt = &h->buckets[prim_bucket_idx];
+		*sec_bkt = &h->buckets[sec_bucket_idx];
+		return 0;
+	}
+
+	bitmask = (r->bucket_bitmask << 1) | 1;
+	prim_bucket_idx = sig & bitmask;
+	sec_bucket_idx = (prim_bucket_idx ^ short_sig) & bitmask;
+	*prim_bkt = &r->buckets_new[prim_bucket_idx];
+	*sec_bkt = &r->buckets_new[sec_bucket_idx];
+	return 1;
+}
+
+/*
+ * Get the buckets a reader searches for a hash value in a resizable table.
+ * Old buckets are left untouched by the resize, so readers use them until
+ * they are migrated.
+ */
+static inline void
+resize_reader_bkts(const struct rte_hash *h, hash_sig_t sig,
+		const struct rte_hash_bucket **prim_bkt,
+		const struct rte_hash_bucket **sec_bkt)
+{
+	const struct rte_hash_resize *r;
+	const struct rte_hash_bucket *buckets;
+	const uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx, sec_bucket_idx, bitmask;
+
+	r = __atomic_load_n(&h->resize, __ATOMIC_ACQUIRE);
+	if (likely(r == NULL)) {
+		bitmask = __atomic_load_n(&h->bucket_bitmask,
+					  __ATOMIC_ACQUIRE);
+		buckets = __atomic_load_n(&h->buckets, __ATOMIC_RELAXED);
+		prim_bucket_idx = sig & bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) & bitmask;
+		*prim_bkt = &buckets[prim_bucket_idx];
+		*sec_bkt = &buckets[sec_bucket_idx];
+		return;
+	}
+
+	prim_bucket_idx = sig & r->bucket_bitmask;
+	sec_bucket_idx = (prim_bucket_idx ^ short_sig) & r->bucket_bitmask;
+	*prim_bkt = &r->buckets[prim_bucket_idx];
+	*sec_bkt = &r->buckets[sec_bucket_idx];
+
+	bitmask = (r->bucket_bitmask << 1) | 1;
+	if (resize_bkt_migrated(r, prim_bucket_idx))
+		*prim_bkt = &r->buckets_new[sig & bitmask];
+	if (resize_bkt_migrated(r, sec_bucket_idx))
+		*sec_bkt = &r->buckets_new[((sig & bitmask) ^ short_sig) &
+					   bitmask];
+}
+
 void
 rte_hash_reset(struct rte_hash *h)
 {
-	uint32_t tot_ring_cnt, i;
+	uint32_t tot_ring_cnt, i, seg;
 	unsigned int pending;
 
 	if (h == NULL)
@@ -632,8 +1067,14 @@ rte_hash_reset(struct rte_hash *h)
 			RTE_LOG(ERR, HASH, "RCU reclaim all resources failed\n");
 	}
 
+	/* A resizable table keeps its current size */
+	if (h->resize != NULL)
+		resize_finish(h);
+
 	memset(h->buckets, 0, h->num_buckets * sizeof(struct rte_hash_bucket));
-	memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
+	for (seg = 0; seg < h->num_key_segs; seg++)
+		memset(h->key_segs[seg], 0,
+		       (size_t)h->key_entry_size * h->key_seg_slots[seg]);
 	*h->tbl_chng_cnt = 0;
 
 	/* reset the free ring */
@@ -653,9 +1094,19 @@ rte_hash_reset(struct rte_hash *h)
 	else
 		tot_ring_cnt = h->entries;
 
+	if (h->resizable)
+		tot_ring_cnt = h->key_seg_slots[0] - 1;
+
 	for (i = 1; i < tot_ring_cnt + 1; i++)
 		rte_ring_sp_enqueue_elem(h->free_slots, &i, sizeof(uint32_t));
 
+	for (seg = 1; seg < h->num_key_segs; seg++) {
+		for (i = key_seg_first(h, seg);
+		     i < key_seg_first(h, seg) + h->key_seg_slots[seg]; i++)
+			rte_ring_sp_enqueue_elem(h->free_slots, &i,
+						 sizeof(uint32_t));
+	}
+
 	/* Repopulate the free ext bkt ring. */
 	if (h->ext_table_support) {
 		for (i = 1; i <= h->num_buckets; i++)
@@ -697,12 +1148,11 @@ search_and_update(const struct rte_hash *h, void *data, const void *key,
 	struct rte_hash_bucket *bkt, uint16_t sig)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				/* The store to application data at *data
 				 * should not leak after the store to pdata
@@ -1011,7 +1461,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	uint16_t short_sig;
 	uint32_t prim_bucket_idx, sec_bucket_idx;
 	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt;
-	struct rte_hash_key *new_k, *keys = h->key_store;
+	struct rte_hash_key *new_k;
 	uint32_t ext_bkt_id = 0;
 	uint32_t slot_id;
 	int ret;
@@ -1068,7 +1518,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 			return -ENOSPC;
 	}
 
-	new_k = RTE_PTR_ADD(keys, slot_id * h->key_entry_size);
+	new_k = get_key_slot(h, slot_id);
 	/* The store to application data (by the application) at *data should
 	 * not leak after the store of pdata in the key store. i.e. pdata is
 	 * the guard variable. Release the application data to the readers.
@@ -1078,6 +1528,8 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		__ATOMIC_RELEASE);
 	/* Copy key */
 	memcpy(new_k->key, key, h->key_len);
+	if (h->resizable)
+		key_sig_set(h, new_k, sig);
 
 	/* Find an empty slot and insert */
 	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt, key, data,
@@ -1197,19 +1649,100 @@ failure:
 
 }
 
+/*
+ * Add a key to a resizable table. While a resize is in progress, keys are
+ * added to the new bucket array without moving other keys. When the
+ * table is full, a resize is started instead of failing.
+ */
+static int32_t
+__rte_hash_add_key_resizable(const struct rte_hash *h, const void *key,
+						hash_sig_t sig, void *data)
+{
+	uint16_t short_sig = get_short_sig(sig);
+	struct rte_hash_bucket *prim_bkt, *sec_bkt;
+	struct rte_hash_key *new_k;
+	uint32_t slot_id;
+	int32_t ret, ret_val;
+
+	for (;;) {
+		__hash_rw_writer_lock(h);
+		if (!resize_writer_bkts(h, sig, &prim_bkt, &sec_bkt)) {
+			__hash_rw_writer_unlock(h);
+			ret = __rte_hash_add_key_with_hash(h, key, sig, data);
+			if (ret != -ENOSPC)
+				return ret;
+
+			__hash_rw_writer_lock(h);
+			ret = resize_start(h);
+			__hash_rw_writer_unlock(h);
+			if (ret != 0)
+				return -ENOSPC;
+			continue;
+		}
+
+		ret = search_and_update(h, data, key, prim_bkt, short_sig);
+		if (ret == -1)
+			ret = search_and_update(h, data, key, sec_bkt,
+						short_sig);
+		__hash_rw_writer_unlock(h);
+		if (ret != -1)
+			return ret;
+
+		slot_id = alloc_slot(h, NULL);
+		if (slot_id != EMPTY_SLOT) {
+			new_k = get_key_slot(h, slot_id);
+			/* Release the application data to the readers */
+			__atomic_store_n(&new_k->pdata, data, __ATOMIC_RELEASE);
+			memcpy(new_k->key, key, h->key_len);
+			key_sig_set(h, new_k, sig);
+
+			ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt,
+					key, data, short_sig, slot_id,
+					&ret_val);
+			if (ret == -1)
+				ret = rte_hash_cuckoo_insert_mw(h, sec_bkt,
+						prim_bkt, key, data, short_sig,
+						slot_id, &ret_val);
+			if (ret == 0)
+				return slot_id - 1;
+
+			enqueue_slot_back(h, NULL, slot_id);
+			if (ret == 1)
+				return ret_val;
+		}
+
+		/* No room for the key in the resized buckets, complete the
+		 * resize to make space by moving keys around.
+		 */
+		__hash_rw_writer_lock(h);
+		resize_finish(h);
+		__hash_rw_writer_unlock(h);
+	}
+}
+
+static inline int32_t
+__rte_hash_add_key(const struct rte_hash *h, const void *key,
+						hash_sig_t sig, void *data)
+{
+	if (unlikely(h->resizable))
+		return __rte_hash_add_key_resizable(h, key, sig, data);
+	else
+		return __rte_hash_add_key_with_hash(h, key, sig, data);
+}
+
 int32_t
 rte_hash_add_key_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, sig, 0);
+	return __rte_hash_add_key(h, key, sig, 0);
 }
 
 int32_t
 rte_hash_add_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key), 0);
+	return __rte_hash_add_key(h, key, rte_hash_hash(h, key), 0);
 }
 
 int
@@ -1219,7 +1752,7 @@ rte_hash_add_key_with_hash_data(const struct rte_hash *h,
 	int ret;
 
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	ret = __rte_hash_add_key_with_hash(h, key, sig, data);
+	ret = __rte_hash_add_key(h, key, sig, data);
 	if (ret >= 0)
 		return 0;
 	else
@@ -1233,7 +1766,7 @@ rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
 
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
-	ret = __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key), data);
+	ret = __rte_hash_add_key(h, key, rte_hash_hash(h, key), data);
 	if (ret >= 0)
 		return 0;
 	else
@@ -1247,13 +1780,12 @@ search_one_bucket_l(const struct rte_hash *h, const void *key,
 		const struct rte_hash_bucket *bkt)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig &&
 				bkt->key_idx[i] != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
@@ -1276,7 +1808,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 {
 	int i;
 	uint32_t key_idx;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Signature comparison is done before the acquire-load
@@ -1290,8 +1822,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 			key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 			if (key_idx != EMPTY_SLOT) {
-				k = (struct rte_hash_key *) ((char *)keys +
-						key_idx * h->key_entry_size);
+				k = get_key_slot(h, key_idx);
 
 				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 					if (data != NULL) {
@@ -1409,11 +1940,57 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+static inline int32_t
+__rte_hash_lookup_resizable(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	const struct rte_hash_bucket *prim_bkt, *sec_bkt;
+	uint16_t short_sig = get_short_sig(sig);
+	uint32_t cnt_b, cnt_a;
+	int32_t ret;
+
+	if (!h->readwrite_concur_lf_support) {
+		__hash_rw_reader_lock(h);
+		resize_reader_bkts(h, sig, &prim_bkt, &sec_bkt);
+		ret = search_one_bucket_l(h, key, short_sig, data, prim_bkt);
+		if (ret == -1)
+			ret = search_one_bucket_l(h, key, short_sig, data,
+						  sec_bkt);
+		__hash_rw_reader_unlock(h);
+
+		return ret != -1 ? ret : -ENOENT;
+	}
+
+	do {
+		/* Same as __rte_hash_lookup_with_hash_lf(). The counter
+		 * also changes when a resize completes.
+		 */
+		cnt_b = __atomic_load_n(h->tbl_chng_cnt,
+				__ATOMIC_ACQUIRE);
+
+		resize_reader_bkts(h, sig, &prim_bkt, &sec_bkt);
+		ret = search_one_bucket_lf(h, key, short_sig, data, prim_bkt);
+		if (ret != -1)
+			return ret;
+		ret = search_one_bucket_lf(h, key, short_sig, data, sec_bkt);
+		if (ret != -1)
+			return ret;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		cnt_a = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+	} while (cnt_b != cnt_a);
+
+	return -ENOENT;
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
-	if (h->readwrite_concur_lf_support)
+	if (unlikely(h->resizable))
+		return __rte_hash_lookup_resizable(h, key, sig, data);
+	else if (h->readwrite_concur_lf_support)
 		return __rte_hash_lookup_with_hash_lf(h, key, sig, data);
 	else
 		return __rte_hash_lookup_with_hash_l(h, key, sig, data);
@@ -1480,16 +2057,14 @@ __hash_rcu_qsbr_free_resource(void *p, void *e, unsigned int n)
 {
 	void *key_data = NULL;
 	int ret;
-	struct rte_hash_key *keys, *k;
+	struct rte_hash_key *k;
 	struct rte_hash *h = (struct rte_hash *)p;
 	struct __rte_hash_rcu_dq_entry rcu_dq_entry =
 			*((struct __rte_hash_rcu_dq_entry *)e);
 
 	RTE_SET_USED(n);
-	keys = h->key_store;
 
-	k = (struct rte_hash_key *) ((char *)keys +
-				rcu_dq_entry.key_idx * h->key_entry_size);
+	k = get_key_slot(h, rcu_dq_entry.key_idx);
 	key_data = k->pdata;
 	if (h->hash_rcu_cfg->free_key_data_func)
 		h->hash_rcu_cfg->free_key_data_func(h->hash_rcu_cfg->key_data_ptr,
@@ -1641,7 +2216,7 @@ static inline int32_t
 search_and_remove(const struct rte_hash *h, const void *key,
 			struct rte_hash_bucket *bkt, uint16_t sig, int *pos)
 {
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 	unsigned int i;
 	uint32_t key_idx;
 
@@ -1650,8 +2225,7 @@ search_and_remove(const struct rte_hash *h, const void *key,
 		key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 		if (bkt->sig_current[i] == sig && key_idx != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					key_idx * h->key_entry_size);
+			k = get_key_slot(h, key_idx);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				bkt->sig_current[i] = NULL_SIGNATURE;
 				/* Free the key store index if
@@ -1690,11 +2264,18 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 	struct __rte_hash_rcu_dq_entry rcu_dq_entry;
 
 	short_sig = get_short_sig(sig);
-	prim_bucket_idx = get_prim_bucket_index(h, sig);
-	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
-	prim_bkt = &h->buckets[prim_bucket_idx];
 
 	__hash_rw_writer_lock(h);
+	if (unlikely(h->resizable))
+		resize_writer_bkts(h, sig, &prim_bkt, &sec_bkt);
+	else {
+		prim_bucket_idx = get_prim_bucket_index(h, sig);
+		sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+						      short_sig);
+		prim_bkt = &h->buckets[prim_bucket_idx];
+		sec_bkt = &h->buckets[sec_bucket_idx];
+	}
+
 	/* look for key in primary bucket */
 	ret = search_and_remove(h, key, prim_bkt, short_sig, &pos);
 	if (ret != -1) {
@@ -1704,9 +2285,6 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 		goto return_bkt;
 	}
 
-	/* Calculate secondary hash */
-	sec_bkt = &h->buckets[sec_bucket_idx];
-
 	FOR_EACH_BUCKET(cur_bkt, sec_bkt) {
 		ret = search_and_remove(h, key, cur_bkt, short_sig, &pos);
 		if (ret != -1) {
@@ -1802,9 +2380,13 @@ rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
-	struct rte_hash_key *k, *keys = h->key_store;
-	k = (struct rte_hash_key *) ((char *) keys + (position + 1) *
-				     h->key_entry_size);
+	struct rte_hash_key *k;
+
+	/* Key store segments of resizable tables have holes between them */
+	if (h->resizable && !key_idx_valid(h, position + 1))
+		return -EINVAL;
+
+	k = get_key_slot(h, position + 1);
 	*key = k->key;
 
 	if (position !=
@@ -1829,8 +2411,11 @@ rte_hash_free_key_with_position(const struct rte_hash *h,
 		h->entries + (RTE_MAX_LCORE - 1) * (LCORE_CACHE_SIZE - 1) + 1
 							: h->entries + 1;
 
-	/* Out of bounds */
-	if (key_idx >= total_entries)
+	/* Out of bounds. Key store segments of resizable tables have holes
+	 * between them.
+	 */
+	if (h->resizable ? !key_idx_valid(h, key_idx) :
+			key_idx >= total_entries)
 		return -EINVAL;
 	if (h->ext_table_support && h->readwrite_concur_lf_support) {
 		uint32_t index = h->ext_bkt_to_free[position];
@@ -1859,6 +2444,8 @@ compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 	/* For match mask the first bit of every two bits indicates the match */
 	switch (sig_cmp_fn) {
 #if defined(__SSE2__)
+	case RTE_HASH_COMPARE_AVX512:
+	case RTE_HASH_COMPARE_AVX2:
 	case RTE_HASH_COMPARE_SSE:
 		/* Compare all signatures in the bucket */
 		*prim_hash_matches = _mm_movemask_epi8(_mm_cmpeq_epi16(
@@ -1900,6 +2487,38 @@ compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 	}
 }
 
+static inline void
+compare_signatures_bulk(const struct rte_hash *h,
+			uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
+			const struct rte_hash_bucket **primary_bkt,
+			const struct rte_hash_bucket **secondary_bkt,
+			const uint16_t *sig, int32_t num_keys)
+{
+	int32_t i;
+
+	switch (h->sig_cmp_fn) {
+#ifdef CC_HASH_AVX512_SUPPORT
+	case RTE_HASH_COMPARE_AVX512:
+		rte_hash_compare_signatures_avx512(prim_hash_matches,
+			sec_hash_matches, primary_bkt, secondary_bkt,
+			sig, num_keys);
+		break;
+#endif
+#ifdef CC_HASH_AVX2_SUPPORT
+	case RTE_HASH_COMPARE_AVX2:
+		rte_hash_compare_signatures_avx2(prim_hash_matches,
+			sec_hash_matches, primary_bkt, secondary_bkt,
+			sig, num_keys);
+		break;
+#endif
+	default:
+		for (i = 0; i < num_keys; i++)
+			compare_signatures(&prim_hash_matches[i],
+				&sec_hash_matches[i], primary_bkt[i],
+				secondary_bkt[i], sig[i], h->sig_cmp_fn);
+	}
+}
+
 static inline void
 __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 		const struct rte_hash_bucket **primary_bkt,
@@ -1917,11 +2536,10 @@ __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 	__hash_rw_reader_lock(h);
 
 	/* Compare signatures and prefetch key slot of first hit */
-	for (i = 0; i < num_keys; i++) {
-		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-			primary_bkt[i], secondary_bkt[i],
-			sig[i], h->sig_cmp_fn);
+	compare_signatures_bulk(h, prim_hitmask, sec_hitmask,
+		primary_bkt, secondary_bkt, sig, num_keys);
 
+	for (i = 0; i < num_keys; i++) {
 		if (prim_hitmask[i]) {
 			uint32_t first_hit =
 					__builtin_ctzl(prim_hitmask[i])
@@ -2074,11 +2692,10 @@ __bulk_lookup_lf(const struct rte_hash *h, const void **keys,
 					__ATOMIC_ACQUIRE);
 
 		/* Compare signatures and prefetch key slot of first hit */
-		for (i = 0; i < num_keys; i++) {
-			compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-				primary_bkt[i], secondary_bkt[i],
-				sig[i], h->sig_cmp_fn);
+		compare_signatures_bulk(h, prim_hitmask, sec_hitmask,
+			primary_bkt, secondary_bkt, sig, num_keys);
 
+		for (i = 0; i < num_keys; i++) {
 			if (prim_hitmask[i]) {
 				uint32_t first_hit =
 						__builtin_ctzl(prim_hitmask[i])
@@ -2227,6 +2844,56 @@ next_key:
 }
 
 #define PREFETCH_OFFSET 4
+#if defined(CC_HASH_AVX2_SUPPORT) || defined(CC_HASH_AVX512_SUPPORT)
+static inline void
+__bulk_lookup_prefetching_loop_vec(const struct rte_hash *h,
+	const void **keys, int32_t num_keys,
+	uint16_t *sig,
+	const struct rte_hash_bucket **primary_bkt,
+	const struct rte_hash_bucket **secondary_bkt)
+{
+	int32_t i, j, n;
+	uint32_t prim_hash[RTE_HASH_LOOKUP_BULK_MAX];
+
+	/* Prefetch first keys */
+	for (i = 0; i < PREFETCH_OFFSET && i < num_keys; i++)
+		rte_prefetch0(keys[i]);
+
+	/*
+	 * Hash a batch of keys while prefetching the next ones, then
+	 * calculate the primary and secondary buckets of the whole batch
+	 * at once and prefetch them
+	 */
+	for (i = 0; i < num_keys; i += RTE_HASH_VEC_BATCH) {
+		n = RTE_MIN(num_keys - i, RTE_HASH_VEC_BATCH);
+
+		for (j = i; j < i + n; j++) {
+			if (j + PREFETCH_OFFSET < num_keys)
+				rte_prefetch0(keys[j + PREFETCH_OFFSET]);
+			prim_hash[j] = rte_hash_hash(h, keys[j]);
+		}
+
+#ifdef CC_HASH_AVX512_SUPPORT
+		if (h->sig_cmp_fn == RTE_HASH_COMPARE_AVX512)
+			rte_hash_bkt_idx_avx512(h->buckets, h->bucket_bitmask,
+				&prim_hash[i], n, &sig[i], &primary_bkt[i],
+				&secondary_bkt[i]);
+#endif
+#ifdef CC_HASH_AVX2_SUPPORT
+		if (h->sig_cmp_fn == RTE_HASH_COMPARE_AVX2)
+			rte_hash_bkt_idx_avx2(h->buckets, h->bucket_bitmask,
+				&prim_hash[i], n, &sig[i], &primary_bkt[i],
+				&secondary_bkt[i]);
+#endif
+
+		for (j = i; j < i + n; j++) {
+			rte_prefetch0(primary_bkt[j]);
+			rte_prefetch0(secondary_bkt[j]);
+		}
+	}
+}
+#endif
+
 static inline void
 __bulk_lookup_prefetching_loop(const struct rte_hash *h,
 	const void **keys, int32_t num_keys,
@@ -2239,6 +2906,15 @@ __bulk_lookup_prefetching_loop(const struct rte_hash *h,
 	uint32_t prim_index[RTE_HASH_LOOKUP_BULK_MAX];
 	uint32_t sec_index[RTE_HASH_LOOKUP_BULK_MAX];
 
+#if defined(CC_HASH_AVX2_SUPPORT) || defined(CC_HASH_AVX512_SUPPORT)
+	if (h->sig_cmp_fn == RTE_HASH_COMPARE_AVX2 ||
+			h->sig_cmp_fn == RTE_HASH_COMPARE_AVX512) {
+		__bulk_lookup_prefetching_loop_vec(h, keys, num_keys, sig,
+			primary_bkt, secondary_bkt);
+		return;
+	}
+#endif
+
 	/* Prefetch first keys */
 	for (i = 0; i < PREFETCH_OFFSET && i < num_keys; i++)
 		rte_prefetch0(keys[i]);
@@ -2312,12 +2988,41 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 		positions, hit_mask, data);
 }
 
+/*
+ * Bulk lookup in a resizable table. The buckets of a key depend on the
+ * progress of the resize, so keys are looked up one at a time.
+ */
+static inline void
+__rte_hash_lookup_bulk_resizable(const struct rte_hash *h, const void **keys,
+			const hash_sig_t *prim_hash, int32_t num_keys,
+			int32_t *positions, uint64_t *hit_mask, void *data[])
+{
+	uint64_t hits = 0;
+	hash_sig_t sig;
+	int32_t i;
+
+	for (i = 0; i < num_keys; i++) {
+		sig = prim_hash != NULL ? prim_hash[i] :
+				rte_hash_hash(h, keys[i]);
+		positions[i] = __rte_hash_lookup_resizable(h, keys[i], sig,
+				data != NULL ? &data[i] : NULL);
+		if (positions[i] >= 0)
+			hits |= 1ULL << i;
+	}
+
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+}
+
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			int32_t num_keys, int32_t *positions,
 			uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (unlikely(h->resizable))
+		__rte_hash_lookup_bulk_resizable(h, keys, NULL, num_keys,
+				positions, hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_bulk_lf(h, keys, num_keys, positions,
 					  hit_mask, data);
 	else
@@ -2429,7 +3134,10 @@ __rte_hash_lookup_with_hash_bulk(const struct rte_hash *h, const void **keys,
 			hash_sig_t *prim_hash, int32_t num_keys,
 			int32_t *positions, uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (unlikely(h->resizable))
+		__rte_hash_lookup_bulk_resizable(h, keys, prim_hash, num_keys,
+				positions, hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_with_hash_bulk_lf(h, keys, prim_hash,
 				num_keys, positions, hit_mask, data);
 	else
@@ -2470,16 +3178,41 @@ rte_hash_lookup_with_hash_bulk_data(const struct rte_hash *h,
 	return __builtin_popcountl(*hit_mask);
 }
 
+/*
+ * Get the key index at a position of the main table. While a resize is in
+ * progress, positions follow the new bucket array and the old buckets not
+ * migrated yet are used for the first half.
+ */
+static inline uint32_t
+iterate_key_idx(const struct rte_hash *h, const struct rte_hash_resize *r,
+		uint32_t bucket_idx, uint32_t idx)
+{
+	const struct rte_hash_bucket *bkt;
+
+	if (likely(r == NULL))
+		bkt = &h->buckets[bucket_idx];
+	else if (resize_bkt_migrated(r, bucket_idx & r->bucket_bitmask))
+		bkt = &r->buckets_new[bucket_idx];
+	else if (bucket_idx <= r->bucket_bitmask)
+		bkt = &r->buckets[bucket_idx];
+	else
+		return EMPTY_SLOT;
+
+	return __atomic_load_n(&bkt->key_idx[idx], __ATOMIC_ACQUIRE);
+}
+
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next)
 {
 	uint32_t bucket_idx, idx, position;
 	struct rte_hash_key *next_key;
+	const struct rte_hash_resize *r;
 
 	RETURN_IF_TRUE(((h == NULL) || (next == NULL)), -EINVAL);
 
-	const uint32_t total_entries_main = h->num_buckets *
-							RTE_HASH_BUCKET_ENTRIES;
+	r = __atomic_load_n(&h->resize, __ATOMIC_ACQUIRE);
+	const uint32_t total_entries_main = (r == NULL ? h->num_buckets :
+			(r->bucket_bitmask + 1) * 2) * RTE_HASH_BUCKET_ENTRIES;
 	const uint32_t total_entries = total_entries_main << 1;
 
 	/* Out of bounds of all buckets (both main table and ext table) */
@@ -2491,8 +3224,8 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	idx = *next % RTE_HASH_BUCKET_ENTRIES;
 
 	/* If current position is empty, go to the next one */
-	while ((position = __atomic_load_n(&h->buckets[bucket_idx].key_idx[idx],
-					__ATOMIC_ACQUIRE)) == EMPTY_SLOT) {
+	while ((position = iterate_key_idx(h, r, bucket_idx, idx)) ==
+			EMPTY_SLOT) {
 		(*next)++;
 		/* End of table */
 		if (*next == total_entries_main)
@@ -2502,8 +3235,7 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	}
 
 	__hash_rw_reader_lock(h);
-	next_key = (struct rte_hash_key *) ((char *)h->key_store +
-				position * h->key_entry_size);
+	next_key = get_key_slot(h, position);
 	/* Return key and data */
 	*key = next_key->key;
 	*data = next_key->pdata;
@@ -2533,8 +3265,7 @@ extend_table:
 		idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
 	}
 	__hash_rw_reader_lock(h);
-	next_key = (struct rte_hash_key *) ((char *)h->key_store +
-				position * h->key_entry_size);
+	next_key = get_key_slot(h, position);
 	/* Return key and data */
 	*key = next_key->key;
 	*data = next_key->pdata;
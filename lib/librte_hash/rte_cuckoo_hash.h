@@ -122,6 +122,12 @@ const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
 
 #define RTE_HASH_TSX_MAX_RETRY  10
 
+/* Maximum number of key store segments of a resizable table */
+#define RTE_HASH_KEY_SEGS_MAX		32
+
+/* Number of old buckets migrated by each writer call during a resize */
+#define RTE_HASH_RESIZE_STEP		4
+
 struct lcore_cache {
 	unsigned len; /**< Cache len */
 	uint32_t objs[LCORE_CACHE_SIZE]; /**< Cache objects */
@@ -142,6 +148,8 @@ enum rte_hash_sig_compare_function {
 	RTE_HASH_COMPARE_SCALAR = 0,
 	RTE_HASH_COMPARE_SSE,
 	RTE_HASH_COMPARE_NEON,
+	RTE_HASH_COMPARE_AVX2,
+	RTE_HASH_COMPARE_AVX512,
 	RTE_HASH_COMPARE_NUM
 };
 
@@ -156,6 +164,18 @@ struct rte_hash_bucket {
 	void *next;
 } __rte_cache_aligned;
 
+/** State of a resizable table while its bucket array is doubled. */
+struct rte_hash_resize {
+	struct rte_hash_bucket *buckets;
+	/**< Bucket array being migrated */
+	struct rte_hash_bucket *buckets_new;
+	/**< Bucket array twice as large receiving the migrated entries */
+	uint32_t bucket_bitmask;        /**< Bitmask of the old bucket array */
+	uint32_t next_bkt;              /**< Next old bucket to migrate */
+	uint64_t migrated[];
+	/**< Bitmap of the old buckets already migrated */
+};
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];   /**< Name of the hash. */
@@ -196,6 +216,8 @@ struct rte_hash {
 	/**< If read-write concurrency lock free support is enabled */
 	uint8_t writer_takes_lock;
 	/**< Indicates if the writer threads need to take lock */
+	uint8_t resizable;
+	/**< If the table grows instead of failing when it is full */
 	rte_hash_function hash_func;    /**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;    /**< Init value used by hash_func. */
 	rte_hash_cmp_eq_t rte_hash_custom_cmp_eq;
@@ -207,6 +229,8 @@ struct rte_hash {
 	uint32_t bucket_bitmask;
 	/**< Bitmask for getting bucket index from hash signature. */
 	uint32_t key_entry_size;         /**< Size of each key entry. */
+	uint32_t key_seg_shift;
+	/**< Log2 of the number of key indexes of the first key store segment */
 
 	void *key_store;                /**< Table storing all keys and data */
 	struct rte_hash_bucket *buckets;
@@ -225,6 +249,24 @@ struct rte_hash {
 	uint32_t *ext_bkt_to_free;
 	uint32_t *tbl_chng_cnt;
 	/**< Indicates if the hash table changed from last read. */
+
+	/* Fields used by resizable tables */
+	struct rte_hash_resize *resize;
+	/**< Resize in progress, NULL if the table is not being resized */
+	void *key_segs[RTE_HASH_KEY_SEGS_MAX];
+	/**< Key store segments. Segment 0 is key_store, segment n > 0 holds
+	 * the key indexes from 1 << (key_seg_shift + n - 1) to
+	 * 1 << (key_seg_shift + n) excluded.
+	 */
+	uint32_t key_seg_slots[RTE_HASH_KEY_SEGS_MAX];
+	/**< Number of key indexes allocated in each key store segment */
+	uint32_t num_key_segs;          /**< Number of key store segments */
+	uint32_t num_retired;           /**< Number of retired allocations */
+	void *retired[2 * RTE_HASH_KEY_SEGS_MAX];
+	/**< Bucket arrays and resize states replaced by a resize, which lock
+	 * free readers may still access when no RCU variable is configured.
+	 */
+	int socket_id;                  /**< Socket of the table memory */
 } __rte_cache_aligned;
 
 struct queue_node {
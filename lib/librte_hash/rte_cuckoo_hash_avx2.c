@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <rte_common.h>
+#include <rte_vect.h>
+
+#include "rte_cuckoo_hash_x86.h"
+
+static __rte_always_inline __m128i
+bkt_sig_load(const struct rte_hash_bucket *bkt)
+{
+	return _mm_load_si128((const __m128i *)bkt);
+}
+
+static __rte_always_inline void
+bkt_ptr_store_x4(const struct rte_hash_bucket **bkt, __m256i base,
+		__m128i idx)
+{
+	__m256i ptr;
+
+	ptr = _mm256_slli_epi64(_mm256_cvtepu32_epi64(idx),
+			RTE_HASH_BUCKET_SHIFT);
+	ptr = _mm256_add_epi64(ptr, base);
+	_mm256_storeu_si256((__m256i *)bkt, ptr);
+}
+
+void
+rte_hash_bkt_idx_avx2(const struct rte_hash_bucket *buckets,
+		uint32_t bucket_bitmask, const uint32_t *prim_hash,
+		int32_t num_keys, uint16_t *sig,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt)
+{
+	const __m256i base = _mm256_set1_epi64x((uintptr_t)buckets);
+	const __m256i msk = _mm256_set1_epi32(bucket_bitmask);
+	__m256i hash, sig32, prim, sec;
+	uint32_t prim_idx, sec_idx;
+	int32_t i;
+
+	for (i = 0; i + 8 <= num_keys; i += 8) {
+		hash = _mm256_loadu_si256((const __m256i *)&prim_hash[i]);
+
+		/* Same as get_short_sig() and get_[prim|alt]_bucket_index() */
+		sig32 = _mm256_srli_epi32(hash, 16);
+		prim = _mm256_and_si256(hash, msk);
+		sec = _mm256_and_si256(_mm256_xor_si256(prim, sig32), msk);
+
+		/* Signatures fit in 16 bits, pack them in the low lane */
+		sig32 = _mm256_permute4x64_epi64(
+				_mm256_packus_epi32(sig32, sig32), 0x8);
+		_mm_storeu_si128((__m128i *)&sig[i],
+				_mm256_castsi256_si128(sig32));
+
+		bkt_ptr_store_x4(&primary_bkt[i], base,
+				_mm256_castsi256_si128(prim));
+		bkt_ptr_store_x4(&primary_bkt[i + 4], base,
+				_mm256_extracti128_si256(prim, 1));
+		bkt_ptr_store_x4(&secondary_bkt[i], base,
+				_mm256_castsi256_si128(sec));
+		bkt_ptr_store_x4(&secondary_bkt[i + 4], base,
+				_mm256_extracti128_si256(sec, 1));
+	}
+
+	for (; i < num_keys; i++) {
+		sig[i] = prim_hash[i] >> 16;
+		prim_idx = prim_hash[i] & bucket_bitmask;
+		sec_idx = (prim_idx ^ sig[i]) & bucket_bitmask;
+		primary_bkt[i] = RTE_PTR_ADD(buckets,
+				(uintptr_t)prim_idx << RTE_HASH_BUCKET_SHIFT);
+		secondary_bkt[i] = RTE_PTR_ADD(buckets,
+				(uintptr_t)sec_idx << RTE_HASH_BUCKET_SHIFT);
+	}
+}
+
+void
+rte_hash_compare_signatures_avx2(uint32_t *prim_hash_matches,
+		uint32_t *sec_hash_matches,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt,
+		const uint16_t *sig, int32_t num_keys)
+{
+	__m256i sigs, prim, sec;
+	uint32_t prim_msk, sec_msk;
+	int32_t i;
+
+	/* Compare the signatures of two keys at a time */
+	for (i = 0; i + 2 <= num_keys; i += 2) {
+		sigs = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_set1_epi16(sig[i])),
+				_mm_set1_epi16(sig[i + 1]), 1);
+		prim = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(
+					bkt_sig_load(primary_bkt[i])),
+				bkt_sig_load(primary_bkt[i + 1]), 1);
+		sec = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(
+					bkt_sig_load(secondary_bkt[i])),
+				bkt_sig_load(secondary_bkt[i + 1]), 1);
+
+		prim_msk = _mm256_movemask_epi8(_mm256_cmpeq_epi16(prim, sigs));
+		sec_msk = _mm256_movemask_epi8(_mm256_cmpeq_epi16(sec, sigs));
+
+		prim_hash_matches[i] = prim_msk & UINT16_MAX;
+		prim_hash_matches[i + 1] = prim_msk >> 16;
+		sec_hash_matches[i] = sec_msk & UINT16_MAX;
+		sec_hash_matches[i + 1] = sec_msk >> 16;
+	}
+
+	if (i < num_keys) {
+		const __m128i sig1 = _mm_set1_epi16(sig[i]);
+
+		prim_hash_matches[i] = _mm_movemask_epi8(_mm_cmpeq_epi16(
+				bkt_sig_load(primary_bkt[i]), sig1));
+		sec_hash_matches[i] = _mm_movemask_epi8(_mm_cmpeq_epi16(
+				bkt_sig_load(secondary_bkt[i]), sig1));
+	}
+}
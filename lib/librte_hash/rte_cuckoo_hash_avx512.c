@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+#include <rte_common.h>
+#include <rte_vect.h>
+
+#include "rte_cuckoo_hash_x86.h"
+
+static __rte_always_inline __m128i
+bkt_sig_load(const struct rte_hash_bucket *bkt)
+{
+	return _mm_load_si128((const __m128i *)bkt);
+}
+
+static __rte_always_inline __m512i
+bkt_sig_load_x4(const struct rte_hash_bucket **bkt)
+{
+	__m512i sigs;
+
+	sigs = _mm512_castsi128_si512(bkt_sig_load(bkt[0]));
+	sigs = _mm512_inserti32x4(sigs, bkt_sig_load(bkt[1]), 1);
+	sigs = _mm512_inserti32x4(sigs, bkt_sig_load(bkt[2]), 2);
+	return _mm512_inserti32x4(sigs, bkt_sig_load(bkt[3]), 3);
+}
+
+/*
+ * Turn a compare mask of 4 buckets into 4 hit masks with the first bit of
+ * every two bits indicating the match.
+ */
+static __rte_always_inline void
+bkt_hitmask_x4(uint32_t *matches, __mmask32 msk)
+{
+	uint64_t hits = _mm512_movepi8_mask(_mm512_movm_epi16(msk));
+
+	matches[0] = hits & UINT16_MAX;
+	matches[1] = (hits >> 16) & UINT16_MAX;
+	matches[2] = (hits >> 32) & UINT16_MAX;
+	matches[3] = hits >> 48;
+}
+
+void
+rte_hash_bkt_idx_avx512(const struct rte_hash_bucket *buckets,
+		uint32_t bucket_bitmask, const uint32_t *prim_hash,
+		int32_t num_keys, uint16_t *sig,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt)
+{
+	const __m512i base = _mm512_set1_epi64((uintptr_t)buckets);
+	const __m512i msk = _mm512_set1_epi32(bucket_bitmask);
+	__mmask16 keys_msk = (1U << num_keys) - 1;
+	__m512i hash, sig32, prim, sec, ptr;
+
+	hash = _mm512_maskz_loadu_epi32(keys_msk, prim_hash);
+
+	/* Same as get_short_sig() and get_[prim|alt]_bucket_index() */
+	sig32 = _mm512_srli_epi32(hash, 16);
+	prim = _mm512_and_epi32(hash, msk);
+	sec = _mm512_and_epi32(_mm512_xor_epi32(prim, sig32), msk);
+
+	_mm512_mask_cvtepi32_storeu_epi16(sig, keys_msk, sig32);
+
+	ptr = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(prim));
+	ptr = _mm512_add_epi64(_mm512_slli_epi64(ptr, RTE_HASH_BUCKET_SHIFT),
+			base);
+	_mm512_mask_storeu_epi64(primary_bkt, keys_msk & 0xff, ptr);
+
+	ptr = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(prim, 1));
+	ptr = _mm512_add_epi64(_mm512_slli_epi64(ptr, RTE_HASH_BUCKET_SHIFT),
+			base);
+	_mm512_mask_storeu_epi64(primary_bkt + 8, keys_msk >> 8, ptr);
+
+	ptr = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(sec));
+	ptr = _mm512_add_epi64(_mm512_slli_epi64(ptr, RTE_HASH_BUCKET_SHIFT),
+			base);
+	_mm512_mask_storeu_epi64(secondary_bkt, keys_msk & 0xff, ptr);
+
+	ptr = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(sec, 1));
+	ptr = _mm512_add_epi64(_mm512_slli_epi64(ptr, RTE_HASH_BUCKET_SHIFT),
+			base);
+	_mm512_mask_storeu_epi64(secondary_bkt + 8, keys_msk >> 8, ptr);
+}
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+		uint32_t *sec_hash_matches,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt,
+		const uint16_t *sig, int32_t num_keys)
+{
+	/* Spread the 4 signatures of the batch to one bucket width each */
+	const __m512i sig_idx = _mm512_set_epi64(
+			0x0003000300030003, 0x0003000300030003,
+			0x0002000200020002, 0x0002000200020002,
+			0x0001000100010001, 0x0001000100010001,
+			0, 0);
+	__m512i sigs;
+	int32_t i;
+
+	/* Compare the signatures of four keys at a time */
+	for (i = 0; i + 4 <= num_keys; i += 4) {
+		sigs = _mm512_permutexvar_epi16(sig_idx,
+				_mm512_castsi128_si512(_mm_loadl_epi64(
+					(const __m128i *)&sig[i])));
+
+		bkt_hitmask_x4(&prim_hash_matches[i], _mm512_cmpeq_epi16_mask(
+				bkt_sig_load_x4(&primary_bkt[i]), sigs));
+		bkt_hitmask_x4(&sec_hash_matches[i], _mm512_cmpeq_epi16_mask(
+				bkt_sig_load_x4(&secondary_bkt[i]), sigs));
+	}
+
+	for (; i < num_keys; i++) {
+		const __m128i sig1 = _mm_set1_epi16(sig[i]);
+
+		prim_hash_matches[i] = _mm_movemask_epi8(_mm_cmpeq_epi16(
+				bkt_sig_load(primary_bkt[i]), sig1));
+		sec_hash_matches[i] = _mm_movemask_epi8(_mm_cmpeq_epi16(
+				bkt_sig_load(secondary_bkt[i]), sig1));
+	}
+}
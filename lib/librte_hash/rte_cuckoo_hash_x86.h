@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+
+/* rte_cuckoo_hash_x86.h
+ * This file holds the declarations of the AVX2 and AVX512 bulk lookup
+ * helpers, which are built in their own objects with the matching compiler
+ * flags and cannot include rte_cuckoo_hash.h.
+ */
+
+#ifndef _RTE_CUCKOO_HASH_X86_H_
+#define _RTE_CUCKOO_HASH_X86_H_
+
+#include <stdint.h>
+
+struct rte_hash_bucket;
+
+/*
+ * Buckets are one cache line, with the signatures array at their start.
+ * Both are checked at table creation.
+ */
+#define RTE_HASH_BUCKET_SHIFT	6
+
+/* Number of keys whose buckets are computed at once by the vector paths */
+#define RTE_HASH_VEC_BATCH	16
+
+/*
+ * Compute the signature, primary and secondary buckets of num_keys
+ * (up to RTE_HASH_VEC_BATCH) keys from their hash values.
+ */
+void
+rte_hash_bkt_idx_avx2(const struct rte_hash_bucket *buckets,
+		uint32_t bucket_bitmask, const uint32_t *prim_hash,
+		int32_t num_keys, uint16_t *sig,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt);
+
+void
+rte_hash_bkt_idx_avx512(const struct rte_hash_bucket *buckets,
+		uint32_t bucket_bitmask, const uint32_t *prim_hash,
+		int32_t num_keys, uint16_t *sig,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt);
+
+/*
+ * Compare the signatures of num_keys keys with the ones in their primary
+ * and secondary buckets. Hit masks use the same format as the SSE compare,
+ * i.e. the first bit of every two bits indicates the match.
+ */
+void
+rte_hash_compare_signatures_avx2(uint32_t *prim_hash_matches,
+		uint32_t *sec_hash_matches,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt,
+		const uint16_t *sig, int32_t num_keys);
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+		uint32_t *sec_hash_matches,
+		const struct rte_hash_bucket **primary_bkt,
+		const struct rte_hash_bucket **secondary_bkt,
+		const uint16_t *sig, int32_t num_keys);
+
+#endif /* _RTE_CUCKOO_HASH_X86_H_ */
@@ -56,6 +56,20 @@ extern "C" {
  */
 #define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
 
+/** Flag to let the table grow when it is full instead of failing additions.
+ * The bucket array is doubled and the keys are migrated to the new array a
+ * few buckets per add/delete call, while lookups keep seeing all the keys.
+ * Cannot be used with RTE_HASH_EXTRA_FLAGS_EXT_TABLE or
+ * RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD. With
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, the replaced bucket arrays are
+ * freed once the readers are quiescent if a RCU variable is attached with
+ * rte_hash_rcu_qsbr_add(), else when the table is freed. In that case, the
+ * add call completing a resize blocks in rte_rcu_qsbr_synchronize() until
+ * all the reader threads report a quiescent state, also when the RCU
+ * variable is attached in RTE_HASH_QSBR_MODE_DQ mode.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RESIZABLE 0x40
+
 /**
  * The type of hash value of a key.
  * It should be a value of at least 32bit with fully random pattern.
@@ -209,7 +223,8 @@ rte_hash_count(const struct rte_hash *h);
  * @b EXPERIMENTAL: this API may change without prior notice
  *
  * Return the maximum key value ID that could possibly be returned by
- * rte_hash_add_key function.
+ * rte_hash_add_key function. For a table created with
+ * RTE_HASH_EXTRA_FLAGS_RESIZABLE, the value grows with the table.
  *
  * @param h
  *  Hash table to query from
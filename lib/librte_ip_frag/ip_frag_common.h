@@ -17,6 +17,15 @@
 #define IPV4_KEYLEN 1
 #define IPV6_KEYLEN 4
 
+/* number of fragments hashed and prefetched ahead in burst mode */
+#define IP_FRAG_BURST_SIZE 32
+
+/* number of mbufs prefetched ahead when the burst mode frees the death row */
+#define IP_FRAG_DR_PREFETCH 3
+
+/* max number of mbufs put on the death row per fragment */
+#define IP_FRAG_DR_MBUF_PER_FRAG (IP_MAX_FRAG_NUM + 1)
+
 /* helper macros */
 #define	IP_FRAG_MBUF2DR(dr, mb)	((dr)->row[(dr)->cnt++] = (mb))
 
@@ -31,6 +40,30 @@
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
 #endif /* IP_FRAG_TBL_STAT */
 
+/* fragment parsed ahead of its table lookup in burst mode */
+struct ip_frag_desc {
+	struct rte_mbuf *mb;     /**< fragment mbuf, NULL if dropped */
+	struct ip_frag_key key;  /**< key, empty if not a fragment */
+	uint32_t sig1;           /**< primary hash value */
+	uint32_t sig2;           /**< secondary hash value */
+	uint16_t ofs;            /**< offset into the packet */
+	uint16_t len;            /**< length of fragment */
+	uint16_t more_frags;     /**< more fragments flag */
+};
+
+/*
+ * Free the death row if it has no room left for the mbufs of *n* fragments,
+ * so that a burst of any size can be processed with one death row.
+ */
+static inline void
+ip_frag_dr_reserve(struct rte_ip_frag_death_row *dr, uint32_t n)
+{
+	RTE_BUILD_BUG_ON(IP_FRAG_BURST_SIZE > IP_FRAG_DEATH_ROW_LEN);
+
+	if (dr->cnt + n * IP_FRAG_DR_MBUF_PER_FRAG > RTE_DIM(dr->row))
+		rte_ip_frag_free_death_row(dr, IP_FRAG_DR_PREFETCH);
+}
+
 /* internal functions declarations */
 struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
 		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
@@ -40,9 +73,18 @@ struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		const struct ip_frag_key *key, uint64_t tms);
 
+struct ip_frag_pkt *ip_frag_find_hash(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr,
+		const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+		uint64_t tms);
+
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+
+uint16_t ip_frag_process_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct ip_frag_desc *desc,
+		uint16_t nb_desc, uint64_t tms, struct rte_mbuf **out);
 
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf *ipv4_frag_reassemble(struct ip_frag_pkt *fp);
@@ -87,6 +87,16 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	*v2 = (v << 7) + (v >> 14);
 }
 
+static inline void
+ip_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+{
+	/* different hashing methods for IPv4 and IPv6 */
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(key, v1, v2);
+	else
+		ipv6_frag_hash(key, v1, v2);
+}
+
 struct rte_mbuf *
 ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
@@ -221,6 +231,25 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 struct ip_frag_pkt *
 ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	const struct ip_frag_key *key, uint64_t tms)
+{
+	uint32_t sig1, sig2;
+
+	/* no need to hash the key of the last used entry. */
+	sig1 = 0;
+	sig2 = 0;
+	if (tbl->last == NULL || ip_frag_key_cmp(key, &tbl->last->key) != 0)
+		ip_frag_hash(key, &sig1, &sig2);
+
+	return ip_frag_find_hash(tbl, dr, key, sig1, sig2, tms);
+}
+
+/*
+ * Same as ip_frag_find(), with the hash values of the key already computed.
+ */
+struct ip_frag_pkt *
+ip_frag_find_hash(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, const struct ip_frag_key *key,
+	uint32_t sig1, uint32_t sig2, uint64_t tms)
 {
 	struct ip_frag_pkt *pkt, *free, *stale, *lru;
 	uint64_t max_cycles;
@@ -235,7 +264,25 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
 
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
+	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
+		pkt = tbl->last;
+	else
+		pkt = ip_frag_lookup(tbl, key, sig1, sig2, tms, &free, &stale);
+
+	if (pkt == NULL) {
+
+		/*
+		 * both lines are full of live entries, double the table
+		 * associativity if allowed: the first new entry of the
+		 * primary line is then free.
+		 */
+		if (free == NULL && stale == NULL &&
+				tbl->bucket_entries < tbl->max_bucket_entries &&
+				tbl->use_entries < tbl->max_entries) {
+			free = IP_FRAG_TBL_POS(tbl, sig1) + tbl->bucket_entries;
+			tbl->bucket_entries *= 2;
+			IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, grow_num, 1);
+		}
 
 		/*timed-out entry, free and invalidate it*/
 		if (stale != NULL) {
@@ -282,13 +329,13 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
 	struct ip_frag_pkt *p1, *p2;
 	struct ip_frag_pkt *empty, *old;
 	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
+	uint32_t i, assoc;
 
 	empty = NULL;
 	old = NULL;
@@ -296,15 +343,6 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	max_cycles = tbl->max_cycles;
 	assoc = tbl->bucket_entries;
 
-	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
-		return tbl->last;
-
-	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
-		ipv4_frag_hash(key, &sig1, &sig2);
-	else
-		ipv6_frag_hash(key, &sig1, &sig2);
-
 	p1 = IP_FRAG_TBL_POS(tbl, sig1);
 	p2 = IP_FRAG_TBL_POS(tbl, sig2);
 
@@ -366,3 +404,65 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	*stale = old;
 	return NULL;
 }
+
+/*
+ * Process a burst of parsed fragments: hash all keys and prefetch their
+ * table lines first, then lookup and process the fragments in order.
+ */
+uint16_t
+ip_frag_process_burst(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct ip_frag_desc *desc,
+	uint16_t nb_desc, uint64_t tms, struct rte_mbuf **out)
+{
+	struct ip_frag_pkt *fp, *p1, *p2;
+	struct rte_mbuf *mb;
+	uint32_t i, j, assoc;
+	uint16_t nb_out;
+
+	assoc = tbl->bucket_entries;
+
+	for (i = 0; i != nb_desc; i++) {
+		if (desc[i].mb == NULL || ip_frag_key_is_empty(&desc[i].key))
+			continue;
+
+		ip_frag_hash(&desc[i].key, &desc[i].sig1, &desc[i].sig2);
+
+		p1 = IP_FRAG_TBL_POS(tbl, desc[i].sig1);
+		p2 = IP_FRAG_TBL_POS(tbl, desc[i].sig2);
+		for (j = 0; j != assoc; j++) {
+			rte_prefetch0(p1 + j);
+			rte_prefetch0(p2 + j);
+		}
+	}
+
+	nb_out = 0;
+	for (i = 0; i != nb_desc; i++) {
+		mb = desc[i].mb;
+
+		/* dropped while parsing. */
+		if (mb == NULL)
+			continue;
+
+		/* not a fragment, pass it through. */
+		if (ip_frag_key_is_empty(&desc[i].key)) {
+			out[nb_out++] = mb;
+			continue;
+		}
+
+		fp = ip_frag_find_hash(tbl, dr, &desc[i].key, desc[i].sig1,
+				desc[i].sig2, tms);
+		if (fp == NULL) {
+			IP_FRAG_MBUF2DR(dr, mb);
+			continue;
+		}
+
+		mb = ip_frag_process(fp, dr, mb, desc[i].ofs, desc[i].len,
+				desc[i].more_frags);
+		ip_frag_inuse(tbl, fp);
+
+		if (mb != NULL)
+			out[nb_out++] = mb;
+	}
+
+	return nb_out;
+}
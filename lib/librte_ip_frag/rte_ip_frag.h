@@ -93,6 +93,7 @@ struct ip_frag_tbl_stat {
 	uint64_t reuse_num;     /**< # of reuse (del/add) ops. */
 	uint64_t fail_total;    /**< total # of add failures. */
 	uint64_t fail_nospace;  /**< # of 'no space' add failures. */
+	uint64_t grow_num;      /**< # of associativity growths. */
 } __rte_cache_aligned;
 
 /** fragmentation table */
@@ -106,6 +107,8 @@ struct rte_ip_frag_tbl {
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
 	struct ip_pkt_list lru;           /**< LRU list for table entries. */
+	/* in the padding before the cache aligned stat, keeps the layout */
+	uint32_t             max_bucket_entries; /**< max hash associativity. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
 	__extension__ struct ip_frag_pkt pkt[0]; /**< hash table. */
 };
@@ -136,6 +139,46 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create a new IP fragmentation table with growable associativity.
+ *
+ * The table starts with *bucket_entries* entries per bucket. When a new
+ * fragmented packet finds both of its buckets full of live entries, while
+ * the table is not full, the number of entries per bucket of the whole table
+ * is doubled, up to *max_bucket_entries*. The memory for the maximum
+ * associativity is allocated at creation time, and existing entries are
+ * not moved.
+ *
+ * @param bucket_num
+ *   Number of buckets in the hash table.
+ * @param bucket_entries
+ *   Initial number of entries per bucket (e.g. hash associativity).
+ *   Should be power of two.
+ * @param max_bucket_entries
+ *   Maximum number of entries per bucket.
+ *   Should be power of two, greater or equal to *bucket_entries*.
+ * @param max_entries
+ *   Maximum number of entries that could be stored in the table.
+ *   The value should be less or equal then
+ *   bucket_num * max_bucket_entries.
+ * @param max_cycles
+ *   Maximum TTL in cycles for each fragmented packet.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in the case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA constraints.
+ * @return
+ *   The pointer to the new allocated fragmentation table, on success.
+ *   NULL on error.
+ */
+__rte_experimental
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(uint32_t bucket_num, uint32_t bucket_entries,
+		uint32_t max_bucket_entries, uint32_t max_entries,
+		uint64_t max_cycles, int socket_id);
+
 /**
  * Free allocated IP fragmentation table.
  *
@@ -200,6 +243,44 @@ struct rte_mbuf *rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_mbuf *mb, uint64_t tms, struct rte_ipv6_hdr *ip_hdr,
 		struct ipv6_extension_fragment *frag_hdr);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * This function implements reassembly of a burst of fragmented IPv6 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ *
+ * The keys of all fragments are hashed and their table entries prefetched
+ * before the fragments are processed in order. Packets without a fragment
+ * header right after the fixed IPv6 header are not fragments, and are
+ * returned unmodified.
+ *
+ * Each fragment may put up to IP_MAX_FRAG_NUM + 1 mbufs on the death row.
+ * The function frees the death row whenever it has no room left for the
+ * next IP_FRAG_DEATH_ROW_LEN fragments, so that *nb_pkts* is not limited.
+ * On return, the death row holds up to IP_FRAG_DEATH_ROW_MBUF_LEN mbufs,
+ * and it should be freed before any other reassembly call with it.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to
+ * @param mb
+ *   Array of incoming mbufs. On return, it holds the reassembled packets
+ *   and the packets which are not fragments, in their order of completion.
+ * @param nb_pkts
+ *   Number of mbufs in the array.
+ * @param tms
+ *   Fragments arrival timestamp.
+ * @return
+ *   Number of packets returned in the *mb* array.
+ */
+__rte_experimental
+uint16_t
+rte_ipv6_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **mb,
+		uint16_t nb_pkts, uint64_t tms);
+
 /**
  * Return a pointer to the packet's fragment header, if found.
  * It only looks at the extension header that's right after the fixed IPv6
@@ -273,6 +354,43 @@ struct rte_mbuf * rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		struct rte_mbuf *mb, uint64_t tms, struct rte_ipv4_hdr *ip_hdr);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * This function implements reassembly of a burst of fragmented IPv4 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ *
+ * The keys of all fragments are hashed and their table entries prefetched
+ * before the fragments are processed in order. Packets which are not
+ * fragments are returned unmodified.
+ *
+ * Each fragment may put up to IP_MAX_FRAG_NUM + 1 mbufs on the death row.
+ * The function frees the death row whenever it has no room left for the
+ * next IP_FRAG_DEATH_ROW_LEN fragments, so that *nb_pkts* is not limited.
+ * On return, the death row holds up to IP_FRAG_DEATH_ROW_MBUF_LEN mbufs,
+ * and it should be freed before any other reassembly call with it.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to
+ * @param mb
+ *   Array of incoming mbufs. On return, it holds the reassembled packets
+ *   and the packets which are not fragments, in their order of completion.
+ * @param nb_pkts
+ *   Number of mbufs in the array.
+ * @param tms
+ *   Fragments arrival timestamp.
+ * @return
+ *   Number of packets returned in the *mb* array.
+ */
+__rte_experimental
+uint16_t
+rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **mb,
+		uint16_t nb_pkts, uint64_t tms);
+
 /**
  * Check if the IPv4 packet is fragmented
  *
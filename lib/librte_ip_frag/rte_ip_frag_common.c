@@ -40,17 +40,29 @@ rte_ip_frag_free_death_row(struct rte_ip_frag_death_row *dr,
 struct rte_ip_frag_tbl *
 rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	uint32_t max_entries, uint64_t max_cycles, int socket_id)
+{
+	return rte_ip_frag_table_create_ext(bucket_num, bucket_entries,
+		bucket_entries, max_entries, max_cycles, socket_id);
+}
+
+/* create fragmentation table with growable associativity */
+struct rte_ip_frag_tbl *
+rte_ip_frag_table_create_ext(uint32_t bucket_num, uint32_t bucket_entries,
+	uint32_t max_bucket_entries, uint32_t max_entries,
+	uint64_t max_cycles, int socket_id)
 {
 	struct rte_ip_frag_tbl *tbl;
 	size_t sz;
 	uint64_t nb_entries;
 
 	nb_entries = rte_align32pow2(bucket_num);
-	nb_entries *= bucket_entries;
+	nb_entries *= max_bucket_entries;
 	nb_entries *= IP_FRAG_HASH_FNUM;
 
 	/* check input parameters. */
 	if (rte_is_power_of_2(bucket_entries) == 0 ||
+			rte_is_power_of_2(max_bucket_entries) == 0 ||
+			max_bucket_entries < bucket_entries ||
 			nb_entries > UINT32_MAX || nb_entries == 0 ||
 			nb_entries < max_entries) {
 		RTE_LOG(ERR, USER1, "%s: invalid input parameter\n", __func__);
@@ -74,7 +86,8 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	tbl->nb_entries = (uint32_t)nb_entries;
 	tbl->nb_buckets = bucket_num;
 	tbl->bucket_entries = bucket_entries;
-	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->max_bucket_entries = max_bucket_entries;
+	tbl->entry_mask = (tbl->nb_entries - 1) & ~(max_bucket_entries - 1);
 
 	TAILQ_INIT(&(tbl->lru));
 	return tbl;
@@ -110,7 +123,8 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		"entries reused by timeout:\t%" PRIu64 ";\n"
 		"total add failures:\t%" PRIu64 ";\n"
 		"add no-space failures:\t%" PRIu64 ";\n"
-		"add hash-collisions failures:\t%" PRIu64 ";\n",
+		"add hash-collisions failures:\t%" PRIu64 ";\n"
+		"associativity growths:\t%" PRIu64 ";\n",
 		tbl->max_entries,
 		tbl->use_entries,
 		tbl->stat.find_num,
@@ -119,7 +133,8 @@ rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 		tbl->stat.reuse_num,
 		fail_total,
 		fail_nospace,
-		fail_total - fail_nospace);
+		fail_total - fail_nospace,
+		tbl->stat.grow_num);
 }
 
 /* Delete expired fragments */
@@ -171,3 +171,77 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Process a burst of mbufs with fragments of IPV4 packets.
+ */
+uint16_t
+rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **mb,
+	uint16_t nb_pkts, uint64_t tms)
+{
+	struct ip_frag_desc desc[IP_FRAG_BURST_SIZE];
+	struct rte_ipv4_hdr *ip_hdr;
+	struct rte_mbuf *m;
+	const unaligned_uint64_t *psd;
+	uint16_t flag_offset, i, j, n, nb_out;
+	int32_t ip_len;
+	int32_t trim;
+
+	nb_out = 0;
+	for (i = 0; i != nb_pkts; i += n) {
+		n = RTE_MIN(nb_pkts - i, IP_FRAG_BURST_SIZE);
+		ip_frag_dr_reserve(dr, n);
+
+		for (j = 0; j != n; j++)
+			rte_prefetch0(rte_pktmbuf_mtod_offset(mb[i + j], void *,
+				mb[i + j]->l2_len));
+
+		/* parse the headers and build the keys. */
+		for (j = 0; j != n; j++) {
+			m = mb[i + j];
+			desc[j].mb = m;
+
+			ip_hdr = rte_pktmbuf_mtod_offset(m,
+				struct rte_ipv4_hdr *, m->l2_len);
+			if (rte_ipv4_frag_pkt_is_fragmented(ip_hdr) == 0) {
+				ip_frag_key_invalidate(&desc[j].key);
+				continue;
+			}
+
+			flag_offset = rte_be_to_cpu_16(ip_hdr->fragment_offset);
+			desc[j].ofs = (uint16_t)(flag_offset &
+				RTE_IPV4_HDR_OFFSET_MASK) *
+				RTE_IPV4_HDR_OFFSET_UNITS;
+			desc[j].more_frags = (uint16_t)(flag_offset &
+				RTE_IPV4_HDR_MF_FLAG);
+
+			psd = (unaligned_uint64_t *)&ip_hdr->src_addr;
+			/* use first 8 bytes only */
+			desc[j].key.src_dst[0] = psd[0];
+			desc[j].key.id = ip_hdr->packet_id;
+			desc[j].key.key_len = IPV4_KEYLEN;
+
+			ip_len = rte_be_to_cpu_16(ip_hdr->total_length) -
+				m->l3_len;
+			trim = m->pkt_len - (ip_len + m->l3_len + m->l2_len);
+
+			/* check that fragment length is greater then zero. */
+			if (ip_len <= 0) {
+				IP_FRAG_MBUF2DR(dr, m);
+				desc[j].mb = NULL;
+				continue;
+			}
+
+			if (unlikely(trim > 0))
+				rte_pktmbuf_trim(m, trim);
+
+			desc[j].len = ip_len;
+		}
+
+		nb_out += ip_frag_process_burst(tbl, dr, desc, n, tms,
+			mb + nb_out);
+	}
+
+	return nb_out;
+}
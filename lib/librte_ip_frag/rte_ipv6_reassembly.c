@@ -216,3 +216,76 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Process a burst of mbufs with fragments of IPV6 datagrams.
+ */
+uint16_t
+rte_ipv6_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **mb,
+	uint16_t nb_pkts, uint64_t tms)
+{
+	struct ip_frag_desc desc[IP_FRAG_BURST_SIZE];
+	struct ipv6_extension_fragment *frag_hdr;
+	struct rte_ipv6_hdr *ip_hdr;
+	struct rte_mbuf *m;
+	uint16_t i, j, n, nb_out;
+	int32_t ip_len;
+	int32_t trim;
+
+	nb_out = 0;
+	for (i = 0; i != nb_pkts; i += n) {
+		n = RTE_MIN(nb_pkts - i, IP_FRAG_BURST_SIZE);
+		ip_frag_dr_reserve(dr, n);
+
+		for (j = 0; j != n; j++)
+			rte_prefetch0(rte_pktmbuf_mtod_offset(mb[i + j], void *,
+				mb[i + j]->l2_len));
+
+		/* parse the headers and build the keys. */
+		for (j = 0; j != n; j++) {
+			m = mb[i + j];
+			desc[j].mb = m;
+
+			ip_hdr = rte_pktmbuf_mtod_offset(m,
+				struct rte_ipv6_hdr *, m->l2_len);
+			frag_hdr =
+				rte_ipv6_frag_get_ipv6_fragment_header(ip_hdr);
+			if (frag_hdr == NULL) {
+				ip_frag_key_invalidate(&desc[j].key);
+				continue;
+			}
+
+			rte_memcpy(&desc[j].key.src_dst[0],
+				ip_hdr->src_addr, 16);
+			rte_memcpy(&desc[j].key.src_dst[2],
+				ip_hdr->dst_addr, 16);
+			desc[j].key.id = frag_hdr->id;
+			desc[j].key.key_len = IPV6_KEYLEN;
+
+			desc[j].ofs = FRAG_OFFSET(frag_hdr->frag_data) * 8;
+			desc[j].more_frags = MORE_FRAGS(frag_hdr->frag_data);
+
+			ip_len = rte_be_to_cpu_16(ip_hdr->payload_len) -
+				sizeof(*frag_hdr);
+			trim = m->pkt_len - (ip_len + m->l3_len + m->l2_len);
+
+			/* check that fragment length is greater then zero. */
+			if (ip_len <= 0) {
+				IP_FRAG_MBUF2DR(dr, m);
+				desc[j].mb = NULL;
+				continue;
+			}
+
+			if (unlikely(trim > 0))
+				rte_pktmbuf_trim(m, trim);
+
+			desc[j].len = ip_len;
+		}
+
+		nb_out += ip_frag_process_burst(tbl, dr, desc, n, tms,
+			mb + nb_out);
+	}
+
+	return nb_out;
+}
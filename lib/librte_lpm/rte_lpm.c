@@ -23,6 +23,8 @@
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 #include <rte_tailq.h>
+#include <rte_hash.h>
+#include <rte_jhash.h>
 
 #include "rte_lpm.h"
 
@@ -34,6 +36,7 @@ static struct rte_tailq_elem rte_lpm_tailq = {
 EAL_REGISTER_TAILQ(rte_lpm_tailq)
 
 #define MAX_DEPTH_TBL24 24
+#define RULE_HASH_TABLE_EXTRA_SPACE 64
 
 enum valid_flag {
 	INVALID = 0,
@@ -46,6 +49,12 @@ struct rte_lpm_rule {
 	uint32_t next_hop; /**< Rule next hop. */
 };
 
+/** @internal Key of the rule index hash table. */
+struct rte_lpm_rule_key {
+	uint32_t ip; /**< Rule IP address. */
+	uint32_t depth; /**< Rule depth. */
+};
+
 /** @internal Contains metadata about the rules table. */
 struct rte_lpm_rule_info {
 	uint32_t used_rules; /**< Used rules so far. */
@@ -64,6 +73,10 @@ struct __rte_lpm {
 	/**< Rule info table. */
 	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH];
 	struct rte_lpm_rule *rules_tbl; /**< LPM rules. */
+	struct rte_hash *rules_idx; /**< Index of rules_tbl by ip and depth. */
+	uint32_t *tbl8_pool; /**< Stack of free tbl8 group indexes. */
+	uint32_t tbl8_pool_pos; /**< Number of tbl8 groups in use. */
+	rte_spinlock_t lock; /**< Serializes the writers. */
 
 	/* RCU config. */
 	struct rte_rcu_qsbr *v;		/* RCU QSBR variable. */
@@ -118,6 +131,61 @@ depth_to_range(uint8_t depth)
 	return 1 << (RTE_LPM_MAX_DEPTH - depth);
 }
 
+/*
+ * Rule index hash function.
+ */
+static inline uint32_t
+rule_hash(const void *data, __rte_unused uint32_t data_len,
+		uint32_t init_val)
+{
+	const struct rte_lpm_rule_key *key = data;
+
+	return rte_jhash_1word(key->ip, init_val + key->depth);
+}
+
+/*
+ * Set the position of a rule in the rule table.
+ */
+static inline int
+rule_idx_set(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
+		uint32_t rule_index)
+{
+	struct rte_lpm_rule_key key = {
+		.ip = ip_masked,
+		.depth = depth,
+	};
+
+	return rte_hash_add_key_data(i_lpm->rules_idx, &key,
+			(void *)(uintptr_t)rule_index);
+}
+
+/*
+ * Init pool of free tbl8 indexes.
+ */
+static void
+tbl8_pool_init(struct __rte_lpm *i_lpm)
+{
+	uint32_t i;
+
+	for (i = 0; i < i_lpm->number_tbl8s; i++)
+		i_lpm->tbl8_pool[i] = i;
+
+	i_lpm->tbl8_pool_pos = 0;
+}
+
+/*
+ * Put the index of a tbl8 group back in the pool.
+ */
+static inline void
+tbl8_put(struct __rte_lpm *i_lpm, uint32_t tbl8_group_index)
+{
+	/* Guard against a group released twice */
+	if (i_lpm->tbl8_pool_pos == 0)
+		return;
+
+	i_lpm->tbl8_pool[--i_lpm->tbl8_pool_pos] = tbl8_group_index;
+}
+
 /*
  * Find an existing lpm table and return a pointer to it.
  */
@@ -159,6 +227,8 @@ rte_lpm_create(const char *name, int socket_id,
 	struct rte_tailq_entry *te;
 	uint32_t mem_size, rules_size, tbl8s_size;
 	struct rte_lpm_list *lpm_list;
+	struct rte_hash *rules_idx;
+	uint32_t *tbl8_pool;
 
 	lpm_list = RTE_TAILQ_CAST(rte_lpm_tailq.head, rte_lpm_list);
 
@@ -171,6 +241,34 @@ rte_lpm_create(const char *name, int socket_id,
 		return NULL;
 	}
 
+	/* Create the rule index before taking the lock, it takes it too. */
+	snprintf(mem_name, sizeof(mem_name), "LRH4_%s", name);
+	struct rte_hash_parameters rule_hash_tbl_params = {
+		.entries = config->max_rules * 1.2 +
+			RULE_HASH_TABLE_EXTRA_SPACE,
+		.key_len = sizeof(struct rte_lpm_rule_key),
+		.hash_func = rule_hash,
+		.hash_func_init_val = 0,
+		.name = mem_name,
+		.socket_id = socket_id,
+	};
+
+	rules_idx = rte_hash_create(&rule_hash_tbl_params);
+	if (rules_idx == NULL) {
+		RTE_LOG(ERR, LPM, "LPM rules hash table allocation failed\n");
+		return NULL;
+	}
+
+	tbl8_pool = rte_malloc_socket(NULL,
+			sizeof(uint32_t) * config->number_tbl8s,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (tbl8_pool == NULL) {
+		RTE_LOG(ERR, LPM, "LPM tbl8 pool allocation failed\n");
+		rte_hash_free(rules_idx);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
 	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
 
 	rte_mcfg_tailq_write_lock();
@@ -241,6 +339,11 @@ rte_lpm_create(const char *name, int socket_id,
 	i_lpm->number_tbl8s = config->number_tbl8s;
 	strlcpy(i_lpm->name, name, sizeof(i_lpm->name));
 
+	i_lpm->rules_idx = rules_idx;
+	i_lpm->tbl8_pool = tbl8_pool;
+	tbl8_pool_init(i_lpm);
+	rte_spinlock_init(&i_lpm->lock);
+
 	te->data = i_lpm;
 	lpm = &i_lpm->lpm;
 
@@ -249,6 +352,11 @@ rte_lpm_create(const char *name, int socket_id,
 exit:
 	rte_mcfg_tailq_write_unlock();
 
+	if (lpm == NULL) {
+		rte_free(tbl8_pool);
+		rte_hash_free(rules_idx);
+	}
+
 	return lpm;
 }
 
@@ -284,6 +392,8 @@ rte_lpm_free(struct rte_lpm *lpm)
 	if (i_lpm->dq != NULL)
 		rte_rcu_qsbr_dq_delete(i_lpm->dq);
 	rte_free(i_lpm->lpm.tbl8);
+	rte_free(i_lpm->tbl8_pool);
+	rte_hash_free(i_lpm->rules_idx);
 	rte_free(i_lpm->rules_tbl);
 	rte_free(i_lpm);
 	rte_free(te);
@@ -292,14 +402,16 @@ rte_lpm_free(struct rte_lpm *lpm)
 static void
 __lpm_rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
 {
-	struct rte_lpm_tbl_entry *tbl8 = ((struct __rte_lpm *)p)->lpm.tbl8;
+	struct __rte_lpm *i_lpm = p;
+	struct rte_lpm_tbl_entry *tbl8 = i_lpm->lpm.tbl8;
 	struct rte_lpm_tbl_entry zero_tbl8_entry = {0};
-	uint32_t tbl8_group_index = *(uint32_t *)data;
+	uint32_t tbl8_group_start = *(uint32_t *)data;
 
 	RTE_SET_USED(n);
-	/* Set tbl8 group invalid */
-	__atomic_store(&tbl8[tbl8_group_index], &zero_tbl8_entry,
+	/* Set tbl8 group invalid and make it available again */
+	__atomic_store(&tbl8[tbl8_group_start], &zero_tbl8_entry,
 		__ATOMIC_RELAXED);
+	tbl8_put(i_lpm, tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 }
 
 /* Associate QSBR variable with an LPM object.
@@ -355,6 +467,31 @@ rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, struct rte_lpm_rcu_config *cfg)
 	return 0;
 }
 
+/*
+ * Finds a rule in rule table.
+ * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ */
+static int32_t
+rule_find(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth)
+{
+	struct rte_lpm_rule_key key = {
+		.ip = ip_masked,
+		.depth = depth,
+	};
+	void *rule_index;
+
+	VERIFY_DEPTH(depth);
+
+	/* If rule is not found return -EINVAL. */
+	if (rte_hash_lookup_data(i_lpm->rules_idx, &key, &rule_index) < 0)
+		return -EINVAL;
+
+	return (int32_t)(uintptr_t)rule_index;
+}
+
+static void
+rule_delete(struct __rte_lpm *i_lpm, int32_t rule_index, uint8_t depth);
+
 /*
  * Adds a rule to the rule table.
  *
@@ -369,34 +506,25 @@ static int32_t
 rule_add(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
 	uint32_t next_hop)
 {
-	uint32_t rule_gindex, rule_index, last_rule;
+	uint32_t rule_index, moved;
+	int32_t existing;
 	int i;
 
 	VERIFY_DEPTH(depth);
 
-	/* Scan through rule group to see if rule already exists. */
-	if (i_lpm->rule_info[depth - 1].used_rules > 0) {
-
-		/* rule_gindex stands for rule group index. */
-		rule_gindex = i_lpm->rule_info[depth - 1].first_rule;
-		/* Initialise rule_index to point to start of rule group. */
-		rule_index = rule_gindex;
-		/* Last rule = Last used rule in this rule group. */
-		last_rule = rule_gindex + i_lpm->rule_info[depth - 1].used_rules;
-
-		for (; rule_index < last_rule; rule_index++) {
-
-			/* If rule already exists update next hop and return. */
-			if (i_lpm->rules_tbl[rule_index].ip == ip_masked) {
+	/* If rule already exists update next hop and return. */
+	existing = rule_find(i_lpm, ip_masked, depth);
+	if (existing >= 0) {
+		if (i_lpm->rules_tbl[existing].next_hop == next_hop)
+			return -EEXIST;
+		i_lpm->rules_tbl[existing].next_hop = next_hop;
 
-				if (i_lpm->rules_tbl[rule_index].next_hop
-						== next_hop)
-					return -EEXIST;
-				i_lpm->rules_tbl[rule_index].next_hop = next_hop;
+		return existing;
+	}
 
-				return rule_index;
-			}
-		}
+	if (i_lpm->rule_info[depth - 1].used_rules > 0) {
+		rule_index = i_lpm->rule_info[depth - 1].first_rule +
+				i_lpm->rule_info[depth - 1].used_rules;
 
 		if (rule_index == i_lpm->max_rules)
 			return -ENOSPC;
@@ -424,9 +552,12 @@ rule_add(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
 			return -ENOSPC;
 
 		if (i_lpm->rule_info[i - 1].used_rules > 0) {
-			i_lpm->rules_tbl[i_lpm->rule_info[i - 1].first_rule
-				+ i_lpm->rule_info[i - 1].used_rules]
+			moved = i_lpm->rule_info[i - 1].first_rule
+				+ i_lpm->rule_info[i - 1].used_rules;
+			i_lpm->rules_tbl[moved]
 					= i_lpm->rules_tbl[i_lpm->rule_info[i - 1].first_rule];
+			rule_idx_set(i_lpm, i_lpm->rules_tbl[moved].ip, i,
+					moved);
 			i_lpm->rule_info[i - 1].first_rule++;
 		}
 	}
@@ -438,6 +569,11 @@ rule_add(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
 	/* Increment the used rules counter for this rule group. */
 	i_lpm->rule_info[depth - 1].used_rules++;
 
+	if (rule_idx_set(i_lpm, ip_masked, depth, rule_index) < 0) {
+		rule_delete(i_lpm, rule_index, depth);
+		return -ENOSPC;
+	}
+
 	return rule_index;
 }
 
@@ -448,19 +584,33 @@ rule_add(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
 static void
 rule_delete(struct __rte_lpm *i_lpm, int32_t rule_index, uint8_t depth)
 {
+	struct rte_lpm_rule_key key = {
+		.ip = i_lpm->rules_tbl[rule_index].ip,
+		.depth = depth,
+	};
+	uint32_t last;
 	int i;
 
 	VERIFY_DEPTH(depth);
 
-	i_lpm->rules_tbl[rule_index] =
-			i_lpm->rules_tbl[i_lpm->rule_info[depth - 1].first_rule
-			+ i_lpm->rule_info[depth - 1].used_rules - 1];
+	rte_hash_del_key(i_lpm->rules_idx, &key);
+
+	last = i_lpm->rule_info[depth - 1].first_rule
+			+ i_lpm->rule_info[depth - 1].used_rules - 1;
+	if ((uint32_t)rule_index != last) {
+		i_lpm->rules_tbl[rule_index] = i_lpm->rules_tbl[last];
+		rule_idx_set(i_lpm, i_lpm->rules_tbl[rule_index].ip, depth,
+				rule_index);
+	}
 
 	for (i = depth; i < RTE_LPM_MAX_DEPTH; i++) {
 		if (i_lpm->rule_info[i].used_rules > 0) {
+			last = i_lpm->rule_info[i].first_rule
+					+ i_lpm->rule_info[i].used_rules - 1;
 			i_lpm->rules_tbl[i_lpm->rule_info[i].first_rule - 1] =
-					i_lpm->rules_tbl[i_lpm->rule_info[i].first_rule
-						+ i_lpm->rule_info[i].used_rules - 1];
+					i_lpm->rules_tbl[last];
+			rule_idx_set(i_lpm, i_lpm->rules_tbl[last].ip, i + 1,
+					i_lpm->rule_info[i].first_rule - 1);
 			i_lpm->rule_info[i].first_rule--;
 		}
 	}
@@ -468,31 +618,6 @@ rule_delete(struct __rte_lpm *i_lpm, int32_t rule_index, uint8_t depth)
 	i_lpm->rule_info[depth - 1].used_rules--;
 }
 
-/*
- * Finds a rule in rule table.
- * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
- */
-static int32_t
-rule_find(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth)
-{
-	uint32_t rule_gindex, last_rule, rule_index;
-
-	VERIFY_DEPTH(depth);
-
-	rule_gindex = i_lpm->rule_info[depth - 1].first_rule;
-	last_rule = rule_gindex + i_lpm->rule_info[depth - 1].used_rules;
-
-	/* Scan used rules at given depth to find rule. */
-	for (rule_index = rule_gindex; rule_index < last_rule; rule_index++) {
-		/* If rule is found return the rule index. */
-		if (i_lpm->rules_tbl[rule_index].ip == ip_masked)
-			return rule_index;
-	}
-
-	/* If rule is not found return -EINVAL. */
-	return -EINVAL;
-}
-
 /*
  * Find, clean and allocate a tbl8.
  */
@@ -501,34 +626,31 @@ _tbl8_alloc(struct __rte_lpm *i_lpm)
 {
 	uint32_t group_idx; /* tbl8 group index. */
 	struct rte_lpm_tbl_entry *tbl8_entry;
+	struct rte_lpm_tbl_entry new_tbl8_entry = {
+		.next_hop = 0,
+		.valid = INVALID,
+		.depth = 0,
+		.valid_group = VALID,
+	};
 
-	/* Scan through tbl8 to find a free (i.e. INVALID) tbl8 group. */
-	for (group_idx = 0; group_idx < i_lpm->number_tbl8s; group_idx++) {
-		tbl8_entry = &i_lpm->lpm.tbl8[group_idx *
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
-		/* If a free tbl8 group is found clean it and set as VALID. */
-		if (!tbl8_entry->valid_group) {
-			struct rte_lpm_tbl_entry new_tbl8_entry = {
-				.next_hop = 0,
-				.valid = INVALID,
-				.depth = 0,
-				.valid_group = VALID,
-			};
+	/* If there are no tbl8 groups free then return error. */
+	if (i_lpm->tbl8_pool_pos == i_lpm->number_tbl8s)
+		return -ENOSPC;
 
-			memset(&tbl8_entry[0], 0,
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
-					sizeof(tbl8_entry[0]));
+	/* Take a free tbl8 group from the pool, clean it and set as VALID. */
+	group_idx = i_lpm->tbl8_pool[i_lpm->tbl8_pool_pos++];
+	tbl8_entry = &i_lpm->lpm.tbl8[group_idx *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
 
-			__atomic_store(tbl8_entry, &new_tbl8_entry,
-					__ATOMIC_RELAXED);
+	memset(&tbl8_entry[0], 0,
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+			sizeof(tbl8_entry[0]));
 
-			/* Return group index for allocated tbl8 group. */
-			return group_idx;
-		}
-	}
+	__atomic_store(tbl8_entry, &new_tbl8_entry,
+			__ATOMIC_RELAXED);
 
-	/* If there are no tbl8 groups free then return error. */
-	return -ENOSPC;
+	/* Return group index for allocated tbl8 group. */
+	return group_idx;
 }
 
 static int32_t
@@ -557,6 +679,8 @@ tbl8_free(struct __rte_lpm *i_lpm, uint32_t tbl8_group_start)
 		/* Set tbl8 group invalid*/
 		__atomic_store(&i_lpm->lpm.tbl8[tbl8_group_start], &zero_tbl8_entry,
 				__ATOMIC_RELAXED);
+		tbl8_put(i_lpm,
+			tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 	} else if (i_lpm->rcu_mode == RTE_LPM_QSBR_MODE_SYNC) {
 		/* Wait for quiescent state change. */
 		rte_rcu_qsbr_synchronize(i_lpm->v,
@@ -564,6 +688,8 @@ tbl8_free(struct __rte_lpm *i_lpm, uint32_t tbl8_group_start)
 		/* Set tbl8 group invalid*/
 		__atomic_store(&i_lpm->lpm.tbl8[tbl8_group_start], &zero_tbl8_entry,
 				__ATOMIC_RELAXED);
+		tbl8_put(i_lpm,
+			tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 	} else if (i_lpm->rcu_mode == RTE_LPM_QSBR_MODE_DQ) {
 		/* Push into QSBR defer queue. */
 		status = rte_rcu_qsbr_dq_enqueue(i_lpm->dq,
@@ -799,22 +925,13 @@ add_depth_big(struct __rte_lpm *i_lpm, uint32_t ip_masked, uint8_t depth,
 	return 0;
 }
 
-/*
- * Add a route
- */
-int
-rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+static int32_t
+lpm_add(struct __rte_lpm *i_lpm, uint32_t ip, uint8_t depth,
 		uint32_t next_hop)
 {
 	int32_t rule_index, status = 0;
-	struct __rte_lpm *i_lpm;
 	uint32_t ip_masked;
 
-	/* Check user arguments. */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
-		return -EINVAL;
-
-	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
 	ip_masked = ip & depth_to_mask(depth);
 
 	/* Add the rule to the rule table. */
@@ -850,6 +967,93 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 	return 0;
 }
 
+/*
+ * Add a route
+ */
+int
+rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+		uint32_t next_hop)
+{
+	struct __rte_lpm *i_lpm;
+	int32_t status;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
+		return -EINVAL;
+
+	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	rte_spinlock_lock(&i_lpm->lock);
+	status = lpm_add(i_lpm, ip, depth, next_hop);
+	rte_spinlock_unlock(&i_lpm->lock);
+
+	return status;
+}
+
+/*
+ * Add a batch of routes
+ */
+int
+rte_lpm_add_bulk(struct rte_lpm *lpm, const uint32_t *ips,
+		const uint8_t *depths, const uint32_t *next_hops,
+		unsigned int n)
+{
+	uint32_t first[RTE_LPM_MAX_DEPTH + 1] = {0};
+	struct __rte_lpm *i_lpm;
+	uint32_t *order;
+	unsigned int i, added = 0;
+	int32_t status;
+	int d;
+
+	/* Check user arguments. */
+	if (lpm == NULL || ips == NULL || depths == NULL || next_hops == NULL)
+		return -EINVAL;
+	for (i = 0; i < n; i++) {
+		if (depths[i] < 1 || depths[i] > RTE_LPM_MAX_DEPTH)
+			return -EINVAL;
+		first[depths[i]]++;
+	}
+	if (n == 0)
+		return 0;
+
+	order = rte_malloc(NULL, sizeof(*order) * n, 0);
+	if (order == NULL)
+		return -ENOMEM;
+
+	/*
+	 * Add the longest prefixes first: the entries they own are then
+	 * skipped when shorter covering prefixes are added instead of being
+	 * written twice, and no tbl8 group gets filled from a tbl24 value
+	 * about to change. Counting sort keeps routes of the same depth in
+	 * input order, so the last duplicate still wins.
+	 */
+	for (d = RTE_LPM_MAX_DEPTH, i = 0; d > 0; d--) {
+		uint32_t cnt = first[d];
+
+		first[d] = i;
+		i += cnt;
+	}
+	for (i = 0; i < n; i++)
+		order[first[depths[i]]++] = i;
+
+	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	rte_spinlock_lock(&i_lpm->lock);
+	for (i = 0; i < n; i++) {
+		status = lpm_add(i_lpm, ips[order[i]], depths[order[i]],
+				next_hops[order[i]]);
+		if (status < 0)
+			rte_errno = -status;
+		else
+			added++;
+	}
+	rte_spinlock_unlock(&i_lpm->lock);
+
+	rte_free(order);
+
+	return added;
+}
+
 /*
  * Look for a rule in the high-level rules table
  */
@@ -870,12 +1074,15 @@ uint32_t *next_hop)
 	/* Look for the rule using rule_find. */
 	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
 	ip_masked = ip & depth_to_mask(depth);
-	rule_index = rule_find(i_lpm, ip_masked, depth);
 
-	if (rule_index >= 0) {
+	rte_spinlock_lock(&i_lpm->lock);
+	rule_index = rule_find(i_lpm, ip_masked, depth);
+	if (rule_index >= 0)
 		*next_hop = i_lpm->rules_tbl[rule_index].next_hop;
+	rte_spinlock_unlock(&i_lpm->lock);
+
+	if (rule_index >= 0)
 		return 1;
-	}
 
 	/* If rule is not found return 0. */
 	return 0;
@@ -1143,25 +1350,13 @@ delete_depth_big(struct __rte_lpm *i_lpm, uint32_t ip_masked,
 	return status;
 }
 
-/*
- * Deletes a rule
- */
-int
-rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
+static int32_t
+lpm_delete(struct __rte_lpm *i_lpm, uint32_t ip, uint8_t depth)
 {
 	int32_t rule_to_delete_index, sub_rule_index;
-	struct __rte_lpm *i_lpm;
 	uint32_t ip_masked;
 	uint8_t sub_rule_depth;
-	/*
-	 * Check input arguments. Note: IP must be a positive integer of 32
-	 * bits in length therefore it need not be checked.
-	 */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH)) {
-		return -EINVAL;
-	}
 
-	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
 	ip_masked = ip & depth_to_mask(depth);
 
 	/*
@@ -1201,6 +1396,31 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 	}
 }
 
+/*
+ * Deletes a rule
+ */
+int
+rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
+{
+	struct __rte_lpm *i_lpm;
+	int32_t status;
+	/*
+	 * Check input arguments. Note: IP must be a positive integer of 32
+	 * bits in length therefore it need not be checked.
+	 */
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH)) {
+		return -EINVAL;
+	}
+
+	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	rte_spinlock_lock(&i_lpm->lock);
+	status = lpm_delete(i_lpm, ip, depth);
+	rte_spinlock_unlock(&i_lpm->lock);
+
+	return status;
+}
+
 /*
  * Delete all rules from the LPM table.
  */
@@ -1210,6 +1430,18 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	struct __rte_lpm *i_lpm;
 
 	i_lpm = container_of(lpm, struct __rte_lpm, lpm);
+
+	rte_spinlock_lock(&i_lpm->lock);
+	/*
+	 * Release the tbl8 groups waiting in the defer queue before the pool
+	 * is reset, they would otherwise be put back later while in use.
+	 */
+	if (i_lpm->dq != NULL) {
+		rte_rcu_qsbr_synchronize(i_lpm->v, RTE_QSBR_THRID_INVALID);
+		rte_rcu_qsbr_dq_reclaim(i_lpm->dq, i_lpm->number_tbl8s,
+				NULL, NULL, NULL);
+	}
+
 	/* Zero rule information. */
 	memset(i_lpm->rule_info, 0, sizeof(i_lpm->rule_info));
 
@@ -1220,6 +1452,11 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	memset(i_lpm->lpm.tbl8, 0, sizeof(i_lpm->lpm.tbl8[0])
 			* RTE_LPM_TBL8_GROUP_NUM_ENTRIES * i_lpm->number_tbl8s);
 
+	/* All tbl8 groups are free again. */
+	tbl8_pool_init(i_lpm);
+
 	/* Delete all rules form the rules table. */
 	memset(i_lpm->rules_tbl, 0, sizeof(i_lpm->rules_tbl[0]) * i_lpm->max_rules);
+	rte_hash_reset(i_lpm->rules_idx);
+	rte_spinlock_unlock(&i_lpm->lock);
 }
@@ -213,6 +213,9 @@ int rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, struct rte_lpm_rcu_config *cfg);
 /**
  * Add a rule to the LPM table.
  *
+ * Rule updates are serialized inside the LPM object, so several threads may
+ * add and delete rules concurrently.
+ *
  * @param lpm
  *   LPM object handle
  * @param ip
@@ -227,6 +230,39 @@ int rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, struct rte_lpm_rcu_config *cfg);
 int
 rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint32_t next_hop);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add a batch of rules to the LPM table.
+ *
+ * The rules are added longest prefix first, so table entries covered by a
+ * more specific rule of the batch are written only once, and the writer lock
+ * is taken once for the whole batch. If the same prefix appears several
+ * times, the last next hop given for it is kept.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param ips
+ *   IPs of the rules to be added to the LPM table
+ * @param depths
+ *   Depths of the rules to be added to the LPM table
+ * @param next_hops
+ *   Next hops of the rules to be added to the LPM table
+ * @param n
+ *   Number of rules to add
+ * @return
+ *   Number of rules added, or a negative value if the arguments are invalid
+ *   or memory could not be allocated, in which case no rule is added.
+ *   If less than n, the rules that could not be added were skipped and
+ *   rte_errno is set to the reason of the last failure, e.g. ENOSPC.
+ */
+__rte_experimental
+int
+rte_lpm_add_bulk(struct rte_lpm *lpm, const uint32_t *ips,
+		const uint8_t *depths, const uint32_t *next_hops,
+		unsigned int n);
+
 /**
  * Check if a rule is present in the LPM table,
  * and provide its next hop if it is.
@@ -263,6 +299,9 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth);
 
 /**
  * Delete all rules from the LPM table.
+ * With a RCU QSBR variable attached in RTE_LPM_QSBR_MODE_DQ mode, waits for
+ * the readers to report a quiescent state, so as to release the tbl8
+ * groups left in the defer queue.
  *
  * @param lpm
  *   LPM object handle
@@ -46,6 +46,24 @@ EAL_REGISTER_TAILQ(rte_mempool_tailq)
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
 
+/* number of refills and flushes of a cache between two resizes */
+#define CACHE_ADAPT_PERIOD 32
+/* size of the ring of objects returned to an lcore by its peers */
+#define CACHE_RET_RING_SIZE (RTE_MEMPOOL_CACHE_MAX_SIZE * 4)
+
+/* adaptive sizing and peer return state of a default cache */
+struct mempool_lcore_ctl {
+	struct rte_ring *ret_ring;  /* objects returned by peers */
+	struct rte_ring *peer_ring; /* return ring of the peer, or NULL */
+	uint32_t refills;           /* refills since last resize */
+	uint32_t flushes;           /* flushes since last resize */
+} __rte_cache_aligned;
+
+struct rte_mempool_cache_ctl {
+	uint32_t max_size; /* adaptive sizing maximum, 0 if disabled */
+	struct mempool_lcore_ctl lcore[RTE_MAX_LCORE];
+};
+
 #if defined(RTE_ARCH_X86)
 /*
  * return the greatest common divisor between a and b (fast algorithm)
@@ -698,6 +716,22 @@ rte_mempool_populate_anon(struct rte_mempool *mp)
 	return 0;
 }
 
+/* free the adaptive sizing and peer return state of the default caches */
+static void
+mempool_cache_ctl_free(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache_ctl *ctl = mp->cache_ctl;
+	unsigned int lcore_id;
+
+	if (ctl == NULL)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		rte_free(ctl->lcore[lcore_id].ret_ring);
+	rte_free(ctl);
+	mp->cache_ctl = NULL;
+}
+
 /* free a mempool */
 void
 rte_mempool_free(struct rte_mempool *mp)
@@ -725,14 +759,21 @@ rte_mempool_free(struct rte_mempool *mp)
 	rte_mempool_trace_free(mp);
 	rte_mempool_free_memchunks(mp);
 	rte_mempool_ops_free(mp);
+	mempool_cache_ctl_free(mp);
 	rte_memzone_free(mp->mz);
 }
 
 static void
-mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
+mempool_cache_resize(struct rte_mempool_cache *cache, uint32_t size)
 {
 	cache->size = size;
 	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+}
+
+static void
+mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
+{
+	mempool_cache_resize(cache, size);
 	cache->len = 0;
 }
 
@@ -777,6 +818,217 @@ rte_mempool_cache_free(struct rte_mempool_cache *cache)
 	rte_free(cache);
 }
 
+/* get the state of a default cache, NULL for a user-owned cache */
+static struct mempool_lcore_ctl *
+mempool_lcore_ctl(const struct rte_mempool *mp,
+	struct rte_mempool_cache_ctl *ctl,
+	const struct rte_mempool_cache *cache)
+{
+	uintptr_t ofs = (uintptr_t)cache - (uintptr_t)mp->local_cache;
+
+	if (ofs >= sizeof(*cache) * RTE_MAX_LCORE)
+		return NULL;
+	return &ctl->lcore[ofs / sizeof(*cache)];
+}
+
+/*
+ * Resize a default cache, on its lcore. A cache used only to get, or only
+ * to put, objects grows so that it accesses the common pool in larger
+ * bulks; a cache used for both shrinks back to the default size.
+ */
+static void
+mempool_cache_adapt(struct rte_mempool *mp, struct rte_mempool_cache_ctl *ctl,
+	struct mempool_lcore_ctl *lc, struct rte_mempool_cache *cache)
+{
+	uint32_t max_size = __atomic_load_n(&ctl->max_size, __ATOMIC_RELAXED);
+	uint32_t events = lc->refills + lc->flushes;
+	uint32_t size = cache->size;
+
+	if (max_size == 0) {
+		size = mp->cache_size;
+	} else if (events < CACHE_ADAPT_PERIOD) {
+		size = RTE_MIN(size, max_size);
+	} else {
+		/* at least 7/8 of the events are of the same kind */
+		if (lc->refills * 8 >= events * 7 ||
+				lc->flushes * 8 >= events * 7)
+			size = RTE_MIN(size * 2, max_size);
+		else
+			size = RTE_MAX(size / 2, mp->cache_size);
+		lc->refills = 0;
+		lc->flushes = 0;
+	}
+
+	if (size != cache->size)
+		mempool_cache_resize(cache, size);
+}
+
+/* refill a cache, from its return ring first */
+int
+__rte_mempool_cache_refill(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache, unsigned int req)
+{
+	struct rte_mempool_cache_ctl *ctl = mp->cache_ctl;
+	struct mempool_lcore_ctl *lc = mempool_lcore_ctl(mp, ctl, cache);
+	void **objs = &cache->objs[cache->len];
+	struct rte_ring *r;
+	unsigned int n = 0;
+	int ret;
+
+	if (lc == NULL)
+		return rte_mempool_ops_dequeue_bulk(mp, objs, req);
+
+	r = __atomic_load_n(&lc->ret_ring, __ATOMIC_ACQUIRE);
+	if (r != NULL)
+		n = rte_ring_dequeue_burst(r, objs, req, NULL);
+
+	if (n < req) {
+		ret = rte_mempool_ops_dequeue_bulk(mp, &objs[n], req - n);
+		if (unlikely(ret < 0)) {
+			if (n != 0)
+				rte_mempool_ops_enqueue_bulk(mp, objs, n);
+			return ret;
+		}
+	}
+
+	lc->refills++;
+	mempool_cache_adapt(mp, ctl, lc, cache);
+	return 0;
+}
+
+/* flush the excess objects of a cache, to the return ring of its peer */
+void
+__rte_mempool_cache_flush_excess(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache)
+{
+	struct rte_mempool_cache_ctl *ctl = mp->cache_ctl;
+	struct mempool_lcore_ctl *lc = mempool_lcore_ctl(mp, ctl, cache);
+	void **objs = &cache->objs[cache->size];
+	unsigned int n = cache->len - cache->size;
+	unsigned int sent = 0;
+	struct rte_ring *r;
+
+	if (lc != NULL) {
+		r = __atomic_load_n(&lc->peer_ring, __ATOMIC_ACQUIRE);
+		if (r != NULL)
+			sent = rte_ring_enqueue_burst(r, objs, n, NULL);
+	}
+
+	if (sent < n)
+		rte_mempool_ops_enqueue_bulk(mp, &objs[sent], n - sent);
+	cache->len = cache->size;
+
+	if (lc != NULL) {
+		lc->flushes++;
+		mempool_cache_adapt(mp, ctl, lc, cache);
+	}
+}
+
+/* allocate the adaptive sizing and peer return state, with mempool lock */
+static struct rte_mempool_cache_ctl *
+mempool_cache_ctl_get(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache_ctl *ctl = mp->cache_ctl;
+
+	if (ctl != NULL)
+		return ctl;
+
+	ctl = rte_zmalloc_socket("MEMPOOL_CACHE_CTL", sizeof(*ctl),
+		RTE_CACHE_LINE_SIZE, mp->socket_id);
+	if (ctl == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate cache control\n");
+		return NULL;
+	}
+
+	/* the datapath may see the state as soon as it is set */
+	__atomic_store_n(&mp->cache_ctl, ctl, __ATOMIC_RELEASE);
+	return ctl;
+}
+
+/* enable or disable the adaptive sizing of the default caches */
+int
+rte_mempool_cache_adapt_set(struct rte_mempool *mp, uint32_t max_size)
+{
+	struct rte_mempool_cache_ctl *ctl;
+
+	if (mp->cache_size == 0 ||
+	    (max_size != 0 && (max_size < mp->cache_size ||
+	     max_size > RTE_MEMPOOL_CACHE_MAX_SIZE ||
+	     CALC_CACHE_FLUSHTHRESH(max_size) > mp->size)))
+		return -EINVAL;
+
+	rte_mcfg_mempool_write_lock();
+	ctl = mempool_cache_ctl_get(mp);
+	if (ctl != NULL)
+		__atomic_store_n(&ctl->max_size, max_size, __ATOMIC_RELAXED);
+	rte_mcfg_mempool_write_unlock();
+
+	return ctl != NULL ? 0 : -ENOMEM;
+}
+
+/* hand the objects flushed by an lcore to another lcore */
+int
+rte_mempool_cache_peer_set(struct rte_mempool *mp, unsigned int lcore_id,
+	unsigned int peer_lcore_id)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_mempool_cache_ctl *ctl;
+	struct mempool_lcore_ctl *peer;
+	struct rte_ring *r = NULL;
+	ssize_t ring_size;
+	int ret = 0;
+
+	if (mp->cache_size == 0 || lcore_id >= RTE_MAX_LCORE ||
+	    (peer_lcore_id != LCORE_ID_ANY &&
+	     (peer_lcore_id >= RTE_MAX_LCORE || peer_lcore_id == lcore_id)))
+		return -EINVAL;
+
+	rte_mcfg_mempool_write_lock();
+
+	ctl = mempool_cache_ctl_get(mp);
+	if (ctl == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	if (peer_lcore_id != LCORE_ID_ANY) {
+		peer = &ctl->lcore[peer_lcore_id];
+		r = peer->ret_ring;
+	}
+
+	/* the return ring of an lcore lives as long as the mempool */
+	if (peer_lcore_id != LCORE_ID_ANY && r == NULL) {
+		ring_size = rte_ring_get_memsize(CACHE_RET_RING_SIZE);
+		if (ring_size < 0) {
+			ret = ring_size;
+			goto out;
+		}
+		r = rte_zmalloc_socket("MEMPOOL_RET_RING", ring_size,
+			RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(peer_lcore_id));
+		if (r == NULL) {
+			RTE_LOG(ERR, MEMPOOL, "Cannot allocate return ring\n");
+			ret = -ENOMEM;
+			goto out;
+		}
+		snprintf(name, sizeof(name), "MPR%u_%s", peer_lcore_id,
+			mp->name);
+		ret = rte_ring_init(r, name, CACHE_RET_RING_SIZE,
+			RING_F_SC_DEQ);
+		if (ret < 0) {
+			rte_free(r);
+			goto out;
+		}
+		__atomic_store_n(&peer->ret_ring, r, __ATOMIC_RELEASE);
+	}
+
+	__atomic_store_n(&ctl->lcore[lcore_id].peer_ring, r,
+		__ATOMIC_RELEASE);
+out:
+	rte_mcfg_mempool_write_unlock();
+	return ret;
+}
+
 /* create an empty mempool */
 struct rte_mempool *
 rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
@@ -983,6 +1235,17 @@ rte_mempool_avail_count(const struct rte_mempool *mp)
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
 		count += mp->local_cache[lcore_id].len;
 
+	/* objects returned to lcores by their peers */
+	if (mp->cache_ctl != NULL) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			const struct rte_ring *r =
+				mp->cache_ctl->lcore[lcore_id].ret_ring;
+
+			if (r != NULL)
+				count += rte_ring_count(r);
+		}
+	}
+
 	/*
 	 * due to race condition (access to len is not locked), the
 	 * total can be greater than size... so fix the result
@@ -1019,6 +1282,26 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 			lcore_id, cache_count);
 		count += cache_count;
 	}
+
+	if (mp->cache_ctl != NULL) {
+		fprintf(f, "    cache_max_size=%"PRIu32"\n",
+			mp->cache_ctl->max_size);
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			const struct rte_ring *r =
+				mp->cache_ctl->lcore[lcore_id].ret_ring;
+
+			if (mp->local_cache[lcore_id].size != mp->cache_size)
+				fprintf(f, "    cache_size[%u]=%"PRIu32"\n",
+					lcore_id,
+					mp->local_cache[lcore_id].size);
+			if (r == NULL)
+				continue;
+			cache_count = rte_ring_count(r);
+			fprintf(f, "    return_count[%u]=%u\n",
+				lcore_id, cache_count);
+			count += cache_count;
+		}
+	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
 }
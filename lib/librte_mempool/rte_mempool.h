@@ -201,6 +201,8 @@ struct rte_mempool_info {
 	unsigned int contig_block_size;
 } __rte_cache_aligned;
 
+struct rte_mempool_cache_ctl;
+
 /**
  * The RTE mempool structure.
  */
@@ -245,6 +247,9 @@ struct rte_mempool {
 	uint32_t nb_mem_chunks;          /**< Number of memory chunks */
 	struct rte_mempool_memhdr_list mem_list; /**< List of memory chunks */
 
+	/** Adaptive sizing and peer return of the default caches. */
+	struct rte_mempool_cache_ctl *cache_ctl;
+
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	/** Per-lcore statistics. */
 	struct rte_mempool_debug_stats stats[RTE_MAX_LCORE];
@@ -1223,6 +1228,96 @@ rte_mempool_cache_create(uint32_t size, int socket_id);
 void
 rte_mempool_cache_free(struct rte_mempool_cache *cache);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable or disable the adaptive sizing of the default caches.
+ *
+ * The default cache of an lcore grows, up to *max_size*, when the lcore
+ * keeps refilling it from the common pool without flushing it, or flushing
+ * it without refilling it, as the RX-only or TX-only lcores of a pipeline
+ * do: the bulk accesses to the common pool get larger and less frequent.
+ * It shrinks back to the size given at mempool creation when the gets and
+ * puts of the lcore are balanced. Each lcore resizes its own cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param max_size
+ *   The maximum size of the default caches, not lower than the size given
+ *   at mempool creation. Zero disables adaptive sizing.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool has no default caches or max_size is invalid.
+ *   - -ENOMEM: Not enough memory.
+ */
+__rte_experimental
+int
+rte_mempool_cache_adapt_set(struct rte_mempool *mp, uint32_t max_size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hand the objects flushed from the default cache of an lcore to another
+ * lcore.
+ *
+ * The objects flushed from the default cache of *lcore_id* are enqueued
+ * to a return ring of *peer_lcore_id*, instead of the common pool, and
+ * *peer_lcore_id* refills its default cache from its return ring before
+ * using the common pool. When the return ring is full, objects go to the
+ * common pool. This suits pipelines where objects are freed on TX lcores
+ * and allocated on RX lcores.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore flushing objects.
+ * @param peer_lcore_id
+ *   The lcore receiving them, or LCORE_ID_ANY to flush them to the
+ *   common pool.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: The mempool has no default caches or an lcore id is invalid.
+ *   - -ENOMEM: Not enough memory.
+ */
+__rte_experimental
+int
+rte_mempool_cache_peer_set(struct rte_mempool *mp, unsigned int lcore_id,
+		unsigned int peer_lcore_id);
+
+/**
+ * @internal Refill a cache of a mempool using adaptive sizing or peer
+ * return, see rte_mempool_cache_adapt_set() and rte_mempool_cache_peer_set().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param req
+ *   The number of objects to store past the current cache length.
+ * @return
+ *   - 0: Success; the cache length is not updated.
+ *   - <0: Error; code of ring dequeue function.
+ */
+int
+__rte_mempool_cache_refill(struct rte_mempool *mp,
+		struct rte_mempool_cache *cache, unsigned int req);
+
+/**
+ * @internal Flush the objects of a cache above its size, using adaptive
+ * sizing or peer return, see rte_mempool_cache_adapt_set() and
+ * rte_mempool_cache_peer_set().
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the mempool cache.
+ */
+void
+__rte_mempool_cache_flush_excess(struct rte_mempool *mp,
+		struct rte_mempool_cache *cache);
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
@@ -1309,6 +1404,10 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	cache->len += n;
 
 	if (cache->len >= cache->flushthresh) {
+		if (unlikely(mp->cache_ctl != NULL)) {
+			__rte_mempool_cache_flush_excess(mp, cache);
+			return;
+		}
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
@@ -1425,6 +1524,9 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		uint32_t req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
+		if (unlikely(mp->cache_ctl != NULL))
+			ret = __rte_mempool_cache_refill(mp, cache, req);
+		else
 		ret = rte_mempool_ops_dequeue_bulk(mp,
 			&cache->objs[cache->len], req);
 		if (unlikely(ret < 0)) {
@@ -234,6 +234,30 @@ error:
 	return NULL;
 }
 
+static int
+key_mask_is_prefix(uint8_t *key_mask, uint32_t key_size)
+{
+	uint32_t i, prefix_done = 0;
+
+	if (!key_mask)
+		return 1;
+
+	/* The key mask bits, in network byte order, are all ones followed by
+	 * all zeros.
+	 */
+	for (i = 0; i < key_size * 8; i++) {
+		uint32_t bit = (key_mask[i / 8] >> (7 - i % 8)) & 1;
+
+		if (bit && prefix_done)
+			return 0;
+
+		if (!bit)
+			prefix_done = 1;
+	}
+
+	return 1;
+}
+
 static int
 table_entry_check(struct rte_swx_ctl_pipeline *ctl,
 		  uint32_t table_id,
@@ -262,7 +286,8 @@ table_entry_check(struct rte_swx_ctl_pipeline *ctl,
 				break;
 
 			case RTE_SWX_TABLE_MATCH_LPM:
-				/* TBD Check that key mask is prefix. */
+				CHECK(key_mask_is_prefix(entry->key_mask,
+					table->params.key_size), EINVAL);
 				break;
 
 			case RTE_SWX_TABLE_MATCH_EXACT:
@@ -326,6 +351,9 @@ table_entry_duplicate(struct rte_swx_ctl_pipeline *ctl,
 		/* key_signature. */
 		new_entry->key_signature = entry->key_signature;
 
+		/* key_priority. */
+		new_entry->key_priority = entry->key_priority;
+
 		/* key_mask. */
 		if (table->params.match_type != RTE_SWX_TABLE_MATCH_EXACT) {
 			if (!entry->key_mask)
@@ -393,23 +421,31 @@ entry_keycmp_em(struct rte_swx_table_entry *e0,
 }
 
 static int
-entry_keycmp_wm(struct rte_swx_table_entry *e0 __rte_unused,
-		struct rte_swx_table_entry *e1 __rte_unused,
-		uint32_t key_size __rte_unused)
+entry_keycmp_wm(struct rte_swx_table_entry *e0,
+		struct rte_swx_table_entry *e1,
+		uint32_t key_size)
 {
-	/* TBD */
+	uint32_t i;
+
+	/* A NULL key mask stands for all the key bits being part of the key. */
+	for (i = 0; i < key_size; i++) {
+		uint8_t m0 = e0->key_mask ? e0->key_mask[i] : 0xFF;
+		uint8_t m1 = e1->key_mask ? e1->key_mask[i] : 0xFF;
+
+		if ((m0 != m1) || ((e0->key[i] & m0) != (e1->key[i] & m1)))
+			return 1; /* Not equal. */
+	}
 
-	return 1; /* Not equal */
+	return 0; /* Equal. */
 }
 
 static int
-entry_keycmp_lpm(struct rte_swx_table_entry *e0 __rte_unused,
-		 struct rte_swx_table_entry *e1 __rte_unused,
-		 uint32_t key_size __rte_unused)
+entry_keycmp_lpm(struct rte_swx_table_entry *e0,
+		 struct rte_swx_table_entry *e1,
+		 uint32_t key_size)
 {
-	/* TBD */
-
-	return 1; /* Not equal */
+	/* The LPM key is the prefix, i.e. the masked key and the mask. */
+	return entry_keycmp_wm(e0, e1, key_size);
 }
 
 static int
@@ -648,8 +684,12 @@ table_state_free(struct rte_swx_ctl_pipeline *ctl)
 		/* Default action data. */
 		free(ts->default_action_data);
 
-		/* Table object. */
-		if (!table->is_stub && table->ops.free && ts->obj)
+		/* Table object. The tables that do not support incremental
+		 * update share the same table object between the current and
+		 * the next table state.
+		 */
+		if (!table->is_stub && table->ops.free && ts->obj &&
+		    (!ctl->ts || (ts->obj != ctl->ts[i].obj)))
 			table->ops.free(ts->obj);
 	}
 
@@ -676,7 +716,9 @@ table_state_create(struct rte_swx_ctl_pipeline *ctl)
 		struct rte_swx_table_state *ts_next = &ctl->ts_next[i];
 
 		/* Table object. */
-		if (!table->is_stub) {
+		if (!table->is_stub && !table->ops.add) {
+			ts_next->obj = ts->obj;
+		} else if (!table->is_stub) {
 			ts_next->obj = table->ops.create(&table->params,
 							 &table->entries,
 							 table->info.args,
@@ -1105,51 +1147,162 @@ rte_swx_ctl_pipeline_table_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
 }
 
 static int
-table_rollfwd0(struct rte_swx_ctl_pipeline *ctl, uint32_t table_id)
+table_is_update_pending(struct table *table)
+{
+	if (TAILQ_FIRST(&table->pending_add) ||
+	    TAILQ_FIRST(&table->pending_modify1) ||
+	    TAILQ_FIRST(&table->pending_delete))
+		return 1;
+
+	return 0;
+}
+
+static void
+table_entry_list_free(struct rte_swx_table_entry_list *list)
+{
+	for ( ; ; ) {
+		struct rte_swx_table_entry *entry;
+
+		entry = TAILQ_FIRST(list);
+		if (!entry)
+			break;
+
+		TAILQ_REMOVE(list, entry, node);
+		table_entry_free(entry);
+	}
+}
+
+static int
+table_entry_list_append(struct rte_swx_ctl_pipeline *ctl,
+			uint32_t table_id,
+			struct rte_swx_table_entry_list *dst,
+			struct rte_swx_table_entry_list *src)
+{
+	struct rte_swx_table_entry *entry;
+
+	TAILQ_FOREACH(entry, src, node) {
+		struct rte_swx_table_entry *new_entry;
+
+		new_entry = table_entry_duplicate(ctl, table_id, entry, 1, 1);
+		if (!new_entry)
+			return -ENOMEM;
+
+		TAILQ_INSERT_TAIL(dst, new_entry, node);
+	}
+
+	return 0;
+}
+
+static int
+table_rollfwd0(struct rte_swx_ctl_pipeline *ctl,
+	       uint32_t table_id,
+	       uint32_t after_swap)
 {
 	struct table *table = &ctl->tables[table_id];
+	struct rte_swx_table_state *ts = &ctl->ts[table_id];
 	struct rte_swx_table_state *ts_next = &ctl->ts_next[table_id];
+	struct rte_swx_table_entry_list list;
 	struct rte_swx_table_entry *entry;
+	void *obj;
+	int status;
 
 	/* Reset counters. */
 	table->n_add = 0;
 	table->n_modify = 0;
 	table->n_delete = 0;
 
-	/* Add pending rules. */
-	TAILQ_FOREACH(entry, &table->pending_add, node) {
-		int status;
+	if (table->is_stub || !table_is_update_pending(table))
+		return 0;
 
-		status = table->ops.add(ts_next->obj, entry);
-		if (status)
-			return status;
+	/*
+	 * Current table supports incremental update.
+	 */
+	if (table->ops.add) {
+		/* Add pending rules. */
+		TAILQ_FOREACH(entry, &table->pending_add, node) {
+			status = table->ops.add(ts_next->obj, entry);
+			if (status)
+				return status;
 
-		table->n_add++;
-	}
+			table->n_add++;
+		}
 
-	/* Modify pending rules. */
-	TAILQ_FOREACH(entry, &table->pending_modify1, node) {
-		int status;
+		/* Modify pending rules. */
+		TAILQ_FOREACH(entry, &table->pending_modify1, node) {
+			status = table->ops.add(ts_next->obj, entry);
+			if (status)
+				return status;
 
-		status = table->ops.add(ts_next->obj, entry);
-		if (status)
-			return status;
+			table->n_modify++;
+		}
 
-		table->n_modify++;
+		/* Delete pending rules. */
+		TAILQ_FOREACH(entry, &table->pending_delete, node) {
+			status = table->ops.del(ts_next->obj, entry);
+			if (status)
+				return status;
+
+			table->n_delete++;
+		}
+
+		return 0;
 	}
 
-	/* Delete pending rules. */
-	TAILQ_FOREACH(entry, &table->pending_delete, node) {
-		int status;
+	/*
+	 * Current table does NOT support incremental update.
+	 */
+	if (after_swap) {
+		/* The previous table object is no longer used by the data
+		 * plane, so it is replaced with the new table object, which is
+		 * now shared between the current and the next table state.
+		 */
+		if (ts_next->obj != ts->obj) {
+			table->ops.free(ts_next->obj);
+			ts_next->obj = ts->obj;
+		}
 
-		status = table->ops.del(ts_next->obj, entry);
-		if (status)
-			return status;
+		return 0;
+	}
+
+	/* Create the updated list of table entries, i.e. the current entries
+	 * plus the pending add and modify entries, then build a new table
+	 * object from it. The pending delete and the pending modify0 entries
+	 * are not part of the table->entries list.
+	 */
+	TAILQ_INIT(&list);
+
+	status = table_entry_list_append(ctl, table_id, &list, &table->entries);
+	if (status)
+		goto error;
+
+	status = table_entry_list_append(ctl,
+					 table_id,
+					 &list,
+					 &table->pending_add);
+	if (status)
+		goto error;
+
+	status = table_entry_list_append(ctl,
+					 table_id,
+					 &list,
+					 &table->pending_modify1);
+	if (status)
+		goto error;
 
-		table->n_delete++;
+	obj = table->ops.create(&table->params,
+				&list,
+				table->info.args,
+				ctl->numa_node);
+	if (!obj) {
+		status = -ENODEV;
+		goto error;
 	}
 
-	return 0;
+	ts_next->obj = obj;
+
+error:
+	table_entry_list_free(&list);
+	return status;
 }
 
 static void
@@ -1206,9 +1359,25 @@ static void
 table_rollback(struct rte_swx_ctl_pipeline *ctl, uint32_t table_id)
 {
 	struct table *table = &ctl->tables[table_id];
+	struct rte_swx_table_state *ts = &ctl->ts[table_id];
 	struct rte_swx_table_state *ts_next = &ctl->ts_next[table_id];
 	struct rte_swx_table_entry *entry;
 
+	if (table->is_stub || !table_is_update_pending(table))
+		return;
+
+	/* Free the new table object, if any, as the current table object is
+	 * still in use.
+	 */
+	if (!table->ops.add) {
+		if (ts_next->obj != ts->obj) {
+			table->ops.free(ts_next->obj);
+			ts_next->obj = ts->obj;
+		}
+
+		return;
+	}
+
 	/* Add back all the entries that were just deleted. */
 	TAILQ_FOREACH(entry, &table->pending_delete, node) {
 		if (!table->n_delete)
@@ -1280,7 +1449,7 @@ rte_swx_ctl_pipeline_commit(struct rte_swx_ctl_pipeline *ctl, int abort_on_fail)
 	 * ts.
 	 */
 	for (i = 0; i < ctl->info.n_tables; i++) {
-		status = table_rollfwd0(ctl, i);
+		status = table_rollfwd0(ctl, i, 0);
 		if (status)
 			goto rollback;
 	}
@@ -1300,7 +1469,7 @@ rte_swx_ctl_pipeline_commit(struct rte_swx_ctl_pipeline *ctl, int abort_on_fail)
 	/* Operate the changes on the current ts_next, which is the previous ts.
 	 */
 	for (i = 0; i < ctl->info.n_tables; i++) {
-		table_rollfwd0(ctl, i);
+		table_rollfwd0(ctl, i, 1);
 		table_rollfwd1(ctl, i);
 		table_rollfwd2(ctl, i);
 	}
@@ -1341,7 +1510,7 @@ rte_swx_ctl_pipeline_table_entry_read(struct rte_swx_ctl_pipeline *ctl,
 	struct action *action;
 	struct rte_swx_table_entry *entry = NULL;
 	char *s0 = NULL, *s;
-	uint32_t n_tokens = 0, arg_offset = 0, i;
+	uint32_t n_tokens = 0, arg_offset = 0, tokens_offset, i;
 
 	/* Check input arguments. */
 	if (!ctl)
@@ -1382,16 +1551,32 @@ rte_swx_ctl_pipeline_table_entry_read(struct rte_swx_ctl_pipeline *ctl,
 	}
 
 	if ((n_tokens < 3 + table->info.n_match_fields) ||
-	    strcmp(tokens[0], "match") ||
-	    strcmp(tokens[1 + table->info.n_match_fields], "action"))
+	    strcmp(tokens[0], "match"))
+		goto error;
+
+	/* Optional key priority. */
+	tokens_offset = 1 + table->info.n_match_fields;
+	if (!strcmp(tokens[tokens_offset], "priority")) {
+		char *priority = tokens[tokens_offset + 1];
+
+		if (n_tokens < 5 + table->info.n_match_fields)
+			goto error;
+
+		entry->key_priority = strtoul(priority, &priority, 0);
+		if (priority[0])
+			goto error;
+
+		tokens_offset += 2;
+	}
+
+	if (strcmp(tokens[tokens_offset], "action"))
 		goto error;
 
-	action = action_find(ctl, tokens[2 + table->info.n_match_fields]);
+	action = action_find(ctl, tokens[tokens_offset + 1]);
 	if (!action)
 		goto error;
 
-	if (n_tokens != 3 + table->info.n_match_fields +
-	    action->info.n_args * 2)
+	if (n_tokens != tokens_offset + 2 + action->info.n_args * 2)
 		goto error;
 
 	/*
@@ -1399,23 +1584,43 @@ rte_swx_ctl_pipeline_table_entry_read(struct rte_swx_ctl_pipeline *ctl,
 	 */
 	for (i = 0; i < table->info.n_match_fields; i++) {
 		struct rte_swx_ctl_table_match_field_info *mf = &table->mf[i];
-		char *mf_val = tokens[1 + i];
-		uint64_t val;
+		char *mf_val = tokens[1 + i], *mf_mask = NULL;
+		uint64_t val, mask = UINT64_MAX;
+		uint32_t offset = (mf->offset - table->mf[0].offset) / 8;
+
+		/* Optional key mask: VALUE/MASK. */
+		mf_mask = strchr(mf_val, '/');
+		if (mf_mask) {
+			*mf_mask = 0;
+			mf_mask++;
+
+			if (!entry->key_mask)
+				goto error;
+
+			mask = strtoull(mf_mask, &mf_mask, 0);
+			if (mf_mask[0])
+				goto error;
+		}
 
 		val = strtoull(mf_val, &mf_val, 0);
 		if (mf_val[0])
 			goto error;
 
 		/* Endianness conversion. */
-		if (mf->is_header)
+		if (mf->is_header) {
 			val = field_hton(val, mf->n_bits);
+			mask = field_hton(mask, mf->n_bits);
+		}
 
 		/* Copy key and key_mask to entry. */
-		memcpy(&entry->key[(mf->offset - table->mf[0].offset) / 8],
+		memcpy(&entry->key[offset],
 		       (uint8_t *)&val,
 		       mf->n_bits / 8);
 
-		/* TBD Set entry->key_mask for wildcard and LPM tables. */
+		if (entry->key_mask)
+			memcpy(&entry->key_mask[offset],
+			       (uint8_t *)&mask,
+			       mf->n_bits / 8);
 	}
 
 	/*
@@ -1431,8 +1636,8 @@ rte_swx_ctl_pipeline_table_entry_read(struct rte_swx_ctl_pipeline *ctl,
 		uint64_t val;
 		int is_nbo = 0;
 
-		arg_name = tokens[3 + table->info.n_match_fields + i * 2];
-		arg_val = tokens[3 + table->info.n_match_fields + i * 2 + 1];
+		arg_name = tokens[tokens_offset + 2 + i * 2];
+		arg_val = tokens[tokens_offset + 2 + i * 2 + 1];
 
 		if (strcmp(arg_name, arg->name) ||
 		    (strlen(arg_val) < 4) ||
@@ -1472,6 +1677,35 @@ error:
 	return NULL;
 }
 
+static void
+table_entry_fprintf(FILE *f,
+		    struct rte_swx_ctl_pipeline *ctl,
+		    struct table *table,
+		    struct rte_swx_table_entry *entry)
+{
+	struct action *action = &ctl->actions[entry->action_id];
+	uint32_t i;
+
+	fprintf(f, "match ");
+	for (i = 0; i < table->params.key_size; i++)
+		fprintf(f, "%02x", entry->key[i]);
+
+	if (entry->key_mask) {
+		fprintf(f, "/");
+		for (i = 0; i < table->params.key_size; i++)
+			fprintf(f, "%02x", entry->key_mask[i]);
+	}
+
+	if (table->params.match_type == RTE_SWX_TABLE_MATCH_WILDCARD)
+		fprintf(f, " priority %u", entry->key_priority);
+
+	fprintf(f, " action %s ", action->info.name);
+	for (i = 0; i < action->data_size; i++)
+		fprintf(f, "%02x", entry->action_data[i]);
+
+	fprintf(f, "\n");
+}
+
 int
 rte_swx_ctl_pipeline_table_fprintf(FILE *f,
 				   struct rte_swx_ctl_pipeline *ctl,
@@ -1502,47 +1736,17 @@ rte_swx_ctl_pipeline_table_fprintf(FILE *f,
 
 	/* Table entries. */
 	TAILQ_FOREACH(entry, &table->entries, node) {
-		struct action *action = &ctl->actions[entry->action_id];
-
-		fprintf(f, "match ");
-		for (i = 0; i < table->params.key_size; i++)
-			fprintf(f, "%02x", entry->key[i]);
-
-		fprintf(f, " action %s ", action->info.name);
-		for (i = 0; i < action->data_size; i++)
-			fprintf(f, "%02x", entry->action_data[i]);
-
-		fprintf(f, "\n");
+		table_entry_fprintf(f, ctl, table, entry);
 		n_entries++;
 	}
 
 	TAILQ_FOREACH(entry, &table->pending_modify0, node) {
-		struct action *action = &ctl->actions[entry->action_id];
-
-		fprintf(f, "match ");
-		for (i = 0; i < table->params.key_size; i++)
-			fprintf(f, "%02x", entry->key[i]);
-
-		fprintf(f, " action %s ", action->info.name);
-		for (i = 0; i < action->data_size; i++)
-			fprintf(f, "%02x", entry->action_data[i]);
-
-		fprintf(f, "\n");
+		table_entry_fprintf(f, ctl, table, entry);
 		n_entries++;
 	}
 
 	TAILQ_FOREACH(entry, &table->pending_delete, node) {
-		struct action *action = &ctl->actions[entry->action_id];
-
-		fprintf(f, "match ");
-		for (i = 0; i < table->params.key_size; i++)
-			fprintf(f, "%02x", entry->key[i]);
-
-		fprintf(f, " action %s ", action->info.name);
-		for (i = 0; i < action->data_size; i++)
-			fprintf(f, "%02x", entry->action_data[i]);
-
-		fprintf(f, "\n");
+		table_entry_fprintf(f, ctl, table, entry);
 		n_entries++;
 	}
 
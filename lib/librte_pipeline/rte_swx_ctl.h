@@ -513,7 +513,19 @@ rte_swx_ctl_pipeline_abort(struct rte_swx_ctl_pipeline *ctl);
 /**
  * Pipeline table entry read
  *
- * Read table entry from string.
+ * Read table entry from string. The string format is:
+ *
+ *    match MATCH_FIELD_VALUE ... [priority PRIORITY] action ACTION_NAME
+ *       [ACTION_ARG_NAME H|N(ACTION_ARG_VALUE) ...]
+ *
+ * where each MATCH_FIELD_VALUE is either VALUE or VALUE/MASK. The VALUE/MASK
+ * format is allowed for the wildcard match and the LPM tables, but not for
+ * the exact match tables. For the LPM tables, the MASK has to be a prefix
+ * mask, i.e. the route depth is given by the MASK, with VALUE alone standing
+ * for the full key depth. The optional PRIORITY (0 is the highest priority)
+ * is used by the wildcard match tables to select between the overlapping
+ * entries and is ignored by the LPM tables, where the longest prefix always
+ * wins, and by the exact match tables.
  *
  * @param[in] ctl
  *   Pipeline control handle.
@@ -8,13 +8,13 @@
 #include <inttypes.h>
 #include <sys/queue.h>
 #include <arpa/inet.h>
+#include <dlfcn.h>
 
 #include <rte_common.h>
 #include <rte_prefetch.h>
 #include <rte_byteorder.h>
 
-#include "rte_swx_pipeline.h"
-#include "rte_swx_ctl.h"
+#include "rte_swx_pipeline_internal.h"
 
 #define CHECK(condition, err_code)                                             \
 do {                                                                           \
@@ -35,977 +35,6 @@ do {                                                                           \
 	       RTE_SWX_INSTRUCTION_SIZE),                                      \
 	      err_code)
 
-#ifndef TRACE_LEVEL
-#define TRACE_LEVEL 0
-#endif
-
-#if TRACE_LEVEL
-#define TRACE(...) printf(__VA_ARGS__)
-#else
-#define TRACE(...)
-#endif
-
-#define ntoh64(x) rte_be_to_cpu_64(x)
-#define hton64(x) rte_cpu_to_be_64(x)
-
-/*
- * Struct.
- */
-struct field {
-	char name[RTE_SWX_NAME_SIZE];
-	uint32_t n_bits;
-	uint32_t offset;
-};
-
-struct struct_type {
-	TAILQ_ENTRY(struct_type) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct field *fields;
-	uint32_t n_fields;
-	uint32_t n_bits;
-};
-
-TAILQ_HEAD(struct_type_tailq, struct_type);
-
-/*
- * Input port.
- */
-struct port_in_type {
-	TAILQ_ENTRY(port_in_type) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct rte_swx_port_in_ops ops;
-};
-
-TAILQ_HEAD(port_in_type_tailq, port_in_type);
-
-struct port_in {
-	TAILQ_ENTRY(port_in) node;
-	struct port_in_type *type;
-	void *obj;
-	uint32_t id;
-};
-
-TAILQ_HEAD(port_in_tailq, port_in);
-
-struct port_in_runtime {
-	rte_swx_port_in_pkt_rx_t pkt_rx;
-	void *obj;
-};
-
-/*
- * Output port.
- */
-struct port_out_type {
-	TAILQ_ENTRY(port_out_type) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct rte_swx_port_out_ops ops;
-};
-
-TAILQ_HEAD(port_out_type_tailq, port_out_type);
-
-struct port_out {
-	TAILQ_ENTRY(port_out) node;
-	struct port_out_type *type;
-	void *obj;
-	uint32_t id;
-};
-
-TAILQ_HEAD(port_out_tailq, port_out);
-
-struct port_out_runtime {
-	rte_swx_port_out_pkt_tx_t pkt_tx;
-	rte_swx_port_out_flush_t flush;
-	void *obj;
-};
-
-/*
- * Extern object.
- */
-struct extern_type_member_func {
-	TAILQ_ENTRY(extern_type_member_func) node;
-	char name[RTE_SWX_NAME_SIZE];
-	rte_swx_extern_type_member_func_t func;
-	uint32_t id;
-};
-
-TAILQ_HEAD(extern_type_member_func_tailq, extern_type_member_func);
-
-struct extern_type {
-	TAILQ_ENTRY(extern_type) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct struct_type *mailbox_struct_type;
-	rte_swx_extern_type_constructor_t constructor;
-	rte_swx_extern_type_destructor_t destructor;
-	struct extern_type_member_func_tailq funcs;
-	uint32_t n_funcs;
-};
-
-TAILQ_HEAD(extern_type_tailq, extern_type);
-
-struct extern_obj {
-	TAILQ_ENTRY(extern_obj) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct extern_type *type;
-	void *obj;
-	uint32_t struct_id;
-	uint32_t id;
-};
-
-TAILQ_HEAD(extern_obj_tailq, extern_obj);
-
-#ifndef RTE_SWX_EXTERN_TYPE_MEMBER_FUNCS_MAX
-#define RTE_SWX_EXTERN_TYPE_MEMBER_FUNCS_MAX 8
-#endif
-
-struct extern_obj_runtime {
-	void *obj;
-	uint8_t *mailbox;
-	rte_swx_extern_type_member_func_t funcs[RTE_SWX_EXTERN_TYPE_MEMBER_FUNCS_MAX];
-};
-
-/*
- * Extern function.
- */
-struct extern_func {
-	TAILQ_ENTRY(extern_func) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct struct_type *mailbox_struct_type;
-	rte_swx_extern_func_t func;
-	uint32_t struct_id;
-	uint32_t id;
-};
-
-TAILQ_HEAD(extern_func_tailq, extern_func);
-
-struct extern_func_runtime {
-	uint8_t *mailbox;
-	rte_swx_extern_func_t func;
-};
-
-/*
- * Header.
- */
-struct header {
-	TAILQ_ENTRY(header) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct struct_type *st;
-	uint32_t struct_id;
-	uint32_t id;
-};
-
-TAILQ_HEAD(header_tailq, header);
-
-struct header_runtime {
-	uint8_t *ptr0;
-};
-
-struct header_out_runtime {
-	uint8_t *ptr0;
-	uint8_t *ptr;
-	uint32_t n_bytes;
-};
-
-/*
- * Instruction.
- */
-
-/* Packet headers are always in Network Byte Order (NBO), i.e. big endian.
- * Packet meta-data fields are always assumed to be in Host Byte Order (HBO).
- * Table entry fields can be in either NBO or HBO; they are assumed to be in HBO
- * when transferred to packet meta-data and in NBO when transferred to packet
- * headers.
- */
-
-/* Notation conventions:
- *    -Header field: H = h.header.field (dst/src)
- *    -Meta-data field: M = m.field (dst/src)
- *    -Extern object mailbox field: E = e.field (dst/src)
- *    -Extern function mailbox field: F = f.field (dst/src)
- *    -Table action data field: T = t.field (src only)
- *    -Immediate value: I = 32-bit unsigned value (src only)
- */
-
-enum instruction_type {
-	/* rx m.port_in */
-	INSTR_RX,
-
-	/* tx m.port_out */
-	INSTR_TX,
-
-	/* extract h.header */
-	INSTR_HDR_EXTRACT,
-	INSTR_HDR_EXTRACT2,
-	INSTR_HDR_EXTRACT3,
-	INSTR_HDR_EXTRACT4,
-	INSTR_HDR_EXTRACT5,
-	INSTR_HDR_EXTRACT6,
-	INSTR_HDR_EXTRACT7,
-	INSTR_HDR_EXTRACT8,
-
-	/* emit h.header */
-	INSTR_HDR_EMIT,
-	INSTR_HDR_EMIT_TX,
-	INSTR_HDR_EMIT2_TX,
-	INSTR_HDR_EMIT3_TX,
-	INSTR_HDR_EMIT4_TX,
-	INSTR_HDR_EMIT5_TX,
-	INSTR_HDR_EMIT6_TX,
-	INSTR_HDR_EMIT7_TX,
-	INSTR_HDR_EMIT8_TX,
-
-	/* validate h.header */
-	INSTR_HDR_VALIDATE,
-
-	/* invalidate h.header */
-	INSTR_HDR_INVALIDATE,
-
-	/* mov dst src
-	 * dst = src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_MOV,   /* dst = MEF, src = MEFT */
-	INSTR_MOV_S, /* (dst, src) = (MEF, H) or (dst, src) = (H, MEFT) */
-	INSTR_MOV_I, /* dst = HMEF, src = I */
-
-	/* dma h.header t.field
-	 * memcpy(h.header, t.field, sizeof(h.header))
-	 */
-	INSTR_DMA_HT,
-	INSTR_DMA_HT2,
-	INSTR_DMA_HT3,
-	INSTR_DMA_HT4,
-	INSTR_DMA_HT5,
-	INSTR_DMA_HT6,
-	INSTR_DMA_HT7,
-	INSTR_DMA_HT8,
-
-	/* add dst src
-	 * dst += src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_ADD,    /* dst = MEF, src = MEF */
-	INSTR_ALU_ADD_MH, /* dst = MEF, src = H */
-	INSTR_ALU_ADD_HM, /* dst = H, src = MEF */
-	INSTR_ALU_ADD_HH, /* dst = H, src = H */
-	INSTR_ALU_ADD_MI, /* dst = MEF, src = I */
-	INSTR_ALU_ADD_HI, /* dst = H, src = I */
-
-	/* sub dst src
-	 * dst -= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_SUB,    /* dst = MEF, src = MEF */
-	INSTR_ALU_SUB_MH, /* dst = MEF, src = H */
-	INSTR_ALU_SUB_HM, /* dst = H, src = MEF */
-	INSTR_ALU_SUB_HH, /* dst = H, src = H */
-	INSTR_ALU_SUB_MI, /* dst = MEF, src = I */
-	INSTR_ALU_SUB_HI, /* dst = H, src = I */
-
-	/* ckadd dst src
-	 * dst = dst '+ src[0:1] '+ src[2:3] + ...
-	 * dst = H, src = {H, h.header}
-	 */
-	INSTR_ALU_CKADD_FIELD,    /* src = H */
-	INSTR_ALU_CKADD_STRUCT20, /* src = h.header, with sizeof(header) = 20 */
-	INSTR_ALU_CKADD_STRUCT,   /* src = h.hdeader, with any sizeof(header) */
-
-	/* cksub dst src
-	 * dst = dst '- src
-	 * dst = H, src = H
-	 */
-	INSTR_ALU_CKSUB_FIELD,
-
-	/* and dst src
-	 * dst &= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_AND,   /* dst = MEF, src = MEFT */
-	INSTR_ALU_AND_S, /* (dst, src) = (MEF, H) or (dst, src) = (H, MEFT) */
-	INSTR_ALU_AND_I, /* dst = HMEF, src = I */
-
-	/* or dst src
-	 * dst |= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_OR,   /* dst = MEF, src = MEFT */
-	INSTR_ALU_OR_S, /* (dst, src) = (MEF, H) or (dst, src) = (H, MEFT) */
-	INSTR_ALU_OR_I, /* dst = HMEF, src = I */
-
-	/* xor dst src
-	 * dst ^= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_XOR,   /* dst = MEF, src = MEFT */
-	INSTR_ALU_XOR_S, /* (dst, src) = (MEF, H) or (dst, src) = (H, MEFT) */
-	INSTR_ALU_XOR_I, /* dst = HMEF, src = I */
-
-	/* shl dst src
-	 * dst <<= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_SHL,    /* dst = MEF, src = MEF */
-	INSTR_ALU_SHL_MH, /* dst = MEF, src = H */
-	INSTR_ALU_SHL_HM, /* dst = H, src = MEF */
-	INSTR_ALU_SHL_HH, /* dst = H, src = H */
-	INSTR_ALU_SHL_MI, /* dst = MEF, src = I */
-	INSTR_ALU_SHL_HI, /* dst = H, src = I */
-
-	/* shr dst src
-	 * dst >>= src
-	 * dst = HMEF, src = HMEFTI
-	 */
-	INSTR_ALU_SHR,    /* dst = MEF, src = MEF */
-	INSTR_ALU_SHR_MH, /* dst = MEF, src = H */
-	INSTR_ALU_SHR_HM, /* dst = H, src = MEF */
-	INSTR_ALU_SHR_HH, /* dst = H, src = H */
-	INSTR_ALU_SHR_MI, /* dst = MEF, src = I */
-	INSTR_ALU_SHR_HI, /* dst = H, src = I */
-
-	/* table TABLE */
-	INSTR_TABLE,
-
-	/* extern e.obj.func */
-	INSTR_EXTERN_OBJ,
-
-	/* extern f.func */
-	INSTR_EXTERN_FUNC,
-
-	/* jmp LABEL
-	 * Unconditional jump
-	 */
-	INSTR_JMP,
-
-	/* jmpv LABEL h.header
-	 * Jump if header is valid
-	 */
-	INSTR_JMP_VALID,
-
-	/* jmpnv LABEL h.header
-	 * Jump if header is invalid
-	 */
-	INSTR_JMP_INVALID,
-
-	/* jmph LABEL
-	 * Jump if table lookup hit
-	 */
-	INSTR_JMP_HIT,
-
-	/* jmpnh LABEL
-	 * Jump if table lookup miss
-	 */
-	INSTR_JMP_MISS,
-
-	/* jmpa LABEL ACTION
-	 * Jump if action run
-	 */
-	INSTR_JMP_ACTION_HIT,
-
-	/* jmpna LABEL ACTION
-	 * Jump if action not run
-	 */
-	INSTR_JMP_ACTION_MISS,
-
-	/* jmpeq LABEL a b
-	 * Jump is a is equal to b
-	 * a = HMEFT, b = HMEFTI
-	 */
-	INSTR_JMP_EQ,   /* (a, b) = (MEFT, MEFT) or (a, b) = (H, H) */
-	INSTR_JMP_EQ_S, /* (a, b) = (MEFT, H) or (a, b) = (H, MEFT) */
-	INSTR_JMP_EQ_I, /* (a, b) = (MEFT, I) or (a, b) = (H, I) */
-
-	/* jmpneq LABEL a b
-	 * Jump is a is not equal to b
-	 * a = HMEFT, b = HMEFTI
-	 */
-	INSTR_JMP_NEQ,   /* (a, b) = (MEFT, MEFT) or (a, b) = (H, H) */
-	INSTR_JMP_NEQ_S, /* (a, b) = (MEFT, H) or (a, b) = (H, MEFT) */
-	INSTR_JMP_NEQ_I, /* (a, b) = (MEFT, I) or (a, b) = (H, I) */
-
-	/* jmplt LABEL a b
-	 * Jump if a is less than b
-	 * a = HMEFT, b = HMEFTI
-	 */
-	INSTR_JMP_LT,    /* a = MEF, b = MEF */
-	INSTR_JMP_LT_MH, /* a = MEF, b = H */
-	INSTR_JMP_LT_HM, /* a = H, b = MEF */
-	INSTR_JMP_LT_HH, /* a = H, b = H */
-	INSTR_JMP_LT_MI, /* a = MEF, b = I */
-	INSTR_JMP_LT_HI, /* a = H, b = I */
-
-	/* jmpgt LABEL a b
-	 * Jump if a is greater than b
-	 * a = HMEFT, b = HMEFTI
-	 */
-	INSTR_JMP_GT,    /* a = MEF, b = MEF */
-	INSTR_JMP_GT_MH, /* a = MEF, b = H */
-	INSTR_JMP_GT_HM, /* a = H, b = MEF */
-	INSTR_JMP_GT_HH, /* a = H, b = H */
-	INSTR_JMP_GT_MI, /* a = MEF, b = I */
-	INSTR_JMP_GT_HI, /* a = H, b = I */
-
-	/* return
-	 * Return from action
-	 */
-	INSTR_RETURN,
-};
-
-struct instr_operand {
-	uint8_t struct_id;
-	uint8_t n_bits;
-	uint8_t offset;
-	uint8_t pad;
-};
-
-struct instr_io {
-	struct {
-		uint8_t offset;
-		uint8_t n_bits;
-		uint8_t pad[2];
-	} io;
-
-	struct {
-		uint8_t header_id[8];
-		uint8_t struct_id[8];
-		uint8_t n_bytes[8];
-	} hdr;
-};
-
-struct instr_hdr_validity {
-	uint8_t header_id;
-};
-
-struct instr_table {
-	uint8_t table_id;
-};
-
-struct instr_extern_obj {
-	uint8_t ext_obj_id;
-	uint8_t func_id;
-};
-
-struct instr_extern_func {
-	uint8_t ext_func_id;
-};
-
-struct instr_dst_src {
-	struct instr_operand dst;
-	union {
-		struct instr_operand src;
-		uint64_t src_val;
-	};
-};
-
-struct instr_dma {
-	struct {
-		uint8_t header_id[8];
-		uint8_t struct_id[8];
-	} dst;
-
-	struct {
-		uint8_t offset[8];
-	} src;
-
-	uint16_t n_bytes[8];
-};
-
-struct instr_jmp {
-	struct instruction *ip;
-
-	union {
-		struct instr_operand a;
-		uint8_t header_id;
-		uint8_t action_id;
-	};
-
-	union {
-		struct instr_operand b;
-		uint64_t b_val;
-	};
-};
-
-struct instruction {
-	enum instruction_type type;
-	union {
-		struct instr_io io;
-		struct instr_hdr_validity valid;
-		struct instr_dst_src mov;
-		struct instr_dma dma;
-		struct instr_dst_src alu;
-		struct instr_table table;
-		struct instr_extern_obj ext_obj;
-		struct instr_extern_func ext_func;
-		struct instr_jmp jmp;
-	};
-};
-
-struct instruction_data {
-	char label[RTE_SWX_NAME_SIZE];
-	char jmp_label[RTE_SWX_NAME_SIZE];
-	uint32_t n_users; /* user = jmp instruction to this instruction. */
-	int invalid;
-};
-
-/*
- * Action.
- */
-struct action {
-	TAILQ_ENTRY(action) node;
-	char name[RTE_SWX_NAME_SIZE];
-	struct struct_type *st;
-	struct instruction *instructions;
-	uint32_t n_instructions;
-	uint32_t id;
-};
-
-TAILQ_HEAD(action_tailq, action);
-
-/*
- * Table.
- */
-struct table_type {
-	TAILQ_ENTRY(table_type) node;
-	char name[RTE_SWX_NAME_SIZE];
-	enum rte_swx_table_match_type match_type;
-	struct rte_swx_table_ops ops;
-};
-
-TAILQ_HEAD(table_type_tailq, table_type);
-
-struct match_field {
-	enum rte_swx_table_match_type match_type;
-	struct field *field;
-};
-
-struct table {
-	TAILQ_ENTRY(table) node;
-	char name[RTE_SWX_NAME_SIZE];
-	char args[RTE_SWX_NAME_SIZE];
-	struct table_type *type; /* NULL when n_fields == 0. */
-
-	/* Match. */
-	struct match_field *fields;
-	uint32_t n_fields;
-	int is_header; /* Only valid when n_fields > 0. */
-	struct header *header; /* Only valid when n_fields > 0. */
-
-	/* Action. */
-	struct action **actions;
-	struct action *default_action;
-	uint8_t *default_action_data;
-	uint32_t n_actions;
-	int default_action_is_const;
-	uint32_t action_data_size_max;
-
-	uint32_t size;
-	uint32_t id;
-};
-
-TAILQ_HEAD(table_tailq, table);
-
-struct table_runtime {
-	rte_swx_table_lookup_t func;
-	void *mailbox;
-	uint8_t **key;
-};
-
-/*
- * Pipeline.
- */
-struct thread {
-	/* Packet. */
-	struct rte_swx_pkt pkt;
-	uint8_t *ptr;
-
-	/* Structures. */
-	uint8_t **structs;
-
-	/* Packet headers. */
-	struct header_runtime *headers; /* Extracted or generated headers. */
-	struct header_out_runtime *headers_out; /* Emitted headers. */
-	uint8_t *header_storage;
-	uint8_t *header_out_storage;
-	uint64_t valid_headers;
-	uint32_t n_headers_out;
-
-	/* Packet meta-data. */
-	uint8_t *metadata;
-
-	/* Tables. */
-	struct table_runtime *tables;
-	struct rte_swx_table_state *table_state;
-	uint64_t action_id;
-	int hit; /* 0 = Miss, 1 = Hit. */
-
-	/* Extern objects and functions. */
-	struct extern_obj_runtime *extern_objs;
-	struct extern_func_runtime *extern_funcs;
-
-	/* Instructions. */
-	struct instruction *ip;
-	struct instruction *ret;
-};
-
-#define MASK64_BIT_GET(mask, pos) ((mask) & (1LLU << (pos)))
-#define MASK64_BIT_SET(mask, pos) ((mask) | (1LLU << (pos)))
-#define MASK64_BIT_CLR(mask, pos) ((mask) & ~(1LLU << (pos)))
-
-#define HEADER_VALID(thread, header_id) \
-	MASK64_BIT_GET((thread)->valid_headers, header_id)
-
-#define ALU(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = dst64 & dst64_mask;                                     \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->alu.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->alu.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src64_mask = UINT64_MAX >> (64 - (ip)->alu.src.n_bits);       \
-	uint64_t src = src64 & src64_mask;                                     \
-									       \
-	uint64_t result = dst operator src;                                    \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (result & dst64_mask);            \
-}
-
-#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-
-#define ALU_S(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = dst64 & dst64_mask;                                     \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->alu.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->alu.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src = ntoh64(src64) >> (64 - (ip)->alu.src.n_bits);           \
-									       \
-	uint64_t result = dst operator src;                                    \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (result & dst64_mask);            \
-}
-
-#define ALU_MH ALU_S
-
-#define ALU_HM(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = ntoh64(dst64) >> (64 - (ip)->alu.dst.n_bits);           \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->alu.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->alu.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src64_mask = UINT64_MAX >> (64 - (ip)->alu.src.n_bits);       \
-	uint64_t src = src64 & src64_mask;                                     \
-									       \
-	uint64_t result = dst operator src;                                    \
-	result = hton64(result << (64 - (ip)->alu.dst.n_bits));                \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | result;                           \
-}
-
-#define ALU_HH(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = ntoh64(dst64) >> (64 - (ip)->alu.dst.n_bits);           \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->alu.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->alu.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src = ntoh64(src64) >> (64 - (ip)->alu.src.n_bits);           \
-									       \
-	uint64_t result = dst operator src;                                    \
-	result = hton64(result << (64 - (ip)->alu.dst.n_bits));                \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | result;                           \
-}
-
-#else
-
-#define ALU_S ALU
-#define ALU_MH ALU
-#define ALU_HM ALU
-#define ALU_HH ALU
-
-#endif
-
-#define ALU_I(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = dst64 & dst64_mask;                                     \
-									       \
-	uint64_t src = (ip)->alu.src_val;                                      \
-									       \
-	uint64_t result = dst operator src;                                    \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (result & dst64_mask);            \
-}
-
-#define ALU_MI ALU_I
-
-#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-
-#define ALU_HI(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->alu.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->alu.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->alu.dst.n_bits);       \
-	uint64_t dst = ntoh64(dst64) >> (64 - (ip)->alu.dst.n_bits);           \
-									       \
-	uint64_t src = (ip)->alu.src_val;                                      \
-									       \
-	uint64_t result = dst operator src;                                    \
-	result = hton64(result << (64 - (ip)->alu.dst.n_bits));                \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | result;                           \
-}
-
-#else
-
-#define ALU_HI ALU_I
-
-#endif
-
-#define MOV(thread, ip)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->mov.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->mov.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->mov.dst.n_bits);       \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->mov.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->mov.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src64_mask = UINT64_MAX >> (64 - (ip)->mov.src.n_bits);       \
-	uint64_t src = src64 & src64_mask;                                     \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (src & dst64_mask);               \
-}
-
-#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-
-#define MOV_S(thread, ip)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->mov.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->mov.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->mov.dst.n_bits);       \
-									       \
-	uint8_t *src_struct = (thread)->structs[(ip)->mov.src.struct_id];      \
-	uint64_t *src64_ptr = (uint64_t *)&src_struct[(ip)->mov.src.offset];   \
-	uint64_t src64 = *src64_ptr;                                           \
-	uint64_t src = ntoh64(src64) >> (64 - (ip)->mov.src.n_bits);           \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (src & dst64_mask);               \
-}
-
-#else
-
-#define MOV_S MOV
-
-#endif
-
-#define MOV_I(thread, ip)  \
-{                                                                              \
-	uint8_t *dst_struct = (thread)->structs[(ip)->mov.dst.struct_id];      \
-	uint64_t *dst64_ptr = (uint64_t *)&dst_struct[(ip)->mov.dst.offset];   \
-	uint64_t dst64 = *dst64_ptr;                                           \
-	uint64_t dst64_mask = UINT64_MAX >> (64 - (ip)->mov.dst.n_bits);       \
-									       \
-	uint64_t src = (ip)->mov.src_val;                                      \
-									       \
-	*dst64_ptr = (dst64 & ~dst64_mask) | (src & dst64_mask);               \
-}
-
-#define JMP_CMP(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a64_mask = UINT64_MAX >> (64 - (ip)->jmp.a.n_bits);           \
-	uint64_t a = a64 & a64_mask;                                           \
-									       \
-	uint8_t *b_struct = (thread)->structs[(ip)->jmp.b.struct_id];          \
-	uint64_t *b64_ptr = (uint64_t *)&b_struct[(ip)->jmp.b.offset];         \
-	uint64_t b64 = *b64_ptr;                                               \
-	uint64_t b64_mask = UINT64_MAX >> (64 - (ip)->jmp.b.n_bits);           \
-	uint64_t b = b64 & b64_mask;                                           \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-
-#define JMP_CMP_S(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a64_mask = UINT64_MAX >> (64 - (ip)->jmp.a.n_bits);           \
-	uint64_t a = a64 & a64_mask;                                           \
-									       \
-	uint8_t *b_struct = (thread)->structs[(ip)->jmp.b.struct_id];          \
-	uint64_t *b64_ptr = (uint64_t *)&b_struct[(ip)->jmp.b.offset];         \
-	uint64_t b64 = *b64_ptr;                                               \
-	uint64_t b = ntoh64(b64) >> (64 - (ip)->jmp.b.n_bits);                 \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#define JMP_CMP_MH JMP_CMP_S
-
-#define JMP_CMP_HM(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a = ntoh64(a64) >> (64 - (ip)->jmp.a.n_bits);                 \
-									       \
-	uint8_t *b_struct = (thread)->structs[(ip)->jmp.b.struct_id];          \
-	uint64_t *b64_ptr = (uint64_t *)&b_struct[(ip)->jmp.b.offset];         \
-	uint64_t b64 = *b64_ptr;                                               \
-	uint64_t b64_mask = UINT64_MAX >> (64 - (ip)->jmp.b.n_bits);           \
-	uint64_t b = b64 & b64_mask;                                           \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#define JMP_CMP_HH(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a = ntoh64(a64) >> (64 - (ip)->jmp.a.n_bits);                 \
-									       \
-	uint8_t *b_struct = (thread)->structs[(ip)->jmp.b.struct_id];          \
-	uint64_t *b64_ptr = (uint64_t *)&b_struct[(ip)->jmp.b.offset];         \
-	uint64_t b64 = *b64_ptr;                                               \
-	uint64_t b = ntoh64(b64) >> (64 - (ip)->jmp.b.n_bits);                 \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#else
-
-#define JMP_CMP_S JMP_CMP
-#define JMP_CMP_MH JMP_CMP
-#define JMP_CMP_HM JMP_CMP
-#define JMP_CMP_HH JMP_CMP
-
-#endif
-
-#define JMP_CMP_I(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a64_mask = UINT64_MAX >> (64 - (ip)->jmp.a.n_bits);           \
-	uint64_t a = a64 & a64_mask;                                           \
-									       \
-	uint64_t b = (ip)->jmp.b_val;                                          \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#define JMP_CMP_MI JMP_CMP_I
-
-#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
-
-#define JMP_CMP_HI(thread, ip, operator)  \
-{                                                                              \
-	uint8_t *a_struct = (thread)->structs[(ip)->jmp.a.struct_id];          \
-	uint64_t *a64_ptr = (uint64_t *)&a_struct[(ip)->jmp.a.offset];         \
-	uint64_t a64 = *a64_ptr;                                               \
-	uint64_t a = ntoh64(a64) >> (64 - (ip)->jmp.a.n_bits);                 \
-									       \
-	uint64_t b = (ip)->jmp.b_val;                                          \
-									       \
-	(thread)->ip = (a operator b) ? (ip)->jmp.ip : ((thread)->ip + 1);     \
-}
-
-#else
-
-#define JMP_CMP_HI JMP_CMP_I
-
-#endif
-
-#define METADATA_READ(thread, offset, n_bits)                                  \
-({                                                                             \
-	uint64_t *m64_ptr = (uint64_t *)&(thread)->metadata[offset];           \
-	uint64_t m64 = *m64_ptr;                                               \
-	uint64_t m64_mask = UINT64_MAX >> (64 - (n_bits));                     \
-	(m64 & m64_mask);                                                      \
-})
-
-#define METADATA_WRITE(thread, offset, n_bits, value)                          \
-{                                                                              \
-	uint64_t *m64_ptr = (uint64_t *)&(thread)->metadata[offset];           \
-	uint64_t m64 = *m64_ptr;                                               \
-	uint64_t m64_mask = UINT64_MAX >> (64 - (n_bits));                     \
-									       \
-	uint64_t m_new = value;                                                \
-									       \
-	*m64_ptr = (m64 & ~m64_mask) | (m_new & m64_mask);                     \
-}
-
-#ifndef RTE_SWX_PIPELINE_THREADS_MAX
-#define RTE_SWX_PIPELINE_THREADS_MAX 16
-#endif
-
-struct rte_swx_pipeline {
-	struct struct_type_tailq struct_types;
-	struct port_in_type_tailq port_in_types;
-	struct port_in_tailq ports_in;
-	struct port_out_type_tailq port_out_types;
-	struct port_out_tailq ports_out;
-	struct extern_type_tailq extern_types;
-	struct extern_obj_tailq extern_objs;
-	struct extern_func_tailq extern_funcs;
-	struct header_tailq headers;
-	struct struct_type *metadata_st;
-	uint32_t metadata_struct_id;
-	struct action_tailq actions;
-	struct table_type_tailq table_types;
-	struct table_tailq tables;
-
-	struct port_in_runtime *in;
-	struct port_out_runtime *out;
-	struct instruction **action_instructions;
-	struct rte_swx_table_state *table_state;
-	struct instruction *instructions;
-	struct thread threads[RTE_SWX_PIPELINE_THREADS_MAX];
-
-	uint32_t n_structs;
-	uint32_t n_ports_in;
-	uint32_t n_ports_out;
-	uint32_t n_extern_objs;
-	uint32_t n_extern_funcs;
-	uint32_t n_actions;
-	uint32_t n_tables;
-	uint32_t n_headers;
-	uint32_t thread_id;
-	uint32_t port_id;
-	uint32_t n_instructions;
-	int build_done;
-	int numa_node;
-};
-
 /*
  * Struct.
  */
@@ -2380,62 +1409,6 @@ struct_field_parse(struct rte_swx_pipeline *p,
 	}
 }
 
-static inline void
-pipeline_port_inc(struct rte_swx_pipeline *p)
-{
-	p->port_id = (p->port_id + 1) & (p->n_ports_in - 1);
-}
-
-static inline void
-thread_ip_reset(struct rte_swx_pipeline *p, struct thread *t)
-{
-	t->ip = p->instructions;
-}
-
-static inline void
-thread_ip_set(struct thread *t, struct instruction *ip)
-{
-	t->ip = ip;
-}
-
-static inline void
-thread_ip_action_call(struct rte_swx_pipeline *p,
-		      struct thread *t,
-		      uint32_t action_id)
-{
-	t->ret = t->ip + 1;
-	t->ip = p->action_instructions[action_id];
-}
-
-static inline void
-thread_ip_inc(struct rte_swx_pipeline *p);
-
-static inline void
-thread_ip_inc(struct rte_swx_pipeline *p)
-{
-	struct thread *t = &p->threads[p->thread_id];
-
-	t->ip++;
-}
-
-static inline void
-thread_ip_inc_cond(struct thread *t, int cond)
-{
-	t->ip += cond;
-}
-
-static inline void
-thread_yield(struct rte_swx_pipeline *p)
-{
-	p->thread_id = (p->thread_id + 1) & (RTE_SWX_PIPELINE_THREADS_MAX - 1);
-}
-
-static inline void
-thread_yield_cond(struct rte_swx_pipeline *p, int cond)
-{
-	p->thread_id = (p->thread_id + cond) & (RTE_SWX_PIPELINE_THREADS_MAX - 1);
-}
-
 /*
  * rx.
  */
@@ -2523,63 +1496,6 @@ instr_tx_translate(struct rte_swx_pipeline *p,
 	return 0;
 }
 
-static inline void
-emit_handler(struct thread *t)
-{
-	struct header_out_runtime *h0 = &t->headers_out[0];
-	struct header_out_runtime *h1 = &t->headers_out[1];
-	uint32_t offset = 0, i;
-
-	/* No header change or header decapsulation. */
-	if ((t->n_headers_out == 1) &&
-	    (h0->ptr + h0->n_bytes == t->ptr)) {
-		TRACE("Emit handler: no header change or header decap.\n");
-
-		t->pkt.offset -= h0->n_bytes;
-		t->pkt.length += h0->n_bytes;
-
-		return;
-	}
-
-	/* Header encapsulation (optionally, with prior header decasulation). */
-	if ((t->n_headers_out == 2) &&
-	    (h1->ptr + h1->n_bytes == t->ptr) &&
-	    (h0->ptr == h0->ptr0)) {
-		uint32_t offset;
-
-		TRACE("Emit handler: header encapsulation.\n");
-
-		offset = h0->n_bytes + h1->n_bytes;
-		memcpy(t->ptr - offset, h0->ptr, h0->n_bytes);
-		t->pkt.offset -= offset;
-		t->pkt.length += offset;
-
-		return;
-	}
-
-	/* Header insertion. */
-	/* TBD */
-
-	/* Header extraction. */
-	/* TBD */
-
-	/* For any other case. */
-	TRACE("Emit handler: complex case.\n");
-
-	for (i = 0; i < t->n_headers_out; i++) {
-		struct header_out_runtime *h = &t->headers_out[i];
-
-		memcpy(&t->header_out_storage[offset], h->ptr, h->n_bytes);
-		offset += h->n_bytes;
-	}
-
-	if (offset) {
-		memcpy(t->ptr - offset, t->header_out_storage, offset);
-		t->pkt.offset -= offset;
-		t->pkt.length += offset;
-	}
-}
-
 static inline void
 instr_tx_exec(struct rte_swx_pipeline *p);
 
@@ -2588,19 +1504,8 @@ instr_tx_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint64_t port_id = METADATA_READ(t, ip->io.io.offset, ip->io.io.n_bits);
-	struct port_out_runtime *port = &p->out[port_id];
-	struct rte_swx_pkt *pkt = &t->pkt;
 
-	TRACE("[Thread %2u]: tx 1 pkt to port %u\n",
-	      p->thread_id,
-	      (uint32_t)port_id);
-
-	/* Headers. */
-	emit_handler(t);
-
-	/* Packet. */
-	port->pkt_tx(port->obj, pkt);
+	__instr_tx_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_reset(p, t);
@@ -2634,52 +1539,12 @@ instr_hdr_extract_translate(struct rte_swx_pipeline *p,
 }
 
 static inline void
-__instr_hdr_extract_exec(struct rte_swx_pipeline *p, uint32_t n_extract);
-
-static inline void
-__instr_hdr_extract_exec(struct rte_swx_pipeline *p, uint32_t n_extract)
+instr_hdr_extract_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint64_t valid_headers = t->valid_headers;
-	uint8_t *ptr = t->ptr;
-	uint32_t offset = t->pkt.offset;
-	uint32_t length = t->pkt.length;
-	uint32_t i;
-
-	for (i = 0; i < n_extract; i++) {
-		uint32_t header_id = ip->io.hdr.header_id[i];
-		uint32_t struct_id = ip->io.hdr.struct_id[i];
-		uint32_t n_bytes = ip->io.hdr.n_bytes[i];
-
-		TRACE("[Thread %2u]: extract header %u (%u bytes)\n",
-		      p->thread_id,
-		      header_id,
-		      n_bytes);
-
-		/* Headers. */
-		t->structs[struct_id] = ptr;
-		valid_headers = MASK64_BIT_SET(valid_headers, header_id);
-
-		/* Packet. */
-		offset += n_bytes;
-		length -= n_bytes;
-		ptr += n_bytes;
-	}
-
-	/* Headers. */
-	t->valid_headers = valid_headers;
-
-	/* Packet. */
-	t->pkt.offset = offset;
-	t->pkt.length = length;
-	t->ptr = ptr;
-}
 
-static inline void
-instr_hdr_extract_exec(struct rte_swx_pipeline *p)
-{
-	__instr_hdr_extract_exec(p, 1);
+	__instr_hdr_extract_exec(p, t, ip, 1);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2688,10 +1553,13 @@ instr_hdr_extract_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract2_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 2 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 2);
+	__instr_hdr_extract_exec(p, t, ip, 2);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2700,10 +1568,13 @@ instr_hdr_extract2_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract3_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 3 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 3);
+	__instr_hdr_extract_exec(p, t, ip, 3);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2712,10 +1583,13 @@ instr_hdr_extract3_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract4_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 4 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 4);
+	__instr_hdr_extract_exec(p, t, ip, 4);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2724,10 +1598,13 @@ instr_hdr_extract4_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract5_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 5 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 5);
+	__instr_hdr_extract_exec(p, t, ip, 5);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2736,10 +1613,13 @@ instr_hdr_extract5_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract6_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 6 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 6);
+	__instr_hdr_extract_exec(p, t, ip, 6);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2748,10 +1628,13 @@ instr_hdr_extract6_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract7_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 7 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 7);
+	__instr_hdr_extract_exec(p, t, ip, 7);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2760,10 +1643,13 @@ instr_hdr_extract7_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_extract8_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 8 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_extract_exec(p, 8);
+	__instr_hdr_extract_exec(p, t, ip, 8);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2795,74 +1681,12 @@ instr_hdr_emit_translate(struct rte_swx_pipeline *p,
 }
 
 static inline void
-__instr_hdr_emit_exec(struct rte_swx_pipeline *p, uint32_t n_emit);
-
-static inline void
-__instr_hdr_emit_exec(struct rte_swx_pipeline *p, uint32_t n_emit)
+instr_hdr_emit_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint32_t n_headers_out = t->n_headers_out;
-	struct header_out_runtime *ho = &t->headers_out[n_headers_out - 1];
-	uint8_t *ho_ptr = NULL;
-	uint32_t ho_nbytes = 0, i;
-
-	for (i = 0; i < n_emit; i++) {
-		uint32_t header_id = ip->io.hdr.header_id[i];
-		uint32_t struct_id = ip->io.hdr.struct_id[i];
-		uint32_t n_bytes = ip->io.hdr.n_bytes[i];
-
-		struct header_runtime *hi = &t->headers[header_id];
-		uint8_t *hi_ptr = t->structs[struct_id];
-
-		TRACE("[Thread %2u]: emit header %u\n",
-		      p->thread_id,
-		      header_id);
-
-		/* Headers. */
-		if (!i) {
-			if (!t->n_headers_out) {
-				ho = &t->headers_out[0];
-
-				ho->ptr0 = hi->ptr0;
-				ho->ptr = hi_ptr;
-
-				ho_ptr = hi_ptr;
-				ho_nbytes = n_bytes;
-
-				n_headers_out = 1;
-
-				continue;
-			} else {
-				ho_ptr = ho->ptr;
-				ho_nbytes = ho->n_bytes;
-			}
-		}
-
-		if (ho_ptr + ho_nbytes == hi_ptr) {
-			ho_nbytes += n_bytes;
-		} else {
-			ho->n_bytes = ho_nbytes;
-
-			ho++;
-			ho->ptr0 = hi->ptr0;
-			ho->ptr = hi_ptr;
 
-			ho_ptr = hi_ptr;
-			ho_nbytes = n_bytes;
-
-			n_headers_out++;
-		}
-	}
-
-	ho->n_bytes = ho_nbytes;
-	t->n_headers_out = n_headers_out;
-}
-
-static inline void
-instr_hdr_emit_exec(struct rte_swx_pipeline *p)
-{
-	__instr_hdr_emit_exec(p, 1);
+	__instr_hdr_emit_exec(p, t, ip, 1);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -2871,80 +1695,104 @@ instr_hdr_emit_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_hdr_emit_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 2 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 1);
+	__instr_hdr_emit_exec(p, t, ip, 1);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit2_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 3 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 2);
+	__instr_hdr_emit_exec(p, t, ip, 2);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit3_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 4 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 3);
+	__instr_hdr_emit_exec(p, t, ip, 3);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit4_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 5 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 4);
+	__instr_hdr_emit_exec(p, t, ip, 4);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit5_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 6 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 5);
+	__instr_hdr_emit_exec(p, t, ip, 5);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit6_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 7 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 6);
+	__instr_hdr_emit_exec(p, t, ip, 6);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit7_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 8 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 7);
+	__instr_hdr_emit_exec(p, t, ip, 7);
 	instr_tx_exec(p);
 }
 
 static inline void
 instr_hdr_emit8_tx_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 9 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_hdr_emit_exec(p, 8);
+	__instr_hdr_emit_exec(p, t, ip, 8);
 	instr_tx_exec(p);
 }
 
@@ -2976,12 +1824,8 @@ instr_hdr_validate_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint32_t header_id = ip->valid.header_id;
-
-	TRACE("[Thread %2u] validate header %u\n", p->thread_id, header_id);
 
-	/* Headers. */
-	t->valid_headers = MASK64_BIT_SET(t->valid_headers, header_id);
+	__instr_hdr_validate_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3015,12 +1859,8 @@ instr_hdr_invalidate_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint32_t header_id = ip->valid.header_id;
-
-	TRACE("[Thread %2u] invalidate header %u\n", p->thread_id, header_id);
 
-	/* Headers. */
-	t->valid_headers = MASK64_BIT_CLR(t->valid_headers, header_id);
+	__instr_hdr_invalidate_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3061,6 +1901,7 @@ instr_table_exec(struct rte_swx_pipeline *p)
 	uint32_t table_id = ip->table.table_id;
 	struct rte_swx_table_state *ts = &t->table_state[table_id];
 	struct table_runtime *table = &t->tables[table_id];
+	action_func_t action_func;
 	uint64_t action_id;
 	uint8_t *action_data;
 	int done, hit;
@@ -3096,6 +1937,13 @@ instr_table_exec(struct rte_swx_pipeline *p)
 	t->hit = hit;
 
 	/* Thread. */
+	action_func = p->action_funcs[action_id];
+	if (action_func) {
+		thread_ip_inc(p);
+		action_func(p);
+		return;
+	}
+
 	thread_ip_action_call(p, t, action_id);
 }
 
@@ -3246,10 +2094,7 @@ instr_mov_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] mov\n",
-	      p->thread_id);
-
-	MOV(t, ip);
+	__instr_mov_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3261,10 +2106,7 @@ instr_mov_s_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] mov (s)\n",
-	      p->thread_id);
-
-	MOV_S(t, ip);
+	__instr_mov_s_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3276,11 +2118,7 @@ instr_mov_i_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] mov m.f %" PRIx64 "\n",
-	      p->thread_id,
-	      ip->mov.src_val);
-
-	MOV_I(t, ip);
+	__instr_mov_i_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3321,46 +2159,12 @@ instr_dma_translate(struct rte_swx_pipeline *p,
 }
 
 static inline void
-__instr_dma_ht_exec(struct rte_swx_pipeline *p, uint32_t n_dma);
-
-static inline void
-__instr_dma_ht_exec(struct rte_swx_pipeline *p, uint32_t n_dma)
+instr_dma_ht_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint8_t *action_data = t->structs[0];
-	uint64_t valid_headers = t->valid_headers;
-	uint32_t i;
-
-	for (i = 0; i < n_dma; i++) {
-		uint32_t header_id = ip->dma.dst.header_id[i];
-		uint32_t struct_id = ip->dma.dst.struct_id[i];
-		uint32_t offset = ip->dma.src.offset[i];
-		uint32_t n_bytes = ip->dma.n_bytes[i];
-
-		struct header_runtime *h = &t->headers[header_id];
-		uint8_t *h_ptr0 = h->ptr0;
-		uint8_t *h_ptr = t->structs[struct_id];
 
-		void *dst = MASK64_BIT_GET(valid_headers, header_id) ?
-			h_ptr : h_ptr0;
-		void *src = &action_data[offset];
-
-		TRACE("[Thread %2u] dma h.s t.f\n", p->thread_id);
-
-		/* Headers. */
-		memcpy(dst, src, n_bytes);
-		t->structs[struct_id] = dst;
-		valid_headers = MASK64_BIT_SET(valid_headers, header_id);
-	}
-
-	t->valid_headers = valid_headers;
-}
-
-static inline void
-instr_dma_ht_exec(struct rte_swx_pipeline *p)
-{
-	__instr_dma_ht_exec(p, 1);
+	__instr_dma_ht_exec(p, t, ip, 1);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3369,10 +2173,13 @@ instr_dma_ht_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht2_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 2 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 2);
+	__instr_dma_ht_exec(p, t, ip, 2);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3381,10 +2188,13 @@ instr_dma_ht2_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht3_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 3 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 3);
+	__instr_dma_ht_exec(p, t, ip, 3);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3393,10 +2203,13 @@ instr_dma_ht3_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht4_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 4 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 4);
+	__instr_dma_ht_exec(p, t, ip, 4);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3405,10 +2218,13 @@ instr_dma_ht4_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht5_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 5 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 5);
+	__instr_dma_ht_exec(p, t, ip, 5);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3417,10 +2233,13 @@ instr_dma_ht5_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht6_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 6 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 6);
+	__instr_dma_ht_exec(p, t, ip, 6);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3429,10 +2248,13 @@ instr_dma_ht6_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht7_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 7 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 7);
+	__instr_dma_ht_exec(p, t, ip, 7);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3441,10 +2263,13 @@ instr_dma_ht7_exec(struct rte_swx_pipeline *p)
 static inline void
 instr_dma_ht8_exec(struct rte_swx_pipeline *p)
 {
+	struct thread *t = &p->threads[p->thread_id];
+	struct instruction *ip = t->ip;
+
 	TRACE("[Thread %2u] *** The next 8 instructions are fused. ***\n",
 	      p->thread_id);
 
-	__instr_dma_ht_exec(p, 8);
+	__instr_dma_ht_exec(p, t, ip, 8);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3898,10 +2723,7 @@ instr_alu_add_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, +);
+	__instr_alu_add_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3913,10 +2735,7 @@ instr_alu_add_mh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add (mh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MH(t, ip, +);
+	__instr_alu_add_mh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3928,10 +2747,7 @@ instr_alu_add_hm_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add (hm)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HM(t, ip, +);
+	__instr_alu_add_hm_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3943,10 +2759,7 @@ instr_alu_add_hh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add (hh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HH(t, ip, +);
+	__instr_alu_add_hh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3958,10 +2771,7 @@ instr_alu_add_mi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add (mi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MI(t, ip, +);
+	__instr_alu_add_mi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3973,10 +2783,7 @@ instr_alu_add_hi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] add (hi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HI(t, ip, +);
+	__instr_alu_add_hi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -3988,10 +2795,7 @@ instr_alu_sub_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, -);
+	__instr_alu_sub_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4003,10 +2807,7 @@ instr_alu_sub_mh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub (mh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MH(t, ip, -);
+	__instr_alu_sub_mh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4018,10 +2819,7 @@ instr_alu_sub_hm_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub (hm)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HM(t, ip, -);
+	__instr_alu_sub_hm_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4033,10 +2831,7 @@ instr_alu_sub_hh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub (hh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HH(t, ip, -);
+	__instr_alu_sub_hh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4048,10 +2843,7 @@ instr_alu_sub_mi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub (mi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MI(t, ip, -);
+	__instr_alu_sub_mi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4063,10 +2855,7 @@ instr_alu_sub_hi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] sub (hi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HI(t, ip, -);
+	__instr_alu_sub_hi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4078,10 +2867,7 @@ instr_alu_shl_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, <<);
+	__instr_alu_shl_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4093,10 +2879,7 @@ instr_alu_shl_mh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl (mh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MH(t, ip, <<);
+	__instr_alu_shl_mh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4108,10 +2891,7 @@ instr_alu_shl_hm_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl (hm)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HM(t, ip, <<);
+	__instr_alu_shl_hm_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4123,10 +2903,7 @@ instr_alu_shl_hh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl (hh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HH(t, ip, <<);
+	__instr_alu_shl_hh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4138,10 +2915,7 @@ instr_alu_shl_mi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl (mi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MI(t, ip, <<);
+	__instr_alu_shl_mi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4153,10 +2927,7 @@ instr_alu_shl_hi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shl (hi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HI(t, ip, <<);
+	__instr_alu_shl_hi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4168,10 +2939,7 @@ instr_alu_shr_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, >>);
+	__instr_alu_shr_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4183,10 +2951,7 @@ instr_alu_shr_mh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr (mh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MH(t, ip, >>);
+	__instr_alu_shr_mh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4198,10 +2963,7 @@ instr_alu_shr_hm_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr (hm)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HM(t, ip, >>);
+	__instr_alu_shr_hm_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4213,10 +2975,7 @@ instr_alu_shr_hh_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr (hh)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HH(t, ip, >>);
+	__instr_alu_shr_hh_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4228,10 +2987,7 @@ instr_alu_shr_mi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr (mi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_MI(t, ip, >>);
+	__instr_alu_shr_mi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4243,10 +2999,7 @@ instr_alu_shr_hi_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] shr (hi)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_HI(t, ip, >>);
+	__instr_alu_shr_hi_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4258,10 +3011,7 @@ instr_alu_and_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] and\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, &);
+	__instr_alu_and_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4273,10 +3023,7 @@ instr_alu_and_s_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] and (s)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_S(t, ip, &);
+	__instr_alu_and_s_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4288,10 +3035,7 @@ instr_alu_and_i_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] and (i)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_I(t, ip, &);
+	__instr_alu_and_i_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4303,10 +3047,7 @@ instr_alu_or_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] or\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, |);
+	__instr_alu_or_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4318,10 +3059,7 @@ instr_alu_or_s_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] or (s)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_S(t, ip, |);
+	__instr_alu_or_s_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4333,10 +3071,7 @@ instr_alu_or_i_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] or (i)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_I(t, ip, |);
+	__instr_alu_or_i_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4348,10 +3083,7 @@ instr_alu_xor_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] xor\n", p->thread_id);
-
-	/* Structs. */
-	ALU(t, ip, ^);
+	__instr_alu_xor_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4363,10 +3095,7 @@ instr_alu_xor_s_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] xor (s)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_S(t, ip, ^);
+	__instr_alu_xor_s_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4378,10 +3107,7 @@ instr_alu_xor_i_exec(struct rte_swx_pipeline *p)
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
 
-	TRACE("[Thread %2u] xor (i)\n", p->thread_id);
-
-	/* Structs. */
-	ALU_I(t, ip, ^);
+	__instr_alu_xor_i_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4392,55 +3118,8 @@ instr_alu_ckadd_field_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint8_t *dst_struct, *src_struct;
-	uint16_t *dst16_ptr, dst;
-	uint64_t *src64_ptr, src64, src64_mask, src;
-	uint64_t r;
-
-	TRACE("[Thread %2u] ckadd (field)\n", p->thread_id);
-
-	/* Structs. */
-	dst_struct = t->structs[ip->alu.dst.struct_id];
-	dst16_ptr = (uint16_t *)&dst_struct[ip->alu.dst.offset];
-	dst = *dst16_ptr;
-
-	src_struct = t->structs[ip->alu.src.struct_id];
-	src64_ptr = (uint64_t *)&src_struct[ip->alu.src.offset];
-	src64 = *src64_ptr;
-	src64_mask = UINT64_MAX >> (64 - ip->alu.src.n_bits);
-	src = src64 & src64_mask;
-
-	r = dst;
-	r = ~r & 0xFFFF;
-
-	/* The first input (r) is a 16-bit number. The second and the third
-	 * inputs are 32-bit numbers. In the worst case scenario, the sum of the
-	 * three numbers (output r) is a 34-bit number.
-	 */
-	r += (src >> 32) + (src & 0xFFFFFFFF);
 
-	/* The first input is a 16-bit number. The second input is an 18-bit
-	 * number. In the worst case scenario, the sum of the two numbers is a
-	 * 19-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* The first input is a 16-bit number (0 .. 0xFFFF). The second input is
-	 * a 3-bit number (0 .. 7). Their sum is a 17-bit number (0 .. 0x10006).
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* When the input r is (0 .. 0xFFFF), the output r is equal to the input
-	 * r, so the output is (0 .. 0xFFFF). When the input r is (0x10000 ..
-	 * 0x10006), the output r is (0 .. 7). So no carry bit can be generated,
-	 * therefore the output r is always a 16-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	r = ~r & 0xFFFF;
-	r = r ? r : 0xFFFF;
-
-	*dst16_ptr = (uint16_t)r;
+	__instr_alu_ckadd_field_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4451,67 +3130,8 @@ instr_alu_cksub_field_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint8_t *dst_struct, *src_struct;
-	uint16_t *dst16_ptr, dst;
-	uint64_t *src64_ptr, src64, src64_mask, src;
-	uint64_t r;
-
-	TRACE("[Thread %2u] cksub (field)\n", p->thread_id);
-
-	/* Structs. */
-	dst_struct = t->structs[ip->alu.dst.struct_id];
-	dst16_ptr = (uint16_t *)&dst_struct[ip->alu.dst.offset];
-	dst = *dst16_ptr;
-
-	src_struct = t->structs[ip->alu.src.struct_id];
-	src64_ptr = (uint64_t *)&src_struct[ip->alu.src.offset];
-	src64 = *src64_ptr;
-	src64_mask = UINT64_MAX >> (64 - ip->alu.src.n_bits);
-	src = src64 & src64_mask;
-
-	r = dst;
-	r = ~r & 0xFFFF;
-
-	/* Subtraction in 1's complement arithmetic (i.e. a '- b) is the same as
-	 * the following sequence of operations in 2's complement arithmetic:
-	 *    a '- b = (a - b) % 0xFFFF.
-	 *
-	 * In order to prevent an underflow for the below subtraction, in which
-	 * a 33-bit number (the subtrahend) is taken out of a 16-bit number (the
-	 * minuend), we first add a multiple of the 0xFFFF modulus to the
-	 * minuend. The number we add to the minuend needs to be a 34-bit number
-	 * or higher, so for readability reasons we picked the 36-bit multiple.
-	 * We are effectively turning the 16-bit minuend into a 36-bit number:
-	 *    (a - b) % 0xFFFF = (a + 0xFFFF00000 - b) % 0xFFFF.
-	 */
-	r += 0xFFFF00000ULL; /* The output r is a 36-bit number. */
-
-	/* A 33-bit number is subtracted from a 36-bit number (the input r). The
-	 * result (the output r) is a 36-bit number.
-	 */
-	r -= (src >> 32) + (src & 0xFFFFFFFF);
 
-	/* The first input is a 16-bit number. The second input is a 20-bit
-	 * number. Their sum is a 21-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* The first input is a 16-bit number (0 .. 0xFFFF). The second input is
-	 * a 5-bit number (0 .. 31). The sum is a 17-bit number (0 .. 0x1001E).
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* When the input r is (0 .. 0xFFFF), the output r is equal to the input
-	 * r, so the output is (0 .. 0xFFFF). When the input r is (0x10000 ..
-	 * 0x1001E), the output r is (0 .. 31). So no carry bit can be
-	 * generated, therefore the output r is always a 16-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	r = ~r & 0xFFFF;
-	r = r ? r : 0xFFFF;
-
-	*dst16_ptr = (uint16_t)r;
+	__instr_alu_cksub_field_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4522,47 +3142,8 @@ instr_alu_ckadd_struct20_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint8_t *dst_struct, *src_struct;
-	uint16_t *dst16_ptr;
-	uint32_t *src32_ptr;
-	uint64_t r0, r1;
-
-	TRACE("[Thread %2u] ckadd (struct of 20 bytes)\n", p->thread_id);
 
-	/* Structs. */
-	dst_struct = t->structs[ip->alu.dst.struct_id];
-	dst16_ptr = (uint16_t *)&dst_struct[ip->alu.dst.offset];
-
-	src_struct = t->structs[ip->alu.src.struct_id];
-	src32_ptr = (uint32_t *)&src_struct[0];
-
-	r0 = src32_ptr[0]; /* r0 is a 32-bit number. */
-	r1 = src32_ptr[1]; /* r1 is a 32-bit number. */
-	r0 += src32_ptr[2]; /* The output r0 is a 33-bit number. */
-	r1 += src32_ptr[3]; /* The output r1 is a 33-bit number. */
-	r0 += r1 + src32_ptr[4]; /* The output r0 is a 35-bit number. */
-
-	/* The first input is a 16-bit number. The second input is a 19-bit
-	 * number. Their sum is a 20-bit number.
-	 */
-	r0 = (r0 & 0xFFFF) + (r0 >> 16);
-
-	/* The first input is a 16-bit number (0 .. 0xFFFF). The second input is
-	 * a 4-bit number (0 .. 15). The sum is a 17-bit number (0 .. 0x1000E).
-	 */
-	r0 = (r0 & 0xFFFF) + (r0 >> 16);
-
-	/* When the input r is (0 .. 0xFFFF), the output r is equal to the input
-	 * r, so the output is (0 .. 0xFFFF). When the input r is (0x10000 ..
-	 * 0x1000E), the output r is (0 .. 15). So no carry bit can be
-	 * generated, therefore the output r is always a 16-bit number.
-	 */
-	r0 = (r0 & 0xFFFF) + (r0 >> 16);
-
-	r0 = ~r0 & 0xFFFF;
-	r0 = r0 ? r0 : 0xFFFF;
-
-	*dst16_ptr = (uint16_t)r0;
+	__instr_alu_ckadd_struct20_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -4573,49 +3154,8 @@ instr_alu_ckadd_struct_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	uint8_t *dst_struct, *src_struct;
-	uint16_t *dst16_ptr;
-	uint32_t *src32_ptr;
-	uint64_t r = 0;
-	uint32_t i;
-
-	TRACE("[Thread %2u] ckadd (struct)\n", p->thread_id);
 
-	/* Structs. */
-	dst_struct = t->structs[ip->alu.dst.struct_id];
-	dst16_ptr = (uint16_t *)&dst_struct[ip->alu.dst.offset];
-
-	src_struct = t->structs[ip->alu.src.struct_id];
-	src32_ptr = (uint32_t *)&src_struct[0];
-
-	/* The max number of 32-bit words in a 256-byte header is 8 = 2^3.
-	 * Therefore, in the worst case scenario, a 35-bit number is added to a
-	 * 16-bit number (the input r), so the output r is 36-bit number.
-	 */
-	for (i = 0; i < ip->alu.src.n_bits / 32; i++, src32_ptr++)
-		r += *src32_ptr;
-
-	/* The first input is a 16-bit number. The second input is a 20-bit
-	 * number. Their sum is a 21-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* The first input is a 16-bit number (0 .. 0xFFFF). The second input is
-	 * a 5-bit number (0 .. 31). The sum is a 17-bit number (0 .. 0x1000E).
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	/* When the input r is (0 .. 0xFFFF), the output r is equal to the input
-	 * r, so the output is (0 .. 0xFFFF). When the input r is (0x10000 ..
-	 * 0x1001E), the output r is (0 .. 31). So no carry bit can be
-	 * generated, therefore the output r is always a 16-bit number.
-	 */
-	r = (r & 0xFFFF) + (r >> 16);
-
-	r = ~r & 0xFFFF;
-	r = r ? r : 0xFFFF;
-
-	*dst16_ptr = (uint16_t)r;
+	__instr_alu_ckadd_struct_exec(p, t, ip);
 
 	/* Thread. */
 	thread_ip_inc(p);
@@ -5085,7 +3625,7 @@ instr_jmp_eq_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpeq\n", p->thread_id);
 
-	JMP_CMP(t, ip, ==);
+	t->ip = JMP_CMP(t, ip, ==) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5096,7 +3636,7 @@ instr_jmp_eq_s_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpeq (s)\n", p->thread_id);
 
-	JMP_CMP_S(t, ip, ==);
+	t->ip = JMP_CMP_S(t, ip, ==) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5107,7 +3647,7 @@ instr_jmp_eq_i_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpeq (i)\n", p->thread_id);
 
-	JMP_CMP_I(t, ip, ==);
+	t->ip = JMP_CMP_I(t, ip, ==) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5118,7 +3658,7 @@ instr_jmp_neq_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpneq\n", p->thread_id);
 
-	JMP_CMP(t, ip, !=);
+	t->ip = JMP_CMP(t, ip, !=) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5129,7 +3669,7 @@ instr_jmp_neq_s_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpneq (s)\n", p->thread_id);
 
-	JMP_CMP_S(t, ip, !=);
+	t->ip = JMP_CMP_S(t, ip, !=) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5140,7 +3680,7 @@ instr_jmp_neq_i_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpneq (i)\n", p->thread_id);
 
-	JMP_CMP_I(t, ip, !=);
+	t->ip = JMP_CMP_I(t, ip, !=) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5151,7 +3691,7 @@ instr_jmp_lt_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt\n", p->thread_id);
 
-	JMP_CMP(t, ip, <);
+	t->ip = JMP_CMP(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5162,7 +3702,7 @@ instr_jmp_lt_mh_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt (mh)\n", p->thread_id);
 
-	JMP_CMP_MH(t, ip, <);
+	t->ip = JMP_CMP_MH(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5173,7 +3713,7 @@ instr_jmp_lt_hm_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt (hm)\n", p->thread_id);
 
-	JMP_CMP_HM(t, ip, <);
+	t->ip = JMP_CMP_HM(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5184,7 +3724,7 @@ instr_jmp_lt_hh_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt (hh)\n", p->thread_id);
 
-	JMP_CMP_HH(t, ip, <);
+	t->ip = JMP_CMP_HH(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5195,7 +3735,7 @@ instr_jmp_lt_mi_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt (mi)\n", p->thread_id);
 
-	JMP_CMP_MI(t, ip, <);
+	t->ip = JMP_CMP_MI(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5206,7 +3746,7 @@ instr_jmp_lt_hi_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmplt (hi)\n", p->thread_id);
 
-	JMP_CMP_HI(t, ip, <);
+	t->ip = JMP_CMP_HI(t, ip, <) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5217,7 +3757,7 @@ instr_jmp_gt_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt\n", p->thread_id);
 
-	JMP_CMP(t, ip, >);
+	t->ip = JMP_CMP(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5228,7 +3768,7 @@ instr_jmp_gt_mh_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt (mh)\n", p->thread_id);
 
-	JMP_CMP_MH(t, ip, >);
+	t->ip = JMP_CMP_MH(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5239,7 +3779,7 @@ instr_jmp_gt_hm_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt (hm)\n", p->thread_id);
 
-	JMP_CMP_HM(t, ip, >);
+	t->ip = JMP_CMP_HM(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5250,7 +3790,7 @@ instr_jmp_gt_hh_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt (hh)\n", p->thread_id);
 
-	JMP_CMP_HH(t, ip, >);
+	t->ip = JMP_CMP_HH(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5261,7 +3801,7 @@ instr_jmp_gt_mi_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt (mi)\n", p->thread_id);
 
-	JMP_CMP_MI(t, ip, >);
+	t->ip = JMP_CMP_MI(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 static inline void
@@ -5272,7 +3812,7 @@ instr_jmp_gt_hi_exec(struct rte_swx_pipeline *p)
 
 	TRACE("[Thread %2u] jmpgt (hi)\n", p->thread_id);
 
-	JMP_CMP_HI(t, ip, >);
+	t->ip = JMP_CMP_HI(t, ip, >) ? ip->jmp.ip : (t->ip + 1);
 }
 
 /*
@@ -5633,7 +4173,7 @@ instr_label_check(struct instruction_data *instruction_data,
 			continue;
 
 		for (j = i + 1; j < n_instructions; j++)
-			CHECK(strcmp(label, data[j].label), EINVAL);
+			CHECK(strcmp(label, instruction_data[j].label), EINVAL);
 	}
 
 	/* Get users for each instruction label. */
@@ -6025,8 +4565,6 @@ error:
 	return err;
 }
 
-typedef void (*instr_exec_t)(struct rte_swx_pipeline *);
-
 static instr_exec_t instruction_table[] = {
 	[INSTR_RX] = instr_rx_exec,
 	[INSTR_TX] = instr_tx_exec,
@@ -6153,7 +4691,7 @@ instr_exec(struct rte_swx_pipeline *p)
 {
 	struct thread *t = &p->threads[p->thread_id];
 	struct instruction *ip = t->ip;
-	instr_exec_t instr = instruction_table[ip->type];
+	instr_exec_t instr = p->instruction_table[ip->type];
 
 	instr(p);
 }
@@ -6262,12 +4800,18 @@ action_build(struct rte_swx_pipeline *p)
 	TAILQ_FOREACH(action, &p->actions, node)
 		p->action_instructions[action->id] = action->instructions;
 
+	p->action_funcs = calloc(p->n_actions, sizeof(action_func_t));
+	CHECK(p->action_funcs, ENOMEM);
+
 	return 0;
 }
 
 static void
 action_build_free(struct rte_swx_pipeline *p)
 {
+	free(p->action_funcs);
+	p->action_funcs = NULL;
+
 	free(p->action_instructions);
 	p->action_instructions = NULL;
 }
@@ -6855,6 +5399,10 @@ rte_swx_pipeline_config(struct rte_swx_pipeline **p, int numa_node)
 	pipeline->n_structs = 1; /* Struct 0 is reserved for action_data. */
 	pipeline->numa_node = numa_node;
 
+	memcpy(pipeline->instruction_table,
+	       instruction_table,
+	       sizeof(instruction_table));
+
 	*p = pipeline;
 	return 0;
 }
@@ -6865,6 +5413,9 @@ rte_swx_pipeline_free(struct rte_swx_pipeline *p)
 	if (!p)
 		return;
 
+	if (p->lib)
+		dlclose(p->lib);
+
 	free(p->instructions);
 
 	table_state_free(p);
@@ -6991,6 +5542,789 @@ rte_swx_pipeline_flush(struct rte_swx_pipeline *p)
 	}
 }
 
+/*
+ * Code generation.
+ */
+struct instruction_group {
+	uint32_t first; /* Position of the first instruction of the group. */
+	uint32_t n_instructions;
+};
+
+static int
+instr_codegen_body(struct instruction *instr,
+		   const char *array,
+		   uint32_t pos,
+		   FILE *f)
+{
+	static const char * const exec[] = {
+		[INSTR_HDR_EXTRACT] = "hdr_extract",
+		[INSTR_HDR_EMIT] = "hdr_emit",
+		[INSTR_HDR_VALIDATE] = "hdr_validate",
+		[INSTR_HDR_INVALIDATE] = "hdr_invalidate",
+
+		[INSTR_MOV] = "mov",
+		[INSTR_MOV_S] = "mov_s",
+		[INSTR_MOV_I] = "mov_i",
+
+		[INSTR_DMA_HT] = "dma_ht",
+
+		[INSTR_ALU_ADD] = "alu_add",
+		[INSTR_ALU_ADD_MH] = "alu_add_mh",
+		[INSTR_ALU_ADD_HM] = "alu_add_hm",
+		[INSTR_ALU_ADD_HH] = "alu_add_hh",
+		[INSTR_ALU_ADD_MI] = "alu_add_mi",
+		[INSTR_ALU_ADD_HI] = "alu_add_hi",
+
+		[INSTR_ALU_SUB] = "alu_sub",
+		[INSTR_ALU_SUB_MH] = "alu_sub_mh",
+		[INSTR_ALU_SUB_HM] = "alu_sub_hm",
+		[INSTR_ALU_SUB_HH] = "alu_sub_hh",
+		[INSTR_ALU_SUB_MI] = "alu_sub_mi",
+		[INSTR_ALU_SUB_HI] = "alu_sub_hi",
+
+		[INSTR_ALU_CKADD_FIELD] = "alu_ckadd_field",
+		[INSTR_ALU_CKADD_STRUCT20] = "alu_ckadd_struct20",
+		[INSTR_ALU_CKADD_STRUCT] = "alu_ckadd_struct",
+		[INSTR_ALU_CKSUB_FIELD] = "alu_cksub_field",
+
+		[INSTR_ALU_AND] = "alu_and",
+		[INSTR_ALU_AND_S] = "alu_and_s",
+		[INSTR_ALU_AND_I] = "alu_and_i",
+
+		[INSTR_ALU_OR] = "alu_or",
+		[INSTR_ALU_OR_S] = "alu_or_s",
+		[INSTR_ALU_OR_I] = "alu_or_i",
+
+		[INSTR_ALU_XOR] = "alu_xor",
+		[INSTR_ALU_XOR_S] = "alu_xor_s",
+		[INSTR_ALU_XOR_I] = "alu_xor_i",
+
+		[INSTR_ALU_SHL] = "alu_shl",
+		[INSTR_ALU_SHL_MH] = "alu_shl_mh",
+		[INSTR_ALU_SHL_HM] = "alu_shl_hm",
+		[INSTR_ALU_SHL_HH] = "alu_shl_hh",
+		[INSTR_ALU_SHL_MI] = "alu_shl_mi",
+		[INSTR_ALU_SHL_HI] = "alu_shl_hi",
+
+		[INSTR_ALU_SHR] = "alu_shr",
+		[INSTR_ALU_SHR_MH] = "alu_shr_mh",
+		[INSTR_ALU_SHR_HM] = "alu_shr_hm",
+		[INSTR_ALU_SHR_HH] = "alu_shr_hh",
+		[INSTR_ALU_SHR_MI] = "alu_shr_mi",
+		[INSTR_ALU_SHR_HI] = "alu_shr_hi",
+	};
+	enum instruction_type type = instr->type;
+
+	/* Fused instructions. */
+	if ((type >= INSTR_HDR_EXTRACT) && (type <= INSTR_HDR_EXTRACT8)) {
+		fprintf(f,
+			"\t__instr_hdr_extract_exec(p, t, &%s[%u], %u);\n",
+			array,
+			pos,
+			type - INSTR_HDR_EXTRACT + 1);
+		return 0;
+	}
+
+	if ((type >= INSTR_DMA_HT) && (type <= INSTR_DMA_HT8)) {
+		fprintf(f,
+			"\t__instr_dma_ht_exec(p, t, &%s[%u], %u);\n",
+			array,
+			pos,
+			type - INSTR_DMA_HT + 1);
+		return 0;
+	}
+
+	if (type == INSTR_HDR_EMIT) {
+		fprintf(f,
+			"\t__instr_hdr_emit_exec(p, t, &%s[%u], 1);\n",
+			array,
+			pos);
+		return 0;
+	}
+
+	/* Any other instruction with a single execution function. */
+	if ((type >= RTE_DIM(exec)) || !exec[type])
+		return -ENOTSUP;
+
+	fprintf(f,
+		"\t__instr_%s_exec(p, t, &%s[%u]);\n",
+		exec[type],
+		array,
+		pos);
+	return 0;
+}
+
+static int
+instr_codegen_jmp_cond(struct instruction *instr,
+		       const char *array,
+		       uint32_t pos,
+		       FILE *f)
+{
+	static const char * const cmp[] = {
+		[INSTR_JMP_EQ] = "JMP_CMP",
+		[INSTR_JMP_EQ_S] = "JMP_CMP_S",
+		[INSTR_JMP_EQ_I] = "JMP_CMP_I",
+
+		[INSTR_JMP_NEQ] = "JMP_CMP",
+		[INSTR_JMP_NEQ_S] = "JMP_CMP_S",
+		[INSTR_JMP_NEQ_I] = "JMP_CMP_I",
+
+		[INSTR_JMP_LT] = "JMP_CMP",
+		[INSTR_JMP_LT_MH] = "JMP_CMP_MH",
+		[INSTR_JMP_LT_HM] = "JMP_CMP_HM",
+		[INSTR_JMP_LT_HH] = "JMP_CMP_HH",
+		[INSTR_JMP_LT_MI] = "JMP_CMP_MI",
+		[INSTR_JMP_LT_HI] = "JMP_CMP_HI",
+
+		[INSTR_JMP_GT] = "JMP_CMP",
+		[INSTR_JMP_GT_MH] = "JMP_CMP_MH",
+		[INSTR_JMP_GT_HM] = "JMP_CMP_HM",
+		[INSTR_JMP_GT_HH] = "JMP_CMP_HH",
+		[INSTR_JMP_GT_MI] = "JMP_CMP_MI",
+		[INSTR_JMP_GT_HI] = "JMP_CMP_HI",
+	};
+	enum instruction_type type = instr->type;
+	const char *op;
+
+	switch (type) {
+	case INSTR_JMP:
+		fprintf(f, "1");
+		return 0;
+
+	case INSTR_JMP_VALID:
+		fprintf(f, "HEADER_VALID(t, %u)", instr->jmp.header_id);
+		return 0;
+
+	case INSTR_JMP_INVALID:
+		fprintf(f, "!HEADER_VALID(t, %u)", instr->jmp.header_id);
+		return 0;
+
+	case INSTR_JMP_HIT:
+		fprintf(f, "t->hit");
+		return 0;
+
+	case INSTR_JMP_MISS:
+		fprintf(f, "!t->hit");
+		return 0;
+
+	case INSTR_JMP_ACTION_HIT:
+		fprintf(f, "t->action_id == %u", instr->jmp.action_id);
+		return 0;
+
+	case INSTR_JMP_ACTION_MISS:
+		fprintf(f, "t->action_id != %u", instr->jmp.action_id);
+		return 0;
+
+	case INSTR_JMP_EQ:
+	case INSTR_JMP_EQ_S:
+	case INSTR_JMP_EQ_I:
+		op = "==";
+		break;
+
+	case INSTR_JMP_NEQ:
+	case INSTR_JMP_NEQ_S:
+	case INSTR_JMP_NEQ_I:
+		op = "!=";
+		break;
+
+	case INSTR_JMP_LT:
+	case INSTR_JMP_LT_MH:
+	case INSTR_JMP_LT_HM:
+	case INSTR_JMP_LT_HH:
+	case INSTR_JMP_LT_MI:
+	case INSTR_JMP_LT_HI:
+		op = "<";
+		break;
+
+	case INSTR_JMP_GT:
+	case INSTR_JMP_GT_MH:
+	case INSTR_JMP_GT_HM:
+	case INSTR_JMP_GT_HH:
+	case INSTR_JMP_GT_MI:
+	case INSTR_JMP_GT_HI:
+		op = ">";
+		break;
+
+	default:
+		return -ENOTSUP;
+	}
+
+	fprintf(f, "%s(t, &%s[%u], %s)", cmp[type], array, pos, op);
+	return 0;
+}
+
+static int
+instr_src_is_imm(enum instruction_type type)
+{
+	switch (type) {
+	case INSTR_MOV_I:
+	case INSTR_ALU_ADD_MI:
+	case INSTR_ALU_ADD_HI:
+	case INSTR_ALU_SUB_MI:
+	case INSTR_ALU_SUB_HI:
+	case INSTR_ALU_AND_I:
+	case INSTR_ALU_OR_I:
+	case INSTR_ALU_XOR_I:
+	case INSTR_ALU_SHL_MI:
+	case INSTR_ALU_SHL_HI:
+	case INSTR_ALU_SHR_MI:
+	case INSTR_ALU_SHR_HI:
+	case INSTR_JMP_EQ_I:
+	case INSTR_JMP_NEQ_I:
+	case INSTR_JMP_LT_MI:
+	case INSTR_JMP_LT_HI:
+	case INSTR_JMP_GT_MI:
+	case INSTR_JMP_GT_HI:
+		return 1;
+
+	default:
+		return 0;
+	}
+}
+
+static void
+instr_operand_export(struct instr_operand *op, const char *name, FILE *f)
+{
+	fprintf(f,
+		".%s = {.struct_id = %u, .n_bits = %u, .offset = %u}",
+		name,
+		op->struct_id,
+		op->n_bits,
+		op->offset);
+}
+
+static void
+u8_array_export(uint8_t *a, const char *name, FILE *f)
+{
+	fprintf(f,
+		".%s = {%u, %u, %u, %u, %u, %u, %u, %u}",
+		name,
+		a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+}
+
+static void
+instr_export(struct instruction *instr, FILE *f)
+{
+	enum instruction_type type = instr->type;
+
+	fprintf(f, "\t{\n\t\t.type = %u,\n", type);
+
+	if ((type == INSTR_RX) ||
+	    (type == INSTR_TX) ||
+	    ((type >= INSTR_HDR_EXTRACT) && (type <= INSTR_HDR_EMIT8_TX))) {
+		fprintf(f,
+			"\t\t.io = {\n"
+			"\t\t\t.io = {.offset = %u, .n_bits = %u},\n"
+			"\t\t\t.hdr = {\n\t\t\t\t",
+			instr->io.io.offset,
+			instr->io.io.n_bits);
+		u8_array_export(instr->io.hdr.header_id, "header_id", f);
+		fprintf(f, ",\n\t\t\t\t");
+		u8_array_export(instr->io.hdr.struct_id, "struct_id", f);
+		fprintf(f, ",\n\t\t\t\t");
+		u8_array_export(instr->io.hdr.n_bytes, "n_bytes", f);
+		fprintf(f, ",\n\t\t\t},\n\t\t},\n");
+	} else if ((type == INSTR_HDR_VALIDATE) ||
+		   (type == INSTR_HDR_INVALIDATE)) {
+		fprintf(f,
+			"\t\t.valid = {.header_id = %u},\n",
+			instr->valid.header_id);
+	} else if ((type >= INSTR_MOV) && (type <= INSTR_MOV_I)) {
+		fprintf(f, "\t\t.mov = {\n\t\t\t");
+		instr_operand_export(&instr->mov.dst, "dst", f);
+		fprintf(f, ",\n\t\t\t");
+		if (instr_src_is_imm(type))
+			fprintf(f, ".src_val = %" PRIu64 "LLU",
+				instr->mov.src_val);
+		else
+			instr_operand_export(&instr->mov.src, "src", f);
+		fprintf(f, ",\n\t\t},\n");
+	} else if ((type >= INSTR_DMA_HT) && (type <= INSTR_DMA_HT8)) {
+		uint16_t *n_bytes = instr->dma.n_bytes;
+
+		fprintf(f, "\t\t.dma = {\n\t\t\t.dst = {\n\t\t\t\t");
+		u8_array_export(instr->dma.dst.header_id, "header_id", f);
+		fprintf(f, ",\n\t\t\t\t");
+		u8_array_export(instr->dma.dst.struct_id, "struct_id", f);
+		fprintf(f, ",\n\t\t\t},\n\t\t\t.src = {");
+		u8_array_export(instr->dma.src.offset, "offset", f);
+		fprintf(f,
+			"},\n"
+			"\t\t\t.n_bytes = {%u, %u, %u, %u, %u, %u, %u, %u},\n"
+			"\t\t},\n",
+			n_bytes[0], n_bytes[1], n_bytes[2], n_bytes[3],
+			n_bytes[4], n_bytes[5], n_bytes[6], n_bytes[7]);
+	} else if ((type >= INSTR_ALU_ADD) && (type <= INSTR_ALU_SHR_HI)) {
+		fprintf(f, "\t\t.alu = {\n\t\t\t");
+		instr_operand_export(&instr->alu.dst, "dst", f);
+		fprintf(f, ",\n\t\t\t");
+		if (instr_src_is_imm(type))
+			fprintf(f, ".src_val = %" PRIu64 "LLU",
+				instr->alu.src_val);
+		else
+			instr_operand_export(&instr->alu.src, "src", f);
+		fprintf(f, ",\n\t\t},\n");
+	} else if (type == INSTR_TABLE) {
+		fprintf(f,
+			"\t\t.table = {.table_id = %u},\n",
+			instr->table.table_id);
+	} else if (type == INSTR_EXTERN_OBJ) {
+		fprintf(f,
+			"\t\t.ext_obj = {.ext_obj_id = %u, .func_id = %u},\n",
+			instr->ext_obj.ext_obj_id,
+			instr->ext_obj.func_id);
+	} else if (type == INSTR_EXTERN_FUNC) {
+		fprintf(f,
+			"\t\t.ext_func = {.ext_func_id = %u},\n",
+			instr->ext_func.ext_func_id);
+	} else if ((type == INSTR_JMP_VALID) || (type == INSTR_JMP_INVALID)) {
+		fprintf(f,
+			"\t\t.jmp = {.header_id = %u},\n",
+			instr->jmp.header_id);
+	} else if ((type == INSTR_JMP_ACTION_HIT) ||
+		   (type == INSTR_JMP_ACTION_MISS)) {
+		fprintf(f,
+			"\t\t.jmp = {.action_id = %u},\n",
+			instr->jmp.action_id);
+	} else if ((type >= INSTR_JMP_EQ) && (type <= INSTR_JMP_GT_HI)) {
+		fprintf(f, "\t\t.jmp = {\n\t\t\t");
+		instr_operand_export(&instr->jmp.a, "a", f);
+		fprintf(f, ",\n\t\t\t");
+		if (instr_src_is_imm(type))
+			fprintf(f, ".b_val = %" PRIu64 "LLU",
+				instr->jmp.b_val);
+		else
+			instr_operand_export(&instr->jmp.b, "b", f);
+		fprintf(f, ",\n\t\t},\n");
+	}
+
+	fprintf(f, "\t},\n");
+}
+
+static void
+instr_array_export(struct instruction *instructions,
+		   uint32_t n_instructions,
+		   const char *array,
+		   FILE *f)
+{
+	uint32_t i;
+
+	fprintf(f,
+		"static const struct instruction %s[] __rte_unused = {\n",
+		array);
+
+	for (i = 0; i < n_instructions; i++)
+		instr_export(&instructions[i], f);
+
+	fprintf(f, "};\n\n");
+}
+
+static int
+action_codegen_check(struct action *a)
+{
+	uint32_t i;
+
+	/* Extern instructions may need to be retried after the thread yields,
+	 * so they cannot be part of straight-line code.
+	 */
+	for (i = 0; i < a->n_instructions; i++) {
+		enum instruction_type type = a->instructions[i].type;
+
+		if ((type == INSTR_EXTERN_OBJ) || (type == INSTR_EXTERN_FUNC))
+			return 0;
+	}
+
+	return 1;
+}
+
+static int
+action_codegen(struct action *a, FILE *f)
+{
+	struct instruction *instructions = a->instructions;
+	char array[RTE_SWX_NAME_SIZE];
+	uint8_t *is_target;
+	uint32_t i;
+	int status = 0;
+
+	snprintf(array, sizeof(array), "action_%u_instructions", a->id);
+	instr_array_export(instructions, a->n_instructions, array, f);
+
+	is_target = calloc(a->n_instructions, sizeof(uint8_t));
+	if (!is_target)
+		return -ENOMEM;
+
+	for (i = 0; i < a->n_instructions; i++)
+		if (instruction_is_jmp(&instructions[i]))
+			is_target[instructions[i].jmp.ip - instructions] = 1;
+
+	fprintf(f,
+		"/* Action %s. */\n"
+		"void\n"
+		"action_%u_run(struct rte_swx_pipeline *p)\n"
+		"{\n"
+		"\tstruct thread *t __rte_unused = &p->threads[p->thread_id];\n"
+		"\n",
+		a->name,
+		a->id);
+
+	for (i = 0; i < a->n_instructions; i++) {
+		struct instruction *instr = &instructions[i];
+		enum instruction_type type = instr->type;
+
+		if (is_target[i])
+			fprintf(f, "instr_%u:\n", i);
+
+		if (!instr_codegen_body(instr, array, i, f))
+			continue;
+
+		if (instruction_is_jmp(instr)) {
+			fprintf(f, "\tif (");
+			instr_codegen_jmp_cond(instr, array, i, f);
+			fprintf(f,
+				")\n\t\tgoto instr_%u;\n",
+				(uint32_t)(instr->jmp.ip - instructions));
+			continue;
+		}
+
+		if (type == INSTR_RETURN) {
+			fprintf(f, "\treturn;\n");
+			continue;
+		}
+
+		if ((type >= INSTR_HDR_EMIT_TX) && (type <= INSTR_HDR_EMIT8_TX))
+			fprintf(f,
+				"\t__instr_hdr_emit_exec(p, t, &%s[%u], %u);\n",
+				array,
+				i,
+				type - INSTR_HDR_EMIT);
+		else if (type != INSTR_TX) {
+			status = -ENOTSUP;
+			break;
+		}
+
+		/* The thread resumes with the rx instruction. */
+		fprintf(f,
+			"\t__instr_tx_exec(p, t, &%s[%u]);\n"
+			"\tthread_ip_reset(p, t);\n"
+			"\treturn;\n",
+			array,
+			i);
+	}
+
+	fprintf(f, "}\n\n");
+
+	free(is_target);
+	return status;
+}
+
+static int
+instr_is_group_body(enum instruction_type type)
+{
+	return ((type >= INSTR_HDR_EXTRACT) && (type <= INSTR_HDR_EMIT)) ||
+	       ((type >= INSTR_HDR_VALIDATE) && (type <= INSTR_ALU_SHR_HI));
+}
+
+/* Group the pipeline instructions into straight-line sequences. Each group
+ * starts with a non-jump instruction that does not yield the thread, contains
+ * only such instructions and can optionally end with a jump instruction. Only
+ * the first instruction of a group can be a jump target.
+ */
+static int
+instruction_groups_get(struct rte_swx_pipeline *p,
+		       struct instruction_group *groups,
+		       uint32_t *n_groups)
+{
+	struct instruction *instructions = p->instructions;
+	uint32_t n_instructions = p->n_instructions, n = 0, i;
+	uint8_t *is_target;
+
+	is_target = calloc(n_instructions, sizeof(uint8_t));
+	CHECK(is_target, ENOMEM);
+
+	for (i = 0; i < n_instructions; i++)
+		if (instruction_is_jmp(&instructions[i]))
+			is_target[instructions[i].jmp.ip - instructions] = 1;
+
+	for (i = 0; i < n_instructions; ) {
+		uint32_t first = i;
+
+		if (!instr_is_group_body(instructions[i].type)) {
+			i++;
+			continue;
+		}
+
+		for (i++; i < n_instructions; i++)
+			if (!instr_is_group_body(instructions[i].type) ||
+			    is_target[i])
+				break;
+
+		if ((i < n_instructions) &&
+		    instruction_is_jmp(&instructions[i]) &&
+		    !is_target[i])
+			i++;
+
+		if ((i - first < 2) ||
+		    (n == RTE_SWX_PIPELINE_INSTRUCTION_GROUPS_MAX))
+			continue;
+
+		groups[n].first = first;
+		groups[n].n_instructions = i - first;
+		n++;
+	}
+
+	free(is_target);
+	*n_groups = n;
+	return 0;
+}
+
+static int
+instruction_group_codegen(struct rte_swx_pipeline *p,
+			  struct instruction_group *g,
+			  uint32_t group_id,
+			  FILE *f)
+{
+	const char *array = "pipeline_instructions";
+	uint32_t last = g->first + g->n_instructions - 1, i;
+	struct instruction *instr = &p->instructions[last];
+
+	fprintf(f,
+		"/* Instructions %u .. %u. */\n"
+		"void\n"
+		"instr_group_%u_run(struct rte_swx_pipeline *p)\n"
+		"{\n"
+		"\tstruct thread *t = &p->threads[p->thread_id];\n"
+		"\n",
+		g->first,
+		last,
+		group_id);
+
+	for (i = g->first; i <= last; i++) {
+		instr = &p->instructions[i];
+
+		if (!instr_codegen_body(instr, array, i, f))
+			continue;
+
+		if (!instruction_is_jmp(instr) || (i != last))
+			return -ENOTSUP;
+
+		fprintf(f, "\tif (");
+		instr_codegen_jmp_cond(instr, array, i, f);
+		fprintf(f,
+			") {\n"
+			"\t\tt->ip += %d;\n"
+			"\t\treturn;\n"
+			"\t}\n"
+			"\n",
+			(int)(instr->jmp.ip - &p->instructions[g->first]));
+	}
+
+	fprintf(f, "\tt->ip += %u;\n}\n\n", g->n_instructions);
+	return 0;
+}
+
+/* Generate the actions and the instruction groups. */
+static int
+pipeline_codegen_body(struct rte_swx_pipeline *p, FILE *f)
+{
+	struct instruction_group *groups = NULL;
+	struct action *a;
+	uint32_t n_groups, i;
+	int status;
+
+	groups = calloc(RTE_SWX_PIPELINE_INSTRUCTION_GROUPS_MAX,
+			sizeof(struct instruction_group));
+	CHECK(groups, ENOMEM);
+
+	status = instruction_groups_get(p, groups, &n_groups);
+	if (status)
+		goto free;
+
+	/* Actions. */
+	TAILQ_FOREACH(a, &p->actions, node) {
+		if (!action_codegen_check(a)) {
+			fprintf(f, "/* Action %s is interpreted. */\n\n", a->name);
+			continue;
+		}
+
+		status = action_codegen(a, f);
+		if (status)
+			goto free;
+	}
+
+	/* Instruction groups. */
+	instr_array_export(p->instructions,
+			   p->n_instructions,
+			   "pipeline_instructions",
+			   f);
+
+	for (i = 0; i < n_groups; i++) {
+		status = instruction_group_codegen(p, &groups[i], i, f);
+		if (status)
+			goto free;
+	}
+
+free:
+	free(groups);
+	return status;
+}
+
+/* The generated code embeds all the instruction operands, i.e. the header
+ * and field offsets, the table and action IDs, etc, so its hash identifies
+ * the pipeline the code is valid for.
+ */
+static int
+pipeline_signature(struct rte_swx_pipeline *p, uint64_t *signature)
+{
+	uint64_t sig = 0xCBF29CE484222325LLU; /* FNV-1a. */
+	char *buf = NULL;
+	size_t size = 0, i;
+	FILE *f;
+	int status;
+
+	f = open_memstream(&buf, &size);
+	CHECK(f, ENOMEM);
+
+	status = pipeline_codegen_body(p, f);
+	if (fclose(f) && !status)
+		status = -ENOMEM;
+	if (status) {
+		free(buf);
+		return status;
+	}
+
+	for (i = 0; i < size; i++)
+		sig = (sig ^ (uint8_t)buf[i]) * 0x100000001B3LLU;
+
+	free(buf);
+	*signature = sig;
+	return 0;
+}
+
+int
+rte_swx_pipeline_codegen(struct rte_swx_pipeline *p, FILE *f)
+{
+	uint64_t signature;
+	int status;
+
+	CHECK(p, EINVAL);
+	CHECK(p->build_done, EINVAL);
+	CHECK(!p->lib, EEXIST);
+	CHECK(f, EINVAL);
+
+	status = pipeline_signature(p, &signature);
+	if (status)
+		return status;
+
+	fprintf(f,
+		"/* Generated by rte_swx_pipeline_codegen(). Do not edit. */\n"
+		"#include <rte_swx_pipeline_internal.h>\n"
+		"\n"
+		"const uint64_t pipeline_signature = 0x%016" PRIx64 "LLU;\n"
+		"\n"
+		"const uint64_t pipeline_size = sizeof(struct rte_swx_pipeline);\n"
+		"\n",
+		signature);
+
+	return pipeline_codegen_body(p, f);
+}
+
+int
+rte_swx_pipeline_codegen_load(struct rte_swx_pipeline *p,
+			      const char *lib_file_name)
+{
+	struct instruction_group *groups = NULL;
+	instr_exec_t *group_funcs = NULL;
+	action_func_t *action_funcs = NULL;
+	const uint64_t *signature, *size;
+	uint64_t pipeline_sig;
+	struct action *a;
+	uint32_t n_groups, i;
+	void *lib;
+	int status = 0;
+
+	CHECK(p, EINVAL);
+	CHECK(p->build_done, EINVAL);
+	CHECK(!p->lib, EEXIST);
+	CHECK(lib_file_name, EINVAL);
+
+	status = pipeline_signature(p, &pipeline_sig);
+	if (status)
+		return status;
+
+	lib = dlopen(lib_file_name, RTLD_NOW | RTLD_LOCAL);
+	CHECK(lib, ENOENT);
+
+	/* Check that the library was generated for this pipeline. */
+	signature = dlsym(lib, "pipeline_signature");
+	size = dlsym(lib, "pipeline_size");
+	if (!signature ||
+	    !size ||
+	    (*signature != pipeline_sig) ||
+	    (*size != sizeof(struct rte_swx_pipeline))) {
+		status = -EINVAL;
+		goto error;
+	}
+
+	/* Memory allocation. */
+	groups = calloc(RTE_SWX_PIPELINE_INSTRUCTION_GROUPS_MAX,
+			sizeof(struct instruction_group));
+	group_funcs = calloc(RTE_SWX_PIPELINE_INSTRUCTION_GROUPS_MAX,
+			     sizeof(instr_exec_t));
+	action_funcs = calloc(p->n_actions, sizeof(action_func_t));
+	if (!groups || !group_funcs || !action_funcs) {
+		status = -ENOMEM;
+		goto error;
+	}
+
+	/* Symbol resolution. */
+	status = instruction_groups_get(p, groups, &n_groups);
+	if (status)
+		goto error;
+
+	for (i = 0; i < n_groups; i++) {
+		char name[RTE_SWX_NAME_SIZE];
+
+		snprintf(name, sizeof(name), "instr_group_%u_run", i);
+		group_funcs[i] = (instr_exec_t)dlsym(lib, name);
+		if (!group_funcs[i]) {
+			status = -EINVAL;
+			goto error;
+		}
+	}
+
+	/* Actions that are not found in the library remain interpreted. */
+	TAILQ_FOREACH(a, &p->actions, node) {
+		char name[RTE_SWX_NAME_SIZE];
+
+		snprintf(name, sizeof(name), "action_%u_run", a->id);
+		action_funcs[a->id] = (action_func_t)dlsym(lib, name);
+	}
+
+	/* Install. */
+	for (i = 0; i < n_groups; i++) {
+		p->instruction_table[INSTR_CUSTOM_0 + i] = group_funcs[i];
+		p->instructions[groups[i].first].type = INSTR_CUSTOM_0 + i;
+	}
+
+	memcpy(p->action_funcs,
+	       action_funcs,
+	       p->n_actions * sizeof(action_func_t));
+
+	p->lib = lib;
+
+	free(action_funcs);
+	free(group_funcs);
+	free(groups);
+	return 0;
+
+error:
+	free(action_funcs);
+	free(group_funcs);
+	free(groups);
+	dlclose(lib);
+	return status;
+}
+
 /*
  * Control.
  */
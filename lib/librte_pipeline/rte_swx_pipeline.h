@@ -681,6 +681,58 @@ rte_swx_pipeline_build_from_spec(struct rte_swx_pipeline *p,
 				 uint32_t *err_line,
 				 const char **err_msg);
 
+/**
+ * Pipeline C code generate
+ *
+ * Translate the instructions of a pipeline that is already built into C code
+ * that has all the instruction operands folded in as constants: one function
+ * per action and one function per straight-line sequence of the pipeline
+ * program instructions that does not yield the current thread. The generated
+ * code includes the rte_swx_pipeline_internal.h header, so it must be compiled
+ * into a shared object library against the headers of the same DPDK build,
+ * e.g.: cc -O3 -fPIC -shared $(pkg-config --cflags libdpdk) -o lib.so lib.c
+ *
+ * @param[in] p
+ *   Pipeline handle.
+ * @param[in] f
+ *   Output file for the generated C code.
+ * @return
+ *   0 on success or the following error codes otherwise:
+ *   -EINVAL: Invalid argument or pipeline not yet built;
+ *   -ENOMEM: Not enough space/cannot allocate memory;
+ *   -EEXIST: Generated code is already loaded for this pipeline;
+ *   -ENOTSUP: Unsupported instruction.
+ */
+__rte_experimental
+int
+rte_swx_pipeline_codegen(struct rte_swx_pipeline *p, FILE *f);
+
+/**
+ * Pipeline generated code load
+ *
+ * Load the shared object library compiled from the C code generated by
+ * rte_swx_pipeline_codegen() for this pipeline and switch the pipeline to use
+ * it instead of interpreting the equivalent instructions. The actions that
+ * contain extern instructions are still interpreted. This function must not
+ * be called while the pipeline is running.
+ *
+ * @param[in] p
+ *   Pipeline handle.
+ * @param[in] lib_file_name
+ *   Shared object library file name.
+ * @return
+ *   0 on success or the following error codes otherwise:
+ *   -EINVAL: Invalid argument, pipeline not yet built or the library was not
+ *   generated for this pipeline;
+ *   -ENOMEM: Not enough space/cannot allocate memory;
+ *   -EEXIST: Generated code is already loaded for this pipeline;
+ *   -ENOENT: The library cannot be loaded.
+ */
+__rte_experimental
+int
+rte_swx_pipeline_codegen_load(struct rte_swx_pipeline *p,
+			      const char *lib_file_name);
+
 /**
  * Pipeline run
  *
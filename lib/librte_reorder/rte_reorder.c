@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <rte_string_fns.h>
+#include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_mbuf.h>
 #include <rte_mbuf_dyn.h>
@@ -42,25 +43,44 @@ struct cir_buffer {
 	struct rte_mbuf **entries;
 } __rte_cache_aligned;
 
+/* An independent sequence number space with its own window */
+struct reorder_domain {
+	uint32_t min_seqn;  /**< Lowest seq. number that can be in the buffer */
+	int is_initialized;
+	unsigned int order_cnt; /**< number of mbufs held in order_buf */
+	uint32_t gap_seqn;  /**< seq. number drain was last blocked on */
+	uint64_t gap_tsc;   /**< time drain got blocked on gap_seqn, 0 if not */
+	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
+	struct cir_buffer order_buf; /**< buffer used to reorder entries */
+} __rte_cache_aligned;
+
 /* The reorder buffer data structure itself */
 struct rte_reorder_buffer {
 	char name[RTE_REORDER_NAMESIZE];
-	uint32_t min_seqn;  /**< Lowest seq. number that can be in the buffer */
 	unsigned int memsize; /**< memory area size of reorder buffer */
-	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
-	struct cir_buffer order_buf; /**< buffer used to reorder entries */
-	int is_initialized;
+	unsigned int nb_domains; /**< number of sequence number domains */
+	struct reorder_domain domains[]; /**< followed by the entry arrays */
 } __rte_cache_aligned;
 
 static void
 rte_reorder_free_mbufs(struct rte_reorder_buffer *b);
 
-struct rte_reorder_buffer *
-rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
-		const char *name, unsigned int size)
+static inline unsigned int
+reorder_memsize(unsigned int size, unsigned int nb_domains)
+{
+	return sizeof(struct rte_reorder_buffer) + nb_domains *
+		(sizeof(struct reorder_domain) +
+		 2 * size * sizeof(struct rte_mbuf *));
+}
+
+static struct rte_reorder_buffer *
+reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
+		const char *name, unsigned int size, unsigned int nb_domains)
 {
-	const unsigned int min_bufsize = sizeof(*b) +
-					(2 * size * sizeof(struct rte_mbuf *));
+	const unsigned int min_bufsize = reorder_memsize(size, nb_domains);
+	struct rte_mbuf **entries;
+	struct reorder_domain *d;
+	unsigned int i;
 
 	if (b == NULL) {
 		RTE_LOG(ERR, REORDER, "Invalid reorder buffer parameter:"
@@ -90,23 +110,35 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	memset(b, 0, bufsize);
 	strlcpy(b->name, name, sizeof(b->name));
 	b->memsize = bufsize;
-	b->order_buf.size = b->ready_buf.size = size;
-	b->order_buf.mask = b->ready_buf.mask = size - 1;
-	b->ready_buf.entries = (void *)&b[1];
-	b->order_buf.entries = RTE_PTR_ADD(&b[1],
-			size * sizeof(b->ready_buf.entries[0]));
+	b->nb_domains = nb_domains;
+	entries = (void *)&b->domains[nb_domains];
+	for (i = 0; i < nb_domains; i++) {
+		d = &b->domains[i];
+		d->order_buf.size = d->ready_buf.size = size;
+		d->order_buf.mask = d->ready_buf.mask = size - 1;
+		d->ready_buf.entries = entries;
+		d->order_buf.entries = entries + size;
+		entries += 2 * size;
+	}
 
 	return b;
 }
 
-struct rte_reorder_buffer*
-rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+struct rte_reorder_buffer *
+rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
+		const char *name, unsigned int size)
+{
+	return reorder_init(b, bufsize, name, size, 1);
+}
+
+struct rte_reorder_buffer *
+rte_reorder_create_domains(const char *name, unsigned int socket_id,
+		unsigned int size, unsigned int nb_domains)
 {
 	struct rte_reorder_buffer *b = NULL;
 	struct rte_tailq_entry *te;
 	struct rte_reorder_list *reorder_list;
-	const unsigned int bufsize = sizeof(struct rte_reorder_buffer) +
-					(2 * size * sizeof(struct rte_mbuf *));
+	unsigned int bufsize;
 	static const struct rte_mbuf_dynfield reorder_seqn_dynfield_desc = {
 		.name = RTE_REORDER_SEQN_DYNFIELD_NAME,
 		.size = sizeof(rte_reorder_seqn_t),
@@ -128,6 +160,13 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 		rte_errno = EINVAL;
 		return NULL;
 	}
+	if (nb_domains == 0 || nb_domains > RTE_REORDER_MAX_DOMAINS) {
+		RTE_LOG(ERR, REORDER, "Invalid number of reorder domains: %u\n",
+				nb_domains);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	bufsize = reorder_memsize(size, nb_domains);
 
 	rte_reorder_seqn_dynfield_offset =
 		rte_mbuf_dynfield_register(&reorder_seqn_dynfield_desc);
@@ -164,7 +203,7 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 		rte_errno = ENOMEM;
 		rte_free(te);
 	} else {
-		rte_reorder_init(b, bufsize, name, size);
+		reorder_init(b, bufsize, name, size, nb_domains);
 		te->data = (void *)b;
 		TAILQ_INSERT_TAIL(reorder_list, te, next);
 	}
@@ -174,6 +213,12 @@ exit:
 	return b;
 }
 
+struct rte_reorder_buffer*
+rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+{
+	return rte_reorder_create_domains(name, socket_id, size, 1);
+}
+
 void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
@@ -182,20 +227,29 @@ rte_reorder_reset(struct rte_reorder_buffer *b)
 	rte_reorder_free_mbufs(b);
 	strlcpy(name, b->name, sizeof(name));
 	/* No error checking as current values should be valid */
-	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
+	reorder_init(b, b->memsize, name, b->domains[0].order_buf.size,
+			b->nb_domains);
 }
 
 static void
 rte_reorder_free_mbufs(struct rte_reorder_buffer *b)
 {
-	unsigned i;
+	struct reorder_domain *d;
+	struct cir_buffer *ready_buf;
+	unsigned int i, j;
 
 	/* Free up the mbufs of order buffer & ready buffer */
-	for (i = 0; i < b->order_buf.size; i++) {
-		if (b->order_buf.entries[i])
-			rte_pktmbuf_free(b->order_buf.entries[i]);
-		if (b->ready_buf.entries[i])
-			rte_pktmbuf_free(b->ready_buf.entries[i]);
+	for (j = 0; j < b->nb_domains; j++) {
+		d = &b->domains[j];
+		for (i = 0; i < d->order_buf.size; i++) {
+			if (d->order_buf.entries[i])
+				rte_pktmbuf_free(d->order_buf.entries[i]);
+		}
+		/* drained entries are left behind, only free pending ones */
+		ready_buf = &d->ready_buf;
+		for (i = ready_buf->tail; i != ready_buf->head;
+				i = (i + 1) & ready_buf->mask)
+			rte_pktmbuf_free(ready_buf->entries[i]);
 	}
 }
 
@@ -264,7 +318,7 @@ rte_reorder_find_existing(const char *name)
 }
 
 static unsigned
-rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
+rte_reorder_fill_overflow(struct reorder_domain *d, unsigned n)
 {
 	/*
 	 * 1. Move all ready entries that fit to the ready_buf
@@ -274,8 +328,8 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 	 * 5. Return the number of positions the order_buf head has moved
 	 */
 
-	struct cir_buffer *order_buf = &b->order_buf,
-			*ready_buf = &b->ready_buf;
+	struct cir_buffer *order_buf = &d->order_buf,
+			*ready_buf = &d->ready_buf;
 
 	unsigned int order_head_adv = 0;
 
@@ -299,6 +353,7 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 
 			order_buf->entries[order_buf->head] = NULL;
 			order_head_adv++;
+			d->order_cnt--;
 
 			order_buf->head = (order_buf->head + 1) & order_buf->mask;
 
@@ -309,26 +364,21 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 		}
 	}
 
-	b->min_seqn += order_head_adv;
+	d->min_seqn += order_head_adv;
 	/* Return the number of positions the order_buf head has moved */
 	return order_head_adv;
 }
 
-int
-rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+static inline int
+reorder_insert(struct reorder_domain *d, struct rte_mbuf *mbuf)
 {
 	uint32_t offset, position;
 	struct cir_buffer *order_buf;
 
-	if (b == NULL || mbuf == NULL) {
-		rte_errno = EINVAL;
-		return -1;
-	}
-
-	order_buf = &b->order_buf;
-	if (!b->is_initialized) {
-		b->min_seqn = *rte_reorder_seqn(mbuf);
-		b->is_initialized = 1;
+	order_buf = &d->order_buf;
+	if (!d->is_initialized) {
+		d->min_seqn = *rte_reorder_seqn(mbuf);
+		d->is_initialized = 1;
 	}
 
 	/*
@@ -339,7 +389,7 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	 *	mbuf_seqn = 0x0010
 	 *	offset    = 0x0010 - 0xFFFD = 0x13
 	 */
-	offset = *rte_reorder_seqn(mbuf) - b->min_seqn;
+	offset = *rte_reorder_seqn(mbuf) - d->min_seqn;
 
 	/*
 	 * action to take depends on offset.
@@ -359,18 +409,20 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	 *       was previously skipped, so just enqueue the packet for
 	 *       immediate return on the next drain call, or else return error.
 	 */
-	if (offset < b->order_buf.size) {
+	if (offset < d->order_buf.size) {
 		position = (order_buf->head + offset) & order_buf->mask;
+		d->order_cnt += order_buf->entries[position] == NULL;
 		order_buf->entries[position] = mbuf;
-	} else if (offset < 2 * b->order_buf.size) {
-		if (rte_reorder_fill_overflow(b, offset + 1 - order_buf->size)
+	} else if (offset < 2 * d->order_buf.size) {
+		if (rte_reorder_fill_overflow(d, offset + 1 - order_buf->size)
 				< (offset + 1 - order_buf->size)) {
 			/* Put in handling for enqueue straight to output */
 			rte_errno = ENOSPC;
 			return -1;
 		}
-		offset = *rte_reorder_seqn(mbuf) - b->min_seqn;
+		offset = *rte_reorder_seqn(mbuf) - d->min_seqn;
 		position = (order_buf->head + offset) & order_buf->mask;
+		d->order_cnt += order_buf->entries[position] == NULL;
 		order_buf->entries[position] = mbuf;
 	} else {
 		/* Put in handling for enqueue straight to output */
@@ -380,14 +432,53 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	return 0;
 }
 
+int
+rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	if (b == NULL || mbuf == NULL) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	return reorder_insert(&b->domains[0], mbuf);
+}
+
 unsigned int
-rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
-		unsigned max_mbufs)
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b, unsigned int domain,
+		struct rte_mbuf **mbufs, unsigned int nb_mbufs)
+{
+	struct reorder_domain *d;
+	unsigned int i;
+
+	if (b == NULL || mbufs == NULL || domain >= b->nb_domains) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	d = &b->domains[domain];
+	for (i = 0; i < nb_mbufs; i++) {
+		if (mbufs[i] == NULL) {
+			rte_errno = EINVAL;
+			break;
+		}
+		if (i + 1 < nb_mbufs && mbufs[i + 1] != NULL)
+			rte_prefetch0(rte_reorder_seqn(mbufs[i + 1]));
+		if (reorder_insert(d, mbufs[i]) != 0)
+			break;
+	}
+
+	return i;
+}
+
+
+static inline unsigned int
+reorder_drain(struct reorder_domain *d, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs)
 {
 	unsigned int drain_cnt = 0;
 
-	struct cir_buffer *order_buf = &b->order_buf,
-			*ready_buf = &b->ready_buf;
+	struct cir_buffer *order_buf = &d->order_buf,
+			*ready_buf = &d->ready_buf;
 
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
@@ -403,9 +494,65 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 			(order_buf->entries[order_buf->head] != NULL)) {
 		mbufs[drain_cnt++] = order_buf->entries[order_buf->head];
 		order_buf->entries[order_buf->head] = NULL;
-		b->min_seqn++;
+		d->order_cnt--;
+		d->min_seqn++;
 		order_buf->head = (order_buf->head + 1) & order_buf->mask;
 	}
 
 	return drain_cnt;
 }
+
+unsigned int
+rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned max_mbufs)
+{
+	return reorder_drain(&b->domains[0], mbufs, max_mbufs);
+}
+
+unsigned int
+rte_reorder_drain_timeout(struct rte_reorder_buffer *b, unsigned int domain,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs,
+		uint64_t timeout)
+{
+	struct reorder_domain *d;
+	struct cir_buffer *order_buf;
+	unsigned int drain_cnt;
+	uint64_t now;
+
+	if (b == NULL || mbufs == NULL || domain >= b->nb_domains) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	d = &b->domains[domain];
+	order_buf = &d->order_buf;
+	drain_cnt = reorder_drain(d, mbufs, max_mbufs);
+
+	/*
+	 * Draining stopped short with mbufs still held in the order buffer:
+	 * the head is a gap. Start timing it the first time it is seen, and
+	 * once it has been outstanding for longer than the timeout consider
+	 * the missing mbufs lost and skip to the next one received.
+	 */
+	while (timeout != 0 && drain_cnt < max_mbufs && d->order_cnt != 0) {
+		now = rte_get_timer_cycles();
+		if (d->gap_tsc == 0 || d->gap_seqn != d->min_seqn) {
+			d->gap_seqn = d->min_seqn;
+			d->gap_tsc = now;
+			break;
+		}
+		if (now - d->gap_tsc < timeout)
+			break;
+
+		while (order_buf->entries[order_buf->head] == NULL) {
+			order_buf->head = (order_buf->head + 1) &
+					order_buf->mask;
+			d->min_seqn++;
+		}
+		d->gap_tsc = 0;
+		drain_cnt += reorder_drain(d, mbufs + drain_cnt,
+				max_mbufs - drain_cnt);
+	}
+
+	return drain_cnt;
+}
@@ -24,6 +24,9 @@ extern "C" {
 
 struct rte_reorder_buffer;
 
+/** Maximum number of sequence number domains in one reorder buffer. */
+#define RTE_REORDER_MAX_DOMAINS 64
+
 typedef uint32_t rte_reorder_seqn_t;
 extern int rte_reorder_seqn_dynfield_offset;
 
@@ -66,6 +69,37 @@ rte_reorder_seqn(struct rte_mbuf *mbuf)
 struct rte_reorder_buffer *
 rte_reorder_create(const char *name, unsigned socket_id, unsigned int size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new reorder buffer instance with several sequence number domains
+ *
+ * Each domain is an independent sequence number space with its own
+ * reorder window, so one buffer can serve several flow groups or worker
+ * pools that number their packets separately. Domain 0 is the one used by
+ * rte_reorder_insert() and rte_reorder_drain().
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param size
+ *   Max number of elements that can be stored in each domain
+ * @param nb_domains
+ *   Number of sequence number domains, at most RTE_REORDER_MAX_DOMAINS
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - EINVAL - invalid parameters
+ */
+__rte_experimental
+struct rte_reorder_buffer *
+rte_reorder_create_domains(const char *name, unsigned int socket_id,
+		unsigned int size, unsigned int nb_domains);
+
 /**
  * Initializes given reorder buffer instance
  *
@@ -167,6 +201,69 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Insert a burst of mbufs in a domain of the reorder buffer
+ *
+ * Each mbuf is handled as by rte_reorder_insert(), relative to the
+ * sequence numbers of the given domain only. Insertion stops at the first
+ * mbuf that cannot be inserted, leaving it and the following ones to the
+ * caller.
+ *
+ * @param b
+ *   Reorder buffer where the mbufs have to be inserted.
+ * @param domain
+ *   Sequence number domain the mbufs belong to.
+ * @param mbufs
+ *   Array of mbufs that need to be inserted in reorder buffer.
+ * @param nb_mbufs
+ *   Number of mbufs in the array.
+ * @return
+ *   Number of mbufs inserted. If less than nb_mbufs, rte_errno is set to:
+ *    - EINVAL - invalid parameters
+ *    - ENOSPC - mbufs[return value] is early and does not fit until drained.
+ *    - ERANGE - mbufs[return value] is vastly out of range of the window.
+ */
+__rte_experimental
+unsigned int
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b, unsigned int domain,
+		struct rte_mbuf **mbufs, unsigned int nb_mbufs);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Fetch reordered buffers of a domain, skipping gaps that time out
+ *
+ * Works like rte_reorder_drain() on the given domain, but when draining is
+ * blocked on a missing sequence number while later mbufs are waiting, the
+ * time the gap was first seen is recorded. Once a later call finds the same
+ * gap outstanding for more than timeout cycles, the missing mbufs are
+ * considered lost and draining resumes from the next mbuf received. They
+ * are reported as late if they arrive afterwards.
+ *
+ * @param b
+ *   Reorder buffer instance from which packets are to be drained
+ * @param domain
+ *   Sequence number domain to drain.
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @param timeout
+ *   Time in timer cycles (see rte_get_timer_hz()) to wait for a missing
+ *   mbuf before skipping it; 0 to never skip, as rte_reorder_drain().
+ * @return
+ *   number of mbuf pointers written to mbufs. 0 <= N < max_mbufs.
+ */
+__rte_experimental
+unsigned int
+rte_reorder_drain_timeout(struct rte_reorder_buffer *b, unsigned int domain,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs,
+		uint64_t timeout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,7 +45,11 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* mask of all valid flag values to ring_create() */
 #define RING_F_MASK (RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ | \
 		     RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ |	       \
-		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ)
+		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ |	       \
+		     RING_F_MP_SEQ_ENQ | RING_F_MC_SEQ_DEQ)
+
+/* flags selecting the per-slot sequence sync mode */
+#define RING_F_SEQ (RING_F_MP_SEQ_ENQ | RING_F_MC_SEQ_DEQ)
 
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
@@ -80,6 +84,22 @@ rte_ring_get_memsize_elem(unsigned int esize, unsigned int count)
 	return sz;
 }
 
+/*
+ * return the size of memory occupied by a ring, including the slot
+ * sequence numbers of the MT_SEQ mode which follow the ring elements.
+ */
+static ssize_t
+get_memsize_flags(unsigned int esize, unsigned int count, unsigned int flags)
+{
+	ssize_t sz;
+
+	sz = rte_ring_get_memsize_elem(esize, count);
+	if (sz >= 0 && (flags & RING_F_SEQ) != 0)
+		sz = RTE_ALIGN(sz + count * sizeof(uint32_t),
+			RTE_CACHE_LINE_SIZE);
+	return sz;
+}
+
 /* return the size of memory occupied by a ring */
 ssize_t
 rte_ring_get_memsize(unsigned int count)
@@ -96,10 +116,12 @@ reset_headtail(void *p)
 	struct rte_ring_headtail *ht;
 	struct rte_ring_hts_headtail *ht_hts;
 	struct rte_ring_rts_headtail *ht_rts;
+	struct rte_ring_seq_headtail *ht_seq;
 
 	ht = p;
 	ht_hts = p;
 	ht_rts = p;
+	ht_seq = p;
 
 	switch (ht->sync_type) {
 	case RTE_RING_SYNC_MT:
@@ -114,17 +136,37 @@ reset_headtail(void *p)
 	case RTE_RING_SYNC_MT_HTS:
 		ht_hts->ht.raw = 0;
 		break;
+	case RTE_RING_SYNC_MT_SEQ:
+		ht_seq->pos = 0;
+		break;
 	default:
 		/* unknown sync mode */
 		RTE_ASSERT(0);
 	}
 }
 
+/*
+ * internal helper function to reset the slot sequence numbers,
+ * each slot is free for the producer at its own index.
+ */
+static void
+reset_seq(struct rte_ring *r)
+{
+	uint32_t *seq;
+	uint32_t i;
+
+	seq = RTE_PTR_ADD(r, r->seq_ofs);
+	for (i = 0; i != r->size; i++)
+		seq[i] = i;
+}
+
 void
 rte_ring_reset(struct rte_ring *r)
 {
 	reset_headtail(&r->prod);
 	reset_headtail(&r->cons);
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_SEQ)
+		reset_seq(r);
 }
 
 /*
@@ -137,9 +179,15 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	enum rte_ring_sync_type *cons_st)
 {
 	static const uint32_t prod_st_flags =
-		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ);
+		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ |
+		RING_F_MP_SEQ_ENQ);
 	static const uint32_t cons_st_flags =
-		(RING_F_SC_DEQ | RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ);
+		(RING_F_SC_DEQ | RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ |
+		RING_F_MC_SEQ_DEQ);
+
+	/* slot sequences are shared by producers and consumers */
+	if ((flags & RING_F_SEQ) != 0 && (flags & RING_F_SEQ) != RING_F_SEQ)
+		return -EINVAL;
 
 	switch (flags & prod_st_flags) {
 	case 0:
@@ -154,6 +202,9 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	case RING_F_MP_HTS_ENQ:
 		*prod_st = RTE_RING_SYNC_MT_HTS;
 		break;
+	case RING_F_MP_SEQ_ENQ:
+		*prod_st = RTE_RING_SYNC_MT_SEQ;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -171,6 +222,9 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	case RING_F_MC_HTS_DEQ:
 		*cons_st = RTE_RING_SYNC_MT_HTS;
 		break;
+	case RING_F_MC_SEQ_DEQ:
+		*cons_st = RTE_RING_SYNC_MT_SEQ;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -178,8 +232,8 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	return 0;
 }
 
-int
-rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+static int
+ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	unsigned int flags)
 {
 	int ret;
@@ -202,6 +256,11 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
 		offsetof(struct rte_ring_rts_headtail, tail.val.pos));
 
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, sync_type) !=
+		offsetof(struct rte_ring_seq_headtail, sync_type));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
+		offsetof(struct rte_ring_seq_headtail, pos));
+
 	/* future proof flags, only allow supported values */
 	if (flags & ~RING_F_MASK) {
 		RTE_LOG(ERR, RING,
@@ -244,6 +303,23 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	return 0;
 }
 
+int
+rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
+	unsigned int flags)
+{
+	/*
+	 * the slot sequence numbers follow the ring elements,
+	 * whose size is not known here.
+	 */
+	if (flags & RING_F_SEQ) {
+		RTE_LOG(ERR, RING,
+			"MT_SEQ sync mode requires rte_ring_create_elem()\n");
+		return -EINVAL;
+	}
+
+	return ring_init(r, name, count, flags);
+}
+
 /* create the ring for a given element size */
 struct rte_ring *
 rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
@@ -265,7 +341,7 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 	if (flags & RING_F_EXACT_SZ)
 		count = rte_align32pow2(count + 1);
 
-	ring_size = rte_ring_get_memsize_elem(esize, count);
+	ring_size = get_memsize_flags(esize, count, flags);
 	if (ring_size < 0) {
 		rte_errno = ring_size;
 		return NULL;
@@ -296,7 +372,11 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, requested_count, flags);
+		ring_init(r, name, requested_count, flags);
+		if (flags & RING_F_SEQ) {
+			r->seq_ofs = rte_ring_get_memsize_elem(esize, count);
+			reset_seq(r);
+		}
 
 		te->data = (void *) r;
 		r->memzone = mz;
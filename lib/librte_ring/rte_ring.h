@@ -107,6 +107,9 @@ ssize_t rte_ring_get_memsize(unsigned int count);
  *        is "multi-consumer HTS mode".
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
+ *   The SEQ modes are not supported, as the slot sequence numbers are
+ *   stored after the object table: such rings have to be created with
+ *   rte_ring_create() or rte_ring_create_elem().
  * @return
  *   0 on success, or a negative value on error.
  */
@@ -146,6 +149,9 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
  *      - RING_F_MP_HTS_ENQ: If this flag is set, the default behavior when
  *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
  *        is "multi-producer HTS mode".
+ *      - RING_F_MP_SEQ_ENQ: If this flag is set, the default behavior when
+ *        using ``rte_ring_enqueue()`` or ``rte_ring_enqueue_bulk()``
+ *        is "multi-producer SEQ mode". It requires RING_F_MC_SEQ_DEQ.
  *     If none of these flags is set, then default "multi-producer"
  *     behavior is selected.
  *   - One of mutually exclusive flags that define consumer behavior:
@@ -158,6 +164,9 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
  *      - RING_F_MC_HTS_DEQ: If this flag is set, the default behavior when
  *        using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *        is "multi-consumer HTS mode".
+ *      - RING_F_MC_SEQ_DEQ: If this flag is set, the default behavior when
+ *        using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
+ *        is "multi-consumer SEQ mode". It requires RING_F_MP_SEQ_ENQ.
  *     If none of these flags is set, then default "multi-consumer"
  *     behavior is selected.
  * @return
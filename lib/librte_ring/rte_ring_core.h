@@ -60,6 +60,7 @@ enum rte_ring_sync_type {
 #ifdef ALLOW_EXPERIMENTAL_API
 	RTE_RING_SYNC_MT_RTS, /**< multi-thread relaxed tail sync */
 	RTE_RING_SYNC_MT_HTS, /**< multi-thread head/tail sync */
+	RTE_RING_SYNC_MT_SEQ, /**< multi-thread per-slot sequence sync */
 #endif
 };
 
@@ -110,6 +111,12 @@ struct rte_ring_hts_headtail {
 	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
+struct rte_ring_seq_headtail {
+	uint32_t reserved;
+	volatile uint32_t pos;  /**< prod/cons position */
+	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
+};
+
 /**
  * An RTE ring structure.
  *
@@ -134,6 +141,8 @@ struct rte_ring {
 	uint32_t size;           /**< Size of ring. */
 	uint32_t mask;           /**< Mask (size-1) of ring. */
 	uint32_t capacity;       /**< Usable size of ring */
+	uint32_t seq_ofs;
+	/**< Offset of the slot sequence numbers, MT_SEQ mode only. */
 
 	char pad0 __rte_cache_aligned; /**< empty cache line */
 
@@ -143,6 +152,7 @@ struct rte_ring {
 		struct rte_ring_headtail prod;
 		struct rte_ring_hts_headtail hts_prod;
 		struct rte_ring_rts_headtail rts_prod;
+		struct rte_ring_seq_headtail seq_prod;
 	}  __rte_cache_aligned;
 
 	char pad1 __rte_cache_aligned; /**< empty cache line */
@@ -153,6 +163,7 @@ struct rte_ring {
 		struct rte_ring_headtail cons;
 		struct rte_ring_hts_headtail hts_cons;
 		struct rte_ring_rts_headtail rts_cons;
+		struct rte_ring_seq_headtail seq_cons;
 	}  __rte_cache_aligned;
 
 	char pad2 __rte_cache_aligned; /**< empty cache line */
@@ -177,6 +188,9 @@ struct rte_ring {
 #define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
 #define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 
+#define RING_F_MP_SEQ_ENQ 0x0080 /**< The default enqueue is "MP SEQ". */
+#define RING_F_MC_SEQ_DEQ 0x0100 /**< The default dequeue is "MC SEQ". */
+
 #ifdef __cplusplus
 }
 #endif
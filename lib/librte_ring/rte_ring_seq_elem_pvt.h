@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2010-2021 Intel Corporation
+ * Copyright (c) 2007-2009 Kip Macy kmacy@freebsd.org
+ * All rights reserved.
+ * Derived from FreeBSD's bufring.h
+ * Used as BSD-3 Licensed with permission from Kip Macy.
+ */
+
+#ifndef _RTE_RING_SEQ_ELEM_PVT_H_
+#define _RTE_RING_SEQ_ELEM_PVT_H_
+
+/**
+ * @file rte_ring_seq_elem_pvt.h
+ * It is not recommended to include this file directly,
+ * include <rte_ring.h> instead.
+ * Contains internal helper functions for per-slot sequence (SEQ) ring mode.
+ * For more information please refer to <rte_ring_seq.h>.
+ */
+
+/**
+ * @internal returns the slot sequence numbers of the ring.
+ */
+static __rte_always_inline uint32_t *
+__rte_ring_seq_slots(struct rte_ring *r)
+{
+	return RTE_PTR_ADD(r, r->seq_ofs);
+}
+
+/**
+ * @internal counts the slots, starting at *pos*, whose sequence number
+ * is their position plus *ofs*: 0 for the slots free for producers,
+ * 1 for the slots filled for consumers.
+ */
+static __rte_always_inline uint32_t
+__rte_ring_seq_scan(const uint32_t *seq, uint32_t mask, uint32_t pos,
+	uint32_t ofs, uint32_t num)
+{
+	uint32_t i;
+
+	/*
+	 * ACQUIRE pairs with the RELEASE of __rte_ring_seq_set(),
+	 * the slot contents are accessed only after that check.
+	 */
+	for (i = 0; i != num; i++) {
+		if (__atomic_load_n(&seq[(pos + i) & mask], __ATOMIC_ACQUIRE) !=
+				pos + i + ofs)
+			break;
+	}
+
+	return i;
+}
+
+/**
+ * @internal hands the *num* slots starting at *pos* over to the other side,
+ * setting their sequence numbers to their position plus *ofs*.
+ */
+static __rte_always_inline void
+__rte_ring_seq_set(uint32_t *seq, uint32_t mask, uint32_t pos, uint32_t ofs,
+	uint32_t num)
+{
+	uint32_t i;
+
+	/* make the slot contents visible before the sequence numbers */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	for (i = 0; i != num; i++)
+		__atomic_store_n(&seq[(pos + i) & mask], pos + i + ofs,
+			__ATOMIC_RELAXED);
+}
+
+/**
+ * @internal claims up to *num* contiguous slots whose sequence number
+ * matches *ofs*, by moving the position of *ht* forward.
+ * *limit* is the number of slots allowed by the position of the other side.
+ * Never waits for other threads: if the next slot is not ready and
+ * the position has not moved, nothing is claimed.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_seq_move_pos(struct rte_ring_seq_headtail *ht,
+	const struct rte_ring_seq_headtail *other, const uint32_t *seq,
+	uint32_t mask, uint32_t limit, uint32_t ofs, unsigned int num,
+	enum rte_ring_queue_behavior behavior, uint32_t *old_pos,
+	uint32_t *entries)
+{
+	uint32_t n, pos, npos;
+
+	pos = __atomic_load_n(&ht->pos, __ATOMIC_RELAXED);
+
+	for (;;) {
+		/*
+		 * The subtraction is done between two unsigned 32bits value
+		 * (the result is always modulo 32 bits even if we have
+		 * pos > other pos). Once *pos* is claimed, it is within
+		 * [0, limit].
+		 */
+		*entries = limit + __atomic_load_n(&other->pos,
+				__ATOMIC_RELAXED) - pos;
+
+		n = RTE_MIN(num, *entries);
+		n = __rte_ring_seq_scan(seq, mask, pos, ofs, n);
+		if (n != num && behavior == RTE_RING_QUEUE_FIXED)
+			n = 0;
+
+		if (n == 0) {
+			/* not ready, or another thread claimed the slots */
+			npos = __atomic_load_n(&ht->pos, __ATOMIC_RELAXED);
+			if (npos == pos)
+				break;
+			pos = npos;
+			continue;
+		}
+
+		/*
+		 * slots are owned through their sequence numbers,
+		 * the position is only a ticket: RELAXED is enough.
+		 */
+		if (__atomic_compare_exchange_n(&ht->pos, &pos, pos + n,
+				0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) != 0)
+			break;
+	}
+
+	*old_pos = pos;
+	return n;
+}
+
+/**
+ * @internal Enqueue several objects on the SEQ ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
+ * @param free_space
+ *   returns the amount of space after the enqueue operation has finished
+ * @return
+ *   Actual number of objects enqueued.
+ *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_do_seq_enqueue_elem(struct rte_ring *r, const void *obj_table,
+	uint32_t esize, uint32_t n, enum rte_ring_queue_behavior behavior,
+	uint32_t *free_space)
+{
+	uint32_t free, head;
+	uint32_t *seq = __rte_ring_seq_slots(r);
+
+	n = __rte_ring_seq_move_pos(&r->seq_prod, &r->seq_cons, seq, r->mask,
+			r->capacity, 0, n, behavior, &head, &free);
+
+	if (n != 0) {
+		__rte_ring_enqueue_elems(r, head, obj_table, esize, n);
+		__rte_ring_seq_set(seq, r->mask, head, 1, n);
+	}
+
+	if (free_space != NULL)
+		*free_space = free - n;
+	return n;
+}
+
+/**
+ * @internal Dequeue several objects from the SEQ ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to pull from the ring.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items as possible from ring
+ * @param available
+ *   returns the number of remaining ring entries after the dequeue has finished
+ * @return
+ *   - Actual number of objects dequeued.
+ *     If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_do_seq_dequeue_elem(struct rte_ring *r, void *obj_table,
+	uint32_t esize, uint32_t n, enum rte_ring_queue_behavior behavior,
+	uint32_t *available)
+{
+	uint32_t entries, head;
+	uint32_t *seq = __rte_ring_seq_slots(r);
+
+	n = __rte_ring_seq_move_pos(&r->seq_cons, &r->seq_prod, seq, r->mask,
+			0, 1, n, behavior, &head, &entries);
+
+	if (n != 0) {
+		__rte_ring_dequeue_elems(r, head, obj_table, esize, n);
+		__rte_ring_seq_set(seq, r->mask, head, r->size, n);
+	}
+
+	if (available != NULL)
+		*available = entries - n;
+	return n;
+}
+
+#endif /* _RTE_RING_SEQ_ELEM_PVT_H_ */
@@ -15,6 +15,7 @@
 #include <rte_mbuf.h>
 #include <rte_bitmap.h>
 #include <rte_reciprocal.h>
+#include <rte_ring.h>
 
 #include "rte_sched.h"
 #include "rte_sched_common.h"
@@ -37,8 +38,9 @@
 
 #define RTE_SCHED_TB_RATE_CONFIG_ERR          (1e-7)
 #define RTE_SCHED_WRR_SHIFT                   3
-#define RTE_SCHED_MAX_QUEUES_PER_TC           RTE_SCHED_BE_QUEUES_PER_PIPE
-#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE)
+#define RTE_SCHED_MAX_QUEUES_PER_TC           RTE_SCHED_BE_QUEUES_PER_PIPE_MAX
+#define RTE_SCHED_QUEUES_PER_PIPE_MIN         8
+#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE_MIN)
 #define RTE_SCHED_PIPE_INVALID                UINT32_MAX
 #define RTE_SCHED_BMP_POS_INVALID             UINT32_MAX
 
@@ -47,6 +49,11 @@
  */
 #define RTE_SCHED_TIME_SHIFT		      8
 
+/* Packets moved at once from a partition ring into its queues */
+#define RTE_SCHED_PARTITION_BURST             64
+/* Line rate credit a partitioned port can save up while idle, in MTUs */
+#define RTE_SCHED_PARTITION_SHAPER_MTUS       64
+
 struct rte_sched_pipe_profile {
 	/* Token bucket (TB) */
 	uint64_t tb_period;
@@ -59,7 +66,7 @@ struct rte_sched_pipe_profile {
 	uint8_t tc_ov_weight;
 
 	/* Pipe best-effort traffic class queues */
-	uint8_t  wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE];
+	uint8_t  wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
 };
 
 struct rte_sched_pipe {
@@ -75,7 +82,7 @@ struct rte_sched_pipe {
 	uint64_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 
 	/* Weighted Round Robin (WRR) */
-	uint8_t wrr_tokens[RTE_SCHED_BE_QUEUES_PER_PIPE];
+	uint8_t wrr_tokens[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
 
 	/* TC oversubscription */
 	uint64_t tc_ov_credits;
@@ -113,7 +120,7 @@ struct rte_sched_subport_profile {
 
 struct rte_sched_grinder {
 	/* Pipe cache */
-	uint16_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
+	uint32_t pcache_qmask[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_qindex[RTE_SCHED_GRINDER_PCACHE_SIZE];
 	uint32_t pcache_w;
 	uint32_t pcache_r;
@@ -128,7 +135,7 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t tccache_qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
@@ -144,9 +151,9 @@ struct rte_sched_grinder {
 	struct rte_mbuf *pkt;
 
 	/* WRR */
-	uint16_t wrr_tokens[RTE_SCHED_BE_QUEUES_PER_PIPE];
-	uint16_t wrr_mask[RTE_SCHED_BE_QUEUES_PER_PIPE];
-	uint8_t wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE];
+	uint16_t wrr_tokens[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
+	uint16_t wrr_mask[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
+	uint8_t wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
 };
 
 struct rte_sched_subport {
@@ -199,8 +206,13 @@ struct rte_sched_subport {
 	struct rte_sched_grinder grinder[RTE_SCHED_PORT_N_GRINDERS];
 	uint32_t busy_grinders;
 
+	/* Pipe topology */
+	uint32_t n_pipe_queues_log2;
+	uint32_t n_sp_tcs;
+	uint32_t n_be_queues;
+
 	/* Queue base calculation */
-	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 	uint32_t qsize_sum;
 
 	struct rte_sched_pipe *pipe;
@@ -217,9 +229,12 @@ struct rte_sched_port {
 	uint32_t n_subports_per_port;
 	uint32_t n_pipes_per_subport;
 	uint32_t n_pipes_per_subport_log2;
+	uint32_t n_pipe_queues_log2;
+	uint32_t n_sp_tcs;
+	uint32_t n_be_queues;
 	uint16_t pipe_queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint8_t pipe_tc[RTE_SCHED_QUEUES_PER_PIPE];
-	uint8_t tc_queue[RTE_SCHED_QUEUES_PER_PIPE];
+	uint8_t pipe_tc[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	uint8_t tc_queue[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 	uint32_t n_subport_profiles;
 	uint32_t n_max_subport_profiles;
 	uint64_t rate;
@@ -238,6 +253,15 @@ struct rte_sched_port {
 	struct rte_mbuf **pkts_out;
 	uint32_t n_pkts_out;
 	uint32_t subport_id;
+	uint32_t subport_first;       /* First subport served by dequeue */
+	uint32_t subport_end;         /* Last subport served by dequeue + 1 */
+
+	/* Partitioning */
+	struct rte_sched_port *parent; /* Port of this partition, or NULL */
+	struct rte_ring *ring;        /* Partition input from other lcores */
+	struct rte_sched_port **partition_of; /* Partition of each subport */
+	uint64_t shaper_tx_bytes;     /* Bytes sent by all partitions */
+	uint64_t shaper_burst;        /* Credit saved up while idle */
 
 	/* Large data structures */
 	struct rte_sched_subport_profile *subport_profiles;
@@ -257,28 +281,20 @@ enum rte_sched_subport_array {
 static inline uint32_t
 rte_sched_subport_pipe_queues(struct rte_sched_subport *subport)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * subport->n_pipes_per_subport_enabled;
+	return subport->n_pipes_per_subport_enabled <<
+		subport->n_pipe_queues_log2;
 }
 
 static inline struct rte_mbuf **
 rte_sched_subport_pipe_qbase(struct rte_sched_subport *subport, uint32_t qindex)
 {
-	uint32_t pindex = qindex >> 4;
-	uint32_t qpos = qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1);
+	uint32_t pindex = qindex >> subport->n_pipe_queues_log2;
+	uint32_t qpos = qindex & ((1 << subport->n_pipe_queues_log2) - 1);
 
 	return (subport->queue_array + pindex *
 		subport->qsize_sum + subport->qsize_add[qpos]);
 }
 
-static inline uint16_t
-rte_sched_subport_pipe_qsize(struct rte_sched_port *port,
-struct rte_sched_subport *subport, uint32_t qindex)
-{
-	uint32_t tc = port->pipe_tc[qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1)];
-
-	return subport->qsize[tc];
-}
-
 static inline uint32_t
 rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
@@ -301,7 +317,8 @@ rte_sched_port_pipe_queue(struct rte_sched_port *port, uint32_t traffic_class)
 static inline uint8_t
 rte_sched_port_pipe_tc(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint8_t pipe_tc = port->pipe_tc[qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1)];
+	uint8_t pipe_tc =
+		port->pipe_tc[qindex & ((1 << port->n_pipe_queues_log2) - 1)];
 
 	return pipe_tc;
 }
@@ -309,15 +326,73 @@ rte_sched_port_pipe_tc(struct rte_sched_port *port, uint32_t qindex)
 static inline uint8_t
 rte_sched_port_tc_queue(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint8_t tc_queue = port->tc_queue[qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1)];
+	uint8_t tc_queue =
+		port->tc_queue[qindex & ((1 << port->n_pipe_queues_log2) - 1)];
 
 	return tc_queue;
 }
 
+static inline uint16_t
+rte_sched_subport_pipe_qsize(struct rte_sched_port *port,
+struct rte_sched_subport *subport, uint32_t qindex)
+{
+	uint32_t tc = rte_sched_port_pipe_tc(port, qindex);
+
+	return subport->qsize[tc];
+}
+
+/*
+ * WRR cost of each best-effort queue, inversely proportional to its weight.
+ * The costs are exact when the least common multiple of the weights over
+ * the smallest weight fits the 8-bit costs, scaled to the 8-bit range
+ * otherwise. Fails on a zero weight, or when the scaled costs of two
+ * different weights are equal.
+ */
+static int
+rte_sched_pipe_wrr_cost(const uint8_t *wrr_weights, uint32_t n_be_queues,
+	uint8_t *wrr_cost)
+{
+	uint32_t lcd = 1, w_min = UINT8_MAX;
+	uint32_t i, j;
+
+	for (i = 0; i < n_be_queues; i++) {
+		if (wrr_weights[i] == 0)
+			return -EINVAL;
+
+		w_min = RTE_MIN(w_min, (uint32_t)wrr_weights[i]);
+	}
+
+	/* Stop as soon as too large, before lcd can overflow */
+	for (i = 0; i < n_be_queues && lcd / w_min <= UINT8_MAX; i++)
+		lcd = rte_get_lcd(lcd, wrr_weights[i]);
+
+	if (lcd / w_min <= UINT8_MAX) {
+		for (i = 0; i < n_be_queues; i++)
+			wrr_cost[i] = (uint8_t)(lcd / wrr_weights[i]);
+
+		return 0;
+	}
+
+	/* The queue with the smallest weight gets the largest cost */
+	for (i = 0; i < n_be_queues; i++)
+		wrr_cost[i] = (uint8_t)((UINT8_MAX * w_min +
+			wrr_weights[i] / 2) / wrr_weights[i]);
+
+	/* Different weights must keep different costs */
+	for (i = 0; i < n_be_queues; i++)
+		for (j = 0; j < n_be_queues; j++)
+			if (wrr_weights[i] < wrr_weights[j] &&
+			    wrr_cost[i] <= wrr_cost[j])
+				return -EINVAL;
+
+	return 0;
+}
+
 static int
 pipe_profile_check(struct rte_sched_pipe_params *params,
-	uint64_t rate, uint16_t *qsize)
+	uint64_t rate, uint16_t *qsize, uint32_t n_be_queues)
 {
+	uint8_t wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE];
 	uint32_t i;
 
 	/* Pipe parameters */
@@ -374,13 +449,16 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -EINVAL;
 	}
 
-	/* Queue WRR weights: non-zero */
-	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++) {
-		if (params->wrr_weights[i] == 0) {
-			RTE_LOG(ERR, SCHED,
-				"%s: Incorrect value for wrr weight\n", __func__);
-			return -EINVAL;
-		}
+	/* Queue WRR weights, ignored beyond the ones of the params */
+	if (n_be_queues > RTE_SCHED_BE_QUEUES_PER_PIPE)
+		return 0;
+
+	/* Queue WRR weights: non-zero, with representable costs */
+	if (rte_sched_pipe_wrr_cost(params->wrr_weights, n_be_queues,
+			wrr_cost) != 0) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for wrr weight\n", __func__);
+		return -EINVAL;
 	}
 
 	return 0;
@@ -436,9 +514,31 @@ subport_profile_check(struct rte_sched_subport_profile_params *params,
 	return 0;
 }
 
+static inline uint32_t
+rte_sched_topology_queues_per_pipe(
+	const struct rte_sched_pipe_topology *topology)
+{
+	if (topology == NULL)
+		return RTE_SCHED_QUEUES_PER_PIPE;
+
+	return topology->n_queues_per_pipe;
+}
+
+static inline uint32_t
+rte_sched_topology_be_queues_per_pipe(
+	const struct rte_sched_pipe_topology *topology)
+{
+	if (topology == NULL)
+		return RTE_SCHED_BE_QUEUES_PER_PIPE;
+
+	return topology->n_be_queues_per_pipe;
+}
+
 static int
-rte_sched_port_check_params(struct rte_sched_port_params *params)
+rte_sched_port_check_params(struct rte_sched_port_params *params,
+	const struct rte_sched_pipe_topology *topology)
 {
+	uint32_t n_queues, n_be_queues;
 	uint32_t i;
 
 	if (params == NULL) {
@@ -508,16 +608,37 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		return -EINVAL;
 	}
 
+	/* n_queues_per_pipe: power of 2, between 8 and 32 */
+	n_queues = rte_sched_topology_queues_per_pipe(topology);
+	if (n_queues < RTE_SCHED_QUEUES_PER_PIPE_MIN ||
+	    n_queues > RTE_SCHED_QUEUES_PER_PIPE_MAX ||
+	    !rte_is_power_of_2(n_queues)) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for queues per pipe\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_be_queues_per_pipe: one queue per strict priority tc left */
+	n_be_queues = rte_sched_topology_be_queues_per_pipe(topology);
+	if (n_be_queues == 0 || n_be_queues > n_queues ||
+	    n_queues - n_be_queues > RTE_SCHED_TRAFFIC_CLASS_BE) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for best-effort queues per pipe\n",
+			__func__);
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
 static uint32_t
 rte_sched_subport_get_array_base(struct rte_sched_subport_params *params,
+	uint32_t n_queues_per_pipe, uint32_t n_be_queues,
 	enum rte_sched_subport_array array)
 {
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport_enabled;
 	uint32_t n_subport_pipe_queues =
-		RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport;
+		n_queues_per_pipe * n_pipes_per_subport;
 
 	uint32_t size_pipe = n_pipes_per_subport * sizeof(struct rte_sched_pipe);
 	uint32_t size_queue =
@@ -538,7 +659,7 @@ rte_sched_subport_get_array_base(struct rte_sched_subport_params *params,
 			size_per_pipe_queue_array +=
 				params->qsize[i] * sizeof(struct rte_mbuf *);
 		else
-			size_per_pipe_queue_array += RTE_SCHED_MAX_QUEUES_PER_TC *
+			size_per_pipe_queue_array += n_be_queues *
 				params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_subport * size_per_pipe_queue_array;
@@ -577,24 +698,20 @@ rte_sched_subport_config_qsize(struct rte_sched_subport *subport)
 {
 	uint32_t i;
 
+	uint32_t n_queues = subport->n_sp_tcs + subport->n_be_queues;
+
 	subport->qsize_add[0] = 0;
 
 	/* Strict prority traffic class */
-	for (i = 1; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 1; i <= subport->n_sp_tcs; i++)
 		subport->qsize_add[i] = subport->qsize_add[i-1] + subport->qsize[i-1];
 
 	/* Best-effort traffic class */
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 1] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 2] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 1] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 3] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 2] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
+	for (i = subport->n_sp_tcs + 1; i < n_queues; i++)
+		subport->qsize_add[i] = subport->qsize_add[i-1] +
+			subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
 
-	subport->qsize_sum = subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 3] +
+	subport->qsize_sum = subport->qsize_add[n_queues - 1] +
 		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
 }
 
@@ -693,8 +810,6 @@ rte_sched_pipe_profile_convert(struct rte_sched_subport *subport,
 	struct rte_sched_pipe_profile *dst,
 	uint64_t rate)
 {
-	uint32_t wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE];
-	uint32_t lcd1, lcd2, lcd;
 	uint32_t i;
 
 	/* Token Bucket */
@@ -724,25 +839,14 @@ rte_sched_pipe_profile_convert(struct rte_sched_subport *subport,
 
 	dst->tc_ov_weight = src->tc_ov_weight;
 
-	/* WRR queues */
-	wrr_cost[0] = src->wrr_weights[0];
-	wrr_cost[1] = src->wrr_weights[1];
-	wrr_cost[2] = src->wrr_weights[2];
-	wrr_cost[3] = src->wrr_weights[3];
-
-	lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-	lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-	lcd = rte_get_lcd(lcd1, lcd2);
-
-	wrr_cost[0] = lcd / wrr_cost[0];
-	wrr_cost[1] = lcd / wrr_cost[1];
-	wrr_cost[2] = lcd / wrr_cost[2];
-	wrr_cost[3] = lcd / wrr_cost[3];
-
-	dst->wrr_cost[0] = (uint8_t) wrr_cost[0];
-	dst->wrr_cost[1] = (uint8_t) wrr_cost[1];
-	dst->wrr_cost[2] = (uint8_t) wrr_cost[2];
-	dst->wrr_cost[3] = (uint8_t) wrr_cost[3];
+	/* WRR queues, all with the same weight until set when not in src */
+	if (subport->n_be_queues > RTE_SCHED_BE_QUEUES_PER_PIPE) {
+		for (i = 0; i < subport->n_be_queues; i++)
+			dst->wrr_cost[i] = 1;
+	} else {
+		rte_sched_pipe_wrr_cost(src->wrr_weights, subport->n_be_queues,
+			dst->wrr_cost);
+	}
 }
 
 static void
@@ -821,7 +925,9 @@ rte_sched_port_config_subport_profile_table(struct rte_sched_port *port,
 static int
 rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 	uint32_t n_max_pipes_per_subport,
-	uint64_t rate)
+	uint64_t rate,
+	uint32_t n_sp_tcs,
+	uint32_t n_be_queues)
 {
 	uint32_t i;
 
@@ -850,6 +956,16 @@ rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 		return -EINVAL;
 	}
 
+	/* qsize: zero for the strict priority tcs without a queue */
+	for (i = n_sp_tcs; i < RTE_SCHED_TRAFFIC_CLASS_BE; i++) {
+		if (params->qsize[i] != 0) {
+			RTE_LOG(ERR, SCHED,
+				"%s: Incorrect qsize for tc %u without queue\n",
+				__func__, i);
+			return -EINVAL;
+		}
+	}
+
 	/* n_pipes_per_subport: non-zero, power of 2 */
 	if (params->n_pipes_per_subport_enabled == 0 ||
 		params->n_pipes_per_subport_enabled > n_max_pipes_per_subport ||
@@ -873,7 +989,8 @@ rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
 		int status;
 
-		status = pipe_profile_check(p, rate, &params->qsize[0]);
+		status = pipe_profile_check(p, rate, &params->qsize[0],
+			n_be_queues);
 		if (status != 0) {
 			RTE_LOG(ERR, SCHED,
 				"%s: Pipe profile check failed(%d)\n", __func__, status);
@@ -887,11 +1004,22 @@ rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
 	struct rte_sched_subport_params **subport_params)
+{
+	return rte_sched_port_get_memory_footprint_topology(port_params, NULL,
+		subport_params);
+}
+
+uint32_t
+rte_sched_port_get_memory_footprint_topology(
+	struct rte_sched_port_params *port_params,
+	const struct rte_sched_pipe_topology *topology,
+	struct rte_sched_subport_params **subport_params)
 {
 	uint32_t size0 = 0, size1 = 0, i;
+	uint32_t n_queues, n_be_queues;
 	int status;
 
-	status = rte_sched_port_check_params(port_params);
+	status = rte_sched_port_check_params(port_params, topology);
 	if (status != 0) {
 		RTE_LOG(ERR, SCHED,
 			"%s: Port scheduler port params check failed (%d)\n",
@@ -900,12 +1028,16 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
 		return 0;
 	}
 
+	n_queues = rte_sched_topology_queues_per_pipe(topology);
+	n_be_queues = rte_sched_topology_be_queues_per_pipe(topology);
+
 	for (i = 0; i < port_params->n_subports_per_port; i++) {
 		struct rte_sched_subport_params *sp = subport_params[i];
 
 		status = rte_sched_subport_check_params(sp,
 				port_params->n_pipes_per_subport,
-				port_params->rate);
+				port_params->rate,
+				n_queues - n_be_queues, n_be_queues);
 		if (status != 0) {
 			RTE_LOG(ERR, SCHED,
 				"%s: Port scheduler subport params check failed (%d)\n",
@@ -920,8 +1052,8 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
 	for (i = 0; i < port_params->n_subports_per_port; i++) {
 		struct rte_sched_subport_params *sp = subport_params[i];
 
-		size1 += rte_sched_subport_get_array_base(sp,
-					e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
+		size1 += rte_sched_subport_get_array_base(sp, n_queues,
+			n_be_queues, e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
 	}
 
 	return size0 + size1;
@@ -929,14 +1061,22 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
 
 struct rte_sched_port *
 rte_sched_port_config(struct rte_sched_port_params *params)
+{
+	return rte_sched_port_config_topology(params, NULL);
+}
+
+struct rte_sched_port *
+rte_sched_port_config_topology(struct rte_sched_port_params *params,
+	const struct rte_sched_pipe_topology *topology)
 {
 	struct rte_sched_port *port = NULL;
 	uint32_t size0, size1, size2;
 	uint32_t cycles_per_byte;
+	uint32_t n_queues;
 	uint32_t i, j;
 	int status;
 
-	status = rte_sched_port_check_params(params);
+	status = rte_sched_port_check_params(params, topology);
 	if (status != 0) {
 		RTE_LOG(ERR, SCHED,
 			"%s: Port scheduler params check failed (%d)\n",
@@ -976,20 +1116,22 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 			__builtin_ctz(params->n_pipes_per_subport);
 	port->socket = params->socket;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
-		port->pipe_queue[i] = i;
-
-	for (i = 0, j = 0; i < RTE_SCHED_QUEUES_PER_PIPE; i++) {
-		port->pipe_tc[i] = j;
+	/* Pipe topology */
+	n_queues = rte_sched_topology_queues_per_pipe(topology);
+	port->n_be_queues = rte_sched_topology_be_queues_per_pipe(topology);
+	port->n_sp_tcs = n_queues - port->n_be_queues;
+	port->n_pipe_queues_log2 = __builtin_ctz(n_queues);
 
-		if (j < RTE_SCHED_TRAFFIC_CLASS_BE)
-			j++;
-	}
+	/* Strict priority tcs without a queue go to the best-effort tc */
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		port->pipe_queue[i] = RTE_MIN(i, port->n_sp_tcs);
 
-	for (i = 0, j = 0; i < RTE_SCHED_QUEUES_PER_PIPE; i++) {
+	for (i = 0, j = 0; i < n_queues; i++) {
+		port->pipe_tc[i] = (i < port->n_sp_tcs) ? i :
+			RTE_SCHED_TRAFFIC_CLASS_BE;
 		port->tc_queue[i] = j;
 
-		if (i >= RTE_SCHED_TRAFFIC_CLASS_BE)
+		if (i >= port->n_sp_tcs)
 			j++;
 	}
 	port->rate = params->rate;
@@ -1013,6 +1155,8 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->pkts_out = NULL;
 	port->n_pkts_out = 0;
 	port->subport_id = 0;
+	port->subport_first = 0;
+	port->subport_end = port->n_subports_per_port;
 
 	return port;
 }
@@ -1059,10 +1203,117 @@ rte_sched_port_free(struct rte_sched_port *port)
 	for (i = 0; i < port->n_subports_per_port; i++)
 		rte_sched_subport_free(port, port->subports[i]);
 
+	rte_free(port->partition_of);
 	rte_free(port->subport_profiles);
 	rte_free(port);
 }
 
+struct rte_sched_port *
+rte_sched_port_partition_create(struct rte_sched_port *port,
+	uint32_t first_subport, uint32_t n_subports, uint32_t ring_size)
+{
+	struct rte_sched_port *part;
+	char name[RTE_RING_NAMESIZE];
+	uint32_t size, i;
+
+	/* Check user parameters */
+	if (port == NULL || port->parent != NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter port\n", __func__);
+		return NULL;
+	}
+
+	if (n_subports == 0 || first_subport >= port->n_subports_per_port ||
+	    n_subports > port->n_subports_per_port - first_subport) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for subport range\n", __func__);
+		return NULL;
+	}
+
+	for (i = first_subport; i < first_subport + n_subports; i++) {
+		if (port->subports[i] == NULL ||
+		    (port->partition_of != NULL &&
+		     port->partition_of[i] != NULL)) {
+			RTE_LOG(ERR, SCHED,
+				"%s: Subport %u not configured or already partitioned\n",
+				__func__, i);
+			return NULL;
+		}
+	}
+
+	if (port->partition_of == NULL) {
+		size = port->n_subports_per_port *
+			sizeof(struct rte_sched_port *);
+		port->partition_of = rte_zmalloc_socket("qos_partitions",
+			size, RTE_CACHE_LINE_SIZE, port->socket);
+		if (port->partition_of == NULL) {
+			RTE_LOG(ERR, SCHED,
+				"%s: Memory allocation fails\n", __func__);
+			return NULL;
+		}
+		port->shaper_burst =
+			(uint64_t)port->mtu * RTE_SCHED_PARTITION_SHAPER_MTUS;
+	}
+
+	/* The partition shares the configuration and subports of the port */
+	size = sizeof(struct rte_sched_port) +
+		port->n_subports_per_port * sizeof(struct rte_sched_subport *);
+	part = rte_zmalloc_socket("qos_partition", size, RTE_CACHE_LINE_SIZE,
+		port->socket);
+	if (part == NULL) {
+		RTE_LOG(ERR, SCHED, "%s: Memory allocation fails\n", __func__);
+		return NULL;
+	}
+	memcpy(part, port, size);
+
+	snprintf(name, sizeof(name), "SCHED_%p_%u", (void *)port,
+		first_subport);
+	part->ring = rte_ring_create(name, ring_size, port->socket,
+		RING_F_SC_DEQ);
+	if (part->ring == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Ring creation fails\n", __func__);
+		rte_free(part);
+		return NULL;
+	}
+
+	part->parent = port;
+	part->partition_of = NULL;
+	part->pkts_out = NULL;
+	part->n_pkts_out = 0;
+	part->subport_first = first_subport;
+	part->subport_end = first_subport + n_subports;
+	part->subport_id = first_subport;
+
+	for (i = first_subport; i < part->subport_end; i++)
+		port->partition_of[i] = part;
+
+	return part;
+}
+
+void
+rte_sched_port_partition_free(struct rte_sched_port *part)
+{
+	struct rte_mbuf *pkts[RTE_SCHED_PARTITION_BURST];
+	unsigned int n;
+	uint32_t i;
+
+	/* Check user parameters */
+	if (part == NULL || part->parent == NULL)
+		return;
+
+	for (i = part->subport_first; i < part->subport_end; i++)
+		part->parent->partition_of[i] = NULL;
+
+	/* Packets still in the ring are dropped */
+	while ((n = rte_ring_sc_dequeue_burst(part->ring, (void **)pkts,
+			RTE_DIM(pkts), NULL)) != 0)
+		rte_pktmbuf_free_bulk(pkts, n);
+
+	rte_ring_free(part->ring);
+	rte_free(part);
+}
+
 static void
 rte_sched_free_memory(struct rte_sched_port *port, uint32_t n_subports)
 {
@@ -1087,7 +1338,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	struct rte_sched_subport *s = NULL;
 	uint32_t n_subports = subport_id;
 	struct rte_sched_subport_profile *profile;
-	uint32_t n_subport_pipe_queues, i;
+	uint32_t n_subport_pipe_queues, n_queues, i;
 	uint32_t size0, size1, bmp_mem_size;
 	int status;
 
@@ -1098,6 +1349,8 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		return 0;
 	}
 
+	n_queues = 1 << port->n_pipe_queues_log2;
+
 	if (subport_id >= port->n_subports_per_port) {
 		RTE_LOG(ERR, SCHED,
 			"%s: Incorrect value for subport id\n", __func__);
@@ -1122,7 +1375,9 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 		status = rte_sched_subport_check_params(params,
 			port->n_pipes_per_subport,
-			port->rate);
+			port->rate,
+			port->n_sp_tcs,
+			port->n_be_queues);
 		if (status != 0) {
 			RTE_LOG(NOTICE, SCHED,
 				"%s: Port scheduler params check failed (%d)\n",
@@ -1134,8 +1389,8 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 		/* Determine the amount of memory to allocate */
 		size0 = sizeof(struct rte_sched_subport);
-		size1 = rte_sched_subport_get_array_base(params,
-					e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
+		size1 = rte_sched_subport_get_array_base(params, n_queues,
+			port->n_be_queues, e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
 
 		/* Allocate memory to store the data structures */
 		s = rte_zmalloc_socket("subport_params", size0 + size1,
@@ -1166,6 +1421,9 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		s->n_pipes_per_subport_enabled =
 				params->n_pipes_per_subport_enabled;
 		memcpy(s->qsize, params->qsize, sizeof(params->qsize));
+		s->n_pipe_queues_log2 = port->n_pipe_queues_log2;
+		s->n_sp_tcs = port->n_sp_tcs;
+		s->n_be_queues = port->n_be_queues;
 		s->n_pipe_profiles = params->n_pipe_profiles;
 		s->n_max_pipe_profiles = params->n_max_pipe_profiles;
 
@@ -1209,20 +1467,26 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		/* Large data structures */
 		s->pipe = (struct rte_sched_pipe *)
 			(s->memory + rte_sched_subport_get_array_base(params,
+			n_queues, s->n_be_queues,
 			e_RTE_SCHED_SUBPORT_ARRAY_PIPE));
 		s->queue = (struct rte_sched_queue *)
 			(s->memory + rte_sched_subport_get_array_base(params,
+			n_queues, s->n_be_queues,
 			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE));
 		s->queue_extra = (struct rte_sched_queue_extra *)
 			(s->memory + rte_sched_subport_get_array_base(params,
+			n_queues, s->n_be_queues,
 			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_EXTRA));
 		s->pipe_profiles = (struct rte_sched_pipe_profile *)
 			(s->memory + rte_sched_subport_get_array_base(params,
+			n_queues, s->n_be_queues,
 			e_RTE_SCHED_SUBPORT_ARRAY_PIPE_PROFILES));
 		s->bmp_array =  s->memory + rte_sched_subport_get_array_base(
-				params, e_RTE_SCHED_SUBPORT_ARRAY_BMP_ARRAY);
+				params, n_queues, s->n_be_queues,
+				e_RTE_SCHED_SUBPORT_ARRAY_BMP_ARRAY);
 		s->queue_array = (struct rte_mbuf **)
 			(s->memory + rte_sched_subport_get_array_base(params,
+			n_queues, s->n_be_queues,
 			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_ARRAY));
 
 		/* Pipe profile table */
@@ -1443,7 +1707,8 @@ rte_sched_subport_pipe_profile_add(struct rte_sched_port *port,
 	}
 
 	/* Pipe params */
-	status = pipe_profile_check(params, port->rate, &s->qsize[0]);
+	status = pipe_profile_check(params, port->rate, &s->qsize[0],
+		s->n_be_queues);
 	if (status != 0) {
 		RTE_LOG(ERR, SCHED,
 			"%s: Pipe profile check failed(%d)\n", __func__, status);
@@ -1473,6 +1738,55 @@ rte_sched_subport_pipe_profile_add(struct rte_sched_port *port,
 	return 0;
 }
 
+int
+rte_sched_subport_pipe_profile_wrr_set(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_profile_id,
+	const uint8_t *wrr_weights)
+{
+	uint8_t wrr_cost[RTE_SCHED_BE_QUEUES_PER_PIPE_MAX];
+	struct rte_sched_subport *s;
+	struct rte_sched_pipe_profile *pp;
+
+	/* Port */
+	if (port == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter port\n", __func__);
+		return -EINVAL;
+	}
+
+	/* Subport id not exceeds the max limit */
+	if (subport_id >= port->n_subports_per_port ||
+	    port->subports[subport_id] == NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for subport id\n", __func__);
+		return -EINVAL;
+	}
+
+	s = port->subports[subport_id];
+
+	if (pipe_profile_id >= s->n_pipe_profiles) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for pipe profile\n", __func__);
+		return -EINVAL;
+	}
+
+	if (wrr_weights == NULL ||
+	    rte_sched_pipe_wrr_cost(wrr_weights, s->n_be_queues,
+			wrr_cost) != 0) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for wrr weights\n", __func__);
+		return -EINVAL;
+	}
+
+	pp = s->pipe_profiles + pipe_profile_id;
+	memcpy(pp->wrr_cost, wrr_cost, s->n_be_queues);
+
+	rte_sched_port_log_pipe_profile(s, pipe_profile_id);
+
+	return 0;
+}
+
 int
 rte_sched_port_subport_profile_add(struct rte_sched_port *port,
 	struct rte_sched_subport_profile_params *params,
@@ -1547,11 +1861,12 @@ rte_sched_port_qindex(struct rte_sched_port *port,
 	uint32_t queue)
 {
 	return ((subport & (port->n_subports_per_port - 1)) <<
-		(port->n_pipes_per_subport_log2 + 4)) |
+		(port->n_pipes_per_subport_log2 + port->n_pipe_queues_log2)) |
 		((pipe &
-		(port->subports[subport]->n_pipes_per_subport_enabled - 1)) << 4) |
+		(port->subports[subport]->n_pipes_per_subport_enabled - 1)) <<
+		port->n_pipe_queues_log2) |
 		((rte_sched_port_pipe_queue(port, traffic_class) + queue) &
-		(RTE_SCHED_QUEUES_PER_PIPE - 1));
+		((1 << port->n_pipe_queues_log2) - 1));
 }
 
 void
@@ -1575,8 +1890,9 @@ rte_sched_port_pkt_read_tree_path(struct rte_sched_port *port,
 {
 	uint32_t queue_id = rte_mbuf_sched_queue_get(pkt);
 
-	*subport = queue_id >> (port->n_pipes_per_subport_log2 + 4);
-	*pipe = (queue_id >> 4) &
+	*subport = queue_id >>
+		(port->n_pipes_per_subport_log2 + port->n_pipe_queues_log2);
+	*pipe = (queue_id >> port->n_pipe_queues_log2) &
 		(port->subports[*subport]->n_pipes_per_subport_enabled - 1);
 	*traffic_class = rte_sched_port_pipe_tc(port, queue_id);
 	*queue = rte_sched_port_tc_queue(port, queue_id);
@@ -1668,7 +1984,8 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 			"%s: Incorrect value for parameter qlen\n", __func__);
 		return -EINVAL;
 	}
-	subport_qmask = port->n_pipes_per_subport_log2 + 4;
+	subport_qmask = port->n_pipes_per_subport_log2 +
+		port->n_pipe_queues_log2;
 	subport_id = (queue_id >> subport_qmask) & (port->n_subports_per_port - 1);
 
 	s = port->subports[subport_id];
@@ -1865,7 +2182,8 @@ rte_sched_port_subport(struct rte_sched_port *port,
 	struct rte_mbuf *pkt)
 {
 	uint32_t queue_id = rte_mbuf_sched_queue_get(pkt);
-	uint32_t subport_id = queue_id >> (port->n_pipes_per_subport_log2 + 4);
+	uint32_t subport_id = queue_id >>
+		(port->n_pipes_per_subport_log2 + port->n_pipe_queues_log2);
 
 	return port->subports[subport_id];
 }
@@ -1983,7 +2301,8 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts,
 	uint32_t result, i;
 
 	result = 0;
-	subport_qmask = (1 << (port->n_pipes_per_subport_log2 + 4)) - 1;
+	subport_qmask = (1 << (port->n_pipes_per_subport_log2 +
+		port->n_pipe_queues_log2)) - 1;
 
 	/*
 	 * Less then 6 input packets available, which is not enough to
@@ -2420,7 +2739,7 @@ grinder_schedule(struct rte_sched_port *port,
 		uint32_t qindex = grinder->qindex[grinder->qpos];
 
 		rte_bitmap_clear(subport->bmp, qindex);
-		grinder->qmask &= ~(1 << grinder->qpos);
+		grinder->qmask &= ~(1u << grinder->qpos);
 		if (be_tc_active)
 			grinder->wrr_mask[grinder->qpos] = 0;
 		rte_sched_port_set_queue_empty_timestamp(port, subport, qindex);
@@ -2489,59 +2808,52 @@ grinder_pipe_exists(struct rte_sched_subport *subport, uint32_t base_pipe)
 
 #endif /* RTE_SCHED_OPTIMIZATIONS */
 
-static inline void
+/*
+ * The pipe queues are 1 << qlog2 consecutive bits of the bitmap, so a slab
+ * holds 64 >> qlog2 pipes. qlog2 is a constant in each specialized dequeue.
+ */
+static __rte_always_inline void
 grinder_pcache_populate(struct rte_sched_subport *subport,
-	uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
+	uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab, uint32_t qlog2)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
-	uint16_t w[4];
+	uint64_t qmask = (1LLU << (1 << qlog2)) - 1;
+	uint32_t i, w;
 
 	grinder->pcache_w = 0;
 	grinder->pcache_r = 0;
 
-	w[0] = (uint16_t) bmp_slab;
-	w[1] = (uint16_t) (bmp_slab >> 16);
-	w[2] = (uint16_t) (bmp_slab >> 32);
-	w[3] = (uint16_t) (bmp_slab >> 48);
+	for (i = 0; i < (64u >> qlog2); i++) {
+		w = (uint32_t) ((bmp_slab >> (i << qlog2)) & qmask);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[0];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
-	grinder->pcache_w += (w[0] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[1];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
-	grinder->pcache_w += (w[1] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[2];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
-	grinder->pcache_w += (w[2] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[3];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
-	grinder->pcache_w += (w[3] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w;
+		grinder->pcache_qindex[grinder->pcache_w] =
+			bmp_pos + (i << qlog2);
+		grinder->pcache_w += (w != 0);
+	}
 }
 
 static inline void
 grinder_tccache_populate(struct rte_sched_subport *subport,
-	uint32_t pos, uint32_t qindex, uint16_t qmask)
+	uint32_t pos, uint32_t qindex, uint32_t qmask)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
-	uint8_t b, i;
+	uint32_t n_sp_tcs = subport->n_sp_tcs;
+	uint32_t b, i;
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASS_BE; i++) {
-		b = (uint8_t) ((qmask >> i) & 0x1);
+	for (i = 0; i < n_sp_tcs; i++) {
+		b = (qmask >> i) & 0x1;
 		grinder->tccache_qmask[grinder->tccache_w] = b;
 		grinder->tccache_qindex[grinder->tccache_w] = qindex + i;
 		grinder->tccache_w += (b != 0);
 	}
 
-	b = (uint8_t) (qmask >> (RTE_SCHED_TRAFFIC_CLASS_BE));
+	b = qmask >> n_sp_tcs;
 	grinder->tccache_qmask[grinder->tccache_w] = b;
-	grinder->tccache_qindex[grinder->tccache_w] = qindex +
-		RTE_SCHED_TRAFFIC_CLASS_BE;
+	grinder->tccache_qindex[grinder->tccache_w] = qindex + n_sp_tcs;
 	grinder->tccache_w += (b != 0);
 }
 
@@ -2551,7 +2863,7 @@ grinder_next_tc(struct rte_sched_port *port,
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w)
@@ -2574,32 +2886,23 @@ grinder_next_tc(struct rte_sched_port *port,
 		return 1;
 	}
 
-	grinder->queue[0] = subport->queue + qindex;
-	grinder->queue[1] = subport->queue + qindex + 1;
-	grinder->queue[2] = subport->queue + qindex + 2;
-	grinder->queue[3] = subport->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
-
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
+	for (i = 0; i < subport->n_be_queues; i++) {
+		grinder->queue[i] = subport->queue + qindex + i;
+		grinder->qbase[i] = qbase + i * qsize;
+		grinder->qindex[i] = qindex + i;
+	}
 
 	grinder->tccache_r++;
 	return 1;
 }
 
-static inline int
+static __rte_always_inline int
 grinder_next_pipe(struct rte_sched_port *port,
-	struct rte_sched_subport *subport, uint32_t pos)
+	struct rte_sched_subport *subport, uint32_t pos, uint32_t qlog2)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint32_t pipe_qindex;
-	uint16_t pipe_qmask;
+	uint32_t pipe_qmask;
 
 	if (grinder->pcache_r < grinder->pcache_w) {
 		pipe_qmask = grinder->pcache_qmask[grinder->pcache_r];
@@ -2625,7 +2928,7 @@ grinder_next_pipe(struct rte_sched_port *port,
 		subport->grinder_base_bmp_pos[pos] = bmp_pos;
 
 		/* Install new pipe group into grinder's pipe cache */
-		grinder_pcache_populate(subport, pos, bmp_pos, bmp_slab);
+		grinder_pcache_populate(subport, pos, bmp_pos, bmp_slab, qlog2);
 
 		pipe_qmask = grinder->pcache_qmask[0];
 		pipe_qindex = grinder->pcache_qindex[0];
@@ -2633,7 +2936,7 @@ grinder_next_pipe(struct rte_sched_port *port,
 	}
 
 	/* Install new pipe in the grinder */
-	grinder->pindex = pipe_qindex >> 4;
+	grinder->pindex = pipe_qindex >> qlog2;
 	grinder->subport = subport;
 	grinder->pipe = subport->pipe + grinder->pindex;
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
@@ -2659,25 +2962,14 @@ grinder_wrr_load(struct rte_sched_subport *subport, uint32_t pos)
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t qmask = grinder->qmask;
+	uint32_t i;
 
-	grinder->wrr_tokens[0] =
-		((uint16_t) pipe->wrr_tokens[0]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[1] =
-		((uint16_t) pipe->wrr_tokens[1]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[2] =
-		((uint16_t) pipe->wrr_tokens[2]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[3] =
-		((uint16_t) pipe->wrr_tokens[3]) << RTE_SCHED_WRR_SHIFT;
-
-	grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
-	grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
-
-	grinder->wrr_cost[0] = pipe_params->wrr_cost[0];
-	grinder->wrr_cost[1] = pipe_params->wrr_cost[1];
-	grinder->wrr_cost[2] = pipe_params->wrr_cost[2];
-	grinder->wrr_cost[3] = pipe_params->wrr_cost[3];
+	for (i = 0; i < subport->n_be_queues; i++) {
+		grinder->wrr_tokens[i] =
+			((uint16_t) pipe->wrr_tokens[i]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+		grinder->wrr_cost[i] = pipe_params->wrr_cost[i];
+	}
 }
 
 static inline void
@@ -2685,18 +2977,11 @@ grinder_wrr_store(struct rte_sched_subport *subport, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
+	uint32_t i;
 
-	pipe->wrr_tokens[0] =
-			(grinder->wrr_tokens[0] & grinder->wrr_mask[0]) >>
-				RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[1] =
-			(grinder->wrr_tokens[1] & grinder->wrr_mask[1]) >>
-				RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[2] =
-			(grinder->wrr_tokens[2] & grinder->wrr_mask[2]) >>
-				RTE_SCHED_WRR_SHIFT;
-	pipe->wrr_tokens[3] =
-			(grinder->wrr_tokens[3] & grinder->wrr_mask[3]) >>
+	for (i = 0; i < subport->n_be_queues; i++)
+		pipe->wrr_tokens[i] =
+			(grinder->wrr_tokens[i] & grinder->wrr_mask[i]) >>
 				RTE_SCHED_WRR_SHIFT;
 }
 
@@ -2704,20 +2989,26 @@ static inline void
 grinder_wrr(struct rte_sched_subport *subport, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
+	uint32_t n_be_queues = subport->n_be_queues;
 	uint16_t wrr_tokens_min;
+	uint32_t i;
 
-	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
-	grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
-	grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
-	grinder->wrr_tokens[3] |= ~grinder->wrr_mask[3];
+	for (i = 0; i < n_be_queues; i++)
+		grinder->wrr_tokens[i] |= ~grinder->wrr_mask[i];
 
-	grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	if (n_be_queues == RTE_SCHED_BE_QUEUES_PER_PIPE) {
+		grinder->qpos = rte_min_pos_4_u16(grinder->wrr_tokens);
+	} else {
+		grinder->qpos = 0;
+		for (i = 1; i < n_be_queues; i++)
+			if (grinder->wrr_tokens[i] <
+			    grinder->wrr_tokens[grinder->qpos])
+				grinder->qpos = i;
+	}
 	wrr_tokens_min = grinder->wrr_tokens[grinder->qpos];
 
-	grinder->wrr_tokens[0] -= wrr_tokens_min;
-	grinder->wrr_tokens[1] -= wrr_tokens_min;
-	grinder->wrr_tokens[2] -= wrr_tokens_min;
-	grinder->wrr_tokens[3] -= wrr_tokens_min;
+	for (i = 0; i < n_be_queues; i++)
+		grinder->wrr_tokens[i] -= wrr_tokens_min;
 }
 
 
@@ -2736,7 +3027,9 @@ static inline void
 grinder_prefetch_tc_queue_arrays(struct rte_sched_subport *subport, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
+	uint32_t n_be_queues = subport->n_be_queues;
 	uint16_t qsize, qr[RTE_SCHED_MAX_QUEUES_PER_TC];
+	uint32_t i;
 
 	qsize = grinder->qsize;
 	grinder->qpos = 0;
@@ -2748,19 +3041,17 @@ grinder_prefetch_tc_queue_arrays(struct rte_sched_subport *subport, uint32_t pos
 		return;
 	}
 
-	qr[0] = grinder->queue[0]->qr & (qsize - 1);
-	qr[1] = grinder->queue[1]->qr & (qsize - 1);
-	qr[2] = grinder->queue[2]->qr & (qsize - 1);
-	qr[3] = grinder->queue[3]->qr & (qsize - 1);
+	for (i = 0; i < n_be_queues; i++)
+		qr[i] = grinder->queue[i]->qr & (qsize - 1);
 
-	rte_prefetch0(grinder->qbase[0] + qr[0]);
-	rte_prefetch0(grinder->qbase[1] + qr[1]);
+	for (i = 0; i < RTE_MIN(n_be_queues, 2u); i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 
 	grinder_wrr_load(subport, pos);
 	grinder_wrr(subport, pos);
 
-	rte_prefetch0(grinder->qbase[2] + qr[2]);
-	rte_prefetch0(grinder->qbase[3] + qr[3]);
+	for (i = 2; i < n_be_queues; i++)
+		rte_prefetch0(grinder->qbase[i] + qr[i]);
 }
 
 static inline void
@@ -2782,16 +3073,16 @@ grinder_prefetch_mbuf(struct rte_sched_subport *subport, uint32_t pos)
 	}
 }
 
-static inline uint32_t
+static __rte_always_inline uint32_t
 grinder_handle(struct rte_sched_port *port,
-	struct rte_sched_subport *subport, uint32_t pos)
+	struct rte_sched_subport *subport, uint32_t pos, uint32_t qlog2)
 {
 	struct rte_sched_grinder *grinder = subport->grinder + pos;
 
 	switch (grinder->state) {
 	case e_GRINDER_PREFETCH_PIPE:
 	{
-		if (grinder_next_pipe(port, subport, pos)) {
+		if (grinder_next_pipe(port, subport, pos, qlog2)) {
 			grinder_prefetch_pipe(subport, pos);
 			subport->busy_grinders++;
 
@@ -2861,7 +3152,7 @@ grinder_handle(struct rte_sched_port *port,
 		grinder_evict(subport, pos);
 
 		/* Look for another active pipe */
-		if (grinder_next_pipe(port, subport, pos)) {
+		if (grinder_next_pipe(port, subport, pos, qlog2)) {
 			grinder_prefetch_pipe(subport, pos);
 
 			grinder->state = e_GRINDER_PREFETCH_TC_QUEUE_ARRAYS;
@@ -2905,10 +3196,58 @@ rte_sched_port_time_resync(struct rte_sched_port *port)
 		port->time = port->time_cpu_bytes;
 
 	/* Reset pipe loop detection */
-	for (i = 0; i < port->n_subports_per_port; i++)
+	for (i = port->subport_first; i < port->subport_end; i++)
 		port->subports[i]->pipe_loop = RTE_SCHED_PIPE_INVALID;
 }
 
+static inline void
+rte_sched_port_partition_drain(struct rte_sched_port *part)
+{
+	struct rte_mbuf *pkts[RTE_SCHED_PARTITION_BURST];
+	uint32_t n, n_left = rte_ring_get_capacity(part->ring);
+
+	/* Bounded, so producers cannot keep the dequeue lcore busy here */
+	while (n_left != 0) {
+		n = rte_ring_sc_dequeue_burst(part->ring, (void **)pkts,
+			RTE_MIN(n_left, (uint32_t)RTE_DIM(pkts)), NULL);
+		if (n == 0)
+			break;
+
+		rte_sched_port_enqueue(part, pkts, n);
+		n_left -= n;
+	}
+}
+
+/*
+ * Claim line rate credit of the port for the next partition dequeue, up to
+ * the bytes of n_pkts packets. Returns the number of bytes the partition
+ * may send, 0 when the port has no credit left.
+ */
+static inline uint64_t
+rte_sched_port_partition_admit(struct rte_sched_port *part, uint32_t n_pkts)
+{
+	struct rte_sched_port *port = part->parent;
+	uint64_t now = part->time_cpu_bytes;
+	uint64_t n_bytes_max =
+		(uint64_t)n_pkts * (port->mtu + port->frame_overhead);
+	uint64_t tx, start, credit;
+
+	/* Credit not used while the port was idle is only kept up to a burst */
+	start = now - RTE_MIN(now, port->shaper_burst);
+
+	tx = __atomic_load_n(&port->shaper_tx_bytes, __ATOMIC_RELAXED);
+	do {
+		if (tx >= now)
+			return 0;
+
+		credit = RTE_MIN(now - RTE_MAX(tx, start), n_bytes_max);
+	} while (!__atomic_compare_exchange_n(&port->shaper_tx_bytes, &tx,
+			RTE_MAX(tx, start) + credit, 0, __ATOMIC_RELAXED,
+			__ATOMIC_RELAXED));
+
+	return credit;
+}
+
 static inline int
 rte_sched_port_exceptions(struct rte_sched_subport *subport, int second_pass)
 {
@@ -2924,30 +3263,26 @@ rte_sched_port_exceptions(struct rte_sched_subport *subport, int second_pass)
 	return exceptions;
 }
 
-int
-rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+static __rte_always_inline uint32_t
+rte_sched_port_grind(struct rte_sched_port *port, uint32_t n_pkts,
+	uint64_t time_end, uint32_t qlog2)
 {
 	struct rte_sched_subport *subport;
 	uint32_t subport_id = port->subport_id;
 	uint32_t i, n_subports = 0, count;
 
-	port->pkts_out = pkts;
-	port->n_pkts_out = 0;
-
-	rte_sched_port_time_resync(port);
-
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i++)  {
 		subport = port->subports[subport_id];
 
 		count += grinder_handle(port, subport,
-				i & (RTE_SCHED_PORT_N_GRINDERS - 1));
+				i & (RTE_SCHED_PORT_N_GRINDERS - 1), qlog2);
 
-		if (count == n_pkts) {
+		if (count == n_pkts || port->time >= time_end) {
 			subport_id++;
 
-			if (subport_id == port->n_subports_per_port)
-				subport_id = 0;
+			if (subport_id == port->subport_end)
+				subport_id = port->subport_first;
 
 			port->subport_id = subport_id;
 			break;
@@ -2959,10 +3294,10 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 			n_subports++;
 		}
 
-		if (subport_id == port->n_subports_per_port)
-			subport_id = 0;
+		if (subport_id == port->subport_end)
+			subport_id = port->subport_first;
 
-		if (n_subports == port->n_subports_per_port) {
+		if (n_subports == port->subport_end - port->subport_first) {
 			port->subport_id = subport_id;
 			break;
 		}
@@ -2970,3 +3305,99 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 
 	return count;
 }
+
+int
+rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	uint32_t count;
+	uint64_t time, time_end, credit = 0;
+
+	port->pkts_out = pkts;
+	port->n_pkts_out = 0;
+
+	if (port->parent != NULL)
+		rte_sched_port_partition_drain(port);
+
+	rte_sched_port_time_resync(port);
+
+	time = port->time;
+	time_end = UINT64_MAX;
+
+	/* Partitions stop once the line rate credit they claimed is used */
+	if (port->parent != NULL) {
+		credit = rte_sched_port_partition_admit(port, n_pkts);
+		if (credit == 0)
+			return 0;
+
+		time_end = time + credit;
+	}
+
+	/* Grinders specialized for each number of queues per pipe */
+	switch (port->n_pipe_queues_log2) {
+	case 3:
+		count = rte_sched_port_grind(port, n_pkts, time_end, 3);
+		break;
+	case 5:
+		count = rte_sched_port_grind(port, n_pkts, time_end, 5);
+		break;
+	default:
+		count = rte_sched_port_grind(port, n_pkts, time_end, 4);
+		break;
+	}
+
+	/*
+	 * Charge the bytes sent to the line rate shared by all partitions:
+	 * give back the credit not used, or charge the last packet sent
+	 * beyond it.
+	 */
+	if (port->parent != NULL && port->time - time != credit)
+		__atomic_fetch_add(&port->parent->shaper_tx_bytes,
+			port->time - time - credit, __ATOMIC_RELAXED);
+
+	return count;
+}
+
+int
+rte_sched_port_enqueue_mt(struct rte_sched_port *port, struct rte_mbuf **pkts,
+	uint32_t n_pkts)
+{
+	struct rte_sched_port *part, *next;
+	uint32_t subport_shift, subport_mask;
+	uint32_t i, j, n, result = 0;
+
+	if (port->partition_of == NULL) {
+		rte_pktmbuf_free_bulk(pkts, n_pkts);
+		return 0;
+	}
+
+	subport_shift = port->n_pipes_per_subport_log2 +
+		port->n_pipe_queues_log2;
+	subport_mask = port->n_subports_per_port - 1;
+
+	/* Each run of packets for the same partition is one ring operation */
+	for (i = 0; i < n_pkts; i = j) {
+		part = port->partition_of[(rte_mbuf_sched_queue_get(pkts[i]) >>
+			subport_shift) & subport_mask];
+
+		for (j = i + 1; j < n_pkts; j++) {
+			next = port->partition_of[
+				(rte_mbuf_sched_queue_get(pkts[j]) >>
+				subport_shift) & subport_mask];
+			if (next != part)
+				break;
+		}
+
+		n = 0;
+		if (part != NULL)
+			n = rte_ring_mp_enqueue_burst(part->ring,
+				(void **)&pkts[i], j - i, NULL);
+
+		/* Packets not taken by any partition are dropped */
+		if (n != j - i)
+			rte_pktmbuf_free_bulk(&pkts[i + n], j - i - n);
+
+		result += n;
+	}
+
+	return result;
+}
@@ -66,22 +66,33 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Maximum number of queues per pipe.
- * Note that the multiple queues (power of 2) can only be assigned to
+/** Default number of queues per pipe.
+ * Note that the multiple queues can only be assigned to
  * lowest priority (best-effort) traffic class. Other higher priority traffic
  * classes can only have one queue.
- * Can not change.
  *
- * @see struct rte_sched_port_params
+ * @see struct rte_sched_pipe_topology
  */
 #define RTE_SCHED_QUEUES_PER_PIPE    16
 
-/** Number of WRR queues for best-effort traffic class per pipe.
+/** Maximum number of queues per pipe.
+ *
+ * @see struct rte_sched_pipe_topology
+ */
+#define RTE_SCHED_QUEUES_PER_PIPE_MAX    32
+
+/** Default number of WRR queues for best-effort traffic class per pipe.
  *
  * @see struct rte_sched_pipe_params
  */
 #define RTE_SCHED_BE_QUEUES_PER_PIPE    4
 
+/** Maximum number of WRR queues for best-effort traffic class per pipe.
+ *
+ * @see struct rte_sched_pipe_topology
+ */
+#define RTE_SCHED_BE_QUEUES_PER_PIPE_MAX    RTE_SCHED_QUEUES_PER_PIPE_MAX
+
 /** Number of traffic classes per pipe (as well as subport).
  * @see struct rte_sched_subport_params
  * @see struct rte_sched_pipe_params
@@ -159,7 +170,8 @@ struct rte_sched_subport_params {
 
 	/** Packet queue size for each traffic class.
 	 * All the pipes within the same subport share the similar
-	 * configuration for the queues.
+	 * configuration for the queues. Must be zero for the strict priority
+	 * traffic classes without a queue in the port topology.
 	 */
 	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 
@@ -275,6 +287,23 @@ struct rte_sched_port_params {
 	uint32_t n_pipes_per_subport;
 };
 
+/*
+ * Pipe topology of a port, shared by all its pipes.
+ *
+ * @see rte_sched_port_config_topology()
+ */
+struct rte_sched_pipe_topology {
+	/** Number of queues per pipe: 8, 16 or 32 */
+	uint32_t n_queues_per_pipe;
+
+	/** Number of best-effort traffic class queues per pipe, from 1 up to
+	 * n_queues_per_pipe. The other queues of the pipe are assigned
+	 * to the strict priority traffic classes, one queue each, starting
+	 * with traffic class 0, so at most RTE_SCHED_TRAFFIC_CLASS_BE of them.
+	 */
+	uint32_t n_be_queues_per_pipe;
+};
+
 /*
  * Configuration
  *
@@ -291,6 +320,32 @@ struct rte_sched_port_params {
 struct rte_sched_port *
 rte_sched_port_config(struct rte_sched_port_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port configuration with a pipe topology other
+ * than RTE_SCHED_QUEUES_PER_PIPE queues, RTE_SCHED_BE_QUEUES_PER_PIPE of
+ * them best-effort.
+ *
+ * The strict priority traffic classes left without a queue must have a
+ * zero qsize in the subport parameters. With more best-effort queues than
+ * RTE_SCHED_BE_QUEUES_PER_PIPE, the wrr_weights of the pipe profiles are
+ * ignored: all the queues start with the same weight, to be changed with
+ * rte_sched_subport_pipe_profile_wrr_set().
+ *
+ * @param params
+ *   Port scheduler configuration parameter structure
+ * @param topology
+ *   Pipe topology of the port, NULL for the default one
+ * @return
+ *   Handle to port scheduler instance upon success or NULL otherwise.
+ */
+__rte_experimental
+struct rte_sched_port *
+rte_sched_port_config_topology(struct rte_sched_port_params *params,
+	const struct rte_sched_pipe_topology *topology);
+
 /**
  * Hierarchical scheduler port free
  *
@@ -324,6 +379,35 @@ rte_sched_subport_pipe_profile_add(struct rte_sched_port *port,
 	struct rte_sched_pipe_params *params,
 	uint32_t *pipe_profile_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler pipe profile WRR weights set
+ *
+ * Sets the weights of all the best-effort queues of the pipe topology of
+ * the port. Weights with a least common multiple too large for the
+ * scheduler are approximated, and rejected when two different weights
+ * would be given the same share.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param pipe_profile_id
+ *   ID of subport-level pre-configured pipe profile
+ * @param wrr_weights
+ *   Non-zero WRR weights, one per best-effort queue of the pipe
+ * @return
+ *   0 upon success, error code otherwise
+ */
+__rte_experimental
+int
+rte_sched_subport_pipe_profile_wrr_set(struct rte_sched_port *port,
+	uint32_t subport_id,
+	uint32_t pipe_profile_id,
+	const uint8_t *wrr_weights);
+
 /**
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice.
@@ -404,6 +488,30 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
 	struct rte_sched_subport_params **subport_params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler memory footprint size per port with a pipe
+ * topology
+ *
+ * @param port_params
+ *   Port scheduler configuration parameter structure
+ * @param topology
+ *   Pipe topology of the port, NULL for the default one
+ * @param subport_params
+ *   Array of subport parameter structures
+ * @return
+ *   Memory footprint size in bytes upon success, 0 otherwise
+ */
+__rte_experimental
+uint32_t
+rte_sched_port_get_memory_footprint_topology(
+	struct rte_sched_port_params *port_params,
+	const struct rte_sched_pipe_topology *topology,
+	struct rte_sched_subport_params **subport_params);
+
 /*
  * Statistics
  *
@@ -467,10 +575,12 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. RTE_SCHED_TRAFFIC_CLASS_BE)
+ *   Traffic class ID within pipe (0 .. RTE_SCHED_TRAFFIC_CLASS_BE).
+ *   The strict priority traffic classes without a queue in the port
+ *   topology are mapped to the best-effort traffic class.
  * @param queue
  *   Queue ID within pipe traffic class, 0 for high priority TCs, and
- *   0 .. (RTE_SCHED_BE_QUEUES_PER_PIPE - 1) for best-effort TC
+ *   0 .. (n_be_queues_per_pipe - 1) for best-effort TC
  * @param color
  *   Packet color set
  */
@@ -498,7 +608,7 @@ rte_sched_port_pkt_write(struct rte_sched_port *port,
  *   Traffic class ID within pipe (0 .. RTE_SCHED_TRAFFIC_CLASS_BE)
  * @param queue
  *   Queue ID within pipe traffic class, 0 for high priority TCs, and
- *   0 .. (RTE_SCHED_BE_QUEUES_PER_PIPE - 1) for best-effort TC
+ *   0 .. (n_be_queues_per_pipe - 1) for best-effort TC
  */
 void
 rte_sched_port_pkt_read_tree_path(struct rte_sched_port *port,
@@ -550,6 +660,77 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port partition create
+ *
+ * A partition is a range of subports of the port that is dequeued by its
+ * own lcore. The partition handle is used with rte_sched_port_dequeue()
+ * on that lcore only, while packets are fed to it from any lcore through
+ * rte_sched_port_enqueue_mt() on the port. All the partitions of a port
+ * share the port line rate. The subports of the range must be configured
+ * before the partition is created, and the partitions must be freed
+ * before the port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param first_subport
+ *   First subport of the partition
+ * @param n_subports
+ *   Number of subports of the partition
+ * @param ring_size
+ *   Size of the ring holding the packets enqueued to the partition,
+ *   must be a power of 2
+ * @return
+ *   Handle to the partition on success, NULL otherwise
+ */
+__rte_experimental
+struct rte_sched_port *
+rte_sched_port_partition_create(struct rte_sched_port *port,
+	uint32_t first_subport, uint32_t n_subports, uint32_t ring_size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port partition free. The packets still waiting
+ * in the partition ring are freed, the ones already in the subport queues
+ * are kept.
+ *
+ * @param part
+ *   Handle to the partition
+ */
+__rte_experimental
+void
+rte_sched_port_partition_free(struct rte_sched_port *part);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port multi-thread enqueue. Hands each packet to
+ * the partition of its subport, as written by rte_sched_port_pkt_write(),
+ * and can be called from several lcores at the same time. The packets are
+ * added to the subport queues by the next rte_sched_port_dequeue() on the
+ * partition. Packets of subports without a partition or not fitting in
+ * the partition ring are freed.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param pkts
+ *   Array storing the packet descriptor pointers
+ * @param n_pkts
+ *   Number of packets to enqueue from the pkts array into the port scheduler
+ * @return
+ *   Number of packets handed to a partition
+ */
+__rte_experimental
+int
+rte_sched_port_enqueue_mt(struct rte_sched_port *port, struct rte_mbuf **pkts,
+	uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,483 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_prefetch.h>
+#include <rte_malloc.h>
+#include <rte_rib.h>
+#include <rte_rib6.h>
+#include <rte_fib.h>
+#include <rte_fib6.h>
+
+#include "rte_swx_table_lpm.h"
+
+#define CHECK(condition, err_code)                                             \
+do {                                                                           \
+	if (!(condition))                                                      \
+		return -(err_code);                                            \
+} while (0)
+
+#define KEY_SIZE_IPV4 4
+#define KEY_SIZE_IPV6 RTE_FIB6_IPV6_ADDR_SIZE
+
+#define NAME_SIZE 32
+
+#ifndef RTE_SWX_TABLE_LPM_N_TBL8_DEFAULT
+#define RTE_SWX_TABLE_LPM_N_TBL8_DEFAULT (1 << 16)
+#endif
+
+/* Size of the FIB tbl8 group, i.e. 256 next hops of 4 bytes each. */
+#define TBL8_SIZE (256 * sizeof(uint32_t))
+
+struct table {
+	/* Input parameters */
+	struct rte_swx_table_params params;
+
+	/* Internal. */
+	struct rte_fib *fib;
+	struct rte_fib6 *fib6;
+	uint32_t n_tbl8;
+	uint32_t entry_data_size;
+	uint32_t entry_stack_tos;
+	uint64_t total_size;
+
+	/* Memory arrays. */
+	uint32_t *entry_stack;
+	uint8_t *data;
+};
+
+static inline uint8_t *
+table_entry_data(struct table *t, uint32_t entry_id)
+{
+	return &t->data[(uint64_t)entry_id * t->entry_data_size];
+}
+
+static inline uint32_t
+key_ipv4(uint8_t *key)
+{
+	uint32_t ip;
+
+	memcpy(&ip, key, sizeof(ip));
+	return rte_be_to_cpu_32(ip);
+}
+
+/* The key mask has to be a prefix mask, with NULL standing for the full key. */
+static int
+key_depth_get(struct table *t, uint8_t *key_mask, uint8_t *depth)
+{
+	uint32_t n_bits = t->params.key_size * 8, d = 0, i;
+
+	if (!key_mask) {
+		*depth = n_bits;
+		return 0;
+	}
+
+	for (i = 0; i < n_bits; i++) {
+		uint32_t bit = (key_mask[i / 8] >> (7 - i % 8)) & 1;
+
+		if (!bit)
+			continue;
+
+		CHECK(d == i, EINVAL);
+		d++;
+	}
+
+	*depth = d;
+	return 0;
+}
+
+static int
+args_parse(uint32_t *n_tbl8, const char *args)
+{
+	char *s;
+
+	*n_tbl8 = RTE_SWX_TABLE_LPM_N_TBL8_DEFAULT;
+
+	if (!args || !args[0])
+		return 0;
+
+	if (strncmp(args, "num_tbl8 ", strlen("num_tbl8 ")))
+		return -EINVAL;
+
+	args += strlen("num_tbl8 ");
+	*n_tbl8 = strtoul(args, &s, 0);
+	if ((s == args) || s[0] || !*n_tbl8)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+route_find(struct table *t, uint8_t *key, uint8_t depth, uint32_t *entry_id)
+{
+	uint64_t nh;
+
+	if (t->fib) {
+		struct rte_rib_node *node;
+
+		node = rte_rib_lookup_exact(rte_fib_get_rib(t->fib),
+					    key_ipv4(key),
+					    depth);
+		if (!node || rte_rib_get_nh(node, &nh))
+			return -ENOENT;
+	} else {
+		struct rte_rib6_node *node;
+
+		node = rte_rib6_lookup_exact(rte_fib6_get_rib(t->fib6),
+					     key,
+					     depth);
+		if (!node || rte_rib6_get_nh(node, &nh))
+			return -ENOENT;
+	}
+
+	*entry_id = (uint32_t)nh;
+	return 0;
+}
+
+static void
+entry_data_set(struct table *t,
+	       uint32_t entry_id,
+	       struct rte_swx_table_entry *entry)
+{
+	uint64_t *entry_data = (uint64_t *)table_entry_data(t, entry_id);
+
+	entry_data[0] = entry->action_id;
+	if (t->params.action_data_size)
+		memcpy(&entry_data[1],
+		       entry->action_data,
+		       t->params.action_data_size);
+}
+
+#define CL RTE_CACHE_LINE_ROUNDUP
+
+static int
+__table_create(struct table **table,
+	       uint64_t *memory_footprint,
+	       struct rte_swx_table_params *params,
+	       const char *args,
+	       int numa_node)
+{
+	char name[NAME_SIZE];
+	struct table *t;
+	uint8_t *memory;
+	size_t table_meta_sz, entry_stack_sz, data_sz, fib_sz, total_size;
+	size_t entry_stack_offset, data_offset;
+	uint32_t entry_data_size, n_tbl8, i;
+	int status;
+
+	/* Check input arguments. */
+	CHECK(params, EINVAL);
+	CHECK(params->match_type == RTE_SWX_TABLE_MATCH_LPM, EINVAL);
+	CHECK((params->key_size == KEY_SIZE_IPV4) ||
+	      (params->key_size == KEY_SIZE_IPV6), EINVAL);
+	CHECK(params->n_keys_max, EINVAL);
+	CHECK(params->n_keys_max < INT32_MAX, EINVAL);
+
+	status = args_parse(&n_tbl8, args);
+	CHECK(!status, EINVAL);
+
+	/* Memory allocation. */
+	entry_data_size = rte_align32pow2(params->action_data_size + 8);
+
+	table_meta_sz = CL(sizeof(struct table));
+	entry_stack_sz = CL(params->n_keys_max * sizeof(uint32_t));
+	data_sz = CL((uint64_t)params->n_keys_max * entry_data_size);
+	total_size = table_meta_sz + entry_stack_sz + data_sz;
+
+	entry_stack_offset = table_meta_sz;
+	data_offset = entry_stack_offset + entry_stack_sz;
+
+	if (!table) {
+		/* The FIB memory is estimated as the DIR-24-8 tbl24 (IPv4) or
+		 * the trie tbl24 (IPv6) plus the tbl8 groups.
+		 */
+		fib_sz = (1 << 24) * sizeof(uint32_t) +
+			 (size_t)n_tbl8 * TBL8_SIZE;
+
+		if (memory_footprint)
+			*memory_footprint = total_size + fib_sz;
+		return 0;
+	}
+
+	memory = rte_zmalloc_socket(NULL,
+				    total_size,
+				    RTE_CACHE_LINE_SIZE,
+				    numa_node);
+	CHECK(memory, ENOMEM);
+
+	/* Initialization. */
+	t = (struct table *)memory;
+	memcpy(&t->params, params, sizeof(*params));
+	t->params.key_mask0 = NULL;
+
+	t->n_tbl8 = n_tbl8;
+	t->entry_data_size = entry_data_size;
+	t->total_size = total_size;
+
+	t->entry_stack = (uint32_t *)&memory[entry_stack_offset];
+	t->data = &memory[data_offset];
+
+	for (i = 0; i < params->n_keys_max; i++)
+		t->entry_stack[i] = params->n_keys_max - 1 - i;
+	t->entry_stack_tos = params->n_keys_max;
+
+	/* FIB. The table address makes the FIB name unique. The default next
+	 * hop is an invalid entry ID, which flags the lookup miss.
+	 */
+	snprintf(name, sizeof(name), "swx_lpm_%p", (void *)t);
+
+	if (params->key_size == KEY_SIZE_IPV4) {
+		struct rte_fib_conf conf = {
+			.type = RTE_FIB_DIR24_8,
+			.default_nh = params->n_keys_max,
+			.max_routes = params->n_keys_max,
+			.dir24_8 = {
+				.nh_sz = RTE_FIB_DIR24_8_4B,
+				.num_tbl8 = n_tbl8,
+			},
+		};
+
+		t->fib = rte_fib_create(name, numa_node, &conf);
+	} else {
+		struct rte_fib6_conf conf = {
+			.type = RTE_FIB6_TRIE,
+			.default_nh = params->n_keys_max,
+			.max_routes = params->n_keys_max,
+			.trie = {
+				.nh_sz = RTE_FIB6_TRIE_4B,
+				.num_tbl8 = n_tbl8,
+			},
+		};
+
+		t->fib6 = rte_fib6_create(name, numa_node, &conf);
+	}
+
+	if (!t->fib && !t->fib6) {
+		rte_free(t);
+		return -ENOMEM;
+	}
+
+	*table = t;
+	return 0;
+}
+
+static void
+table_free(void *table)
+{
+	struct table *t = table;
+
+	if (!t)
+		return;
+
+	rte_fib_free(t->fib);
+	rte_fib6_free(t->fib6);
+	rte_free(t);
+}
+
+static int
+table_add(void *table, struct rte_swx_table_entry *entry)
+{
+	struct table *t = table;
+	uint32_t entry_id;
+	uint8_t depth;
+	int status;
+
+	CHECK(t, EINVAL);
+	CHECK(entry, EINVAL);
+	CHECK(entry->key, EINVAL);
+	CHECK((!t->params.action_data_size && !entry->action_data) ||
+	      (t->params.action_data_size && entry->action_data), EINVAL);
+
+	status = key_depth_get(t, entry->key_mask, &depth);
+	if (status)
+		return status;
+
+	/* Route is already present: update its entry data in place. */
+	status = route_find(t, entry->key, depth, &entry_id);
+	if (!status) {
+		entry_data_set(t, entry_id, entry);
+		return 0;
+	}
+
+	/* Route is not present: allocate a new entry. */
+	CHECK(t->entry_stack_tos, ENOSPC);
+	entry_id = t->entry_stack[--t->entry_stack_tos];
+	entry_data_set(t, entry_id, entry);
+
+	if (t->fib)
+		status = rte_fib_add(t->fib, key_ipv4(entry->key), depth,
+				     entry_id);
+	else
+		status = rte_fib6_add(t->fib6, entry->key, depth, entry_id);
+
+	if (status) {
+		t->entry_stack[t->entry_stack_tos++] = entry_id;
+		return status;
+	}
+
+	return 0;
+}
+
+static int
+table_del(void *table, struct rte_swx_table_entry *entry)
+{
+	struct table *t = table;
+	uint32_t entry_id;
+	uint8_t depth;
+	int status;
+
+	CHECK(t, EINVAL);
+	CHECK(entry, EINVAL);
+	CHECK(entry->key, EINVAL);
+
+	status = key_depth_get(t, entry->key_mask, &depth);
+	if (status)
+		return status;
+
+	/* Route is not present. */
+	status = route_find(t, entry->key, depth, &entry_id);
+	if (status)
+		return 0;
+
+	if (t->fib)
+		status = rte_fib_delete(t->fib, key_ipv4(entry->key), depth);
+	else
+		status = rte_fib6_delete(t->fib6, entry->key, depth);
+
+	if (status)
+		return status;
+
+	t->entry_stack[t->entry_stack_tos++] = entry_id;
+	return 0;
+}
+
+struct mailbox {
+	uint64_t entry_id;
+	int state;
+};
+
+static uint64_t
+table_mailbox_size_get(void)
+{
+	return sizeof(struct mailbox);
+}
+
+static int
+table_lookup(void *table,
+	     void *mailbox,
+	     uint8_t **key,
+	     uint64_t *action_id,
+	     uint8_t **action_data,
+	     int *hit)
+{
+	struct table *t = table;
+	struct mailbox *m = mailbox;
+
+	switch (m->state) {
+	case 0: {
+		uint8_t *input_key = &(*key)[t->params.key_offset];
+
+		if (t->fib) {
+			uint32_t ip = key_ipv4(input_key);
+
+			rte_fib_lookup_bulk(t->fib, &ip, &m->entry_id, 1);
+		} else {
+			uint8_t ip[1][RTE_FIB6_IPV6_ADDR_SIZE];
+
+			memcpy(ip[0], input_key, RTE_FIB6_IPV6_ADDR_SIZE);
+			rte_fib6_lookup_bulk(t->fib6, ip, &m->entry_id, 1);
+		}
+
+		if (m->entry_id >= t->params.n_keys_max) {
+			*hit = 0;
+			return 1;
+		}
+
+		/* Prefetch the entry data and resume the lookup later, as the
+		 * entry data is read by the action that follows.
+		 */
+		rte_prefetch0(table_entry_data(t, m->entry_id));
+
+		m->state++;
+		return 0;
+	}
+
+	case 1: {
+		uint64_t *entry_data;
+
+		entry_data = (uint64_t *)table_entry_data(t, m->entry_id);
+		*action_id = entry_data[0];
+		*action_data = (uint8_t *)&entry_data[1];
+		*hit = 1;
+
+		m->state = 0;
+		return 1;
+	}
+
+	default:
+		return 0;
+	}
+}
+
+static void *
+table_create(struct rte_swx_table_params *params,
+	     struct rte_swx_table_entry_list *entries,
+	     const char *args,
+	     int numa_node)
+{
+	struct table *t;
+	struct rte_swx_table_entry *entry;
+	int status;
+
+	/* Table create. */
+	status = __table_create(&t, NULL, params, args, numa_node);
+	if (status)
+		return NULL;
+
+	/* Table add entries. */
+	if (!entries)
+		return t;
+
+	TAILQ_FOREACH(entry, entries, node) {
+		int status;
+
+		status = table_add(t, entry);
+		if (status) {
+			table_free(t);
+			return NULL;
+		}
+	}
+
+	return t;
+}
+
+static uint64_t
+table_footprint(struct rte_swx_table_params *params,
+		struct rte_swx_table_entry_list *entries __rte_unused,
+		const char *args)
+{
+	uint64_t memory_footprint;
+	int status;
+
+	status = __table_create(NULL, &memory_footprint, params, args, 0);
+	if (status)
+		return 0;
+
+	return memory_footprint;
+}
+
+struct rte_swx_table_ops rte_swx_table_longest_prefix_match_ops = {
+	.footprint_get = table_footprint,
+	.mailbox_size_get = table_mailbox_size_get,
+	.create = table_create,
+	.add = table_add,
+	.del = table_del,
+	.lkp = table_lookup,
+	.free = table_free,
+};
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+#ifndef __INCLUDE_RTE_SWX_TABLE_LPM_H__
+#define __INCLUDE_RTE_SWX_TABLE_LPM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE SWX Longest Prefix Match Table
+ *
+ * The table key is either 4 bytes (IPv4 route table built on top of the FIB
+ * library with the DIR-24-8 algorithm) or 16 bytes (IPv6 route table built on
+ * top of the FIB6 library with the trie algorithm). The key is read in network
+ * byte order, i.e. the prefix covers the leading key bytes, which is the case
+ * for the IP address fields of the packet headers. The key mask of each table
+ * entry has to be a prefix mask, with a NULL key mask standing for the full
+ * key length. The table supports incremental add and delete.
+ *
+ * The optional table creation arguments string has the format:
+ *
+ *    [num_tbl8 N_TBL8]
+ *
+ * where N_TBL8 is the number of FIB tbl8 groups, which limits the number of
+ * routes that are longer than 24 bits (IPv4) or than each trie level (IPv6).
+ */
+
+#include <stdint.h>
+
+#include <rte_swx_table.h>
+
+/** Longest prefix match table operations. */
+extern struct rte_swx_table_ops rte_swx_table_longest_prefix_match_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
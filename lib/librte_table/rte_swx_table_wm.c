@@ -0,0 +1,416 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_prefetch.h>
+#include <rte_malloc.h>
+#include <rte_acl.h>
+
+#include "rte_swx_table_wm.h"
+
+#define CHECK(condition, err_code)                                             \
+do {                                                                           \
+	if (!(condition))                                                      \
+		return -(err_code);                                            \
+} while (0)
+
+/* The first ACL field has to be one byte long, while all the subsequent fields
+ * have to be grouped into sets of 4 consecutive bytes.
+ */
+#define ACL_FIELD0_SIZE 1
+#define ACL_FIELD_SIZE 4
+#define KEY_SIZE_MAX \
+	(ACL_FIELD0_SIZE + ACL_FIELD_SIZE * (RTE_ACL_MAX_FIELDS - 1))
+
+struct table {
+	/* Input parameters */
+	struct rte_swx_table_params params;
+
+	/* Internal. */
+	struct rte_acl_config acl_cfg;
+	struct rte_acl_ctx *acl_ctx;
+	uint32_t n_entries;
+	uint32_t entry_data_size;
+	uint64_t total_size;
+
+	/* Memory arrays. */
+	uint8_t *key_mask;
+	uint8_t *data;
+};
+
+static inline uint8_t *
+table_entry_data(struct table *t, uint32_t entry_id)
+{
+	return &t->data[(uint64_t)entry_id * t->entry_data_size];
+}
+
+static uint32_t
+acl_n_fields_get(uint32_t key_size)
+{
+	return 1 + (key_size - ACL_FIELD0_SIZE + ACL_FIELD_SIZE - 1) /
+		ACL_FIELD_SIZE;
+}
+
+static void
+acl_cfg_get(struct rte_acl_config *cfg, struct rte_swx_table_params *params)
+{
+	uint32_t n_fields = acl_n_fields_get(params->key_size), i;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->num_categories = 1;
+	cfg->num_fields = n_fields;
+
+	for (i = 0; i < n_fields; i++) {
+		struct rte_acl_field_def *def = &cfg->defs[i];
+
+		def->type = RTE_ACL_FIELD_TYPE_BITMASK;
+		def->size = i ? ACL_FIELD_SIZE : ACL_FIELD0_SIZE;
+		def->field_index = i;
+		def->input_index = i;
+		def->offset = params->key_offset +
+			(i ? ACL_FIELD0_SIZE + (i - 1) * ACL_FIELD_SIZE : 0);
+	}
+}
+
+static void
+acl_rule_field_set(struct rte_acl_field *field,
+		   uint8_t *key,
+		   uint8_t *key_mask,
+		   uint32_t key_size,
+		   uint32_t offset,
+		   uint32_t size)
+{
+	uint8_t *value = (uint8_t *)&field->value;
+	uint8_t *mask = (uint8_t *)&field->mask_range;
+	uint32_t i;
+
+	memset(field, 0, sizeof(*field));
+
+	/* The ACL library matches the most significant byte of the field value
+	 * against the first byte of the field input, so the key bytes are
+	 * stored in reverse order. The key bytes beyond the key size are
+	 * wildcarded.
+	 */
+	for (i = 0; (i < size) && (offset + i < key_size); i++) {
+		value[size - 1 - i] = key[offset + i] & key_mask[offset + i];
+		mask[size - 1 - i] = key_mask[offset + i];
+	}
+}
+
+static int
+acl_rule_set(struct table *t,
+	     struct rte_acl_rule *rule,
+	     struct rte_swx_table_entry *entry,
+	     uint32_t entry_id)
+{
+	uint8_t key_mask[KEY_SIZE_MAX];
+	uint32_t key_size = t->params.key_size, i;
+
+	CHECK(entry->key, EINVAL);
+	CHECK(entry->key_priority < RTE_ACL_MAX_PRIORITY, EINVAL);
+
+	for (i = 0; i < key_size; i++)
+		key_mask[i] = entry->key_mask ?
+			t->key_mask[i] & entry->key_mask[i] : t->key_mask[i];
+
+	/* Key priority 0 is the highest priority, while the ACL library uses
+	 * the largest value for the highest priority.
+	 */
+	rule->data.category_mask = 1;
+	rule->data.priority = RTE_ACL_MAX_PRIORITY - entry->key_priority;
+	rule->data.userdata = entry_id + 1;
+
+	for (i = 0; i < t->acl_cfg.num_fields; i++) {
+		struct rte_acl_field_def *def = &t->acl_cfg.defs[i];
+
+		acl_rule_field_set(&rule->field[i],
+				   entry->key,
+				   key_mask,
+				   key_size,
+				   def->offset - t->params.key_offset,
+				   def->size);
+	}
+
+	return 0;
+}
+
+static int
+acl_build(struct table *t,
+	  struct rte_swx_table_entry_list *entries,
+	  int numa_node)
+{
+	char name[RTE_ACL_NAMESIZE];
+	struct rte_acl_param acl_params;
+	struct rte_swx_table_entry *entry;
+	uint8_t *rules = NULL;
+	uint32_t rule_size, entry_id = 0;
+	int status = 0;
+
+	if (!t->n_entries)
+		return 0;
+
+	/* Memory allocation. */
+	rule_size = RTE_ACL_RULE_SZ(t->acl_cfg.num_fields);
+
+	rules = calloc(t->n_entries, rule_size);
+	CHECK(rules, ENOMEM);
+
+	/* Rules. */
+	TAILQ_FOREACH(entry, entries, node) {
+		struct rte_acl_rule *rule;
+		uint8_t *entry_data;
+
+		rule = (struct rte_acl_rule *)&rules[entry_id * rule_size];
+		status = acl_rule_set(t, rule, entry, entry_id);
+		if (status)
+			goto free_rules;
+
+		entry_data = table_entry_data(t, entry_id);
+		*(uint64_t *)entry_data = entry->action_id;
+		if (t->params.action_data_size && entry->action_data)
+			memcpy(&entry_data[sizeof(uint64_t)],
+			       entry->action_data,
+			       t->params.action_data_size);
+
+		entry_id++;
+	}
+
+	/* ACL context. The table address makes the context name unique. */
+	snprintf(name, sizeof(name), "swx_wm_%p", (void *)t);
+
+	acl_params.name = name;
+	acl_params.socket_id = numa_node;
+	acl_params.rule_size = rule_size;
+	acl_params.max_rule_num = t->n_entries;
+
+	t->acl_ctx = rte_acl_create(&acl_params);
+	if (!t->acl_ctx) {
+		status = -ENOMEM;
+		goto free_rules;
+	}
+
+	status = rte_acl_add_rules(t->acl_ctx,
+				   (struct rte_acl_rule *)rules,
+				   t->n_entries);
+	if (status)
+		goto free_rules;
+
+	status = rte_acl_build(t->acl_ctx, &t->acl_cfg);
+
+free_rules:
+	free(rules);
+	return status;
+}
+
+#define CL RTE_CACHE_LINE_ROUNDUP
+
+static int
+__table_create(struct table **table,
+	       uint64_t *memory_footprint,
+	       struct rte_swx_table_params *params,
+	       struct rte_swx_table_entry_list *entries,
+	       const char *args __rte_unused,
+	       int numa_node)
+{
+	struct table *t;
+	struct rte_swx_table_entry *entry;
+	uint8_t *memory;
+	size_t table_meta_sz, key_mask_sz, data_sz, total_size;
+	size_t key_mask_offset, data_offset;
+	uint32_t n_entries = 0, entry_data_size;
+
+	/* Check input arguments. */
+	CHECK(params, EINVAL);
+	CHECK(params->match_type == RTE_SWX_TABLE_MATCH_WILDCARD, EINVAL);
+	CHECK(params->key_size, EINVAL);
+	CHECK(params->key_size <= KEY_SIZE_MAX, EINVAL);
+	CHECK(params->n_keys_max, EINVAL);
+
+	if (entries)
+		TAILQ_FOREACH(entry, entries, node)
+			n_entries++;
+
+	CHECK(n_entries <= params->n_keys_max, ENOSPC);
+
+	/* Memory allocation. */
+	entry_data_size = RTE_ALIGN_CEIL(sizeof(uint64_t) +
+					 params->action_data_size,
+					 sizeof(uint64_t));
+
+	table_meta_sz = CL(sizeof(struct table));
+	key_mask_sz = CL(params->key_size);
+	data_sz = CL((uint64_t)n_entries * entry_data_size);
+	total_size = table_meta_sz + key_mask_sz + data_sz;
+
+	key_mask_offset = table_meta_sz;
+	data_offset = key_mask_offset + key_mask_sz;
+
+	if (!table) {
+		if (memory_footprint)
+			*memory_footprint = total_size;
+		return 0;
+	}
+
+	memory = rte_zmalloc_socket(NULL,
+				    total_size,
+				    RTE_CACHE_LINE_SIZE,
+				    numa_node);
+	CHECK(memory, ENOMEM);
+
+	/* Initialization. */
+	t = (struct table *)memory;
+	memcpy(&t->params, params, sizeof(*params));
+
+	t->n_entries = n_entries;
+	t->entry_data_size = entry_data_size;
+	t->total_size = total_size;
+
+	t->key_mask = &memory[key_mask_offset];
+	t->data = &memory[data_offset];
+
+	t->params.key_mask0 = t->key_mask;
+
+	if (!params->key_mask0)
+		memset(t->key_mask, 0xFF, params->key_size);
+	else
+		memcpy(t->key_mask, params->key_mask0, params->key_size);
+
+	acl_cfg_get(&t->acl_cfg, &t->params);
+
+	*table = t;
+	return 0;
+}
+
+static void
+table_free(void *table)
+{
+	struct table *t = table;
+
+	if (!t)
+		return;
+
+	rte_acl_free(t->acl_ctx);
+	rte_free(t);
+}
+
+struct mailbox {
+	uint8_t *entry_data;
+	int hit;
+	int state;
+};
+
+static uint64_t
+table_mailbox_size_get(void)
+{
+	return sizeof(struct mailbox);
+}
+
+static int
+table_lookup(void *table,
+	     void *mailbox,
+	     uint8_t **key,
+	     uint64_t *action_id,
+	     uint8_t **action_data,
+	     int *hit)
+{
+	struct table *t = table;
+	struct mailbox *m = mailbox;
+
+	switch (m->state) {
+	case 0: {
+		const uint8_t *data = *key;
+		uint32_t userdata = 0;
+
+		if (t->acl_ctx)
+			rte_acl_classify(t->acl_ctx, &data, &userdata, 1, 1);
+
+		if (!userdata) {
+			*hit = 0;
+			return 1;
+		}
+
+		/* Prefetch the entry data and resume the lookup later, as the
+		 * entry data is read by the action that follows.
+		 */
+		m->entry_data = table_entry_data(t, userdata - 1);
+		rte_prefetch0(m->entry_data);
+
+		m->hit = 1;
+		m->state++;
+		return 0;
+	}
+
+	case 1: {
+		uint8_t *entry_data = m->entry_data;
+
+		*action_id = *(uint64_t *)entry_data;
+		*action_data = &entry_data[sizeof(uint64_t)];
+		*hit = m->hit;
+
+		m->state = 0;
+		return 1;
+	}
+
+	default:
+		return 0;
+	}
+}
+
+static void *
+table_create(struct rte_swx_table_params *params,
+	     struct rte_swx_table_entry_list *entries,
+	     const char *args,
+	     int numa_node)
+{
+	struct table *t;
+	int status;
+
+	/* Table create. */
+	status = __table_create(&t, NULL, params, entries, args, numa_node);
+	if (status)
+		return NULL;
+
+	/* Table build. */
+	status = acl_build(t, entries, numa_node);
+	if (status) {
+		table_free(t);
+		return NULL;
+	}
+
+	return t;
+}
+
+static uint64_t
+table_footprint(struct rte_swx_table_params *params,
+		struct rte_swx_table_entry_list *entries,
+		const char *args)
+{
+	uint64_t memory_footprint;
+	int status;
+
+	status = __table_create(NULL,
+				&memory_footprint,
+				params,
+				entries,
+				args,
+				0);
+	if (status)
+		return 0;
+
+	return memory_footprint;
+}
+
+struct rte_swx_table_ops rte_swx_table_wildcard_match_ops = {
+	.footprint_get = table_footprint,
+	.mailbox_size_get = table_mailbox_size_get,
+	.create = table_create,
+	.add = NULL,
+	.del = NULL,
+	.lkp = table_lookup,
+	.free = table_free,
+};
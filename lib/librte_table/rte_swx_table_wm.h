@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright 2021 The DPDK contributors
+ */
+#ifndef __INCLUDE_RTE_SWX_TABLE_WM_H__
+#define __INCLUDE_RTE_SWX_TABLE_WM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE SWX Wildcard Match Table
+ *
+ * The table entries are matched against the lookup key using a per-entry key
+ * mask, with the entry *key_priority* used to select the matching entry when
+ * several entries match the same lookup key (0 is the highest priority). The
+ * table is built on top of the ACL library and it does not support incremental
+ * updates: each table update requires the table to be re-created from the full
+ * list of entries, which is handled transparently by the pipeline control API.
+ */
+
+#include <stdint.h>
+
+#include <rte_swx_table.h>
+
+/** Wildcard match table operations. */
+extern struct rte_swx_table_ops rte_swx_table_wildcard_match_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,6 +28,33 @@
 
 #include "rte_timer.h"
 
+#define TIMER_WHEEL_BITS	6
+#define TIMER_WHEEL_SLOTS	(1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK	(TIMER_WHEEL_SLOTS - 1)
+/* enough levels to cover 64-bit tick values */
+#define TIMER_WHEEL_LEVELS	((64 + TIMER_WHEEL_BITS - 1) / TIMER_WHEEL_BITS)
+/* wl_slot of the timers in the due list */
+#define TIMER_WHEEL_SLOT_DUE	UINT32_MAX
+
+/**
+ * Hierarchical timer wheel, alternative to the skiplist.
+ *
+ * A timer expiring at tick t is stored at the level of the highest bit
+ * differing between t and now_tick, in the slot given by the bits of t at
+ * that level. When now_tick reaches the start of a slot of an upper
+ * level, the timers of that slot are cascaded to the lower levels, and
+ * the timers of the level 0 slot of now_tick are due.
+ */
+struct timer_wheel {
+	uint64_t now_tick;      /**< last tick processed */
+	uint64_t next_tick;     /**< lower bound of the next tick to process */
+	uint32_t shift;         /**< log2 of the slot length in cycles */
+	uint32_t nb_pending;    /**< number of timers in the wheel */
+	struct rte_timer *due;  /**< timers to run on next manage */
+	uint64_t occupied[TIMER_WHEEL_LEVELS]; /**< non empty slots bitmap */
+	struct rte_timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
 /**
  * Per-lcore info for timers.
  */
@@ -47,6 +74,9 @@ struct priv_timer {
 	/** running timer on this lcore now */
 	struct rte_timer *running_tim;
 
+	/** timer wheel used instead of the skiplist, if not NULL */
+	struct timer_wheel *wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -115,12 +145,60 @@ rte_timer_data_alloc(uint32_t *id_ptr)
 	return -ENOSPC;
 }
 
+int
+rte_timer_data_alloc_wheel(uint32_t *id_ptr, uint64_t resolution)
+{
+	struct rte_timer_data *data;
+	struct timer_wheel *wheels;
+	uint64_t now;
+	uint32_t id, shift;
+	int i, ret;
+
+	if (resolution == 0)
+		resolution = rte_get_timer_hz() / US_PER_S;
+	shift = resolution > 1 ? rte_log2_u64(rte_align64prevpow2(resolution))
+		: 0;
+
+	wheels = rte_zmalloc("timer_wheel", RTE_MAX_LCORE * sizeof(*wheels),
+			RTE_CACHE_LINE_SIZE);
+	if (wheels == NULL)
+		return -ENOMEM;
+
+	ret = rte_timer_data_alloc(&id);
+	if (ret != 0) {
+		rte_free(wheels);
+		return ret;
+	}
+
+	now = rte_get_timer_cycles() >> shift;
+	data = &rte_timer_data_arr[id];
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		wheels[i].shift = shift;
+		wheels[i].now_tick = now;
+		wheels[i].next_tick = UINT64_MAX;
+		data->priv_timer[i].wheel = &wheels[i];
+	}
+
+	if (id_ptr)
+		*id_ptr = id;
+
+	return 0;
+}
+
 int
 rte_timer_data_dealloc(uint32_t id)
 {
 	struct rte_timer_data *timer_data;
+	int i;
+
 	TIMER_DATA_VALID_GET_OR_ERR_RET(id, timer_data, -EINVAL);
 
+	if (timer_data->priv_timer[0].wheel != NULL) {
+		rte_free(timer_data->priv_timer[0].wheel);
+		for (i = 0; i < RTE_MAX_LCORE; i++)
+			timer_data->priv_timer[i].wheel = NULL;
+	}
+
 	timer_data->internal_flags &= ~(FL_ALLOCATED);
 
 	return 0;
@@ -389,6 +467,154 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
+/* link a timer at the head of a wheel list */
+static inline void
+timer_wheel_link(struct rte_timer **head, struct rte_timer *tim,
+		 uint32_t slot)
+{
+	tim->wl_next = *head;
+	if (*head != NULL)
+		(*head)->wl_pprev = &tim->wl_next;
+	*head = tim;
+	tim->wl_pprev = head;
+	tim->wl_slot = slot;
+}
+
+/* insert a timer in the wheel, relative to now_tick */
+static void
+timer_wheel_insert(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint64_t tick, start;
+	uint32_t lvl, idx;
+
+	/* round up so that the timer never runs early */
+	tick = tim->expire >> w->shift;
+	if ((tim->expire & ((UINT64_C(1) << w->shift) - 1)) != 0)
+		tick++;
+
+	if (tick <= w->now_tick) {
+		timer_wheel_link(&w->due, tim, TIMER_WHEEL_SLOT_DUE);
+		w->next_tick = 0;
+		return;
+	}
+
+	lvl = (rte_fls_u64(tick ^ w->now_tick) - 1) / TIMER_WHEEL_BITS;
+	idx = (tick >> (lvl * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+	timer_wheel_link(&w->slots[lvl][idx], tim,
+			 lvl * TIMER_WHEEL_SLOTS + idx);
+	w->occupied[lvl] |= UINT64_C(1) << idx;
+
+	/* the slot is processed when now_tick reaches its start */
+	start = tick & ~((UINT64_C(1) << (lvl * TIMER_WHEEL_BITS)) - 1);
+	if (start < w->next_tick)
+		w->next_tick = start;
+}
+
+/* remove a timer from the wheel, if still in it */
+static void
+timer_wheel_remove(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint32_t lvl, idx;
+
+	if (tim->wl_pprev == NULL)
+		return;
+
+	*tim->wl_pprev = tim->wl_next;
+	if (tim->wl_next != NULL)
+		tim->wl_next->wl_pprev = tim->wl_pprev;
+	tim->wl_pprev = NULL;
+
+	if (tim->wl_slot != TIMER_WHEEL_SLOT_DUE) {
+		lvl = tim->wl_slot / TIMER_WHEEL_SLOTS;
+		idx = tim->wl_slot % TIMER_WHEEL_SLOTS;
+		if (w->slots[lvl][idx] == NULL)
+			w->occupied[lvl] &= ~(UINT64_C(1) << idx);
+	}
+	w->nb_pending--;
+}
+
+/* get the start tick of the first non empty slot after now_tick */
+static uint64_t
+timer_wheel_next_slot(const struct timer_wheel *w)
+{
+	uint64_t next = UINT64_MAX;
+	uint64_t mask, tick;
+	uint32_t lvl, idx, base;
+
+	for (lvl = 0; lvl < TIMER_WHEEL_LEVELS; lvl++) {
+		if (w->occupied[lvl] == 0)
+			continue;
+
+		/* slots at or before the current one are empty */
+		base = lvl * TIMER_WHEEL_BITS;
+		idx = (w->now_tick >> base) & TIMER_WHEEL_MASK;
+		mask = w->occupied[lvl] & ~((UINT64_C(2) << idx) - 1);
+		if (mask == 0)
+			continue;
+
+		/* same upper bits as now_tick */
+		tick = (uint64_t)rte_bsf64(mask) << base;
+		base += TIMER_WHEEL_BITS;
+		if (base < 64)
+			tick |= w->now_tick & ~((UINT64_C(1) << base) - 1);
+		if (tick < next)
+			next = tick;
+	}
+
+	return next;
+}
+
+/* move all the timers of a slot to the due list or a lower level */
+static void
+timer_wheel_cascade(struct timer_wheel *w, uint32_t lvl, uint32_t idx)
+{
+	struct rte_timer *tim, *next_tim;
+
+	tim = w->slots[lvl][idx];
+	w->slots[lvl][idx] = NULL;
+	w->occupied[lvl] &= ~(UINT64_C(1) << idx);
+
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = tim->wl_next;
+		timer_wheel_insert(w, tim);
+	}
+}
+
+/*
+ * Advance the wheel up to cur_tick, jumping over empty slots, and return
+ * the list of due timers, linked with sl_next[0].
+ */
+static struct rte_timer *
+timer_wheel_expire(struct timer_wheel *w, uint64_t cur_tick)
+{
+	struct rte_timer *tim, *run_first_tim;
+	uint64_t tick;
+	int lvl;
+
+	while ((tick = timer_wheel_next_slot(w)) <= cur_tick) {
+		w->now_tick = tick;
+		for (lvl = TIMER_WHEEL_LEVELS - 1; lvl >= 0; lvl--) {
+			if ((tick & ((UINT64_C(1) <<
+					(lvl * TIMER_WHEEL_BITS)) - 1)) != 0)
+				continue;
+			timer_wheel_cascade(w, lvl, (tick >>
+				(lvl * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK);
+		}
+	}
+	if (w->now_tick < cur_tick)
+		w->now_tick = cur_tick;
+
+	run_first_tim = w->due;
+	w->due = NULL;
+	for (tim = run_first_tim; tim != NULL; tim = tim->wl_next) {
+		tim->wl_pprev = NULL;
+		w->nb_pending--;
+	}
+	w->next_tick = timer_wheel_next_slot(w);
+
+	return run_first_tim;
+}
+
 /* call with lock held as necessary
  * add in list
  * timer must be in config state
@@ -401,6 +627,12 @@ timer_add(struct rte_timer *tim, unsigned int tim_lcore,
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
+	if (priv_timer[tim_lcore].wheel != NULL) {
+		priv_timer[tim_lcore].wheel->nb_pending++;
+		timer_wheel_insert(priv_timer[tim_lcore].wheel, tim);
+		return;
+	}
+
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
@@ -446,6 +678,11 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
 
+	if (priv_timer[prev_owner].wheel != NULL) {
+		timer_wheel_remove(priv_timer[prev_owner].wheel, tim);
+		goto unlock;
+	}
+
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -466,6 +703,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 		else
 			break;
 
+unlock:
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
@@ -657,6 +895,71 @@ rte_timer_pending(struct rte_timer *tim)
 				__ATOMIC_RELAXED) == RTE_TIMER_PENDING;
 }
 
+/* check whether the timer list of an lcore is empty */
+static inline int
+timer_list_empty(const struct priv_timer *priv)
+{
+	if (priv->wheel != NULL)
+		return priv->wheel->nb_pending == 0;
+	return priv->pending_head.sl_next[0] == NULL;
+}
+
+/* get a lower bound of the next expiry time of the timer list of an lcore */
+static inline uint64_t
+timer_list_next_expire(const struct priv_timer *priv)
+{
+	const struct timer_wheel *w = priv->wheel;
+
+	if (w == NULL)
+		return priv->pending_head.expire;
+	if (w->next_tick > (UINT64_MAX >> w->shift))
+		return UINT64_MAX;
+	return w->next_tick << w->shift;
+}
+
+/*
+ * Detach the expired timers from the timer list of an lcore and return
+ * them linked with sl_next[0]. List lock must be held.
+ */
+static struct rte_timer *
+timer_list_detach_expired(unsigned int lcore_id, uint64_t cur_time,
+			  struct priv_timer *priv_timer)
+{
+	struct priv_timer *priv = &priv_timer[lcore_id];
+	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
+	struct rte_timer *tim;
+	int i;
+
+	if (priv->wheel != NULL)
+		return timer_wheel_expire(priv->wheel,
+					  cur_time >> priv->wheel->shift);
+
+	/* if nothing to do just return */
+	if (priv->pending_head.sl_next[0] == NULL ||
+	    priv->pending_head.sl_next[0]->expire > cur_time)
+		return NULL;
+
+	/* save start of list of expired timers */
+	tim = priv->pending_head.sl_next[0];
+
+	/* break the existing list at current time point */
+	timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
+	for (i = priv->curr_skiplist_depth - 1; i >= 0; i--) {
+		if (prev[i] == &priv->pending_head)
+			continue;
+		priv->pending_head.sl_next[i] = prev[i]->sl_next[i];
+		if (prev[i]->sl_next[i] == NULL)
+			priv->curr_skiplist_depth--;
+		prev[i]->sl_next[i] = NULL;
+	}
+
+	/* update the next to expire timer value */
+	priv->pending_head.expire = (priv->pending_head.sl_next[0] == NULL) ?
+		0 : priv->pending_head.sl_next[0]->expire;
+
+	return tim;
+}
+
 /* must be called periodically, run all timer that expired */
 static void
 __rte_timer_manage(struct rte_timer_data *timer_data)
@@ -665,9 +968,8 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
 	unsigned lcore_id = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
-	int i, ret;
+	int ret;
 	struct priv_timer *priv_timer = timer_data->priv_timer;
 
 	/* timer manager only runs on EAL thread with valid lcore_id */
@@ -675,7 +977,7 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 
 	__TIMER_STAT_ADD(priv_timer, manage, 1);
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+	if (timer_list_empty(&priv_timer[lcore_id]))
 		return;
 	cur_time = rte_get_timer_cycles();
 
@@ -683,35 +985,21 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 	/* on 64-bit the value cached in the pending_head.expired will be
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
+	if (likely(timer_list_next_expire(&priv_timer[lcore_id]) > cur_time))
 		return;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
 	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
 
+	tim = timer_list_detach_expired(lcore_id, cur_time, priv_timer);
+
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
+	if (tim == NULL) {
 		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 		return;
 	}
 
-	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
-
-	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		if (prev[i] == &priv_timer[lcore_id].pending_head)
-			continue;
-		priv_timer[lcore_id].pending_head.sl_next[i] =
-		    prev[i]->sl_next[i];
-		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
-		prev[i] ->sl_next[i] = NULL;
-	}
-
 	/* transition run-list from PENDING to RUNNING */
 	run_first_tim = tim;
 	pprev = &run_first_tim;
@@ -730,11 +1018,6 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 		}
 	}
 
-	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
-
 	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
 
 	/* now scan expired list and call callbacks */
@@ -807,9 +1090,8 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 	struct rte_timer *tim, *next_tim, **pprev;
 	struct rte_timer *run_first_tims[RTE_MAX_LCORE];
 	unsigned int this_lcore = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
-	int i, j, ret;
+	int i, ret;
 	int nb_runlists = 0;
 	struct rte_timer_data *data;
 	struct priv_timer *privp;
@@ -832,7 +1114,7 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 		privp = &data->priv_timer[poll_lcore];
 
 		/* optimize for the case where per-cpu list is empty */
-		if (privp->pending_head.sl_next[0] == NULL)
+		if (timer_list_empty(privp))
 			continue;
 		cur_time = rte_get_timer_cycles();
 
@@ -841,37 +1123,22 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 		 * be updated atomically, so we can consult that for a quick
 		 * check here outside the lock
 		 */
-		if (likely(privp->pending_head.expire > cur_time))
+		if (likely(timer_list_next_expire(privp) > cur_time))
 			continue;
 #endif
 
 		/* browse ordered list, add expired timers in 'expired' list */
 		rte_spinlock_lock(&privp->list_lock);
 
+		tim = timer_list_detach_expired(poll_lcore, cur_time,
+						data->priv_timer);
+
 		/* if nothing to do just unlock and return */
-		if (privp->pending_head.sl_next[0] == NULL ||
-		    privp->pending_head.sl_next[0]->expire > cur_time) {
+		if (tim == NULL) {
 			rte_spinlock_unlock(&privp->list_lock);
 			continue;
 		}
 
-		/* save start of list of expired timers */
-		tim = privp->pending_head.sl_next[0];
-
-		/* break the existing list at current time point */
-		timer_get_prev_entries(cur_time, poll_lcore, prev,
-				       data->priv_timer);
-		for (j = privp->curr_skiplist_depth - 1; j >= 0; j--) {
-			if (prev[j] == &privp->pending_head)
-				continue;
-			privp->pending_head.sl_next[j] =
-				prev[j]->sl_next[j];
-			if (prev[j]->sl_next[j] == NULL)
-				privp->curr_skiplist_depth--;
-
-			prev[j]->sl_next[j] = NULL;
-		}
-
 		/* transition run-list from PENDING to RUNNING */
 		run_first_tims[nb_runlists] = tim;
 		pprev = &run_first_tims[nb_runlists];
@@ -891,11 +1158,6 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 			}
 		}
 
-		/* update the next to expire timer value */
-		privp->pending_head.expire =
-		    (privp->pending_head.sl_next[0] == NULL) ? 0 :
-			privp->pending_head.sl_next[0]->expire;
-
 		rte_spinlock_unlock(&privp->list_lock);
 	}
 
@@ -976,6 +1238,40 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 	return 0;
 }
 
+/* stop the timers of a wheel list, list lock must be held */
+static void
+timer_wheel_stop_list(struct rte_timer *tim,
+		      struct rte_timer_data *timer_data,
+		      rte_timer_stop_all_cb_t f, void *f_arg)
+{
+	struct rte_timer *next_tim;
+
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = tim->wl_next;
+
+		/* Call timer_stop with lock held */
+		__rte_timer_stop(tim, 1, timer_data);
+
+		if (f)
+			f(tim, f_arg);
+	}
+}
+
+/* stop all the timers of a wheel, list lock must be held */
+static void
+timer_wheel_stop_all(struct timer_wheel *w, struct rte_timer_data *timer_data,
+		     rte_timer_stop_all_cb_t f, void *f_arg)
+{
+	uint32_t lvl, idx;
+
+	timer_wheel_stop_list(w->due, timer_data, f, f_arg);
+	for (lvl = 0; lvl < TIMER_WHEEL_LEVELS; lvl++)
+		for (idx = 0; idx < TIMER_WHEEL_SLOTS; idx++)
+			if (w->occupied[lvl] & (UINT64_C(1) << idx))
+				timer_wheel_stop_list(w->slots[lvl][idx],
+						      timer_data, f, f_arg);
+}
+
 /* Walk pending lists, stopping timers and calling user-specified function */
 int
 rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
@@ -996,6 +1292,13 @@ rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
 
 		rte_spinlock_lock(&priv_timer->list_lock);
 
+		if (priv_timer->wheel != NULL) {
+			timer_wheel_stop_all(priv_timer->wheel, timer_data,
+					     f, f_arg);
+			rte_spinlock_unlock(&priv_timer->list_lock);
+			continue;
+		}
+
 		for (tim = priv_timer->pending_head.sl_next[0];
 		     tim != NULL;
 		     tim = next_tim) {
@@ -1021,7 +1324,7 @@ rte_timer_next_ticks(void)
 	struct rte_timer_data *timer_data;
 	struct priv_timer *priv_timer;
 	const struct rte_timer *tm;
-	uint64_t cur_time;
+	uint64_t cur_time, expire;
 	int64_t left = -ENOENT;
 
 	TIMER_DATA_VALID_GET_OR_ERR_RET(default_data_id, timer_data, -EINVAL);
@@ -1030,6 +1333,15 @@ rte_timer_next_ticks(void)
 	cur_time = rte_get_timer_cycles();
 
 	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	if (priv_timer[lcore_id].wheel != NULL) {
+		if (!timer_list_empty(&priv_timer[lcore_id])) {
+			expire = timer_list_next_expire(&priv_timer[lcore_id]);
+			left = expire > cur_time ? (int64_t)(expire - cur_time)
+				: 0;
+		}
+		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+		return left;
+	}
 	tm = priv_timer[lcore_id].pending_head.sl_next[0];
 	if (tm) {
 		left = tm->expire - cur_time;
@@ -100,7 +100,17 @@ typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	RTE_STD_C11
+	union {
+		/** Skiplist links. */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Timer wheel links. */
+		struct {
+			struct rte_timer *wl_next;   /**< Next in slot. */
+			struct rte_timer **wl_pprev; /**< Link to this timer. */
+			uint32_t wl_slot;            /**< Slot index. */
+		};
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t f;      /**< Callback function. */
@@ -146,6 +156,34 @@ struct rte_timer
  */
 int rte_timer_data_alloc(uint32_t *id_ptr);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Allocate a timer data instance backed by hierarchical timer wheels
+ * instead of skiplists.
+ *
+ * Adding and removing a timer is O(1), and expired timers are collected a
+ * whole wheel slot at a time, which suits instances holding millions of
+ * timers. Timers never expire early, but may expire up to *resolution*
+ * cycles late. The instance is used through the rte_timer_alt_*()
+ * functions, like one allocated with rte_timer_data_alloc().
+ *
+ * @param id_ptr
+ *   Pointer to variable into which to write the identifier of the allocated
+ *   timer data instance.
+ * @param resolution
+ *   Wheel slot length in timer cycles, rounded down to a power of 2.
+ *   If 0, one microsecond is used.
+ *
+ * @return
+ *   - 0: Success
+ *   - -ENOSPC: maximum number of timer data instances already allocated
+ *   - -ENOMEM: unable to allocate the timer wheels
+ */
+__rte_experimental
+int rte_timer_data_alloc_wheel(uint32_t *id_ptr, uint64_t resolution);
+
 /**
  * Deallocate a timer data instance.
  *
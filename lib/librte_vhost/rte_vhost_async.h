@@ -192,4 +192,49 @@ __rte_experimental
 uint16_t rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
 		struct rte_mbuf **pkts, uint16_t count);
 
+/**
+ * This function submits dequeue data to async engine. Buffers of the
+ * packets available in the guest Tx queue are allocated from mbuf_pool,
+ * and the packet data copies are submitted to the async engine, except
+ * for segments shorter than the channel threshold which are copied by
+ * the CPU. Submitted packets, either copied by the CPU or still being
+ * copied by DMA engines, are returned in submission order by
+ * rte_vhost_poll_dequeue_completed().
+ *
+ * @param vid
+ *  id of vhost device to dequeue data
+ * @param queue_id
+ *  queue id to dequeue data
+ * @param mbuf_pool
+ *  mbuf pool where host mbufs are allocated
+ * @param count
+ *  max num of packets to be dequeued
+ * @return
+ *  num of packets submitted
+ */
+__rte_experimental
+uint16_t rte_vhost_submit_dequeue_burst(int vid, uint16_t queue_id,
+		struct rte_mempool *mbuf_pool, uint16_t count);
+
+/**
+ * This function checks async completion status for a specific vhost
+ * device queue. Packets which finish copying (dequeue) operation are
+ * returned in an array, in their submission order, and their descriptors
+ * are given back to the guest.
+ *
+ * @param vid
+ *  id of vhost device to dequeue data
+ * @param queue_id
+ *  queue id to dequeue data
+ * @param pkts
+ *  blank array to get return packet pointer
+ * @param count
+ *  size of the packet array
+ * @return
+ *  num of packets returned
+ */
+__rte_experimental
+uint16_t rte_vhost_poll_dequeue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
 #endif /* _RTE_VHOST_ASYNC_H_ */
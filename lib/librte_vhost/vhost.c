@@ -336,9 +336,12 @@ vhost_free_async_mem(struct vhost_virtqueue *vq)
 		rte_free(vq->it_pool);
 	if (vq->vec_pool)
 		rte_free(vq->vec_pool);
+	if (vq->async_deq_info)
+		rte_free(vq->async_deq_info);
 
 	vq->async_pkts_info = NULL;
 	vq->async_descs_split = NULL;
+	vq->async_deq_info = NULL;
 	vq->it_pool = NULL;
 	vq->vec_pool = NULL;
 }
@@ -1646,8 +1649,14 @@ int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
 	vq->async_descs_split = rte_malloc_socket(NULL,
 			vq->size * sizeof(struct vring_used_elem),
 			RTE_CACHE_LINE_SIZE, node);
+	/* guest Tx queues are dequeued */
+	if (queue_id & 1)
+		vq->async_deq_info = rte_malloc_socket(NULL,
+				vq->size * sizeof(struct async_dequeue_info),
+				RTE_CACHE_LINE_SIZE, node);
 	if (!vq->async_descs_split || !vq->async_pkts_info ||
-		!vq->it_pool || !vq->vec_pool) {
+		!vq->it_pool || !vq->vec_pool ||
+		((queue_id & 1) && !vq->async_deq_info)) {
 		vhost_free_async_mem(vq);
 		VHOST_LOG_CONFIG(ERR,
 				"async register failed: cannot allocate memory for vq data "
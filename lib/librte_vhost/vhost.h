@@ -117,6 +117,17 @@ struct vring_used_elem_packed {
 	uint32_t count;
 };
 
+/*
+ * Structure that contains the info for each async dequeue packet,
+ * in submission order.
+ */
+struct async_dequeue_info {
+	struct rte_mbuf *mbuf;		/* NULL if dropped */
+	struct virtio_net_hdr hdr;	/* saved for offloads on completion */
+	uint16_t head_idx;		/* descriptor chain head */
+	uint16_t nr_dma;		/* 0 if copied by the CPU */
+};
+
 /**
  * Structure contains variables relevant to RX/TX virtqueues.
  */
@@ -209,6 +220,7 @@ struct vhost_virtqueue {
 	struct vring_used_elem  *async_descs_split;
 	uint16_t async_desc_idx;
 	uint16_t last_async_desc_idx;
+	struct async_dequeue_info *async_deq_info;
 
 	/* vq async features */
 	bool		async_inorder;
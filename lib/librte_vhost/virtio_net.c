@@ -2585,3 +2585,515 @@ out_access_unlock:
 
 	return count;
 }
+
+static __rte_always_inline int
+async_desc_to_mbuf(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		  struct buf_vector *buf_vec, uint16_t nr_vec,
+		  struct rte_mbuf *m, struct rte_mempool *mbuf_pool,
+		  struct virtio_net_hdr *hdr,
+		  struct iovec *src_iovec, struct iovec *dst_iovec,
+		  struct rte_vhost_iov_iter *src_it,
+		  struct rte_vhost_iov_iter *dst_it)
+{
+	uint32_t buf_avail, buf_offset;
+	uint64_t buf_addr, buf_iova, buf_len;
+	uint32_t mbuf_avail, mbuf_offset;
+	uint32_t cpy_len, cpy_threshold;
+	struct rte_mbuf *cur = m, *prev = m;
+	/* A counter to avoid desc dead loop chain */
+	uint16_t vec_idx = 0;
+	struct batch_copy_elem *batch_copy = vq->batch_copy_elems;
+	int error = 0;
+	uint64_t mapped_len;
+
+	uint32_t tlen = 0;
+	int tvec_idx = 0;
+	void *hpa;
+
+	cpy_threshold = vq->async_threshold;
+
+	buf_addr = buf_vec[vec_idx].buf_addr;
+	buf_iova = buf_vec[vec_idx].buf_iova;
+	buf_len = buf_vec[vec_idx].buf_len;
+
+	if (unlikely(buf_len < dev->vhost_hlen && nr_vec <= 1)) {
+		error = -1;
+		goto out;
+	}
+
+	/*
+	 * The offloads are parsed once the packet data is copied,
+	 * keep a copy of the header until then.
+	 */
+	if (virtio_net_with_host_offload(dev)) {
+		if (unlikely(buf_len < sizeof(struct virtio_net_hdr)))
+			copy_vnet_hdr_from_desc(hdr, buf_vec);
+		else
+			*hdr = *(struct virtio_net_hdr *)((uintptr_t)buf_addr);
+	}
+
+	if (unlikely(buf_len < dev->vhost_hlen)) {
+		buf_offset = dev->vhost_hlen - buf_len;
+		vec_idx++;
+		buf_addr = buf_vec[vec_idx].buf_addr;
+		buf_iova = buf_vec[vec_idx].buf_iova;
+		buf_len = buf_vec[vec_idx].buf_len;
+		buf_avail  = buf_len - buf_offset;
+	} else if (buf_len == dev->vhost_hlen) {
+		if (unlikely(++vec_idx >= nr_vec))
+			goto out;
+		buf_addr = buf_vec[vec_idx].buf_addr;
+		buf_iova = buf_vec[vec_idx].buf_iova;
+		buf_len = buf_vec[vec_idx].buf_len;
+
+		buf_offset = 0;
+		buf_avail = buf_len;
+	} else {
+		buf_offset = dev->vhost_hlen;
+		buf_avail = buf_vec[vec_idx].buf_len - dev->vhost_hlen;
+	}
+
+	mbuf_offset = 0;
+	mbuf_avail  = m->buf_len - RTE_PKTMBUF_HEADROOM;
+	while (1) {
+		cpy_len = RTE_MIN(buf_avail, mbuf_avail);
+
+		while (unlikely(cpy_len && cpy_len >= cpy_threshold &&
+				tvec_idx < BUF_VECTOR_MAX)) {
+			hpa = (void *)(uintptr_t)gpa_to_first_hpa(dev,
+					buf_iova + buf_offset,
+					cpy_len, &mapped_len);
+
+			if (unlikely(!hpa || mapped_len < cpy_threshold))
+				break;
+
+			async_fill_vec(src_iovec + tvec_idx,
+					hpa, (size_t)mapped_len);
+
+			async_fill_vec(dst_iovec + tvec_idx,
+				(void *)(uintptr_t)rte_pktmbuf_iova_offset(cur,
+				mbuf_offset), (size_t)mapped_len);
+
+			tlen += (uint32_t)mapped_len;
+			cpy_len -= (uint32_t)mapped_len;
+			mbuf_avail  -= (uint32_t)mapped_len;
+			mbuf_offset += (uint32_t)mapped_len;
+			buf_avail  -= (uint32_t)mapped_len;
+			buf_offset += (uint32_t)mapped_len;
+			tvec_idx++;
+		}
+
+		if (likely(cpy_len)) {
+			if (cpy_len > MAX_BATCH_LEN ||
+					vq->batch_copy_nb_elems >= vq->size) {
+				rte_memcpy(rte_pktmbuf_mtod_offset(cur, void *,
+							mbuf_offset),
+						(void *)((uintptr_t)(buf_addr +
+								buf_offset)),
+						cpy_len);
+			} else {
+				batch_copy[vq->batch_copy_nb_elems].dst =
+					rte_pktmbuf_mtod_offset(cur, void *,
+							mbuf_offset);
+				batch_copy[vq->batch_copy_nb_elems].src =
+					(void *)((uintptr_t)(buf_addr +
+								buf_offset));
+				batch_copy[vq->batch_copy_nb_elems].len =
+					cpy_len;
+				vq->batch_copy_nb_elems++;
+			}
+
+			mbuf_avail  -= cpy_len;
+			mbuf_offset += cpy_len;
+			buf_avail -= cpy_len;
+			buf_offset += cpy_len;
+		}
+
+		/* This buf reaches to its end, get the next one */
+		if (buf_avail == 0) {
+			if (++vec_idx >= nr_vec)
+				break;
+
+			buf_addr = buf_vec[vec_idx].buf_addr;
+			buf_iova = buf_vec[vec_idx].buf_iova;
+			buf_len = buf_vec[vec_idx].buf_len;
+
+			buf_offset = 0;
+			buf_avail  = buf_len;
+		}
+
+		/*
+		 * This mbuf reaches to its end, get a new one
+		 * to hold more data.
+		 */
+		if (mbuf_avail == 0) {
+			cur = rte_pktmbuf_alloc(mbuf_pool);
+			if (unlikely(cur == NULL)) {
+				VHOST_LOG_DATA(ERR, "Failed to "
+					"allocate memory for mbuf.\n");
+				error = -1;
+				goto out;
+			}
+
+			prev->next = cur;
+			prev->data_len = mbuf_offset;
+			m->nb_segs += 1;
+			m->pkt_len += mbuf_offset;
+			prev = cur;
+
+			mbuf_offset = 0;
+			mbuf_avail  = cur->buf_len - RTE_PKTMBUF_HEADROOM;
+		}
+	}
+
+	prev->data_len = mbuf_offset;
+	m->pkt_len    += mbuf_offset;
+
+out:
+	if (tlen) {
+		async_fill_iter(src_it, tlen, src_iovec, tvec_idx);
+		async_fill_iter(dst_it, tlen, dst_iovec, tvec_idx);
+	} else {
+		src_it->count = 0;
+	}
+
+	return error;
+}
+
+/*
+ * Packet of an async dequeue burst waiting for its DMA submission.
+ */
+struct async_dequeue_log {
+	uint16_t pkt_idx;
+	uint16_t batch_copy_nb_elems;
+};
+
+/*
+ * Submit the pending DMA copies of an async dequeue burst. If the async
+ * engine does not take them all, the packets from the first rejected one
+ * are freed, their descriptors are left in the ring to be submitted again,
+ * and the number of packets kept in the burst is returned.
+ */
+static __rte_always_inline uint16_t
+async_dequeue_transfer(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		uint16_t queue_id, struct rte_vhost_async_desc *tdes,
+		struct async_dequeue_log *log, uint16_t nr_tdes,
+		uint16_t nr_pkts)
+{
+	struct async_dequeue_info *info;
+	uint32_t n_xfer;
+	uint16_t i;
+
+	n_xfer = vq->async_ops.transfer_data(dev->vid, queue_id, tdes, 0,
+			nr_tdes);
+	if (likely(n_xfer >= nr_tdes))
+		return nr_pkts;
+
+	VHOST_LOG_DATA(DEBUG, "(%d) async engine took %u of %u copies\n",
+		dev->vid, n_xfer, nr_tdes);
+
+	vq->batch_copy_nb_elems = log[n_xfer].batch_copy_nb_elems;
+	for (i = log[n_xfer].pkt_idx; i < nr_pkts; i++) {
+		info = &vq->async_deq_info[(vq->async_pkts_idx + i) &
+			(vq->size - 1)];
+		if (info->mbuf != NULL)
+			rte_pktmbuf_free(info->mbuf);
+	}
+
+	return log[n_xfer].pkt_idx;
+}
+
+static __rte_noinline uint16_t
+virtio_dev_tx_async_submit_split(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, uint16_t count)
+{
+	uint16_t pkt_idx, pkt_burst_idx = 0;
+	uint16_t free_entries;
+	uint16_t dropped = 0;
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+
+	struct rte_vhost_iov_iter *it_pool = vq->it_pool;
+	struct iovec *vec_pool = vq->vec_pool;
+	struct rte_vhost_async_desc tdes[MAX_PKT_BURST];
+	struct iovec *src_iovec = vec_pool;
+	struct iovec *dst_iovec = vec_pool + (VHOST_MAX_ASYNC_VEC >> 1);
+	struct rte_vhost_iov_iter *src_it = it_pool;
+	struct rte_vhost_iov_iter *dst_it = it_pool + 1;
+	uint16_t segs_await = 0;
+	struct async_dequeue_info *info;
+	struct async_dequeue_log async_pkts_log[MAX_PKT_BURST];
+	static bool allocerr_warned;
+
+	/*
+	 * The ordering between avail index and
+	 * desc reads needs to be enforced.
+	 */
+	free_entries = __atomic_load_n(&vq->avail->idx, __ATOMIC_ACQUIRE) -
+			vq->last_avail_idx;
+	if (free_entries == 0)
+		return 0;
+
+	rte_prefetch0(&vq->avail->ring[vq->last_avail_idx & (vq->size - 1)]);
+
+	VHOST_LOG_DATA(DEBUG, "(%d) %s\n", dev->vid, __func__);
+
+	count = RTE_MIN(count, MAX_PKT_BURST);
+	count = RTE_MIN(count, free_entries);
+	count = RTE_MIN(count, vq->size - vq->async_pkts_inflight_n);
+	VHOST_LOG_DATA(DEBUG, "(%d) about to dequeue %u buffers\n",
+			dev->vid, count);
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		uint16_t head_idx;
+		uint32_t buf_len;
+		uint16_t nr_vec = 0;
+		uint16_t nb_elems;
+		struct rte_mbuf *pkt;
+		int err;
+
+		if (unlikely(fill_vec_buf_split(dev, vq,
+						vq->last_avail_idx + pkt_idx,
+						&nr_vec, buf_vec,
+						&head_idx, &buf_len,
+						VHOST_ACCESS_RO) < 0))
+			break;
+
+		info = &vq->async_deq_info[(vq->async_pkts_idx + pkt_idx) &
+			(vq->size - 1)];
+		info->mbuf = NULL;
+		info->head_idx = head_idx;
+		info->nr_dma = 0;
+
+		pkt = virtio_dev_pktmbuf_alloc(dev, mbuf_pool, buf_len);
+		if (unlikely(pkt == NULL)) {
+			/*
+			 * Same as the synchronous path, drop this packet.
+			 * Its descriptors are given back on completion.
+			 */
+			if (!allocerr_warned) {
+				VHOST_LOG_DATA(ERR,
+					"Failed mbuf alloc of size %d from %s on %s.\n",
+					buf_len, mbuf_pool->name, dev->ifname);
+				allocerr_warned = true;
+			}
+			dropped += 1;
+			pkt_idx++;
+			break;
+		}
+
+		nb_elems = vq->batch_copy_nb_elems;
+		err = async_desc_to_mbuf(dev, vq, buf_vec, nr_vec, pkt,
+				mbuf_pool, &info->hdr, src_iovec, dst_iovec,
+				src_it, dst_it);
+		if (unlikely(err)) {
+			vq->batch_copy_nb_elems = nb_elems;
+			rte_pktmbuf_free(pkt);
+			if (!allocerr_warned) {
+				VHOST_LOG_DATA(ERR,
+					"Failed to copy desc to mbuf on %s.\n",
+					dev->ifname);
+				allocerr_warned = true;
+			}
+			dropped += 1;
+			pkt_idx++;
+			break;
+		}
+
+		info->mbuf = pkt;
+
+		if (src_it->count) {
+			async_fill_desc(&tdes[pkt_burst_idx], src_it, dst_it);
+			async_pkts_log[pkt_burst_idx].pkt_idx = pkt_idx;
+			async_pkts_log[pkt_burst_idx++].batch_copy_nb_elems =
+				nb_elems;
+			info->nr_dma = 1;
+			segs_await += src_it->nr_segs;
+			src_iovec += src_it->nr_segs;
+			dst_iovec += dst_it->nr_segs;
+			src_it += 2;
+			dst_it += 2;
+		}
+
+		/*
+		 * conditions to trigger async device transfer:
+		 * - buffered packet number reaches transfer threshold
+		 * - unused async iov number is less than max vhost vector
+		 */
+		if (unlikely(pkt_burst_idx >= VHOST_ASYNC_BATCH_THRESHOLD ||
+			((VHOST_MAX_ASYNC_VEC >> 1) - segs_await <
+			BUF_VECTOR_MAX))) {
+			uint16_t nr_pkts = async_dequeue_transfer(dev, vq,
+					queue_id, tdes, async_pkts_log,
+					pkt_burst_idx, pkt_idx + 1);
+
+			src_iovec = vec_pool;
+			dst_iovec = vec_pool + (VHOST_MAX_ASYNC_VEC >> 1);
+			src_it = it_pool;
+			dst_it = it_pool + 1;
+			segs_await = 0;
+			pkt_burst_idx = 0;
+
+			if (unlikely(nr_pkts <= pkt_idx)) {
+				pkt_idx = nr_pkts;
+				break;
+			}
+		}
+	}
+
+	if (pkt_burst_idx) {
+		uint16_t nr_pkts = async_dequeue_transfer(dev, vq, queue_id,
+				tdes, async_pkts_log, pkt_burst_idx, pkt_idx);
+
+		if (unlikely(nr_pkts < pkt_idx)) {
+			/* a dropped packet can only be the last one */
+			dropped = 0;
+			pkt_idx = nr_pkts;
+		}
+	}
+
+	do_data_copy_dequeue(vq);
+
+	vq->last_avail_idx += pkt_idx;
+	vq->async_pkts_idx += pkt_idx;
+	vq->async_pkts_inflight_n += pkt_idx;
+
+	return pkt_idx - dropped;
+}
+
+uint16_t
+rte_vhost_submit_dequeue_burst(int vid, uint16_t queue_id,
+	struct rte_mempool *mbuf_pool, uint16_t count)
+{
+	struct virtio_net *dev;
+	struct vhost_virtqueue *vq;
+	uint16_t nb_rx = 0;
+
+	dev = get_device(vid);
+	if (!dev)
+		return 0;
+
+	if (unlikely(!(dev->flags & VIRTIO_DEV_BUILTIN_VIRTIO_NET))) {
+		VHOST_LOG_DATA(ERR,
+			"(%d) %s: built-in vhost net backend is disabled.\n",
+			dev->vid, __func__);
+		return 0;
+	}
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 1, dev->nr_vring))) {
+		VHOST_LOG_DATA(ERR,
+			"(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	if (unlikely(vq_is_packed(dev))) {
+		VHOST_LOG_DATA(ERR,
+			"(%d) %s: async dequeue is not supported on packed queue.\n",
+			dev->vid, __func__);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	if (unlikely(rte_spinlock_trylock(&vq->access_lock) == 0))
+		return 0;
+
+	if (unlikely(vq->enabled == 0 || !vq->async_registered))
+		goto out_access_unlock;
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0))
+			goto out;
+
+	nb_rx = virtio_dev_tx_async_submit_split(dev, vq, queue_id,
+			mbuf_pool, count);
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return nb_rx;
+}
+
+uint16_t
+rte_vhost_poll_dequeue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	struct async_dequeue_info *info;
+	uint16_t n_pkts_cpl, n_pkts_put = 0, n_descs;
+	uint16_t start_idx;
+
+	if (!dev)
+		return 0;
+
+	VHOST_LOG_DATA(DEBUG, "(%d) %s\n", dev->vid, __func__);
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 1, dev->nr_vring))) {
+		VHOST_LOG_DATA(ERR, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	if (unlikely(!vq->async_registered)) {
+		VHOST_LOG_DATA(ERR, "(%d) %s: async not registered for queue id %d.\n",
+			dev->vid, __func__, queue_id);
+		return 0;
+	}
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	n_pkts_cpl = vq->async_last_pkts_n;
+	if (vq->async_pkts_inflight_n && count > n_pkts_cpl)
+		n_pkts_cpl += vq->async_ops.check_completed_copies(vid,
+			queue_id, 0, count - n_pkts_cpl);
+
+	/*
+	 * Return the packets in submission order, up to the first one
+	 * whose DMA copy is not completed yet.
+	 */
+	start_idx = vq->async_pkts_idx - vq->async_pkts_inflight_n;
+	for (n_descs = 0; n_descs < vq->async_pkts_inflight_n &&
+			n_pkts_put < count; n_descs++) {
+		info = &vq->async_deq_info[(start_idx + n_descs) &
+			(vq->size - 1)];
+		if (info->nr_dma) {
+			if (n_pkts_cpl == 0)
+				break;
+			n_pkts_cpl--;
+		}
+
+		update_shadow_used_ring_split(vq, info->head_idx, 0);
+
+		/* dropped on submission */
+		if (unlikely(info->mbuf == NULL))
+			continue;
+
+		if (virtio_net_with_host_offload(dev))
+			vhost_dequeue_offload(&info->hdr, info->mbuf);
+		pkts[n_pkts_put++] = info->mbuf;
+	}
+	vq->async_last_pkts_n = n_pkts_cpl;
+	vq->async_pkts_inflight_n -= n_descs;
+
+	if (likely(vq->enabled && vq->access_ok)) {
+		if (likely(vq->shadow_used_idx)) {
+			flush_shadow_used_ring_split(dev, vq);
+			vhost_vring_call_split(dev, vq);
+		}
+	} else
+		vq->shadow_used_idx = 0;
+
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return n_pkts_put;
+}